@@ -30,6 +30,8 @@ TARGET_HOST=""
 USER=""
 TARGET_DIRECTORY="/tmp/panelkit"
 BINARY_PATH="build/target/panelkit"
+TAP_PATH="build/target/panelkit-tap"
+ASSETS_PATH="build/panelkit-assets.pkb"
 
 # Parse command line arguments
 while [[ $# -gt 0 ]]; do
@@ -92,7 +94,14 @@ fi
 
 # Step 2: Copy binary
 echo -e "${YELLOW}2. Copying binary...${NC}"
-if scp "$BINARY_PATH" "$SSH_TARGET:$TARGET_DIRECTORY/"; then
+BINARIES="$BINARY_PATH"
+if [ -f "$TAP_PATH" ]; then
+    BINARIES="$BINARIES $TAP_PATH"
+fi
+if [ -f "$ASSETS_PATH" ]; then
+    BINARIES="$BINARIES $ASSETS_PATH"
+fi
+if scp $BINARIES "$SSH_TARGET:$TARGET_DIRECTORY/"; then
     echo -e "${GREEN}Binary copied successfully${NC}"
 else
     echo -e "${RED}Failed to copy binary${NC}"
@@ -120,6 +129,10 @@ fi
 echo -e "${GREEN}Deployment completed successfully!${NC}"
 echo -e "${YELLOW}Files deployed to: $SSH_TARGET:$TARGET_DIRECTORY${NC}"
 echo "Binary: $TARGET_DIRECTORY/panelkit"
+echo "Event viewer: $TARGET_DIRECTORY/panelkit-tap"
+if [ -f "$ASSETS_PATH" ]; then
+    echo "Assets: $TARGET_DIRECTORY/panelkit-assets.pkb (system.assets.bundle)"
+fi
 echo "Service: $TARGET_DIRECTORY/panelkit.service"
 echo "README: $TARGET_DIRECTORY/README.md"
 echo "Makefile: $TARGET_DIRECTORY/Makefile"
\ No newline at end of file
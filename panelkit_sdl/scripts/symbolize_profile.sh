@@ -0,0 +1,83 @@
+#!/bin/bash
+# Symbolize a folded profile written on the panel by the built-in profiler
+#
+# Frames arrive as "module+0xOFFSET" (file offsets), so the stripped binary
+# on the device needs no symbols. This maps the offsets of one module back
+# to function names using the unstripped build:
+#
+#   scripts/symbolize_profile.sh build/target/panelkit panelkit-profile.folded \
+#       | flamegraph.pl > profile.svg
+#
+# Set ADDR2LINE/READELF for cross builds (aarch64-linux-gnu-addr2line ...).
+# Frames from other modules (libc.so.6+0x...) are left as they are.
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 BINARY PROFILE.folded [MODULE]" >&2
+    echo "  MODULE defaults to the binary's file name" >&2
+    exit 2
+fi
+
+BINARY="$1"
+PROFILE="$2"
+MODULE="${3:-$(basename "$BINARY")}"
+ADDR2LINE="${ADDR2LINE:-addr2line}"
+READELF="${READELF:-readelf}"
+
+if [ ! -f "$BINARY" ] || [ ! -f "$PROFILE" ]; then
+    echo "Error: $BINARY or $PROFILE not found" >&2
+    exit 1
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Unique offsets of this module, in the order addr2line will answer
+grep -o "[;]$MODULE+0x[0-9a-f]*" "$PROFILE" | sed "s/^;$MODULE+//" | sort -u > "$WORK/offsets"
+if [ ! -s "$WORK/offsets" ]; then
+    echo "Warning: no frames from module '$MODULE' in $PROFILE" >&2
+    cat "$PROFILE"
+    exit 0
+fi
+
+# File offset -> virtual address through the PT_LOAD segments
+"$READELF" -lW "$BINARY" | awk '$1 == "LOAD" { print $2, $3, $5 }' > "$WORK/segments"
+awk 'function hex(s,    i, v) {
+         s = tolower(s); sub(/^0x/, "", s); v = 0
+         for (i = 1; i <= length(s); i++) v = v * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+         return v
+     }
+     NR == FNR { off[n] = hex($1); vaddr[n] = hex($2); size[n++] = hex($3); next }
+     {
+         o = hex($1)
+         for (i = 0; i < n; i++) {
+             if (o >= off[i] && o < off[i] + size[i]) {
+                 printf "0x%x\n", o - off[i] + vaddr[i]
+                 next
+             }
+         }
+         print $1
+     }' "$WORK/segments" "$WORK/offsets" > "$WORK/addresses"
+
+# One function name per address (-f prints name and file:line pairs)
+"$ADDR2LINE" -f -C -e "$BINARY" < "$WORK/addresses" | awk 'NR % 2 == 1' > "$WORK/names"
+
+paste "$WORK/offsets" "$WORK/names" > "$WORK/map"
+awk -v module="$MODULE" '
+    NR == FNR { split($0, pair, "\t"); name[pair[1]] = (pair[2] == "??" ? module "+" pair[1] : pair[2]); next }
+    {
+        count = $NF
+        stack = substr($0, 1, length($0) - length(count) - 1)
+        frames = split(stack, frame, ";")
+        line = frame[1]
+        for (i = 2; i <= frames; i++) {
+            f = frame[i]
+            prefix = module "+"
+            if (index(f, prefix) == 1 && (substr(f, length(prefix) + 1) in name)) {
+                f = name[substr(f, length(prefix) + 1)]
+            }
+            line = line ";" f
+        }
+        print line, count
+    }' "$WORK/map" "$PROFILE"
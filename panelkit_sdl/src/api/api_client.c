@@ -1,22 +1,51 @@
 #include "api_client.h"
 #include "../core/logger.h"
 #include "../core/error.h"
-#include "../core/sdl_includes.h"
+#include "../core/realtime.h"
 #include <curl/curl.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <errno.h>
+#include <time.h>
+
+// One connection slot; its handle keeps a connection cache between requests
+typedef struct {
+    CURL* curl;                 // Created on first use
+    bool busy;
+} ApiSlot;
+
+typedef struct {
+    ApiSlot slots[API_CLIENT_MAX_LANE_SLOTS];
+    int slot_count;
+    atomic_uint_least64_t generation;  // Bumped to cancel everything in the lane
+} ApiLane;
 
 struct ApiClient {
-    CURL* curl;
     ApiClientConfig config;
-    pthread_mutex_t mutex;
+    struct curl_slist* headers; // Request headers shared by every handle
+    pthread_mutex_t mutex;      // Guards slots and the counters below
+    pthread_cond_t changed;     // Slot freed, interactive request done, or lane cancelled
+    ApiLane lanes[API_PRIORITY_COUNT];
+    int interactive_active;     // Interactive requests waiting or in flight
+    int active_requests;        // Requests holding or waiting for a slot
+    int async_pending;          // Async threads not yet past their callback
+    bool closing;               // Destroy started: no new transfers
 };
 
+// A request's claim on its lane, shared with the CURL progress callback
+typedef struct {
+    ApiClient* client;
+    ApiRequestPriority priority;
+    uint64_t generation;        // Lane generation when the request was queued
+} RequestTicket;
+
 // Async request data
 typedef struct {
     ApiClient* client;
+    ApiRequestPriority priority;
     HttpMethod method;
     char* url;
     char* body;
@@ -25,7 +54,8 @@ typedef struct {
 } AsyncRequest;
 
 // CURL write callback
-static size_t write_callback(void* contents, size_t size, size_t nmemb, ApiResponse* response) {
+static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userdata) {
+    ApiResponse* response = (ApiResponse*)userdata;
     size_t realsize = size * nmemb;
     
     char* new_data = realloc(response->data, response->size + realsize + 1);
@@ -45,6 +75,161 @@ static size_t write_callback(void* contents, size_t size, size_t nmemb, ApiRespo
     return realsize;
 }
 
+// Add one attempt's traffic (headers included) to the response totals
+static void account_transfer(CURL* curl, ApiResponse* response) {
+    long header_size = 0;
+    long request_size = 0;
+    curl_off_t body_down = 0;
+    curl_off_t body_up = 0;
+    
+    curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &header_size);
+    curl_easy_getinfo(curl, CURLINFO_REQUEST_SIZE, &request_size);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &body_down);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &body_up);
+    
+    // REQUEST_SIZE already counts a POSTFIELDS body; UPLOAD covers streamed ones
+    response->bytes_sent += (uint64_t)(request_size > 0 ? request_size : 0);
+    if (body_up > request_size) {
+        response->bytes_sent += (uint64_t)(body_up - request_size);
+    }
+    response->bytes_received += (uint64_t)(header_size > 0 ? header_size : 0) +
+                                (uint64_t)(body_down > 0 ? body_down : 0);
+}
+
+// Lanes and preemption
+
+static bool ticket_cancelled(const RequestTicket* ticket) {
+    return atomic_load(&ticket->client->lanes[ticket->priority].generation) !=
+           ticket->generation;
+}
+
+// CURL progress callback: a non-zero return aborts the transfer
+static int progress_callback(void* clientp, curl_off_t dltotal, curl_off_t dlnow,
+                             curl_off_t ultotal, curl_off_t ulnow) {
+    (void)dltotal; (void)dlnow; (void)ultotal; (void)ulnow;
+    return ticket_cancelled((const RequestTicket*)clientp) ? 1 : 0;
+}
+
+// Background lanes hold off while the user is waiting; caller holds mutex
+static bool lane_yields_locked(const ApiClient* client, ApiRequestPriority priority) {
+    return priority != API_PRIORITY_INTERACTIVE && client->interactive_active > 0;
+}
+
+// Cancel a lane's waiting and in-flight requests; caller holds mutex
+static void cancel_lane_locked(ApiClient* client, ApiRequestPriority priority) {
+    atomic_fetch_add(&client->lanes[priority].generation, 1);
+    pthread_cond_broadcast(&client->changed);
+}
+
+static void deadline_after_ms(struct timespec* deadline, int ms) {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += ms / 1000;
+    deadline->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+// Create a slot's handle with the client-wide options
+static CURL* slot_create_handle(ApiClient* client) {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        return NULL;
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);  // Several handles time out concurrently
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)client->config.timeout_seconds);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, (long)client->config.connect_timeout_seconds);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, client->config.follow_redirects ? 1L : 0L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, (long)client->config.max_redirects);
+    if (client->config.user_agent) {
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, client->config.user_agent);
+    }
+    if (client->headers) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, client->headers);
+    }
+    return curl;
+}
+
+// Wait for a free slot in the ticket's lane; NULL if cancelled
+static ApiSlot* acquire_slot(RequestTicket* ticket) {
+    ApiClient* client = ticket->client;
+    ApiLane* lane = &client->lanes[ticket->priority];
+    
+    pthread_mutex_lock(&client->mutex);
+    
+    ticket->generation = atomic_load(&lane->generation);
+    client->active_requests++;
+    if (ticket->priority == API_PRIORITY_INTERACTIVE) {
+        // The user is waiting: speculative and telemetry work gives way
+        client->interactive_active++;
+        cancel_lane_locked(client, API_PRIORITY_PREFETCH);
+        cancel_lane_locked(client, API_PRIORITY_TELEMETRY);
+    }
+    
+    ApiSlot* slot = NULL;
+    while (!slot && !ticket_cancelled(ticket) && !client->closing) {
+        if (!lane_yields_locked(client, ticket->priority)) {
+            for (int i = 0; i < lane->slot_count; i++) {
+                if (!lane->slots[i].busy) {
+                    slot = &lane->slots[i];
+                    slot->busy = true;
+                    break;
+                }
+            }
+        }
+        if (!slot) {
+            pthread_cond_wait(&client->changed, &client->mutex);
+        }
+    }
+    
+    pthread_mutex_unlock(&client->mutex);
+    return slot;
+}
+
+// Release a slot (may be NULL) and the ticket's claim on the client
+static void release_slot(RequestTicket* ticket, ApiSlot* slot) {
+    ApiClient* client = ticket->client;
+    
+    pthread_mutex_lock(&client->mutex);
+    if (slot) {
+        slot->busy = false;
+    }
+    if (ticket->priority == API_PRIORITY_INTERACTIVE) {
+        client->interactive_active--;
+    }
+    client->active_requests--;
+    pthread_cond_broadcast(&client->changed);
+    pthread_mutex_unlock(&client->mutex);
+}
+
+// Retry backoff that ends early on cancellation and, for background
+// lanes, is extended until no interactive request is in flight.
+// Returns false if the request was cancelled.
+static bool backoff_wait(RequestTicket* ticket, int backoff_ms) {
+    ApiClient* client = ticket->client;
+    struct timespec deadline;
+    deadline_after_ms(&deadline, backoff_ms);
+    bool expired = false;
+    
+    pthread_mutex_lock(&client->mutex);
+    while (!ticket_cancelled(ticket) &&
+           (!expired || lane_yields_locked(client, ticket->priority))) {
+        if (expired) {
+            pthread_cond_wait(&client->changed, &client->mutex);
+        } else {
+            expired = pthread_cond_timedwait(&client->changed, &client->mutex,
+                                             &deadline) == ETIMEDOUT;
+        }
+    }
+    bool cancelled = ticket_cancelled(ticket);
+    pthread_mutex_unlock(&client->mutex);
+    return !cancelled;
+}
+
 ApiClient* api_client_create(const ApiClientConfig* config) {
     ApiClient* client = calloc(1, sizeof(ApiClient));
     if (!client) {
@@ -54,16 +239,6 @@ ApiClient* api_client_create(const ApiClientConfig* config) {
         return NULL;
     }
     
-    // Initialize CURL
-    client->curl = curl_easy_init();
-    if (!client->curl) {
-        log_error("Failed to initialize CURL");
-        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
-            "api_client_create: curl_easy_init failed");
-        free(client);
-        return NULL;
-    }
-    
     // Copy configuration
     if (config) {
         client->config = *config;
@@ -71,28 +246,68 @@ ApiClient* api_client_create(const ApiClientConfig* config) {
         client->config = api_client_default_config();
     }
     
-    // Initialize mutex
+    // Initialize mutex and condition (monotonic clock for backoff waits)
     if (pthread_mutex_init(&client->mutex, NULL) != 0) {
         log_error("Failed to initialize mutex");
         pk_set_last_error_with_context(PK_ERROR_SYSTEM,
             "api_client_create: pthread_mutex_init failed");
-        curl_easy_cleanup(client->curl);
         free(client);
         return NULL;
     }
     
-    // Set basic CURL options
-    curl_easy_setopt(client->curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(client->curl, CURLOPT_TIMEOUT, (long)client->config.timeout_seconds);
-    curl_easy_setopt(client->curl, CURLOPT_CONNECTTIMEOUT, (long)client->config.connect_timeout_seconds);
-    curl_easy_setopt(client->curl, CURLOPT_FOLLOWLOCATION, client->config.follow_redirects ? 1L : 0L);
-    curl_easy_setopt(client->curl, CURLOPT_MAXREDIRS, (long)client->config.max_redirects);
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    int cond_result = pthread_cond_init(&client->changed, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    if (cond_result != 0) {
+        log_error("Failed to initialize condition variable");
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "api_client_create: pthread_cond_init failed");
+        pthread_mutex_destroy(&client->mutex);
+        free(client);
+        return NULL;
+    }
     
-    if (client->config.user_agent) {
-        curl_easy_setopt(client->curl, CURLOPT_USERAGENT, client->config.user_agent);
+    // Content negotiation; the list is copied, so config.accept need not outlive us
+    if (client->config.accept) {
+        char accept_header[256];
+        snprintf(accept_header, sizeof(accept_header), "Accept: %s", client->config.accept);
+        client->headers = curl_slist_append(NULL, accept_header);
+        if (!client->headers) {
+            log_error("Failed to allocate API client headers");
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                "api_client_create: curl_slist_append failed");
+            pthread_cond_destroy(&client->changed);
+            pthread_mutex_destroy(&client->mutex);
+            free(client);
+            return NULL;
+        }
+        client->config.accept = NULL;  // Borrowed; the header list owns a copy
     }
     
-    log_info("API client initialized with %ds timeout", client->config.timeout_seconds);
+    // Size the lanes; handles are created when a slot is first used
+    for (int p = 0; p < API_PRIORITY_COUNT; p++) {
+        int slots = client->config.lane_slots[p];
+        if (slots <= 0) {
+            slots = 1;
+        } else if (slots > API_CLIENT_MAX_LANE_SLOTS) {
+            log_warn("API client %s lane limited to %d slots (requested %d)",
+                     api_priority_string((ApiRequestPriority)p),
+                     API_CLIENT_MAX_LANE_SLOTS, slots);
+            slots = API_CLIENT_MAX_LANE_SLOTS;
+        }
+        client->lanes[p].slot_count = slots;
+        atomic_init(&client->lanes[p].generation, 0);
+    }
+    
+    log_info("API client initialized with %ds timeout, slots %d/%d/%d/%d "
+             "(interactive/scheduled/prefetch/telemetry)",
+             client->config.timeout_seconds,
+             client->lanes[API_PRIORITY_INTERACTIVE].slot_count,
+             client->lanes[API_PRIORITY_SCHEDULED].slot_count,
+             client->lanes[API_PRIORITY_PREFETCH].slot_count,
+             client->lanes[API_PRIORITY_TELEMETRY].slot_count);
     return client;
 }
 
@@ -101,59 +316,130 @@ void api_client_destroy(ApiClient* client) {
         return;
     }
     
+    // Cancel everything and wait for requests to leave their slots and
+    // for async callbacks, which may still use the client's owner
     pthread_mutex_lock(&client->mutex);
+    client->closing = true;
+    for (int p = 0; p < API_PRIORITY_COUNT; p++) {
+        cancel_lane_locked(client, (ApiRequestPriority)p);
+    }
+    while (client->active_requests > 0 || client->async_pending > 0) {
+        pthread_cond_wait(&client->changed, &client->mutex);
+    }
+    pthread_mutex_unlock(&client->mutex);
     
-    if (client->curl) {
-        curl_easy_cleanup(client->curl);
+    for (int p = 0; p < API_PRIORITY_COUNT; p++) {
+        for (int i = 0; i < client->lanes[p].slot_count; i++) {
+            if (client->lanes[p].slots[i].curl) {
+                curl_easy_cleanup(client->lanes[p].slots[i].curl);
+            }
+        }
     }
     
-    pthread_mutex_unlock(&client->mutex);
+    curl_slist_free_all(client->headers);
+    pthread_cond_destroy(&client->changed);
     pthread_mutex_destroy(&client->mutex);
     
     free(client);
     log_debug("API client destroyed");
 }
 
+void api_client_cancel(ApiClient* client, ApiRequestPriority priority) {
+    if (!client || priority < 0 || priority >= API_PRIORITY_COUNT) {
+        return;
+    }
+    
+    pthread_mutex_lock(&client->mutex);
+    cancel_lane_locked(client, priority);
+    pthread_mutex_unlock(&client->mutex);
+    
+    log_debug("Cancelled %s API requests", api_priority_string(priority));
+}
+
 ApiClientError api_client_request(ApiClient* client,
                                   HttpMethod method,
                                   const char* url,
                                   const char* body,
                                   ApiResponse* response) {
+    return api_client_request_priority(client, API_PRIORITY_SCHEDULED,
+                                       method, url, body, response);
+}
+
+// Record a cancellation in the response
+static ApiClientError cancelled_result(ApiResponse* response, const RequestTicket* ticket,
+                                       const char* url) {
+    free(response->error_message);
+    response->error_message = strdup("Cancelled");
+    response->error = API_CLIENT_ERROR_CANCELLED;
+    log_debug("%s API request cancelled: %s", api_priority_string(ticket->priority), url);
+    return API_CLIENT_ERROR_CANCELLED;
+}
+
+ApiClientError api_client_request_priority(ApiClient* client,
+                                           ApiRequestPriority priority,
+                                           HttpMethod method,
+                                           const char* url,
+                                           const char* body,
+                                           ApiResponse* response) {
     if (!client || !url || !response) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
             "api_client_request: client=%p, url=%p, response=%p",
             (void*)client, (void*)url, (void*)response);
         return API_CLIENT_ERROR_INVALID_URL;
     }
-    
-    pthread_mutex_lock(&client->mutex);
+    if (priority < 0 || priority >= API_PRIORITY_COUNT) {
+        priority = API_PRIORITY_SCHEDULED;
+    }
     
     // Initialize response
     api_response_init(response);
     
+    RequestTicket ticket = { client, priority, 0 };
+    ApiSlot* slot = acquire_slot(&ticket);
+    if (!slot) {
+        ApiClientError result = cancelled_result(response, &ticket, url);
+        release_slot(&ticket, NULL);
+        return result;
+    }
+    
+    if (!slot->curl) {
+        slot->curl = slot_create_handle(client);
+        if (!slot->curl) {
+            log_error("Failed to initialize CURL");
+            pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                "api_client_request: curl_easy_init failed");
+            response->error = API_CLIENT_ERROR_INIT;
+            release_slot(&ticket, slot);
+            return API_CLIENT_ERROR_INIT;
+        }
+    }
+    CURL* curl = slot->curl;
+    
     // Set URL
-    curl_easy_setopt(client->curl, CURLOPT_URL, url);
-    curl_easy_setopt(client->curl, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &ticket);
     
-    // Set HTTP method
+    // Set HTTP method (the handle is reused, so clear any custom verb)
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, NULL);
     switch (method) {
         case HTTP_METHOD_GET:
-            curl_easy_setopt(client->curl, CURLOPT_HTTPGET, 1L);
+            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
             break;
         case HTTP_METHOD_POST:
-            curl_easy_setopt(client->curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
             if (body) {
-                curl_easy_setopt(client->curl, CURLOPT_POSTFIELDS, body);
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
             }
             break;
         case HTTP_METHOD_PUT:
-            curl_easy_setopt(client->curl, CURLOPT_CUSTOMREQUEST, "PUT");
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
             if (body) {
-                curl_easy_setopt(client->curl, CURLOPT_POSTFIELDS, body);
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
             }
             break;
         case HTTP_METHOD_DELETE:
-            curl_easy_setopt(client->curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
             break;
     }
     
@@ -175,11 +461,16 @@ ApiClientError api_client_request(ApiClient* client,
                 free(response->error_message);
                 response->error_message = NULL;
             }
+            free(response->content_type);
+            response->content_type = NULL;
             
             // Wait with backoff
             log_info("Retrying API request (attempt %d/%d) after %dms backoff...", 
                      attempt, max_attempts, backoff_ms);
-            SDL_Delay(backoff_ms);
+            if (!backoff_wait(&ticket, backoff_ms)) {
+                result = API_CLIENT_ERROR_CANCELLED;
+                break;
+            }
             
             // Calculate next backoff (exponential with max limit)
             backoff_ms = (int)(backoff_ms * client->config.backoff_multiplier);
@@ -189,14 +480,28 @@ ApiClientError api_client_request(ApiClient* client,
         }
         
         // Perform request
-        curl_result = curl_easy_perform(client->curl);
+        curl_result = curl_easy_perform(curl);
         
         // Get HTTP response code
-        curl_easy_getinfo(client->curl, CURLINFO_RESPONSE_CODE, &response->http_code);
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->http_code);
+        
+        // Failed and aborted attempts still used the link
+        account_transfer(curl, response);
         
+        // Parsers are chosen by media type; the string is owned by the handle
         if (curl_result == CURLE_OK) {
-            // Check if HTTP response indicates success or permanent failure
-            if (response->http_code >= 200 && response->http_code < 300) {
+            char* content_type = NULL;
+            curl_easy_getinfo(curl, CURLINFO_CONTENT_TYPE, &content_type);
+            if (content_type) {
+                response->content_type = strdup(content_type);
+            }
+        }
+        
+        if (curl_result == CURLE_OK) {
+            // Check if HTTP response indicates success or permanent failure.
+            // Non-HTTP schemes (file://) report code 0 on a completed transfer.
+            if (response->http_code == 0 ||
+                (response->http_code >= 200 && response->http_code < 300)) {
                 result = API_CLIENT_SUCCESS;
                 break;  // Success - no need to retry
             } else if (response->http_code >= 400 && response->http_code < 500 &&
@@ -208,6 +513,10 @@ ApiClientError api_client_request(ApiClient* client,
             }
             // Server errors (5xx) and 429 - continue retry loop
             result = API_CLIENT_ERROR_NETWORK;
+        } else if (curl_result == CURLE_ABORTED_BY_CALLBACK) {
+            // Preempted or cancelled from another thread
+            result = API_CLIENT_ERROR_CANCELLED;
+            break;
         } else {
             // CURL error - check if retryable
             switch (curl_result) {
@@ -251,8 +560,11 @@ ApiClientError api_client_request(ApiClient* client,
         }
     }
     
-    // Log final result
-    if (result == API_CLIENT_SUCCESS) {
+    // Log final result (before releasing: destroy waits for the release)
+    response->error = result;
+    if (result == API_CLIENT_ERROR_CANCELLED) {
+        cancelled_result(response, &ticket, url);
+    } else if (result == API_CLIENT_SUCCESS) {
         log_debug("API request successful: %s -> %ld (%zu bytes)", 
                  url, response->http_code, response->size);
     } else {
@@ -260,7 +572,7 @@ ApiClientError api_client_request(ApiClient* client,
                  max_attempts, response->error_message ? response->error_message : "Unknown error");
     }
     
-    pthread_mutex_unlock(&client->mutex);
+    release_slot(&ticket, slot);
     return result;
 }
 
@@ -268,14 +580,24 @@ ApiClientError api_client_request(ApiClient* client,
 static void* async_request_thread(void* arg) {
     AsyncRequest* req = (AsyncRequest*)arg;
     
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+    
     ApiResponse response;
-    ApiClientError error = api_client_request(req->client, req->method, req->url, req->body, &response);
+    api_client_request_priority(req->client, req->priority, req->method,
+                                req->url, req->body, &response);
     
     // Call callback with result
     if (req->callback) {
         req->callback(&response, req->user_data);
     }
     
+    // Last use of the client: destroy may proceed after this
+    ApiClient* client = req->client;
+    pthread_mutex_lock(&client->mutex);
+    client->async_pending--;
+    pthread_cond_broadcast(&client->changed);
+    pthread_mutex_unlock(&client->mutex);
+    
     // Cleanup
     api_response_cleanup(&response);
     free(req->url);
@@ -291,6 +613,17 @@ ApiClientError api_client_request_async(ApiClient* client,
                                          const char* body,
                                          api_client_callback callback,
                                          void* user_data) {
+    return api_client_request_async_priority(client, API_PRIORITY_SCHEDULED, method,
+                                             url, body, callback, user_data);
+}
+
+ApiClientError api_client_request_async_priority(ApiClient* client,
+                                                  ApiRequestPriority priority,
+                                                  HttpMethod method,
+                                                  const char* url,
+                                                  const char* body,
+                                                  api_client_callback callback,
+                                                  void* user_data) {
     if (!client || !url) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
             "api_client_request_async: client=%p, url=%p",
@@ -308,6 +641,7 @@ ApiClientError api_client_request_async(ApiClient* client,
     }
     
     req->client = client;
+    req->priority = priority;
     req->method = method;
     req->url = malloc(strlen(url) + 1);
     req->body = body ? malloc(strlen(body) + 1) : NULL;
@@ -328,9 +662,17 @@ ApiClientError api_client_request_async(ApiClient* client,
         strcpy(req->body, body);
     }
     
-    // Create thread
+    // Create thread (counted before it exists so destroy cannot miss it)
+    pthread_mutex_lock(&client->mutex);
+    client->async_pending++;
+    pthread_mutex_unlock(&client->mutex);
+    
     pthread_t thread;
     if (pthread_create(&thread, NULL, async_request_thread, req) != 0) {
+        pthread_mutex_lock(&client->mutex);
+        client->async_pending--;
+        pthread_cond_broadcast(&client->changed);
+        pthread_mutex_unlock(&client->mutex);
         log_error("Failed to create async request thread");
         pk_set_last_error_with_context(PK_ERROR_SYSTEM,
             "api_client_request_async: pthread_create failed for URL %s", url);
@@ -343,7 +685,7 @@ ApiClientError api_client_request_async(ApiClient* client,
     // Detach thread so it cleans up automatically
     pthread_detach(thread);
     
-    log_debug("Async request started: %s", url);
+    log_debug("Async %s request started: %s", api_priority_string(priority), url);
     return API_CLIENT_SUCCESS;
 }
 
@@ -361,6 +703,7 @@ void api_response_cleanup(ApiResponse* response) {
     if (response) {
         free(response->data);
         free(response->error_message);
+        free(response->content_type);
         memset(response, 0, sizeof(ApiResponse));
     }
 }
@@ -379,6 +722,8 @@ const char* api_client_error_string(ApiClientError error) {
             return "Memory allocation error";
         case API_CLIENT_ERROR_INVALID_URL:
             return "Invalid URL";
+        case API_CLIENT_ERROR_CANCELLED:
+            return "Cancelled";
         default:
             return "Unknown error";
     }
@@ -399,6 +744,21 @@ const char* http_method_string(HttpMethod method) {
     }
 }
 
+const char* api_priority_string(ApiRequestPriority priority) {
+    switch (priority) {
+        case API_PRIORITY_INTERACTIVE:
+            return "interactive";
+        case API_PRIORITY_SCHEDULED:
+            return "scheduled";
+        case API_PRIORITY_PREFETCH:
+            return "prefetch";
+        case API_PRIORITY_TELEMETRY:
+            return "telemetry";
+        default:
+            return "unknown";
+    }
+}
+
 ApiClientConfig api_client_default_config(void) {
     ApiClientConfig config = {
         .timeout_seconds = 10,
@@ -411,7 +771,10 @@ ApiClientConfig api_client_default_config(void) {
         .max_retries = 3,
         .initial_backoff_ms = 100,
         .max_backoff_ms = 5000,
-        .backoff_multiplier = 2.0f
+        .backoff_multiplier = 2.0f,
+        
+        // One slot per lane: interactive never queues behind background work
+        .lane_slots = {1, 1, 1, 1}
     };
     return config;
 }
\ No newline at end of file
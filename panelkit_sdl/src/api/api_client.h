@@ -4,6 +4,11 @@
  * 
  * Provides HTTP request/response handling with connection pooling,
  * timeout management, and retry capabilities.
+ *
+ * Requests run in priority lanes, each with its own connection slots, so
+ * a slow background poll never holds up a user-initiated request. While
+ * an interactive request is in flight, prefetch and telemetry transfers
+ * are aborted and background requests hold off starting or retrying.
  */
 
 #ifndef API_CLIENT_H
@@ -11,6 +16,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // Forward declarations
 typedef struct ApiClient ApiClient;
@@ -31,9 +37,21 @@ typedef enum {
     API_CLIENT_ERROR_NETWORK = -2,
     API_CLIENT_ERROR_TIMEOUT = -3,
     API_CLIENT_ERROR_MEMORY = -4,
-    API_CLIENT_ERROR_INVALID_URL = -5
+    API_CLIENT_ERROR_INVALID_URL = -5,
+    API_CLIENT_ERROR_CANCELLED = -6
 } ApiClientError;
 
+// Request priorities, highest first. Each has its own lane of slots.
+typedef enum {
+    API_PRIORITY_INTERACTIVE,   // User is waiting (refresh button)
+    API_PRIORITY_SCHEDULED,     // Periodic polls; yields to interactive
+    API_PRIORITY_PREFETCH,      // Speculative; aborted by interactive
+    API_PRIORITY_TELEMETRY,     // Fire-and-forget; aborted by interactive
+    API_PRIORITY_COUNT
+} ApiRequestPriority;
+
+#define API_CLIENT_MAX_LANE_SLOTS 4
+
 // Configuration
 typedef struct {
     int timeout_seconds;        // Request timeout
@@ -41,12 +59,16 @@ typedef struct {
     bool follow_redirects;      // Follow HTTP redirects
     int max_redirects;          // Maximum number of redirects
     const char* user_agent;     // User-Agent header
+    const char* accept;         // Accept header for content negotiation (NULL = none)
     
     // Retry configuration
     int max_retries;            // Maximum retry attempts (0 = no retry)
     int initial_backoff_ms;     // Initial backoff in milliseconds
     int max_backoff_ms;         // Maximum backoff in milliseconds
     float backoff_multiplier;   // Backoff multiplier (e.g., 2.0 for exponential)
+    
+    // Concurrent requests per priority lane (0 = default of 1, max 4)
+    int lane_slots[API_PRIORITY_COUNT];
 } ApiClientConfig;
 
 // Response structure
@@ -55,23 +77,27 @@ struct ApiResponse {
     size_t size;                // Response size
     long http_code;             // HTTP status code
     char* error_message;        // Error message if any
+    char* content_type;         // Response Content-Type, NULL if the server sent none
+    ApiClientError error;       // Outcome (lets async callbacks spot cancellation)
+    uint64_t bytes_sent;        // Request headers and body, all attempts
+    uint64_t bytes_received;    // Response headers and body, all attempts
 };
 
 // Request completion callback
 typedef void (*api_client_callback)(ApiResponse* response, void* user_data);
 
-// Create/destroy client
+// Create/destroy client (destroy cancels requests and waits for async callbacks)
 ApiClient* api_client_create(const ApiClientConfig* config);
 void api_client_destroy(ApiClient* client);
 
-// Synchronous requests
+// Synchronous requests (scheduled priority)
 ApiClientError api_client_request(ApiClient* client, 
                                   HttpMethod method,
                                   const char* url,
                                   const char* body,
                                   ApiResponse* response);
 
-// Asynchronous requests (threaded)
+// Asynchronous requests (threaded, scheduled priority)
 ApiClientError api_client_request_async(ApiClient* client,
                                          HttpMethod method, 
                                          const char* url,
@@ -79,6 +105,27 @@ ApiClientError api_client_request_async(ApiClient* client,
                                          api_client_callback callback,
                                          void* user_data);
 
+// Requests with an explicit priority. Blocks until a slot in the lane is
+// free; returns API_CLIENT_ERROR_CANCELLED if cancelled or preempted.
+ApiClientError api_client_request_priority(ApiClient* client,
+                                           ApiRequestPriority priority,
+                                           HttpMethod method,
+                                           const char* url,
+                                           const char* body,
+                                           ApiResponse* response);
+
+ApiClientError api_client_request_async_priority(ApiClient* client,
+                                                  ApiRequestPriority priority,
+                                                  HttpMethod method,
+                                                  const char* url,
+                                                  const char* body,
+                                                  api_client_callback callback,
+                                                  void* user_data);
+
+// Cancel all waiting and in-flight requests in one lane. Transfers abort
+// at their next progress check (within about a second).
+void api_client_cancel(ApiClient* client, ApiRequestPriority priority);
+
 // Response management
 void api_response_init(ApiResponse* response);
 void api_response_cleanup(ApiResponse* response);
@@ -86,6 +133,7 @@ void api_response_cleanup(ApiResponse* response);
 // Utility functions
 const char* api_client_error_string(ApiClientError error);
 const char* http_method_string(HttpMethod method);
+const char* api_priority_string(ApiRequestPriority priority);
 
 // Default configuration
 ApiClientConfig api_client_default_config(void);
@@ -1,6 +1,6 @@
 #include "api_manager.h"
 #include "api_client.h"
-#include "../json/json_parser.h"
+#include "api_parsers.h"
 #include "../core/logger.h"
 #include "../core/error.h"
 #include <stdlib.h>
@@ -8,6 +8,10 @@
 #include <stdio.h>
 #include <pthread.h>
 
+// Parser registry keys for the user profile endpoint
+#define USER_SERVICE_ID "randomuser"
+#define USER_ENDPOINT_ID "get_user"
+
 struct ApiManager {
     ApiClient* client;
     ApiManagerConfig config;
@@ -22,6 +26,11 @@ struct ApiManager {
     bool auto_refresh_enabled;
     uint32_t last_refresh_time;
     
+    // Metered link accounting (optional)
+    BandwidthBudget* budget;
+    char budget_service[48];
+    char budget_endpoint[48];
+    
     // Callbacks
     api_data_callback data_callback;
     void* data_context;
@@ -35,10 +44,11 @@ struct ApiManager {
 };
 
 // Internal functions
+static void record_traffic(ApiManager* manager, const ApiResponse* response);
 static void set_state(ApiManager* manager, ApiState new_state);
 static void set_error(ApiManager* manager, ApiError error, const char* message);
 static void handle_api_response(ApiResponse* response, void* user_data);
-static bool parse_user_data(const char* json_data, UserData* user_data);
+static bool parse_user_data(const ApiResponse* response, UserData* user_data);
 
 ApiManager* api_manager_create(const ApiManagerConfig* config) {
     PK_CHECK_NULL_WITH_CONTEXT(config != NULL, PK_ERROR_NULL_PARAM,
@@ -61,6 +71,13 @@ ApiManager* api_manager_create(const ApiManagerConfig* config) {
         manager->config = api_manager_default_config();
     }
     
+    // Response parsers (built-ins register on first init)
+    if (!api_parsers_init()) {
+        log_error("Failed to initialize API parsers");
+        free(manager);
+        return NULL;
+    }
+    
     // Initialize mutex
     if (pthread_mutex_init(&manager->mutex, NULL) != 0) {
         log_error("Failed to initialize API manager mutex");
@@ -69,13 +86,11 @@ ApiManager* api_manager_create(const ApiManagerConfig* config) {
     }
     
     // Create API client
-    ApiClientConfig client_config = {
-        .timeout_seconds = manager->config.timeout_seconds,
-        .connect_timeout_seconds = 5,
-        .follow_redirects = true,
-        .max_redirects = 3,
-        .user_agent = "PanelKit/1.0"
-    };
+    ApiClientConfig client_config = api_client_default_config();
+    client_config.timeout_seconds = manager->config.timeout_seconds;
+    client_config.max_retries = manager->config.retry_count;
+    client_config.initial_backoff_ms = manager->config.retry_delay_ms;
+    client_config.accept = manager->config.accept;
     
     manager->client = api_client_create(&client_config);
     if (!manager->client) {
@@ -99,13 +114,12 @@ void api_manager_destroy(ApiManager* manager) {
         return;
     }
     
-    pthread_mutex_lock(&manager->mutex);
-    
+    // Not under the mutex: destroy waits for in-flight response
+    // callbacks, and those take it
     if (manager->client) {
         api_client_destroy(manager->client);
     }
     
-    pthread_mutex_unlock(&manager->mutex);
     pthread_mutex_destroy(&manager->mutex);
     
     free(manager);
@@ -154,8 +168,7 @@ bool api_manager_fetch_user_async(ApiManager* manager) {
     
     set_state(manager, API_STATE_LOADING);
     
-    // Build URL - for now using randomuser.me as in original
-    const char* url = "https://randomuser.me/api/";
+    const char* url = manager->config.base_url;
     
     pthread_mutex_unlock(&manager->mutex);
     
@@ -189,13 +202,23 @@ bool api_manager_fetch_user(ApiManager* manager) {
     
     set_state(manager, API_STATE_LOADING);
     
-    const char* url = "https://randomuser.me/api/";
+    const char* url = manager->config.base_url;
     
     pthread_mutex_unlock(&manager->mutex);
     
     ApiResponse response;
     ApiClientError result = api_client_request(manager->client, HTTP_METHOD_GET, url, NULL, &response);
     
+    if (result != API_CLIENT_SUCCESS) {
+        record_traffic(manager, &response);
+    }
+    
+    if (result == API_CLIENT_ERROR_CANCELLED) {
+        // Superseded by api_manager_refresh_now(), which now owns the state
+        api_response_cleanup(&response);
+        return false;
+    }
+    
     if (result != API_CLIENT_SUCCESS) {
         pthread_mutex_lock(&manager->mutex);
         set_error(manager, API_ERROR_NETWORK, api_client_error_string(result));
@@ -212,6 +235,52 @@ bool api_manager_fetch_user(ApiManager* manager) {
     return true;
 }
 
+bool api_manager_refresh_now(ApiManager* manager) {
+    if (!manager) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&manager->mutex);
+    if (manager->state != API_STATE_LOADING) {
+        set_state(manager, API_STATE_LOADING);
+    }
+    const char* url = manager->config.base_url;
+    pthread_mutex_unlock(&manager->mutex);
+    
+    // A background fetch of the same data would only arrive later; drop it
+    api_client_cancel(manager->client, API_PRIORITY_SCHEDULED);
+    
+    ApiClientError result = api_client_request_async_priority(manager->client,
+                                                              API_PRIORITY_INTERACTIVE,
+                                                              HTTP_METHOD_GET, url, NULL,
+                                                              handle_api_response, manager);
+    if (result != API_CLIENT_SUCCESS) {
+        pthread_mutex_lock(&manager->mutex);
+        set_error(manager, API_ERROR_NETWORK, api_client_error_string(result));
+        set_state(manager, API_STATE_ERROR);
+        pthread_mutex_unlock(&manager->mutex);
+        return false;
+    }
+    
+    log_debug("Interactive user data refresh initiated");
+    return true;
+}
+
+void api_manager_set_bandwidth_budget(ApiManager* manager, BandwidthBudget* budget,
+                                      const char* service_id, const char* endpoint_id) {
+    if (!manager || (budget && (!service_id || !endpoint_id))) {
+        return;
+    }
+    
+    pthread_mutex_lock(&manager->mutex);
+    manager->budget = budget;
+    if (budget) {
+        snprintf(manager->budget_service, sizeof(manager->budget_service), "%s", service_id);
+        snprintf(manager->budget_endpoint, sizeof(manager->budget_endpoint), "%s", endpoint_id);
+    }
+    pthread_mutex_unlock(&manager->mutex);
+}
+
 void api_manager_update(ApiManager* manager, uint32_t current_time_ms) {
     if (!manager) {
         return;
@@ -219,11 +288,19 @@ void api_manager_update(ApiManager* manager, uint32_t current_time_ms) {
     
     pthread_mutex_lock(&manager->mutex);
     
+    uint32_t interval_ms = (uint32_t)manager->config.refresh_interval_ms;
+    if (manager->budget) {
+        interval_ms = bandwidth_budget_scale_interval(manager->budget, manager->budget_service,
+                                                      manager->budget_endpoint, interval_ms);
+    }
+    
     // Check for auto-refresh
     if (manager->auto_refresh_enabled && 
         manager->state == API_STATE_SUCCESS &&
-        (current_time_ms - manager->last_refresh_time) >= (uint32_t)manager->config.refresh_interval_ms) {
+        interval_ms != BANDWIDTH_BUDGET_PAUSED &&
+        (current_time_ms - manager->last_refresh_time) >= interval_ms) {
         
+        manager->last_refresh_time = current_time_ms;
         pthread_mutex_unlock(&manager->mutex);
         api_manager_fetch_user_async(manager);
         return;
@@ -280,6 +357,24 @@ const char* api_manager_get_error_message(ApiManager* manager) {
     return message;
 }
 
+void api_manager_cancel_requests(ApiManager* manager) {
+    if (!manager) {
+        return;
+    }
+    
+    for (int p = 0; p < API_PRIORITY_COUNT; p++) {
+        api_client_cancel(manager->client, (ApiRequestPriority)p);
+    }
+    
+    // Cancelled responses are ignored, so nothing else leaves LOADING
+    pthread_mutex_lock(&manager->mutex);
+    if (manager->state == API_STATE_LOADING) {
+        set_state(manager, API_STATE_IDLE);
+    }
+    pthread_mutex_unlock(&manager->mutex);
+    log_debug("Cancelled all API requests");
+}
+
 void api_manager_set_auto_refresh(ApiManager* manager, bool enabled) {
     if (!manager) {
         return;
@@ -293,6 +388,15 @@ void api_manager_set_auto_refresh(ApiManager* manager, bool enabled) {
 }
 
 // Internal helper functions
+static void record_traffic(ApiManager* manager, const ApiResponse* response) {
+    pthread_mutex_lock(&manager->mutex);
+    if (manager->budget) {
+        bandwidth_budget_record(manager->budget, manager->budget_service, manager->budget_endpoint,
+                                response->bytes_sent + response->bytes_received);
+    }
+    pthread_mutex_unlock(&manager->mutex);
+}
+
 static void set_state(ApiManager* manager, ApiState new_state) {
     ApiState old_state = manager->state;
     manager->state = new_state;
@@ -326,6 +430,15 @@ static void set_error(ApiManager* manager, ApiError error, const char* message)
 static void handle_api_response(ApiResponse* response, void* user_data) {
     ApiManager* manager = (ApiManager*)user_data;
     
+    // Cancelled and failed transfers still count against the budget
+    record_traffic(manager, response);
+    
+    if (response->error == API_CLIENT_ERROR_CANCELLED) {
+        // Superseded by an interactive refresh that will report instead
+        log_debug("Cancelled API response ignored");
+        return;
+    }
+    
     pthread_mutex_lock(&manager->mutex);
     
     if (response->http_code != 200) {
@@ -344,7 +457,7 @@ static void handle_api_response(ApiResponse* response, void* user_data) {
     
     // Parse user data
     UserData new_user_data = {0};
-    if (!parse_user_data(response->data, &new_user_data)) {
+    if (!parse_user_data(response, &new_user_data)) {
         set_error(manager, API_ERROR_PARSE, "Failed to parse user data");
         set_state(manager, API_STATE_ERROR);
         pthread_mutex_unlock(&manager->mutex);
@@ -354,7 +467,6 @@ static void handle_api_response(ApiResponse* response, void* user_data) {
     // Update stored data
     manager->user_data = new_user_data;
     manager->user_data.is_valid = true;
-    manager->last_refresh_time = 0; // Will be updated by caller
     
     set_state(manager, API_STATE_SUCCESS);
     
@@ -368,150 +480,17 @@ static void handle_api_response(ApiResponse* response, void* user_data) {
     log_info("User data updated: %s", manager->user_data.name);
 }
 
-static bool parse_user_data(const char* json_data, UserData* user_data) {
-    JsonParser* parser = json_parser_create();
-    if (!parser) {
-        log_error("Failed to create JSON parser");
-        return false;
-    }
-    
-    JsonError error = json_parser_parse(parser, json_data, strlen(json_data));
-    if (error != JSON_SUCCESS) {
-        log_error("JSON parsing failed: %s", json_error_string(error));
-        json_parser_destroy(parser);
-        return false;
-    }
-    
-    JsonValue* root = json_parser_get_root(parser);
-    if (!root) {
-        log_error("No JSON root object");
-        json_parser_destroy(parser);
-        return false;
-    }
-    
-    // Get results array
-    JsonValue* results = json_object_get(root, "results");
-    if (!results || json_array_size(results) == 0) {
-        log_error("No results in API response");
-        json_parser_destroy(parser);
-        return false;
-    }
-    
-    // Get first user
-    JsonValue* user = json_array_get(results, 0);
-    if (!user) {
-        log_error("No user data in results");
-        json_parser_destroy(parser);
+// Pick the registered parser for the body's Content-Type
+static bool parse_user_data(const ApiResponse* response, UserData* user_data) {
+    ApiPayloadFormat format = api_payload_format_from_content_type(response->content_type);
+    api_parser_func parse = api_parsers_get_format(USER_SERVICE_ID, USER_ENDPOINT_ID, format);
+    if (!parse) {
+        log_error("No %s parser for %s:%s (Content-Type: %s)", api_payload_format_string(format),
+                  USER_SERVICE_ID, USER_ENDPOINT_ID,
+                  response->content_type ? response->content_type : "none");
         return false;
     }
-    
-    // Parse name
-    JsonValue* name_obj = json_object_get(user, "name");
-    if (name_obj) {
-        JsonValue* first = json_object_get(name_obj, "first");
-        JsonValue* last = json_object_get(name_obj, "last");
-        
-        char first_name[64] = {0};
-        char last_name[64] = {0};
-        
-        if (first) {
-            JsonError err = json_value_get_string(first, first_name, sizeof(first_name));
-            if (err != JSON_SUCCESS) {
-                log_error("Failed to parse first name: %s", json_error_string(err));
-            }
-        }
-        if (last) {
-            JsonError err = json_value_get_string(last, last_name, sizeof(last_name));
-            if (err != JSON_SUCCESS) {
-                log_error("Failed to parse last name: %s", json_error_string(err));
-            }
-        }
-        
-        snprintf(user_data->name, sizeof(user_data->name), "%s %s", first_name, last_name);
-    }
-    
-    // Parse email
-    JsonValue* email = json_object_get(user, "email");
-    if (email) {
-        JsonError err = json_value_get_string(email, user_data->email, sizeof(user_data->email));
-        if (err != JSON_SUCCESS) {
-            log_error("Failed to parse email: %s", json_error_string(err));
-        }
-    }
-    
-    // Parse location
-    JsonValue* location_obj = json_object_get(user, "location");
-    if (location_obj) {
-        JsonValue* city = json_object_get(location_obj, "city");
-        JsonValue* country = json_object_get(location_obj, "country");
-        
-        char city_name[64] = {0};
-        char country_name[64] = {0};
-        
-        if (city) {
-            JsonError err = json_value_get_string(city, city_name, sizeof(city_name));
-            if (err != JSON_SUCCESS) {
-                log_error("Failed to parse city: %s", json_error_string(err));
-            }
-        }
-        if (country) {
-            JsonError err = json_value_get_string(country, country_name, sizeof(country_name));
-            if (err != JSON_SUCCESS) {
-                log_error("Failed to parse country: %s", json_error_string(err));
-            }
-        }
-        
-        snprintf(user_data->location, sizeof(user_data->location), "%s, %s", city_name, country_name);
-    }
-    
-    // Parse phone
-    JsonValue* phone = json_object_get(user, "phone");
-    if (phone) {
-        JsonError err = json_value_get_string(phone, user_data->phone, sizeof(user_data->phone));
-        if (err != JSON_SUCCESS) {
-            log_error("Failed to parse phone: %s", json_error_string(err));
-        }
-    }
-    
-    // Parse nationality
-    JsonValue* nat = json_object_get(user, "nat");
-    if (nat) {
-        JsonError err = json_value_get_string(nat, user_data->nationality, sizeof(user_data->nationality));
-        if (err != JSON_SUCCESS) {
-            log_error("Failed to parse nationality: %s", json_error_string(err));
-        }
-    }
-    
-    // Parse age
-    JsonValue* dob_obj = json_object_get(user, "dob");
-    if (dob_obj) {
-        JsonValue* age = json_object_get(dob_obj, "age");
-        if (age) {
-            JsonError err = json_value_get_int(age, &user_data->age);
-            if (err != JSON_SUCCESS) {
-                log_error("Failed to parse age: %s", json_error_string(err));
-            }
-        }
-    }
-    
-    // Parse picture URL
-    JsonValue* picture_obj = json_object_get(user, "picture");
-    if (picture_obj) {
-        JsonValue* large = json_object_get(picture_obj, "large");
-        if (large) {
-            JsonError err = json_value_get_string(large, user_data->picture_url, sizeof(user_data->picture_url));
-            if (err != JSON_SUCCESS) {
-                log_error("Failed to parse picture URL: %s", json_error_string(err));
-            }
-        }
-    }
-    
-    json_parser_destroy(parser);
-    
-    log_debug("Parsed user data: %s, %d years old from %s", 
-             user_data->name, user_data->age, user_data->location);
-    
-    return true;
+    return parse(response->data, response->size, NULL, NULL, user_data);
 }
 
 // Utility functions
@@ -9,6 +9,7 @@
 #ifndef API_MANAGER_H
 #define API_MANAGER_H
 
+#include "bandwidth_budget.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -48,7 +49,7 @@ typedef enum {
 typedef enum {
     API_ERROR_NONE = 0,     /**< No error */
     API_ERROR_NETWORK,      /**< Network/HTTP error */
-    API_ERROR_PARSE,        /**< JSON parsing error */
+    API_ERROR_PARSE,        /**< Response parsing error */
     API_ERROR_VALIDATION,   /**< Data validation error */
     API_ERROR_TIMEOUT,      /**< Request timeout */
     API_ERROR_MEMORY        /**< Memory allocation error */
@@ -65,6 +66,7 @@ typedef struct {
     int retry_delay_ms;         /**< Delay between retries in milliseconds */
     bool auto_refresh;          /**< Enable automatic data refresh */
     int refresh_interval_ms;    /**< Auto-refresh interval in milliseconds */
+    const char* accept;         /**< Accept header, e.g. API_PARSERS_ACCEPT_BINARY (NULL = none, borrowed) */
 } ApiManagerConfig;
 
 /**
@@ -157,9 +159,21 @@ bool api_manager_fetch_user(ApiManager* manager);
  * @param manager API manager (required)
  * @return true if request started, false on error
  * @note Non-blocking - callbacks fired on completion
+ * @note Scheduled priority; returns false while a fetch is in progress
  */
 bool api_manager_fetch_user_async(ApiManager* manager);
 
+/**
+ * Refresh user data now because the user asked for it.
+ * 
+ * @param manager API manager (required)
+ * @return true if request started, false on error
+ * @note Runs at interactive priority: it never waits behind background
+ *       polls, cancels any scheduled fetch still in flight and starts
+ *       even while one is loading. Callbacks fire on completion.
+ */
+bool api_manager_refresh_now(ApiManager* manager);
+
 // State queries
 
 /**
@@ -215,6 +229,20 @@ void api_manager_cancel_requests(ApiManager* manager);
  */
 void api_manager_set_auto_refresh(ApiManager* manager, bool enabled);
 
+/**
+ * Account traffic against a bandwidth budget and pace auto-refresh by it.
+ * 
+ * @param manager API manager (required)
+ * @param budget Bandwidth budget (borrowed, NULL to detach)
+ * @param service_id Service the user data is billed to (required with budget)
+ * @param endpoint_id Endpoint the user data is billed to (required with budget)
+ * @note The budget must outlive the manager or be detached first
+ * @note Auto-refresh waits for the budget-scaled interval and stops while
+ *       the budget pauses the endpoint; explicit fetches always run
+ */
+void api_manager_set_bandwidth_budget(ApiManager* manager, BandwidthBudget* budget,
+                                      const char* service_id, const char* endpoint_id);
+
 /**
  * Update manager state and handle auto-refresh.
  * 
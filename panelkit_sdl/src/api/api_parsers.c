@@ -1,9 +1,12 @@
 #include "api_parsers.h"
+#include "binary_reader.h"
 #include "../json/json_parser.h"
 #include "../core/logger.h"
 #include "../core/error.h"
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <stdio.h>
 
 // Static registry for parsers
 static ApiParserEntry* parser_registry = NULL;
@@ -11,6 +14,10 @@ static size_t registry_size = 0;
 static size_t registry_capacity = 0;
 
 bool api_parsers_init(void) {
+    if (parser_registry) {
+        return true;
+    }
+    
     // Initialize with some default capacity
     registry_capacity = 10;
     parser_registry = calloc(registry_capacity, sizeof(ApiParserEntry));
@@ -23,7 +30,11 @@ bool api_parsers_init(void) {
     }
     
     // Register built-in parsers
-    if (!api_parsers_register("randomuser", "get_user", "RandomUser API Parser", parse_randomuser_get_user)) {
+    if (!api_parsers_register("randomuser", "get_user", "RandomUser API Parser", parse_randomuser_get_user) ||
+        !api_parsers_register_format("randomuser", "get_user", API_FORMAT_CBOR,
+                                     "RandomUser CBOR Parser", parse_randomuser_get_user_cbor) ||
+        !api_parsers_register_format("randomuser", "get_user", API_FORMAT_MSGPACK,
+                                     "RandomUser MessagePack Parser", parse_randomuser_get_user_msgpack)) {
         log_error("Failed to register randomuser parser");
         pk_set_last_error_with_context(PK_ERROR_INVALID_STATE,
             "api_parsers_init: Failed to register built-in randomuser parser");
@@ -45,11 +56,26 @@ void api_parsers_cleanup(void) {
 
 bool api_parsers_register(const char* service_id, const char* endpoint_id, 
                           const char* parser_name, api_parser_func parse_func) {
+    return api_parsers_register_format(service_id, endpoint_id, API_FORMAT_JSON,
+                                       parser_name, parse_func);
+}
+
+bool api_parsers_register_format(const char* service_id, const char* endpoint_id,
+                                 ApiPayloadFormat format, const char* parser_name,
+                                 api_parser_func parse_func) {
     if (!service_id || !endpoint_id || !parser_name || !parse_func) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
             "api_parsers_register: Missing required parameter(s)");
         return false;
     }
+    if (format < 0 || format >= API_FORMAT_COUNT) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "api_parsers_register: Invalid payload format %d", (int)format);
+        return false;
+    }
+    if (!parser_registry && !api_parsers_init()) {
+        return false;
+    }
     
     // Check if we need to expand the registry
     if (registry_size >= registry_capacity) {
@@ -70,15 +96,22 @@ bool api_parsers_register(const char* service_id, const char* endpoint_id,
     ApiParserEntry* entry = &parser_registry[registry_size];
     entry->service_id = service_id;  // Assuming these are string literals or managed elsewhere
     entry->endpoint_id = endpoint_id;
+    entry->format = format;
     entry->parser_name = parser_name;
     entry->parse_func = parse_func;
     
     registry_size++;
-    log_debug("Registered parser for %s:%s - %s", service_id, endpoint_id, parser_name);
+    log_debug("Registered %s parser for %s:%s - %s", api_payload_format_string(format),
+              service_id, endpoint_id, parser_name);
     return true;
 }
 
 api_parser_func api_parsers_get(const char* service_id, const char* endpoint_id) {
+    return api_parsers_get_format(service_id, endpoint_id, API_FORMAT_JSON);
+}
+
+api_parser_func api_parsers_get_format(const char* service_id, const char* endpoint_id,
+                                       ApiPayloadFormat format) {
     if (!service_id || !endpoint_id) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
             "api_parsers_get: service_id=%p, endpoint_id=%p",
@@ -87,7 +120,8 @@ api_parser_func api_parsers_get(const char* service_id, const char* endpoint_id)
     }
     
     for (size_t i = 0; i < registry_size; i++) {
-        if (strcmp(parser_registry[i].service_id, service_id) == 0 &&
+        if (parser_registry[i].format == format &&
+            strcmp(parser_registry[i].service_id, service_id) == 0 &&
             strcmp(parser_registry[i].endpoint_id, endpoint_id) == 0) {
             return parser_registry[i].parse_func;
         }
@@ -118,10 +152,45 @@ bool api_parsers_is_supported(const char* service_id, const char* endpoint_id) {
     return api_parsers_get(service_id, endpoint_id) != NULL;
 }
 
+ApiPayloadFormat api_payload_format_from_content_type(const char* content_type) {
+    if (!content_type) {
+        return API_FORMAT_JSON;
+    }
+    
+    // Compare the media type only, ignoring parameters such as charset
+    size_t len = strcspn(content_type, "; \t");
+    if (len == strlen("application/cbor") &&
+        strncasecmp(content_type, "application/cbor", len) == 0) {
+        return API_FORMAT_CBOR;
+    }
+    if ((len == strlen("application/msgpack") &&
+         strncasecmp(content_type, "application/msgpack", len) == 0) ||
+        (len == strlen("application/x-msgpack") &&
+         strncasecmp(content_type, "application/x-msgpack", len) == 0) ||
+        (len == strlen("application/vnd.msgpack") &&
+         strncasecmp(content_type, "application/vnd.msgpack", len) == 0)) {
+        return API_FORMAT_MSGPACK;
+    }
+    return API_FORMAT_JSON;
+}
+
+const char* api_payload_format_string(ApiPayloadFormat format) {
+    switch (format) {
+        case API_FORMAT_JSON:
+            return "JSON";
+        case API_FORMAT_CBOR:
+            return "CBOR";
+        case API_FORMAT_MSGPACK:
+            return "MessagePack";
+        default:
+            return "unknown";
+    }
+}
+
 // Built-in parser for RandomUser API
-bool parse_randomuser_get_user(const char* response_data, size_t data_len, 
-                              const ApiServiceConfig* service, 
-                              const ApiEndpointConfig* endpoint, 
+bool parse_randomuser_get_user(const char* response_data, size_t data_len,
+                              const ApiServiceConfig* service,
+                              const ApiEndpointConfig* endpoint,
                               UserData* output) {
     if (!response_data || !output) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
@@ -129,7 +198,7 @@ bool parse_randomuser_get_user(const char* response_data, size_t data_len,
             (void*)response_data, (void*)output);
         return false;
     }
-    if (!response_data || data_len == 0 || !output) {
+    if (data_len == 0) {
         log_error("Invalid parameters for randomuser parser");
         return false;
     }
@@ -137,8 +206,6 @@ bool parse_randomuser_get_user(const char* response_data, size_t data_len,
     log_debug("Parsing RandomUser API response (%zu bytes) for service:%s endpoint:%s", 
               data_len, service ? service->id : "unknown", endpoint ? endpoint->id : "unknown");
     
-    // For now, just use the existing JSON parser
-    // TODO: This should be updated to handle the new API structure
     JsonParser* parser = json_parser_create();
     if (!parser) {
         log_error("Failed to create JSON parser for randomuser");
@@ -147,19 +214,257 @@ bool parse_randomuser_get_user(const char* response_data, size_t data_len,
         return false;
     }
     
-    bool success = json_parser_parse_user_data(parser, response_data, data_len, output);
-    if (!success) {
-        const JsonParseError* error = json_parser_get_error(parser);
-        log_error("Failed to parse randomuser response: %s", error ? error->message : "unknown error");
+    JsonError error = json_parser_parse(parser, response_data, data_len);
+    if (error != JSON_SUCCESS) {
+        log_error("JSON parsing failed: %s", json_error_string(error));
         pk_set_last_error_with_context(PK_ERROR_PARSE,
-            "parse_randomuser_get_user: JSON parse failed: %s",
-            error ? error->message : "unknown error");
-    } else {
-        log_info("Successfully parsed randomuser data: %s %s", output->first_name, output->last_name);
+            "parse_randomuser_get_user: JSON parse failed: %s", json_error_string(error));
+        json_parser_destroy(parser);
+        return false;
+    }
+    
+    JsonValue* root = json_parser_get_root(parser);
+    if (!root) {
+        log_error("No JSON root object");
+        json_parser_destroy(parser);
+        return false;
+    }
+    
+    // Get results array
+    JsonValue* results = json_object_get(root, "results");
+    if (!results || json_array_size(results) == 0) {
+        log_error("No results in API response");
+        json_parser_destroy(parser);
+        return false;
+    }
+    
+    // Get first user
+    JsonValue* user = json_array_get(results, 0);
+    if (!user) {
+        log_error("No user data in results");
+        json_parser_destroy(parser);
+        return false;
+    }
+    
+    // Parse name
+    JsonValue* name_obj = json_object_get(user, "name");
+    if (name_obj) {
+        JsonValue* first = json_object_get(name_obj, "first");
+        JsonValue* last = json_object_get(name_obj, "last");
+        
+        char first_name[64] = {0};
+        char last_name[64] = {0};
+        
+        if (first) {
+            JsonError err = json_value_get_string(first, first_name, sizeof(first_name));
+            if (err != JSON_SUCCESS) {
+                log_error("Failed to parse first name: %s", json_error_string(err));
+            }
+        }
+        if (last) {
+            JsonError err = json_value_get_string(last, last_name, sizeof(last_name));
+            if (err != JSON_SUCCESS) {
+                log_error("Failed to parse last name: %s", json_error_string(err));
+            }
+        }
+        
+        snprintf(output->name, sizeof(output->name), "%s %s", first_name, last_name);
+    }
+    
+    // Parse email
+    JsonValue* email = json_object_get(user, "email");
+    if (email) {
+        JsonError err = json_value_get_string(email, output->email, sizeof(output->email));
+        if (err != JSON_SUCCESS) {
+            log_error("Failed to parse email: %s", json_error_string(err));
+        }
+    }
+    
+    // Parse location
+    JsonValue* location_obj = json_object_get(user, "location");
+    if (location_obj) {
+        JsonValue* city = json_object_get(location_obj, "city");
+        JsonValue* country = json_object_get(location_obj, "country");
+        
+        char city_name[64] = {0};
+        char country_name[64] = {0};
+        
+        if (city) {
+            JsonError err = json_value_get_string(city, city_name, sizeof(city_name));
+            if (err != JSON_SUCCESS) {
+                log_error("Failed to parse city: %s", json_error_string(err));
+            }
+        }
+        if (country) {
+            JsonError err = json_value_get_string(country, country_name, sizeof(country_name));
+            if (err != JSON_SUCCESS) {
+                log_error("Failed to parse country: %s", json_error_string(err));
+            }
+        }
+        
+        snprintf(output->location, sizeof(output->location), "%s, %s", city_name, country_name);
+    }
+    
+    // Parse phone
+    JsonValue* phone = json_object_get(user, "phone");
+    if (phone) {
+        JsonError err = json_value_get_string(phone, output->phone, sizeof(output->phone));
+        if (err != JSON_SUCCESS) {
+            log_error("Failed to parse phone: %s", json_error_string(err));
+        }
+    }
+    
+    // Parse nationality
+    JsonValue* nat = json_object_get(user, "nat");
+    if (nat) {
+        JsonError err = json_value_get_string(nat, output->nationality, sizeof(output->nationality));
+        if (err != JSON_SUCCESS) {
+            log_error("Failed to parse nationality: %s", json_error_string(err));
+        }
+    }
+    
+    // Parse age
+    JsonValue* dob_obj = json_object_get(user, "dob");
+    if (dob_obj) {
+        JsonValue* age = json_object_get(dob_obj, "age");
+        if (age) {
+            JsonError err = json_value_get_int(age, &output->age);
+            if (err != JSON_SUCCESS) {
+                log_error("Failed to parse age: %s", json_error_string(err));
+            }
+        }
+    }
+    
+    // Parse picture URL
+    JsonValue* picture_obj = json_object_get(user, "picture");
+    if (picture_obj) {
+        JsonValue* large = json_object_get(picture_obj, "large");
+        if (large) {
+            JsonError err = json_value_get_string(large, output->picture_url, sizeof(output->picture_url));
+            if (err != JSON_SUCCESS) {
+                log_error("Failed to parse picture URL: %s", json_error_string(err));
+            }
+        }
     }
     
     json_parser_destroy(parser);
-    return success;
+    
+    log_debug("Parsed user data: %s, %d years old from %s", 
+             output->name, output->age, output->location);
+    
+    return true;
+}
+
+// Flattened randomuser result; the binary field tables write straight into it
+typedef struct {
+    char first[64];
+    char last[64];
+    char email[128];
+    char city[62];          // With ", " these fit UserData.location
+    char country[62];
+    char phone[64];
+    char picture[256];
+    char nat[32];
+    int age;
+} RandomUserRecord;
+
+#define RECORD_STRING(key, member) \
+    { key, BINARY_FIELD_STRING, offsetof(RandomUserRecord, member), \
+      sizeof(((RandomUserRecord*)0)->member), NULL, 0 }
+#define RECORD_NESTED(key, type, table) \
+    { key, type, 0, 0, table, sizeof(table) / sizeof(table[0]) }
+
+static const BinaryField randomuser_name_fields[] = {
+    RECORD_STRING("first", first),
+    RECORD_STRING("last", last)
+};
+
+static const BinaryField randomuser_location_fields[] = {
+    RECORD_STRING("city", city),
+    RECORD_STRING("country", country)
+};
+
+static const BinaryField randomuser_dob_fields[] = {
+    { "age", BINARY_FIELD_INT, offsetof(RandomUserRecord, age), 0, NULL, 0 }
+};
+
+static const BinaryField randomuser_picture_fields[] = {
+    RECORD_STRING("large", picture)
+};
+
+static const BinaryField randomuser_user_fields[] = {
+    RECORD_NESTED("name", BINARY_FIELD_MAP, randomuser_name_fields),
+    RECORD_STRING("email", email),
+    RECORD_NESTED("location", BINARY_FIELD_MAP, randomuser_location_fields),
+    RECORD_STRING("phone", phone),
+    RECORD_STRING("nat", nat),
+    RECORD_NESTED("dob", BINARY_FIELD_MAP, randomuser_dob_fields),
+    RECORD_NESTED("picture", BINARY_FIELD_MAP, randomuser_picture_fields)
+};
+
+static const BinaryField randomuser_root_fields[] = {
+    RECORD_NESTED("results", BINARY_FIELD_FIRST, randomuser_user_fields)
+};
+
+// Same document shape as the JSON API, decoded without a token pass
+static bool parse_randomuser_binary(BinaryFormat format, const char* response_data,
+                                    size_t data_len, UserData* output) {
+    if (!response_data || !output) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+            "parse_randomuser_binary: response_data=%p, output=%p",
+            (void*)response_data, (void*)output);
+        return false;
+    }
+    
+    RandomUserRecord record = {0};
+    BinaryReader reader;
+    binary_reader_init(&reader, format, response_data, data_len);
+    if (!binary_reader_decode_map(&reader, randomuser_root_fields,
+                                  sizeof(randomuser_root_fields) / sizeof(randomuser_root_fields[0]),
+                                  &record)) {
+        log_error("Malformed %s randomuser response at byte %zu of %zu",
+                  binary_format_string(format), reader.pos, data_len);
+        pk_set_last_error_with_context(PK_ERROR_PARSE,
+            "parse_randomuser_binary: malformed %s at byte %zu",
+            binary_format_string(format), reader.pos);
+        return false;
+    }
+    if (!record.first[0] && !record.email[0]) {
+        log_error("No results in API response");
+        pk_set_last_error_with_context(PK_ERROR_PARSE,
+            "parse_randomuser_binary: no user in %s response", binary_format_string(format));
+        return false;
+    }
+    
+    snprintf(output->name, sizeof(output->name), "%s %s", record.first, record.last);
+    snprintf(output->location, sizeof(output->location), "%s, %s", record.city, record.country);
+    snprintf(output->email, sizeof(output->email), "%s", record.email);
+    snprintf(output->phone, sizeof(output->phone), "%s", record.phone);
+    snprintf(output->picture_url, sizeof(output->picture_url), "%s", record.picture);
+    snprintf(output->nationality, sizeof(output->nationality), "%s", record.nat);
+    output->age = record.age;
+    
+    log_debug("Parsed %s user data: %s, %d years old from %s", binary_format_string(format),
+              output->name, output->age, output->location);
+    return true;
+}
+
+bool parse_randomuser_get_user_cbor(const char* response_data, size_t data_len,
+                                    const ApiServiceConfig* service,
+                                    const ApiEndpointConfig* endpoint,
+                                    UserData* output) {
+    (void)service;
+    (void)endpoint;
+    return parse_randomuser_binary(BINARY_FORMAT_CBOR, response_data, data_len, output);
+}
+
+bool parse_randomuser_get_user_msgpack(const char* response_data, size_t data_len,
+                                       const ApiServiceConfig* service,
+                                       const ApiEndpointConfig* endpoint,
+                                       UserData* output) {
+    (void)service;
+    (void)endpoint;
+    return parse_randomuser_binary(BINARY_FORMAT_MSGPACK, response_data, data_len, output);
 }
 
 // Helper functions for accessing service configuration
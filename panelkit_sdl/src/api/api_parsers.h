@@ -1,45 +1,72 @@
 /**
  * @file api_parsers.h
- * @brief JSON parsing utilities for API responses
- * 
- * Provides type-safe parsing of API responses into domain structures.
+ * @brief Parsing of API responses into domain structures
+ *
+ * Parsers are registered per service, endpoint and payload format. The
+ * format comes from the response Content-Type, so a backend that
+ * honours the Accept header can answer in CBOR or MessagePack while
+ * third-party services keep sending JSON to the same code path.
+ *
+ * Register parsers at startup, before requests are in flight; lookups
+ * are not locked.
  */
 
 #ifndef API_PARSERS_H
 #define API_PARSERS_H
 
+#include "api_manager.h"
+#include "../config/config_schema.h"
 #include <stdbool.h>
 #include <stddef.h>
 
-// Forward declarations
-typedef struct ApiServiceConfig ApiServiceConfig;
-typedef struct ApiEndpointConfig ApiEndpointConfig;
-typedef struct UserData UserData;
+// Accept header preferring compact encodings, with JSON as the fallback
+#define API_PARSERS_ACCEPT_BINARY \
+    "application/cbor, application/msgpack;q=0.9, application/json;q=0.5"
+
+// Response body encodings
+typedef enum {
+    API_FORMAT_JSON,
+    API_FORMAT_CBOR,
+    API_FORMAT_MSGPACK,
+    API_FORMAT_COUNT
+} ApiPayloadFormat;
 
 // API parser function signature
-// Returns true on successful parse, false on error
-typedef bool (*api_parser_func)(const char* response_data, size_t data_len, 
-                                const ApiServiceConfig* service, 
-                                const ApiEndpointConfig* endpoint, 
+// Returns true on successful parse, false on error. response_data is
+// NUL-terminated, but binary formats may contain NULs: use data_len.
+typedef bool (*api_parser_func)(const char* response_data, size_t data_len,
+                                const ApiServiceConfig* service,
+                                const ApiEndpointConfig* endpoint,
                                 UserData* output);
 
 // Parser registry entry
 typedef struct {
     const char* service_id;          // Must match ApiServiceConfig.id
     const char* endpoint_id;         // Must match ApiEndpointConfig.id
+    ApiPayloadFormat format;         // Body encoding this parser accepts
     const char* parser_name;         // Human-readable parser name
     api_parser_func parse_func;      // Parser function
 } ApiParserEntry;
 
-// Parser registry functions
+// Parser registry functions (init is idempotent)
 bool api_parsers_init(void);
 void api_parsers_cleanup(void);
-bool api_parsers_register(const char* service_id, const char* endpoint_id, 
+bool api_parsers_register(const char* service_id, const char* endpoint_id,
                           const char* parser_name, api_parser_func parse_func);
+bool api_parsers_register_format(const char* service_id, const char* endpoint_id,
+                                 ApiPayloadFormat format, const char* parser_name,
+                                 api_parser_func parse_func);
 api_parser_func api_parsers_get(const char* service_id, const char* endpoint_id);
+api_parser_func api_parsers_get_format(const char* service_id, const char* endpoint_id,
+                                       ApiPayloadFormat format);
 const char* api_parsers_get_name(const char* service_id, const char* endpoint_id);
 bool api_parsers_is_supported(const char* service_id, const char* endpoint_id);
 
+// Payload formats
+// Unknown or missing content types map to JSON, which every service speaks
+ApiPayloadFormat api_payload_format_from_content_type(const char* content_type);
+const char* api_payload_format_string(ApiPayloadFormat format);
+
 // Helper functions for accessing service configuration
 const char* api_service_get_header(const ApiServiceConfig* service, const char* header_name);
 const char* api_service_get_meta(const ApiServiceConfig* service, const char* meta_key);
@@ -47,9 +74,17 @@ bool api_service_get_meta_bool(const ApiServiceConfig* service, const char* meta
 int api_service_get_meta_int(const ApiServiceConfig* service, const char* meta_key, int default_value);
 
 // Built-in parsers
-bool parse_randomuser_get_user(const char* response_data, size_t data_len, 
-                              const ApiServiceConfig* service, 
-                              const ApiEndpointConfig* endpoint, 
+bool parse_randomuser_get_user(const char* response_data, size_t data_len,
+                              const ApiServiceConfig* service,
+                              const ApiEndpointConfig* endpoint,
                               UserData* output);
+bool parse_randomuser_get_user_cbor(const char* response_data, size_t data_len,
+                                    const ApiServiceConfig* service,
+                                    const ApiEndpointConfig* endpoint,
+                                    UserData* output);
+bool parse_randomuser_get_user_msgpack(const char* response_data, size_t data_len,
+                                       const ApiServiceConfig* service,
+                                       const ApiEndpointConfig* endpoint,
+                                       UserData* output);
 
 #endif // API_PARSERS_H
\ No newline at end of file
@@ -0,0 +1,524 @@
+#include "bandwidth_budget.h"
+#include "../core/logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+
+#define BUDGET_MAX_ENDPOINTS 32
+#define BUDGET_MAX_ID 48
+#define BUDGET_SAVE_INTERVAL_S 60
+#define BUDGET_HIDDEN_STRETCH 4
+#define BUDGET_HIDDEN_CUTOFF 0.9
+
+typedef struct {
+    char service[BUDGET_MAX_ID];
+    char endpoint[BUDGET_MAX_ID];
+    uint64_t day_bytes;
+    uint64_t month_bytes;
+    uint64_t requests;
+    bool visible;
+} BudgetEntry;
+
+struct BandwidthBudget {
+    BandwidthBudgetConfig config;
+    char state_path[512];
+
+    // Current periods as YYYYMMDD of their first day
+    int day_key;
+    int period_key;
+    time_t day_start;
+    time_t day_end;
+    time_t period_start;
+    time_t period_end;
+
+    // Totals include bytes recorded after the endpoint table filled up
+    BandwidthUsage total;
+    BudgetEntry entries[BUDGET_MAX_ENDPOINTS];
+    size_t entry_count;
+
+    // Persistence
+    time_t last_save;
+    bool dirty;
+    bool save_failed;
+
+    pthread_mutex_t mutex;
+};
+
+// Period helpers
+
+static int tm_key(const struct tm* tm) {
+    return (tm->tm_year + 1900) * 10000 + (tm->tm_mon + 1) * 100 + tm->tm_mday;
+}
+
+static time_t local_midnight(struct tm tm) {
+    tm.tm_hour = 0;
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+// Recompute period boundaries and zero counters of periods that ended
+static void rollover_locked(BandwidthBudget* budget, time_t now) {
+    struct tm today;
+    localtime_r(&now, &today);
+
+    int day_key = tm_key(&today);
+    if (day_key != budget->day_key) {
+        if (budget->day_key != 0) {
+            log_info("Bandwidth budget: day rolled over (%llu bytes used)",
+                     (unsigned long long)budget->total.day_bytes);
+        }
+        budget->day_key = day_key;
+        budget->day_start = local_midnight(today);
+        struct tm tomorrow = today;
+        tomorrow.tm_mday++;
+        budget->day_end = local_midnight(tomorrow);
+
+        budget->total.day_bytes = 0;
+        for (size_t i = 0; i < budget->entry_count; i++) {
+            budget->entries[i].day_bytes = 0;
+        }
+        budget->dirty = true;
+    }
+
+    struct tm start = today;
+    if (today.tm_mday < budget->config.billing_day) {
+        start.tm_mon--;
+    }
+    start.tm_mday = budget->config.billing_day;
+    budget->period_start = local_midnight(start);
+    localtime_r(&budget->period_start, &start);
+
+    int period_key = tm_key(&start);
+    if (period_key != budget->period_key) {
+        if (budget->period_key != 0) {
+            log_info("Bandwidth budget: billing period rolled over (%llu bytes used)",
+                     (unsigned long long)budget->total.month_bytes);
+        }
+        budget->period_key = period_key;
+        budget->total.month_bytes = 0;
+        budget->total.requests = 0;
+        for (size_t i = 0; i < budget->entry_count; i++) {
+            budget->entries[i].month_bytes = 0;
+            budget->entries[i].requests = 0;
+        }
+        budget->dirty = true;
+    }
+
+    struct tm end = start;
+    end.tm_mon++;
+    budget->period_end = local_midnight(end);
+}
+
+// Ratio of the current spend rate to the rate that would exactly use up
+// the rest of the allowance by the end of the period (<0 = exhausted)
+static double pace_ratio(uint64_t used, uint64_t limit, time_t start, time_t end, time_t now) {
+    if (limit == 0) {
+        return 0.0;
+    }
+    if (used >= limit) {
+        return -1.0;
+    }
+
+    // Early in a period a single response would look like a huge rate
+    double elapsed = difftime(now, start);
+    double min_elapsed = difftime(end, start) / 24.0;
+    if (elapsed < min_elapsed) {
+        elapsed = min_elapsed;
+    }
+    double remaining = difftime(end, now);
+    if (remaining < 1.0) {
+        remaining = 1.0;
+    }
+
+    double spend_rate = (double)used / elapsed;
+    double allowed_rate = (double)(limit - used) / remaining;
+    return spend_rate / allowed_rate;
+}
+
+static bool valid_id(const char* id) {
+    return id[0] != '\0' && strlen(id) < BUDGET_MAX_ID && strcspn(id, " \t\r\n") == strlen(id);
+}
+
+static BudgetEntry* find_entry_locked(BandwidthBudget* budget, const char* service_id,
+                                      const char* endpoint_id) {
+    for (size_t i = 0; i < budget->entry_count; i++) {
+        BudgetEntry* entry = &budget->entries[i];
+        if (strcmp(entry->service, service_id) == 0 &&
+            strcmp(entry->endpoint, endpoint_id) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static BudgetEntry* add_entry_locked(BandwidthBudget* budget, const char* service_id,
+                                     const char* endpoint_id) {
+    BudgetEntry* entry = find_entry_locked(budget, service_id, endpoint_id);
+    if (entry) {
+        return entry;
+    }
+    if (budget->entry_count >= BUDGET_MAX_ENDPOINTS) {
+        pk_set_last_error_with_context(PK_ERROR_RESOURCE_LIMIT,
+            "Bandwidth budget tracks at most %d endpoints (adding %s/%s)",
+            BUDGET_MAX_ENDPOINTS, service_id, endpoint_id);
+        return NULL;
+    }
+
+    entry = &budget->entries[budget->entry_count++];
+    memset(entry, 0, sizeof(*entry));
+    strcpy(entry->service, service_id);
+    strcpy(entry->endpoint, endpoint_id);
+    entry->visible = true;
+    return entry;
+}
+
+// Persistence
+
+static void load_state_locked(BandwidthBudget* budget) {
+    FILE* file = fopen(budget->state_path, "r");
+    if (!file) {
+        log_debug("No saved bandwidth counters at %s", budget->state_path);
+        return;
+    }
+
+    int day_key = 0;
+    int period_key = 0;
+    BandwidthUsage total = {0};
+    char line[256];
+
+    while (fgets(line, sizeof(line), file)) {
+        char service[BUDGET_MAX_ID];
+        char endpoint[BUDGET_MAX_ID];
+        unsigned long long day_bytes, month_bytes, requests;
+
+        if (line[0] == '#' ||
+            sscanf(line, "day %d", &day_key) == 1 ||
+            sscanf(line, "period %d", &period_key) == 1) {
+            continue;
+        }
+        if (sscanf(line, "total %llu %llu %llu", &day_bytes, &month_bytes, &requests) == 3) {
+            total.day_bytes = day_bytes;
+            total.month_bytes = month_bytes;
+            total.requests = requests;
+        } else if (sscanf(line, "endpoint %47s %47s %llu %llu %llu", service, endpoint,
+                          &day_bytes, &month_bytes, &requests) == 5) {
+            BudgetEntry* entry = add_entry_locked(budget, service, endpoint);
+            if (entry) {
+                entry->day_bytes = day_bytes;
+                entry->month_bytes = month_bytes;
+                entry->requests = requests;
+            }
+        } else {
+            log_warn("Ignoring malformed line in %s: %s", budget->state_path, line);
+        }
+    }
+    fclose(file);
+
+    // Let the normal rollover discard whatever belongs to an ended period
+    budget->day_key = day_key;
+    budget->period_key = period_key;
+    budget->total = total;
+    rollover_locked(budget, time(NULL));
+    budget->dirty = false;
+
+    log_info("Loaded bandwidth counters: %llu bytes today, %llu this billing period",
+             (unsigned long long)budget->total.day_bytes,
+             (unsigned long long)budget->total.month_bytes);
+}
+
+static PkError save_state_locked(BandwidthBudget* budget, time_t now) {
+    if (budget->state_path[0] == '\0') {
+        return PK_OK;
+    }
+
+    // Write a sibling file and rename so a crash never leaves half a file
+    char tmp_path[sizeof(budget->state_path) + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", budget->state_path);
+
+    FILE* file = fopen(tmp_path, "w");
+    if (!file) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "Cannot write bandwidth counters to %s", tmp_path);
+        goto failed;
+    }
+
+    fprintf(file, "# PanelKit bandwidth counters\n");
+    fprintf(file, "day %d\n", budget->day_key);
+    fprintf(file, "period %d\n", budget->period_key);
+    fprintf(file, "total %llu %llu %llu\n",
+            (unsigned long long)budget->total.day_bytes,
+            (unsigned long long)budget->total.month_bytes,
+            (unsigned long long)budget->total.requests);
+    for (size_t i = 0; i < budget->entry_count; i++) {
+        const BudgetEntry* entry = &budget->entries[i];
+        fprintf(file, "endpoint %s %s %llu %llu %llu\n", entry->service, entry->endpoint,
+                (unsigned long long)entry->day_bytes,
+                (unsigned long long)entry->month_bytes,
+                (unsigned long long)entry->requests);
+    }
+
+    bool write_failed = ferror(file) != 0;
+    if (fclose(file) != 0 || write_failed || rename(tmp_path, budget->state_path) != 0) {
+        remove(tmp_path);
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "Cannot save bandwidth counters to %s", budget->state_path);
+        goto failed;
+    }
+
+    budget->last_save = now;
+    budget->dirty = false;
+    budget->save_failed = false;
+    return PK_OK;
+
+failed:
+    // Retry on the next interval, but only complain once
+    budget->last_save = now;
+    if (!budget->save_failed) {
+        log_warn("%s", pk_get_last_error_context());
+        budget->save_failed = true;
+    }
+    return PK_ERROR_SYSTEM;
+}
+
+// Lifecycle
+
+BandwidthBudget* bandwidth_budget_create(const BandwidthBudgetConfig* config) {
+    PK_CHECK_NULL_WITH_CONTEXT(config != NULL, PK_ERROR_NULL_PARAM,
+                               "config is NULL");
+    PK_CHECK_NULL_WITH_CONTEXT(config->billing_day >= 1 && config->billing_day <= 28,
+                               PK_ERROR_INVALID_PARAM,
+                               "billing_day must be 1-28, got %d", config->billing_day);
+    PK_CHECK_NULL_WITH_CONTEXT(config->max_stretch >= 1, PK_ERROR_INVALID_PARAM,
+                               "max_stretch must be at least 1, got %d", config->max_stretch);
+
+    BandwidthBudget* budget = calloc(1, sizeof(BandwidthBudget));
+    if (!budget) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate BandwidthBudget struct");
+        return NULL;
+    }
+
+    budget->config = *config;
+    if (config->state_path) {
+        snprintf(budget->state_path, sizeof(budget->state_path), "%s", config->state_path);
+    }
+    budget->config.state_path = budget->state_path;
+
+    if (pthread_mutex_init(&budget->mutex, NULL) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                                       "Failed to initialize bandwidth budget mutex");
+        free(budget);
+        return NULL;
+    }
+
+    time_t now = time(NULL);
+    if (budget->state_path[0] != '\0') {
+        load_state_locked(budget);
+    }
+    rollover_locked(budget, now);
+    budget->last_save = now;
+
+    log_info("Bandwidth budget: daily=%llu monthly=%llu bytes, billing day %d, max stretch %dx",
+             (unsigned long long)config->daily_bytes,
+             (unsigned long long)config->monthly_bytes,
+             config->billing_day, config->max_stretch);
+    return budget;
+}
+
+void bandwidth_budget_destroy(BandwidthBudget* budget) {
+    if (!budget) {
+        return;
+    }
+
+    pthread_mutex_lock(&budget->mutex);
+    if (budget->dirty) {
+        save_state_locked(budget, time(NULL));
+    }
+    pthread_mutex_unlock(&budget->mutex);
+
+    pthread_mutex_destroy(&budget->mutex);
+    free(budget);
+}
+
+// Accounting
+
+PkError bandwidth_budget_record(BandwidthBudget* budget, const char* service_id,
+                                const char* endpoint_id, uint64_t bytes) {
+    PK_CHECK_ERROR_WITH_CONTEXT(budget != NULL, PK_ERROR_NULL_PARAM,
+                                "budget is NULL");
+    PK_CHECK_ERROR_WITH_CONTEXT(service_id != NULL && endpoint_id != NULL, PK_ERROR_NULL_PARAM,
+                                "service_id and endpoint_id are required");
+    PK_CHECK_ERROR_WITH_CONTEXT(valid_id(service_id) && valid_id(endpoint_id),
+                                PK_ERROR_INVALID_PARAM,
+                                "Invalid endpoint id '%s/%s'", service_id, endpoint_id);
+
+    time_t now = time(NULL);
+    PkError result = PK_OK;
+
+    pthread_mutex_lock(&budget->mutex);
+    rollover_locked(budget, now);
+
+    budget->total.day_bytes += bytes;
+    budget->total.month_bytes += bytes;
+    budget->total.requests++;
+
+    BudgetEntry* entry = add_entry_locked(budget, service_id, endpoint_id);
+    if (entry) {
+        entry->day_bytes += bytes;
+        entry->month_bytes += bytes;
+        entry->requests++;
+    } else {
+        result = PK_ERROR_RESOURCE_LIMIT;
+    }
+    budget->dirty = true;
+
+    if (difftime(now, budget->last_save) >= BUDGET_SAVE_INTERVAL_S) {
+        save_state_locked(budget, now);
+    }
+    pthread_mutex_unlock(&budget->mutex);
+
+    return result;
+}
+
+PkError bandwidth_budget_set_visible(BandwidthBudget* budget, const char* service_id,
+                                     const char* endpoint_id, bool visible) {
+    PK_CHECK_ERROR_WITH_CONTEXT(budget != NULL, PK_ERROR_NULL_PARAM,
+                                "budget is NULL");
+    PK_CHECK_ERROR_WITH_CONTEXT(service_id != NULL && endpoint_id != NULL, PK_ERROR_NULL_PARAM,
+                                "service_id and endpoint_id are required");
+    PK_CHECK_ERROR_WITH_CONTEXT(valid_id(service_id) && valid_id(endpoint_id),
+                                PK_ERROR_INVALID_PARAM,
+                                "Invalid endpoint id '%s/%s'", service_id, endpoint_id);
+
+    pthread_mutex_lock(&budget->mutex);
+    BudgetEntry* entry = add_entry_locked(budget, service_id, endpoint_id);
+    if (entry && entry->visible != visible) {
+        entry->visible = visible;
+        log_debug("Bandwidth budget: %s/%s now %s", service_id, endpoint_id,
+                  visible ? "visible" : "hidden");
+    }
+    pthread_mutex_unlock(&budget->mutex);
+
+    return entry ? PK_OK : PK_ERROR_RESOURCE_LIMIT;
+}
+
+uint32_t bandwidth_budget_scale_interval(BandwidthBudget* budget, const char* service_id,
+                                         const char* endpoint_id, uint32_t base_interval_ms) {
+    if (!budget || !service_id || !endpoint_id) {
+        return base_interval_ms;
+    }
+
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&budget->mutex);
+    rollover_locked(budget, now);
+
+    BudgetEntry* entry = find_entry_locked(budget, service_id, endpoint_id);
+    bool visible = entry ? entry->visible : true;
+
+    double day_pace = pace_ratio(budget->total.day_bytes, budget->config.daily_bytes,
+                                 budget->day_start, budget->day_end, now);
+    double month_pace = pace_ratio(budget->total.month_bytes, budget->config.monthly_bytes,
+                                   budget->period_start, budget->period_end, now);
+    bool exhausted = day_pace < 0.0 || month_pace < 0.0;
+
+    double used_fraction = 0.0;
+    if (budget->config.daily_bytes > 0) {
+        used_fraction = (double)budget->total.day_bytes / (double)budget->config.daily_bytes;
+    }
+    if (budget->config.monthly_bytes > 0) {
+        double month_fraction = (double)budget->total.month_bytes /
+                                (double)budget->config.monthly_bytes;
+        if (month_fraction > used_fraction) {
+            used_fraction = month_fraction;
+        }
+    }
+
+    int max_stretch = budget->config.max_stretch;
+    pthread_mutex_unlock(&budget->mutex);
+
+    // Hidden endpoints leave the last of the allowance to what is on screen
+    if (!visible && (exhausted || used_fraction >= BUDGET_HIDDEN_CUTOFF)) {
+        return BANDWIDTH_BUDGET_PAUSED;
+    }
+
+    double stretch = day_pace > month_pace ? day_pace : month_pace;
+    if (exhausted || stretch > max_stretch) {
+        stretch = max_stretch;
+    }
+    if (stretch < 1.0) {
+        stretch = 1.0;
+    }
+    if (!visible) {
+        stretch *= BUDGET_HIDDEN_STRETCH;
+    }
+
+    double interval = (double)base_interval_ms * stretch;
+    if (interval >= (double)(BANDWIDTH_BUDGET_PAUSED - 1)) {
+        return BANDWIDTH_BUDGET_PAUSED - 1;
+    }
+    return (uint32_t)interval;
+}
+
+// Queries
+
+PkError bandwidth_budget_get_usage(BandwidthBudget* budget, const char* service_id,
+                                   const char* endpoint_id, BandwidthUsage* usage) {
+    PK_CHECK_ERROR_WITH_CONTEXT(budget != NULL && usage != NULL, PK_ERROR_NULL_PARAM,
+                                "budget and usage are required");
+
+    memset(usage, 0, sizeof(*usage));
+    bool found = false;
+
+    pthread_mutex_lock(&budget->mutex);
+    rollover_locked(budget, time(NULL));
+
+    if (!service_id) {
+        *usage = budget->total;
+        found = true;
+    } else {
+        for (size_t i = 0; i < budget->entry_count; i++) {
+            const BudgetEntry* entry = &budget->entries[i];
+            if (strcmp(entry->service, service_id) != 0 ||
+                (endpoint_id && strcmp(entry->endpoint, endpoint_id) != 0)) {
+                continue;
+            }
+            usage->day_bytes += entry->day_bytes;
+            usage->month_bytes += entry->month_bytes;
+            usage->requests += entry->requests;
+            found = true;
+        }
+    }
+    pthread_mutex_unlock(&budget->mutex);
+
+    PK_CHECK_ERROR_WITH_CONTEXT(found, PK_ERROR_NOT_FOUND,
+                                "No bandwidth recorded for %s/%s", service_id,
+                                endpoint_id ? endpoint_id : "*");
+    return PK_OK;
+}
+
+PkError bandwidth_budget_save(BandwidthBudget* budget) {
+    PK_CHECK_ERROR_WITH_CONTEXT(budget != NULL, PK_ERROR_NULL_PARAM,
+                                "budget is NULL");
+
+    pthread_mutex_lock(&budget->mutex);
+    PkError result = save_state_locked(budget, time(NULL));
+    pthread_mutex_unlock(&budget->mutex);
+
+    return result;
+}
+
+BandwidthBudgetConfig bandwidth_budget_default_config(void) {
+    BandwidthBudgetConfig config = {
+        .daily_bytes = 0,
+        .monthly_bytes = 0,
+        .billing_day = 1,
+        .max_stretch = 16,
+        .state_path = NULL
+    };
+    return config;
+}
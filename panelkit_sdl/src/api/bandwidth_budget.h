@@ -0,0 +1,147 @@
+/**
+ * @file bandwidth_budget.h
+ * @brief Data budget accounting for metered network links
+ *
+ * Counts the bytes each service endpoint moves (bodies and headers, both
+ * directions) against daily and monthly allowances, and stretches refresh
+ * intervals so the allowance lasts until the period ends. Endpoints whose
+ * data is on screen keep refreshing at the fairest rate the budget allows;
+ * hidden ones back off harder and stop entirely once the budget is spent.
+ * Counters are persisted so a restart does not reset the allowance.
+ */
+
+#ifndef BANDWIDTH_BUDGET_H
+#define BANDWIDTH_BUDGET_H
+
+#include "../core/error.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Opaque bandwidth budget handle */
+typedef struct BandwidthBudget BandwidthBudget;
+
+/** Returned by bandwidth_budget_scale_interval() when an endpoint must not poll */
+#define BANDWIDTH_BUDGET_PAUSED UINT32_MAX
+
+/**
+ * Budget configuration.
+ */
+typedef struct {
+    uint64_t daily_bytes;       /**< Allowance per calendar day (0 = unlimited) */
+    uint64_t monthly_bytes;     /**< Allowance per billing month (0 = unlimited) */
+    int billing_day;            /**< Day of month the billing period starts (1-28) */
+    int max_stretch;            /**< Largest interval multiplier for visible endpoints */
+    const char* state_path;     /**< Counter file (borrowed, NULL = not persisted) */
+} BandwidthBudgetConfig;
+
+/**
+ * Usage counters for the current periods.
+ */
+typedef struct {
+    uint64_t day_bytes;         /**< Bytes since local midnight */
+    uint64_t month_bytes;       /**< Bytes since the billing period started */
+    uint64_t requests;          /**< Requests recorded this billing period */
+} BandwidthUsage;
+
+// Lifecycle
+
+/**
+ * Create a bandwidth budget.
+ *
+ * @param config Budget configuration (required)
+ * @return New budget or NULL on error (caller owns)
+ * @note Loads saved counters from config->state_path if it exists;
+ *       counters from an earlier day or billing period are discarded
+ */
+BandwidthBudget* bandwidth_budget_create(const BandwidthBudgetConfig* config);
+
+/**
+ * Destroy a bandwidth budget.
+ *
+ * @param budget Budget to destroy (can be NULL)
+ * @note Saves the counters first when persistence is configured
+ */
+void bandwidth_budget_destroy(BandwidthBudget* budget);
+
+// Accounting
+
+/**
+ * Record the bytes one request moved.
+ *
+ * @param budget Bandwidth budget (required)
+ * @param service_id Service identifier (required)
+ * @param endpoint_id Endpoint identifier (required)
+ * @param bytes Bytes sent plus received, headers included
+ * @return PK_OK on success, error code on failure
+ * @note Bytes still count toward the totals when the endpoint table is full
+ */
+PkError bandwidth_budget_record(BandwidthBudget* budget, const char* service_id,
+                                const char* endpoint_id, uint64_t bytes);
+
+/**
+ * Mark whether an endpoint's data is currently on screen.
+ *
+ * @param budget Bandwidth budget (required)
+ * @param service_id Service identifier (required)
+ * @param endpoint_id Endpoint identifier (required)
+ * @param visible true while a visible page shows the endpoint's data
+ * @return PK_OK on success, error code on failure
+ * @note Endpoints are treated as visible until marked otherwise
+ */
+PkError bandwidth_budget_set_visible(BandwidthBudget* budget, const char* service_id,
+                                     const char* endpoint_id, bool visible);
+
+/**
+ * Scale an endpoint's refresh interval to fit the remaining budget.
+ *
+ * @param budget Bandwidth budget (required)
+ * @param service_id Service identifier (required)
+ * @param endpoint_id Endpoint identifier (required)
+ * @param base_interval_ms Interval the endpoint would use on an unmetered link
+ * @return Interval to wait before the next refresh, or BANDWIDTH_BUDGET_PAUSED
+ * @note Spending faster than an even pace across the rest of the period
+ *       stretches the interval by the overspend ratio, up to max_stretch.
+ *       Hidden endpoints are stretched four times further and paused once
+ *       90% of either allowance is used; visible ones keep polling at
+ *       max_stretch even when the budget is exhausted.
+ */
+uint32_t bandwidth_budget_scale_interval(BandwidthBudget* budget, const char* service_id,
+                                         const char* endpoint_id, uint32_t base_interval_ms);
+
+// Queries
+
+/**
+ * Get usage for one endpoint or for the whole budget.
+ *
+ * @param budget Bandwidth budget (required)
+ * @param service_id Service identifier (NULL for the whole budget)
+ * @param endpoint_id Endpoint identifier (NULL for all of the service's endpoints)
+ * @param usage Output counters (required)
+ * @return PK_OK on success, PK_ERROR_NOT_FOUND if nothing was recorded for the endpoint
+ */
+PkError bandwidth_budget_get_usage(BandwidthBudget* budget, const char* service_id,
+                                   const char* endpoint_id, BandwidthUsage* usage);
+
+/**
+ * Write the counters to the state file now.
+ *
+ * @param budget Bandwidth budget (required)
+ * @return PK_OK on success (or when not persisted), error code on failure
+ * @note Also happens automatically at most once a minute while recording
+ *       and at every day or billing period rollover
+ */
+PkError bandwidth_budget_save(BandwidthBudget* budget);
+
+/**
+ * Get default budget configuration.
+ *
+ * @return Unlimited budget with a billing period starting on the 1st
+ */
+BandwidthBudgetConfig bandwidth_budget_default_config(void);
+
+/**
+ * @note Thread Safety: All functions may be called from any thread; the
+ *       response callbacks of async requests record from worker threads.
+ */
+
+#endif // BANDWIDTH_BUDGET_H
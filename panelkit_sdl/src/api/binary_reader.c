@@ -0,0 +1,527 @@
+#include "binary_reader.h"
+#include <string.h>
+#include <math.h>
+
+// Decoded item header: what the next item is and how long its header is.
+// CBOR tags are folded into the header of the item they annotate.
+typedef struct {
+    BinaryType type;
+    size_t header_len;      // Bytes before the payload (or the whole scalar)
+    uint64_t length;        // String/bytes length, array/map entry count
+    int64_t int_value;
+    double float_value;
+    bool bool_value;
+} ItemHead;
+
+static bool available(const BinaryReader* reader, size_t offset, uint64_t count) {
+    size_t remaining = reader->size - reader->pos;
+    return offset <= remaining && count <= remaining - offset;
+}
+
+static uint64_t read_be(const uint8_t* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static double half_to_double(uint16_t half) {
+    int exponent = (half >> 10) & 0x1f;
+    int mantissa = half & 0x3ff;
+    double value;
+    if (exponent == 0) {
+        value = ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = mantissa == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+static double float_bits_to_double(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static double double_bits_to_double(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// Containers can't hold more items than there are bytes left; checking
+// here keeps skip() and decode loops bounded on hostile input
+static bool plausible_count(const BinaryReader* reader, const ItemHead* head) {
+    uint64_t min_bytes = head->type == BINARY_TYPE_MAP ? head->length * 2 : head->length;
+    if (head->type == BINARY_TYPE_MAP && head->length > UINT64_MAX / 2) {
+        return false;
+    }
+    return available(reader, head->header_len, min_bytes);
+}
+
+static bool cbor_head(const BinaryReader* reader, ItemHead* head) {
+    size_t offset = 0;
+
+    for (;;) {
+        if (!available(reader, offset, 1)) {
+            return false;
+        }
+        uint8_t initial = reader->data[reader->pos + offset];
+        int major = initial >> 5;
+        int info = initial & 0x1f;
+        offset++;
+
+        int arg_bytes = 0;
+        uint64_t arg = (uint64_t)info;
+        if (info >= 24 && info <= 27) {
+            arg_bytes = 1 << (info - 24);
+            if (!available(reader, offset, (uint64_t)arg_bytes)) {
+                return false;
+            }
+            arg = read_be(&reader->data[reader->pos + offset], arg_bytes);
+            offset += (size_t)arg_bytes;
+        } else if (info > 27) {
+            return false;  // Reserved or indefinite length
+        }
+
+        head->header_len = offset;
+        switch (major) {
+            case 0:
+                if (arg > INT64_MAX) {
+                    return false;
+                }
+                head->type = BINARY_TYPE_INT;
+                head->int_value = (int64_t)arg;
+                return true;
+            case 1:
+                if (arg > INT64_MAX) {
+                    return false;
+                }
+                head->type = BINARY_TYPE_INT;
+                head->int_value = -1 - (int64_t)arg;
+                return true;
+            case 2:
+            case 3:
+                head->type = major == 2 ? BINARY_TYPE_BYTES : BINARY_TYPE_STRING;
+                head->length = arg;
+                return available(reader, offset, arg);
+            case 4:
+            case 5:
+                head->type = major == 4 ? BINARY_TYPE_ARRAY : BINARY_TYPE_MAP;
+                head->length = arg;
+                return plausible_count(reader, head);
+            case 6:
+                continue;  // Tag: the annotated item follows
+            default:
+                break;
+        }
+
+        // Major type 7: simple values and floats
+        switch (info) {
+            case 20:
+            case 21:
+                head->type = BINARY_TYPE_BOOL;
+                head->bool_value = info == 21;
+                return true;
+            case 22:
+            case 23:
+                head->type = BINARY_TYPE_NIL;
+                return true;
+            case 25:
+                head->type = BINARY_TYPE_FLOAT;
+                head->float_value = half_to_double((uint16_t)arg);
+                return true;
+            case 26:
+                head->type = BINARY_TYPE_FLOAT;
+                head->float_value = float_bits_to_double((uint32_t)arg);
+                return true;
+            case 27:
+                head->type = BINARY_TYPE_FLOAT;
+                head->float_value = double_bits_to_double(arg);
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+static bool msgpack_sized(const BinaryReader* reader, ItemHead* head, BinaryType type,
+                          int size_bytes) {
+    if (!available(reader, 1, (uint64_t)size_bytes)) {
+        return false;
+    }
+    head->type = type;
+    head->header_len = 1 + (size_t)size_bytes;
+    head->length = read_be(&reader->data[reader->pos + 1], size_bytes);
+    if (type == BINARY_TYPE_ARRAY || type == BINARY_TYPE_MAP) {
+        return plausible_count(reader, head);
+    }
+    return available(reader, head->header_len, head->length);
+}
+
+static bool msgpack_number(const BinaryReader* reader, ItemHead* head, int bytes,
+                           bool is_signed) {
+    if (!available(reader, 1, (uint64_t)bytes)) {
+        return false;
+    }
+    uint64_t raw = read_be(&reader->data[reader->pos + 1], bytes);
+    head->type = BINARY_TYPE_INT;
+    head->header_len = 1 + (size_t)bytes;
+    if (!is_signed) {
+        if (raw > INT64_MAX) {
+            return false;
+        }
+        head->int_value = (int64_t)raw;
+    } else if (bytes < 8 && (raw >> (bytes * 8 - 1)) & 1) {
+        head->int_value = (int64_t)(raw | (~(uint64_t)0 << (bytes * 8)));
+    } else {
+        head->int_value = (int64_t)raw;
+    }
+    return true;
+}
+
+static bool msgpack_head(const BinaryReader* reader, ItemHead* head) {
+    if (!available(reader, 0, 1)) {
+        return false;
+    }
+    uint8_t b = reader->data[reader->pos];
+    head->header_len = 1;
+
+    if (b <= 0x7f) {
+        head->type = BINARY_TYPE_INT;
+        head->int_value = b;
+        return true;
+    }
+    if (b >= 0xe0) {
+        head->type = BINARY_TYPE_INT;
+        head->int_value = (int8_t)b;
+        return true;
+    }
+    if (b <= 0x8f || (b >= 0x90 && b <= 0x9f)) {
+        head->type = b <= 0x8f ? BINARY_TYPE_MAP : BINARY_TYPE_ARRAY;
+        head->length = b & 0x0f;
+        return plausible_count(reader, head);
+    }
+    if (b >= 0xa0 && b <= 0xbf) {
+        head->type = BINARY_TYPE_STRING;
+        head->length = b & 0x1f;
+        return available(reader, 1, head->length);
+    }
+
+    switch (b) {
+        case 0xc0:
+            head->type = BINARY_TYPE_NIL;
+            return true;
+        case 0xc2:
+        case 0xc3:
+            head->type = BINARY_TYPE_BOOL;
+            head->bool_value = b == 0xc3;
+            return true;
+        case 0xc4: return msgpack_sized(reader, head, BINARY_TYPE_BYTES, 1);
+        case 0xc5: return msgpack_sized(reader, head, BINARY_TYPE_BYTES, 2);
+        case 0xc6: return msgpack_sized(reader, head, BINARY_TYPE_BYTES, 4);
+        case 0xca:
+        case 0xcb: {
+            int bytes = b == 0xca ? 4 : 8;
+            if (!available(reader, 1, (uint64_t)bytes)) {
+                return false;
+            }
+            uint64_t raw = read_be(&reader->data[reader->pos + 1], bytes);
+            head->type = BINARY_TYPE_FLOAT;
+            head->header_len = 1 + (size_t)bytes;
+            head->float_value = bytes == 4 ? float_bits_to_double((uint32_t)raw)
+                                           : double_bits_to_double(raw);
+            return true;
+        }
+        case 0xcc: return msgpack_number(reader, head, 1, false);
+        case 0xcd: return msgpack_number(reader, head, 2, false);
+        case 0xce: return msgpack_number(reader, head, 4, false);
+        case 0xcf: return msgpack_number(reader, head, 8, false);
+        case 0xd0: return msgpack_number(reader, head, 1, true);
+        case 0xd1: return msgpack_number(reader, head, 2, true);
+        case 0xd2: return msgpack_number(reader, head, 4, true);
+        case 0xd3: return msgpack_number(reader, head, 8, true);
+        case 0xd9: return msgpack_sized(reader, head, BINARY_TYPE_STRING, 1);
+        case 0xda: return msgpack_sized(reader, head, BINARY_TYPE_STRING, 2);
+        case 0xdb: return msgpack_sized(reader, head, BINARY_TYPE_STRING, 4);
+        case 0xdc: return msgpack_sized(reader, head, BINARY_TYPE_ARRAY, 2);
+        case 0xdd: return msgpack_sized(reader, head, BINARY_TYPE_ARRAY, 4);
+        case 0xde: return msgpack_sized(reader, head, BINARY_TYPE_MAP, 2);
+        case 0xdf: return msgpack_sized(reader, head, BINARY_TYPE_MAP, 4);
+        default:
+            return false;  // Extension types and the never-used 0xc1
+    }
+}
+
+static bool peek_head(const BinaryReader* reader, ItemHead* head) {
+    if (reader->failed) {
+        return false;
+    }
+    memset(head, 0, sizeof(*head));
+    return reader->format == BINARY_FORMAT_CBOR ? cbor_head(reader, head)
+                                                : msgpack_head(reader, head);
+}
+
+// Read the next item's header, failing the reader unless it has the given type
+static bool take_head(BinaryReader* reader, BinaryType type, ItemHead* head) {
+    if (!peek_head(reader, head) || head->type != type) {
+        reader->failed = true;
+        return false;
+    }
+    reader->pos += head->header_len;
+    return true;
+}
+
+void binary_reader_init(BinaryReader* reader, BinaryFormat format,
+                        const void* data, size_t size) {
+    if (!reader) {
+        return;
+    }
+    reader->format = format;
+    reader->data = data;
+    reader->size = data ? size : 0;
+    reader->pos = 0;
+    reader->failed = data == NULL;
+}
+
+BinaryType binary_reader_peek(const BinaryReader* reader) {
+    ItemHead head;
+    return peek_head(reader, &head) ? head.type : BINARY_TYPE_INVALID;
+}
+
+bool binary_reader_failed(const BinaryReader* reader) {
+    return reader->failed;
+}
+
+bool binary_reader_map(BinaryReader* reader, size_t* count) {
+    ItemHead head;
+    if (!take_head(reader, BINARY_TYPE_MAP, &head)) {
+        return false;
+    }
+    *count = (size_t)head.length;
+    return true;
+}
+
+bool binary_reader_array(BinaryReader* reader, size_t* count) {
+    ItemHead head;
+    if (!take_head(reader, BINARY_TYPE_ARRAY, &head)) {
+        return false;
+    }
+    *count = (size_t)head.length;
+    return true;
+}
+
+bool binary_reader_nil(BinaryReader* reader) {
+    ItemHead head;
+    return take_head(reader, BINARY_TYPE_NIL, &head);
+}
+
+bool binary_reader_bool(BinaryReader* reader, bool* value) {
+    ItemHead head;
+    if (!take_head(reader, BINARY_TYPE_BOOL, &head)) {
+        return false;
+    }
+    *value = head.bool_value;
+    return true;
+}
+
+bool binary_reader_int(BinaryReader* reader, int64_t* value) {
+    ItemHead head;
+    if (!take_head(reader, BINARY_TYPE_INT, &head)) {
+        return false;
+    }
+    *value = head.int_value;
+    return true;
+}
+
+bool binary_reader_double(BinaryReader* reader, double* value) {
+    ItemHead head;
+    if (!peek_head(reader, &head) ||
+        (head.type != BINARY_TYPE_FLOAT && head.type != BINARY_TYPE_INT)) {
+        reader->failed = true;
+        return false;
+    }
+    reader->pos += head.header_len;
+    *value = head.type == BINARY_TYPE_FLOAT ? head.float_value : (double)head.int_value;
+    return true;
+}
+
+bool binary_reader_string(BinaryReader* reader, const char** str, size_t* len) {
+    ItemHead head;
+    if (!take_head(reader, BINARY_TYPE_STRING, &head)) {
+        return false;
+    }
+    *str = (const char*)&reader->data[reader->pos];
+    *len = (size_t)head.length;
+    reader->pos += (size_t)head.length;
+    return true;
+}
+
+bool binary_reader_string_copy(BinaryReader* reader, char* buffer, size_t buffer_size) {
+    const char* str;
+    size_t len;
+    if (!buffer || buffer_size == 0 || !binary_reader_string(reader, &str, &len)) {
+        return false;
+    }
+    size_t n = len < buffer_size - 1 ? len : buffer_size - 1;
+    memcpy(buffer, str, n);
+    buffer[n] = '\0';
+    return true;
+}
+
+bool binary_reader_bytes(BinaryReader* reader, const uint8_t** bytes, size_t* len) {
+    ItemHead head;
+    if (!take_head(reader, BINARY_TYPE_BYTES, &head)) {
+        return false;
+    }
+    *bytes = &reader->data[reader->pos];
+    *len = (size_t)head.length;
+    reader->pos += (size_t)head.length;
+    return true;
+}
+
+bool binary_reader_skip(BinaryReader* reader) {
+    // Count outstanding items instead of recursing, so nesting depth
+    // can't exhaust the stack
+    uint64_t pending = 1;
+    while (pending > 0) {
+        ItemHead head;
+        if (!peek_head(reader, &head)) {
+            reader->failed = true;
+            return false;
+        }
+        reader->pos += head.header_len;
+        pending--;
+        switch (head.type) {
+            case BINARY_TYPE_STRING:
+            case BINARY_TYPE_BYTES:
+                reader->pos += (size_t)head.length;
+                break;
+            case BINARY_TYPE_ARRAY:
+                pending += head.length;
+                break;
+            case BINARY_TYPE_MAP:
+                pending += head.length * 2;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+// Field tables
+
+static const BinaryField* find_field(const BinaryField* fields, size_t field_count,
+                                     const char* key, size_t key_len) {
+    for (size_t i = 0; i < field_count; i++) {
+        if (strlen(fields[i].key) == key_len && memcmp(fields[i].key, key, key_len) == 0) {
+            return &fields[i];
+        }
+    }
+    return NULL;
+}
+
+static bool decode_field(BinaryReader* reader, const BinaryField* field, void* output) {
+    char* target = (char*)output + field->offset;
+
+    switch (field->type) {
+        case BINARY_FIELD_STRING:
+            return binary_reader_string_copy(reader, target, field->size);
+        case BINARY_FIELD_INT: {
+            int64_t value;
+            if (!binary_reader_int(reader, &value)) {
+                return false;
+            }
+            if (value < INT32_MIN || value > INT32_MAX) {
+                reader->failed = true;
+                return false;
+            }
+            *(int*)target = (int)value;
+            return true;
+        }
+        case BINARY_FIELD_INT64:
+            return binary_reader_int(reader, (int64_t*)target);
+        case BINARY_FIELD_DOUBLE:
+            return binary_reader_double(reader, (double*)target);
+        case BINARY_FIELD_FLOAT: {
+            double value;
+            if (!binary_reader_double(reader, &value)) {
+                return false;
+            }
+            *(float*)target = (float)value;
+            return true;
+        }
+        case BINARY_FIELD_BOOL:
+            return binary_reader_bool(reader, (bool*)target);
+        case BINARY_FIELD_MAP:
+            return binary_reader_decode_map(reader, field->fields, field->field_count, output);
+        case BINARY_FIELD_FIRST: {
+            size_t count;
+            if (!binary_reader_array(reader, &count)) {
+                return false;
+            }
+            if (count == 0) {
+                return true;
+            }
+            if (!binary_reader_decode_map(reader, field->fields, field->field_count, output)) {
+                return false;
+            }
+            for (size_t i = 1; i < count; i++) {
+                if (!binary_reader_skip(reader)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+    reader->failed = true;
+    return false;
+}
+
+bool binary_reader_decode_map(BinaryReader* reader, const BinaryField* fields,
+                              size_t field_count, void* output) {
+    size_t count;
+    if (!binary_reader_map(reader, &count)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const BinaryField* field = NULL;
+        if (binary_reader_peek(reader) == BINARY_TYPE_STRING) {
+            const char* key = NULL;
+            size_t key_len = 0;
+            if (!binary_reader_string(reader, &key, &key_len)) {
+                return false;
+            }
+            field = find_field(fields, field_count, key, key_len);
+        } else if (!binary_reader_skip(reader)) {
+            return false;  // Non-string keys never match a field
+        }
+
+        if (!field) {
+            if (!binary_reader_skip(reader)) {
+                return false;
+            }
+        } else if (binary_reader_peek(reader) == BINARY_TYPE_NIL) {
+            binary_reader_nil(reader);
+        } else if (!decode_field(reader, field, output)) {
+            return false;
+        }
+    }
+    return !reader->failed;
+}
+
+const char* binary_format_string(BinaryFormat format) {
+    switch (format) {
+        case BINARY_FORMAT_CBOR:
+            return "CBOR";
+        case BINARY_FORMAT_MSGPACK:
+            return "MessagePack";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * @file binary_reader.h
+ * @brief Pull decoder for CBOR and MessagePack response bodies
+ *
+ * Reads values straight out of the response buffer: no token array, no
+ * tree, no allocation. Strings come back as pointers into the buffer.
+ * Callers walk the document with the typed read functions, or describe
+ * a map with a BinaryField table and let binary_reader_decode_map() copy
+ * matching keys into a struct (or a record bound for the state store).
+ *
+ * Only definite-length CBOR items are supported; our backends never
+ * stream, and rejecting indefinite lengths keeps skip() bounded.
+ */
+
+#ifndef BINARY_READER_H
+#define BINARY_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    BINARY_FORMAT_CBOR,
+    BINARY_FORMAT_MSGPACK
+} BinaryFormat;
+
+typedef enum {
+    BINARY_TYPE_INVALID,    // Truncated or unsupported item
+    BINARY_TYPE_NIL,
+    BINARY_TYPE_BOOL,
+    BINARY_TYPE_INT,
+    BINARY_TYPE_FLOAT,
+    BINARY_TYPE_STRING,
+    BINARY_TYPE_BYTES,
+    BINARY_TYPE_ARRAY,
+    BINARY_TYPE_MAP
+} BinaryType;
+
+/**
+ * Decoder cursor. Lives on the caller's stack; treat fields as private.
+ * After any failed read the reader stays failed and every later read
+ * returns false, so a parser can check once at the end.
+ */
+typedef struct {
+    BinaryFormat format;
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool failed;
+} BinaryReader;
+
+/**
+ * Start reading a buffer.
+ *
+ * @param reader Reader to initialize (required)
+ * @param format Wire format of the buffer
+ * @param data Encoded document (borrowed, must outlive the reader)
+ * @param size Length of data in bytes
+ */
+void binary_reader_init(BinaryReader* reader, BinaryFormat format,
+                        const void* data, size_t size);
+
+/** Type of the next item, without consuming it */
+BinaryType binary_reader_peek(const BinaryReader* reader);
+
+/** True once a read has failed (truncation, type mismatch, overflow) */
+bool binary_reader_failed(const BinaryReader* reader);
+
+// Containers: read the header, then the caller reads count items
+// (maps: count key/value pairs)
+bool binary_reader_map(BinaryReader* reader, size_t* count);
+bool binary_reader_array(BinaryReader* reader, size_t* count);
+
+// Scalars
+bool binary_reader_nil(BinaryReader* reader);
+bool binary_reader_bool(BinaryReader* reader, bool* value);
+bool binary_reader_int(BinaryReader* reader, int64_t* value);
+bool binary_reader_double(BinaryReader* reader, double* value);  // Accepts ints too
+
+/**
+ * Read a text string without copying.
+ *
+ * @param str Set to the first byte in the buffer (not NUL-terminated)
+ * @param len Set to the length in bytes
+ */
+bool binary_reader_string(BinaryReader* reader, const char** str, size_t* len);
+
+/** Read a text string into buffer, truncating and NUL-terminating */
+bool binary_reader_string_copy(BinaryReader* reader, char* buffer, size_t buffer_size);
+
+/** Read a byte string without copying */
+bool binary_reader_bytes(BinaryReader* reader, const uint8_t** bytes, size_t* len);
+
+/** Skip the next item, including everything nested inside it */
+bool binary_reader_skip(BinaryReader* reader);
+
+// Field tables
+
+typedef enum {
+    BINARY_FIELD_STRING,    // char[size], truncated and NUL-terminated
+    BINARY_FIELD_INT,       // int
+    BINARY_FIELD_INT64,     // int64_t
+    BINARY_FIELD_DOUBLE,    // double
+    BINARY_FIELD_FLOAT,     // float
+    BINARY_FIELD_BOOL,      // bool
+    BINARY_FIELD_MAP,       // Nested map decoded with fields/field_count
+    BINARY_FIELD_FIRST      // First element of an array, decoded as a map
+} BinaryFieldType;
+
+/**
+ * One map key and where its value goes. Offsets are relative to the
+ * output struct passed to binary_reader_decode_map(), including for
+ * nested tables, so nested documents can be flattened into one struct.
+ */
+typedef struct BinaryField {
+    const char* key;
+    BinaryFieldType type;
+    size_t offset;                      // offsetof(OutputStruct, member)
+    size_t size;                        // Buffer size for BINARY_FIELD_STRING
+    const struct BinaryField* fields;   // Nested table for MAP/FIRST
+    size_t field_count;
+} BinaryField;
+
+/**
+ * Decode a map into a struct using a field table.
+ *
+ * Unknown keys are skipped; missing keys leave the output untouched. A
+ * nil value also leaves the field untouched.
+ *
+ * @param reader Reader positioned at a map
+ * @param fields Field table
+ * @param field_count Number of entries in fields
+ * @param output Struct the offsets refer to
+ * @return true if the map was read to its end without errors
+ */
+bool binary_reader_decode_map(BinaryReader* reader, const BinaryField* fields,
+                              size_t field_count, void* output);
+
+const char* binary_format_string(BinaryFormat format);
+
+#endif // BINARY_READER_H
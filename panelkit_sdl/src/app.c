@@ -14,12 +14,25 @@
 #include "core/build_info.h"
 #include "core/error.h"
 #include "core/error_logger.h"
+#include "core/realtime.h"
+#include "core/watchdog.h"
+#include "core/profiler.h"
+#include "core/asset_bundle.h"
 #include "display/display_backend.h"
+#include "display/frame_scheduler.h"
+#include "display/render_pipeline.h"
+#include "display/rfb_server.h"
+#include "display/skin_atlas.h"
+#include "events/event_tap.h"
+#include "events/event_types.h"
 #include "input/input_handler.h"
 #include "input/input_debug.h"
+#include "server/headless_server.h"
+#include "state/state_event_bridge.h"
 
 // API modules
 #include "api/api_manager.h"
+#include "api/api_parsers.h"
 
 // Configuration system
 #include "config/config_manager.h"
@@ -28,15 +41,22 @@
 #include "ui/widget_integration.h"
 #include "ui/widget.h"
 #include "ui/widget_manager.h"
+#include "ui/widgets/page_manager_widget.h"
 
-// Embedded font data
+// Embedded font data (fallback when no asset bundle provides the font)
+#ifndef PANELKIT_NO_EMBEDDED_FONT
 #include "embedded_font.h"
+#endif
 
 // Default screen dimensions
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT 480
 
 // Actual runtime dimensions (will be set from display backend)
+// CPU lists are copied from the config as-is; a shorter buffer would cut
+// a list mid-number and pin threads to the wrong CPUs
+_Static_assert(REALTIME_MAX_CPU_LIST >= CONFIG_MAX_STRING, "realtime CPU list too short");
+
 static int actual_width = SCREEN_WIDTH;
 static int actual_height = SCREEN_HEIGHT;
 
@@ -49,6 +69,16 @@ static int actual_height = SCREEN_HEIGHT;
 SDL_Window* window = NULL;
 SDL_Renderer* renderer = NULL;
 DisplayBackend* display_backend = NULL;  // Display abstraction
+FrameScheduler* frame_scheduler = NULL;  // Vsync-aligned frame pacing
+RenderPipeline* render_pipeline = NULL;  // Display list handoff to render thread
+Watchdog* watchdog = NULL;               // Main loop stall detection
+Profiler* profiler = NULL;               // Sampling profiler (SIGUSR2)
+AssetBundle* asset_bundle = NULL;        // Mapped fonts and skins (NULL = compiled-in)
+RfbServer* rfb_server = NULL;            // Remote screen for support sessions
+static bool app_state_watched = false;   // "state.changed" events arrive
+static bool app_state_changed = true;    // app:bg_color or app:quit to re-read
+EventTap* event_tap = NULL;              // Live event stream for panelkit-tap
+SkinAtlas* skin_atlas = NULL;           // Nine-slice widget chrome (NULL = flat)
 InputHandler* input_handler = NULL;     // Input abstraction
 ConfigManager* config_manager = NULL;   // Configuration system
 TTF_Font* font = NULL;
@@ -80,12 +110,35 @@ SDL_Color text_colors[] = {
 
 // API manager
 ApiManager* api_manager = NULL;
+// Data budget for metered links (NULL = unmetered)
+BandwidthBudget* bandwidth_budget = NULL;
+// Page showing the user data, and the budget entry it is billed to
+#define USER_DATA_PAGE 1
+#define USER_DATA_SERVICE "randomuser"
+#define USER_DATA_ENDPOINT "get_user"
 // TODO: Remove - user data now stored in state store via widget integration
 UserData current_user_data = {0};
 
 // Widget integration layer (runs parallel to existing system)
 WidgetIntegration* widget_integration = NULL;
 
+// Displays after the first in display.outputs. Each has its own pages and
+// render pipeline; state, events, API data, fonts and skin are shared with
+// the primary display above.
+typedef struct {
+    DisplayBackend* backend;
+    RenderPipeline* pipeline;
+    WidgetIntegration* integration;
+    InputHandler* input;        // Own touch device (sdl_drm, fbdev), or NULL
+    char input_device[CONFIG_MAX_PATH];
+    Uint32 window_id;
+    int width;
+    int height;
+    uint64_t fps_presented;     // Frames presented at the last FPS update
+} SecondaryDisplay;
+static SecondaryDisplay secondary_displays[CONFIG_MAX_DISPLAYS - 1];
+static int secondary_display_count = 0;
+
 // Debug info
 bool show_debug = true;
 Uint32 frame_count = 0;
@@ -95,6 +148,14 @@ Uint32 fps = 0;
 // Function prototypes
 static void on_system_page_transition(const char* event_name, const void* data, size_t data_size, void* context);
 static void on_system_api_refresh(const char* event_name, const void* data, size_t data_size, void* context);
+static void on_state_changed(const char* event_name, const void* data, size_t data_size, void* context);
+static void on_remote_input(SDL_Event* event, void* user_data);
+static int parse_output_list(const char* list, int* outputs);
+static void secondary_displays_create(const Config* config, const DisplayConfig* primary_config,
+                                      const int* outputs, int output_count);
+static WidgetIntegration* integration_for_event(const SDL_Event* event);
+static void secondary_displays_render(SDL_Color bg_color, double dt, bool update_fps);
+static void secondary_displays_destroy(void);
 
 // API callback functions
 void on_api_data_received(const UserData* data, void* context);
@@ -102,20 +163,16 @@ void on_api_error(ApiError error, const char* message, void* context);
 void on_api_state_changed(ApiState state, void* context);
 
 // Simple text rendering for debug overlay
-void draw_text_left(const char* text, int x, int y, SDL_Color color) {
-    if (!text || !font || !renderer) return;
+void draw_text_left(DisplayList* list, const char* text, int x, int y, SDL_Color color) {
+    if (!list || !text || !font) return;
     
     SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
     if (!surface) return;
     
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture) {
-        SDL_Rect dst = {x, y, surface->w, surface->h};
-        SDL_RenderCopy(renderer, texture, NULL, &dst);
-        SDL_DestroyTexture(texture);
-    }
-    
-    SDL_FreeSurface(surface);
+    // Display list keeps its own reference until the frame is rendered
+    SDL_Rect dst = {x, y, surface->w, surface->h};
+    display_list_copy_surface(list, surface, NULL, &dst);
+    display_list_release_surface(surface);
 }
 
 
@@ -123,6 +180,7 @@ void draw_text_left(const char* text, int x, int y, SDL_Color color) {
 static DisplayBackendType backend_type_from_string(const char* str) {
     if (strcmp(str, "sdl") == 0) return DISPLAY_BACKEND_SDL;
     if (strcmp(str, "sdl_drm") == 0) return DISPLAY_BACKEND_SDL_DRM;
+    if (strcmp(str, "fbdev") == 0) return DISPLAY_BACKEND_FBDEV;
     return DISPLAY_BACKEND_AUTO;
 }
 
@@ -211,6 +269,7 @@ int main(int argc, char* argv[]) {
     int display_width = config->display.width;
     int display_height = config->display.height;
     bool portrait_mode = false;
+    const char* server_instances = config->system.server.instances;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
@@ -252,6 +311,10 @@ int main(int argc, char* argv[]) {
             backend_type = backend_type_from_string(backend);
             log_info("Display backend override: %s", backend);
             i++;
+        } else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc) {
+            server_instances = argv[i + 1];
+            log_info("Headless server mode: %s", server_instances);
+            i++;
         } else if (strcmp(argv[i], "--portrait") == 0) {
             portrait_mode = true;
             log_info("Portrait mode requested");
@@ -271,10 +334,11 @@ int main(int argc, char* argv[]) {
             printf("  --config-override <key=value>    Override configuration value\n");
             printf("  --validate-config <file>         Validate configuration file\n");
             printf("  --generate-config <file>         Generate default configuration\n");
-            printf("  --display-backend <sdl|sdl_drm>  Select display backend\n");
+            printf("  --display-backend <sdl|sdl_drm|fbdev>  Select display backend\n");
             printf("  --portrait                       Use portrait mode (swap width/height)\n");
             printf("  --width <pixels>                 Set display width\n");
             printf("  --height <pixels>                Set display height\n");
+            printf("  --server <instances>             Serve many headless panels (see docs/DISPLAY.md)\n");
             printf("  --help, -h                       Show this help\n");
             config_manager_destroy(config_manager);
             logger_shutdown();
@@ -290,15 +354,110 @@ int main(int argc, char* argv[]) {
         log_info("Portrait mode: %dx%d", display_width, display_height);
     }
     
+    // Real-time profile must be installed before any thread is created
+    const ConfigRealtime* rt_cfg = &config->system.realtime;
+    RealtimeConfig realtime_config = realtime_default_config();
+    realtime_config.enabled = rt_cfg->enabled;
+    realtime_config.round_robin = strcmp(rt_cfg->policy, "rr") == 0;
+    realtime_config.input_priority = rt_cfg->input_priority;
+    realtime_config.main_priority = rt_cfg->main_priority;
+    realtime_config.render_priority = rt_cfg->render_priority;
+    snprintf(realtime_config.input_cpus, sizeof(realtime_config.input_cpus), "%s", rt_cfg->input_cpus);
+    snprintf(realtime_config.main_cpus, sizeof(realtime_config.main_cpus), "%s", rt_cfg->main_cpus);
+    snprintf(realtime_config.render_cpus, sizeof(realtime_config.render_cpus), "%s", rt_cfg->render_cpus);
+    snprintf(realtime_config.background_cpus, sizeof(realtime_config.background_cpus), "%s",
+             rt_cfg->background_cpus);
+    realtime_config.lock_memory = rt_cfg->lock_memory;
+    realtime_config.prefault_heap_kb = (size_t)rt_cfg->prefault_heap_kb;
+    if (!realtime_init(&realtime_config)) {
+        log_warn("Continuing with default scheduling");
+    }
+    
+    // Sampling profiler: idle until SIGUSR2 unless autostarted
+    if (config->system.profiler.enabled) {
+        ProfilerConfig profiler_config = profiler_default_config();
+        profiler_config.frequency_hz = config->system.profiler.frequency_hz;
+        profiler_config.signal_toggle = config->system.profiler.signal_toggle;
+        snprintf(profiler_config.output, sizeof(profiler_config.output), "%s",
+                 config->system.profiler.output);
+        profiler = profiler_create(&profiler_config);
+        if (!profiler) {
+            log_warn("Profiler unavailable: %s", pk_get_last_error_context());
+        } else if (config->system.profiler.autostart && !profiler_start(profiler)) {
+            log_warn("Profiler autostart failed: %s", pk_get_last_error_context());
+        }
+    }
+    
+    // Fonts and skins from a mapped bundle; pages load as assets are read
+    const char* bundle_path = config->system.assets.bundle;
+    if (bundle_path[0]) {
+        bool self = strcmp(bundle_path, "self") == 0;
+        asset_bundle = self ? asset_bundle_open_self() : asset_bundle_open(bundle_path);
+        if (!asset_bundle && !(self && pk_get_last_error() == PK_ERROR_NOT_FOUND)) {
+            log_warn("Asset bundle unavailable: %s", pk_get_last_error_context());
+        }
+    }
+    
+    const void* font_data = NULL;
+    size_t font_size = 0;
+    bool font_from_bundle = false;
+    if (asset_bundle && asset_bundle_contains(asset_bundle, ASSET_BUNDLE_FONT_REGULAR)) {
+        AssetView font_view;
+        if (asset_bundle_get(asset_bundle, ASSET_BUNDLE_FONT_REGULAR, &font_view)) {
+            font_data = font_view.data;
+            font_size = font_view.size;
+            font_from_bundle = true;
+        } else {
+            log_warn("Bundled font unusable: %s", pk_get_last_error_context());
+        }
+    }
+#ifndef PANELKIT_NO_EMBEDDED_FONT
+    if (!font_data) {
+        font_data = embedded_font_data;
+        font_size = embedded_font_size;
+    }
+#endif
+    if (!font_data) {
+        log_error("No font: %s is not in an asset bundle and this build has none compiled in",
+                  ASSET_BUNDLE_FONT_REGULAR);
+        asset_bundle_close(asset_bundle);
+        profiler_destroy(profiler);
+        config_manager_destroy(config_manager);
+        realtime_shutdown();
+        logger_shutdown();
+        return 1;
+    }
+    
+    // Headless server mode replaces the display, input and main loop below
+    if (server_instances[0]) {
+        int status = headless_server_run(config, server_instances,
+                                         font_data, font_size, asset_bundle);
+        asset_bundle_close(asset_bundle);
+        profiler_destroy(profiler);
+        config_manager_destroy(config_manager);
+        realtime_shutdown();
+        log_info("=== PanelKit Shutdown Complete ===");
+        error_logger_shutdown();
+        logger_shutdown();
+        return status;
+    }
+    
     // Initialize display backend
     log_state_change("Display", "NONE", "INITIALIZING");
+    DisplayPixelFormat pixel_format = DISPLAY_PIXEL_FORMAT_XRGB8888;
+    display_pixel_format_parse(config->display.pixel_format, &pixel_format);
+    int outputs[CONFIG_MAX_DISPLAYS];
+    int output_count = parse_output_list(config->display.outputs, outputs);
     DisplayConfig display_config = {
         .width = display_width,
         .height = display_height,
         .title = "PanelKit",
         .backend_type = backend_type,
         .fullscreen = config->display.fullscreen,
-        .vsync = config->display.vsync
+        .vsync = config->display.vsync,
+        .pixel_format = pixel_format,
+        .dither = config->display.dither,
+        .output = outputs[0]
     };
     
     display_backend = display_backend_create(&display_config);
@@ -333,10 +492,10 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    // Load embedded font from memory
-    SDL_RWops* font_rw = SDL_RWFromConstMem(embedded_font_data, embedded_font_size);
+    // Load the font from memory (bundle mapping or compiled-in data)
+    SDL_RWops* font_rw = SDL_RWFromConstMem(font_data, (int)font_size);
     if (!font_rw) {
-        log_error("Failed to create RWops from embedded font data");
+        log_error("Failed to create RWops from font data");
         TTF_Quit();
         display_backend_destroy(display_backend);
         logger_shutdown();
@@ -346,7 +505,7 @@ int main(int argc, char* argv[]) {
     // Load font at different sizes - don't close RWops, TTF_OpenFontRW handles it
     font = TTF_OpenFontRW(font_rw, 1, config->ui.fonts.regular_size);  // The '1' means SDL will free the RWops
     if (!font) {
-        log_error("Failed to load font from embedded data: %s", TTF_GetError());
+        log_error("Failed to load font: %s", TTF_GetError());
         TTF_Quit();
         display_backend_destroy(display_backend);
         logger_shutdown();
@@ -354,7 +513,7 @@ int main(int argc, char* argv[]) {
     }
     
     // Load same font at larger size
-    SDL_RWops* large_font_rw = SDL_RWFromConstMem(embedded_font_data, embedded_font_size);
+    SDL_RWops* large_font_rw = SDL_RWFromConstMem(font_data, (int)font_size);
     large_font = TTF_OpenFontRW(large_font_rw, 1, config->ui.fonts.large_size);
     if (!large_font) {
         log_error("Failed to load large font: %s", TTF_GetError());
@@ -366,7 +525,7 @@ int main(int argc, char* argv[]) {
     }
     
     // Load same font at smaller size
-    SDL_RWops* small_font_rw = SDL_RWFromConstMem(embedded_font_data, embedded_font_size);
+    SDL_RWops* small_font_rw = SDL_RWFromConstMem(font_data, (int)font_size);
     small_font = TTF_OpenFontRW(small_font_rw, 1, config->ui.fonts.small_size);
     if (!small_font) {
         log_error("Failed to load small font: %s", TTF_GetError());
@@ -378,7 +537,9 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    log_info("Fonts loaded successfully from embedded data");
+    log_info("Fonts loaded from %s (%zu bytes)",
+             font_from_bundle ? "asset bundle" : "embedded data",
+             font_size);
     
     // Initialize input handler
     log_state_change("Input", "NONE", "INITIALIZING");
@@ -389,12 +550,19 @@ int main(int argc, char* argv[]) {
         .enable_mouse_emulation = config->input.mouse_emulation
     };
     
-    // If using SDL+DRM backend, switch to evdev input source
-    if (display_backend->type == DISPLAY_BACKEND_SDL_DRM) {
-        log_info("SDL+DRM backend detected, switching to evdev input source");
+    // SDL+DRM and fbdev render offscreen, so SDL delivers no touch events
+    if (display_backend->type == DISPLAY_BACKEND_SDL_DRM ||
+        display_backend->type == DISPLAY_BACKEND_FBDEV) {
+        log_info("%s backend detected, switching to evdev input source",
+                 display_backend_type_name(display_backend->type));
         input_config.source_type = INPUT_SOURCE_LINUX_EVDEV;
     }
     
+    // With several displays, motion must be told apart by window
+    if (output_count > 1) {
+        input_config.window_id = SDL_GetWindowID(window);
+    }
+    
     input_handler = input_handler_create(&input_config);
     if (!input_handler) {
         log_error("Failed to create input handler");
@@ -458,6 +626,41 @@ int main(int argc, char* argv[]) {
     api_manager_set_error_callback(api_manager, on_api_error, NULL);
     api_manager_set_state_callback(api_manager, on_api_state_changed, NULL);
     
+    // Bandwidth budget; without one the link is treated as unmetered
+    if (config->api.budget.daily_mb > 0 || config->api.budget.monthly_mb > 0) {
+        BandwidthBudgetConfig budget_config = bandwidth_budget_default_config();
+        budget_config.daily_bytes = (uint64_t)config->api.budget.daily_mb * 1024 * 1024;
+        budget_config.monthly_bytes = (uint64_t)config->api.budget.monthly_mb * 1024 * 1024;
+        budget_config.billing_day = config->api.budget.billing_day;
+        budget_config.max_stretch = config->api.budget.max_stretch;
+        budget_config.state_path = config->api.budget.state_file[0] ?
+            config->api.budget.state_file : NULL;
+        
+        bandwidth_budget = bandwidth_budget_create(&budget_config);
+        if (bandwidth_budget) {
+            api_manager_set_bandwidth_budget(api_manager, bandwidth_budget,
+                                             USER_DATA_SERVICE, USER_DATA_ENDPOINT);
+        } else {
+            log_warn("Failed to create bandwidth budget: %s - refreshing unmetered",
+                     pk_get_last_error_context());
+        }
+    }
+    
+    // Skin atlas for button chrome; fall back to flat widgets on failure
+    if (strcmp(config->ui.skin.source, "none") != 0) {
+        skin_atlas = skin_atlas_create(0, 0);
+        if (skin_atlas) {
+            PkError skin_err = skin_atlas_load_source(skin_atlas, config->ui.skin.source,
+                                                      config->ui.skin.slice, asset_bundle);
+            if (skin_err != PK_OK) {
+                log_warn("Failed to load skin '%s': %s - using flat widgets",
+                         config->ui.skin.source, pk_get_last_error_context());
+                skin_atlas_destroy(skin_atlas);
+                skin_atlas = NULL;
+            }
+        }
+    }
+    
     // Initialize widget integration layer (runs parallel to existing UI)
     widget_integration = widget_integration_create(renderer);
     if (!widget_integration) {
@@ -465,6 +668,15 @@ int main(int argc, char* argv[]) {
     } else {
         widget_integration_set_dimensions(widget_integration, actual_width, actual_height);
         widget_integration_set_fonts(widget_integration, font, large_font, small_font);
+        widget_integration_set_skin(widget_integration, skin_atlas);
+        widget_integration_set_video(widget_integration, config->ui.video.source,
+                                     config->ui.video.width, config->ui.video.height);
+        widget_integration_set_map(widget_integration, config->ui.map.source,
+                                   config->ui.map.cache_dir, config->ui.map.cache_mb,
+                                   config->ui.map.memory_mb);
+        widget_integration_set_map_view(widget_integration, config->ui.map.lat,
+                                        config->ui.map.lon, config->ui.map.zoom,
+                                        config->ui.map.min_zoom, config->ui.map.max_zoom);
         
         // Create shadow widgets that mirror existing UI structure
         widget_integration_create_shadow_widgets(widget_integration);
@@ -478,9 +690,32 @@ int main(int argc, char* argv[]) {
         // Subscribe to system events from widget integration
         EventSystem* event_system = widget_integration_get_event_system(widget_integration);
         if (event_system) {
+            event_set_dispatch_budget(event_system, (uint32_t)config->system.events.low_budget_us,
+                                      (uint32_t)config->system.events.max_defer_ms);
             event_subscribe(event_system, "system.page_transition", on_system_page_transition, NULL);
             event_subscribe(event_system, "system.api_refresh", on_system_api_refresh, NULL);
             log_info("Subscribed to system events: page_transition, api_refresh");
+            
+            // Store writes come back as queued "state.changed" events, so the
+            // loop re-reads app state only when it changed
+            if (state_event_bridge_init(widget_integration->state_store, event_system, NULL) == PK_OK) {
+                app_state_watched = event_subscribe(event_system, "state.changed",
+                                                    on_state_changed, NULL);
+            } else {
+                log_warn("State-event bridge unavailable: %s", pk_get_last_error_context());
+            }
+            
+            if (config->system.tap.enabled) {
+                event_tap = event_tap_create(event_system, config->system.tap.socket);
+                if (!event_tap) {
+                    log_warn("Event tap unavailable: %s", pk_get_last_error_context());
+                }
+            }
+        }
+        
+        if (bandwidth_budget) {
+            bandwidth_budget_set_visible(bandwidth_budget, USER_DATA_SERVICE, USER_DATA_ENDPOINT,
+                widget_integration_get_current_page(widget_integration) == USER_DATA_PAGE);
         }
         
         // Start with state tracking and event mirroring
@@ -490,14 +725,94 @@ int main(int argc, char* argv[]) {
     // Force initial API fetch immediately
     api_manager_fetch_user_async(api_manager);
     
+    // Frame scheduler (assume the display mode refresh until vblanks are measured)
+    FrameSchedulerConfig scheduler_config = frame_scheduler_default_config();
+    scheduler_config.late_latch = config->display.late_latch;
+    scheduler_config.safety_margin_us = config->display.frame_margin_us;
+    SDL_DisplayMode display_mode;
+    if (SDL_GetWindowDisplayMode(window, &display_mode) == 0 && display_mode.refresh_rate > 0) {
+        scheduler_config.target_fps = display_mode.refresh_rate;
+    }
+    frame_scheduler = frame_scheduler_create(&scheduler_config);
+    if (!frame_scheduler) {
+        log_warn("Frame scheduler unavailable, running without frame pacing");
+    }
+    
+    // Render pipeline (widgets record display lists, render thread presents them)
+    render_pipeline = render_pipeline_create(display_backend, frame_scheduler,
+                                             config->display.render_thread);
+    if (!render_pipeline) {
+        log_error("Failed to create render pipeline");
+        quit = true;
+    }
+    
+    // Further displays share everything above except the screen itself
+    if (output_count > 1 && widget_integration && render_pipeline) {
+        secondary_displays_create(config, &display_config, outputs, output_count);
+    }
+    
+    // Remote screen for support sessions (idle until a viewer connects)
+    if (config->system.remote.enabled && render_pipeline) {
+        RfbServerConfig remote_config = rfb_server_default_config();
+        remote_config.bind_address = config->system.remote.bind;
+        remote_config.port = config->system.remote.port;
+        remote_config.max_fps = config->system.remote.max_fps;
+        remote_config.idle_fps = config->system.remote.idle_fps;
+        remote_config.compression = config->system.remote.compression;
+        remote_config.view_only = config->system.remote.view_only;
+        remote_config.on_input = on_remote_input;
+        remote_config.input_user_data = input_handler;
+        rfb_server = rfb_server_create(&remote_config, actual_width, actual_height);
+        if (!rfb_server || !rfb_server_start(rfb_server)) {
+            log_warn("Remote screen unavailable: %s", pk_get_last_error_context());
+            rfb_server_destroy(rfb_server);
+            rfb_server = NULL;
+        } else {
+            render_pipeline_set_mirror(render_pipeline, rfb_server);
+        }
+    }
+    
+    // Stall watchdog monitors this thread from the first heartbeat on
+    if (config->system.watchdog.enabled) {
+        WatchdogConfig watchdog_config = watchdog_default_config();
+        watchdog_config.deadline_ms = config->system.watchdog.deadline_ms;
+        watchdog_config.systemd = config->system.watchdog.systemd;
+        watchdog_config.capture_stack = config->system.watchdog.capture_stack;
+        watchdog = watchdog_create(&watchdog_config);
+        if (!watchdog || !watchdog_start(watchdog)) {
+            log_warn("Watchdog unavailable: %s", pk_get_last_error_context());
+            watchdog_destroy(watchdog);
+            watchdog = NULL;
+        }
+    } else if (getenv("WATCHDOG_USEC")) {
+        log_warn("systemd WatchdogSec is set but system.watchdog is disabled; "
+                 "the service will be restarted");
+    }
+    watchdog_notify("READY=1");
+    
+    // Startup allocations are done: raise the main thread and lock memory.
+    // Threads created before this point set their own policy on entry.
+    realtime_enter(REALTIME_ROLE_MAIN);
+    realtime_lock_memory();
+    asset_bundle_unlock(asset_bundle);  // mlockall() read all of it in
+    
     // Main loop
     Uint32 last_time = SDL_GetTicks();
     while (!quit) {
+        watchdog_heartbeat(watchdog);
+        
+        // Hold the frame start back until just before the next vblank
+        watchdog_phase(watchdog, "wait");
+        frame_scheduler_wait(frame_scheduler);
+        frame_scheduler_begin_frame(frame_scheduler);
+        
         Uint32 current_time = SDL_GetTicks();
+        DisplayList* frame_list = render_pipeline_begin_frame(render_pipeline);
         
         // Note: SDL event processing happens below
         
         // Process SDL events for unified input handling
+        watchdog_phase(watchdog, "events");
         SDL_Event e;
         int event_count = 0;
         while (SDL_PollEvent(&e)) {
@@ -510,22 +825,32 @@ int main(int argc, char* argv[]) {
                 quit = true; // Will be synced from widget state
             }
             
-            // Forward SDL events to widget manager
-            if (widget_integration && widget_integration->widget_manager) {
-                widget_manager_handle_event(widget_integration->widget_manager, &e);
+            // Forward SDL events to the widget manager of the display they belong to
+            WidgetIntegration* target = integration_for_event(&e);
+            if (target && target->widget_manager) {
+                widget_manager_handle_event(target->widget_manager, &e);
             }
         }
         
+        // Queued events after input: touch-driven ones first, data
+        // refreshes within their budget (the rest wait for the next frame)
+        if (widget_integration) {
+            event_dispatch_pending(widget_integration_get_event_system(widget_integration));
+        }
+        
         // Always use widget rendering
         if (widget_integration && widget_integration->page_manager) {
             // === WIDGET MODE: Completely independent rendering path ===
             
             // Update API manager (still needed for data)
+            watchdog_phase(watchdog, "update");
             api_manager_update(api_manager, current_time);
             
-            // Get ALL state from widget system
-            SDL_Color widget_bg_color = {33, 33, 33, 255}; // Default
-            if (widget_integration && widget_integration->state_store) {
+            // Get ALL state from widget system (cached until it changes)
+            static SDL_Color widget_bg_color = {33, 33, 33, 255}; // Default
+            if (widget_integration && widget_integration->state_store &&
+                (app_state_changed || !app_state_watched)) {
+                app_state_changed = false;
                 size_t size;
                 time_t timestamp;
                 SDL_Color* stored_color = (SDL_Color*)state_store_get(widget_integration->state_store, 
@@ -545,14 +870,18 @@ int main(int argc, char* argv[]) {
             }
             
             // Clear screen with widget background color
-            SDL_SetRenderDrawColor(renderer, widget_bg_color.r, widget_bg_color.g, 
-                                 widget_bg_color.b, widget_bg_color.a);
-            SDL_RenderClear(renderer);
+            display_list_set_draw_color(frame_list, widget_bg_color.r, widget_bg_color.g, 
+                                        widget_bg_color.b, widget_bg_color.a);
+            display_list_clear(frame_list);
             
+            // Record and hand off the other displays' frames first
+            secondary_displays_render(widget_bg_color, (double)(current_time - last_time) / 1000.0,
+                                      current_time - fps_timer >= 1000);
         }
         
         if (widget_integration && widget_integration->page_manager) {
             // === WIDGET MODE RENDERING ===
+            watchdog_phase(watchdog, "record");
             
             // Update widget rendering based on current state
             widget_integration_update_rendering(widget_integration);
@@ -563,9 +892,16 @@ int main(int argc, char* argv[]) {
                                                        (double)(current_time - last_time) / 1000.0);
             }
             
+            // Late-latch the newest touch position into an active page drag
+            SDL_Event latest_motion;
+            if (input_handler &&
+                input_handler_peek_latest_motion(input_handler, &latest_motion)) {
+                page_manager_latch_motion(widget_integration->page_manager, &latest_motion);
+            }
+            
             // Use widget-based rendering
             if (widget_integration->page_manager->render) {
-                widget_integration->page_manager->render(widget_integration->page_manager, renderer);
+                widget_integration->page_manager->render(widget_integration->page_manager, frame_list);
             }
         }
         
@@ -581,7 +917,7 @@ int main(int argc, char* argv[]) {
                 widget_integration_get_current_page(widget_integration) : 0;
             snprintf(debug_line1, sizeof(debug_line1), "Page: %d | FPS: %d", 
                     widget_current_page + 1, fps);
-            draw_text_left(debug_line1, 10, actual_height - 55, (SDL_Color){255, 255, 255, 128});
+            draw_text_left(frame_list, debug_line1, 10, actual_height - 55, (SDL_Color){255, 255, 255, 128});
         }
         
         
@@ -598,37 +934,59 @@ int main(int argc, char* argv[]) {
             }
         }
         
-        // Update screen
-        SDL_RenderPresent(renderer);
-        display_backend_present(display_backend);
+        // Hand the finished frame to the render thread (or render it inline)
+        watchdog_phase(watchdog, "present");
+        render_pipeline_submit(render_pipeline);
+        
+        // Feed present timing back into the scheduler
+        uint64_t vblank_ns = 0;
+        display_backend_get_vblank_time(display_backend, &vblank_ns);
+        frame_scheduler_end_frame(frame_scheduler, vblank_ns);
         
-        // Frame limiting
-        Uint32 frame_time = SDL_GetTicks() - current_time;
-        if (frame_time < 16) {
-            SDL_Delay(16 - frame_time);
+        // Frame limiting fallback when no scheduler is available
+        if (!frame_scheduler) {
+            Uint32 frame_time = SDL_GetTicks() - current_time;
+            if (frame_time < 16) {
+                SDL_Delay(16 - frame_time);
+            }
         }
     }
     
     // Cleanup
     log_state_change("Application", "RUNNING", "SHUTTING_DOWN");
+    watchdog_notify("STOPPING=1");
+    watchdog_destroy(watchdog);
+    profiler_destroy(profiler);  // Writes a session still running
     
     if (api_manager) {
         api_manager_destroy(api_manager);
     }
+    api_parsers_cleanup();
+    bandwidth_budget_destroy(bandwidth_budget);
+    secondary_displays_destroy();  // Before the primary: they share its state and events
+    render_pipeline_destroy(render_pipeline);
+    rfb_server_destroy(rfb_server);  // After the pipeline: its render thread captures into it
+    frame_scheduler_destroy(frame_scheduler);
     if (input_handler) {
         input_handler_destroy(input_handler);
     }
     if (config_manager) {
         config_manager_destroy(config_manager);
     }
+    event_tap_destroy(event_tap);  // Before the event system it observes
     if (widget_integration) {
+        state_event_bridge_cleanup(widget_integration->state_store,
+                                   widget_integration_get_event_system(widget_integration));
         widget_integration_destroy(widget_integration);
     }
+    skin_atlas_destroy(skin_atlas);
     TTF_CloseFont(font);
     TTF_CloseFont(large_font);
     TTF_CloseFont(small_font);
     TTF_Quit();
+    asset_bundle_close(asset_bundle);  // After the fonts and skin that read from it
     display_backend_destroy(display_backend);
+    realtime_shutdown();
     
     log_info("=== PanelKit Shutdown Complete ===");
     error_logger_shutdown();
@@ -680,6 +1038,42 @@ static void on_system_page_transition(const char* event_name, const void* data,
     } *page_event = (void*)data;
     
     log_debug("System page transition event: %d -> %d", page_event->from_page, page_event->to_page);
+    
+    // Off-screen data can refresh more slowly on a metered link
+    if (bandwidth_budget) {
+        bandwidth_budget_set_visible(bandwidth_budget, USER_DATA_SERVICE, USER_DATA_ENDPOINT,
+                                     page_event->to_page == USER_DATA_PAGE);
+    }
+}
+
+// Store change notification (posted by the state-event bridge)
+static void on_state_changed(const char* event_name, const void* data, size_t data_size, void* context) {
+    (void)event_name; (void)context;
+    
+    const StateChangedEventData* change = data;
+    if (!change || data_size < sizeof(StateChangedEventData)) {
+        return;
+    }
+    if (change->listed_count < change->key_count) {
+        app_state_changed = true;  // Keys that did not fit may be ours
+        return;
+    }
+    const char* key = change->keys;
+    for (uint32_t i = 0; i < change->listed_count; i++) {
+        if (strcmp(key, "app:bg_color") == 0 || strcmp(key, "app:quit") == 0) {
+            app_state_changed = true;
+            return;
+        }
+        key += strlen(key) + 1;
+    }
+}
+
+// Remote viewer pointer input, called on the RFB server thread
+static void on_remote_input(SDL_Event* event, void* user_data) {
+    InputHandler* handler = user_data;
+    if (handler) {
+        input_handler_push_event(handler, event);
+    }
 }
 
 // Event handler for API refresh requests
@@ -691,8 +1085,208 @@ static void on_system_api_refresh(const char* event_name, const void* data, size
     // Trigger API refresh
     // TODO(Phase7): Remove global api_manager when old system is fully retired
     if (api_manager) {
-        api_manager_fetch_user_async(api_manager);
+        api_manager_refresh_now(api_manager);
         log_info("API refresh triggered via system event");
     }
 }
 
+
+// Parse display.outputs (validated by the config manager); returns the count
+static int parse_output_list(const char* list, int* outputs) {
+    int count = 0;
+    const char* p = list;
+    
+    while (*p && count < CONFIG_MAX_DISPLAYS) {
+        char* end;
+        outputs[count++] = (int)strtol(p, &end, 10);
+        if (end == p) {
+            count--;
+            break;
+        }
+        p = end;
+        while (*p == ' ' || *p == ',') p++;
+    }
+    
+    if (count == 0) {
+        outputs[count++] = 0;
+    }
+    return count;
+}
+
+// Nth entry of a comma-separated list, or NULL
+static const char* list_entry(const char* list, int index, char* buf, size_t size) {
+    const char* p = list;
+    for (int i = 0; i < index && p; i++) {
+        p = strchr(p, ',');
+        if (p) p++;
+    }
+    if (!p) {
+        return NULL;
+    }
+    while (*p == ' ') p++;
+    size_t len = strcspn(p, ", ");
+    if (len == 0 || len >= size) {
+        return NULL;
+    }
+    memcpy(buf, p, len);
+    buf[len] = '\0';
+    return buf;
+}
+
+// Open the displays after the first; a display that fails is skipped
+static void secondary_displays_create(const Config* config, const DisplayConfig* primary_config,
+                                      const int* outputs, int output_count) {
+    for (int i = 1; i < output_count; i++) {
+        SecondaryDisplay* display = &secondary_displays[secondary_display_count];
+        
+        // Same backend as the primary, on another output
+        DisplayConfig display_config = *primary_config;
+        display_config.backend_type = display_backend->type;
+        display_config.output = outputs[i];
+        // Windowed SDL presents every display on the main thread; waiting for
+        // vsync once per window would divide the frame rate
+        if (!display_backend->render_thread_safe) {
+            display_config.vsync = false;
+        }
+        
+        display->backend = display_backend_create(&display_config);
+        if (!display->backend) {
+            log_warn("Display output %d unavailable: %s", outputs[i], pk_get_last_error_context());
+            continue;
+        }
+        display->window_id = SDL_GetWindowID(display->backend->window);
+        SDL_GetWindowSize(display->backend->window, &display->width, &display->height);
+        
+        display->pipeline = render_pipeline_create(display->backend, NULL,
+                                                   config->display.render_thread);
+        display->integration = display->pipeline ?
+            widget_integration_create_for_display(display->backend->renderer,
+                                                  widget_integration, i) : NULL;
+        if (!display->integration) {
+            log_warn("Display output %d: %s", outputs[i], pk_get_last_error_context());
+            render_pipeline_destroy(display->pipeline);
+            display_backend_destroy(display->backend);
+            memset(display, 0, sizeof(*display));
+            continue;
+        }
+        
+        // Video and map widgets own a device or tile loader; they stay on the primary
+        widget_integration_set_dimensions(display->integration, display->width, display->height);
+        widget_integration_set_fonts(display->integration, font, large_font, small_font);
+        widget_integration_set_skin(display->integration, skin_atlas);
+        widget_integration_create_shadow_widgets(display->integration);
+        widget_integration_enable_events(display->integration);
+        widget_integration_enable_button_handling(display->integration);
+        
+        // Offscreen backends get touch from the display's own evdev device
+        const char* device = list_entry(config->input.extra_devices, i - 1,
+                                        display->input_device, sizeof(display->input_device));
+        if (input_handler && input_handler->config.source_type == INPUT_SOURCE_LINUX_EVDEV &&
+            device) {
+            InputConfig input_config = input_handler->config;
+            input_config.device_path = device;
+            input_config.auto_detect_devices = false;
+            input_config.window_id = display->window_id;
+            display->input = input_handler_create(&input_config);
+            if (!display->input || !input_handler_start(display->input)) {
+                log_warn("Display output %d: no touch input from %s", outputs[i], device);
+                input_handler_destroy(display->input);
+                display->input = NULL;
+            }
+        }
+        
+        log_info("Display output %d ready: %dx%d (%s)", outputs[i], display->width,
+                 display->height, display->backend->name);
+        secondary_display_count++;
+    }
+}
+
+// Widget layer an input event is for; events without a known window go to the primary
+static WidgetIntegration* integration_for_event(const SDL_Event* event) {
+    Uint32 window_id = 0;
+    switch (event->type) {
+        case SDL_MOUSEMOTION:
+            window_id = event->motion.windowID;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            window_id = event->button.windowID;
+            break;
+        case SDL_MOUSEWHEEL:
+            window_id = event->wheel.windowID;
+            break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            window_id = event->key.windowID;
+            break;
+        case SDL_WINDOWEVENT:
+            window_id = event->window.windowID;
+            break;
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+        case SDL_FINGERDOWN:
+        case SDL_FINGERUP:
+        case SDL_FINGERMOTION:
+            window_id = event->tfinger.windowID;
+            break;
+#endif
+        default:
+            break;
+    }
+    
+    for (int i = 0; window_id && i < secondary_display_count; i++) {
+        if (secondary_displays[i].window_id == window_id) {
+            return secondary_displays[i].integration;
+        }
+    }
+    return widget_integration;
+}
+
+// Record one frame per secondary display and hand it to its pipeline
+static void secondary_displays_render(SDL_Color bg_color, double dt, bool update_fps) {
+    for (int i = 0; i < secondary_display_count; i++) {
+        SecondaryDisplay* display = &secondary_displays[i];
+        WidgetIntegration* integration = display->integration;
+        DisplayList* list = render_pipeline_begin_frame(display->pipeline);
+        
+        display_list_set_draw_color(list, bg_color.r, bg_color.g, bg_color.b, bg_color.a);
+        display_list_clear(list);
+        
+        widget_integration_update_rendering(integration);
+        if (integration->page_manager) {
+            if (integration->page_manager->update) {
+                integration->page_manager->update(integration->page_manager, dt);
+            }
+            
+            SDL_Event latest_motion;
+            if (display->input &&
+                input_handler_peek_latest_motion(display->input, &latest_motion)) {
+                page_manager_latch_motion(integration->page_manager, &latest_motion);
+            }
+            
+            if (integration->page_manager->render) {
+                integration->page_manager->render(integration->page_manager, list);
+            }
+        }
+        
+        render_pipeline_submit(display->pipeline);
+        
+        if (update_fps) {
+            RenderPipelineStats stats;
+            render_pipeline_get_stats(display->pipeline, &stats);
+            widget_integration_update_fps(integration,
+                                          (Uint32)(stats.frames_presented - display->fps_presented));
+            display->fps_presented = stats.frames_presented;
+        }
+    }
+}
+
+static void secondary_displays_destroy(void) {
+    for (int i = 0; i < secondary_display_count; i++) {
+        SecondaryDisplay* display = &secondary_displays[i];
+        render_pipeline_destroy(display->pipeline);
+        input_handler_destroy(display->input);
+        widget_integration_destroy(display->integration);
+        display_backend_destroy(display->backend);
+    }
+    secondary_display_count = 0;
+}
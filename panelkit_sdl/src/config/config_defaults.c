@@ -12,8 +12,16 @@ void config_init_display_defaults(ConfigDisplay* display) {
     display->height = DEFAULT_DISPLAY_HEIGHT;
     display->fullscreen = DEFAULT_DISPLAY_FULLSCREEN;
     display->vsync = DEFAULT_DISPLAY_VSYNC;
+    display->late_latch = DEFAULT_DISPLAY_LATE_LATCH;
+    display->frame_margin_us = DEFAULT_DISPLAY_FRAME_MARGIN_US;
+    display->render_thread = DEFAULT_DISPLAY_RENDER_THREAD;
     strncpy(display->backend, DEFAULT_DISPLAY_BACKEND, CONFIG_MAX_STRING - 1);
     display->backend[CONFIG_MAX_STRING - 1] = '\0';
+    strncpy(display->pixel_format, DEFAULT_DISPLAY_PIXEL_FORMAT, CONFIG_MAX_STRING - 1);
+    display->pixel_format[CONFIG_MAX_STRING - 1] = '\0';
+    display->dither = DEFAULT_DISPLAY_DITHER;
+    strncpy(display->outputs, DEFAULT_DISPLAY_OUTPUTS, CONFIG_MAX_STRING - 1);
+    display->outputs[CONFIG_MAX_STRING - 1] = '\0';
 }
 
 void config_init_input_defaults(ConfigInput* input) {
@@ -30,6 +38,9 @@ void config_init_input_defaults(ConfigInput* input) {
     
     input->mouse_emulation = DEFAULT_INPUT_MOUSE_EMULATION;
     input->auto_detect_devices = DEFAULT_INPUT_AUTO_DETECT;
+    
+    strncpy(input->extra_devices, DEFAULT_INPUT_EXTRA_DEVICES, CONFIG_MAX_PATH - 1);
+    input->extra_devices[CONFIG_MAX_PATH - 1] = '\0';
 }
 
 void config_init_api_defaults(ConfigApi* api) {
@@ -46,6 +57,14 @@ void config_init_api_defaults(ConfigApi* api) {
     strncpy(api->default_user_agent, DEFAULT_API_USER_AGENT, CONFIG_MAX_STRING - 1);
     api->default_user_agent[CONFIG_MAX_STRING - 1] = '\0';
     
+    // Bandwidth budget (unlimited)
+    api->budget.daily_mb = DEFAULT_API_BUDGET_DAILY_MB;
+    api->budget.monthly_mb = DEFAULT_API_BUDGET_MONTHLY_MB;
+    api->budget.billing_day = DEFAULT_API_BUDGET_BILLING_DAY;
+    api->budget.max_stretch = DEFAULT_API_BUDGET_MAX_STRETCH;
+    strncpy(api->budget.state_file, DEFAULT_API_BUDGET_STATE_FILE, CONFIG_MAX_PATH - 1);
+    api->budget.state_file[CONFIG_MAX_PATH - 1] = '\0';
+    
     // Initialize with no services (will be allocated and populated from config)
     api->services = NULL;
     api->num_services = 0;
@@ -104,6 +123,33 @@ static void config_init_layout_defaults(LayoutConfig* layout) {
     layout->swipe_threshold = DEFAULT_LAYOUT_SWIPE_THRESHOLD;
 }
 
+static void config_init_skin_defaults(SkinConfig* skin) {
+    strncpy(skin->source, DEFAULT_SKIN_SOURCE, CONFIG_MAX_PATH - 1);
+    skin->source[CONFIG_MAX_PATH - 1] = '\0';
+    skin->slice = DEFAULT_SKIN_SLICE;
+}
+
+static void config_init_video_defaults(VideoConfig* video) {
+    strncpy(video->source, DEFAULT_VIDEO_SOURCE, CONFIG_MAX_PATH - 1);
+    video->source[CONFIG_MAX_PATH - 1] = '\0';
+    video->width = DEFAULT_VIDEO_WIDTH;
+    video->height = DEFAULT_VIDEO_HEIGHT;
+}
+
+static void config_init_map_defaults(MapConfig* map) {
+    strncpy(map->source, DEFAULT_MAP_SOURCE, CONFIG_MAX_PATH - 1);
+    map->source[CONFIG_MAX_PATH - 1] = '\0';
+    strncpy(map->cache_dir, DEFAULT_MAP_CACHE_DIR, CONFIG_MAX_PATH - 1);
+    map->cache_dir[CONFIG_MAX_PATH - 1] = '\0';
+    map->cache_mb = DEFAULT_MAP_CACHE_MB;
+    map->memory_mb = DEFAULT_MAP_MEMORY_MB;
+    map->min_zoom = DEFAULT_MAP_MIN_ZOOM;
+    map->max_zoom = DEFAULT_MAP_MAX_ZOOM;
+    map->zoom = DEFAULT_MAP_ZOOM;
+    map->lat = DEFAULT_MAP_LAT;
+    map->lon = DEFAULT_MAP_LON;
+}
+
 void config_init_ui_defaults(ConfigUI* ui) {
     if (!ui) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
@@ -114,6 +160,9 @@ void config_init_ui_defaults(ConfigUI* ui) {
     config_init_fonts_defaults(&ui->fonts);
     config_init_animations_defaults(&ui->animations);
     config_init_layout_defaults(&ui->layout);
+    config_init_skin_defaults(&ui->skin);
+    config_init_video_defaults(&ui->video);
+    config_init_map_defaults(&ui->map);
 }
 
 void config_init_logging_defaults(ConfigLogging* logging) {
@@ -144,6 +193,60 @@ void config_init_system_defaults(ConfigSystem* system) {
     system->allow_exit = DEFAULT_SYSTEM_ALLOW_EXIT;
     system->idle_timeout = DEFAULT_SYSTEM_IDLE_TIMEOUT;
     system->config_check_interval = DEFAULT_SYSTEM_CONFIG_CHECK_INTERVAL;
+    
+    // Real-time profile (off; CFS scheduling, no pinning)
+    ConfigRealtime* rt = &system->realtime;
+    rt->enabled = DEFAULT_REALTIME_ENABLED;
+    strncpy(rt->policy, DEFAULT_REALTIME_POLICY, CONFIG_MAX_STRING - 1);
+    rt->policy[CONFIG_MAX_STRING - 1] = '\0';
+    rt->input_priority = DEFAULT_REALTIME_INPUT_PRIORITY;
+    rt->main_priority = DEFAULT_REALTIME_MAIN_PRIORITY;
+    rt->render_priority = DEFAULT_REALTIME_RENDER_PRIORITY;
+    strncpy(rt->input_cpus, DEFAULT_REALTIME_CPUS, CONFIG_MAX_STRING - 1);
+    strncpy(rt->main_cpus, DEFAULT_REALTIME_CPUS, CONFIG_MAX_STRING - 1);
+    strncpy(rt->render_cpus, DEFAULT_REALTIME_CPUS, CONFIG_MAX_STRING - 1);
+    strncpy(rt->background_cpus, DEFAULT_REALTIME_CPUS, CONFIG_MAX_STRING - 1);
+    rt->lock_memory = DEFAULT_REALTIME_LOCK_MEMORY;
+    rt->prefault_heap_kb = DEFAULT_REALTIME_PREFAULT_HEAP_KB;
+    
+    // Frame-deadline watchdog
+    system->watchdog.enabled = DEFAULT_WATCHDOG_ENABLED;
+    system->watchdog.deadline_ms = DEFAULT_WATCHDOG_DEADLINE_MS;
+    system->watchdog.systemd = DEFAULT_WATCHDOG_SYSTEMD;
+    system->watchdog.capture_stack = DEFAULT_WATCHDOG_CAPTURE_STACK;
+    
+    // Remote screen mirroring
+    system->remote.enabled = DEFAULT_REMOTE_ENABLED;
+    strncpy(system->remote.bind, DEFAULT_REMOTE_BIND, CONFIG_MAX_STRING - 1);
+    system->remote.port = DEFAULT_REMOTE_PORT;
+    system->remote.max_fps = DEFAULT_REMOTE_MAX_FPS;
+    system->remote.idle_fps = DEFAULT_REMOTE_IDLE_FPS;
+    system->remote.compression = DEFAULT_REMOTE_COMPRESSION;
+    system->remote.view_only = DEFAULT_REMOTE_VIEW_ONLY;
+    
+    // Headless panel server
+    strncpy(system->server.instances, DEFAULT_SERVER_INSTANCES, CONFIG_MAX_PATH - 1);
+    system->server.workers = DEFAULT_SERVER_WORKERS;
+    system->server.fps = DEFAULT_SERVER_FPS;
+    system->server.base_port = DEFAULT_SERVER_BASE_PORT;
+    
+    // Queued event dispatch
+    system->events.low_budget_us = DEFAULT_EVENTS_LOW_BUDGET_US;
+    system->events.max_defer_ms = DEFAULT_EVENTS_MAX_DEFER_MS;
+    
+    // Event tap
+    system->tap.enabled = DEFAULT_TAP_ENABLED;
+    strncpy(system->tap.socket, DEFAULT_TAP_SOCKET, CONFIG_MAX_PATH - 1);
+    
+    // Sampling profiler
+    system->profiler.enabled = DEFAULT_PROFILER_ENABLED;
+    system->profiler.autostart = DEFAULT_PROFILER_AUTOSTART;
+    system->profiler.signal_toggle = DEFAULT_PROFILER_SIGNAL_TOGGLE;
+    system->profiler.frequency_hz = DEFAULT_PROFILER_FREQUENCY_HZ;
+    strncpy(system->profiler.output, DEFAULT_PROFILER_OUTPUT, CONFIG_MAX_PATH - 1);
+    
+    // Asset bundle
+    strncpy(system->assets.bundle, DEFAULT_ASSETS_BUNDLE, CONFIG_MAX_PATH - 1);
 }
 
 void config_init_defaults(Config* config) {
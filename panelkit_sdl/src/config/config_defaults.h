@@ -18,13 +18,20 @@
 #define DEFAULT_DISPLAY_HEIGHT 480
 #define DEFAULT_DISPLAY_FULLSCREEN false
 #define DEFAULT_DISPLAY_VSYNC true
+#define DEFAULT_DISPLAY_LATE_LATCH true
+#define DEFAULT_DISPLAY_FRAME_MARGIN_US 2000
+#define DEFAULT_DISPLAY_RENDER_THREAD true
 #define DEFAULT_DISPLAY_BACKEND "auto"
+#define DEFAULT_DISPLAY_PIXEL_FORMAT "xrgb8888"
+#define DEFAULT_DISPLAY_DITHER true
+#define DEFAULT_DISPLAY_OUTPUTS "0"
 
 // Input defaults
 #define DEFAULT_INPUT_SOURCE "auto"
 #define DEFAULT_INPUT_DEVICE_PATH "auto"
 #define DEFAULT_INPUT_MOUSE_EMULATION false
 #define DEFAULT_INPUT_AUTO_DETECT true
+#define DEFAULT_INPUT_EXTRA_DEVICES ""
 
 // API defaults
 #define DEFAULT_API_TIMEOUT_MS 10000
@@ -32,6 +39,11 @@
 #define DEFAULT_API_RETRY_DELAY_MS 1000
 #define DEFAULT_API_VERIFY_SSL true
 #define DEFAULT_API_USER_AGENT "PanelKit/1.0"
+#define DEFAULT_API_BUDGET_DAILY_MB 0
+#define DEFAULT_API_BUDGET_MONTHLY_MB 0
+#define DEFAULT_API_BUDGET_BILLING_DAY 1
+#define DEFAULT_API_BUDGET_MAX_STRETCH 16
+#define DEFAULT_API_BUDGET_STATE_FILE "/var/lib/panelkit/bandwidth.state"
 
 // UI Color defaults (Material Design inspired)
 #define DEFAULT_COLOR_BACKGROUND "#212121"
@@ -54,6 +66,24 @@
 #define DEFAULT_ANIMATION_SCROLL_FRICTION 0.95f
 #define DEFAULT_ANIMATION_BUTTON_PRESS_SCALE 0.95f
 
+// Skin defaults
+#define DEFAULT_SKIN_SOURCE "none"
+#define DEFAULT_SKIN_SLICE 12
+#define DEFAULT_VIDEO_SOURCE ""
+#define DEFAULT_VIDEO_WIDTH 640
+#define DEFAULT_VIDEO_HEIGHT 480
+
+// Map defaults
+#define DEFAULT_MAP_SOURCE ""
+#define DEFAULT_MAP_CACHE_DIR "/var/cache/panelkit/tiles"
+#define DEFAULT_MAP_CACHE_MB 256
+#define DEFAULT_MAP_MEMORY_MB 64
+#define DEFAULT_MAP_MIN_ZOOM 0
+#define DEFAULT_MAP_MAX_ZOOM 19
+#define DEFAULT_MAP_ZOOM 12.0
+#define DEFAULT_MAP_LAT 51.5074
+#define DEFAULT_MAP_LON -0.1278
+
 // UI Layout defaults
 #define DEFAULT_LAYOUT_BUTTON_PADDING 20
 #define DEFAULT_LAYOUT_HEADER_HEIGHT 60
@@ -75,6 +105,55 @@
 #define DEFAULT_SYSTEM_IDLE_TIMEOUT 0
 #define DEFAULT_SYSTEM_CONFIG_CHECK_INTERVAL 0
 
+// Real-time profile defaults
+#define DEFAULT_REALTIME_ENABLED false
+#define DEFAULT_REALTIME_POLICY "fifo"
+#define DEFAULT_REALTIME_INPUT_PRIORITY 60
+#define DEFAULT_REALTIME_MAIN_PRIORITY 50
+#define DEFAULT_REALTIME_RENDER_PRIORITY 45
+#define DEFAULT_REALTIME_CPUS ""
+#define DEFAULT_REALTIME_LOCK_MEMORY true
+#define DEFAULT_REALTIME_PREFAULT_HEAP_KB 8192
+
+// Watchdog defaults
+#define DEFAULT_WATCHDOG_ENABLED true
+#define DEFAULT_WATCHDOG_DEADLINE_MS 2000
+#define DEFAULT_WATCHDOG_SYSTEMD true
+#define DEFAULT_WATCHDOG_CAPTURE_STACK true
+
+// Remote screen defaults
+#define DEFAULT_REMOTE_ENABLED false
+#define DEFAULT_REMOTE_BIND "127.0.0.1"
+#define DEFAULT_REMOTE_PORT 5900
+#define DEFAULT_REMOTE_MAX_FPS 15
+#define DEFAULT_REMOTE_IDLE_FPS 2
+#define DEFAULT_REMOTE_COMPRESSION 6
+#define DEFAULT_REMOTE_VIEW_ONLY false
+
+// Headless panel server defaults
+#define DEFAULT_SERVER_INSTANCES ""
+#define DEFAULT_SERVER_WORKERS 0
+#define DEFAULT_SERVER_FPS 30
+#define DEFAULT_SERVER_BASE_PORT 0
+
+// Queued event dispatch defaults
+#define DEFAULT_EVENTS_LOW_BUDGET_US 2000
+#define DEFAULT_EVENTS_MAX_DEFER_MS 100
+
+// Event tap defaults
+#define DEFAULT_TAP_ENABLED true
+#define DEFAULT_TAP_SOCKET "/tmp/panelkit-events.sock"
+
+// Sampling profiler defaults
+#define DEFAULT_PROFILER_ENABLED true
+#define DEFAULT_PROFILER_AUTOSTART false
+#define DEFAULT_PROFILER_SIGNAL_TOGGLE true
+#define DEFAULT_PROFILER_FREQUENCY_HZ 99
+#define DEFAULT_PROFILER_OUTPUT "/tmp/panelkit-profile.folded"
+
+// Asset bundle defaults
+#define DEFAULT_ASSETS_BUNDLE "self"
+
 // Initialize a Config structure with all defaults
 void config_init_defaults(Config* config);
 
@@ -177,6 +177,31 @@ bool config_manager_load_file(ConfigManager* manager, const char* path, ConfigSo
     return true;
 }
 
+// Check a display.outputs list: 1 to CONFIG_MAX_DISPLAYS distinct indices 0-15
+static bool validate_output_list(const char* outputs) {
+    bool seen[16] = {false};
+    int count = 0;
+    const char* p = outputs;
+    
+    while (*p) {
+        char* end;
+        long index = strtol(p, &end, 10);
+        if (end == p || index < 0 || index > 15 || seen[index] ||
+            ++count > CONFIG_MAX_DISPLAYS) {
+            return false;
+        }
+        seen[index] = true;
+        while (*end == ' ') end++;
+        if (*end == ',') {
+            end++;
+        } else if (*end) {
+            return false;
+        }
+        p = end;
+    }
+    return count > 0;
+}
+
 // Validate critical configuration values and apply corrections
 static void validate_and_correct_config(Config* config) {
     bool corrected = false;
@@ -196,6 +221,214 @@ static void validate_and_correct_config(Config* config) {
         corrected = true;
     }
     
+    if (config->display.frame_margin_us < 0 || config->display.frame_margin_us > 100000) {
+        log_warn("Invalid frame margin %dus, using default %d",
+                 config->display.frame_margin_us, DEFAULT_DISPLAY_FRAME_MARGIN_US);
+        config->display.frame_margin_us = DEFAULT_DISPLAY_FRAME_MARGIN_US;
+        corrected = true;
+    }
+    
+    if (strcmp(config->display.pixel_format, "xrgb8888") != 0 &&
+        strcmp(config->display.pixel_format, "rgb565") != 0) {
+        log_warn("Invalid pixel format '%s', using default %s",
+                 config->display.pixel_format, DEFAULT_DISPLAY_PIXEL_FORMAT);
+        strncpy(config->display.pixel_format, DEFAULT_DISPLAY_PIXEL_FORMAT, CONFIG_MAX_STRING - 1);
+        corrected = true;
+    }
+    
+    if (!validate_output_list(config->display.outputs)) {
+        log_warn("Invalid display outputs '%s', using default \"%s\"",
+                 config->display.outputs, DEFAULT_DISPLAY_OUTPUTS);
+        strncpy(config->display.outputs, DEFAULT_DISPLAY_OUTPUTS, CONFIG_MAX_STRING - 1);
+        corrected = true;
+    }
+    
+    if (config->ui.skin.slice < 0 || config->ui.skin.slice > 256) {
+        log_warn("Invalid skin slice %d, using default %d",
+                 config->ui.skin.slice, DEFAULT_SKIN_SLICE);
+        config->ui.skin.slice = DEFAULT_SKIN_SLICE;
+        corrected = true;
+    }
+    
+    if (config->ui.video.width < 16 || config->ui.video.width > 4096 ||
+        config->ui.video.height < 16 || config->ui.video.height > 4096) {
+        log_warn("Invalid video capture size %dx%d, using default %dx%d",
+                 config->ui.video.width, config->ui.video.height,
+                 DEFAULT_VIDEO_WIDTH, DEFAULT_VIDEO_HEIGHT);
+        config->ui.video.width = DEFAULT_VIDEO_WIDTH;
+        config->ui.video.height = DEFAULT_VIDEO_HEIGHT;
+        corrected = true;
+    }
+    
+    if (config->ui.map.min_zoom < 0 || config->ui.map.max_zoom > 22 ||
+        config->ui.map.min_zoom > config->ui.map.max_zoom) {
+        log_warn("Invalid map zoom range %d-%d, using default %d-%d",
+                 config->ui.map.min_zoom, config->ui.map.max_zoom,
+                 DEFAULT_MAP_MIN_ZOOM, DEFAULT_MAP_MAX_ZOOM);
+        config->ui.map.min_zoom = DEFAULT_MAP_MIN_ZOOM;
+        config->ui.map.max_zoom = DEFAULT_MAP_MAX_ZOOM;
+        corrected = true;
+    }
+    
+    if (config->ui.map.memory_mb < 4 || config->ui.map.memory_mb > 1024 ||
+        config->ui.map.cache_mb < 0) {
+        log_warn("Invalid map cache sizes %d MB memory, %d MB disk, using defaults",
+                 config->ui.map.memory_mb, config->ui.map.cache_mb);
+        config->ui.map.memory_mb = DEFAULT_MAP_MEMORY_MB;
+        config->ui.map.cache_mb = DEFAULT_MAP_CACHE_MB;
+        corrected = true;
+    }
+    
+    if (config->ui.map.lat < -90.0 || config->ui.map.lat > 90.0 ||
+        config->ui.map.lon < -180.0 || config->ui.map.lon > 180.0) {
+        log_warn("Invalid map center %.4f,%.4f, using default",
+                 config->ui.map.lat, config->ui.map.lon);
+        config->ui.map.lat = DEFAULT_MAP_LAT;
+        config->ui.map.lon = DEFAULT_MAP_LON;
+        corrected = true;
+    }
+    
+    if (config->api.budget.daily_mb < 0 || config->api.budget.monthly_mb < 0) {
+        log_warn("Invalid API budget %d MB/day, %d MB/month, disabling budget",
+                 config->api.budget.daily_mb, config->api.budget.monthly_mb);
+        config->api.budget.daily_mb = 0;
+        config->api.budget.monthly_mb = 0;
+        corrected = true;
+    }
+    
+    if (config->api.budget.billing_day < 1 || config->api.budget.billing_day > 28) {
+        log_warn("Invalid API billing day %d, using default %d",
+                 config->api.budget.billing_day, DEFAULT_API_BUDGET_BILLING_DAY);
+        config->api.budget.billing_day = DEFAULT_API_BUDGET_BILLING_DAY;
+        corrected = true;
+    }
+    
+    if (config->api.budget.max_stretch < 1 || config->api.budget.max_stretch > 1000) {
+        log_warn("Invalid API budget max stretch %d, using default %d",
+                 config->api.budget.max_stretch, DEFAULT_API_BUDGET_MAX_STRETCH);
+        config->api.budget.max_stretch = DEFAULT_API_BUDGET_MAX_STRETCH;
+        corrected = true;
+    }
+    
+    ConfigRealtime* rt = &config->system.realtime;
+    if (strcmp(rt->policy, "fifo") != 0 && strcmp(rt->policy, "rr") != 0) {
+        log_warn("Invalid real-time policy '%s', using default '%s'",
+                 rt->policy, DEFAULT_REALTIME_POLICY);
+        strncpy(rt->policy, DEFAULT_REALTIME_POLICY, CONFIG_MAX_STRING - 1);
+        corrected = true;
+    }
+    
+    if (rt->input_priority < 1 || rt->input_priority > 99 ||
+        rt->main_priority < 1 || rt->main_priority > 99 ||
+        rt->render_priority < 1 || rt->render_priority > 99) {
+        log_warn("Invalid real-time priorities input=%d main=%d render=%d, using defaults",
+                 rt->input_priority, rt->main_priority, rt->render_priority);
+        rt->input_priority = DEFAULT_REALTIME_INPUT_PRIORITY;
+        rt->main_priority = DEFAULT_REALTIME_MAIN_PRIORITY;
+        rt->render_priority = DEFAULT_REALTIME_RENDER_PRIORITY;
+        corrected = true;
+    }
+    
+    if (rt->prefault_heap_kb < 0 || rt->prefault_heap_kb > 1024 * 1024) {
+        log_warn("Invalid real-time heap prefault %d KB, using default %d",
+                 rt->prefault_heap_kb, DEFAULT_REALTIME_PREFAULT_HEAP_KB);
+        rt->prefault_heap_kb = DEFAULT_REALTIME_PREFAULT_HEAP_KB;
+        corrected = true;
+    }
+    
+    if (config->system.watchdog.deadline_ms < 50 || config->system.watchdog.deadline_ms > 600000) {
+        log_warn("Invalid watchdog deadline %dms, using default %d",
+                 config->system.watchdog.deadline_ms, DEFAULT_WATCHDOG_DEADLINE_MS);
+        config->system.watchdog.deadline_ms = DEFAULT_WATCHDOG_DEADLINE_MS;
+        corrected = true;
+    }
+    
+    ConfigRemote* remote = &config->system.remote;
+    if (remote->port < 1 || remote->port > 65535) {
+        log_warn("Invalid remote screen port %d, using default %d",
+                 remote->port, DEFAULT_REMOTE_PORT);
+        remote->port = DEFAULT_REMOTE_PORT;
+        corrected = true;
+    }
+    
+    if (remote->max_fps < 1 || remote->max_fps > 60) {
+        log_warn("Invalid remote screen max_fps %d, using default %d",
+                 remote->max_fps, DEFAULT_REMOTE_MAX_FPS);
+        remote->max_fps = DEFAULT_REMOTE_MAX_FPS;
+        corrected = true;
+    }
+    
+    if (remote->idle_fps < 1 || remote->idle_fps > remote->max_fps) {
+        int idle_fps = DEFAULT_REMOTE_IDLE_FPS < remote->max_fps ?
+            DEFAULT_REMOTE_IDLE_FPS : remote->max_fps;
+        log_warn("Invalid remote screen idle_fps %d (1-%d), using %d",
+                 remote->idle_fps, remote->max_fps, idle_fps);
+        remote->idle_fps = idle_fps;
+        corrected = true;
+    }
+    
+    if (remote->compression < 1 || remote->compression > 9) {
+        log_warn("Invalid remote screen compression %d, using default %d",
+                 remote->compression, DEFAULT_REMOTE_COMPRESSION);
+        remote->compression = DEFAULT_REMOTE_COMPRESSION;
+        corrected = true;
+    }
+    
+    ConfigServer* server = &config->system.server;
+    if (server->workers < 0 || server->workers > 64) {
+        log_warn("Invalid server workers %d (0-64), using default %d",
+                 server->workers, DEFAULT_SERVER_WORKERS);
+        server->workers = DEFAULT_SERVER_WORKERS;
+        corrected = true;
+    }
+    
+    if (server->fps < 0 || server->fps > 240) {
+        log_warn("Invalid server fps %d (0-240), using default %d",
+                 server->fps, DEFAULT_SERVER_FPS);
+        server->fps = DEFAULT_SERVER_FPS;
+        corrected = true;
+    }
+    
+    if (server->base_port < 0 || server->base_port > 65535) {
+        log_warn("Invalid server base_port %d, disabling viewers", server->base_port);
+        server->base_port = 0;
+        corrected = true;
+    }
+    
+    ConfigEvents* events = &config->system.events;
+    if (events->low_budget_us < 0 || events->low_budget_us > 100000) {
+        log_warn("Invalid low-priority event budget %dus (0-100000), using default %d",
+                 events->low_budget_us, DEFAULT_EVENTS_LOW_BUDGET_US);
+        events->low_budget_us = DEFAULT_EVENTS_LOW_BUDGET_US;
+        corrected = true;
+    }
+    
+    if (events->max_defer_ms < 0 || events->max_defer_ms > 60000) {
+        log_warn("Invalid event max_defer_ms %d (0-60000), using default %d",
+                 events->max_defer_ms, DEFAULT_EVENTS_MAX_DEFER_MS);
+        events->max_defer_ms = DEFAULT_EVENTS_MAX_DEFER_MS;
+        corrected = true;
+    }
+    
+    if (config->system.tap.enabled && config->system.tap.socket[0] == '\0') {
+        log_warn("Event tap enabled without a socket path, using %s", DEFAULT_TAP_SOCKET);
+        strncpy(config->system.tap.socket, DEFAULT_TAP_SOCKET, CONFIG_MAX_PATH - 1);
+        corrected = true;
+    }
+    
+    ConfigProfiler* profiler = &config->system.profiler;
+    if (profiler->frequency_hz < 1 || profiler->frequency_hz > 1000) {
+        log_warn("Invalid profiler frequency %dHz (1-1000), using default %d",
+                 profiler->frequency_hz, DEFAULT_PROFILER_FREQUENCY_HZ);
+        profiler->frequency_hz = DEFAULT_PROFILER_FREQUENCY_HZ;
+        corrected = true;
+    }
+    if (profiler->enabled && profiler->output[0] == '\0') {
+        log_warn("Profiler enabled without an output path, using %s", DEFAULT_PROFILER_OUTPUT);
+        strncpy(profiler->output, DEFAULT_PROFILER_OUTPUT, CONFIG_MAX_PATH - 1);
+        corrected = true;
+    }
+    
     // Validate logging level
     if (strlen(config->logging.level) == 0) {
         log_warn("Empty logging level, using default 'info'");
@@ -266,6 +499,12 @@ bool config_manager_apply_override(ConfigManager* manager, const char* key, cons
     else if (strcmp(key, "display.fullscreen") == 0) {
         parse_bool(value, &manager->config.display.fullscreen);
     }
+    else if (strcmp(key, "display.late_latch") == 0) {
+        parse_bool(value, &manager->config.display.late_latch);
+    }
+    else if (strcmp(key, "display.render_thread") == 0) {
+        parse_bool(value, &manager->config.display.render_thread);
+    }
     else if (strcmp(key, "system.debug_overlay") == 0) {
         parse_bool(value, &manager->config.system.debug_overlay);
     }
@@ -323,39 +562,89 @@ void config_log_summary(const ConfigManager* manager) {
     const Config* cfg = &manager->config;
     
     log_info("=== Configuration Summary ===");
-    log_info("Display: %dx%d, fullscreen=%s, vsync=%s, backend=%s",
+    log_info("Display: %dx%d, fullscreen=%s, vsync=%s, backend=%s, format=%s%s",
              cfg->display.width, cfg->display.height,
              cfg->display.fullscreen ? "yes" : "no",
              cfg->display.vsync ? "yes" : "no",
-             cfg->display.backend);
+             cfg->display.backend, cfg->display.pixel_format,
+             cfg->display.dither ? " (dither)" : "");
+    log_info("Frame pacing: late_latch=%s, margin=%dus, render_thread=%s",
+             cfg->display.late_latch ? "yes" : "no",
+             cfg->display.frame_margin_us,
+             cfg->display.render_thread ? "yes" : "no");
+    
+    log_info("Outputs: %s", cfg->display.outputs);
     
-    log_info("Input: source=%s, device=%s, mouse_emulation=%s",
+    log_info("Input: source=%s, device=%s, mouse_emulation=%s%s%s",
              cfg->input.source,
              cfg->input.device_path,
-             cfg->input.mouse_emulation ? "yes" : "no");
+             cfg->input.mouse_emulation ? "yes" : "no",
+             cfg->input.extra_devices[0] ? ", extra=" : "",
+             cfg->input.extra_devices);
     
     log_info("API: default_timeout=%dms, verify_ssl=%s, num_services=%zu",
              cfg->api.default_timeout_ms,
              cfg->api.default_verify_ssl ? "yes" : "no",
              cfg->api.num_services);
+    if (cfg->api.budget.daily_mb > 0 || cfg->api.budget.monthly_mb > 0) {
+        log_info("API budget: %d MB/day, %d MB/month from day %d, max stretch %dx, state=%s",
+                 cfg->api.budget.daily_mb, cfg->api.budget.monthly_mb,
+                 cfg->api.budget.billing_day, cfg->api.budget.max_stretch,
+                 cfg->api.budget.state_file);
+    }
     
-    log_info("UI: fonts=%d/%d/%d, animations=%s, colors: bg=%s primary=%s",
+    log_info("UI: fonts=%d/%d/%d, animations=%s, colors: bg=%s primary=%s, skin=%s, video=%s, map=%s",
              cfg->ui.fonts.regular_size,
              cfg->ui.fonts.large_size,
              cfg->ui.fonts.small_size,
              cfg->ui.animations.enabled ? "yes" : "no",
              cfg->ui.colors.background,
-             cfg->ui.colors.primary);
+             cfg->ui.colors.primary,
+             cfg->ui.skin.source,
+             cfg->ui.video.source[0] ? cfg->ui.video.source : "off",
+             cfg->ui.map.source[0] ? cfg->ui.map.source : "off");
     
     log_info("Logging: level=%s, file=%s, console=%s",
              cfg->logging.level,
              cfg->logging.file,
              cfg->logging.console ? "yes" : "no");
     
-    log_info("System: debug_overlay=%s, allow_exit=%s, startup_page=%d",
+    log_info("System: debug_overlay=%s, allow_exit=%s, startup_page=%d, watchdog=%s, remote=%s",
              cfg->system.debug_overlay ? "yes" : "no",
              cfg->system.allow_exit ? "yes" : "no",
-             cfg->system.startup_page);
+             cfg->system.startup_page,
+             cfg->system.watchdog.enabled ? "on" : "off",
+             cfg->system.remote.enabled ? "on" : "off");
+    
+    if (cfg->system.server.instances[0]) {
+        log_info("Server: instances=%s, workers=%d, fps=%d, base_port=%d",
+                 cfg->system.server.instances, cfg->system.server.workers,
+                 cfg->system.server.fps, cfg->system.server.base_port);
+    }
+    
+    log_info("Events: low-priority budget=%dus, max_defer=%dms, tap=%s",
+             cfg->system.events.low_budget_us, cfg->system.events.max_defer_ms,
+             cfg->system.tap.enabled ? cfg->system.tap.socket : "off");
+    
+    if (cfg->system.profiler.enabled) {
+        log_info("Profiler: %dHz, autostart=%s, SIGUSR2 toggle=%s, output=%s",
+                 cfg->system.profiler.frequency_hz,
+                 cfg->system.profiler.autostart ? "yes" : "no",
+                 cfg->system.profiler.signal_toggle ? "yes" : "no",
+                 cfg->system.profiler.output);
+    }
+    
+    log_info("Assets: bundle=%s",
+             cfg->system.assets.bundle[0] ? cfg->system.assets.bundle : "none");
+    
+    if (cfg->system.realtime.enabled) {
+        log_info("Real-time: policy=%s, priorities input=%d main=%d render=%d, lock_memory=%s",
+                 cfg->system.realtime.policy,
+                 cfg->system.realtime.input_priority,
+                 cfg->system.realtime.main_priority,
+                 cfg->system.realtime.render_priority,
+                 cfg->system.realtime.lock_memory ? "yes" : "no");
+    }
     
     if (cfg->loaded_from[0]) {
         log_info("Loaded from: %s", cfg->loaded_from);
@@ -460,7 +749,13 @@ bool config_generate_default(const char* path, bool include_comments) {
     fprintf(file, "  height: %d\n", DEFAULT_DISPLAY_HEIGHT);
     fprintf(file, "  fullscreen: %s\n", DEFAULT_DISPLAY_FULLSCREEN ? "true" : "false");
     fprintf(file, "  vsync: %s\n", DEFAULT_DISPLAY_VSYNC ? "true" : "false");
-    fprintf(file, "  backend: \"%s\"  # Options: auto, sdl, sdl_drm\n\n", DEFAULT_DISPLAY_BACKEND);
+    fprintf(file, "  late_latch: %s\n", DEFAULT_DISPLAY_LATE_LATCH ? "true" : "false");
+    fprintf(file, "  frame_margin_us: %d\n", DEFAULT_DISPLAY_FRAME_MARGIN_US);
+    fprintf(file, "  render_thread: %s\n", DEFAULT_DISPLAY_RENDER_THREAD ? "true" : "false");
+    fprintf(file, "  backend: \"%s\"  # Options: auto, sdl, sdl_drm, fbdev\n", DEFAULT_DISPLAY_BACKEND);
+    fprintf(file, "  pixel_format: \"%s\"  # Options: xrgb8888, rgb565 (sdl_drm; fbdev follows the device)\n", DEFAULT_DISPLAY_PIXEL_FORMAT);
+    fprintf(file, "  dither: %s\n", DEFAULT_DISPLAY_DITHER ? "true" : "false");
+    fprintf(file, "  outputs: \"%s\"  # Output indices, e.g. \"0,1\"; the first is primary\n\n", DEFAULT_DISPLAY_OUTPUTS);
     
     // Input section
     if (include_comments) {
@@ -470,7 +765,8 @@ bool config_generate_default(const char* path, bool include_comments) {
     fprintf(file, "  source: \"%s\"  # Options: auto, sdl_native, evdev\n", DEFAULT_INPUT_SOURCE);
     fprintf(file, "  device_path: \"%s\"  # Device path or \"auto\"\n", DEFAULT_INPUT_DEVICE_PATH);
     fprintf(file, "  mouse_emulation: %s\n", DEFAULT_INPUT_MOUSE_EMULATION ? "true" : "false");
-    fprintf(file, "  auto_detect_devices: %s\n\n", DEFAULT_INPUT_AUTO_DETECT ? "true" : "false");
+    fprintf(file, "  auto_detect_devices: %s\n", DEFAULT_INPUT_AUTO_DETECT ? "true" : "false");
+    fprintf(file, "  extra_devices: \"%s\"  # Touch devices for the second and later outputs\n\n", DEFAULT_INPUT_EXTRA_DEVICES);
     
     // API section
     if (include_comments) {
@@ -486,6 +782,17 @@ bool config_generate_default(const char* path, bool include_comments) {
     fprintf(file, "  default_verify_ssl: %s\n", DEFAULT_API_VERIFY_SSL ? "true" : "false");
     fprintf(file, "  default_user_agent: \"%s\"\n\n", DEFAULT_API_USER_AGENT);
     
+    // Bandwidth budget
+    if (include_comments) {
+        fprintf(file, "  # Data budget for metered links; refreshes slow down to make it last\n");
+    }
+    fprintf(file, "  budget:\n");
+    fprintf(file, "    daily_mb: %d  # 0 = unlimited\n", DEFAULT_API_BUDGET_DAILY_MB);
+    fprintf(file, "    monthly_mb: %d  # 0 = unlimited\n", DEFAULT_API_BUDGET_MONTHLY_MB);
+    fprintf(file, "    billing_day: %d  # 1-28\n", DEFAULT_API_BUDGET_BILLING_DAY);
+    fprintf(file, "    max_stretch: %d\n", DEFAULT_API_BUDGET_MAX_STRETCH);
+    fprintf(file, "    state_file: \"%s\"\n\n", DEFAULT_API_BUDGET_STATE_FILE);
+    
     // Services
     fprintf(file, "  services:\n");
     
@@ -574,7 +881,34 @@ bool config_generate_default(const char* path, bool include_comments) {
     fprintf(file, "    header_height: %d\n", DEFAULT_LAYOUT_HEADER_HEIGHT);
     fprintf(file, "    margin: %d\n", DEFAULT_LAYOUT_MARGIN);
     fprintf(file, "    scroll_threshold: %d\n", DEFAULT_LAYOUT_SCROLL_THRESHOLD);
-    fprintf(file, "    swipe_threshold: %d\n\n", DEFAULT_LAYOUT_SWIPE_THRESHOLD);
+    fprintf(file, "    swipe_threshold: %d\n", DEFAULT_LAYOUT_SWIPE_THRESHOLD);
+    
+    // Skin subsection
+    fprintf(file, "  \n  skin:\n");
+    fprintf(file, "    source: \"%s\"  # \"none\", \"builtin\", or a directory of BMP images\n",
+            DEFAULT_SKIN_SOURCE);
+    fprintf(file, "    slice: %d\n", DEFAULT_SKIN_SLICE);
+    
+    // Video subsection
+    fprintf(file, "  \n  video:\n");
+    fprintf(file, "    source: \"%s\"  # MJPEG URL or /dev/videoN; empty to disable\n",
+            DEFAULT_VIDEO_SOURCE);
+    fprintf(file, "    width: %d\n", DEFAULT_VIDEO_WIDTH);
+    fprintf(file, "    height: %d\n", DEFAULT_VIDEO_HEIGHT);
+    
+    // Map subsection
+    fprintf(file, "  \n  map:\n");
+    fprintf(file, "    source: \"%s\"  # Tile path or URL with {z}/{x}/{y}; empty to disable\n",
+            DEFAULT_MAP_SOURCE);
+    fprintf(file, "    cache_dir: \"%s\"  # Disk cache for downloaded tiles\n",
+            DEFAULT_MAP_CACHE_DIR);
+    fprintf(file, "    cache_mb: %d\n", DEFAULT_MAP_CACHE_MB);
+    fprintf(file, "    memory_mb: %d\n", DEFAULT_MAP_MEMORY_MB);
+    fprintf(file, "    min_zoom: %d\n", DEFAULT_MAP_MIN_ZOOM);
+    fprintf(file, "    max_zoom: %d\n", DEFAULT_MAP_MAX_ZOOM);
+    fprintf(file, "    zoom: %.1f\n", DEFAULT_MAP_ZOOM);
+    fprintf(file, "    lat: %.4f\n", DEFAULT_MAP_LAT);
+    fprintf(file, "    lon: %.4f\n\n", DEFAULT_MAP_LON);
     
     // Logging section
     if (include_comments) {
@@ -598,6 +932,96 @@ bool config_generate_default(const char* path, bool include_comments) {
     fprintf(file, "  idle_timeout: %d  # seconds, 0 = disabled\n", DEFAULT_SYSTEM_IDLE_TIMEOUT);
     fprintf(file, "  config_check_interval: %d  # seconds, 0 = disabled\n", DEFAULT_SYSTEM_CONFIG_CHECK_INTERVAL);
     
+    // Real-time subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # Real-time scheduling for input/render threads (needs CAP_SYS_NICE)\n");
+        fprintf(file, "  # CPU lists pair well with isolcpus= on the kernel command line\n");
+    }
+    fprintf(file, "  realtime:\n");
+    fprintf(file, "    enabled: %s\n", DEFAULT_REALTIME_ENABLED ? "true" : "false");
+    fprintf(file, "    policy: \"%s\"  # \"fifo\" or \"rr\"\n", DEFAULT_REALTIME_POLICY);
+    fprintf(file, "    input_priority: %d\n", DEFAULT_REALTIME_INPUT_PRIORITY);
+    fprintf(file, "    main_priority: %d\n", DEFAULT_REALTIME_MAIN_PRIORITY);
+    fprintf(file, "    render_priority: %d\n", DEFAULT_REALTIME_RENDER_PRIORITY);
+    fprintf(file, "    input_cpus: \"%s\"  # e.g. \"3\"; empty = no pinning\n", DEFAULT_REALTIME_CPUS);
+    fprintf(file, "    main_cpus: \"%s\"\n", DEFAULT_REALTIME_CPUS);
+    fprintf(file, "    render_cpus: \"%s\"\n", DEFAULT_REALTIME_CPUS);
+    fprintf(file, "    background_cpus: \"%s\"  # e.g. \"0-1\"\n", DEFAULT_REALTIME_CPUS);
+    fprintf(file, "    lock_memory: %s\n", DEFAULT_REALTIME_LOCK_MEMORY ? "true" : "false");
+    fprintf(file, "    prefault_heap_kb: %d\n", DEFAULT_REALTIME_PREFAULT_HEAP_KB);
+    
+    // Watchdog subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # Stall detection: logs the main thread's stack when frames stop\n");
+    }
+    fprintf(file, "  watchdog:\n");
+    fprintf(file, "    enabled: %s\n", DEFAULT_WATCHDOG_ENABLED ? "true" : "false");
+    fprintf(file, "    deadline_ms: %d\n", DEFAULT_WATCHDOG_DEADLINE_MS);
+    fprintf(file, "    systemd: %s  # WATCHDOG=1 pings when run with WatchdogSec=\n",
+            DEFAULT_WATCHDOG_SYSTEMD ? "true" : "false");
+    fprintf(file, "    capture_stack: %s\n", DEFAULT_WATCHDOG_CAPTURE_STACK ? "true" : "false");
+    
+    // Remote screen subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # VNC server for support sessions (no authentication: keep it on\n");
+        fprintf(file, "  # loopback and connect through an SSH tunnel)\n");
+    }
+    fprintf(file, "  remote:\n");
+    fprintf(file, "    enabled: %s\n", DEFAULT_REMOTE_ENABLED ? "true" : "false");
+    fprintf(file, "    bind: \"%s\"\n", DEFAULT_REMOTE_BIND);
+    fprintf(file, "    port: %d\n", DEFAULT_REMOTE_PORT);
+    fprintf(file, "    max_fps: %d\n", DEFAULT_REMOTE_MAX_FPS);
+    fprintf(file, "    idle_fps: %d\n", DEFAULT_REMOTE_IDLE_FPS);
+    fprintf(file, "    compression: %d  # zlib level 1-9\n", DEFAULT_REMOTE_COMPRESSION);
+    fprintf(file, "    view_only: %s\n", DEFAULT_REMOTE_VIEW_ONLY ? "true" : "false");
+    
+    // Headless server subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # Headless server hosting many virtual panels (also --server FILE);\n");
+        fprintf(file, "  # the file lists one \"name config.yaml\" instance per line\n");
+    }
+    fprintf(file, "  server:\n");
+    fprintf(file, "    instances: \"%s\"\n", DEFAULT_SERVER_INSTANCES);
+    fprintf(file, "    workers: %d  # 0 = one per CPU\n", DEFAULT_SERVER_WORKERS);
+    fprintf(file, "    fps: %d  # per panel, 0 = unpaced\n", DEFAULT_SERVER_FPS);
+    fprintf(file, "    base_port: %d  # VNC port of the first instance, 0 = none\n",
+            DEFAULT_SERVER_BASE_PORT);
+    
+    // Event dispatch subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # Queued events: input first, data refreshes within a per-frame budget\n");
+    }
+    fprintf(file, "  events:\n");
+    fprintf(file, "    low_budget_us: %d  # 0 = unlimited\n", DEFAULT_EVENTS_LOW_BUDGET_US);
+    fprintf(file, "    max_defer_ms: %d  # older backlog may use a second budget\n",
+            DEFAULT_EVENTS_MAX_DEFER_MS);
+    
+    // Event tap subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # Live event stream for panelkit-tap; free until a client connects\n");
+    }
+    fprintf(file, "  tap:\n");
+    fprintf(file, "    enabled: %s\n", DEFAULT_TAP_ENABLED ? "true" : "false");
+    fprintf(file, "    socket: \"%s\"\n", DEFAULT_TAP_SOCKET);
+    
+    // Sampling profiler subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # Sampling profiler; kill -USR2 <pid> starts/stops a session\n");
+    }
+    fprintf(file, "  profiler:\n");
+    fprintf(file, "    enabled: %s\n", DEFAULT_PROFILER_ENABLED ? "true" : "false");
+    fprintf(file, "    autostart: %s\n", DEFAULT_PROFILER_AUTOSTART ? "true" : "false");
+    fprintf(file, "    signal_toggle: %s\n", DEFAULT_PROFILER_SIGNAL_TOGGLE ? "true" : "false");
+    fprintf(file, "    frequency_hz: %d\n", DEFAULT_PROFILER_FREQUENCY_HZ);
+    fprintf(file, "    output: \"%s\"\n", DEFAULT_PROFILER_OUTPUT);
+    
+    // Asset bundle subsection
+    if (include_comments) {
+        fprintf(file, "  \n  # Fonts and skins from a mapped bundle (panelkit-bundle); \"self\" = appended to the binary\n");
+    }
+    fprintf(file, "  assets:\n");
+    fprintf(file, "    bundle: \"%s\"\n", DEFAULT_ASSETS_BUNDLE);
+    
     fclose(file);
     
     log_info("Generated default configuration file: %s", path);
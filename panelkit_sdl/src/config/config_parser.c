@@ -125,9 +125,27 @@ static void process_key_value(ParseContext* ctx, const char* key, const char* va
         else if (strcmp(subkey, "vsync") == 0) {
             parse_bool(value, &ctx->config->display.vsync);
         }
+        else if (strcmp(subkey, "late_latch") == 0) {
+            parse_bool(value, &ctx->config->display.late_latch);
+        }
+        else if (strcmp(subkey, "frame_margin_us") == 0) {
+            ctx->config->display.frame_margin_us = atoi(value);
+        }
+        else if (strcmp(subkey, "render_thread") == 0) {
+            parse_bool(value, &ctx->config->display.render_thread);
+        }
         else if (strcmp(subkey, "backend") == 0) {
             strncpy(ctx->config->display.backend, value, CONFIG_MAX_STRING - 1);
         }
+        else if (strcmp(subkey, "pixel_format") == 0) {
+            strncpy(ctx->config->display.pixel_format, value, CONFIG_MAX_STRING - 1);
+        }
+        else if (strcmp(subkey, "dither") == 0) {
+            parse_bool(value, &ctx->config->display.dither);
+        }
+        else if (strcmp(subkey, "outputs") == 0) {
+            strncpy(ctx->config->display.outputs, value, CONFIG_MAX_STRING - 1);
+        }
         else {
             emit_warning(ctx, "Unknown display configuration key: %s", subkey);
         }
@@ -148,10 +166,36 @@ static void process_key_value(ParseContext* ctx, const char* key, const char* va
         else if (strcmp(subkey, "auto_detect_devices") == 0) {
             parse_bool(value, &ctx->config->input.auto_detect_devices);
         }
+        else if (strcmp(subkey, "extra_devices") == 0) {
+            strncpy(ctx->config->input.extra_devices, value, CONFIG_MAX_PATH - 1);
+        }
         else {
             emit_warning(ctx, "Unknown input configuration key: %s", subkey);
         }
     }
+    // API bandwidth budget subsection
+    else if (strncmp(path, "api.budget.", 11) == 0) {
+        const char* subkey = path + 11;
+        
+        if (strcmp(subkey, "daily_mb") == 0) {
+            ctx->config->api.budget.daily_mb = atoi(value);
+        }
+        else if (strcmp(subkey, "monthly_mb") == 0) {
+            ctx->config->api.budget.monthly_mb = atoi(value);
+        }
+        else if (strcmp(subkey, "billing_day") == 0) {
+            ctx->config->api.budget.billing_day = atoi(value);
+        }
+        else if (strcmp(subkey, "max_stretch") == 0) {
+            ctx->config->api.budget.max_stretch = atoi(value);
+        }
+        else if (strcmp(subkey, "state_file") == 0) {
+            strncpy(ctx->config->api.budget.state_file, value, CONFIG_MAX_PATH - 1);
+        }
+        else {
+            emit_warning(ctx, "Unknown API budget configuration key: %s", subkey);
+        }
+    }
     // API section
     else if (strncmp(path, "api.", 4) == 0) {
         const char* subkey = path + 4;
@@ -287,6 +331,72 @@ static void process_key_value(ParseContext* ctx, const char* key, const char* va
             emit_warning(ctx, "Unknown UI layout configuration key: %s", subkey);
         }
     }
+    // UI Skin section
+    else if (strncmp(path, "ui.skin.", 8) == 0) {
+        const char* subkey = path + 8;
+        
+        if (strcmp(subkey, "source") == 0) {
+            strncpy(ctx->config->ui.skin.source, value, CONFIG_MAX_PATH - 1);
+        }
+        else if (strcmp(subkey, "slice") == 0) {
+            ctx->config->ui.skin.slice = atoi(value);
+        }
+        else {
+            emit_warning(ctx, "Unknown UI skin configuration key: %s", subkey);
+        }
+    }
+    // UI Video section
+    else if (strncmp(path, "ui.video.", 9) == 0) {
+        const char* subkey = path + 9;
+        
+        if (strcmp(subkey, "source") == 0) {
+            strncpy(ctx->config->ui.video.source, value, CONFIG_MAX_PATH - 1);
+        }
+        else if (strcmp(subkey, "width") == 0) {
+            ctx->config->ui.video.width = atoi(value);
+        }
+        else if (strcmp(subkey, "height") == 0) {
+            ctx->config->ui.video.height = atoi(value);
+        }
+        else {
+            emit_warning(ctx, "Unknown UI video configuration key: %s", subkey);
+        }
+    }
+    // UI Map section
+    else if (strncmp(path, "ui.map.", 7) == 0) {
+        const char* subkey = path + 7;
+        
+        if (strcmp(subkey, "source") == 0) {
+            strncpy(ctx->config->ui.map.source, value, CONFIG_MAX_PATH - 1);
+        }
+        else if (strcmp(subkey, "cache_dir") == 0) {
+            strncpy(ctx->config->ui.map.cache_dir, value, CONFIG_MAX_PATH - 1);
+        }
+        else if (strcmp(subkey, "cache_mb") == 0) {
+            ctx->config->ui.map.cache_mb = atoi(value);
+        }
+        else if (strcmp(subkey, "memory_mb") == 0) {
+            ctx->config->ui.map.memory_mb = atoi(value);
+        }
+        else if (strcmp(subkey, "min_zoom") == 0) {
+            ctx->config->ui.map.min_zoom = atoi(value);
+        }
+        else if (strcmp(subkey, "max_zoom") == 0) {
+            ctx->config->ui.map.max_zoom = atoi(value);
+        }
+        else if (strcmp(subkey, "zoom") == 0) {
+            ctx->config->ui.map.zoom = atof(value);
+        }
+        else if (strcmp(subkey, "lat") == 0) {
+            ctx->config->ui.map.lat = atof(value);
+        }
+        else if (strcmp(subkey, "lon") == 0) {
+            ctx->config->ui.map.lon = atof(value);
+        }
+        else {
+            emit_warning(ctx, "Unknown UI map configuration key: %s", subkey);
+        }
+    }
     // Logging section
     else if (strncmp(path, "logging.", 8) == 0) {
         const char* subkey = path + 8;
@@ -311,6 +421,184 @@ static void process_key_value(ParseContext* ctx, const char* key, const char* va
             emit_warning(ctx, "Unknown logging configuration key: %s", subkey);
         }
     }
+    // System real-time profile subsection
+    else if (strncmp(path, "system.realtime.", 16) == 0) {
+        const char* subkey = path + 16;
+        ConfigRealtime* rt = &ctx->config->system.realtime;
+        
+        if (strcmp(subkey, "enabled") == 0) {
+            parse_bool(value, &rt->enabled);
+        }
+        else if (strcmp(subkey, "policy") == 0) {
+            strncpy(rt->policy, value, CONFIG_MAX_STRING - 1);
+        }
+        else if (strcmp(subkey, "input_priority") == 0) {
+            rt->input_priority = atoi(value);
+        }
+        else if (strcmp(subkey, "main_priority") == 0) {
+            rt->main_priority = atoi(value);
+        }
+        else if (strcmp(subkey, "render_priority") == 0) {
+            rt->render_priority = atoi(value);
+        }
+        else if (strcmp(subkey, "input_cpus") == 0) {
+            strncpy(rt->input_cpus, value, CONFIG_MAX_STRING - 1);
+        }
+        else if (strcmp(subkey, "main_cpus") == 0) {
+            strncpy(rt->main_cpus, value, CONFIG_MAX_STRING - 1);
+        }
+        else if (strcmp(subkey, "render_cpus") == 0) {
+            strncpy(rt->render_cpus, value, CONFIG_MAX_STRING - 1);
+        }
+        else if (strcmp(subkey, "background_cpus") == 0) {
+            strncpy(rt->background_cpus, value, CONFIG_MAX_STRING - 1);
+        }
+        else if (strcmp(subkey, "lock_memory") == 0) {
+            parse_bool(value, &rt->lock_memory);
+        }
+        else if (strcmp(subkey, "prefault_heap_kb") == 0) {
+            rt->prefault_heap_kb = atoi(value);
+        }
+        else {
+            emit_warning(ctx, "Unknown system realtime configuration key: %s", subkey);
+        }
+    }
+    // System watchdog subsection
+    else if (strncmp(path, "system.watchdog.", 16) == 0) {
+        const char* subkey = path + 16;
+        
+        if (strcmp(subkey, "enabled") == 0) {
+            parse_bool(value, &ctx->config->system.watchdog.enabled);
+        }
+        else if (strcmp(subkey, "deadline_ms") == 0) {
+            ctx->config->system.watchdog.deadline_ms = atoi(value);
+        }
+        else if (strcmp(subkey, "systemd") == 0) {
+            parse_bool(value, &ctx->config->system.watchdog.systemd);
+        }
+        else if (strcmp(subkey, "capture_stack") == 0) {
+            parse_bool(value, &ctx->config->system.watchdog.capture_stack);
+        }
+        else {
+            emit_warning(ctx, "Unknown system watchdog configuration key: %s", subkey);
+        }
+    }
+    // System remote screen subsection
+    else if (strncmp(path, "system.remote.", 14) == 0) {
+        const char* subkey = path + 14;
+        ConfigRemote* remote = &ctx->config->system.remote;
+        
+        if (strcmp(subkey, "enabled") == 0) {
+            parse_bool(value, &remote->enabled);
+        }
+        else if (strcmp(subkey, "bind") == 0) {
+            strncpy(remote->bind, value, CONFIG_MAX_STRING - 1);
+        }
+        else if (strcmp(subkey, "port") == 0) {
+            remote->port = atoi(value);
+        }
+        else if (strcmp(subkey, "max_fps") == 0) {
+            remote->max_fps = atoi(value);
+        }
+        else if (strcmp(subkey, "idle_fps") == 0) {
+            remote->idle_fps = atoi(value);
+        }
+        else if (strcmp(subkey, "compression") == 0) {
+            remote->compression = atoi(value);
+        }
+        else if (strcmp(subkey, "view_only") == 0) {
+            parse_bool(value, &remote->view_only);
+        }
+        else {
+            emit_warning(ctx, "Unknown system remote configuration key: %s", subkey);
+        }
+    }
+    // System headless server subsection
+    else if (strncmp(path, "system.server.", 14) == 0) {
+        const char* subkey = path + 14;
+        ConfigServer* server = &ctx->config->system.server;
+        
+        if (strcmp(subkey, "instances") == 0) {
+            strncpy(server->instances, value, CONFIG_MAX_PATH - 1);
+        }
+        else if (strcmp(subkey, "workers") == 0) {
+            server->workers = atoi(value);
+        }
+        else if (strcmp(subkey, "fps") == 0) {
+            server->fps = atoi(value);
+        }
+        else if (strcmp(subkey, "base_port") == 0) {
+            server->base_port = atoi(value);
+        }
+        else {
+            emit_warning(ctx, "Unknown system server configuration key: %s", subkey);
+        }
+    }
+    // System event dispatch subsection
+    else if (strncmp(path, "system.events.", 14) == 0) {
+        const char* subkey = path + 14;
+        ConfigEvents* events = &ctx->config->system.events;
+        
+        if (strcmp(subkey, "low_budget_us") == 0) {
+            events->low_budget_us = atoi(value);
+        }
+        else if (strcmp(subkey, "max_defer_ms") == 0) {
+            events->max_defer_ms = atoi(value);
+        }
+        else {
+            emit_warning(ctx, "Unknown system events configuration key: %s", subkey);
+        }
+    }
+    // System event tap subsection
+    else if (strncmp(path, "system.tap.", 11) == 0) {
+        const char* subkey = path + 11;
+        ConfigTap* tap = &ctx->config->system.tap;
+        
+        if (strcmp(subkey, "enabled") == 0) {
+            parse_bool(value, &tap->enabled);
+        }
+        else if (strcmp(subkey, "socket") == 0) {
+            strncpy(tap->socket, value, CONFIG_MAX_PATH - 1);
+        }
+        else {
+            emit_warning(ctx, "Unknown system tap configuration key: %s", subkey);
+        }
+    }
+    // System profiler subsection
+    else if (strncmp(path, "system.profiler.", 16) == 0) {
+        const char* subkey = path + 16;
+        ConfigProfiler* profiler = &ctx->config->system.profiler;
+        
+        if (strcmp(subkey, "enabled") == 0) {
+            parse_bool(value, &profiler->enabled);
+        }
+        else if (strcmp(subkey, "autostart") == 0) {
+            parse_bool(value, &profiler->autostart);
+        }
+        else if (strcmp(subkey, "signal_toggle") == 0) {
+            parse_bool(value, &profiler->signal_toggle);
+        }
+        else if (strcmp(subkey, "frequency_hz") == 0) {
+            profiler->frequency_hz = atoi(value);
+        }
+        else if (strcmp(subkey, "output") == 0) {
+            strncpy(profiler->output, value, CONFIG_MAX_PATH - 1);
+        }
+        else {
+            emit_warning(ctx, "Unknown system profiler configuration key: %s", subkey);
+        }
+    }
+    // System assets subsection
+    else if (strncmp(path, "system.assets.", 14) == 0) {
+        const char* subkey = path + 14;
+        
+        if (strcmp(subkey, "bundle") == 0) {
+            strncpy(ctx->config->system.assets.bundle, value, CONFIG_MAX_PATH - 1);
+        }
+        else {
+            emit_warning(ctx, "Unknown system assets configuration key: %s", subkey);
+        }
+    }
     // System section
     else if (strncmp(path, "system.", 7) == 0) {
         const char* subkey = path + 7;
@@ -17,6 +17,7 @@
 #define CONFIG_MAX_URL 512
 #define CONFIG_MAX_STRING 128
 #define CONFIG_MAX_COLOR 8  // #RRGGBB
+#define CONFIG_MAX_DISPLAYS 4  // Entries in display.outputs
 
 // Forward declaration
 typedef struct Config Config;
@@ -27,7 +28,13 @@ typedef struct {
     int height;
     bool fullscreen;
     bool vsync;
-    char backend[CONFIG_MAX_STRING];  // "auto", "sdl", "sdl_drm"
+    bool late_latch;                  // Vsync-aligned late frame start
+    int frame_margin_us;              // Safety margin before vblank
+    bool render_thread;               // Present display lists on a render thread
+    char backend[CONFIG_MAX_STRING];  // "auto", "sdl", "sdl_drm", "fbdev"
+    char pixel_format[CONFIG_MAX_STRING]; // "xrgb8888", "rgb565"
+    bool dither;                      // Ordered dither for images at 16 bits
+    char outputs[CONFIG_MAX_STRING];  // Output indices, e.g. "0" or "0,1" (first is primary)
 } ConfigDisplay;
 
 // Input configuration
@@ -36,6 +43,7 @@ typedef struct {
     char device_path[CONFIG_MAX_PATH]; // Device path or "auto"
     bool mouse_emulation;
     bool auto_detect_devices;
+    char extra_devices[CONFIG_MAX_PATH]; // Touch devices for displays after the first, comma-separated
 } ConfigInput;
 
 // Individual endpoint within an API
@@ -87,6 +95,15 @@ typedef struct {
     size_t max_endpoints;
 } ApiServiceConfig;
 
+// Data budget for metered links (0 MB = unlimited)
+typedef struct {
+    int daily_mb;                           // Allowance per calendar day
+    int monthly_mb;                         // Allowance per billing period
+    int billing_day;                        // Day of month the period starts (1-28)
+    int max_stretch;                        // Largest refresh interval multiplier
+    char state_file[CONFIG_MAX_PATH];       // Counters persisted across restarts
+} ApiBudgetConfig;
+
 // API configuration
 typedef struct {
     // Default settings for all APIs
@@ -96,6 +113,9 @@ typedef struct {
     bool default_verify_ssl;
     char default_user_agent[CONFIG_MAX_STRING];
     
+    // Bandwidth budget shared by all services
+    ApiBudgetConfig budget;
+    
     // Defined API services
     ApiServiceConfig* services;
     size_t num_services;
@@ -138,12 +158,41 @@ typedef struct {
     int swipe_threshold;
 } LayoutConfig;
 
+// Skin configuration
+typedef struct {
+    char source[CONFIG_MAX_PATH];  // "none", "builtin", or a directory of BMPs
+    int slice;                     // Nine-slice inset for images from a directory
+} SkinConfig;
+
+// Video feed configuration
+typedef struct {
+    char source[CONFIG_MAX_PATH];  // MJPEG URL or V4L2 device; empty disables the feed
+    int width;                     // Requested capture size for V4L2 devices
+    int height;
+} VideoConfig;
+
+// Map configuration
+typedef struct {
+    char source[CONFIG_MAX_PATH];     // Tile path or URL template; empty disables the map
+    char cache_dir[CONFIG_MAX_PATH];  // Disk cache for network tiles; empty for none
+    int cache_mb;                     // Disk cache budget
+    int memory_mb;                    // Decoded tiles kept in memory
+    int min_zoom;
+    int max_zoom;
+    double zoom;                      // Initial zoom level
+    double lat;                       // Initial center
+    double lon;
+} MapConfig;
+
 // UI configuration
 typedef struct {
     ColorScheme colors;
     FontConfig fonts;
     AnimationConfig animations;
     LayoutConfig layout;
+    SkinConfig skin;
+    VideoConfig video;
+    MapConfig map;
 } ConfigUI;
 
 // Logging configuration
@@ -155,6 +204,74 @@ typedef struct {
     bool console;
 } ConfigLogging;
 
+// Real-time scheduling profile (opt-in, needs CAP_SYS_NICE/RLIMIT_RTPRIO)
+typedef struct {
+    bool enabled;
+    char policy[CONFIG_MAX_STRING];         // "fifo" or "rr"
+    int input_priority;                     // 1-99, evdev reader thread
+    int main_priority;                      // 1-99, event loop
+    int render_priority;                    // 1-99, render pipeline thread
+    char input_cpus[CONFIG_MAX_STRING];     // CPU lists ("2", "2-3", "1,3"); empty = no pinning
+    char main_cpus[CONFIG_MAX_STRING];
+    char render_cpus[CONFIG_MAX_STRING];
+    char background_cpus[CONFIG_MAX_STRING];
+    bool lock_memory;                       // mlockall() once startup is done
+    int prefault_heap_kb;                   // Heap reserve made resident before locking
+} ConfigRealtime;
+
+// Frame-deadline watchdog
+typedef struct {
+    bool enabled;
+    int deadline_ms;                        // Main loop heartbeat age that counts as a stall
+    bool systemd;                           // Ping systemd (WatchdogSec=) while frames flow
+    bool capture_stack;                     // Backtrace of the stalled main thread
+} ConfigWatchdog;
+
+// Remote screen mirroring (RFB/VNC) for support sessions
+typedef struct {
+    bool enabled;
+    char bind[CONFIG_MAX_STRING];           // Listen address; loopback = SSH tunnel only
+    int port;
+    int max_fps;                            // Capture rate while the screen changes
+    int idle_fps;                           // Capture rate while it doesn't
+    int compression;                        // zlib level 1-9 (ZRLE)
+    bool view_only;                         // Ignore remote pointer input
+} ConfigRemote;
+
+// Headless multi-panel server (--server); each instance gets its own config
+typedef struct {
+    char instances[CONFIG_MAX_PATH];        // Instance list file; empty = normal panel mode
+    int workers;                            // Rasterizing threads, 0 = one per CPU
+    int fps;                                // Frames per panel per second, 0 = unpaced
+    int base_port;                          // RFB port of the first instance, 0 = no viewers
+} ConfigServer;
+
+// Queued event dispatch (see event_dispatch_pending)
+typedef struct {
+    int low_budget_us;                      // Per-frame time for low-priority events, 0 = unlimited
+    int max_defer_ms;                       // Backlog older than this may use a second budget, 0 = never
+} ConfigEvents;
+
+// Live event stream for panelkit-tap (costs nothing until a client connects)
+typedef struct {
+    bool enabled;
+    char socket[CONFIG_MAX_PATH];           // Unix socket path, created owner-only
+} ConfigTap;
+
+// In-process sampling profiler (folded stacks for flame graphs)
+typedef struct {
+    bool enabled;                           // Install the profiler; idle until a session starts
+    bool autostart;                         // Sample from startup until SIGUSR2 or exit
+    bool signal_toggle;                     // SIGUSR2 starts/stops a session
+    int frequency_hz;                       // Samples per CPU-second
+    char output[CONFIG_MAX_PATH];           // Folded stack file written per session
+} ConfigProfiler;
+
+// Read-only assets (fonts, skins) from a memory-mapped bundle
+typedef struct {
+    char bundle[CONFIG_MAX_PATH];           // Bundle file, "self" (appended to the binary) or "" for none
+} ConfigAssets;
+
 // System configuration
 typedef struct {
     int startup_page;
@@ -162,6 +279,14 @@ typedef struct {
     bool allow_exit;
     int idle_timeout;  // seconds, 0 = disabled
     char config_check_interval;  // seconds, 0 = disabled
+    ConfigRealtime realtime;
+    ConfigWatchdog watchdog;
+    ConfigRemote remote;
+    ConfigServer server;
+    ConfigEvents events;
+    ConfigTap tap;
+    ConfigProfiler profiler;
+    ConfigAssets assets;
 } ConfigSystem;
 
 // Main configuration structure
@@ -0,0 +1,424 @@
+/**
+ * @file asset_bundle.c
+ * @brief Memory-mapped asset bundle reader
+ */
+
+#define _GNU_SOURCE
+#include "asset_bundle.h"
+#include "logger.h"
+#include "error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "asset bundles are little-endian; add byte swapping for this target"
+#endif
+
+_Static_assert(sizeof(AssetBundleHeader) == 32, "bundle header layout");
+_Static_assert(sizeof(AssetBundleEntry) == 40, "bundle entry layout");
+_Static_assert(sizeof(AssetBundleTrailer) == 16, "bundle trailer layout");
+
+#define FNV64_OFFSET 0xcbf29ce484222325ull
+#define FNV64_PRIME 0x100000001b3ull
+
+struct AssetBundle {
+    uint8_t* map;                       /* Page-aligned start of the mapping */
+    size_t map_size;
+    uint64_t page_size;
+    const uint8_t* base;                /* Header */
+    const AssetBundleHeader* header;
+    const AssetBundleEntry* entries;
+    const char* names;
+
+    pthread_mutex_t mutex;              /* Guards inflated[] and the counters */
+    void** inflated;                    /* Per entry; NULL until first use */
+    uint64_t inflated_bytes;
+    uint64_t inflations;
+    uint64_t hash_failures;
+};
+
+uint64_t asset_bundle_hash(const void* data, size_t size) {
+    const uint8_t* p = data;
+    uint64_t hash = FNV64_OFFSET;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+/* Bytewise order, shorter first on a common prefix (matches strcmp) */
+static int compare_name(const AssetBundle* bundle, const AssetBundleEntry* entry,
+                        const char* name, size_t length) {
+    size_t common = entry->name_length < length ? entry->name_length : length;
+    int order = memcmp(bundle->names + entry->name_offset, name, common);
+    if (order != 0) {
+        return order;
+    }
+    return (entry->name_length > length) - (entry->name_length < length);
+}
+
+static int find_entry(const AssetBundle* bundle, const char* name) {
+    size_t length = strlen(name);
+    int low = 0;
+    int high = (int)bundle->header->entry_count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        int order = compare_name(bundle, &bundle->entries[mid], name, length);
+        if (order == 0) {
+            return mid;
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+/* Check the index against the mapping once, so lookups can trust it */
+static bool validate_index(const AssetBundle* bundle, const char* path) {
+    const AssetBundleHeader* header = bundle->header;
+    uint64_t data_end = header->bundle_size - sizeof(AssetBundleTrailer);
+    uint64_t index_end = sizeof(AssetBundleHeader) +
+                         (uint64_t)header->entry_count * sizeof(AssetBundleEntry);
+
+    if (memcmp(header->magic, ASSET_BUNDLE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != ASSET_BUNDLE_VERSION) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_DATA,
+            "asset_bundle_open: %s: bad header magic or version %u", path, header->version);
+        return false;
+    }
+    if (index_end > header->names_offset ||
+        (uint64_t)header->names_offset + header->names_size > data_end) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_DATA,
+            "asset_bundle_open: %s: index (%u entries) overruns the bundle",
+            path, header->entry_count);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header->entry_count; i++) {
+        const AssetBundleEntry* entry = &bundle->entries[i];
+        bool valid = entry->name_length > 0 && entry->name_length <= ASSET_BUNDLE_MAX_NAME &&
+                     (uint64_t)entry->name_offset + entry->name_length <= header->names_size &&
+                     entry->offset <= data_end &&
+                     entry->stored_size <= data_end - entry->offset &&
+                     entry->size <= SIZE_MAX &&
+                     (entry->compression == ASSET_COMPRESSION_DEFLATE ||
+                      (entry->compression == ASSET_COMPRESSION_NONE &&
+                       entry->stored_size == entry->size));
+        if (!valid) {
+            pk_set_last_error_with_context(PK_ERROR_INVALID_DATA,
+                "asset_bundle_open: %s: entry %u is out of bounds or malformed", path, i);
+            return false;
+        }
+        if (i > 0 && compare_name(bundle, &bundle->entries[i - 1],
+                                  bundle->names + entry->name_offset,
+                                  entry->name_length) >= 0) {
+            pk_set_last_error_with_context(PK_ERROR_INVALID_DATA,
+                "asset_bundle_open: %s: index not sorted at entry %u", path, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+AssetBundle* asset_bundle_open(const char* path) {
+    PK_CHECK_NULL_WITH_CONTEXT(path, PK_ERROR_NULL_PARAM, "asset_bundle_open: path is NULL");
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        pk_set_last_error_with_context(errno == ENOENT ? PK_ERROR_NOT_FOUND : PK_ERROR_SYSTEM,
+            "asset_bundle_open: cannot open %s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+    AssetBundleTrailer trailer;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(trailer) ||
+        pread(fd, &trailer, sizeof(trailer), st.st_size - (off_t)sizeof(trailer)) !=
+            (ssize_t)sizeof(trailer) ||
+        memcmp(trailer.magic, ASSET_BUNDLE_TRAILER_MAGIC, sizeof(trailer.magic)) != 0) {
+        close(fd);
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "asset_bundle_open: no asset bundle in %s", path);
+        return NULL;
+    }
+    if (trailer.bundle_size < sizeof(AssetBundleHeader) + sizeof(trailer) ||
+        trailer.bundle_size > (uint64_t)st.st_size) {
+        close(fd);
+        pk_set_last_error_with_context(PK_ERROR_INVALID_DATA,
+            "asset_bundle_open: %s: bundle size %llu does not fit the file",
+            path, (unsigned long long)trailer.bundle_size);
+        return NULL;
+    }
+
+    /* Map from the page holding the header; nothing is read until touched */
+    uint64_t start = (uint64_t)st.st_size - trailer.bundle_size;
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t map_offset = start & ~(page - 1);
+    size_t map_size = (size_t)((uint64_t)st.st_size - map_offset);
+    void* map = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, (off_t)map_offset);
+    int map_errno = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "asset_bundle_open: cannot map %s: %s", path, strerror(map_errno));
+        return NULL;
+    }
+
+    /* Assets are fetched individually; readahead would pull in the rest */
+    madvise(map, map_size, MADV_RANDOM);
+    /* Under mlockall(MCL_FUTURE) the mapping is locked as it faults in */
+    munlock(map, map_size);
+
+    AssetBundle* bundle = calloc(1, sizeof(AssetBundle));
+    if (!bundle) {
+        munmap(map, map_size);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "asset_bundle_open: allocation failed");
+        return NULL;
+    }
+    bundle->map = map;
+    bundle->map_size = map_size;
+    bundle->page_size = page;
+    bundle->base = bundle->map + (start - map_offset);
+    bundle->header = (const AssetBundleHeader*)bundle->base;
+    bundle->entries = (const AssetBundleEntry*)(bundle->base + sizeof(AssetBundleHeader));
+    bundle->names = (const char*)bundle->base + bundle->header->names_offset;
+    pthread_mutex_init(&bundle->mutex, NULL);
+
+    if (bundle->header->bundle_size != trailer.bundle_size) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_DATA,
+            "asset_bundle_open: %s: header and trailer disagree on the bundle size", path);
+        asset_bundle_close(bundle);
+        return NULL;
+    }
+    if (!validate_index(bundle, path)) {
+        asset_bundle_close(bundle);
+        return NULL;
+    }
+
+    bundle->inflated = calloc(bundle->header->entry_count ? bundle->header->entry_count : 1,
+                              sizeof(void*));
+    if (!bundle->inflated) {
+        asset_bundle_close(bundle);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "asset_bundle_open: allocation failed");
+        return NULL;
+    }
+
+    log_info("Asset bundle %s: %u assets, %llu bytes mapped", path,
+             bundle->header->entry_count, (unsigned long long)trailer.bundle_size);
+    return bundle;
+}
+
+AssetBundle* asset_bundle_open_self(void) {
+    return asset_bundle_open("/proc/self/exe");
+}
+
+void asset_bundle_close(AssetBundle* bundle) {
+    if (!bundle) {
+        return;
+    }
+    if (bundle->inflated) {
+        for (uint32_t i = 0; i < bundle->header->entry_count; i++) {
+            free(bundle->inflated[i]);
+        }
+        free(bundle->inflated);
+    }
+    pthread_mutex_destroy(&bundle->mutex);
+    munmap(bundle->map, bundle->map_size);
+    free(bundle);
+}
+
+void asset_bundle_unlock(AssetBundle* bundle) {
+    if (!bundle) {
+        return;
+    }
+    /* mlockall() read the whole bundle in; drop it and let the pages still
+     * in use (stored fonts, entries not yet inflated) fault back in */
+    munlock(bundle->map, bundle->map_size);
+    madvise(bundle->map, bundle->map_size, MADV_DONTNEED);
+}
+
+/* madvise over part of the mapping: the pages it touches, or only those it covers */
+static void advise_range(const AssetBundle* bundle, uint64_t offset, uint64_t size,
+                         int advice, bool covered_only) {
+    uintptr_t mask = (uintptr_t)bundle->page_size - 1;
+    uintptr_t begin = (uintptr_t)(bundle->base + offset);
+    uintptr_t end = begin + (uintptr_t)size;
+    if (covered_only) {
+        begin = (begin + mask) & ~mask;
+        end &= ~mask;
+    } else {
+        begin &= ~mask;
+        end = (end + mask) & ~mask;
+    }
+    if (end > begin) {
+        madvise((void*)begin, end - begin, advice);
+    }
+}
+
+/* Inflate an entry into a new buffer; called with the mutex held */
+static void* inflate_entry(AssetBundle* bundle, const AssetBundleEntry* entry) {
+#ifdef HAVE_ZLIB
+    void* data = malloc(entry->size ? (size_t)entry->size : 1);
+    if (!data) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "asset_bundle_get: cannot allocate %llu bytes",
+            (unsigned long long)entry->size);
+        return NULL;
+    }
+
+    uLongf length = (uLongf)entry->size;
+    int result = uncompress(data, &length, bundle->base + entry->offset,
+                            (uLong)entry->stored_size);
+    if (result != Z_OK || length != entry->size ||
+        asset_bundle_hash(data, length) != entry->hash) {
+        free(data);
+        bundle->hash_failures++;
+        pk_set_last_error_with_context(PK_ERROR_INVALID_DATA,
+            "asset_bundle_get: %.*s is corrupt (zlib %d, %lu of %llu bytes)",
+            (int)entry->name_length, bundle->names + entry->name_offset, result,
+            (unsigned long)length, (unsigned long long)entry->size);
+        return NULL;
+    }
+
+    /* The compressed pages are not needed again; drop them from RSS */
+    advise_range(bundle, entry->offset, entry->stored_size, MADV_DONTNEED, true);
+    bundle->inflated_bytes += entry->size;
+    bundle->inflations++;
+    return data;
+#else
+    (void)bundle;
+    pk_set_last_error_with_context(PK_ERROR_INVALID_STATE,
+        "asset_bundle_get: %.*s is compressed and this build has no zlib",
+        (int)entry->name_length, bundle->names + entry->name_offset);
+    return NULL;
+#endif
+}
+
+static bool get_entry(AssetBundle* bundle, int index, AssetView* view) {
+    const AssetBundleEntry* entry = &bundle->entries[index];
+
+    if (entry->compression == ASSET_COMPRESSION_NONE) {
+        /* Zero copy: fault a multi-page asset in with one request, not per page */
+        if (entry->size > bundle->page_size) {
+            advise_range(bundle, entry->offset, entry->size, MADV_WILLNEED, false);
+        }
+        view->data = bundle->base + entry->offset;
+        view->size = (size_t)entry->size;
+        view->hash = entry->hash;
+        return true;
+    }
+
+    pthread_mutex_lock(&bundle->mutex);
+    if (!bundle->inflated[index]) {
+        bundle->inflated[index] = inflate_entry(bundle, entry);
+    }
+    void* data = bundle->inflated[index];
+    pthread_mutex_unlock(&bundle->mutex);
+
+    if (!data) {
+        return false;
+    }
+    view->data = data;
+    view->size = (size_t)entry->size;
+    view->hash = entry->hash;
+    return true;
+}
+
+bool asset_bundle_get(AssetBundle* bundle, const char* name, AssetView* view) {
+    PK_CHECK_FALSE_WITH_CONTEXT(bundle && name && view, PK_ERROR_NULL_PARAM,
+                                "asset_bundle_get: bundle, name and view are required");
+
+    int index = find_entry(bundle, name);
+    if (index < 0) {
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "asset_bundle_get: no asset named %s", name);
+        return false;
+    }
+    return get_entry(bundle, index, view);
+}
+
+bool asset_bundle_contains(const AssetBundle* bundle, const char* name) {
+    return bundle && name && find_entry(bundle, name) >= 0;
+}
+
+uint32_t asset_bundle_count(const AssetBundle* bundle) {
+    return bundle ? bundle->header->entry_count : 0;
+}
+
+bool asset_bundle_info(const AssetBundle* bundle, uint32_t index, AssetInfo* info) {
+    PK_CHECK_FALSE_WITH_CONTEXT(bundle && info, PK_ERROR_NULL_PARAM,
+                                "asset_bundle_info: bundle and info are required");
+    if (index >= bundle->header->entry_count) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "asset_bundle_info: index %u out of range (%u entries)",
+            index, bundle->header->entry_count);
+        return false;
+    }
+
+    const AssetBundleEntry* entry = &bundle->entries[index];
+    memcpy(info->name, bundle->names + entry->name_offset, entry->name_length);
+    info->name[entry->name_length] = '\0';
+    info->size = entry->size;
+    info->stored_size = entry->stored_size;
+    info->hash = entry->hash;
+    info->compression = (AssetCompression)entry->compression;
+    return true;
+}
+
+uint32_t asset_bundle_verify(AssetBundle* bundle) {
+    if (!bundle) {
+        return 0;
+    }
+
+    uint32_t failures = 0;
+    for (uint32_t i = 0; i < bundle->header->entry_count; i++) {
+        const AssetBundleEntry* entry = &bundle->entries[i];
+        AssetView view;
+        if (!get_entry(bundle, (int)i, &view)) {
+            log_warn("Asset bundle: %s", pk_get_last_error_context());
+            failures++;
+            continue;
+        }
+        /* Inflated entries were checked when inflated; stored ones are checked here */
+        if (entry->compression == ASSET_COMPRESSION_NONE &&
+            asset_bundle_hash(view.data, view.size) != entry->hash) {
+            log_warn("Asset bundle: %.*s does not match its hash",
+                     (int)entry->name_length, bundle->names + entry->name_offset);
+            pthread_mutex_lock(&bundle->mutex);
+            bundle->hash_failures++;
+            pthread_mutex_unlock(&bundle->mutex);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+void asset_bundle_get_stats(AssetBundle* bundle, AssetBundleStats* stats) {
+    if (!bundle || !stats) {
+        return;
+    }
+    pthread_mutex_lock(&bundle->mutex);
+    stats->entries = bundle->header->entry_count;
+    stats->mapped_bytes = bundle->map_size;
+    stats->inflated_bytes = bundle->inflated_bytes;
+    stats->inflations = bundle->inflations;
+    stats->hash_failures = bundle->hash_failures;
+    pthread_mutex_unlock(&bundle->mutex);
+}
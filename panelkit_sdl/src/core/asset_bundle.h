@@ -0,0 +1,274 @@
+/**
+ * @file asset_bundle.h
+ * @brief Memory-mapped asset bundle with lazy per-asset decompression
+ *
+ * Fonts, skins and other read-only assets can ship as one indexed archive
+ * instead of being compiled into the binary as C arrays. The bundle is
+ * either a separate file or appended to the executable (open "self"), and
+ * is mapped read-only: pages are read from flash only when an asset is
+ * touched, and stay shared, clean page cache rather than private RSS.
+ *
+ * Entries are stored as-is or deflated (zlib). Stored entries are
+ * returned as pointers straight into the mapping (zero copy). Deflated
+ * entries are inflated on their first asset_bundle_get() and the copy is
+ * kept until the bundle is closed, so every caller shares one buffer.
+ * Every entry carries a 64-bit FNV-1a hash of its original content, which
+ * is checked after inflating and by asset_bundle_verify().
+ *
+ * Layout (little-endian, offsets relative to the header):
+ *
+ *   AssetBundleHeader
+ *   AssetBundleEntry[entry_count]   sorted by name (bytewise)
+ *   name table                      names, not NUL-terminated
+ *   entry data                      each aligned to ASSET_BUNDLE_ALIGN
+ *   AssetBundleTrailer              locates the header from the file end
+ *
+ * Because the trailer is found from the end of the file, the same bytes
+ * work as a standalone file or appended to an executable
+ * (panelkit-bundle create -a build/panelkit ...).
+ */
+
+#ifndef PANELKIT_ASSET_BUNDLE_H
+#define PANELKIT_ASSET_BUNDLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASSET_BUNDLE_MAGIC "PKASSET1"
+#define ASSET_BUNDLE_TRAILER_MAGIC "PKBUNDLE"
+#define ASSET_BUNDLE_VERSION 1
+
+/** Alignment of entry data within the bundle */
+#define ASSET_BUNDLE_ALIGN 16
+
+/** Longest asset name */
+#define ASSET_BUNDLE_MAX_NAME 255
+
+/** Name of the UI font within a bundle */
+#define ASSET_BUNDLE_FONT_REGULAR "fonts/regular.ttf"
+
+/** Entry compression */
+typedef enum {
+    ASSET_COMPRESSION_NONE = 0,     /**< Stored; served zero-copy */
+    ASSET_COMPRESSION_DEFLATE = 1   /**< zlib stream; inflated on first use */
+} AssetCompression;
+
+/** On-disk header */
+typedef struct {
+    char magic[8];                  /**< ASSET_BUNDLE_MAGIC */
+    uint32_t version;               /**< ASSET_BUNDLE_VERSION */
+    uint32_t entry_count;
+    uint32_t names_offset;          /**< Name table */
+    uint32_t names_size;
+    uint64_t bundle_size;           /**< Header through the trailer */
+} AssetBundleHeader;
+
+/** On-disk index entry */
+typedef struct {
+    uint64_t offset;                /**< Data */
+    uint64_t stored_size;           /**< Bytes in the bundle */
+    uint64_t size;                  /**< Bytes once decompressed */
+    uint64_t hash;                  /**< FNV-1a 64 of the decompressed bytes */
+    uint32_t name_offset;           /**< Into the name table */
+    uint16_t name_length;
+    uint8_t compression;            /**< AssetCompression */
+    uint8_t reserved;
+} AssetBundleEntry;
+
+/** On-disk trailer, the last bytes of the file */
+typedef struct {
+    uint64_t bundle_size;           /**< Same as the header's */
+    char magic[8];                  /**< ASSET_BUNDLE_TRAILER_MAGIC */
+} AssetBundleTrailer;
+
+/** Opaque bundle handle */
+typedef struct AssetBundle AssetBundle;
+
+/** Opaque writer handle */
+typedef struct AssetBundleWriter AssetBundleWriter;
+
+/**
+ * View of one asset. Valid until the bundle is closed.
+ */
+typedef struct {
+    const void* data;
+    size_t size;
+    uint64_t hash;                  /**< FNV-1a 64 of data */
+} AssetView;
+
+/**
+ * Description of one entry, for listing.
+ */
+typedef struct {
+    char name[ASSET_BUNDLE_MAX_NAME + 1];
+    uint64_t size;
+    uint64_t stored_size;
+    uint64_t hash;
+    AssetCompression compression;
+} AssetInfo;
+
+/**
+ * Bundle statistics.
+ */
+typedef struct {
+    uint32_t entries;
+    uint64_t mapped_bytes;          /**< Size of the read-only mapping */
+    uint64_t inflated_bytes;        /**< Heap held by inflated entries */
+    uint64_t inflations;            /**< Entries inflated so far */
+    uint64_t hash_failures;         /**< Entries that failed their hash check */
+} AssetBundleStats;
+
+/**
+ * FNV-1a 64 hash, as stored in entries.
+ *
+ * @param data Bytes to hash
+ * @param size Byte count
+ * @return Hash
+ */
+uint64_t asset_bundle_hash(const void* data, size_t size);
+
+/**
+ * Map a bundle: a standalone file or one appended to another file.
+ *
+ * @param path Bundle or executable path (required)
+ * @return New bundle or NULL on error (caller owns, error context set)
+ */
+AssetBundle* asset_bundle_open(const char* path);
+
+/**
+ * Map the bundle appended to the running executable.
+ *
+ * @return New bundle or NULL when there is none (error context set)
+ */
+AssetBundle* asset_bundle_open_self(void);
+
+/**
+ * Unlock the bundle mapping after mlockall(MCL_CURRENT), which faults in
+ * and pins every page of it, and drop the pages from RSS again. Until
+ * then MADV_DONTNEED cannot release the compressed pages of inflated
+ * entries. Bundles opened while MCL_FUTURE is in effect unlock themselves.
+ *
+ * @param bundle Bundle (can be NULL)
+ */
+void asset_bundle_unlock(AssetBundle* bundle);
+
+/**
+ * Unmap the bundle and free inflated entries. Views become invalid.
+ *
+ * @param bundle Bundle to close (can be NULL)
+ */
+void asset_bundle_close(AssetBundle* bundle);
+
+/**
+ * Look up an asset, inflating it on first use.
+ *
+ * @param bundle Bundle (required)
+ * @param name Asset name, e.g. "fonts/regular.ttf" (required)
+ * @param view Output view (required)
+ * @return true on success; false if missing, corrupt or compressed
+ *         without zlib support (error context set)
+ */
+bool asset_bundle_get(AssetBundle* bundle, const char* name, AssetView* view);
+
+/**
+ * Check whether an asset exists without touching its data.
+ *
+ * @param bundle Bundle (required)
+ * @param name Asset name (required)
+ * @return true if present
+ */
+bool asset_bundle_contains(const AssetBundle* bundle, const char* name);
+
+/**
+ * Number of entries.
+ *
+ * @param bundle Bundle (required)
+ * @return Entry count
+ */
+uint32_t asset_bundle_count(const AssetBundle* bundle);
+
+/**
+ * Describe an entry by index (in name order).
+ *
+ * @param bundle Bundle (required)
+ * @param index Entry index below asset_bundle_count()
+ * @param info Output description (required)
+ * @return true on success, false if out of range (error context set)
+ */
+bool asset_bundle_info(const AssetBundle* bundle, uint32_t index, AssetInfo* info);
+
+/**
+ * Hash every entry against its index, inflating as needed. Reads the
+ * whole bundle, so meant for tools and diagnostics rather than startup.
+ *
+ * @param bundle Bundle (required)
+ * @return Number of entries that failed (0 when intact)
+ */
+uint32_t asset_bundle_verify(AssetBundle* bundle);
+
+/**
+ * Get bundle statistics.
+ *
+ * @param bundle Bundle (required)
+ * @param stats Output statistics (required)
+ */
+void asset_bundle_get_stats(AssetBundle* bundle, AssetBundleStats* stats);
+
+/**
+ * Create an empty bundle writer.
+ *
+ * @return New writer or NULL on error (caller owns, error context set)
+ */
+AssetBundleWriter* asset_bundle_writer_create(void);
+
+/**
+ * Destroy a writer.
+ *
+ * @param writer Writer to destroy (can be NULL)
+ */
+void asset_bundle_writer_destroy(AssetBundleWriter* writer);
+
+/**
+ * Add an asset from memory (copied).
+ *
+ * @param writer Writer (required)
+ * @param name Unique asset name (required)
+ * @param data Content (can be NULL when size is 0)
+ * @param size Byte count
+ * @param level 0 to store, 1-9 to deflate; deflated data that saves less
+ *        than an eighth is stored instead, so it stays zero-copy
+ * @return true on success, false on error (error context set)
+ */
+bool asset_bundle_writer_add(AssetBundleWriter* writer, const char* name,
+                             const void* data, size_t size, int level);
+
+/**
+ * Add an asset from a file.
+ *
+ * @param writer Writer (required)
+ * @param name Unique asset name (required)
+ * @param path File to read (required)
+ * @param level As for asset_bundle_writer_add()
+ * @return true on success, false on error (error context set)
+ */
+bool asset_bundle_writer_add_file(AssetBundleWriter* writer, const char* name,
+                                  const char* path, int level);
+
+/**
+ * Write the bundle.
+ *
+ * @param writer Writer (required)
+ * @param path Output path (required)
+ * @param append Append to an existing file (an executable) instead of
+ *        replacing it
+ * @return true on success, false on error (error context set)
+ */
+bool asset_bundle_writer_save(AssetBundleWriter* writer, const char* path, bool append);
+
+/**
+ * @note Thread Safety: get, contains, info and get_stats may be called
+ *       from any thread; open, close and the writer from one.
+ */
+
+#endif /* PANELKIT_ASSET_BUNDLE_H */
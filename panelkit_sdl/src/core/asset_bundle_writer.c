@@ -0,0 +1,317 @@
+/**
+ * @file asset_bundle_writer.c
+ * @brief Asset bundle writer (build time, panelkit-bundle)
+ */
+
+#define _GNU_SOURCE
+#include "asset_bundle.h"
+#include "error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* An appended bundle starts on a page so its mapping holds nothing else */
+#define APPEND_ALIGN 4096
+
+typedef struct {
+    char* name;
+    uint8_t* data;                      /* Stored bytes (deflated or not) */
+    uint64_t stored_size;
+    uint64_t size;
+    uint64_t hash;
+    AssetCompression compression;
+} WriterItem;
+
+struct AssetBundleWriter {
+    WriterItem* items;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+AssetBundleWriter* asset_bundle_writer_create(void) {
+    AssetBundleWriter* writer = calloc(1, sizeof(AssetBundleWriter));
+    if (!writer) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "asset_bundle_writer_create: allocation failed");
+        return NULL;
+    }
+    return writer;
+}
+
+void asset_bundle_writer_destroy(AssetBundleWriter* writer) {
+    if (!writer) {
+        return;
+    }
+    for (uint32_t i = 0; i < writer->count; i++) {
+        free(writer->items[i].name);
+        free(writer->items[i].data);
+    }
+    free(writer->items);
+    free(writer);
+}
+
+/* Deflate into a new buffer if that saves at least an eighth */
+static uint8_t* try_deflate(const void* data, size_t size, int level, uint64_t* stored_size) {
+#ifdef HAVE_ZLIB
+    uLongf length = compressBound((uLong)size);
+    uint8_t* packed = malloc(length);
+    if (!packed) {
+        return NULL;
+    }
+    if (compress2(packed, &length, data, (uLong)size, level) != Z_OK ||
+        length > size - size / 8) {
+        free(packed);
+        return NULL;
+    }
+    *stored_size = length;
+    return packed;
+#else
+    (void)data;
+    (void)size;
+    (void)level;
+    (void)stored_size;
+    return NULL;
+#endif
+}
+
+bool asset_bundle_writer_add(AssetBundleWriter* writer, const char* name,
+                             const void* data, size_t size, int level) {
+    PK_CHECK_FALSE_WITH_CONTEXT(writer && name && (data || size == 0), PK_ERROR_NULL_PARAM,
+                                "asset_bundle_writer_add: writer, name and data are required");
+
+    size_t name_length = strlen(name);
+    if (name_length == 0 || name_length > ASSET_BUNDLE_MAX_NAME) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "asset_bundle_writer_add: name '%s' must be 1-%d bytes", name, ASSET_BUNDLE_MAX_NAME);
+        return false;
+    }
+    for (uint32_t i = 0; i < writer->count; i++) {
+        if (strcmp(writer->items[i].name, name) == 0) {
+            pk_set_last_error_with_context(PK_ERROR_ALREADY_EXISTS,
+                "asset_bundle_writer_add: duplicate asset %s", name);
+            return false;
+        }
+    }
+
+    if (writer->count == writer->capacity) {
+        uint32_t capacity = writer->capacity ? writer->capacity * 2 : 16;
+        WriterItem* items = realloc(writer->items, capacity * sizeof(WriterItem));
+        if (!items) {
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                "asset_bundle_writer_add: allocation failed");
+            return false;
+        }
+        writer->items = items;
+        writer->capacity = capacity;
+    }
+
+    WriterItem item = {
+        .size = size,
+        .hash = asset_bundle_hash(data, size),
+        .compression = ASSET_COMPRESSION_NONE
+    };
+    if (level > 0 && size > 0) {
+        item.data = try_deflate(data, size, level > 9 ? 9 : level, &item.stored_size);
+        if (item.data) {
+            item.compression = ASSET_COMPRESSION_DEFLATE;
+        }
+    }
+    if (!item.data) {
+        item.data = malloc(size ? size : 1);
+        if (item.data && size) {
+            memcpy(item.data, data, size);
+        }
+        item.stored_size = size;
+    }
+    item.name = strdup(name);
+    if (!item.data || !item.name) {
+        free(item.data);
+        free(item.name);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "asset_bundle_writer_add: allocation failed for %s", name);
+        return false;
+    }
+
+    writer->items[writer->count++] = item;
+    return true;
+}
+
+bool asset_bundle_writer_add_file(AssetBundleWriter* writer, const char* name,
+                                  const char* path, int level) {
+    PK_CHECK_FALSE_WITH_CONTEXT(writer && name && path, PK_ERROR_NULL_PARAM,
+                                "asset_bundle_writer_add_file: writer, name and path are required");
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        pk_set_last_error_with_context(errno == ENOENT ? PK_ERROR_NOT_FOUND : PK_ERROR_SYSTEM,
+            "asset_bundle_writer_add_file: cannot open %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+    uint8_t* data = size >= 0 ? malloc(size ? (size_t)size : 1) : NULL;
+    bool read_ok = data && fseek(file, 0, SEEK_SET) == 0 &&
+                   fread(data, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!read_ok) {
+        free(data);
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "asset_bundle_writer_add_file: cannot read %s", path);
+        return false;
+    }
+
+    bool added = asset_bundle_writer_add(writer, name, data, (size_t)size, level);
+    free(data);
+    return added;
+}
+
+static int compare_items(const void* a, const void* b) {
+    return strcmp(((const WriterItem*)a)->name, ((const WriterItem*)b)->name);
+}
+
+static bool write_padding(FILE* file, uint64_t count) {
+    static const uint8_t zeros[APPEND_ALIGN];
+    while (count > 0) {
+        size_t chunk = count < sizeof(zeros) ? (size_t)count : sizeof(zeros);
+        if (fwrite(zeros, 1, chunk, file) != chunk) {
+            return false;
+        }
+        count -= chunk;
+    }
+    return true;
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/* Header, index, names, data and trailer, from the current position */
+static bool write_bundle(AssetBundleWriter* writer, FILE* file) {
+    qsort(writer->items, writer->count, sizeof(WriterItem), compare_items);
+
+    uint32_t names_offset = (uint32_t)(sizeof(AssetBundleHeader) +
+                                       writer->count * sizeof(AssetBundleEntry));
+    uint32_t names_size = 0;
+    for (uint32_t i = 0; i < writer->count; i++) {
+        names_size += (uint32_t)strlen(writer->items[i].name);
+    }
+
+    uint64_t data_offset = align_up((uint64_t)names_offset + names_size, ASSET_BUNDLE_ALIGN);
+    AssetBundleEntry* entries = calloc(writer->count ? writer->count : 1, sizeof(AssetBundleEntry));
+    if (!entries) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "asset_bundle_writer_save: allocation failed");
+        return false;
+    }
+
+    uint32_t name_offset = 0;
+    uint64_t offset = data_offset;
+    for (uint32_t i = 0; i < writer->count; i++) {
+        const WriterItem* item = &writer->items[i];
+        entries[i].offset = offset;
+        entries[i].stored_size = item->stored_size;
+        entries[i].size = item->size;
+        entries[i].hash = item->hash;
+        entries[i].name_offset = name_offset;
+        entries[i].name_length = (uint16_t)strlen(item->name);
+        entries[i].compression = (uint8_t)item->compression;
+        name_offset += entries[i].name_length;
+        offset = align_up(offset + item->stored_size, ASSET_BUNDLE_ALIGN);
+    }
+
+    AssetBundleHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ASSET_BUNDLE_MAGIC, sizeof(header.magic));
+    header.version = ASSET_BUNDLE_VERSION;
+    header.entry_count = writer->count;
+    header.names_offset = names_offset;
+    header.names_size = names_size;
+    header.bundle_size = offset + sizeof(AssetBundleTrailer);
+
+    AssetBundleTrailer trailer;
+    trailer.bundle_size = header.bundle_size;
+    memcpy(trailer.magic, ASSET_BUNDLE_TRAILER_MAGIC, sizeof(trailer.magic));
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (writer->count == 0 ||
+               fwrite(entries, sizeof(AssetBundleEntry), writer->count, file) == writer->count);
+    for (uint32_t i = 0; ok && i < writer->count; i++) {
+        size_t length = entries[i].name_length;
+        ok = fwrite(writer->items[i].name, 1, length, file) == length;
+    }
+    uint64_t position = (uint64_t)names_offset + names_size;
+    for (uint32_t i = 0; ok && i < writer->count; i++) {
+        ok = write_padding(file, entries[i].offset - position) &&
+             fwrite(writer->items[i].data, 1, (size_t)entries[i].stored_size, file) ==
+                 entries[i].stored_size;
+        position = entries[i].offset + entries[i].stored_size;
+    }
+    ok = ok && write_padding(file, offset - position) &&
+         fwrite(&trailer, sizeof(trailer), 1, file) == 1;
+
+    free(entries);
+    if (!ok) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "asset_bundle_writer_save: write failed: %s", strerror(errno));
+    }
+    return ok;
+}
+
+bool asset_bundle_writer_save(AssetBundleWriter* writer, const char* path, bool append) {
+    PK_CHECK_FALSE_WITH_CONTEXT(writer && path, PK_ERROR_NULL_PARAM,
+                                "asset_bundle_writer_save: writer and path are required");
+
+    if (append) {
+        FILE* file = fopen(path, "ab");
+        if (!file) {
+            pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                "asset_bundle_writer_save: cannot open %s: %s", path, strerror(errno));
+            return false;
+        }
+        long end = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+        bool ok = end >= 0 &&
+                  write_padding(file, align_up((uint64_t)end, APPEND_ALIGN) - (uint64_t)end) &&
+                  write_bundle(writer, file);
+        if (fclose(file) != 0 || !ok) {
+            if (ok) {
+                pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                    "asset_bundle_writer_save: cannot write %s: %s", path, strerror(errno));
+            }
+            return false;
+        }
+        return true;
+    }
+
+    /* Write aside and rename, so a running panel never maps a partial file */
+    char temp_path[1024];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "asset_bundle_writer_save: cannot create %s: %s", temp_path, strerror(errno));
+        return false;
+    }
+    bool ok = write_bundle(writer, file);
+    if (fclose(file) != 0 && ok) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "asset_bundle_writer_save: cannot write %s: %s", temp_path, strerror(errno));
+        ok = false;
+    }
+    if (ok && rename(temp_path, path) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "asset_bundle_writer_save: cannot rename %s: %s", temp_path, strerror(errno));
+        ok = false;
+    }
+    if (!ok) {
+        remove(temp_path);
+    }
+    return ok;
+}
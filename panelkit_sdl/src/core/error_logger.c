@@ -148,6 +148,10 @@ void error_logger_log(PkError error, const char* file, int line,
 }
 
 void error_logger_log_entry(const ErrorLogEntry* entry) {
+    error_logger_log_detail(entry, NULL);
+}
+
+void error_logger_log_detail(const ErrorLogEntry* entry, const char* detail) {
     if (!g_error_logger.initialized || !entry) {
         return;
     }
@@ -182,6 +186,14 @@ void error_logger_log_entry(const ErrorLogEntry* entry) {
                 "  Context: %s\n", entry->context);
         }
         
+        /* Detail block, one indented line per input line */
+        while (detail && *detail) {
+            const char* eol = strchr(detail, '\n');
+            int len = eol ? (int)(eol - detail) : (int)strlen(detail);
+            bytes_written += fprintf(g_error_logger.current_file, "    %.*s\n", len, detail);
+            detail = eol ? eol + 1 : NULL;
+        }
+        
         bytes_written += fprintf(g_error_logger.current_file,
             "  Process: %d, Thread: %lu\n\n",
             entry->pid,
@@ -81,6 +81,16 @@ void error_logger_log(PkError error, const char* file, int line,
  */
 void error_logger_log_entry(const ErrorLogEntry* entry);
 
+/**
+ * Log an error entry followed by a multi-line detail block.
+ * 
+ * @param entry Pre-filled error log entry
+ * @param detail Text written indented below the entry (can be NULL)
+ * 
+ * @note Used for reports too long for the context field (stack traces)
+ */
+void error_logger_log_detail(const ErrorLogEntry* entry, const char* detail);
+
 /**
  * Force rotation of error log files.
  * 
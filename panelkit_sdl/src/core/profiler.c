@@ -0,0 +1,768 @@
+/**
+ * @file profiler.c
+ * @brief In-process sampling profiler implementation
+ */
+
+#define _GNU_SOURCE
+#include "profiler.h"
+#include "logger.h"
+#include "error.h"
+#include "realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* glibc before 2.35 only exposes the union member */
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+#if defined(__x86_64__) || defined(__aarch64__)
+/* Both keep { saved frame pointer, return address } at the frame pointer */
+#define PROFILER_HAVE_FRAME_WALK 1
+#endif
+
+#define NS_PER_MS 1000000ull
+#define NS_PER_SEC 1000000000ull
+
+/* Samples in flight between the signal handler and the drain thread */
+#define SLOT_COUNT 1024
+
+/* Slots a handler probes before giving the sample up */
+#define SLOT_PROBES 8
+
+/* Drain thread wake-up period */
+#define DRAIN_INTERVAL_MS 20
+
+/* Unique stacks per session; further new stacks are counted as dropped */
+#define TABLE_INITIAL 1024
+#define TABLE_MAX 16384
+
+/* Thread names shown as the root frame; index 0 is unregistered threads */
+#define MAX_THREAD_NAMES 32
+
+/* Threads with their own CPU-time timer */
+#define MAX_TIMED_THREADS 64
+
+/* Executable mappings considered when writing frames */
+#define MAX_MAPPINGS 128
+
+/* Sample slot handshake between the handler and the drain thread */
+enum {
+    SLOT_EMPTY,
+    SLOT_WRITING,
+    SLOT_READY
+};
+
+typedef struct {
+    atomic_int state;
+    uint8_t thread;
+    uint8_t depth;
+    uintptr_t pcs[PROFILER_MAX_DEPTH];
+} Sample;
+
+typedef struct {
+    uint64_t count;                     /* 0 = unused */
+    uint32_t hash;
+    uint8_t thread;
+    uint8_t depth;
+    uintptr_t pcs[PROFILER_MAX_DEPTH];
+} StackEntry;
+
+typedef struct {
+    pid_t tid;
+    timer_t timer;
+} ThreadTimer;
+
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+    uintptr_t offset;
+    char name[64];
+} Mapping;
+
+/* Process-wide state reached from signal handlers */
+static Sample* g_slots;
+static atomic_uint g_next_slot;
+static atomic_bool g_sampling = false;
+static atomic_bool g_toggle_requested = false;
+static atomic_bool g_created = false;
+static _Atomic uint64_t g_samples;
+static _Atomic uint64_t g_dropped;
+static _Atomic uint64_t g_truncated;
+static atomic_int g_in_handler;
+
+/* Stack bounds of the current thread, set by profiler_register_thread() */
+static __thread uintptr_t t_stack_lo;
+static __thread uintptr_t t_stack_hi;
+static __thread uint8_t t_thread_index;
+static __thread bool t_timed;
+
+/* Thread names and timers, both protected by g_names_mutex */
+static pthread_mutex_t g_names_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const char* g_thread_names[MAX_THREAD_NAMES] = { "other" };
+static int g_thread_name_count = 1;
+static ThreadTimer g_timers[MAX_TIMED_THREADS];
+static int g_timer_count;
+static uint64_t g_interval_ns;          /* Armed period, 0 while no session runs */
+
+struct Profiler {
+    ProfilerConfig config;
+
+    pthread_t thread;
+    bool thread_started;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool running;                       /* Drain thread keeps going */
+
+    /* Session state, protected by mutex */
+    bool sampling;
+    StackEntry* table;
+    uint32_t table_capacity;
+    uint32_t table_count;
+    uint64_t table_dropped;
+    uint64_t session_samples;
+    ProfilerStats stats;
+};
+
+ProfilerConfig profiler_default_config(void) {
+    ProfilerConfig config = {
+        .frequency_hz = PROFILER_DEFAULT_HZ,
+        .signal_toggle = true,
+        .output = "/tmp/panelkit-profile.folded"
+    };
+    return config;
+}
+
+static void arm_timer(timer_t timer, uint64_t interval_ns, int* error) {
+    struct itimerspec spec = {
+        .it_interval = { (time_t)(interval_ns / NS_PER_SEC), (long)(interval_ns % NS_PER_SEC) },
+        .it_value = { (time_t)(interval_ns / NS_PER_SEC), (long)(interval_ns % NS_PER_SEC) }
+    };
+    if (timer_settime(timer, 0, &spec, NULL) != 0 && error) {
+        *error = errno;
+    }
+}
+
+/* Give the calling thread a timer on its own CPU clock that signals only
+ * it; a process-wide CPU clock picks the thread to signal itself, and only
+ * kernels from 6.4 pick the one that was running. Called with
+ * g_names_mutex held; returns 0 or an errno value. */
+static int register_timer_locked(void) {
+    pid_t tid = (pid_t)syscall(SYS_gettid);
+    int slot = -1;
+    for (int i = 0; i < g_timer_count && slot < 0; i++) {
+        if (g_timers[i].tid == tid) {
+            slot = i;       /* Re-registered, or an exited thread's tid reused */
+        }
+    }
+    for (int i = 0; i < g_timer_count && slot < 0; i++) {
+        if (syscall(SYS_tgkill, getpid(), g_timers[i].tid, 0) != 0 && errno == ESRCH) {
+            slot = i;       /* Thread gone; its timer can no longer fire */
+        }
+    }
+    if (slot < 0) {
+        if (g_timer_count == MAX_TIMED_THREADS) {
+            return ENOSPC;
+        }
+        slot = g_timer_count++;
+    } else {
+        timer_delete(g_timers[slot].timer);
+        g_timers[slot].tid = 0;
+    }
+
+    struct sigevent event;
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = tid;
+    timer_t timer;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0) {
+        int error = errno;
+        g_timers[slot] = g_timers[--g_timer_count];
+        return error;
+    }
+    if (g_interval_ns != 0) {
+        arm_timer(timer, g_interval_ns, NULL);
+    }
+    g_timers[slot].tid = tid;
+    g_timers[slot].timer = timer;
+    t_timed = true;
+    return 0;
+}
+
+void profiler_register_thread(const char* name) {
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        void* stack = NULL;
+        size_t size = 0;
+        if (pthread_attr_getstack(&attr, &stack, &size) == 0) {
+            t_stack_lo = (uintptr_t)stack;
+            t_stack_hi = (uintptr_t)stack + size;
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    pthread_mutex_lock(&g_names_mutex);
+    int error = register_timer_locked();
+    if (error != 0) {
+        log_warn("Profiler: no CPU-time timer for %s thread, it will not be sampled: %s",
+                 name ? name : "unnamed", strerror(error));
+    }
+    if (!name) {
+        pthread_mutex_unlock(&g_names_mutex);
+        return;
+    }
+    int index = 0;
+    for (int i = 1; i < g_thread_name_count; i++) {
+        if (strcmp(g_thread_names[i], name) == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index == 0 && g_thread_name_count < MAX_THREAD_NAMES) {
+        index = g_thread_name_count++;
+        g_thread_names[index] = name;
+    }
+    pthread_mutex_unlock(&g_names_mutex);
+    t_thread_index = (uint8_t)index;
+}
+
+/* Runs on the thread whose timer fired. Async-signal-safe: only atomics,
+ * TLS and reads of the interrupted thread's own stack. */
+static void take_sample(const ucontext_t* uc) {
+    Sample* slot = NULL;
+    for (int probe = 0; probe < SLOT_PROBES; probe++) {
+        unsigned index = atomic_fetch_add_explicit(&g_next_slot, 1, memory_order_relaxed);
+        Sample* candidate = &g_slots[index % SLOT_COUNT];
+        int expected = SLOT_EMPTY;
+        if (atomic_compare_exchange_strong_explicit(&candidate->state, &expected, SLOT_WRITING,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            slot = candidate;
+            break;
+        }
+    }
+    if (!slot) {
+        atomic_fetch_add_explicit(&g_dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    uintptr_t pc = 0, fp = 0, sp = 0;
+#if defined(__x86_64__)
+    pc = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+    fp = (uintptr_t)uc->uc_mcontext.gregs[REG_RBP];
+    sp = (uintptr_t)uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__aarch64__)
+    pc = (uintptr_t)uc->uc_mcontext.pc;
+    fp = (uintptr_t)uc->uc_mcontext.regs[29];
+    sp = (uintptr_t)uc->uc_mcontext.sp;
+#elif defined(__arm__)
+    pc = (uintptr_t)uc->uc_mcontext.arm_pc;
+#endif
+
+    int depth = 0;
+    slot->pcs[depth++] = pc;
+
+#ifdef PROFILER_HAVE_FRAME_WALK
+    /* Only follow frame pointers that stay inside this thread's stack and
+     * move towards its base, so a clobbered register cannot fault or loop */
+    if (t_stack_hi != 0) {
+        uintptr_t lo = sp > t_stack_lo ? sp : t_stack_lo;
+        while (fp >= lo && fp + 2 * sizeof(uintptr_t) <= t_stack_hi &&
+               (fp & (sizeof(uintptr_t) - 1)) == 0) {
+            const uintptr_t* frame = (const uintptr_t*)fp;
+            if (frame[1] == 0) {
+                break;
+            }
+            if (depth == PROFILER_MAX_DEPTH) {
+                atomic_fetch_add_explicit(&g_truncated, 1, memory_order_relaxed);
+                break;
+            }
+            slot->pcs[depth++] = frame[1];
+            if (frame[0] <= fp) {
+                break;
+            }
+            fp = frame[0];
+        }
+    }
+#else
+    (void)fp;
+    (void)sp;
+#endif
+
+    slot->depth = (uint8_t)depth;
+    slot->thread = t_thread_index;
+    atomic_store_explicit(&slot->state, SLOT_READY, memory_order_release);
+    atomic_fetch_add_explicit(&g_samples, 1, memory_order_relaxed);
+}
+
+/* g_in_handler is raised before g_sampling is read (both sequentially
+ * consistent), so once quiesce() has cleared g_sampling and seen the
+ * count at zero no handler can still touch g_slots. */
+static void sample_signal_handler(int sig, siginfo_t* info, void* context) {
+    (void)sig;
+    (void)info;
+    atomic_fetch_add(&g_in_handler, 1);
+    if (atomic_load(&g_sampling)) {
+        take_sample(context);
+    }
+    atomic_fetch_sub(&g_in_handler, 1);
+}
+
+/* Disarm every thread's timer, then wait out handlers already running.
+ * Signals still pending afterwards find g_sampling false and return. */
+static void quiesce(void) {
+    pthread_mutex_lock(&g_names_mutex);
+    g_interval_ns = 0;
+    struct itimerspec off;
+    memset(&off, 0, sizeof(off));
+    for (int i = 0; i < g_timer_count; i++) {
+        timer_settime(g_timers[i].timer, 0, &off, NULL);
+    }
+    pthread_mutex_unlock(&g_names_mutex);
+
+    atomic_store(&g_sampling, false);
+    while (atomic_load(&g_in_handler) != 0) {
+        sched_yield();
+    }
+}
+
+static void toggle_signal_handler(int sig) {
+    (void)sig;
+    atomic_store(&g_toggle_requested, true);
+}
+
+static uint32_t hash_sample(const Sample* sample) {
+    uint64_t h = 1469598103934665603ull ^ sample->thread;
+    for (int i = 0; i < sample->depth; i++) {
+        h = (h ^ (uint64_t)sample->pcs[i]) * 1099511628211ull;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+static bool table_grow(Profiler* profiler) {
+    uint32_t capacity = profiler->table_capacity * 2;
+    StackEntry* table = calloc(capacity, sizeof(StackEntry));
+    if (!table) {
+        return false;
+    }
+    for (uint32_t i = 0; i < profiler->table_capacity; i++) {
+        const StackEntry* entry = &profiler->table[i];
+        if (entry->count == 0) {
+            continue;
+        }
+        uint32_t index = entry->hash & (capacity - 1);
+        while (table[index].count != 0) {
+            index = (index + 1) & (capacity - 1);
+        }
+        table[index] = *entry;
+    }
+    free(profiler->table);
+    profiler->table = table;
+    profiler->table_capacity = capacity;
+    return true;
+}
+
+/* Fold one sample into the session's stack table */
+static void table_add(Profiler* profiler, const Sample* sample) {
+    if (profiler->table_count * 10 >= profiler->table_capacity * 7 &&
+        profiler->table_capacity < TABLE_MAX) {
+        table_grow(profiler);
+    }
+
+    uint32_t hash = hash_sample(sample);
+    uint32_t mask = profiler->table_capacity - 1;
+    uint32_t index = hash & mask;
+    while (profiler->table[index].count != 0) {
+        StackEntry* entry = &profiler->table[index];
+        if (entry->hash == hash && entry->thread == sample->thread &&
+            entry->depth == sample->depth &&
+            memcmp(entry->pcs, sample->pcs, sample->depth * sizeof(uintptr_t)) == 0) {
+            entry->count++;
+            return;
+        }
+        index = (index + 1) & mask;
+    }
+
+    /* Full: known stacks keep counting, new ones are dropped */
+    if (profiler->table_count * 10 >= profiler->table_capacity * 7) {
+        profiler->table_dropped++;
+        profiler->stats.dropped++;
+        return;
+    }
+
+    StackEntry* entry = &profiler->table[index];
+    entry->count = 1;
+    entry->hash = hash;
+    entry->thread = sample->thread;
+    entry->depth = sample->depth;
+    memcpy(entry->pcs, sample->pcs, sample->depth * sizeof(uintptr_t));
+    profiler->table_count++;
+}
+
+/* Move finished samples into the table. Called with the mutex held. */
+static void drain_slots(Profiler* profiler) {
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        Sample* slot = &g_slots[i];
+        if (atomic_load_explicit(&slot->state, memory_order_acquire) != SLOT_READY) {
+            continue;
+        }
+        table_add(profiler, slot);
+        profiler->session_samples++;
+        atomic_store_explicit(&slot->state, SLOT_EMPTY, memory_order_release);
+    }
+}
+
+/* Executable mappings, so frames can be written module-relative */
+static int read_mappings(Mapping* mappings, int max) {
+    FILE* maps = fopen("/proc/self/maps", "r");
+    if (!maps) {
+        return 0;
+    }
+    int count = 0;
+    char line[512];
+    while (count < max && fgets(line, sizeof(line), maps)) {
+        unsigned long start, end, offset;
+        char perms[8];
+        int path_at = 0;
+        if (sscanf(line, "%lx-%lx %7s %lx %*s %*s %n", &start, &end, perms, &offset,
+                   &path_at) < 4 || perms[2] != 'x') {
+            continue;
+        }
+        char* path = line + path_at;
+        path[strcspn(path, "\n")] = '\0';
+        const char* base = strrchr(path, '/');
+        base = base ? base + 1 : path;
+        if (*base == '\0') {
+            continue; /* Anonymous (JIT, trampolines): leave as absolute */
+        }
+        Mapping* mapping = &mappings[count++];
+        mapping->start = start;
+        mapping->end = end;
+        mapping->offset = offset;
+        snprintf(mapping->name, sizeof(mapping->name), "%s", base);
+    }
+    fclose(maps);
+    return count;
+}
+
+static void write_frame(FILE* file, uintptr_t pc, const Mapping* mappings, int count) {
+    for (int i = 0; i < count; i++) {
+        if (pc >= mappings[i].start && pc < mappings[i].end) {
+            fprintf(file, ";%s+0x%lx", mappings[i].name,
+                    (unsigned long)(pc - mappings[i].start + mappings[i].offset));
+            return;
+        }
+    }
+    fprintf(file, ";0x%lx", (unsigned long)pc);
+}
+
+/* Write the session's folded stacks. Called with the mutex held. */
+static bool write_output(Profiler* profiler) {
+    Mapping* mappings = malloc(MAX_MAPPINGS * sizeof(Mapping));
+    if (!mappings) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "profiler: mapping table allocation failed");
+        return false;
+    }
+    int mapping_count = read_mappings(mappings, MAX_MAPPINGS);
+
+    char temp[sizeof(profiler->config.output) + 8];
+    snprintf(temp, sizeof(temp), "%s.tmp", profiler->config.output);
+    FILE* file = fopen(temp, "w");
+    if (!file) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "profiler: cannot create %s: %s", temp, strerror(errno));
+        free(mappings);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < profiler->table_capacity; i++) {
+        const StackEntry* entry = &profiler->table[i];
+        if (entry->count == 0) {
+            continue;
+        }
+        fputs(g_thread_names[entry->thread], file);
+        /* Root first; return addresses point after the call, so step back
+         * into it for the symbolizer */
+        for (int f = entry->depth - 1; f >= 0; f--) {
+            write_frame(file, f == 0 ? entry->pcs[f] : entry->pcs[f] - 1,
+                        mappings, mapping_count);
+        }
+        fprintf(file, " %llu\n", (unsigned long long)entry->count);
+    }
+    free(mappings);
+
+    bool ok = fflush(file) == 0 && !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temp, profiler->config.output) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "profiler: cannot write %s: %s", profiler->config.output, strerror(errno));
+        unlink(temp);
+        return false;
+    }
+    return true;
+}
+
+static bool start_locked(Profiler* profiler) {
+    if (profiler->sampling) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_STATE,
+            "profiler_start: session already running");
+        return false;
+    }
+
+    memset(profiler->table, 0, profiler->table_capacity * sizeof(StackEntry));
+    profiler->table_count = 0;
+    profiler->table_dropped = 0;
+    profiler->session_samples = 0;
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        atomic_store(&g_slots[i].state, SLOT_EMPTY);
+    }
+
+    atomic_store(&g_sampling, true);
+    pthread_mutex_lock(&g_names_mutex);
+    g_interval_ns = NS_PER_SEC / (uint64_t)profiler->config.frequency_hz;
+    int armed = 0;
+    int error = 0;
+    for (int i = 0; i < g_timer_count; i++) {
+        int timer_error = 0;
+        arm_timer(g_timers[i].timer, g_interval_ns, &timer_error);
+        if (timer_error == 0) {
+            armed++;
+        } else if (timer_error != ESRCH) {
+            error = timer_error;    /* ESRCH: the thread has exited */
+        }
+    }
+    pthread_mutex_unlock(&g_names_mutex);
+    if (armed == 0) {
+        quiesce();
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "profiler_start: no thread timer could be armed: %s",
+            error ? strerror(error) : "no registered threads");
+        return false;
+    }
+
+    profiler->sampling = true;
+    profiler->stats.sessions++;
+    log_info("Profiler: sampling at %d Hz", profiler->config.frequency_hz);
+    return true;
+}
+
+static bool stop_locked(Profiler* profiler) {
+    if (!profiler->sampling) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_STATE,
+            "profiler_stop: no session running");
+        return false;
+    }
+
+    quiesce();
+    profiler->sampling = false;
+    drain_slots(profiler);
+
+    bool ok = write_output(profiler);
+    if (ok) {
+        log_info("Profiler: wrote %u stacks from %llu samples to %s%s",
+                 profiler->table_count, (unsigned long long)profiler->session_samples,
+                 profiler->config.output,
+                 profiler->table_dropped ? " (stack table full, some samples dropped)" : "");
+    } else {
+        log_error("Profiler: %s", pk_get_last_error_context());
+    }
+    return ok;
+}
+
+static void* profiler_thread_main(void* arg) {
+    Profiler* profiler = arg;
+
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+
+    pthread_mutex_lock(&profiler->mutex);
+    while (profiler->running) {
+        struct timespec wake;
+        clock_gettime(CLOCK_REALTIME, &wake);
+        uint64_t wake_ns = (uint64_t)wake.tv_nsec + DRAIN_INTERVAL_MS * NS_PER_MS;
+        wake.tv_sec += (time_t)(wake_ns / NS_PER_SEC);
+        wake.tv_nsec = (long)(wake_ns % NS_PER_SEC);
+        pthread_cond_timedwait(&profiler->cond, &profiler->mutex, &wake);
+        if (!profiler->running) {
+            break;
+        }
+
+        if (atomic_exchange(&g_toggle_requested, false)) {
+            log_info("Profiler: %s on SIGUSR2", profiler->sampling ? "stopping" : "starting");
+            if (profiler->sampling) {
+                stop_locked(profiler);
+            } else if (!start_locked(profiler)) {
+                log_error("Profiler: %s", pk_get_last_error_context());
+            }
+        }
+        if (profiler->sampling) {
+            drain_slots(profiler);
+        }
+    }
+    pthread_mutex_unlock(&profiler->mutex);
+    return NULL;
+}
+
+Profiler* profiler_create(const ProfilerConfig* config) {
+    bool expected = false;
+    if (!atomic_compare_exchange_strong(&g_created, &expected, true)) {
+        pk_set_last_error_with_context(PK_ERROR_ALREADY_INITIALIZED,
+            "profiler_create: a profiler already exists");
+        return NULL;
+    }
+
+    Profiler* profiler = calloc(1, sizeof(Profiler));
+    g_slots = calloc(SLOT_COUNT, sizeof(Sample));
+    StackEntry* table = calloc(TABLE_INITIAL, sizeof(StackEntry));
+    if (!profiler || !g_slots || !table) {
+        free(profiler);
+        free(g_slots);
+        free(table);
+        g_slots = NULL;
+        atomic_store(&g_created, false);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "profiler_create: allocation failed");
+        return NULL;
+    }
+
+    profiler->config = config ? *config : profiler_default_config();
+    if (profiler->config.frequency_hz < 1 || profiler->config.frequency_hz > 1000) {
+        profiler->config.frequency_hz = PROFILER_DEFAULT_HZ;
+    }
+    if (profiler->config.output[0] == '\0') {
+        snprintf(profiler->config.output, sizeof(profiler->config.output), "%s",
+                 profiler_default_config().output);
+    }
+    profiler->table = table;
+    profiler->table_capacity = TABLE_INITIAL;
+    pthread_mutex_init(&profiler->mutex, NULL);
+    pthread_cond_init(&profiler->cond, NULL);
+
+    /* Created from main before it calls realtime_enter(): cover startup */
+    if (t_stack_hi == 0) {
+        profiler_register_thread("main");
+    }
+    pthread_mutex_lock(&g_names_mutex);
+    int timer_error = t_timed ? 0 : register_timer_locked();
+    pthread_mutex_unlock(&g_names_mutex);
+    if (timer_error != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "profiler_create: timer_create failed: %s", strerror(timer_error));
+        profiler_destroy(profiler);
+        return NULL;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = sample_signal_handler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, NULL) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "profiler_create: cannot install SIGPROF handler: %s", strerror(errno));
+        profiler_destroy(profiler);
+        return NULL;
+    }
+
+    if (profiler->config.signal_toggle) {
+        struct sigaction toggle;
+        memset(&toggle, 0, sizeof(toggle));
+        toggle.sa_handler = toggle_signal_handler;
+        toggle.sa_flags = SA_RESTART;
+        sigemptyset(&toggle.sa_mask);
+        if (sigaction(SIGUSR2, &toggle, NULL) != 0) {
+            log_warn("Profiler: cannot install SIGUSR2 toggle: %s", strerror(errno));
+            profiler->config.signal_toggle = false;
+        }
+    }
+
+    profiler->running = true;
+    int rc = pthread_create(&profiler->thread, NULL, profiler_thread_main, profiler);
+    if (rc != 0) {
+        profiler->running = false;
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "profiler_create: pthread_create failed: %s", strerror(rc));
+        profiler_destroy(profiler);
+        return NULL;
+    }
+    profiler->thread_started = true;
+
+    log_info("Profiler ready (%d Hz, output %s%s)", profiler->config.frequency_hz,
+             profiler->config.output,
+             profiler->config.signal_toggle ? ", toggle with SIGUSR2" : "");
+    return profiler;
+}
+
+void profiler_destroy(Profiler* profiler) {
+    if (!profiler) {
+        return;
+    }
+
+    pthread_mutex_lock(&profiler->mutex);
+    if (profiler->sampling) {
+        stop_locked(profiler);
+    }
+    profiler->running = false;
+    pthread_cond_signal(&profiler->cond);
+    pthread_mutex_unlock(&profiler->mutex);
+    if (profiler->thread_started) {
+        pthread_join(profiler->thread, NULL);
+    }
+
+    if (profiler->config.signal_toggle) {
+        signal(SIGUSR2, SIG_DFL);
+    }
+    /* Thread timers stay registered (disarmed) for the next profiler. Leave
+     * the SIGPROF handler installed: it ignores stray signals once
+     * g_sampling is false, where the default action would kill us. */
+    quiesce();
+
+    pthread_cond_destroy(&profiler->cond);
+    pthread_mutex_destroy(&profiler->mutex);
+    free(profiler->table);
+    free(profiler);
+    free(g_slots);
+    g_slots = NULL;
+    atomic_store(&g_created, false);
+}
+
+bool profiler_start(Profiler* profiler) {
+    PK_CHECK_FALSE_WITH_CONTEXT(profiler != NULL, PK_ERROR_NULL_PARAM,
+                                "profiler_start: profiler is NULL");
+    pthread_mutex_lock(&profiler->mutex);
+    bool ok = start_locked(profiler);
+    pthread_mutex_unlock(&profiler->mutex);
+    return ok;
+}
+
+bool profiler_stop(Profiler* profiler) {
+    PK_CHECK_FALSE_WITH_CONTEXT(profiler != NULL, PK_ERROR_NULL_PARAM,
+                                "profiler_stop: profiler is NULL");
+    pthread_mutex_lock(&profiler->mutex);
+    bool ok = stop_locked(profiler);
+    pthread_mutex_unlock(&profiler->mutex);
+    return ok;
+}
+
+void profiler_get_stats(Profiler* profiler, ProfilerStats* stats) {
+    if (!profiler || !stats) {
+        return;
+    }
+    pthread_mutex_lock(&profiler->mutex);
+    *stats = profiler->stats;
+    stats->stacks = profiler->table_count;
+    stats->running = profiler->sampling;
+    pthread_mutex_unlock(&profiler->mutex);
+    stats->samples = atomic_load(&g_samples);
+    stats->dropped += atomic_load(&g_dropped);
+    stats->truncated = atomic_load(&g_truncated);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file profiler.h
+ * @brief In-process sampling profiler writing folded stacks
+ *
+ * The target boards run a stripped static binary without perf or kernel
+ * headers. The profiler samples the process itself: every registered
+ * thread gets a timer on its own CPU clock that raises SIGPROF on that
+ * thread, and the handler walks its frame pointers into a lock-free slot
+ * array. A background thread folds the samples into unique stacks, and
+ * when a session ends writes them in the folded format flamegraph.pl and
+ * speedscope read:
+ *
+ *   main;panelkit+0x4f1a0;panelkit+0x52c14;panelkit+0x3a2e8 41
+ *
+ * Frames are module-relative file offsets, so the profile is taken on the
+ * device and symbolized later against the unstripped build with
+ * scripts/symbolize_profile.sh. The first frame names the thread's role.
+ *
+ * Sessions are started and stopped with SIGUSR2 (kill -USR2 <pid>), by
+ * profiler_start()/profiler_stop(), or from startup via config. While no
+ * session runs nothing is armed and the profiler costs nothing.
+ *
+ * Only threads that registered are sampled, which realtime_enter() does
+ * for every PanelKit thread; library threads (SDL, curl) are not.
+ * Per-thread timers work on any kernel, where a process CPU-time timer
+ * only signals the thread that was running from Linux 6.4 on. Frame
+ * walking needs -fno-omit-frame-pointer (PANELKIT_FRAME_POINTERS in
+ * CMake); code built without it shows up as truncated stacks, and a leaf
+ * function that sets up no frame hides its direct caller.
+ *
+ * The timers count each thread's CPU time, so idle periods take no
+ * samples; the kernel checks them once per tick, which caps the effective
+ * rate per thread at CONFIG_HZ (often 250).
+ */
+
+#ifndef PANELKIT_PROFILER_H
+#define PANELKIT_PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Frames kept per sample, leaf first */
+#define PROFILER_MAX_DEPTH 32
+
+/** Default sampling rate; off the 100 Hz grid so it does not alias ticks */
+#define PROFILER_DEFAULT_HZ 99
+
+/** Opaque profiler handle */
+typedef struct Profiler Profiler;
+
+/**
+ * Profiler configuration.
+ */
+typedef struct {
+    int frequency_hz;           /**< Samples per CPU-second (1-1000) */
+    bool signal_toggle;         /**< SIGUSR2 starts/stops a session */
+    char output[256];           /**< Folded stack file written per session */
+} ProfilerConfig;
+
+/**
+ * Profiler statistics.
+ */
+typedef struct {
+    uint64_t sessions;          /**< Sessions started */
+    uint64_t samples;           /**< Samples taken (all sessions) */
+    uint64_t dropped;           /**< Samples lost to a full slot array or stack table */
+    uint64_t truncated;         /**< Samples whose walk hit PROFILER_MAX_DEPTH */
+    uint32_t stacks;            /**< Unique stacks in the current session */
+    bool running;               /**< A session is in progress */
+} ProfilerStats;
+
+/**
+ * Get default profiler configuration.
+ *
+ * @return 99 Hz, SIGUSR2 toggle, /tmp/panelkit-profile.folded
+ */
+ProfilerConfig profiler_default_config(void);
+
+/**
+ * Create the profiler and install its signal handlers. One per process.
+ *
+ * @param config Profiler configuration (NULL for defaults)
+ * @return New profiler or NULL on error (caller owns, error context set)
+ */
+Profiler* profiler_create(const ProfilerConfig* config);
+
+/**
+ * Stop any session (writing its output) and destroy the profiler.
+ *
+ * @param profiler Profiler to destroy (can be NULL)
+ */
+void profiler_destroy(Profiler* profiler);
+
+/**
+ * Start a sampling session. Samples from an earlier session are discarded.
+ *
+ * @param profiler Profiler (required)
+ * @return true on success, false on error (error context set)
+ */
+bool profiler_start(Profiler* profiler);
+
+/**
+ * End the session and write its folded stacks to the configured output.
+ *
+ * @param profiler Profiler (required)
+ * @return true if the output was written, false on error or when no
+ *         session was running (error context set)
+ */
+bool profiler_stop(Profiler* profiler);
+
+/**
+ * Get profiler statistics.
+ *
+ * @param profiler Profiler (required)
+ * @param stats Output statistics (required)
+ */
+void profiler_get_stats(Profiler* profiler, ProfilerStats* stats);
+
+/**
+ * Record the calling thread's stack bounds and give it a (disarmed)
+ * CPU-time timer, so it is sampled while a session runs. Valid before a
+ * profiler exists; a thread that registers during a session joins it.
+ *
+ * @param name Static string naming the thread in stacks (not copied)
+ */
+void profiler_register_thread(const char* name);
+
+/**
+ * @note Thread Safety: start, stop and get_stats may be called from any
+ *       thread; create and destroy from one. At most 64 threads are
+ *       sampled at a time; entries of exited threads are reused.
+ */
+
+#endif /* PANELKIT_PROFILER_H */
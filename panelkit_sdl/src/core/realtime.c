@@ -0,0 +1,339 @@
+/**
+ * @file realtime.c
+ * @brief Real-time scheduling profile implementation
+ */
+
+#define _GNU_SOURCE
+#include "realtime.h"
+#include "profiler.h"
+#include "logger.h"
+#include "error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <alloca.h>
+#include <sys/mman.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/* Highest CPU number accepted in a CPU list */
+#define REALTIME_MAX_CPUS 256
+#define CPU_WORDS (REALTIME_MAX_CPUS / 64)
+
+/* Stack prefault is capped well below the default 8MB thread stack */
+#define MAX_PREFAULT_STACK_KB 1024
+
+/* Per-role scheduling, resolved once by realtime_init() */
+typedef struct {
+    int policy;
+    int priority;
+    cpu_set_t cpus;
+    int cpu_count;          /* 0 = leave affinity alone */
+    const char* cpu_list;   /* Points into g_config, for logging */
+} RoleProfile;
+
+static RealtimeConfig g_config;
+static RoleProfile g_roles[REALTIME_ROLE_COUNT];
+static atomic_bool g_enabled = false;
+static atomic_bool g_warned_policy = false;
+static bool g_memory_locked = false;
+
+static const char* role_names[REALTIME_ROLE_COUNT] = {
+    "input", "main", "render", "background"
+};
+
+RealtimeConfig realtime_default_config(void) {
+    RealtimeConfig config = {
+        .enabled = false,
+        .round_robin = false,
+        .input_priority = 60,
+        .main_priority = 50,
+        .render_priority = 45,
+        .lock_memory = true,
+        .prefault_heap_kb = 8192,
+        .prefault_stack_kb = 256
+    };
+    return config;
+}
+
+const char* realtime_role_string(RealtimeRole role) {
+    if (role < 0 || role >= REALTIME_ROLE_COUNT) {
+        return "unknown";
+    }
+    return role_names[role];
+}
+
+static const char* policy_string(int policy) {
+    switch (policy) {
+        case SCHED_FIFO: return "SCHED_FIFO";
+        case SCHED_RR:   return "SCHED_RR";
+        default:         return "SCHED_OTHER";
+    }
+}
+
+int realtime_parse_cpus(const char* list, unsigned long long* cpus, int max_cpus) {
+    if (!cpus || max_cpus <= 0) {
+        return -1;
+    }
+    memset(cpus, 0, (size_t)(max_cpus / 64) * sizeof(*cpus));
+    if (!list) {
+        return 0;
+    }
+
+    int count = 0;
+    const char* p = list;
+    while (*p) {
+        while (*p == ' ' || *p == ',') {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0) {
+            return -1;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first) {
+                return -1;
+            }
+            p = end;
+        }
+        if (last >= max_cpus) {
+            return -1;
+        }
+        if (*p && *p != ',' && *p != ' ') {
+            return -1;
+        }
+
+        for (long cpu = first; cpu <= last; cpu++) {
+            unsigned long long bit = 1ull << (cpu % 64);
+            if (!(cpus[cpu / 64] & bit)) {
+                cpus[cpu / 64] |= bit;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/* Resolve a CPU list into a cpu_set_t, rejecting CPUs the system lacks */
+static bool resolve_cpus(const char* name, const char* list, RoleProfile* role) {
+    unsigned long long mask[CPU_WORDS];
+    int count = realtime_parse_cpus(list, mask, REALTIME_MAX_CPUS);
+    if (count < 0) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+            "realtime_init: invalid %s CPU list '%s'", name, list);
+        return false;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_CONF);
+    CPU_ZERO(&role->cpus);
+    role->cpu_count = count;
+    for (int cpu = 0; cpu < REALTIME_MAX_CPUS && count > 0; cpu++) {
+        if (!(mask[cpu / 64] & (1ull << (cpu % 64)))) {
+            continue;
+        }
+        if (online > 0 && cpu >= online) {
+            pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+                "realtime_init: %s CPU %d does not exist (%ld CPUs)", name, cpu, online);
+            return false;
+        }
+        CPU_SET(cpu, &role->cpus);
+    }
+    return true;
+}
+
+static bool resolve_priority(const char* name, int priority, int policy, RoleProfile* role) {
+    int min = sched_get_priority_min(policy);
+    int max = sched_get_priority_max(policy);
+    if (priority < min || priority > max) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+            "realtime_init: %s priority %d outside %d-%d", name, priority, min, max);
+        return false;
+    }
+    role->policy = policy;
+    role->priority = priority;
+    return true;
+}
+
+bool realtime_init(const RealtimeConfig* config) {
+    RealtimeConfig defaults = realtime_default_config();
+    if (!config) {
+        config = &defaults;
+    }
+
+    atomic_store(&g_enabled, false);
+    if (!config->enabled) {
+        return true;
+    }
+
+    int policy = config->round_robin ? SCHED_RR : SCHED_FIFO;
+    memset(g_roles, 0, sizeof(g_roles));
+    if (!resolve_priority("input", config->input_priority, policy, &g_roles[REALTIME_ROLE_INPUT]) ||
+        !resolve_priority("main", config->main_priority, policy, &g_roles[REALTIME_ROLE_MAIN]) ||
+        !resolve_priority("render", config->render_priority, policy, &g_roles[REALTIME_ROLE_RENDER]) ||
+        !resolve_cpus("input", config->input_cpus, &g_roles[REALTIME_ROLE_INPUT]) ||
+        !resolve_cpus("main", config->main_cpus, &g_roles[REALTIME_ROLE_MAIN]) ||
+        !resolve_cpus("render", config->render_cpus, &g_roles[REALTIME_ROLE_RENDER]) ||
+        !resolve_cpus("background", config->background_cpus, &g_roles[REALTIME_ROLE_BACKGROUND])) {
+        log_error("Real-time profile disabled: %s", pk_get_last_error_context());
+        return false;
+    }
+    g_roles[REALTIME_ROLE_BACKGROUND].policy = SCHED_OTHER;
+    g_roles[REALTIME_ROLE_BACKGROUND].priority = 0;
+
+    g_config = *config;
+    g_roles[REALTIME_ROLE_INPUT].cpu_list = g_config.input_cpus;
+    g_roles[REALTIME_ROLE_MAIN].cpu_list = g_config.main_cpus;
+    g_roles[REALTIME_ROLE_RENDER].cpu_list = g_config.render_cpus;
+    g_roles[REALTIME_ROLE_BACKGROUND].cpu_list = g_config.background_cpus;
+    if (g_config.prefault_stack_kb > MAX_PREFAULT_STACK_KB) {
+        g_config.prefault_stack_kb = MAX_PREFAULT_STACK_KB;
+    }
+
+#ifdef __GLIBC__
+    if (g_config.lock_memory) {
+        /* Keep freed memory in the heap: no trimming, no per-allocation
+         * mmap, so a locked and prefaulted arena stays that way */
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+    }
+#endif
+
+    atomic_store(&g_warned_policy, false);
+    atomic_store(&g_enabled, true);
+
+    log_info("Real-time profile: %s input=%d main=%d render=%d, CPUs input='%s' main='%s' "
+             "render='%s' background='%s', lock_memory=%s",
+             policy_string(policy), config->input_priority, config->main_priority,
+             config->render_priority, config->input_cpus, config->main_cpus,
+             config->render_cpus, config->background_cpus,
+             config->lock_memory ? "yes" : "no");
+    return true;
+}
+
+/* Touch the stack below the caller so later deep calls don't fault */
+static void __attribute__((noinline)) prefault_stack(size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    volatile unsigned char* stack = alloca(bytes);
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) {
+        page = 4096;
+    }
+    for (size_t i = 0; i < bytes; i += (size_t)page) {
+        stack[i] = 0;
+    }
+}
+
+bool realtime_enter(RealtimeRole role) {
+    profiler_register_thread(realtime_role_string(role));
+
+    if (!atomic_load(&g_enabled) || role < 0 || role >= REALTIME_ROLE_COUNT) {
+        return true;
+    }
+
+    const RoleProfile* profile = &g_roles[role];
+    bool ok = true;
+
+    /* Lowering to SCHED_OTHER is always allowed; background threads need it
+     * because new threads inherit the creator's real-time policy */
+    struct sched_param param = { .sched_priority = profile->priority };
+    int rc = pthread_setschedparam(pthread_self(), profile->policy, &param);
+    if (rc != 0) {
+        ok = false;
+        if (!atomic_exchange(&g_warned_policy, true)) {
+            log_warn("Real-time: cannot set %s for %s thread: %s%s",
+                     policy_string(profile->policy), role_names[role], strerror(rc),
+                     rc == EPERM ? " (needs CAP_SYS_NICE or RLIMIT_RTPRIO)" : "");
+        }
+    }
+
+    if (profile->cpu_count > 0) {
+        rc = pthread_setaffinity_np(pthread_self(), sizeof(profile->cpus), &profile->cpus);
+        if (rc != 0) {
+            ok = false;
+            log_warn("Real-time: cannot pin %s thread: %s", role_names[role], strerror(rc));
+        }
+    }
+
+    if (role == REALTIME_ROLE_BACKGROUND) {
+        log_debug("Real-time: background thread on %d CPUs", profile->cpu_count);
+        return ok;
+    }
+
+    prefault_stack(g_config.prefault_stack_kb * 1024);
+
+    if (ok) {
+        log_info("Real-time: %s thread running %s/%d%s%s", role_names[role],
+                 policy_string(profile->policy), profile->priority,
+                 profile->cpu_count > 0 ? " on CPUs " : "",
+                 profile->cpu_count > 0 ? profile->cpu_list : "");
+    }
+    return ok;
+}
+
+bool realtime_lock_memory(void) {
+    if (!atomic_load(&g_enabled) || !g_config.lock_memory || g_memory_locked) {
+        return true;
+    }
+
+    /* Grow the heap once and hand it back to malloc; with trimming off the
+     * pages stay mapped and mlockall() below makes them resident */
+    size_t reserve = g_config.prefault_heap_kb * 1024;
+    if (reserve > 0) {
+        unsigned char* heap = malloc(reserve);
+        if (heap) {
+            memset(heap, 0, reserve);
+            free(heap);
+        } else {
+            log_warn("Real-time: could not prefault %zu KB heap reserve", g_config.prefault_heap_kb);
+        }
+    }
+
+    if (mlockall(MCL_CURRENT) != 0) {
+        log_warn("Real-time: mlockall failed: %s%s", strerror(errno),
+                 errno == ENOMEM || errno == EPERM ? " (raise RLIMIT_MEMLOCK)" : "");
+        return false;
+    }
+
+    /* Future mappings (new thread stacks, curl buffers) lock as they are
+     * touched instead of committing their full size up front */
+#ifdef MCL_ONFAULT
+    int future_flags = MCL_FUTURE | MCL_ONFAULT;
+#else
+    int future_flags = MCL_CURRENT | MCL_FUTURE;
+#endif
+    if (mlockall(future_flags) != 0) {
+        log_warn("Real-time: locking future mappings failed: %s", strerror(errno));
+    }
+
+    g_memory_locked = true;
+    log_info("Real-time: memory locked (%zu KB heap reserve)", g_config.prefault_heap_kb);
+    return true;
+}
+
+void realtime_shutdown(void) {
+    if (g_memory_locked) {
+        munlockall();
+        g_memory_locked = false;
+    }
+    atomic_store(&g_enabled, false);
+}
+
+bool realtime_is_enabled(void) {
+    return atomic_load(&g_enabled);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file realtime.h
+ * @brief Opt-in real-time scheduling profile for latency-critical threads
+ *
+ * By default every thread runs under CFS with no affinity, so a burst of
+ * curl workers or a log flush competes with touch handling for the same
+ * cores. The real-time profile assigns each thread a role: input and
+ * render threads get SCHED_FIFO (or SCHED_RR) priorities and can be
+ * pinned to isolated cores, background threads are pushed back to
+ * SCHED_OTHER on the housekeeping cores, and memory is locked so the hot
+ * path never takes a page fault.
+ *
+ * Threads call realtime_enter() as their first statement. When the
+ * profile is disabled every call is a no-op, so the hooks stay in place
+ * on desktop builds. Failures (usually EPERM without CAP_SYS_NICE or an
+ * RLIMIT_RTPRIO grant) are logged once and the thread keeps running with
+ * whatever it inherited.
+ *
+ * Typical startup:
+ * @code
+ *   RealtimeConfig rt = realtime_default_config();
+ *   rt.enabled = true;
+ *   realtime_init(&rt);              // before any thread is created
+ *   realtime_enter(REALTIME_ROLE_MAIN);
+ *   ... create threads, load assets ...
+ *   realtime_lock_memory();          // just before the main loop
+ * @endcode
+ */
+
+#ifndef PANELKIT_REALTIME_H
+#define PANELKIT_REALTIME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Size of a CPU list string ("0-3,6"); holds any list the config accepts */
+#define REALTIME_MAX_CPU_LIST 128
+
+/**
+ * Thread roles. Each role maps to a policy, priority and CPU set.
+ */
+typedef enum {
+    REALTIME_ROLE_INPUT,        /**< Touch/evdev reader: highest priority */
+    REALTIME_ROLE_MAIN,         /**< Event dispatch and display list recording */
+    REALTIME_ROLE_RENDER,       /**< Render pipeline present thread */
+    REALTIME_ROLE_BACKGROUND,   /**< Network, video decode, anything else */
+    REALTIME_ROLE_COUNT
+} RealtimeRole;
+
+/**
+ * Real-time profile configuration.
+ *
+ * CPU lists use the kernel's cpulist syntax ("2", "2-3", "1,3"); an empty
+ * list leaves the thread's affinity alone. Pair input/main/render CPUs
+ * with isolcpus= (or a cpuset) and give background_cpus the remaining
+ * cores.
+ */
+typedef struct {
+    bool enabled;                               /**< Master switch (false = all no-ops) */
+    bool round_robin;                           /**< SCHED_RR instead of SCHED_FIFO */
+    int input_priority;                         /**< 1-99 */
+    int main_priority;                          /**< 1-99 */
+    int render_priority;                        /**< 1-99 */
+    char input_cpus[REALTIME_MAX_CPU_LIST];
+    char main_cpus[REALTIME_MAX_CPU_LIST];
+    char render_cpus[REALTIME_MAX_CPU_LIST];
+    char background_cpus[REALTIME_MAX_CPU_LIST];
+    bool lock_memory;                           /**< mlockall() and malloc tuning */
+    size_t prefault_heap_kb;                    /**< Heap reserve touched before locking */
+    size_t prefault_stack_kb;                   /**< Stack touched by each real-time thread */
+} RealtimeConfig;
+
+/**
+ * Get default real-time configuration.
+ *
+ * @return Disabled profile with FIFO priorities input 60, main 50,
+ *         render 45, no pinning, memory locking on
+ */
+RealtimeConfig realtime_default_config(void);
+
+/**
+ * Install the real-time profile for this process.
+ *
+ * Must run before threads are created. Validates the CPU lists and,
+ * with lock_memory set, tunes malloc so freed memory is never returned
+ * to the kernel (and re-faulted later).
+ *
+ * @param config Profile to install (NULL for defaults)
+ * @return true on success, false if the configuration is invalid
+ *         (error context set; the profile is left disabled)
+ */
+bool realtime_init(const RealtimeConfig* config);
+
+/**
+ * Apply the profile for a role to the calling thread.
+ *
+ * Also registers the thread with the sampling profiler (see profiler.h),
+ * so this runs even when the profile is disabled.
+ *
+ * @param role Role of the calling thread
+ * @return true if the requested policy is in effect (or the profile is
+ *         disabled), false if the kernel refused it
+ */
+bool realtime_enter(RealtimeRole role);
+
+/**
+ * Prefault the heap reserve and lock all current and future pages.
+ *
+ * Call once, after startup allocations and asset loading, just before
+ * entering the main loop. No-op unless the profile enables lock_memory.
+ *
+ * @return true if memory is locked (or locking is not requested)
+ */
+bool realtime_lock_memory(void);
+
+/**
+ * Undo memory locking and disable the profile.
+ */
+void realtime_shutdown(void);
+
+/**
+ * Check whether the profile is active.
+ *
+ * @return true between a successful realtime_init() with enabled set and
+ *         realtime_shutdown()
+ */
+bool realtime_is_enabled(void);
+
+/**
+ * Parse a kernel-style CPU list.
+ *
+ * @param list CPU list ("2", "2-3", "1,3"); NULL or empty yields no CPUs
+ * @param cpus Output bitmask, bit N set for CPU N (required)
+ * @param max_cpus Number of bits available in cpus (multiple of 64)
+ * @return Number of CPUs in the list, or -1 if the list is malformed
+ */
+int realtime_parse_cpus(const char* list, unsigned long long* cpus, int max_cpus);
+
+/**
+ * Get a role's name for logging.
+ *
+ * @param role Thread role
+ * @return Static string ("input", "main", ...)
+ */
+const char* realtime_role_string(RealtimeRole role);
+
+#endif /* PANELKIT_REALTIME_H */
@@ -0,0 +1,462 @@
+/**
+ * @file watchdog.c
+ * @brief Frame-deadline watchdog implementation
+ */
+
+#define _GNU_SOURCE
+#include "watchdog.h"
+#include "logger.h"
+#include "error.h"
+#include "error_logger.h"
+#include "realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#ifdef __GLIBC__
+#include <execinfo.h>
+#define WATCHDOG_HAVE_BACKTRACE 1
+#endif
+
+#define NS_PER_MS 1000000ull
+#define NS_PER_SEC 1000000000ull
+
+/* Real-time signal used to ask the stalled thread for its stack */
+#define WATCHDOG_SIGNAL (SIGRTMIN + 4)
+
+/* How long the monitor waits for the stalled thread to answer */
+#define CAPTURE_TIMEOUT_MS 200
+
+/* Stall report buffer (header plus one line per frame) */
+#define REPORT_SIZE 8192
+
+/* Stack capture handshake with the signal handler */
+enum {
+    CAPTURE_IDLE,
+    CAPTURE_REQUESTED,
+    CAPTURE_RUNNING,
+    CAPTURE_DONE
+};
+
+/* One capture slot per process: only the main loop is monitored */
+static atomic_int g_capture_state = CAPTURE_IDLE;
+static void* g_capture_frames[WATCHDOG_MAX_FRAMES];
+static int g_capture_count;
+
+struct Watchdog {
+    WatchdogConfig config;
+    pthread_t monitored;
+    pthread_t thread;
+    bool thread_started;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool running;
+
+    /* Written by the monitored thread, read by the monitor */
+    _Atomic uint64_t last_heartbeat_ns;     /* 0 = not monitoring */
+    _Atomic uint64_t heartbeats;
+    _Atomic(const char*) phase;
+    _Atomic uint64_t phase_start_ns;
+
+    /* Monitor state */
+    uint64_t stall_heartbeat_ns;            /* Heartbeat that went stale */
+
+    /* systemd notify socket (-1 when not under systemd) */
+    int notify_fd;
+    struct sockaddr_un notify_addr;
+    socklen_t notify_addr_len;
+    uint64_t ping_interval_ns;
+    uint64_t last_ping_ns;
+
+    WatchdogStats stats;                    /* Protected by mutex */
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+WatchdogConfig watchdog_default_config(void) {
+    WatchdogConfig config = {
+        .deadline_ms = 2000,
+        .check_interval_ms = 0,
+        .systemd = true,
+        .capture_stack = true
+    };
+    return config;
+}
+
+/* Runs on the stalled thread. backtrace() was primed in watchdog_start()
+ * so it does not load libgcc from inside the handler. */
+static void capture_signal_handler(int sig) {
+    (void)sig;
+    int expected = CAPTURE_REQUESTED;
+    if (!atomic_compare_exchange_strong(&g_capture_state, &expected, CAPTURE_RUNNING)) {
+        return; /* Monitor gave up on this request */
+    }
+    int saved_errno = errno;
+#ifdef WATCHDOG_HAVE_BACKTRACE
+    g_capture_count = backtrace(g_capture_frames, WATCHDOG_MAX_FRAMES);
+#else
+    g_capture_count = 0;
+#endif
+    errno = saved_errno;
+    atomic_store(&g_capture_state, CAPTURE_DONE);
+}
+
+/* Resolve NOTIFY_SOCKET ("/run/..." or "@abstract") */
+static bool notify_address(struct sockaddr_un* addr, socklen_t* len) {
+    const char* path = getenv("NOTIFY_SOCKET");
+    if (!path || (path[0] != '/' && path[0] != '@') || strlen(path) >= sizeof(addr->sun_path)) {
+        return false;
+    }
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+    if (addr->sun_path[0] == '@') {
+        addr->sun_path[0] = '\0';
+    }
+    *len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + strlen(path));
+    return true;
+}
+
+/* Never blocks: a service manager that stops reading must not stall the monitor */
+static bool notify_send(int fd, const struct sockaddr_un* addr, socklen_t len, const char* state) {
+    ssize_t sent = sendto(fd, state, strlen(state), MSG_NOSIGNAL | MSG_DONTWAIT,
+                          (const struct sockaddr*)addr, len);
+    return sent == (ssize_t)strlen(state);
+}
+
+bool watchdog_notify(const char* state) {
+    struct sockaddr_un addr;
+    socklen_t len;
+    if (!state || !notify_address(&addr, &len)) {
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = notify_send(fd, &addr, len, state);
+    close(fd);
+    return ok;
+}
+
+/* Set up periodic WATCHDOG=1 if systemd asked for it */
+static void setup_systemd(Watchdog* watchdog) {
+    watchdog->notify_fd = -1;
+    if (!watchdog->config.systemd) {
+        return;
+    }
+
+    const char* usec_env = getenv("WATCHDOG_USEC");
+    const char* pid_env = getenv("WATCHDOG_PID");
+    if (!usec_env) {
+        return;
+    }
+    if (pid_env && strtol(pid_env, NULL, 10) != (long)getpid()) {
+        return; /* Meant for another process */
+    }
+    unsigned long long usec = strtoull(usec_env, NULL, 10);
+    if (usec == 0 || !notify_address(&watchdog->notify_addr, &watchdog->notify_addr_len)) {
+        return;
+    }
+
+    watchdog->notify_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (watchdog->notify_fd < 0) {
+        log_warn("Watchdog: cannot open systemd notify socket: %s", strerror(errno));
+        return;
+    }
+
+    /* Ping at half the systemd timeout, as sd_watchdog_enabled() suggests */
+    watchdog->ping_interval_ns = usec * 1000ull / 2;
+    if ((uint64_t)watchdog->config.deadline_ms * NS_PER_MS >= usec * 1000ull) {
+        log_warn("Watchdog: deadline %dms is not below systemd WatchdogSec (%llums); "
+                 "systemd will restart before a stall is reported",
+                 watchdog->config.deadline_ms, usec / 1000);
+    }
+    log_info("Watchdog: pinging systemd every %llums", usec / 2000);
+}
+
+Watchdog* watchdog_create(const WatchdogConfig* config) {
+    Watchdog* watchdog = calloc(1, sizeof(Watchdog));
+    if (!watchdog) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "watchdog_create: allocation failed");
+        return NULL;
+    }
+
+    watchdog->config = config ? *config : watchdog_default_config();
+    if (watchdog->config.deadline_ms <= 0) {
+        watchdog->config.deadline_ms = watchdog_default_config().deadline_ms;
+    }
+    if (watchdog->config.check_interval_ms <= 0) {
+        watchdog->config.check_interval_ms = watchdog->config.deadline_ms / 4;
+        if (watchdog->config.check_interval_ms < 10) {
+            watchdog->config.check_interval_ms = 10;
+        }
+    }
+
+    pthread_mutex_init(&watchdog->mutex, NULL);
+    pthread_cond_init(&watchdog->cond, NULL);
+    atomic_store(&watchdog->phase, "startup");
+    setup_systemd(watchdog);
+    return watchdog;
+}
+
+/* Ask the monitored thread for its stack; returns frames captured */
+static int capture_stack(Watchdog* watchdog) {
+    if (!watchdog->config.capture_stack) {
+        return 0;
+    }
+
+    atomic_store(&g_capture_state, CAPTURE_REQUESTED);
+    if (pthread_kill(watchdog->monitored, WATCHDOG_SIGNAL) != 0) {
+        atomic_store(&g_capture_state, CAPTURE_IDLE);
+        return -1;
+    }
+
+    struct timespec tick = { .tv_sec = 0, .tv_nsec = (long)NS_PER_MS };
+    for (int waited = 0; waited < CAPTURE_TIMEOUT_MS; waited++) {
+        if (atomic_load(&g_capture_state) == CAPTURE_DONE) {
+            return g_capture_count;
+        }
+        nanosleep(&tick, NULL);
+    }
+
+    /* Withdraw the request; if the handler already started, let it finish */
+    int expected = CAPTURE_REQUESTED;
+    if (atomic_compare_exchange_strong(&g_capture_state, &expected, CAPTURE_IDLE)) {
+        return -1;  /* Signal not delivered: blocked in an uninterruptible wait */
+    }
+    while (atomic_load(&g_capture_state) != CAPTURE_DONE) {
+        nanosleep(&tick, NULL);
+    }
+    return g_capture_count;
+}
+
+static void report_stall(Watchdog* watchdog, uint64_t now, uint64_t heartbeat_ns) {
+    const char* phase = atomic_load(&watchdog->phase);
+    uint64_t phase_start = atomic_load(&watchdog->phase_start_ns);
+    uint32_t stalled_ms = (uint32_t)((now - heartbeat_ns) / NS_PER_MS);
+    uint32_t phase_ms = phase_start ? (uint32_t)((now - phase_start) / NS_PER_MS) : 0;
+
+    int frames = capture_stack(watchdog);
+
+    char* report = malloc(REPORT_SIZE);
+    if (!report) {
+        log_error("Main loop stalled for %ums in phase '%s'", stalled_ms, phase);
+        return;
+    }
+    int used = snprintf(report, REPORT_SIZE,
+                        "Phase: %s (%ums in phase)\nFrames completed: %llu\nStack of main thread:",
+                        phase ? phase : "unknown", phase_ms,
+                        (unsigned long long)atomic_load(&watchdog->heartbeats));
+
+#ifdef WATCHDOG_HAVE_BACKTRACE
+    if (frames > 0) {
+        char** symbols = backtrace_symbols(g_capture_frames, frames);
+        /* Frames 0-1 are the handler and the signal trampoline */
+        for (int i = 2; i < frames && used < REPORT_SIZE; i++) {
+            used += snprintf(report + used, REPORT_SIZE - (size_t)used, "\n  #%-2d %s",
+                             i - 2, symbols ? symbols[i] : "?");
+        }
+        free(symbols);
+    }
+#endif
+    if (frames <= 0 && used < REPORT_SIZE) {
+        snprintf(report + used, REPORT_SIZE - (size_t)used, "\n  %s",
+                 frames < 0 ? "unavailable (thread did not answer the signal; "
+                              "likely blocked in the kernel)"
+                            : "capture disabled or unsupported");
+    }
+    atomic_store(&g_capture_state, CAPTURE_IDLE);
+
+    ErrorLogEntry entry = {
+        .timestamp = time(NULL),
+        .error_code = PK_ERROR_TIMEOUT,
+        .line = __LINE__,
+        .pid = getpid(),
+        .thread_id = watchdog->monitored
+    };
+    strncpy(entry.function, "watchdog", sizeof(entry.function) - 1);
+    strncpy(entry.file, "watchdog.c", sizeof(entry.file) - 1);
+    snprintf(entry.context, sizeof(entry.context),
+             "Main loop missed its %dms frame deadline (no heartbeat for %ums) in phase '%s'",
+             watchdog->config.deadline_ms, stalled_ms, phase ? phase : "unknown");
+    error_logger_log_detail(&entry, report);
+
+    log_error("Watchdog: main loop stalled for %ums in phase '%s'", stalled_ms,
+              phase ? phase : "unknown");
+    log_error("%s", report);
+    free(report);
+}
+
+static void* watchdog_thread_main(void* arg) {
+    Watchdog* watchdog = arg;
+    uint64_t deadline_ns = (uint64_t)watchdog->config.deadline_ms * NS_PER_MS;
+
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+
+    pthread_mutex_lock(&watchdog->mutex);
+    while (watchdog->running) {
+        struct timespec wake;
+        clock_gettime(CLOCK_REALTIME, &wake);
+        uint64_t wake_ns = (uint64_t)wake.tv_nsec +
+                           (uint64_t)watchdog->config.check_interval_ms * NS_PER_MS;
+        wake.tv_sec += (time_t)(wake_ns / NS_PER_SEC);
+        wake.tv_nsec = (long)(wake_ns % NS_PER_SEC);
+        pthread_cond_timedwait(&watchdog->cond, &watchdog->mutex, &wake);
+        if (!watchdog->running) {
+            break;
+        }
+
+        uint64_t now = now_ns();
+        uint64_t heartbeat = atomic_load(&watchdog->last_heartbeat_ns);
+        bool fresh = heartbeat == 0 || now - heartbeat <= deadline_ns;
+
+        if (watchdog->stats.stalled && heartbeat != watchdog->stall_heartbeat_ns) {
+            /* Heartbeat moved (or monitoring was suspended): stall is over */
+            watchdog->stats.stalled = false;
+            if (heartbeat != 0) {
+                uint32_t gap_ms = (uint32_t)((heartbeat - watchdog->stall_heartbeat_ns) / NS_PER_MS);
+                watchdog->stats.last_stall_ms = gap_ms;
+                if (gap_ms > watchdog->stats.longest_stall_ms) {
+                    watchdog->stats.longest_stall_ms = gap_ms;
+                }
+                log_warn("Watchdog: main loop recovered after %ums", gap_ms);
+            }
+        }
+
+        if (!fresh && !watchdog->stats.stalled) {
+            watchdog->stats.stalled = true;
+            watchdog->stats.stalls++;
+            watchdog->stall_heartbeat_ns = heartbeat;
+            /* Report without the lock: stats readers must not wait on it */
+            pthread_mutex_unlock(&watchdog->mutex);
+            report_stall(watchdog, now, heartbeat);
+            pthread_mutex_lock(&watchdog->mutex);
+        }
+
+        /* Withholding pings while stalled lets systemd restart us */
+        if (fresh && watchdog->notify_fd >= 0 &&
+            now - watchdog->last_ping_ns >= watchdog->ping_interval_ns) {
+            if (notify_send(watchdog->notify_fd, &watchdog->notify_addr,
+                            watchdog->notify_addr_len, "WATCHDOG=1")) {
+                watchdog->stats.systemd_pings++;
+            }
+            watchdog->last_ping_ns = now;
+        }
+    }
+    pthread_mutex_unlock(&watchdog->mutex);
+    return NULL;
+}
+
+bool watchdog_start(Watchdog* watchdog) {
+    PK_CHECK_FALSE_WITH_CONTEXT(watchdog != NULL, PK_ERROR_NULL_PARAM,
+                                "watchdog_start: watchdog is NULL");
+    if (watchdog->thread_started) {
+        pk_set_last_error_with_context(PK_ERROR_ALREADY_INITIALIZED,
+            "watchdog_start: already started");
+        return false;
+    }
+
+    watchdog->monitored = pthread_self();
+
+    if (watchdog->config.capture_stack) {
+#ifdef WATCHDOG_HAVE_BACKTRACE
+        void* prime[1];
+        backtrace(prime, 1);
+#endif
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = capture_signal_handler;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if (sigaction(WATCHDOG_SIGNAL, &sa, NULL) != 0) {
+            log_warn("Watchdog: cannot install stack capture handler: %s", strerror(errno));
+            watchdog->config.capture_stack = false;
+        }
+    }
+
+    watchdog->running = true;
+    int rc = pthread_create(&watchdog->thread, NULL, watchdog_thread_main, watchdog);
+    if (rc != 0) {
+        watchdog->running = false;
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "watchdog_start: pthread_create failed: %s", strerror(rc));
+        return false;
+    }
+    watchdog->thread_started = true;
+
+    log_info("Watchdog started (deadline %dms, check every %dms, stack capture %s)",
+             watchdog->config.deadline_ms, watchdog->config.check_interval_ms,
+             watchdog->config.capture_stack ? "on" : "off");
+    return true;
+}
+
+void watchdog_destroy(Watchdog* watchdog) {
+    if (!watchdog) {
+        return;
+    }
+
+    if (watchdog->thread_started) {
+        pthread_mutex_lock(&watchdog->mutex);
+        watchdog->running = false;
+        pthread_cond_signal(&watchdog->cond);
+        pthread_mutex_unlock(&watchdog->mutex);
+        pthread_join(watchdog->thread, NULL);
+
+        log_info("Watchdog stopped: %llu stalls, longest %ums",
+                 (unsigned long long)watchdog->stats.stalls, watchdog->stats.longest_stall_ms);
+    }
+
+    if (watchdog->notify_fd >= 0) {
+        close(watchdog->notify_fd);
+    }
+    pthread_cond_destroy(&watchdog->cond);
+    pthread_mutex_destroy(&watchdog->mutex);
+    free(watchdog);
+}
+
+void watchdog_heartbeat(Watchdog* watchdog) {
+    if (!watchdog) {
+        return;
+    }
+    atomic_store(&watchdog->last_heartbeat_ns, now_ns());
+    atomic_fetch_add(&watchdog->heartbeats, 1);
+}
+
+void watchdog_phase(Watchdog* watchdog, const char* phase) {
+    if (!watchdog) {
+        return;
+    }
+    atomic_store(&watchdog->phase_start_ns, now_ns());
+    atomic_store(&watchdog->phase, phase);
+}
+
+void watchdog_suspend(Watchdog* watchdog) {
+    if (!watchdog) {
+        return;
+    }
+    atomic_store(&watchdog->last_heartbeat_ns, 0);
+}
+
+void watchdog_get_stats(Watchdog* watchdog, WatchdogStats* stats) {
+    if (!watchdog || !stats) {
+        return;
+    }
+    pthread_mutex_lock(&watchdog->mutex);
+    *stats = watchdog->stats;
+    pthread_mutex_unlock(&watchdog->mutex);
+    stats->heartbeats = atomic_load(&watchdog->heartbeats);
+}
@@ -0,0 +1,140 @@
+/**
+ * @file watchdog.h
+ * @brief Frame-deadline watchdog with stall diagnostics
+ *
+ * The main loop calls watchdog_heartbeat() once per frame and marks what
+ * it is doing with watchdog_phase(). A monitor thread checks the
+ * heartbeat; when it is older than the deadline (a handler blocked in
+ * event_emit, a synchronous HTTP request on the UI thread, a DRM ioctl
+ * that never returns) the monitor signals the main thread, which records
+ * its own backtrace, and a stall report with the phase and the stack is
+ * written to the error log.
+ *
+ * When the process runs under systemd with WatchdogSec=, the monitor
+ * sends WATCHDOG=1 only while heartbeats are fresh, so a loop that stays
+ * frozen gets the service killed and restarted. The notify protocol is
+ * spoken directly over NOTIFY_SOCKET; libsystemd is not required.
+ *
+ * Typical loop:
+ * @code
+ *   watchdog_start(wd);                   // on the thread to monitor
+ *   watchdog_notify("READY=1");
+ *   while (!quit) {
+ *       watchdog_heartbeat(wd);
+ *       watchdog_phase(wd, "events");
+ *       ... poll events ...
+ *       watchdog_phase(wd, "present");
+ *       ... submit ...
+ *   }
+ *   watchdog_notify("STOPPING=1");
+ * @endcode
+ */
+
+#ifndef PANELKIT_WATCHDOG_H
+#define PANELKIT_WATCHDOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Opaque watchdog handle */
+typedef struct Watchdog Watchdog;
+
+/** Maximum stack frames captured in a stall report */
+#define WATCHDOG_MAX_FRAMES 48
+
+/**
+ * Watchdog configuration.
+ */
+typedef struct {
+    int deadline_ms;            /**< Heartbeat age that counts as a stall */
+    int check_interval_ms;      /**< Monitor wake-up period (0 = deadline / 4) */
+    bool systemd;               /**< Send WATCHDOG=1 when NOTIFY_SOCKET is set */
+    bool capture_stack;         /**< Signal the stalled thread for a backtrace */
+} WatchdogConfig;
+
+/**
+ * Watchdog statistics.
+ */
+typedef struct {
+    uint64_t heartbeats;        /**< Frames seen */
+    uint64_t stalls;            /**< Deadlines missed (one per stall) */
+    uint64_t systemd_pings;     /**< WATCHDOG=1 messages sent */
+    uint32_t longest_stall_ms;  /**< Longest heartbeat gap that was reported */
+    uint32_t last_stall_ms;     /**< Duration of the most recent stall */
+    bool stalled;               /**< A stall is in progress */
+} WatchdogStats;
+
+/**
+ * Get default watchdog configuration.
+ *
+ * @return 2000ms deadline, systemd pings and stack capture enabled
+ */
+WatchdogConfig watchdog_default_config(void);
+
+/**
+ * Create a watchdog. Monitoring begins with watchdog_start().
+ *
+ * @param config Watchdog configuration (NULL for defaults)
+ * @return New watchdog or NULL on error (caller owns)
+ */
+Watchdog* watchdog_create(const WatchdogConfig* config);
+
+/**
+ * Stop the monitor thread and destroy the watchdog.
+ *
+ * @param watchdog Watchdog to destroy (can be NULL)
+ */
+void watchdog_destroy(Watchdog* watchdog);
+
+/**
+ * Start monitoring the calling thread.
+ *
+ * Installs the stack capture signal handler and starts the monitor
+ * thread. Stalls are only reported after the first heartbeat, so
+ * startup work before the main loop is not flagged.
+ *
+ * @param watchdog Watchdog (required)
+ * @return true on success, false on error (error context set)
+ */
+bool watchdog_start(Watchdog* watchdog);
+
+/**
+ * Record that the monitored thread completed a frame. Lock-free.
+ *
+ * @param watchdog Watchdog (can be NULL)
+ */
+void watchdog_heartbeat(Watchdog* watchdog);
+
+/**
+ * Mark the phase the monitored thread is entering. Lock-free.
+ *
+ * @param watchdog Watchdog (can be NULL)
+ * @param phase Static string naming the phase (not copied)
+ */
+void watchdog_phase(Watchdog* watchdog, const char* phase);
+
+/**
+ * Pause monitoring until the next heartbeat, for intentional long
+ * operations on the monitored thread (config reload, page rebuild).
+ *
+ * @param watchdog Watchdog (can be NULL)
+ */
+void watchdog_suspend(Watchdog* watchdog);
+
+/**
+ * Get watchdog statistics.
+ *
+ * @param watchdog Watchdog (required)
+ * @param stats Output statistics (required)
+ */
+void watchdog_get_stats(Watchdog* watchdog, WatchdogStats* stats);
+
+/**
+ * Send a state string to the service manager ("READY=1", "STOPPING=1").
+ *
+ * @param state sd_notify-style state string
+ * @return true if sent, false if not running under systemd or on error
+ */
+bool watchdog_notify(const char* state);
+
+#endif /* PANELKIT_WATCHDOG_H */
@@ -0,0 +1,234 @@
+/**
+ * @file backend_fbdev.c
+ * @brief Legacy framebuffer (/dev/fbN) display backend implementation
+ *
+ * For boards whose kernels expose only fbdev. SDL's software renderer
+ * draws into a system-memory surface in the framebuffer's own pixel
+ * format; present hands that surface to FbdevOutput, which writes only the
+ * tiles that changed and flips pages with FBIOPAN_DISPLAY when the virtual
+ * resolution has room for two screens.
+ *
+ * The device defaults to /dev/fb0; set PANELKIT_FBDEV_DEVICE to use
+ * another one. Further outputs (DisplayConfig.output > 0) open /dev/fbN.
+ */
+
+#include "display_backend.h"
+#include "fbdev_output.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Framebuffer backend implementation data */
+typedef struct FbdevBackendImpl {
+    FbdevOutput* output;
+    SDL_Surface* target;    /* Software render target, framebuffer format */
+    bool vsync;
+    bool owns_sdl_init;
+} FbdevBackendImpl;
+
+/* Present function - write changed tiles to the framebuffer */
+static void fbdev_backend_present(DisplayBackend* backend) {
+    if (!backend || !backend->impl.fbdev) {
+        return;
+    }
+
+    FbdevBackendImpl* impl = backend->impl.fbdev;
+    SDL_Surface* surface = impl->target;
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_LockSurface(surface);
+    }
+    fbdev_output_present(impl->output, surface->pixels, surface->pitch, impl->vsync);
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_UnlockSurface(surface);
+    }
+}
+
+/* Cleanup function */
+static void fbdev_backend_cleanup(DisplayBackend* backend) {
+    if (!backend || !backend->impl.fbdev) {
+        return;
+    }
+
+    FbdevBackendImpl* impl = backend->impl.fbdev;
+
+    if (impl->output) {
+        FbdevStats stats;
+        fbdev_output_get_stats(impl->output, &stats);
+        log_info("Framebuffer: %llu presents, %llu unchanged, %llu KB written, %llu flips",
+                 (unsigned long long)stats.frames,
+                 (unsigned long long)stats.frames_unchanged,
+                 (unsigned long long)(stats.bytes_copied / 1024),
+                 (unsigned long long)stats.pans);
+        fbdev_output_destroy(impl->output);
+    }
+
+    /* Destroy SDL resources */
+    if (backend->renderer) {
+        SDL_DestroyRenderer(backend->renderer);
+        backend->renderer = NULL;
+    }
+    if (impl->target) {
+        SDL_FreeSurface(impl->target);
+    }
+    if (backend->window) {
+        SDL_DestroyWindow(backend->window);
+        backend->window = NULL;
+    }
+
+    /* Quit SDL if we initialized it */
+    if (impl->owns_sdl_init) {
+        SDL_Quit();
+    }
+
+    free(impl);
+    backend->impl.fbdev = NULL;
+}
+
+/* Bring up SDL video without touching the console: offscreen, then dummy */
+static bool fbdev_init_sdl_video(void) {
+    static const char* drivers[] = { "offscreen", "dummy" };
+
+    for (size_t i = 0; i < sizeof(drivers) / sizeof(drivers[0]); i++) {
+        setenv("SDL_VIDEODRIVER", drivers[i], 1);
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, drivers[i]);
+        if (SDL_Init(SDL_INIT_VIDEO) == 0) {
+            log_info("SDL video subsystem initialized with %s driver", drivers[i]);
+            return true;
+        }
+        LOG_SDL_ERROR("Failed to initialize SDL video");
+    }
+    return false;
+}
+
+/* Create framebuffer backend */
+DisplayBackend* display_backend_fbdev_create(const DisplayConfig* config) {
+    /* Allocate backend structure */
+    DisplayBackend* backend = calloc(1, sizeof(DisplayBackend));
+    if (!backend) {
+        log_error("Failed to allocate display backend");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "display_backend_fbdev_create: Failed to allocate %zu bytes",
+            sizeof(DisplayBackend));
+        return NULL;
+    }
+
+    /* Allocate implementation data */
+    FbdevBackendImpl* impl = calloc(1, sizeof(FbdevBackendImpl));
+    if (!impl) {
+        log_error("Failed to allocate framebuffer backend implementation");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "display_backend_fbdev_create: Failed to allocate %zu bytes for impl",
+            sizeof(FbdevBackendImpl));
+        free(backend);
+        return NULL;
+    }
+
+    /* Set up backend structure */
+    backend->type = DISPLAY_BACKEND_FBDEV;
+    backend->name = "fbdev";
+    backend->impl.fbdev = impl;
+    backend->present = fbdev_backend_present;
+    backend->cleanup = fbdev_backend_cleanup;
+
+    /* Software renderer on an offscreen surface has no thread-bound context */
+    backend->render_thread_safe = true;
+    impl->vsync = config->vsync;
+
+    /* Open the framebuffer first; its mode decides size and format */
+    char device[32];
+    const char* path = getenv("PANELKIT_FBDEV_DEVICE");
+    if (config->output > 0) {
+        snprintf(device, sizeof(device), "/dev/fb%d", config->output);
+        path = device;
+    }
+    impl->output = fbdev_output_open(path, true);
+    if (!impl->output) {
+        /* Error context already set by fbdev_output_open */
+        log_error("Failed to open framebuffer: %s", pk_get_last_error_context());
+        free(impl);
+        free(backend);
+        return NULL;
+    }
+
+    FbdevInfo info;
+    fbdev_output_get_info(impl->output, &info);
+    backend->actual_width = info.width;
+    backend->actual_height = info.height;
+    backend->render_format = SDL_MasksToPixelFormatEnum(info.bits_per_pixel, info.red_mask,
+                                                        info.green_mask, info.blue_mask, 0);
+    if (backend->render_format == SDL_PIXELFORMAT_UNKNOWN) {
+        log_error("No SDL pixel format for framebuffer masks %06x/%06x/%06x",
+                  info.red_mask, info.green_mask, info.blue_mask);
+        pk_set_last_error_with_context(PK_ERROR_DISPLAY_MODE_FAILED,
+            "display_backend_fbdev_create: Unsupported %d bpp layout", info.bits_per_pixel);
+        fbdev_backend_cleanup(backend);
+        free(backend);
+        return NULL;
+    }
+
+    /* The framebuffer mode is fixed; pixel_format cannot override it */
+    if (display_pixel_format_bytes(config->pixel_format) * 8 != info.bits_per_pixel) {
+        log_info("Framebuffer is %d bpp, ignoring pixel format %s",
+                 info.bits_per_pixel, display_pixel_format_name(config->pixel_format));
+    }
+    backend->dither = config->dither && info.bits_per_pixel == 16;
+
+    /* Initialize SDL (window and events only; nothing is drawn by SDL video) */
+    if (!SDL_WasInit(SDL_INIT_VIDEO)) {
+        if (!fbdev_init_sdl_video()) {
+            pk_set_last_error_with_context(PK_ERROR_SDL,
+                "display_backend_fbdev_create: SDL_Init failed: %s", SDL_GetError());
+            fbdev_backend_cleanup(backend);
+            free(backend);
+            return NULL;
+        }
+        impl->owns_sdl_init = true;
+    }
+
+    /* Create window (offscreen) */
+    backend->window = SDL_CreateWindow(
+        config->title ? config->title : "PanelKit",
+        SDL_WINDOWPOS_UNDEFINED,
+        SDL_WINDOWPOS_UNDEFINED,
+        backend->actual_width,
+        backend->actual_height,
+        0
+    );
+
+    if (!backend->window) {
+        LOG_SDL_ERROR("Failed to create offscreen window");
+        fbdev_backend_cleanup(backend);
+        free(backend);
+        return NULL;
+    }
+
+    /* Create render target in the framebuffer format */
+    impl->target = SDL_CreateRGBSurfaceWithFormat(0, backend->actual_width,
+                                                  backend->actual_height,
+                                                  info.bits_per_pixel, backend->render_format);
+    if (!impl->target) {
+        LOG_SDL_ERROR("Failed to create render target surface");
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "display_backend_fbdev_create: %dx%d surface failed: %s",
+            backend->actual_width, backend->actual_height, SDL_GetError());
+        fbdev_backend_cleanup(backend);
+        free(backend);
+        return NULL;
+    }
+
+    backend->renderer = SDL_CreateSoftwareRenderer(impl->target);
+    if (!backend->renderer) {
+        LOG_SDL_ERROR("Failed to create software renderer");
+        fbdev_backend_cleanup(backend);
+        free(backend);
+        return NULL;
+    }
+
+    log_info("Framebuffer backend initialized (%s, %d page%s%s)",
+             SDL_GetPixelFormatName(backend->render_format), info.pages,
+             info.pages > 1 ? "s" : "", backend->dither ? ", dithered" : "");
+
+    return backend;
+}
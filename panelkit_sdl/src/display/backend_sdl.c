@@ -141,8 +141,8 @@ DisplayBackend* display_backend_sdl_create(const DisplayConfig* config) {
     
     backend->window = SDL_CreateWindow(
         config->title ? config->title : "PanelKit",
-        SDL_WINDOWPOS_CENTERED,
-        SDL_WINDOWPOS_CENTERED,
+        SDL_WINDOWPOS_CENTERED_DISPLAY(config->output),
+        SDL_WINDOWPOS_CENTERED_DISPLAY(config->output),
         config->width,
         config->height,
         window_flags
@@ -178,6 +178,14 @@ DisplayBackend* display_backend_sdl_create(const DisplayConfig* config) {
     /* Get actual window size (may differ in fullscreen) */
     SDL_GetWindowSize(backend->window, &backend->actual_width, &backend->actual_height);
     
+    /* Windowed rendering stays in the window's native format */
+    backend->render_format = SDL_GetWindowPixelFormat(backend->window);
+    if (config->pixel_format != DISPLAY_PIXEL_FORMAT_XRGB8888) {
+        log_info("Pixel format %s applies to SDL+DRM only; window uses %s",
+                 display_pixel_format_name(config->pixel_format),
+                 SDL_GetPixelFormatName(backend->render_format));
+    }
+    
     /* Log renderer info */
     SDL_RendererInfo info;
     if (SDL_GetRendererInfo(backend->renderer, &info) == 0) {
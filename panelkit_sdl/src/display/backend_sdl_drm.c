@@ -6,6 +6,13 @@
  * then copies the pixels to a DRM dumb buffer for direct display output.
  * This approach requires only libdrm (~200KB) instead of the full Mesa
  * stack (~169MB).
+ *
+ * The render surface and dumb buffer share one pixel format (XRGB8888 or
+ * RGB565), so present is a straight row copy with no conversion.
+ *
+ * Several backends in one process (one per connector) share a single
+ * DRM file descriptor, since only the first open of a card becomes DRM
+ * master; each claims its own CRTC.
  */
 
 #include "display_backend.h"
@@ -21,6 +28,7 @@
 #include <errno.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <pthread.h>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <libdrm/drm.h>
@@ -29,7 +37,7 @@
 /* DRM buffer structure */
 typedef struct {
     int fd;
-    uint32_t* pixels;
+    uint8_t* pixels;
     size_t size;
     uint32_t handle;
     uint32_t pitch;
@@ -38,6 +46,15 @@ typedef struct {
     int height;
 } DRMBuffer;
 
+/* Most display controllers have at most this many CRTCs */
+#define DRM_MAX_CLAIMED_CRTCS 8
+
+/* DRM device shared by every SDL+DRM backend in the process */
+static pthread_mutex_t drm_device_lock = PTHREAD_MUTEX_INITIALIZER;
+static int drm_device_fd = -1;
+static int drm_device_users = 0;
+static uint32_t drm_claimed_crtcs[DRM_MAX_CLAIMED_CRTCS];
+
 /* SDL+DRM backend implementation data */
 typedef struct SDLDRMBackendImpl {
     /* DRM resources */
@@ -45,14 +62,16 @@ typedef struct SDLDRMBackendImpl {
     drmModeConnector* connector;
     drmModeModeInfo* mode;
     uint32_t crtc_id;
+    bool crtc_claimed;
     DRMBuffer* buffer;
     
     /* SDL resources */
+    SDL_Surface* target;    /* Software render target, same format as buffer */
     bool owns_sdl_init;
 } SDLDRMBackendImpl;
 
 /* Create DRM buffer */
-static DRMBuffer* create_drm_buffer(int fd, int width, int height) {
+static DRMBuffer* create_drm_buffer(int fd, int width, int height, int bpp) {
     DRMBuffer* buf = calloc(1, sizeof(DRMBuffer));
     if (!buf) {
         log_error("Failed to allocate DRM buffer structure");
@@ -67,7 +86,7 @@ static DRMBuffer* create_drm_buffer(int fd, int width, int height) {
     struct drm_mode_create_dumb create = {
         .width = width,
         .height = height,
-        .bpp = 32
+        .bpp = bpp
     };
     
     if (ioctl(fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
@@ -80,11 +99,11 @@ static DRMBuffer* create_drm_buffer(int fd, int width, int height) {
     buf->pitch = create.pitch;
     buf->size = create.size;
     
-    log_debug("Created DRM buffer: %dx%d, pitch=%d, size=%zu",
-              width, height, buf->pitch, buf->size);
+    log_debug("Created DRM buffer: %dx%d, %d bpp, pitch=%d, size=%zu",
+              width, height, bpp, buf->pitch, buf->size);
     
-    /* Create framebuffer */
-    if (drmModeAddFB(fd, width, height, 24, 32, buf->pitch,
+    /* Create framebuffer; depth 16 at 16 bpp is RGB565 */
+    if (drmModeAddFB(fd, width, height, bpp == 16 ? 16 : 24, bpp, buf->pitch,
                      buf->handle, &buf->fb_id)) {
         LOG_ERRNO("Failed to create framebuffer");
         struct drm_mode_destroy_dumb destroy = { .handle = buf->handle };
@@ -138,24 +157,120 @@ static void destroy_drm_buffer(DRMBuffer* buf) {
     free(buf);
 }
 
-/* Setup DRM display */
-static int setup_drm_display(SDLDRMBackendImpl* impl) {
-    /* Try vc4 driver first (card1), fallback to card0 */
-    const char* drm_devices[] = { "/dev/dri/card1", "/dev/dri/card0", NULL };
-    
-    for (int i = 0; drm_devices[i]; i++) {
-        impl->drm_fd = open(drm_devices[i], O_RDWR);
-        if (impl->drm_fd >= 0) {
-            log_info("Opened DRM device: %s", drm_devices[i]);
+/* Open the DRM device, or take another reference to the open one */
+static int drm_device_acquire(void) {
+    pthread_mutex_lock(&drm_device_lock);
+    
+    if (drm_device_fd < 0) {
+        /* Try vc4 driver first (card1), fallback to card0 */
+        const char* drm_devices[] = { "/dev/dri/card1", "/dev/dri/card0", NULL };
+        
+        for (int i = 0; drm_devices[i]; i++) {
+            drm_device_fd = open(drm_devices[i], O_RDWR | O_CLOEXEC);
+            if (drm_device_fd >= 0) {
+                log_info("Opened DRM device: %s", drm_devices[i]);
+                break;
+            }
+        }
+        
+        if (drm_device_fd < 0) {
+            LOG_ERRNO("Failed to open any DRM device");
+            pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                "drm_device_acquire: Could not open /dev/dri/card0 or card1: %s",
+                strerror(errno));
+            pthread_mutex_unlock(&drm_device_lock);
+            return -1;
+        }
+    }
+    
+    drm_device_users++;
+    int fd = drm_device_fd;
+    pthread_mutex_unlock(&drm_device_lock);
+    return fd;
+}
+
+/* Drop a reference to the DRM device, closing it with the last one */
+static void drm_device_release(void) {
+    pthread_mutex_lock(&drm_device_lock);
+    if (drm_device_users > 0 && --drm_device_users == 0) {
+        close(drm_device_fd);
+        drm_device_fd = -1;
+    }
+    pthread_mutex_unlock(&drm_device_lock);
+}
+
+/* Claim a CRTC for this process; fails if another backend holds it */
+static bool drm_claim_crtc(uint32_t crtc_id) {
+    bool claimed = false;
+    pthread_mutex_lock(&drm_device_lock);
+    int free_slot = -1;
+    for (int i = 0; i < DRM_MAX_CLAIMED_CRTCS; i++) {
+        if (drm_claimed_crtcs[i] == crtc_id) {
+            free_slot = -1;
             break;
         }
+        if (!drm_claimed_crtcs[i] && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+    if (free_slot >= 0) {
+        drm_claimed_crtcs[free_slot] = crtc_id;
+        claimed = true;
+    }
+    pthread_mutex_unlock(&drm_device_lock);
+    return claimed;
+}
+
+static void drm_release_crtc(uint32_t crtc_id) {
+    pthread_mutex_lock(&drm_device_lock);
+    for (int i = 0; i < DRM_MAX_CLAIMED_CRTCS; i++) {
+        if (drm_claimed_crtcs[i] == crtc_id) {
+            drm_claimed_crtcs[i] = 0;
+        }
+    }
+    pthread_mutex_unlock(&drm_device_lock);
+}
+
+/* Pick a CRTC for the connector: its current one, else any it can drive */
+static uint32_t drm_select_crtc(int fd, drmModeRes* res, drmModeConnector* connector) {
+    /* Try to find encoder and associated CRTC */
+    if (connector->encoder_id) {
+        drmModeEncoder* encoder = drmModeGetEncoder(fd, connector->encoder_id);
+        if (encoder) {
+            uint32_t crtc_id = encoder->crtc_id;
+            drmModeFreeEncoder(encoder);
+            if (crtc_id && drm_claim_crtc(crtc_id)) {
+                log_debug("Using CRTC %d from current encoder", crtc_id);
+                return crtc_id;
+            }
+        }
+    }
+    
+    /* Otherwise any CRTC one of the connector's encoders can feed */
+    for (int e = 0; e < connector->count_encoders; e++) {
+        drmModeEncoder* encoder = drmModeGetEncoder(fd, connector->encoders[e]);
+        if (!encoder) {
+            continue;
+        }
+        uint32_t possible = encoder->possible_crtcs;
+        drmModeFreeEncoder(encoder);
+        
+        for (int c = 0; c < res->count_crtcs && c < 32; c++) {
+            if ((possible & (1u << c)) && drm_claim_crtc(res->crtcs[c])) {
+                log_debug("Using free CRTC %d", res->crtcs[c]);
+                return res->crtcs[c];
+            }
+        }
     }
     
+    return 0;
+}
+
+/* Setup DRM display on the Nth connected connector */
+static int setup_drm_display(SDLDRMBackendImpl* impl, int output) {
+    impl->drm_fd = drm_device_acquire();
     if (impl->drm_fd < 0) {
-        LOG_ERRNO("Failed to open any DRM device");
-        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
-            "setup_drm_display: Could not open /dev/dri/card0 or card1: %s",
-            strerror(errno));
+        /* Error context already set by drm_device_acquire */
         return -1;
     }
     
@@ -165,17 +280,21 @@ static int setup_drm_display(SDLDRMBackendImpl* impl) {
         log_error("Failed to get DRM resources");
         pk_set_last_error_with_context(PK_ERROR_SYSTEM,
             "setup_drm_display: drmModeGetResources failed");
+        drm_device_release();
+        impl->drm_fd = -1;
         return -1;
     }
     
     /* Find connected connector */
     impl->connector = NULL;
+    int connected = 0;
     for (int i = 0; i < res->count_connectors; i++) {
         drmModeConnector* conn = drmModeGetConnector(impl->drm_fd, res->connectors[i]);
-        if (conn && conn->connection == DRM_MODE_CONNECTED && conn->count_modes > 0) {
+        if (conn && conn->connection == DRM_MODE_CONNECTED && conn->count_modes > 0 &&
+            connected++ == output) {
             impl->connector = conn;
             impl->mode = &conn->modes[0]; /* Use first (preferred) mode */
-            log_info("Found connected display: %dx%d @ %dHz",
+            log_info("Found connected display %d: %dx%d @ %dHz", output,
                      impl->mode->hdisplay, impl->mode->vdisplay,
                      impl->mode->vrefresh);
             break;
@@ -184,41 +303,32 @@ static int setup_drm_display(SDLDRMBackendImpl* impl) {
     }
     
     if (!impl->connector) {
-        log_error("No connected display found");
+        log_error("No connected display %d found", output);
         pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
-            "setup_drm_display: No connected display found among %d connectors",
-            res->count_connectors);
+            "setup_drm_display: Output %d not found (%d connected among %d connectors)",
+            output, connected, res->count_connectors);
         drmModeFreeResources(res);
+        drm_device_release();
+        impl->drm_fd = -1;
         return -1;
     }
     
     /* Find CRTC */
-    impl->crtc_id = 0;
-    
-    /* Try to find encoder and associated CRTC */
-    if (impl->connector->encoder_id) {
-        drmModeEncoder* encoder = drmModeGetEncoder(impl->drm_fd, impl->connector->encoder_id);
-        if (encoder) {
-            impl->crtc_id = encoder->crtc_id;
-            log_debug("Using CRTC %d from current encoder", impl->crtc_id);
-            drmModeFreeEncoder(encoder);
-        }
-    }
-    
-    /* Fallback to first available CRTC */
-    if (!impl->crtc_id && res->count_crtcs > 0) {
-        impl->crtc_id = res->crtcs[0];
-        log_debug("Using first available CRTC %d", impl->crtc_id);
-    }
+    impl->crtc_id = drm_select_crtc(impl->drm_fd, res, impl->connector);
+    drmModeFreeResources(res);
     
     if (!impl->crtc_id) {
         log_error("No CRTC available");
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "setup_drm_display: No free CRTC for output %d", output);
         drmModeFreeConnector(impl->connector);
-        drmModeFreeResources(res);
+        impl->connector = NULL;
+        drm_device_release();
+        impl->drm_fd = -1;
         return -1;
     }
+    impl->crtc_claimed = true;
     
-    drmModeFreeResources(res);
     return 0;
 }
 
@@ -233,23 +343,18 @@ static void sdl_drm_backend_present(DisplayBackend* backend) {
         return;
     }
     
-    /* Get SDL surface */
-    SDL_Surface* surface = SDL_GetWindowSurface(backend->window);
-    if (!surface) {
-        log_error("Failed to get SDL window surface");
-        return;
-    }
-    
+    SDL_Surface* surface = impl->target;
     SDL_LockSurface(surface);
     
-    /* Copy SDL surface to DRM buffer */
+    /* Copy render target to DRM buffer; formats match */
     int min_height = surface->h < impl->buffer->height ? surface->h : impl->buffer->height;
     int min_width = surface->w < impl->buffer->width ? surface->w : impl->buffer->width;
+    size_t row_bytes = (size_t)min_width * surface->format->BytesPerPixel;
     
     for (int y = 0; y < min_height; y++) {
-        uint32_t* src = (uint32_t*)((uint8_t*)surface->pixels + y * surface->pitch);
-        uint32_t* dst = impl->buffer->pixels + y * (impl->buffer->pitch / 4);
-        memcpy(dst, src, min_width * 4);
+        const uint8_t* src = (const uint8_t*)surface->pixels + y * surface->pitch;
+        uint8_t* dst = impl->buffer->pixels + y * impl->buffer->pitch;
+        memcpy(dst, src, row_bytes);
     }
     
     SDL_UnlockSurface(surface);
@@ -262,6 +367,27 @@ static void sdl_drm_backend_present(DisplayBackend* backend) {
     }
 }
 
+/* Vblank query - relative wait of zero returns the last vblank time */
+static bool sdl_drm_backend_get_vblank_time(DisplayBackend* backend, uint64_t* vblank_ns) {
+    if (!backend || !backend->impl.sdl_drm || backend->impl.sdl_drm->drm_fd < 0) {
+        return false;
+    }
+    
+    drmVBlank vbl;
+    memset(&vbl, 0, sizeof(vbl));
+    vbl.request.type = DRM_VBLANK_RELATIVE;
+    vbl.request.sequence = 0;
+    
+    if (drmWaitVBlank(backend->impl.sdl_drm->drm_fd, &vbl) != 0) {
+        return false;
+    }
+    
+    /* DRM reports vblank time on CLOCK_MONOTONIC */
+    *vblank_ns = (uint64_t)vbl.reply.tval_sec * 1000000000ull +
+                 (uint64_t)vbl.reply.tval_usec * 1000ull;
+    return *vblank_ns != 0;
+}
+
 /* Cleanup function */
 static void sdl_drm_backend_cleanup(DisplayBackend* backend) {
     if (!backend || !backend->impl.sdl_drm) {
@@ -273,13 +399,17 @@ static void sdl_drm_backend_cleanup(DisplayBackend* backend) {
     /* Destroy DRM resources */
     destroy_drm_buffer(impl->buffer);
     if (impl->connector) drmModeFreeConnector(impl->connector);
-    if (impl->drm_fd >= 0) close(impl->drm_fd);
+    if (impl->crtc_claimed) drm_release_crtc(impl->crtc_id);
+    if (impl->drm_fd >= 0) drm_device_release();
     
     /* Destroy SDL resources */
     if (backend->renderer) {
         SDL_DestroyRenderer(backend->renderer);
         backend->renderer = NULL;
     }
+    if (impl->target) {
+        SDL_FreeSurface(impl->target);
+    }
     
     if (backend->window) {
         SDL_DestroyWindow(backend->window);
@@ -324,9 +454,13 @@ DisplayBackend* display_backend_sdl_drm_create(const DisplayConfig* config) {
     backend->impl.sdl_drm = impl;
     backend->present = sdl_drm_backend_present;
     backend->cleanup = sdl_drm_backend_cleanup;
+    backend->get_vblank_time = sdl_drm_backend_get_vblank_time;
+    
+    /* Software renderer on an offscreen window has no thread-bound context */
+    backend->render_thread_safe = true;
     
     /* Setup DRM first to get actual display resolution */
-    if (setup_drm_display(impl) < 0) {
+    if (setup_drm_display(impl, config->output) < 0) {
         /* Error context already set by setup_drm_display */
         free(impl);
         free(backend);
@@ -394,8 +528,26 @@ DisplayBackend* display_backend_sdl_drm_create(const DisplayConfig* config) {
         return NULL;
     }
     
-    /* Create renderer (software) */
-    backend->renderer = SDL_CreateRenderer(backend->window, -1, SDL_RENDERER_SOFTWARE);
+    /* Create render target in the scanout format */
+    bool rgb565 = config->pixel_format == DISPLAY_PIXEL_FORMAT_RGB565;
+    backend->render_format = rgb565 ? SDL_PIXELFORMAT_RGB565 : SDL_PIXELFORMAT_RGB888;
+    backend->dither = rgb565 && config->dither;
+    impl->target = SDL_CreateRGBSurfaceWithFormat(0, backend->actual_width,
+                                                  backend->actual_height,
+                                                  rgb565 ? 16 : 32, backend->render_format);
+    if (!impl->target) {
+        LOG_SDL_ERROR("Failed to create render target surface");
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "display_backend_sdl_drm_create: %dx%d %s surface failed: %s",
+            backend->actual_width, backend->actual_height,
+            display_pixel_format_name(config->pixel_format), SDL_GetError());
+        sdl_drm_backend_cleanup(backend);
+        free(backend);
+        return NULL;
+    }
+    
+    /* Create renderer (software, drawing straight into the target) */
+    backend->renderer = SDL_CreateSoftwareRenderer(impl->target);
     if (!backend->renderer) {
         LOG_SDL_ERROR("Failed to create software renderer");
         sdl_drm_backend_cleanup(backend);
@@ -406,7 +558,8 @@ DisplayBackend* display_backend_sdl_drm_create(const DisplayConfig* config) {
     /* Create DRM buffer */
     impl->buffer = create_drm_buffer(impl->drm_fd, 
                                      impl->mode->hdisplay, 
-                                     impl->mode->vdisplay);
+                                     impl->mode->vdisplay,
+                                     rgb565 ? 16 : 32);
     if (!impl->buffer) {
         sdl_drm_backend_cleanup(backend);
         free(backend);
@@ -420,7 +573,9 @@ DisplayBackend* display_backend_sdl_drm_create(const DisplayConfig* config) {
         /* Continue anyway - might already be set correctly */
     }
     
-    log_info("SDL+DRM backend initialized successfully");
+    log_info("SDL+DRM backend initialized successfully (%s%s)",
+             display_pixel_format_name(config->pixel_format),
+             backend->dither ? ", dithered" : "");
     
     return backend;
 }
@@ -8,10 +8,12 @@
 #include "../core/error.h"
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 /* Forward declarations for backend implementations */
 extern DisplayBackend* display_backend_sdl_create(const DisplayConfig* config);
 extern DisplayBackend* display_backend_sdl_drm_create(const DisplayConfig* config);
+extern DisplayBackend* display_backend_fbdev_create(const DisplayConfig* config);
 
 /* Get backend type name */
 const char* display_backend_type_name(DisplayBackendType type) {
@@ -20,6 +22,8 @@ const char* display_backend_type_name(DisplayBackendType type) {
             return "SDL";
         case DISPLAY_BACKEND_SDL_DRM:
             return "SDL+DRM";
+        case DISPLAY_BACKEND_FBDEV:
+            return "FBDEV";
         case DISPLAY_BACKEND_AUTO:
             return "Auto";
         default:
@@ -43,6 +47,14 @@ bool display_backend_available(DisplayBackendType type) {
             return false;
 #endif
             
+        case DISPLAY_BACKEND_FBDEV:
+            /* Framebuffer devices are Linux-only */
+#ifdef __linux__
+            return true;
+#else
+            return false;
+#endif
+            
         case DISPLAY_BACKEND_AUTO:
             /* Auto is always "available" as it will pick something */
             return true;
@@ -63,6 +75,9 @@ static DisplayBackendType detect_best_backend(void) {
         } else if (strcmp(backend_env, "sdl_drm") == 0) {
             log_info("Display backend forced to SDL+DRM via environment");
             return DISPLAY_BACKEND_SDL_DRM;
+        } else if (strcmp(backend_env, "fbdev") == 0) {
+            log_info("Display backend forced to FBDEV via environment");
+            return DISPLAY_BACKEND_FBDEV;
         }
     }
     
@@ -73,7 +88,19 @@ static DisplayBackendType detect_best_backend(void) {
     const char* wayland = getenv("WAYLAND_DISPLAY");
     
     if (!display && !wayland) {
-        /* No display server, likely embedded - use DRM if available */
+        /* No display server, likely embedded - prefer DRM, fall back to
+         * fbdev on kernels that only expose a framebuffer device */
+        bool has_drm = access("/dev/dri/card0", F_OK) == 0 ||
+                       access("/dev/dri/card1", F_OK) == 0;
+        if (has_drm && display_backend_available(DISPLAY_BACKEND_SDL_DRM)) {
+            log_info("Auto-detected embedded environment, using SDL+DRM");
+            return DISPLAY_BACKEND_SDL_DRM;
+        }
+        if (access("/dev/fb0", F_OK) == 0 &&
+            display_backend_available(DISPLAY_BACKEND_FBDEV)) {
+            log_info("Auto-detected embedded environment without DRM, using FBDEV");
+            return DISPLAY_BACKEND_FBDEV;
+        }
         if (display_backend_available(DISPLAY_BACKEND_SDL_DRM)) {
             log_info("Auto-detected embedded environment, using SDL+DRM");
             return DISPLAY_BACKEND_SDL_DRM;
@@ -124,6 +151,10 @@ DisplayBackend* display_backend_create(const DisplayConfig* config) {
             backend = display_backend_sdl_drm_create(config);
             break;
             
+        case DISPLAY_BACKEND_FBDEV:
+            backend = display_backend_fbdev_create(config);
+            break;
+            
         default:
             log_error("Unknown display backend type: %d", type);
             pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
@@ -154,6 +185,19 @@ void display_backend_present(DisplayBackend* backend) {
     }
 }
 
+/* Query last vblank timestamp */
+bool display_backend_get_vblank_time(DisplayBackend* backend, uint64_t* vblank_ns) {
+    if (!backend || !vblank_ns) {
+        return false;
+    }
+    
+    if (backend->get_vblank_time) {
+        return backend->get_vblank_time(backend, vblank_ns);
+    }
+    
+    return false;
+}
+
 /* Destroy backend */
 void display_backend_destroy(DisplayBackend* backend) {
     if (!backend) {
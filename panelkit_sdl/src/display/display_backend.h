@@ -11,7 +11,9 @@
 #define PANELKIT_DISPLAY_BACKEND_H
 
 #include "core/sdl_includes.h"
+#include "pixel_format.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /** Opaque display backend handle */
 typedef struct DisplayBackend DisplayBackend;
@@ -23,6 +25,7 @@ typedef struct DisplayBackend DisplayBackend;
 typedef enum {
     DISPLAY_BACKEND_SDL,        /**< Standard SDL with window manager */
     DISPLAY_BACKEND_SDL_DRM,    /**< SDL + Direct DRM for embedded */
+    DISPLAY_BACKEND_FBDEV,      /**< Legacy Linux framebuffer (/dev/fbN) */
     DISPLAY_BACKEND_AUTO        /**< Auto-detect best backend */
 } DisplayBackendType;
 
@@ -37,11 +40,15 @@ typedef struct {
     DisplayBackendType backend_type; /**< Backend implementation to use */
     bool fullscreen;                /**< Start in fullscreen mode */
     bool vsync;                     /**< Enable vertical sync */
+    DisplayPixelFormat pixel_format; /**< Render target and scanout format */
+    bool dither;                    /**< Dither images when caching them at 16 bits */
+    int output;                     /**< SDL display, Nth connected DRM connector, or /dev/fbN */
 } DisplayConfig;
 
 /* Forward declarations for implementation types */
 struct SDLBackendImpl;
 struct SDLDRMBackendImpl;
+struct FbdevBackendImpl;
 
 /**
  * Display backend interface.
@@ -58,6 +65,7 @@ struct DisplayBackend {
     union {
         struct SDLBackendImpl* sdl;
         struct SDLDRMBackendImpl* sdl_drm;
+        struct FbdevBackendImpl* fbdev;
     } impl;
     
     /* SDL window handle (may be NULL for some backends) */
@@ -70,6 +78,14 @@ struct DisplayBackend {
     int actual_width;
     int actual_height;
     
+    /* Renderer and present may be driven from a non-creating thread */
+    bool render_thread_safe;
+    
+    /* Render target format (SDL_PIXELFORMAT_*) and whether cached images
+     * are dithered down to it */
+    Uint32 render_format;
+    bool dither;
+    
     /* Backend operations */
     void (*present)(DisplayBackend* backend);
     void (*cleanup)(DisplayBackend* backend);
@@ -77,6 +93,7 @@ struct DisplayBackend {
     /* Optional operations */
     bool (*set_vsync)(DisplayBackend* backend, bool enable);
     bool (*set_fullscreen)(DisplayBackend* backend, bool enable);
+    bool (*get_vblank_time)(DisplayBackend* backend, uint64_t* vblank_ns);
 };
 
 /**
@@ -96,6 +113,16 @@ DisplayBackend* display_backend_create(const DisplayConfig* config);
  */
 void display_backend_present(DisplayBackend* backend);
 
+/**
+ * Get the timestamp of the most recent vertical blank.
+ * 
+ * @param backend Display backend (required)
+ * @param vblank_ns Output CLOCK_MONOTONIC timestamp in nanoseconds (required)
+ * @return true if the backend reported a timestamp, false if unsupported
+ * @note Used by the frame scheduler to align frame starts with scanout
+ */
+bool display_backend_get_vblank_time(DisplayBackend* backend, uint64_t* vblank_ns);
+
 /**
  * Destroy a display backend.
  * 
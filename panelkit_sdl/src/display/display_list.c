@@ -0,0 +1,751 @@
+/**
+ * @file display_list.c
+ * @brief Display list recording and replay
+ */
+
+#include "display_list.h"
+#include "pixel_format.h"
+#include "../core/logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define DISPLAY_LIST_DEFAULT_CAPACITY 256
+#define DISPLAY_LIST_DEFAULT_VERTICES 1024
+#define TEXTURE_CACHE_INITIAL_CAPACITY 32
+
+typedef enum {
+    DL_CMD_SET_DRAW_COLOR,
+    DL_CMD_SET_BLEND_MODE,
+    DL_CMD_SET_CLIP_RECT,
+    DL_CMD_CLEAR,
+    DL_CMD_FILL_RECT,
+    DL_CMD_DRAW_RECT,
+    DL_CMD_COPY_SURFACE,
+    DL_CMD_GEOMETRY,
+    DL_CMD_COPY_YUV,
+    DL_CMD_KEEP_TEXTURE
+} DisplayListCommandType;
+
+typedef struct {
+    DisplayListCommandType type;
+    union {
+        SDL_Color color;
+        SDL_BlendMode blend_mode;
+        struct {
+            SDL_Rect rect;
+            bool enabled;
+        } clip;
+        SDL_Rect rect;
+        struct {
+            SDL_Surface* surface;
+            SDL_Rect src;
+            SDL_Rect dst;
+            bool has_src;
+            bool has_dst;
+        } copy;
+        struct {
+            SDL_Surface* surface;   /* NULL for untextured geometry */
+            size_t first_vertex;    /* Offsets into the list's arenas */
+            size_t vertex_count;
+            size_t first_index;
+            size_t index_count;
+        } geometry;
+        struct {
+            const void* stream;     /* Identifies the streaming texture */
+            YuvFrame* frame;        /* Retained until the list is reset */
+            SDL_Rect dst;
+        } yuv;
+        SDL_Surface* keep;          /* Texture kept resident, not drawn */
+    } data;
+} DisplayListCommand;
+
+struct DisplayList {
+    DisplayListCommand* commands;
+    size_t count;
+    size_t capacity;
+
+    /* Geometry arenas shared by all DL_CMD_GEOMETRY commands */
+    SDL_Vertex* vertices;
+    size_t vertex_count;
+    size_t vertex_capacity;
+    int* indices;
+    size_t index_count;
+    size_t index_capacity;
+};
+
+typedef struct {
+    const void* key;            /* Surface or stream identity */
+    SDL_Surface* surface;       /* Retained while cached (NULL for streams) */
+    SDL_Texture* texture;
+    uint64_t sequence;          /* Last frame uploaded to a stream texture */
+    uint64_t last_used;
+} TextureCacheEntry;
+
+struct DisplayListTextureCache {
+    SDL_Renderer* renderer;     /* Renderer the textures belong to */
+    TextureCacheEntry* entries;
+    size_t count;
+    size_t capacity;
+    uint64_t generation;
+    bool rgb565;                /* Store opaque images at 16 bits */
+    bool dither;                /* Dither them on the way down */
+};
+
+/* SDL_Surface refcount is a plain int; serialize updates across threads */
+static pthread_mutex_t surface_ref_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Surface references
+
+void display_list_retain_surface(SDL_Surface* surface) {
+    if (!surface) {
+        return;
+    }
+
+    pthread_mutex_lock(&surface_ref_mutex);
+    surface->refcount++;
+    pthread_mutex_unlock(&surface_ref_mutex);
+}
+
+void display_list_release_surface(SDL_Surface* surface) {
+    if (!surface) {
+        return;
+    }
+
+    /* SDL_FreeSurface decrements and frees on the last reference */
+    pthread_mutex_lock(&surface_ref_mutex);
+    SDL_FreeSurface(surface);
+    pthread_mutex_unlock(&surface_ref_mutex);
+}
+
+// Lifecycle
+
+DisplayList* display_list_create(size_t initial_capacity) {
+    DisplayList* list = calloc(1, sizeof(DisplayList));
+    if (!list) {
+        log_error("Failed to allocate display list");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "display_list_create: Failed to allocate %zu bytes", sizeof(DisplayList));
+        return NULL;
+    }
+
+    list->capacity = initial_capacity ? initial_capacity : DISPLAY_LIST_DEFAULT_CAPACITY;
+    list->commands = malloc(list->capacity * sizeof(DisplayListCommand));
+    if (!list->commands) {
+        log_error("Failed to allocate %zu display list commands", list->capacity);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "display_list_create: Failed to allocate %zu commands", list->capacity);
+        free(list);
+        return NULL;
+    }
+
+    return list;
+}
+
+void display_list_destroy(DisplayList* list) {
+    if (!list) {
+        return;
+    }
+
+    display_list_reset(list);
+    free(list->commands);
+    free(list->vertices);
+    free(list->indices);
+    free(list);
+}
+
+void display_list_reset(DisplayList* list) {
+    if (!list) {
+        return;
+    }
+
+    for (size_t i = 0; i < list->count; i++) {
+        if (list->commands[i].type == DL_CMD_COPY_SURFACE) {
+            display_list_release_surface(list->commands[i].data.copy.surface);
+        } else if (list->commands[i].type == DL_CMD_GEOMETRY) {
+            display_list_release_surface(list->commands[i].data.geometry.surface);
+        } else if (list->commands[i].type == DL_CMD_COPY_YUV) {
+            yuv_frame_release(list->commands[i].data.yuv.frame);
+        } else if (list->commands[i].type == DL_CMD_KEEP_TEXTURE) {
+            display_list_release_surface(list->commands[i].data.keep);
+        }
+    }
+    list->count = 0;
+    list->vertex_count = 0;
+    list->index_count = 0;
+}
+
+size_t display_list_get_command_count(const DisplayList* list) {
+    return list ? list->count : 0;
+}
+
+// Recording
+
+static DisplayListCommand* append_command(DisplayList* list, DisplayListCommandType type) {
+    if (!list) {
+        SDL_SetError("Display list is NULL");
+        return NULL;
+    }
+
+    if (list->count >= list->capacity) {
+        size_t new_capacity = list->capacity * 2;
+        DisplayListCommand* commands = realloc(list->commands,
+                                               new_capacity * sizeof(DisplayListCommand));
+        if (!commands) {
+            SDL_SetError("Display list out of memory (%zu commands)", list->count);
+            return NULL;
+        }
+        list->commands = commands;
+        list->capacity = new_capacity;
+    }
+
+    DisplayListCommand* cmd = &list->commands[list->count++];
+    cmd->type = type;
+    return cmd;
+}
+
+int display_list_set_draw_color(DisplayList* list, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    DisplayListCommand* cmd = append_command(list, DL_CMD_SET_DRAW_COLOR);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->data.color = (SDL_Color){r, g, b, a};
+    return 0;
+}
+
+int display_list_set_blend_mode(DisplayList* list, SDL_BlendMode mode) {
+    DisplayListCommand* cmd = append_command(list, DL_CMD_SET_BLEND_MODE);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->data.blend_mode = mode;
+    return 0;
+}
+
+int display_list_set_clip_rect(DisplayList* list, const SDL_Rect* rect) {
+    DisplayListCommand* cmd = append_command(list, DL_CMD_SET_CLIP_RECT);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->data.clip.enabled = rect != NULL;
+    if (rect) {
+        cmd->data.clip.rect = *rect;
+    }
+    return 0;
+}
+
+int display_list_clear(DisplayList* list) {
+    return append_command(list, DL_CMD_CLEAR) ? 0 : -1;
+}
+
+int display_list_fill_rect(DisplayList* list, const SDL_Rect* rect) {
+    if (!rect) {
+        return SDL_SetError("Parameter 'rect' is invalid");
+    }
+    DisplayListCommand* cmd = append_command(list, DL_CMD_FILL_RECT);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->data.rect = *rect;
+    return 0;
+}
+
+int display_list_draw_rect(DisplayList* list, const SDL_Rect* rect) {
+    if (!rect) {
+        return SDL_SetError("Parameter 'rect' is invalid");
+    }
+    DisplayListCommand* cmd = append_command(list, DL_CMD_DRAW_RECT);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->data.rect = *rect;
+    return 0;
+}
+
+int display_list_copy_surface(DisplayList* list, SDL_Surface* surface,
+                              const SDL_Rect* src, const SDL_Rect* dst) {
+    if (!surface) {
+        return SDL_SetError("Parameter 'surface' is invalid");
+    }
+    DisplayListCommand* cmd = append_command(list, DL_CMD_COPY_SURFACE);
+    if (!cmd) {
+        return -1;
+    }
+
+    display_list_retain_surface(surface);
+    cmd->data.copy.surface = surface;
+    cmd->data.copy.has_src = src != NULL;
+    cmd->data.copy.has_dst = dst != NULL;
+    if (src) {
+        cmd->data.copy.src = *src;
+    }
+    if (dst) {
+        cmd->data.copy.dst = *dst;
+    }
+    return 0;
+}
+
+int display_list_copy_yuv(DisplayList* list, const void* stream, YuvFrame* frame,
+                          const SDL_Rect* dst) {
+    if (!stream || !frame || !dst) {
+        return SDL_SetError("Parameter 'stream', 'frame' or 'dst' is invalid");
+    }
+    DisplayListCommand* cmd = append_command(list, DL_CMD_COPY_YUV);
+    if (!cmd) {
+        return -1;
+    }
+
+    yuv_frame_retain(frame);
+    cmd->data.yuv.stream = stream;
+    cmd->data.yuv.frame = frame;
+    cmd->data.yuv.dst = *dst;
+    return 0;
+}
+
+int display_list_keep_texture(DisplayList* list, SDL_Surface* surface) {
+    if (!surface) {
+        return SDL_SetError("Parameter 'surface' is invalid");
+    }
+    DisplayListCommand* cmd = append_command(list, DL_CMD_KEEP_TEXTURE);
+    if (!cmd) {
+        return -1;
+    }
+
+    display_list_retain_surface(surface);
+    cmd->data.keep = surface;
+    return 0;
+}
+
+/* Grow a geometry arena to hold at least `needed` elements */
+static bool reserve_arena(void** arena, size_t* capacity, size_t needed, size_t elem_size) {
+    if (needed <= *capacity) {
+        return true;
+    }
+
+    size_t new_capacity = *capacity ? *capacity : DISPLAY_LIST_DEFAULT_VERTICES;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    void* grown = realloc(*arena, new_capacity * elem_size);
+    if (!grown) {
+        return false;
+    }
+    *arena = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+int display_list_geometry(DisplayList* list, SDL_Surface* surface,
+                          const SDL_Vertex* vertices, int num_vertices,
+                          const int* indices, int num_indices) {
+    if (!list) {
+        return SDL_SetError("Display list is NULL");
+    }
+    if (!vertices || num_vertices <= 0 || !indices || num_indices <= 0) {
+        return SDL_SetError("Parameter 'vertices' or 'indices' is invalid");
+    }
+
+    if (!reserve_arena((void**)&list->vertices, &list->vertex_capacity,
+                       list->vertex_count + (size_t)num_vertices, sizeof(SDL_Vertex)) ||
+        !reserve_arena((void**)&list->indices, &list->index_capacity,
+                       list->index_count + (size_t)num_indices, sizeof(int))) {
+        return SDL_SetError("Display list out of memory (%zu vertices)", list->vertex_count);
+    }
+
+    /* Extend the previous batch when it samples the same surface */
+    DisplayListCommand* cmd = NULL;
+    if (list->count > 0) {
+        DisplayListCommand* last = &list->commands[list->count - 1];
+        if (last->type == DL_CMD_GEOMETRY && last->data.geometry.surface == surface) {
+            cmd = last;
+        }
+    }
+
+    if (!cmd) {
+        cmd = append_command(list, DL_CMD_GEOMETRY);
+        if (!cmd) {
+            return -1;
+        }
+        display_list_retain_surface(surface);
+        cmd->data.geometry.surface = surface;
+        cmd->data.geometry.first_vertex = list->vertex_count;
+        cmd->data.geometry.vertex_count = 0;
+        cmd->data.geometry.first_index = list->index_count;
+        cmd->data.geometry.index_count = 0;
+    }
+
+    /* Indices are relative to the batch, not to the caller's vertex array */
+    int base = (int)cmd->data.geometry.vertex_count;
+    memcpy(&list->vertices[list->vertex_count], vertices,
+           (size_t)num_vertices * sizeof(SDL_Vertex));
+    for (int i = 0; i < num_indices; i++) {
+        list->indices[list->index_count + (size_t)i] = indices[i] + base;
+    }
+
+    list->vertex_count += (size_t)num_vertices;
+    list->index_count += (size_t)num_indices;
+    cmd->data.geometry.vertex_count += (size_t)num_vertices;
+    cmd->data.geometry.index_count += (size_t)num_indices;
+    return 0;
+}
+
+// Texture cache
+
+DisplayListTextureCache* display_list_texture_cache_create(void) {
+    DisplayListTextureCache* cache = calloc(1, sizeof(DisplayListTextureCache));
+    if (!cache) {
+        log_error("Failed to allocate display list texture cache");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "display_list_texture_cache_create: Failed to allocate %zu bytes",
+            sizeof(DisplayListTextureCache));
+        return NULL;
+    }
+    return cache;
+}
+
+static void texture_cache_evict(DisplayListTextureCache* cache, size_t index) {
+    SDL_DestroyTexture(cache->entries[index].texture);
+    display_list_release_surface(cache->entries[index].surface);
+    cache->entries[index] = cache->entries[--cache->count];
+}
+
+static void texture_cache_flush(DisplayListTextureCache* cache) {
+    while (cache->count > 0) {
+        texture_cache_evict(cache, cache->count - 1);
+    }
+}
+
+void display_list_texture_cache_destroy(DisplayListTextureCache* cache) {
+    if (!cache) {
+        return;
+    }
+
+    texture_cache_flush(cache);
+    free(cache->entries);
+    free(cache);
+}
+
+void display_list_texture_cache_set_format(DisplayListTextureCache* cache,
+                                           Uint32 format, bool dither) {
+    if (!cache) {
+        return;
+    }
+
+    bool rgb565 = format == SDL_PIXELFORMAT_RGB565;
+    dither = dither && rgb565;
+    if (rgb565 != cache->rgb565 || dither != cache->dither) {
+        texture_cache_flush(cache);
+        cache->rgb565 = rgb565;
+        cache->dither = dither;
+    }
+}
+
+static TextureCacheEntry* texture_cache_find(DisplayListTextureCache* cache, const void* key) {
+    for (size_t i = 0; i < cache->count; i++) {
+        if (cache->entries[i].key == key) {
+            cache->entries[i].last_used = cache->generation;
+            return &cache->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static TextureCacheEntry* texture_cache_add(DisplayListTextureCache* cache, const void* key,
+                                            SDL_Surface* surface, SDL_Texture* texture) {
+    if (cache->count >= cache->capacity) {
+        size_t new_capacity = cache->capacity ? cache->capacity * 2 : TEXTURE_CACHE_INITIAL_CAPACITY;
+        TextureCacheEntry* entries = realloc(cache->entries,
+                                             new_capacity * sizeof(TextureCacheEntry));
+        if (!entries) {
+            SDL_SetError("Texture cache out of memory");
+            return NULL;
+        }
+        cache->entries = entries;
+        cache->capacity = new_capacity;
+    }
+
+    display_list_retain_surface(surface);
+    TextureCacheEntry* entry = &cache->entries[cache->count++];
+    *entry = (TextureCacheEntry){
+        .key = key,
+        .surface = surface,
+        .texture = texture,
+        .sequence = 0,
+        .last_used = cache->generation
+    };
+    return entry;
+}
+
+/* Pack an opaque image to RGB565 once, instead of on every blit into a
+ * 16-bit target; images with alpha or a colour key are left to SDL */
+static SDL_Texture* texture_create_rgb565(SDL_Renderer* renderer, SDL_Surface* surface,
+                                          bool dither) {
+    if (SDL_ISPIXELFORMAT_ALPHA(surface->format->format) || SDL_HasColorKey(surface)) {
+        return SDL_CreateTextureFromSurface(renderer, surface);
+    }
+
+    SDL_Surface* xrgb = NULL;
+    if (surface->format->format != SDL_PIXELFORMAT_RGB888) {
+        xrgb = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB888, 0);
+        if (!xrgb) {
+            return NULL;
+        }
+    }
+    SDL_Surface* source = xrgb ? xrgb : surface;
+    SDL_Surface* packed = SDL_CreateRGBSurfaceWithFormat(0, source->w, source->h, 16,
+                                                         SDL_PIXELFORMAT_RGB565);
+    if (!packed) {
+        SDL_FreeSurface(xrgb);
+        return NULL;
+    }
+
+    if (SDL_MUSTLOCK(source)) {
+        SDL_LockSurface(source);
+    }
+    pixel_convert_rgb565(source->pixels, source->pitch, packed->pixels, packed->pitch,
+                         source->w, source->h, dither);
+    if (SDL_MUSTLOCK(source)) {
+        SDL_UnlockSurface(source);
+    }
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, packed);
+    SDL_FreeSurface(packed);
+    SDL_FreeSurface(xrgb);
+
+    /* Carry over modulation the recorder set on the original */
+    if (texture) {
+        Uint8 r, g, b, a;
+        SDL_BlendMode mode;
+        SDL_GetSurfaceColorMod(surface, &r, &g, &b);
+        SDL_GetSurfaceAlphaMod(surface, &a);
+        SDL_GetSurfaceBlendMode(surface, &mode);
+        SDL_SetTextureColorMod(texture, r, g, b);
+        SDL_SetTextureAlphaMod(texture, a);
+        SDL_SetTextureBlendMode(texture, mode);
+    }
+    return texture;
+}
+
+/* Converting a surface rewrites its blit map, so uploads of one surface
+ * from several renderers at once (panels sharing a skin atlas, see
+ * panel_server.h) would race; uploads are rare, serialize them all */
+static pthread_mutex_t surface_upload_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static SDL_Texture* texture_create(DisplayListTextureCache* cache, SDL_Renderer* renderer,
+                                   SDL_Surface* surface) {
+    pthread_mutex_lock(&surface_upload_mutex);
+    SDL_Texture* texture = cache && cache->rgb565 ?
+        texture_create_rgb565(renderer, surface, cache->dither) :
+        SDL_CreateTextureFromSurface(renderer, surface);
+    pthread_mutex_unlock(&surface_upload_mutex);
+    return texture;
+}
+
+/* Look up or create the texture for a surface; NULL cache means uncached */
+static SDL_Texture* texture_for_surface(DisplayListTextureCache* cache,
+                                        SDL_Renderer* renderer, SDL_Surface* surface) {
+    if (!cache) {
+        return texture_create(NULL, renderer, surface);
+    }
+
+    TextureCacheEntry* entry = texture_cache_find(cache, surface);
+    if (entry) {
+        return entry->texture;
+    }
+
+    SDL_Texture* texture = texture_create(cache, renderer, surface);
+    if (!texture) {
+        return NULL;
+    }
+
+    if (!texture_cache_add(cache, surface, surface, texture)) {
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+    return texture;
+}
+
+/* Streaming texture for a video stream, uploading the frame if it changed */
+static SDL_Texture* texture_for_yuv(DisplayListTextureCache* cache, SDL_Renderer* renderer,
+                                    const void* stream, YuvFrame* frame) {
+    TextureCacheEntry* entry = cache ? texture_cache_find(cache, stream) : NULL;
+
+    if (entry) {
+        int w = 0, h = 0;
+        SDL_QueryTexture(entry->texture, NULL, NULL, &w, &h);
+        if (w != frame->width || h != frame->height) {
+            /* Stream changed resolution; drop the old texture */
+            SDL_DestroyTexture(entry->texture);
+            entry->texture = NULL;
+        }
+    }
+
+    SDL_Texture* texture = entry ? entry->texture : NULL;
+    if (!texture) {
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_IYUV, SDL_TEXTUREACCESS_STREAMING,
+                                    frame->width, frame->height);
+        if (!texture) {
+            return NULL;
+        }
+        if (entry) {
+            entry->texture = texture;
+            entry->sequence = 0;
+        } else if (cache) {
+            entry = texture_cache_add(cache, stream, NULL, texture);
+            if (!entry) {
+                SDL_DestroyTexture(texture);
+                return NULL;
+            }
+        }
+    }
+
+    if (!entry || entry->sequence != frame->sequence) {
+        if (SDL_UpdateYUVTexture(texture, NULL,
+                                 frame->planes[0], frame->pitches[0],
+                                 frame->planes[1], frame->pitches[1],
+                                 frame->planes[2], frame->pitches[2]) < 0) {
+            if (!entry) {
+                SDL_DestroyTexture(texture);
+            }
+            return NULL;
+        }
+        if (entry) {
+            entry->sequence = frame->sequence;
+        }
+    }
+
+    return texture;
+}
+
+// Execution
+
+PkError display_list_execute(const DisplayList* list, SDL_Renderer* renderer,
+                             DisplayListTextureCache* cache) {
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in display_list_execute");
+    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
+                               "renderer is NULL in display_list_execute");
+
+    if (cache) {
+        if (cache->renderer != renderer) {
+            texture_cache_flush(cache);
+            cache->renderer = renderer;
+        }
+        cache->generation++;
+    }
+
+    PkError result = PK_OK;
+
+    for (size_t i = 0; i < list->count && result == PK_OK; i++) {
+        const DisplayListCommand* cmd = &list->commands[i];
+        int rc = 0;
+
+        switch (cmd->type) {
+            case DL_CMD_SET_DRAW_COLOR:
+                rc = SDL_SetRenderDrawColor(renderer, cmd->data.color.r, cmd->data.color.g,
+                                            cmd->data.color.b, cmd->data.color.a);
+                break;
+
+            case DL_CMD_SET_BLEND_MODE:
+                rc = SDL_SetRenderDrawBlendMode(renderer, cmd->data.blend_mode);
+                break;
+
+            case DL_CMD_SET_CLIP_RECT:
+                rc = SDL_RenderSetClipRect(renderer,
+                                           cmd->data.clip.enabled ? &cmd->data.clip.rect : NULL);
+                break;
+
+            case DL_CMD_CLEAR:
+                rc = SDL_RenderClear(renderer);
+                break;
+
+            case DL_CMD_FILL_RECT:
+                rc = SDL_RenderFillRect(renderer, &cmd->data.rect);
+                break;
+
+            case DL_CMD_DRAW_RECT:
+                rc = SDL_RenderDrawRect(renderer, &cmd->data.rect);
+                break;
+
+            case DL_CMD_COPY_SURFACE: {
+                SDL_Texture* texture = texture_for_surface(cache, renderer,
+                                                           cmd->data.copy.surface);
+                if (!texture) {
+                    rc = -1;
+                    break;
+                }
+                rc = SDL_RenderCopy(renderer, texture,
+                                    cmd->data.copy.has_src ? &cmd->data.copy.src : NULL,
+                                    cmd->data.copy.has_dst ? &cmd->data.copy.dst : NULL);
+                if (!cache) {
+                    SDL_DestroyTexture(texture);
+                }
+                break;
+            }
+
+            case DL_CMD_COPY_YUV: {
+                SDL_Texture* texture = texture_for_yuv(cache, renderer, cmd->data.yuv.stream,
+                                                       cmd->data.yuv.frame);
+                if (!texture) {
+                    rc = -1;
+                    break;
+                }
+                rc = SDL_RenderCopy(renderer, texture, NULL, &cmd->data.yuv.dst);
+                if (!cache) {
+                    SDL_DestroyTexture(texture);
+                }
+                break;
+            }
+
+            case DL_CMD_GEOMETRY: {
+                SDL_Texture* texture = NULL;
+                if (cmd->data.geometry.surface) {
+                    texture = texture_for_surface(cache, renderer, cmd->data.geometry.surface);
+                    if (!texture) {
+                        rc = -1;
+                        break;
+                    }
+                }
+                rc = SDL_RenderGeometry(renderer, texture,
+                                        &list->vertices[cmd->data.geometry.first_vertex],
+                                        (int)cmd->data.geometry.vertex_count,
+                                        &list->indices[cmd->data.geometry.first_index],
+                                        (int)cmd->data.geometry.index_count);
+                if (texture && !cache) {
+                    SDL_DestroyTexture(texture);
+                }
+                break;
+            }
+
+            case DL_CMD_KEEP_TEXTURE:
+                /* Only meaningful with a cache: marks the entry used this frame */
+                if (cache && !texture_for_surface(cache, renderer, cmd->data.keep)) {
+                    rc = -1;
+                }
+                break;
+        }
+
+        if (rc < 0) {
+            pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                           "Display list command %zu (type %d) failed: %s",
+                                           i, cmd->type, SDL_GetError());
+            result = PK_ERROR_RENDER_FAILED;
+        }
+    }
+
+    /* Leave the renderer in a known state for the next list */
+    SDL_RenderSetClipRect(renderer, NULL);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    /* Drop textures for surfaces no longer drawn or kept (text changed, widget hidden) */
+    if (cache) {
+        for (size_t i = cache->count; i > 0; i--) {
+            if (cache->entries[i - 1].last_used != cache->generation) {
+                texture_cache_evict(cache, i - 1);
+            }
+        }
+    }
+
+    return result;
+}
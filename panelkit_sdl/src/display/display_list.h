@@ -0,0 +1,224 @@
+/**
+ * @file display_list.h
+ * @brief Recorded drawing commands for one frame
+ *
+ * Widgets record their drawing into a DisplayList instead of calling the
+ * SDL renderer directly. Once a frame is recorded the list is treated as
+ * an immutable snapshot and can be executed on another thread (see
+ * render_pipeline.h) while the next frame is being built.
+ *
+ * The recording functions mirror the SDL_Render* calls they replace and
+ * return 0 on success, -1 on failure with SDL_GetError() describing the
+ * problem, so existing `< 0` error checks carry over unchanged.
+ */
+
+#ifndef PANELKIT_DISPLAY_LIST_H
+#define PANELKIT_DISPLAY_LIST_H
+
+#include "core/sdl_includes.h"
+#include "../core/error.h"
+#include "yuv_frame.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Opaque display list handle */
+typedef struct DisplayList DisplayList;
+
+/** Opaque cache of textures created from recorded surfaces */
+typedef struct DisplayListTextureCache DisplayListTextureCache;
+
+// Lifecycle
+
+/**
+ * Create an empty display list.
+ *
+ * @param initial_capacity Initial command capacity (0 for default)
+ * @return New display list or NULL on error (caller owns)
+ */
+DisplayList* display_list_create(size_t initial_capacity);
+
+/**
+ * Destroy a display list and release any surfaces it references.
+ *
+ * @param list Display list to destroy (can be NULL)
+ */
+void display_list_destroy(DisplayList* list);
+
+/**
+ * Remove all commands so the list can be recorded again.
+ *
+ * @param list Display list (required)
+ * @note Keeps allocated capacity; releases surface references
+ */
+void display_list_reset(DisplayList* list);
+
+/**
+ * Get the number of recorded commands.
+ *
+ * @param list Display list (required)
+ * @return Command count
+ */
+size_t display_list_get_command_count(const DisplayList* list);
+
+// Recording
+
+/**
+ * Record a draw color change (SDL_SetRenderDrawColor).
+ */
+int display_list_set_draw_color(DisplayList* list, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+
+/**
+ * Record a blend mode change (SDL_SetRenderDrawBlendMode).
+ */
+int display_list_set_blend_mode(DisplayList* list, SDL_BlendMode mode);
+
+/**
+ * Record a clip rectangle change (SDL_RenderSetClipRect).
+ *
+ * @param list Display list (required)
+ * @param rect Clip rectangle, or NULL to disable clipping
+ */
+int display_list_set_clip_rect(DisplayList* list, const SDL_Rect* rect);
+
+/**
+ * Record a clear of the whole target with the current draw color.
+ */
+int display_list_clear(DisplayList* list);
+
+/**
+ * Record a filled rectangle (SDL_RenderFillRect).
+ */
+int display_list_fill_rect(DisplayList* list, const SDL_Rect* rect);
+
+/**
+ * Record a rectangle outline (SDL_RenderDrawRect).
+ */
+int display_list_draw_rect(DisplayList* list, const SDL_Rect* rect);
+
+/**
+ * Record a copy of a surface to the target (SDL_RenderCopy).
+ *
+ * @param list Display list (required)
+ * @param surface Source surface (required, retained by the list)
+ * @param src Source rectangle, or NULL for the whole surface
+ * @param dst Destination rectangle, or NULL for the whole target
+ * @note The surface's pixels must not be modified after recording; create
+ *       a new surface instead. Textures are created when the list executes.
+ */
+int display_list_copy_surface(DisplayList* list, SDL_Surface* surface,
+                              const SDL_Rect* src, const SDL_Rect* dst);
+
+/**
+ * Record indexed triangles (SDL_RenderGeometry).
+ *
+ * @param list Display list (required)
+ * @param surface Texture source (NULL for untextured, retained by the list)
+ * @param vertices Vertex array (copied)
+ * @param num_vertices Number of vertices
+ * @param indices Triangle indices into vertices (copied)
+ * @param num_indices Number of indices (multiple of 3)
+ * @note Consecutive calls with the same surface are merged into a single
+ *       geometry command, so many quads cost one draw call
+ */
+int display_list_geometry(DisplayList* list, SDL_Surface* surface,
+                          const SDL_Vertex* vertices, int num_vertices,
+                          const int* indices, int num_indices);
+
+/**
+ * Record a video frame drawn into a destination rectangle.
+ *
+ * @param list Display list (required)
+ * @param stream Stable identity of the video stream, e.g. the widget
+ *               (required); frames of one stream share a streaming texture
+ * @param frame Frame to draw (required, retained by the list)
+ * @param dst Destination rectangle (required)
+ * @note The frame is uploaded with SDL_UpdateYUVTexture only when its
+ *       sequence differs from the last upload for the stream
+ */
+int display_list_copy_yuv(DisplayList* list, const void* stream, YuvFrame* frame,
+                          const SDL_Rect* dst);
+
+/**
+ * Keep the cached texture for a surface resident without drawing it.
+ *
+ * @param list Display list (required)
+ * @param surface Surface whose texture to keep (required, retained by the list)
+ * @return 0 on success, -1 on failure
+ * @note Creates the texture if it is not cached yet, so content that is
+ *       about to scroll into view can be uploaded ahead of time. Executing
+ *       without a texture cache makes this a no-op.
+ */
+int display_list_keep_texture(DisplayList* list, SDL_Surface* surface);
+
+// Surface references
+
+/**
+ * Take a reference to a surface that may be shared with the render thread.
+ *
+ * @param surface Surface to retain (can be NULL)
+ * @note Use instead of touching surface->refcount directly
+ */
+void display_list_retain_surface(SDL_Surface* surface);
+
+/**
+ * Drop a reference taken by creation or display_list_retain_surface().
+ *
+ * @param surface Surface to release (can be NULL)
+ * @note Frees the surface when the last reference is dropped
+ */
+void display_list_release_surface(SDL_Surface* surface);
+
+// Execution
+
+/**
+ * Create a cache for textures built from recorded surfaces.
+ *
+ * @return New cache or NULL on error (caller owns)
+ * @note Must be used and destroyed on the thread that executes lists
+ */
+DisplayListTextureCache* display_list_texture_cache_create(void);
+
+/**
+ * Destroy a texture cache.
+ *
+ * @param cache Cache to destroy (can be NULL)
+ */
+void display_list_texture_cache_destroy(DisplayListTextureCache* cache);
+
+/**
+ * Match cached textures to the render target format.
+ *
+ * With an RGB565 target, opaque images are packed to 16 bits once when
+ * cached (optionally with ordered dithering) instead of being converted on
+ * every blit. Images with alpha are cached as they are.
+ *
+ * @param cache Texture cache (can be NULL)
+ * @param format Render target format (SDL_PIXELFORMAT_*)
+ * @param dither Dither opaque images packed to RGB565
+ * @note Changing the format flushes the cache
+ */
+void display_list_texture_cache_set_format(DisplayListTextureCache* cache,
+                                           Uint32 format, bool dither);
+
+/**
+ * Replay a display list onto a renderer.
+ *
+ * @param list Display list to execute (required, not modified)
+ * @param renderer Target renderer (required)
+ * @param cache Texture cache (NULL to create textures per frame)
+ * @return PK_OK on success, error code on failure
+ * @note Clip rectangle and blend mode are reset afterwards; cached textures
+ *       not used by this list are evicted
+ */
+PkError display_list_execute(const DisplayList* list, SDL_Renderer* renderer,
+                             DisplayListTextureCache* cache);
+
+/**
+ * @note Thread Safety: A display list must only be recorded by one thread
+ *       at a time. After recording it may be executed from another thread
+ *       as long as the recorder does not touch it until execution ends.
+ *       Surface retain/release is thread-safe, and lists sharing surfaces
+ *       may execute on different renderers at the same time.
+ */
+
+#endif /* PANELKIT_DISPLAY_LIST_H */
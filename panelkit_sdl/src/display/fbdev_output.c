@@ -0,0 +1,461 @@
+/**
+ * @file fbdev_output.c
+ * @brief Legacy Linux framebuffer (/dev/fbN) output with damage-only copies
+ */
+
+#include "fbdev_output.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/fb.h>
+
+#ifndef FBIO_WAITFORVSYNC
+#define FBIO_WAITFORVSYNC _IOW('F', 0x20, uint32_t)
+#endif
+#endif /* __linux__ */
+
+#define FBDEV_DEFAULT_DEVICE "/dev/fb0"
+
+/* Damage granularity: wide and short, since copies are row-contiguous */
+#define FBDEV_TILE_W 64
+#define FBDEV_TILE_H 16
+
+struct FbdevOutput {
+    int fd;                         /* -1 for memory-backed output */
+    uint8_t* map;                   /* Page 0; pages follow every height rows */
+    size_t map_size;
+    FbdevInfo info;
+    int bytes_per_pixel;
+    int front;                      /* Page being scanned out */
+    bool vsync_supported;
+
+    /* Last presented frame in system memory, and per page which tiles
+     * still hold older content */
+    uint8_t* shadow;
+    int shadow_pitch;
+    bool primed;                    /* Shadow holds a frame */
+    uint8_t* dirty[FBDEV_MAX_PAGES];
+    int tiles_x;
+    int tiles_y;
+
+#ifdef __linux__
+    struct fb_var_screeninfo var;   /* For panning */
+#endif
+
+    FbdevStats stats;
+};
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+/* Allocate the shadow frame and dirty maps once geometry is known */
+static bool output_init_tracking(FbdevOutput* output) {
+    const FbdevInfo* info = &output->info;
+    output->bytes_per_pixel = info->bits_per_pixel / 8;
+    output->shadow_pitch = info->width * output->bytes_per_pixel;
+    output->tiles_x = (info->width + FBDEV_TILE_W - 1) / FBDEV_TILE_W;
+    output->tiles_y = (info->height + FBDEV_TILE_H - 1) / FBDEV_TILE_H;
+
+    output->shadow = malloc((size_t)output->shadow_pitch * info->height);
+    for (int p = 0; p < FBDEV_MAX_PAGES; p++) {
+        output->dirty[p] = calloc((size_t)output->tiles_x * output->tiles_y, 1);
+    }
+    if (!output->shadow || !output->dirty[0] || !output->dirty[1]) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "fbdev_output: Failed to allocate %dx%d shadow frame",
+            info->width, info->height);
+        return false;
+    }
+    return true;
+}
+
+static uint8_t* page_start(const FbdevOutput* output, int page) {
+    return output->map + (size_t)page * output->info.height * output->info.line_length;
+}
+
+FbdevOutput* fbdev_output_create_memory(int width, int height, int bits_per_pixel, int pages) {
+    if (width <= 0 || height <= 0 || (bits_per_pixel != 16 && bits_per_pixel != 32) ||
+        pages < 1 || pages > FBDEV_MAX_PAGES) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "fbdev_output_create_memory: Invalid %dx%d, %d bpp, %d pages",
+            width, height, bits_per_pixel, pages);
+        return NULL;
+    }
+
+    FbdevOutput* output = calloc(1, sizeof(FbdevOutput));
+    if (!output) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "fbdev_output_create_memory: Failed to allocate %zu bytes", sizeof(FbdevOutput));
+        return NULL;
+    }
+
+    output->fd = -1;
+    output->info = (FbdevInfo){
+        .width = width,
+        .height = height,
+        .bits_per_pixel = bits_per_pixel,
+        .line_length = width * bits_per_pixel / 8,
+        .pages = pages,
+        .red_mask = bits_per_pixel == 16 ? 0xF800 : 0xFF0000,
+        .green_mask = bits_per_pixel == 16 ? 0x07E0 : 0x00FF00,
+        .blue_mask = bits_per_pixel == 16 ? 0x001F : 0x0000FF
+    };
+    output->map_size = (size_t)output->info.line_length * height * pages;
+    output->map = calloc(1, output->map_size);
+    if (!output->map || !output_init_tracking(output)) {
+        if (!output->map) {
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                "fbdev_output_create_memory: Failed to allocate %zu bytes", output->map_size);
+        }
+        fbdev_output_destroy(output);
+        return NULL;
+    }
+    return output;
+}
+
+FbdevOutput* fbdev_output_open(const char* device, bool double_buffer) {
+#ifdef __linux__
+    if (!device) {
+        device = FBDEV_DEFAULT_DEVICE;
+    }
+
+    FbdevOutput* output = calloc(1, sizeof(FbdevOutput));
+    if (!output) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "fbdev_output_open: Failed to allocate %zu bytes", sizeof(FbdevOutput));
+        return NULL;
+    }
+    output->map = MAP_FAILED;
+
+    output->fd = open(device, O_RDWR | O_CLOEXEC);
+    if (output->fd < 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "fbdev_output_open: Could not open %s: %s", device, strerror(errno));
+        free(output);
+        return NULL;
+    }
+
+    struct fb_fix_screeninfo fix;
+    if (ioctl(output->fd, FBIOGET_FSCREENINFO, &fix) < 0 ||
+        ioctl(output->fd, FBIOGET_VSCREENINFO, &output->var) < 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "fbdev_output_open: %s screen info query failed: %s", device, strerror(errno));
+        fbdev_output_destroy(output);
+        return NULL;
+    }
+
+    struct fb_var_screeninfo* var = &output->var;
+    if (fix.type != FB_TYPE_PACKED_PIXELS || fix.visual != FB_VISUAL_TRUECOLOR ||
+        (var->bits_per_pixel != 16 && var->bits_per_pixel != 32)) {
+        pk_set_last_error_with_context(PK_ERROR_DISPLAY_MODE_FAILED,
+            "fbdev_output_open: %s has unsupported layout (type %u, visual %u, %u bpp)",
+            device, fix.type, fix.visual, var->bits_per_pixel);
+        fbdev_output_destroy(output);
+        return NULL;
+    }
+
+    size_t page_size = (size_t)fix.line_length * var->yres;
+    if (fix.smem_len < page_size) {
+        pk_set_last_error_with_context(PK_ERROR_DISPLAY_MODE_FAILED,
+            "fbdev_output_open: %s memory (%u bytes) smaller than one screen (%zu)",
+            device, fix.smem_len, page_size);
+        fbdev_output_destroy(output);
+        return NULL;
+    }
+    int pages = 1;
+    if (double_buffer && var->yres_virtual >= 2 * var->yres && fix.ypanstep != 0 &&
+        fix.smem_len >= 2 * page_size) {
+        pages = 2;
+    }
+
+    output->info = (FbdevInfo){
+        .width = (int)var->xres,
+        .height = (int)var->yres,
+        .bits_per_pixel = (int)var->bits_per_pixel,
+        .line_length = (int)fix.line_length,
+        .pages = pages,
+        .red_mask = ((1u << var->red.length) - 1) << var->red.offset,
+        .green_mask = ((1u << var->green.length) - 1) << var->green.offset,
+        .blue_mask = ((1u << var->blue.length) - 1) << var->blue.offset
+    };
+
+    output->map_size = fix.smem_len;
+    output->map = mmap(NULL, output->map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       output->fd, 0);
+    if (output->map == MAP_FAILED) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "fbdev_output_open: mmap of %zu bytes failed: %s", output->map_size, strerror(errno));
+        fbdev_output_destroy(output);
+        return NULL;
+    }
+
+    if (!output_init_tracking(output)) {
+        fbdev_output_destroy(output);
+        return NULL;
+    }
+
+    /* Start from page 0 with the console unblanked */
+    ioctl(output->fd, FBIOBLANK, FB_BLANK_UNBLANK);
+    if (var->yoffset != 0 || var->xoffset != 0) {
+        var->xoffset = 0;
+        var->yoffset = 0;
+        ioctl(output->fd, FBIOPAN_DISPLAY, var);
+    }
+    output->vsync_supported = true;
+
+    log_info("Framebuffer %s: %dx%d, %d bpp, line %d bytes, %s",
+             device, output->info.width, output->info.height, output->info.bits_per_pixel,
+             output->info.line_length, pages > 1 ? "panning double buffer" : "single buffer");
+    return output;
+#else
+    (void)double_buffer;
+    pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+        "fbdev_output_open: Framebuffer devices are only available on Linux (%s)",
+        device ? device : FBDEV_DEFAULT_DEVICE);
+    return NULL;
+#endif
+}
+
+void fbdev_output_destroy(FbdevOutput* output) {
+    if (!output) {
+        return;
+    }
+
+#ifdef __linux__
+    if (output->fd >= 0) {
+        if (output->map != MAP_FAILED) {
+            munmap(output->map, output->map_size);
+        }
+        close(output->fd);
+    } else {
+        free(output->map);
+    }
+#else
+    free(output->map);
+#endif
+
+    free(output->shadow);
+    for (int p = 0; p < FBDEV_MAX_PAGES; p++) {
+        free(output->dirty[p]);
+    }
+    free(output);
+}
+
+void fbdev_output_get_info(const FbdevOutput* output, FbdevInfo* info) {
+    *info = output->info;
+}
+
+static void output_wait_vsync(FbdevOutput* output) {
+#ifdef __linux__
+    if (output->fd < 0 || !output->vsync_supported) {
+        return;
+    }
+    uint32_t crtc = 0;
+    if (ioctl(output->fd, FBIO_WAITFORVSYNC, &crtc) == 0) {
+        output->stats.vsync_waits++;
+    } else {
+        log_info("Framebuffer driver has no FBIO_WAITFORVSYNC (%s), presenting unpaced",
+                 strerror(errno));
+        output->vsync_supported = false;
+    }
+#else
+    (void)output;
+#endif
+}
+
+/* Make page visible; false if the driver refused to pan */
+static bool output_flip(FbdevOutput* output, int page) {
+#ifdef __linux__
+    if (output->fd >= 0) {
+        output->var.xoffset = 0;
+        output->var.yoffset = (uint32_t)(page * output->info.height);
+        if (ioctl(output->fd, FBIOPAN_DISPLAY, &output->var) < 0) {
+            log_warn("FBIOPAN_DISPLAY failed (%s), falling back to a single buffer",
+                     strerror(errno));
+            return false;
+        }
+    }
+#endif
+    output->front = page;
+    output->stats.pans++;
+    return true;
+}
+
+/* Compare the new frame with the shadow; changed tiles go into the shadow
+ * and are marked missing on every page */
+static bool output_diff(FbdevOutput* output, const uint8_t* pixels, int pitch) {
+    const FbdevInfo* info = &output->info;
+    int bpp = output->bytes_per_pixel;
+    size_t row_bytes = (size_t)info->width * bpp;
+    bool changed = false;
+
+    for (int ty = 0; ty < output->tiles_y; ty++) {
+        int y0 = ty * FBDEV_TILE_H;
+        int rows = info->height - y0 < FBDEV_TILE_H ? info->height - y0 : FBDEV_TILE_H;
+
+        /* Most bands are untouched; whole-row compares skip them quickly */
+        int first = 0;
+        if (output->primed) {
+            while (first < rows &&
+                   memcmp(pixels + (size_t)(y0 + first) * pitch,
+                          output->shadow + (size_t)(y0 + first) * output->shadow_pitch,
+                          row_bytes) == 0) {
+                first++;
+            }
+            if (first == rows) {
+                continue;
+            }
+        }
+
+        for (int tx = 0; tx < output->tiles_x; tx++) {
+            int x0 = tx * FBDEV_TILE_W;
+            int cols = info->width - x0 < FBDEV_TILE_W ? info->width - x0 : FBDEV_TILE_W;
+            size_t offset = (size_t)x0 * bpp;
+            size_t bytes = (size_t)cols * bpp;
+
+            bool differs = !output->primed;
+            for (int y = y0 + first; y < y0 + rows && !differs; y++) {
+                differs = memcmp(pixels + (size_t)y * pitch + offset,
+                                 output->shadow + (size_t)y * output->shadow_pitch + offset,
+                                 bytes) != 0;
+            }
+            if (!differs) {
+                continue;
+            }
+
+            for (int y = y0; y < y0 + rows; y++) {
+                memcpy(output->shadow + (size_t)y * output->shadow_pitch + offset,
+                       pixels + (size_t)y * pitch + offset, bytes);
+            }
+            for (int p = 0; p < FBDEV_MAX_PAGES; p++) {
+                output->dirty[p][ty * output->tiles_x + tx] = 1;
+            }
+            changed = true;
+        }
+    }
+
+    output->primed = true;
+    return changed;
+}
+
+/* Write a page's missing tiles from the shadow, merging runs along a band */
+static void output_copy_dirty(FbdevOutput* output, int page) {
+    const FbdevInfo* info = &output->info;
+    int bpp = output->bytes_per_pixel;
+    uint8_t* base = page_start(output, page);
+    uint8_t* dirty = output->dirty[page];
+
+    for (int ty = 0; ty < output->tiles_y; ty++) {
+        int y0 = ty * FBDEV_TILE_H;
+        int rows = info->height - y0 < FBDEV_TILE_H ? info->height - y0 : FBDEV_TILE_H;
+        uint8_t* band = dirty + ty * output->tiles_x;
+
+        for (int tx = 0; tx < output->tiles_x; tx++) {
+            if (!band[tx]) {
+                continue;
+            }
+            int run_end = tx;
+            while (run_end + 1 < output->tiles_x && band[run_end + 1]) {
+                run_end++;
+            }
+
+            int x0 = tx * FBDEV_TILE_W;
+            int x1 = (run_end + 1) * FBDEV_TILE_W;
+            if (x1 > info->width) {
+                x1 = info->width;
+            }
+            size_t offset = (size_t)x0 * bpp;
+            size_t bytes = (size_t)(x1 - x0) * bpp;
+            for (int y = y0; y < y0 + rows; y++) {
+                memcpy(base + (size_t)y * info->line_length + offset,
+                       output->shadow + (size_t)y * output->shadow_pitch + offset, bytes);
+            }
+            memset(band + tx, 0, (size_t)(run_end - tx + 1));
+            output->stats.rects_copied++;
+            output->stats.bytes_copied += bytes * (size_t)rows;
+            tx = run_end;
+        }
+    }
+}
+
+static bool page_has_dirty(const FbdevOutput* output, int page) {
+    size_t tiles = (size_t)output->tiles_x * output->tiles_y;
+    for (size_t i = 0; i < tiles; i++) {
+        if (output->dirty[page][i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool fbdev_output_present(FbdevOutput* output, const void* pixels, int pitch, bool wait_vsync) {
+    if (!output || !pixels) {
+        return false;
+    }
+
+    uint64_t start = monotonic_us();
+    output->stats.frames++;
+
+    bool changed = output_diff(output, pixels, pitch);
+    bool flipping = output->info.pages > 1;
+    int target = flipping ? (output->front + 1) % output->info.pages : output->front;
+
+    /* A back page may still be missing the previous frame's changes */
+    if (!changed && !page_has_dirty(output, target)) {
+        output->stats.frames_unchanged++;
+        output->stats.last_present_us = (uint32_t)(monotonic_us() - start);
+        return false;
+    }
+
+    if (!flipping) {
+        /* Single buffer: start writing right after scanout passes vblank */
+        if (wait_vsync) {
+            output_wait_vsync(output);
+        }
+        output_copy_dirty(output, target);
+    } else {
+        output_copy_dirty(output, target);
+        if (!output_flip(output, target)) {
+            /* Keep writing the page that is on screen, all of it once */
+            output->info.pages = 1;
+            fbdev_output_invalidate(output);
+            output_copy_dirty(output, output->front);
+        } else if (wait_vsync) {
+            /* The old front page is written next; wait until it is off screen */
+            output_wait_vsync(output);
+        }
+    }
+
+    output->stats.last_present_us = (uint32_t)(monotonic_us() - start);
+    return true;
+}
+
+void fbdev_output_invalidate(FbdevOutput* output) {
+    size_t tiles = (size_t)output->tiles_x * output->tiles_y;
+    for (int p = 0; p < FBDEV_MAX_PAGES; p++) {
+        memset(output->dirty[p], 1, tiles);
+    }
+}
+
+const void* fbdev_output_front(const FbdevOutput* output, int* pitch) {
+    if (pitch) {
+        *pitch = output->info.line_length;
+    }
+    return page_start(output, output->front);
+}
+
+void fbdev_output_get_stats(const FbdevOutput* output, FbdevStats* stats) {
+    *stats = output->stats;
+}
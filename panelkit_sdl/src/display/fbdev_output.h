@@ -0,0 +1,138 @@
+/**
+ * @file fbdev_output.h
+ * @brief Legacy Linux framebuffer (/dev/fbN) output with damage-only copies
+ *
+ * Maps the framebuffer and copies rendered frames into it. Framebuffer
+ * memory is usually uncached, so writes are expensive and reads worse:
+ * each presented frame is compared in tiles against a system-memory copy
+ * of the previous one, and only changed tiles are written.
+ *
+ * When the virtual resolution holds two screens and the driver can pan,
+ * frames go to the off-screen page and FBIOPAN_DISPLAY flips to it; each
+ * page remembers which tiles it is missing, so a tile changed once is
+ * written to both pages but never again while it stays the same.
+ * FBIO_WAITFORVSYNC paces presents where the driver supports it.
+ *
+ * Without a device (fbdev_output_create_memory) the same code runs against
+ * plain memory pages, for benchmarks and tests.
+ *
+ * Nothing here depends on SDL; backend_fbdev.c renders with SDL's software
+ * renderer into a surface of the framebuffer's format and hands the pixels
+ * over.
+ */
+
+#ifndef PANELKIT_FBDEV_OUTPUT_H
+#define PANELKIT_FBDEV_OUTPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Pages used for panned double buffering */
+#define FBDEV_MAX_PAGES 2
+
+/** Opaque framebuffer output handle */
+typedef struct FbdevOutput FbdevOutput;
+
+/**
+ * Framebuffer geometry and pixel layout.
+ */
+typedef struct {
+    int width;                  /**< Visible width in pixels */
+    int height;                 /**< Visible height in pixels */
+    int bits_per_pixel;         /**< 16 or 32 */
+    int line_length;            /**< Framebuffer bytes per row */
+    int pages;                  /**< 2 when panning double buffering is used */
+    uint32_t red_mask;          /**< Channel masks within a pixel */
+    uint32_t green_mask;
+    uint32_t blue_mask;
+} FbdevInfo;
+
+/**
+ * Framebuffer output statistics.
+ */
+typedef struct {
+    uint64_t frames;            /**< Presents */
+    uint64_t frames_unchanged;  /**< Presents that wrote nothing */
+    uint64_t rects_copied;      /**< Rectangles written to the framebuffer */
+    uint64_t bytes_copied;      /**< Bytes written to the framebuffer */
+    uint64_t pans;              /**< Page flips */
+    uint64_t vsync_waits;       /**< Successful FBIO_WAITFORVSYNC calls */
+    uint32_t last_present_us;   /**< Diff + copy + flip time of the last present */
+} FbdevStats;
+
+/**
+ * Open and map a framebuffer device.
+ *
+ * @param device Device path (NULL for /dev/fb0)
+ * @param double_buffer Use panning when the virtual resolution allows it
+ * @return New output or NULL on error (error context set)
+ * @note Only 16 and 32 bits per pixel are supported
+ */
+FbdevOutput* fbdev_output_open(const char* device, bool double_buffer);
+
+/**
+ * Create an output backed by plain memory instead of a device.
+ *
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param bits_per_pixel 16 (RGB565) or 32 (XRGB8888)
+ * @param pages 1 or 2
+ * @return New output or NULL on error (error context set)
+ */
+FbdevOutput* fbdev_output_create_memory(int width, int height, int bits_per_pixel, int pages);
+
+/**
+ * Unmap and close the framebuffer.
+ *
+ * @param output Output to destroy (can be NULL)
+ */
+void fbdev_output_destroy(FbdevOutput* output);
+
+/**
+ * Get framebuffer geometry and pixel layout.
+ *
+ * @param output Framebuffer output (required)
+ * @param info Output information (required)
+ */
+void fbdev_output_get_info(const FbdevOutput* output, FbdevInfo* info);
+
+/**
+ * Show a frame, writing only the tiles that changed.
+ *
+ * @param output Framebuffer output (required)
+ * @param pixels Frame in the framebuffer's pixel format (width x height)
+ * @param pitch Bytes per row of pixels
+ * @param wait_vsync Pace with FBIO_WAITFORVSYNC (ignored if unsupported)
+ * @return true if anything was written
+ */
+bool fbdev_output_present(FbdevOutput* output, const void* pixels, int pitch, bool wait_vsync);
+
+/**
+ * Rewrite every tile on the next present (e.g. after a console switch).
+ *
+ * @param output Framebuffer output (required)
+ */
+void fbdev_output_invalidate(FbdevOutput* output);
+
+/**
+ * Get the visible page.
+ *
+ * @param output Framebuffer output (required)
+ * @param pitch Output: bytes per row (can be NULL)
+ * @return Start of the page currently scanned out
+ */
+const void* fbdev_output_front(const FbdevOutput* output, int* pitch);
+
+/**
+ * Get output statistics.
+ *
+ * @param output Framebuffer output (required)
+ * @param stats Output statistics (required)
+ */
+void fbdev_output_get_stats(const FbdevOutput* output, FbdevStats* stats);
+
+/**
+ * @note Thread Safety: Not thread-safe; use from the presenting thread.
+ */
+
+#endif /* PANELKIT_FBDEV_OUTPUT_H */
@@ -0,0 +1,280 @@
+/**
+ * @file frame_scheduler.c
+ * @brief Vsync-aligned, late-latched frame pacing implementation
+ */
+
+#include "frame_scheduler.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#define NS_PER_US 1000ull
+#define NS_PER_SEC 1000000000ull
+
+/* Period estimator smoothing: new = old + (sample - old) / 16 */
+#define PERIOD_SMOOTHING_SHIFT 4
+
+/* Ignore vblank deltas spanning more than this many refreshes */
+#define MAX_PERIOD_MULTIPLE 8
+
+struct FrameScheduler {
+    FrameSchedulerConfig config;
+
+    /* Clock (CLOCK_MONOTONIC unless replaced) */
+    frame_scheduler_now_func now;
+    frame_scheduler_sleep_func sleep_until;
+    void* clock_user_data;
+
+    /* Refresh timing */
+    uint64_t period_ns;
+    uint64_t last_vblank_ns;        /* Most recent known vblank (0 = none yet) */
+
+    /* Current frame */
+    uint64_t frame_start_ns;
+    uint64_t submit_ns;             /* Render work finished, present issued */
+    uint64_t target_vblank_ns;      /* Vblank the current frame is aiming for */
+
+    /* Render cost history (ring buffer) */
+    uint64_t cost_history[FRAME_SCHEDULER_MAX_HISTORY];
+    int history_count;
+    int history_index;
+
+    FrameSchedulerStats stats;
+};
+
+uint64_t frame_scheduler_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t monotonic_now(void* user_data) {
+    (void)user_data;
+    return frame_scheduler_now_ns();
+}
+
+/* Sleep until an absolute CLOCK_MONOTONIC deadline */
+static void sleep_until_ns(uint64_t deadline_ns, void* user_data) {
+    (void)user_data;
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline_ns / NS_PER_SEC),
+        .tv_nsec = (long)(deadline_ns % NS_PER_SEC)
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        /* Retry on signal */
+    }
+}
+
+/* Predicted cost is the worst of recent frames: starting late is only
+ * worth it if it does not cost a missed vblank */
+static uint64_t predict_cost_ns(const FrameScheduler* scheduler) {
+    if (scheduler->history_count == 0) {
+        return scheduler->period_ns / 2;
+    }
+
+    uint64_t worst = 0;
+    for (int i = 0; i < scheduler->history_count; i++) {
+        if (scheduler->cost_history[i] > worst) {
+            worst = scheduler->cost_history[i];
+        }
+    }
+    return worst;
+}
+
+/* First vblank at or after `t`, extrapolated from the last known one */
+static uint64_t vblank_at_or_after(const FrameScheduler* scheduler, uint64_t t) {
+    uint64_t base = scheduler->last_vblank_ns;
+    if (t <= base) {
+        return base;
+    }
+    uint64_t periods = (t - base + scheduler->period_ns - 1) / scheduler->period_ns;
+    return base + periods * scheduler->period_ns;
+}
+
+FrameSchedulerConfig frame_scheduler_default_config(void) {
+    FrameSchedulerConfig config = {
+        .late_latch = true,
+        .target_fps = 60,
+        .safety_margin_us = 2000,
+        .history_frames = 16
+    };
+    return config;
+}
+
+FrameScheduler* frame_scheduler_create(const FrameSchedulerConfig* config) {
+    FrameScheduler* scheduler = calloc(1, sizeof(FrameScheduler));
+    if (!scheduler) {
+        log_error("Failed to allocate frame scheduler");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "frame_scheduler_create: Failed to allocate %zu bytes", sizeof(FrameScheduler));
+        return NULL;
+    }
+
+    scheduler->config = config ? *config : frame_scheduler_default_config();
+    frame_scheduler_set_clock(scheduler, NULL, NULL, NULL);
+
+    if (scheduler->config.target_fps <= 0) {
+        scheduler->config.target_fps = 60;
+    }
+    if (scheduler->config.history_frames < 1 ||
+        scheduler->config.history_frames > FRAME_SCHEDULER_MAX_HISTORY) {
+        scheduler->config.history_frames = 16;
+    }
+    if (scheduler->config.safety_margin_us < 0) {
+        scheduler->config.safety_margin_us = 0;
+    }
+
+    scheduler->period_ns = NS_PER_SEC / (uint64_t)scheduler->config.target_fps;
+    scheduler->stats.refresh_period_us = (uint32_t)(scheduler->period_ns / NS_PER_US);
+
+    log_info("Frame scheduler: %s, %d Hz, margin %dus, history %d frames",
+             scheduler->config.late_latch ? "late-latch" : "fixed cadence",
+             scheduler->config.target_fps,
+             scheduler->config.safety_margin_us,
+             scheduler->config.history_frames);
+    return scheduler;
+}
+
+void frame_scheduler_destroy(FrameScheduler* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    log_info("Frame scheduler: %llu frames, %llu missed deadlines, period %uus",
+             (unsigned long long)scheduler->stats.frames,
+             (unsigned long long)scheduler->stats.missed_deadlines,
+             scheduler->stats.refresh_period_us);
+    free(scheduler);
+}
+
+void frame_scheduler_set_clock(FrameScheduler* scheduler,
+                               frame_scheduler_now_func now,
+                               frame_scheduler_sleep_func sleep_until,
+                               void* user_data) {
+    if (!scheduler) {
+        return;
+    }
+
+    scheduler->now = now ? now : monotonic_now;
+    scheduler->sleep_until = sleep_until ? sleep_until : sleep_until_ns;
+    scheduler->clock_user_data = user_data;
+}
+
+void frame_scheduler_wait(FrameScheduler* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    uint64_t now = scheduler->now(scheduler->clock_user_data);
+
+    /* Fixed cadence (legacy behaviour) until we have a vblank reference */
+    if (!scheduler->config.late_latch || scheduler->last_vblank_ns == 0) {
+        scheduler->target_vblank_ns = 0;
+        if (scheduler->frame_start_ns) {
+            uint64_t next_start = scheduler->frame_start_ns + scheduler->period_ns;
+            if (next_start > now) {
+                scheduler->sleep_until(next_start, scheduler->clock_user_data);
+            }
+        }
+        return;
+    }
+
+    uint64_t budget = predict_cost_ns(scheduler) +
+                      (uint64_t)scheduler->config.safety_margin_us * NS_PER_US;
+
+    /* Aim for the earliest vblank we can still make, but never the one
+     * the previous frame already targeted */
+    uint64_t target = vblank_at_or_after(scheduler, now + budget);
+    if (target <= scheduler->last_vblank_ns) {
+        target = scheduler->last_vblank_ns + scheduler->period_ns;
+    }
+
+    scheduler->target_vblank_ns = target;
+    scheduler->stats.predicted_cost_us = (uint32_t)(budget / NS_PER_US);
+
+    if (target - budget > now) {
+        scheduler->sleep_until(target - budget, scheduler->clock_user_data);
+    }
+}
+
+void frame_scheduler_begin_frame(FrameScheduler* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    scheduler->frame_start_ns = scheduler->now(scheduler->clock_user_data);
+    scheduler->submit_ns = 0;
+}
+
+void frame_scheduler_mark_submit(FrameScheduler* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    scheduler->submit_ns = scheduler->now(scheduler->clock_user_data);
+}
+
+void frame_scheduler_end_frame(FrameScheduler* scheduler, uint64_t vblank_ns) {
+    if (!scheduler || scheduler->frame_start_ns == 0) {
+        return;
+    }
+
+    uint64_t now = scheduler->now(scheduler->clock_user_data);
+
+    /* Render cost. Without a backend vblank timestamp we assume present
+     * blocked on vsync, so its completion marks the vblank and the wait
+     * inside present must not count as work. With a timestamp the present
+     * call is CPU work (e.g. DRM buffer copy) and is included. */
+    uint64_t cost = now - scheduler->frame_start_ns;
+    uint64_t shown_at = now;
+
+    if (vblank_ns != 0) {
+        /* Update refresh period from consecutive vblank timestamps */
+        if (scheduler->stats.vblank_measured && vblank_ns > scheduler->last_vblank_ns) {
+            uint64_t delta = vblank_ns - scheduler->last_vblank_ns;
+            uint64_t multiple = (delta + scheduler->period_ns / 2) / scheduler->period_ns;
+            if (multiple >= 1 && multiple <= MAX_PERIOD_MULTIPLE) {
+                int64_t sample = (int64_t)(delta / multiple);
+                int64_t error = sample - (int64_t)scheduler->period_ns;
+                scheduler->period_ns = (uint64_t)((int64_t)scheduler->period_ns +
+                                                  error / (1 << PERIOD_SMOOTHING_SHIFT));
+            }
+        }
+        scheduler->last_vblank_ns = vblank_ns;
+        scheduler->stats.vblank_measured = true;
+        shown_at = vblank_at_or_after(scheduler, now);
+    } else {
+        if (scheduler->submit_ns != 0) {
+            cost = scheduler->submit_ns - scheduler->frame_start_ns;
+        }
+        scheduler->last_vblank_ns = now;
+    }
+
+    /* Record cost history */
+    scheduler->cost_history[scheduler->history_index] = cost;
+    scheduler->history_index = (scheduler->history_index + 1) % scheduler->config.history_frames;
+    if (scheduler->history_count < scheduler->config.history_frames) {
+        scheduler->history_count++;
+    }
+
+    /* Deadline accounting */
+    if (scheduler->target_vblank_ns &&
+        shown_at > scheduler->target_vblank_ns + scheduler->period_ns / 2) {
+        scheduler->stats.missed_deadlines++;
+        log_debug("Frame missed vblank by %lluus (cost %lluus)",
+                  (unsigned long long)((shown_at - scheduler->target_vblank_ns) / NS_PER_US),
+                  (unsigned long long)(cost / NS_PER_US));
+    }
+
+    scheduler->stats.frames++;
+    scheduler->stats.last_cost_us = (uint32_t)(cost / NS_PER_US);
+    scheduler->stats.last_latency_us = (uint32_t)((shown_at - scheduler->frame_start_ns) / NS_PER_US);
+    scheduler->stats.refresh_period_us = (uint32_t)(scheduler->period_ns / NS_PER_US);
+}
+
+const FrameSchedulerStats* frame_scheduler_get_stats(const FrameScheduler* scheduler) {
+    return scheduler ? &scheduler->stats : NULL;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file frame_scheduler.h
+ * @brief Vsync-aligned, late-latched frame pacing
+ *
+ * Replaces the fixed "render, then sleep the rest of 16ms" loop. The
+ * scheduler tracks when frames actually reach the display (vblank or
+ * present timestamps), predicts how long the next frame will take from
+ * recent history, and holds the frame start back until just before the
+ * deadline. Input that arrives during the wait is therefore processed in
+ * the frame that displays it instead of one frame later.
+ *
+ * Typical loop:
+ * @code
+ *   frame_scheduler_wait(sched);          // sleep until planned start
+ *   frame_scheduler_begin_frame(sched);
+ *   ... poll events, update, record display list ...
+ *   render_pipeline_submit(pipeline);     // marks submit before present
+ *   uint64_t vblank_ns = 0;
+ *   display_backend_get_vblank_time(backend, &vblank_ns);
+ *   frame_scheduler_end_frame(sched, vblank_ns);
+ * @endcode
+ */
+
+#ifndef PANELKIT_FRAME_SCHEDULER_H
+#define PANELKIT_FRAME_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Opaque frame scheduler handle */
+typedef struct FrameScheduler FrameScheduler;
+
+/** Reads the scheduler's clock in nanoseconds */
+typedef uint64_t (*frame_scheduler_now_func)(void* user_data);
+
+/** Sleeps until an absolute time on the scheduler's clock */
+typedef void (*frame_scheduler_sleep_func)(uint64_t deadline_ns, void* user_data);
+
+/** Maximum render cost history length */
+#define FRAME_SCHEDULER_MAX_HISTORY 64
+
+/**
+ * Frame scheduler configuration.
+ */
+typedef struct {
+    bool late_latch;            /**< Start frames late (false = fixed cadence) */
+    int target_fps;             /**< Refresh rate assumed until measured */
+    int safety_margin_us;       /**< Slack added to the predicted render cost */
+    int history_frames;         /**< Frames of render cost history (1-64) */
+} FrameSchedulerConfig;
+
+/**
+ * Frame pacing statistics.
+ */
+typedef struct {
+    uint64_t frames;            /**< Frames completed */
+    uint64_t missed_deadlines;  /**< Frames presented after their target vblank */
+    uint32_t refresh_period_us; /**< Measured (or assumed) refresh period */
+    uint32_t predicted_cost_us; /**< Current render cost prediction */
+    uint32_t last_cost_us;      /**< Measured cost of the last frame */
+    uint32_t last_latency_us;   /**< Frame start to photon for the last frame */
+    bool vblank_measured;       /**< True once real vblank timestamps were seen */
+} FrameSchedulerStats;
+
+/**
+ * Get default scheduler configuration.
+ *
+ * @return Configuration with late latching enabled at 60 Hz
+ */
+FrameSchedulerConfig frame_scheduler_default_config(void);
+
+/**
+ * Create a frame scheduler.
+ *
+ * @param config Scheduler configuration (NULL for defaults)
+ * @return New scheduler or NULL on error (caller owns)
+ */
+FrameScheduler* frame_scheduler_create(const FrameSchedulerConfig* config);
+
+/**
+ * Destroy a frame scheduler.
+ *
+ * @param scheduler Scheduler to destroy (can be NULL)
+ */
+void frame_scheduler_destroy(FrameScheduler* scheduler);
+
+/**
+ * Sleep until the planned start of the next frame.
+ *
+ * @param scheduler Frame scheduler (required)
+ * @note With late latching this is next_vblank - predicted_cost - margin;
+ *       otherwise one period after the previous frame start
+ */
+void frame_scheduler_wait(FrameScheduler* scheduler);
+
+/**
+ * Mark the start of frame work (input latch point).
+ *
+ * @param scheduler Frame scheduler (required)
+ */
+void frame_scheduler_begin_frame(FrameScheduler* scheduler);
+
+/**
+ * Mark the end of render work, immediately before presenting.
+ *
+ * @param scheduler Frame scheduler (required)
+ * @note Only used when the backend has no vblank timestamp: a vsync-blocking
+ *       present would otherwise be counted as render cost
+ */
+void frame_scheduler_mark_submit(FrameScheduler* scheduler);
+
+/**
+ * Mark the frame as presented and feed timing back into the predictor.
+ *
+ * @param scheduler Frame scheduler (required)
+ * @param vblank_ns CLOCK_MONOTONIC timestamp of the vblank the frame was
+ *                  shown at, or 0 if unknown (present completion time is used)
+ */
+void frame_scheduler_end_frame(FrameScheduler* scheduler, uint64_t vblank_ns);
+
+/**
+ * Get frame pacing statistics.
+ *
+ * @param scheduler Frame scheduler (required)
+ * @return Read-only statistics (owned by scheduler, never NULL for valid input)
+ */
+const FrameSchedulerStats* frame_scheduler_get_stats(const FrameScheduler* scheduler);
+
+/**
+ * Replace the scheduler's clock, e.g. with a synthetic one in tests.
+ *
+ * @param scheduler Frame scheduler (required)
+ * @param now Clock read (NULL restores CLOCK_MONOTONIC)
+ * @param sleep_until Absolute sleep on the same clock (NULL restores
+ *                    clock_nanosleep)
+ * @param user_data Passed to both callbacks
+ * @note vblank timestamps given to end_frame must come from the same clock
+ */
+void frame_scheduler_set_clock(FrameScheduler* scheduler,
+                               frame_scheduler_now_func now,
+                               frame_scheduler_sleep_func sleep_until,
+                               void* user_data);
+
+/**
+ * Get the current CLOCK_MONOTONIC time in nanoseconds.
+ *
+ * @return Monotonic timestamp, same clock as DRM vblank events
+ */
+uint64_t frame_scheduler_now_ns(void);
+
+/**
+ * @note Thread Safety: A scheduler must only be used from the thread
+ *       that drives the render loop.
+ */
+
+#endif /* PANELKIT_FRAME_SCHEDULER_H */
@@ -0,0 +1,392 @@
+/**
+ * @file panel_server.c
+ * @brief Worker pool rasterizing offscreen panels from display lists
+ */
+
+#include "panel_server.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include "../core/realtime.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PANEL_SERVER_MAX_WORKERS 64
+
+typedef struct {
+    SDL_Surface* surface;
+    SDL_Renderer* renderer;             /* Used by one worker at a time */
+    DisplayListTextureCache* cache;     /* Likewise */
+    DisplayList* lists[2];
+    int back;                           /* Caller thread only */
+    RfbServer* mirror;                  /* Changed only between batches */
+} Panel;
+
+struct PanelServer {
+    PanelServerConfig config;
+    Uint32 sdl_format;
+    int bits_per_pixel;
+
+    /* Panels; the array only changes between batches */
+    Panel** panels;
+    int panel_count;
+    int panel_capacity;
+
+    /* Worker pool */
+    pthread_t threads[PANEL_SERVER_MAX_WORKERS];
+    int worker_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;           /* Workers: a new batch was kicked */
+    pthread_cond_t done_cond;           /* Caller: the last worker checked in */
+    uint64_t batch;                     /* Guarded by mutex, bumped per kick */
+    int batch_panels;                   /* Guarded by mutex, panels in the batch */
+    int active;                         /* Guarded by mutex, workers still busy */
+    bool running;                       /* Guarded by mutex */
+    atomic_int next_panel;              /* Work index shared by the workers */
+
+    /* Caller thread */
+    bool in_flight;
+    uint64_t last_submit_ns;
+
+    /* Statistics (guarded by mutex) */
+    PanelServerStats stats;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Replay a panel's front list and hand the pixels to its viewer */
+static void rasterize_panel(Panel* panel) {
+    SDL_Renderer* renderer = panel->renderer;
+    const DisplayList* list = panel->lists[panel->back ^ 1];
+
+    if (display_list_execute(list, renderer, panel->cache) != PK_OK) {
+        log_error("Panel display list execution failed: %s", pk_get_last_error_context());
+    }
+
+    void* pixels;
+    int pitch;
+    if (rfb_server_begin_capture(panel->mirror, &pixels, &pitch)) {
+        SDL_Rect rect = { 0, 0, pitch / 4, panel->surface->h };
+        bool captured = SDL_RenderReadPixels(renderer, &rect, SDL_PIXELFORMAT_ARGB8888,
+                                             pixels, pitch) == 0;
+        rfb_server_end_capture(panel->mirror, captured);
+    }
+
+    SDL_RenderPresent(renderer);
+}
+
+static void* worker_main(void* arg) {
+    PanelServer* server = arg;
+    uint64_t seen = 0;
+
+    realtime_enter(REALTIME_ROLE_RENDER);
+
+    pthread_mutex_lock(&server->mutex);
+    while (server->running) {
+        if (server->batch == seen) {
+            pthread_cond_wait(&server->work_cond, &server->mutex);
+            continue;
+        }
+        seen = server->batch;
+        int count = server->batch_panels;
+        pthread_mutex_unlock(&server->mutex);
+
+        /* Pull panels until the batch is drained */
+        uint64_t start = monotonic_ns();
+        int done = 0;
+        for (;;) {
+            int index = atomic_fetch_add(&server->next_panel, 1);
+            if (index >= count) {
+                break;
+            }
+            rasterize_panel(server->panels[index]);
+            done++;
+        }
+        uint64_t elapsed = monotonic_ns() - start;
+
+        pthread_mutex_lock(&server->mutex);
+        server->stats.panel_frames += (uint64_t)done;
+        server->stats.raster_ns += elapsed;
+        if (--server->active == 0) {
+            pthread_cond_signal(&server->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&server->mutex);
+
+    return NULL;
+}
+
+static void panel_destroy(Panel* panel) {
+    if (!panel) {
+        return;
+    }
+
+    /* Cache holds textures for the renderer; drop before it */
+    display_list_texture_cache_destroy(panel->cache);
+    if (panel->renderer) {
+        SDL_DestroyRenderer(panel->renderer);
+    }
+    SDL_FreeSurface(panel->surface);
+    display_list_destroy(panel->lists[0]);
+    display_list_destroy(panel->lists[1]);
+    free(panel);
+}
+
+PanelServerConfig panel_server_default_config(void) {
+    PanelServerConfig config = {
+        .workers = 0,
+        .pixel_format = DISPLAY_PIXEL_FORMAT_XRGB8888,
+        .dither = false
+    };
+    return config;
+}
+
+PanelServer* panel_server_create(const PanelServerConfig* config) {
+    PanelServer* server = calloc(1, sizeof(PanelServer));
+    if (!server) {
+        log_error("Failed to allocate panel server");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "panel_server_create: Failed to allocate %zu bytes", sizeof(PanelServer));
+        return NULL;
+    }
+
+    server->config = config ? *config : panel_server_default_config();
+    if (server->config.pixel_format == DISPLAY_PIXEL_FORMAT_RGB565) {
+        server->sdl_format = SDL_PIXELFORMAT_RGB565;
+        server->bits_per_pixel = 16;
+    } else {
+        server->sdl_format = SDL_PIXELFORMAT_RGB888;
+        server->bits_per_pixel = 32;
+    }
+
+    int workers = server->config.workers;
+    if (workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (int)cpus : 1;
+    }
+    if (workers > PANEL_SERVER_MAX_WORKERS) {
+        workers = PANEL_SERVER_MAX_WORKERS;
+    }
+
+    pthread_mutex_init(&server->mutex, NULL);
+    pthread_cond_init(&server->work_cond, NULL);
+    pthread_cond_init(&server->done_cond, NULL);
+    atomic_init(&server->next_panel, 0);
+    server->running = true;
+
+    for (int i = 0; i < workers; i++) {
+        int rc = pthread_create(&server->threads[i], NULL, worker_main, server);
+        if (rc != 0) {
+            log_error("Failed to create panel worker %d: %s", i, strerror(rc));
+            break;
+        }
+        server->worker_count++;
+    }
+    if (server->worker_count == 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "panel_server_create: No worker thread could be started");
+        panel_server_destroy(server);
+        return NULL;
+    }
+    server->stats.workers = server->worker_count;
+
+    log_info("Panel server started (%d worker%s, %s)", server->worker_count,
+             server->worker_count == 1 ? "" : "s",
+             display_pixel_format_name(server->config.pixel_format));
+    return server;
+}
+
+void panel_server_destroy(PanelServer* server) {
+    if (!server) {
+        return;
+    }
+
+    panel_server_finish(server);
+
+    pthread_mutex_lock(&server->mutex);
+    server->running = false;
+    pthread_cond_broadcast(&server->work_cond);
+    pthread_mutex_unlock(&server->mutex);
+    for (int i = 0; i < server->worker_count; i++) {
+        pthread_join(server->threads[i], NULL);
+    }
+
+    if (server->stats.frames > 0) {
+        log_info("Panel server: %llu batches, %llu panel frames",
+                 (unsigned long long)server->stats.frames,
+                 (unsigned long long)server->stats.panel_frames);
+    }
+
+    for (int i = 0; i < server->panel_count; i++) {
+        panel_destroy(server->panels[i]);
+    }
+    free(server->panels);
+
+    pthread_mutex_destroy(&server->mutex);
+    pthread_cond_destroy(&server->work_cond);
+    pthread_cond_destroy(&server->done_cond);
+    free(server);
+}
+
+int panel_server_add_panel(PanelServer* server, int width, int height) {
+    if (!server || width <= 0 || height <= 0) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "panel_server_add_panel: server=%p size=%dx%d", (void*)server, width, height);
+        return -1;
+    }
+
+    panel_server_finish(server);
+
+    if (server->panel_count == server->panel_capacity) {
+        int capacity = server->panel_capacity ? server->panel_capacity * 2 : 8;
+        Panel** panels = realloc(server->panels, (size_t)capacity * sizeof(Panel*));
+        if (!panels) {
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                "panel_server_add_panel: Failed to grow to %d panels", capacity);
+            return -1;
+        }
+        server->panels = panels;
+        server->panel_capacity = capacity;
+    }
+
+    Panel* panel = calloc(1, sizeof(Panel));
+    if (!panel) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "panel_server_add_panel: Failed to allocate %zu bytes", sizeof(Panel));
+        return -1;
+    }
+
+    panel->surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, server->bits_per_pixel,
+                                                    server->sdl_format);
+    if (!panel->surface) {
+        LOG_SDL_ERROR("Failed to create panel surface");
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "panel_server_add_panel: %dx%d surface failed: %s", width, height, SDL_GetError());
+        panel_destroy(panel);
+        return -1;
+    }
+
+    panel->renderer = SDL_CreateSoftwareRenderer(panel->surface);
+    if (!panel->renderer) {
+        LOG_SDL_ERROR("Failed to create panel renderer");
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "panel_server_add_panel: Software renderer failed: %s", SDL_GetError());
+        panel_destroy(panel);
+        return -1;
+    }
+
+    panel->cache = display_list_texture_cache_create();
+    panel->lists[0] = display_list_create(0);
+    panel->lists[1] = display_list_create(0);
+    if (!panel->cache || !panel->lists[0] || !panel->lists[1]) {
+        /* Error context already set by the failing create */
+        panel_destroy(panel);
+        return -1;
+    }
+    display_list_texture_cache_set_format(panel->cache, server->sdl_format,
+                                          server->config.dither);
+
+    server->panels[server->panel_count] = panel;
+    pthread_mutex_lock(&server->mutex);
+    server->stats.panels = server->panel_count + 1;
+    pthread_mutex_unlock(&server->mutex);
+    return server->panel_count++;
+}
+
+SDL_Renderer* panel_server_get_renderer(PanelServer* server, int panel) {
+    if (!server || panel < 0 || panel >= server->panel_count) {
+        return NULL;
+    }
+    return server->panels[panel]->renderer;
+}
+
+void panel_server_set_mirror(PanelServer* server, int panel, RfbServer* mirror) {
+    if (!server || panel < 0 || panel >= server->panel_count) {
+        return;
+    }
+
+    panel_server_finish(server);
+    server->panels[panel]->mirror = mirror;
+}
+
+DisplayList* panel_server_begin_frame(PanelServer* server, int panel) {
+    if (!server || panel < 0 || panel >= server->panel_count) {
+        return NULL;
+    }
+
+    /* The back list is never part of the batch in flight */
+    Panel* p = server->panels[panel];
+    DisplayList* list = p->lists[p->back];
+    display_list_reset(list);
+    return list;
+}
+
+void panel_server_submit(PanelServer* server) {
+    if (!server) {
+        return;
+    }
+
+    uint64_t start = monotonic_ns();
+    panel_server_finish(server);
+    uint64_t waited = monotonic_ns() - start;
+
+    /* Recorded lists become the front; the fronts just drawn are recycled */
+    for (int i = 0; i < server->panel_count; i++) {
+        server->panels[i]->back ^= 1;
+    }
+
+    pthread_mutex_lock(&server->mutex);
+    if (server->last_submit_ns) {
+        server->stats.record_ns += start - server->last_submit_ns;
+    }
+    server->stats.wait_ns += waited;
+    server->stats.frames++;
+    if (server->panel_count > 0) {
+        atomic_store(&server->next_panel, 0);
+        server->batch_panels = server->panel_count;
+        server->active = server->worker_count;
+        server->batch++;
+        server->in_flight = true;
+        pthread_cond_broadcast(&server->work_cond);
+    }
+    pthread_mutex_unlock(&server->mutex);
+
+    server->last_submit_ns = monotonic_ns();
+}
+
+void panel_server_finish(PanelServer* server) {
+    if (!server || !server->in_flight) {
+        return;
+    }
+
+    pthread_mutex_lock(&server->mutex);
+    while (server->active > 0) {
+        pthread_cond_wait(&server->done_cond, &server->mutex);
+    }
+    pthread_mutex_unlock(&server->mutex);
+    server->in_flight = false;
+}
+
+SDL_Surface* panel_server_get_surface(PanelServer* server, int panel) {
+    if (!server || panel < 0 || panel >= server->panel_count) {
+        return NULL;
+    }
+    return server->panels[panel]->surface;
+}
+
+void panel_server_get_stats(PanelServer* server, PanelServerStats* stats) {
+    if (!server || !stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&server->mutex);
+    *stats = server->stats;
+    pthread_mutex_unlock(&server->mutex);
+}
@@ -0,0 +1,161 @@
+/**
+ * @file panel_server.h
+ * @brief Offscreen rendering of many panels on a pool of worker threads
+ *
+ * A headless host serves many virtual panels from one process, each seen
+ * only through a remote viewer (or not at all). Every panel renders into
+ * a system-memory surface with its own SDL software renderer and texture
+ * cache, so panels share no render state and can be rasterized in
+ * parallel.
+ *
+ * Each panel has two display lists. The caller records the back list of
+ * every panel and submits; submit waits for the previous batch, swaps the
+ * lists and hands the batch to the workers, which pull panels from a
+ * shared index until none are left. Recording the next frame on the
+ * caller's thread therefore overlaps with rasterizing the last one.
+ *
+ * Recording stays on one thread because SDL_ttf and the widget tree are
+ * not thread-safe; rasterizing is where the pixels are touched and what
+ * the pool spreads across cores. Surfaces recorded into several panels'
+ * lists (skin atlas, shared images) are only read while rasterizing.
+ */
+
+#ifndef PANELKIT_PANEL_SERVER_H
+#define PANELKIT_PANEL_SERVER_H
+
+#include "display_list.h"
+#include "pixel_format.h"
+#include "rfb_server.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Opaque panel server handle */
+typedef struct PanelServer PanelServer;
+
+/**
+ * Panel server configuration.
+ */
+typedef struct {
+    int workers;                    /**< Rasterizing threads (0 = one per online CPU) */
+    DisplayPixelFormat pixel_format; /**< Format of every panel surface */
+    bool dither;                    /**< Dither opaque images when RGB565 */
+} PanelServerConfig;
+
+/**
+ * Panel server statistics.
+ */
+typedef struct {
+    uint64_t frames;                /**< Batches submitted */
+    uint64_t panel_frames;          /**< Panels rasterized, summed over batches */
+    uint64_t record_ns;             /**< Caller time between submits (recording) */
+    uint64_t wait_ns;               /**< Caller time blocked on the previous batch */
+    uint64_t raster_ns;             /**< Worker time rasterizing, summed over workers */
+    int workers;                    /**< Worker threads running */
+    int panels;                     /**< Panels added */
+} PanelServerStats;
+
+/**
+ * Get the default configuration (one worker per CPU, XRGB8888).
+ *
+ * @return Default configuration
+ */
+PanelServerConfig panel_server_default_config(void);
+
+/**
+ * Create a panel server and start its workers.
+ *
+ * @param config Configuration (NULL for defaults)
+ * @return New server or NULL on error (caller owns, error context set)
+ */
+PanelServer* panel_server_create(const PanelServerConfig* config);
+
+/**
+ * Wait for the batch in flight, stop the workers and free every panel.
+ *
+ * @param server Server to destroy (can be NULL)
+ */
+void panel_server_destroy(PanelServer* server);
+
+/**
+ * Add a panel.
+ *
+ * @param server Panel server (required)
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @return Panel index, or -1 on error (error context set)
+ * @note Waits for the batch in flight first
+ */
+int panel_server_add_panel(PanelServer* server, int width, int height);
+
+/**
+ * Get a panel's renderer, e.g. for widgets that query output size.
+ *
+ * @param server Panel server (required)
+ * @param panel Panel index
+ * @return Renderer (owned by the server), or NULL for a bad index
+ * @note Draw through display lists only; the renderer belongs to whichever
+ *       worker rasterizes the panel
+ */
+SDL_Renderer* panel_server_get_renderer(PanelServer* server, int panel);
+
+/**
+ * Attach a remote screen server that the panel's frames are captured for.
+ *
+ * @param server Panel server (required)
+ * @param panel Panel index
+ * @param mirror RFB server sized like the panel (borrowed), or NULL
+ * @note Waits for the batch in flight first; destroy the RFB server after
+ *       detaching it or destroying the panel server
+ */
+void panel_server_set_mirror(PanelServer* server, int panel, RfbServer* mirror);
+
+/**
+ * Get an empty display list to record the panel's next frame into.
+ *
+ * @param server Panel server (required)
+ * @param panel Panel index
+ * @return Back list (owned by the server, valid until submit), or NULL
+ */
+DisplayList* panel_server_begin_frame(PanelServer* server, int panel);
+
+/**
+ * Rasterize every panel's recorded frame on the worker pool.
+ *
+ * @param server Panel server (required)
+ * @note Blocks only while the previous batch is still being rasterized.
+ *       Panels whose list was not begun since the last submit render an
+ *       empty list.
+ */
+void panel_server_submit(PanelServer* server);
+
+/**
+ * Wait until the batch in flight has been rasterized.
+ *
+ * @param server Panel server (required)
+ */
+void panel_server_finish(PanelServer* server);
+
+/**
+ * Get the surface a panel renders into.
+ *
+ * @param server Panel server (required)
+ * @param panel Panel index
+ * @return Surface (owned by the server), or NULL for a bad index
+ * @note Pixels are only stable after panel_server_finish()
+ */
+SDL_Surface* panel_server_get_surface(PanelServer* server, int panel);
+
+/**
+ * Get server statistics.
+ *
+ * @param server Panel server (required)
+ * @param stats Output statistics snapshot (required)
+ */
+void panel_server_get_stats(PanelServer* server, PanelServerStats* stats);
+
+/**
+ * @note Thread Safety: Everything except get_stats must be called from one
+ *       thread. get_stats may be called from any thread.
+ */
+
+#endif /* PANELKIT_PANEL_SERVER_H */
@@ -0,0 +1,107 @@
+/**
+ * @file pixel_format.c
+ * @brief Framebuffer pixel formats and 32-to-16-bit conversion
+ */
+
+#include "pixel_format.h"
+#include <pthread.h>
+#include <string.h>
+
+/* 4x4 Bayer matrix, thresholds 0-15 */
+static const uint8_t bayer4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+const char* display_pixel_format_name(DisplayPixelFormat format) {
+    switch (format) {
+        case DISPLAY_PIXEL_FORMAT_RGB565:
+            return "rgb565";
+        case DISPLAY_PIXEL_FORMAT_XRGB8888:
+        default:
+            return "xrgb8888";
+    }
+}
+
+bool display_pixel_format_parse(const char* name, DisplayPixelFormat* format) {
+    if (strcmp(name, "xrgb8888") == 0) {
+        *format = DISPLAY_PIXEL_FORMAT_XRGB8888;
+        return true;
+    }
+    if (strcmp(name, "rgb565") == 0) {
+        *format = DISPLAY_PIXEL_FORMAT_RGB565;
+        return true;
+    }
+    return false;
+}
+
+int display_pixel_format_bytes(DisplayPixelFormat format) {
+    return format == DISPLAY_PIXEL_FORMAT_RGB565 ? 2 : 4;
+}
+
+static inline uint16_t pack_rgb565(uint32_t p) {
+    return (uint16_t)(((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F));
+}
+
+/* Quantized channel value for each (threshold, 8-bit input) pair. Levels
+ * are placed where scanout expands them (bit replication, q<<3 | q>>2 for
+ * 5 bits), so inputs that land exactly on a level never dither and the
+ * average over a 4x4 block tracks the input */
+static uint8_t dither5[16][256];
+static uint8_t dither6[16][256];
+static pthread_once_t dither_once = PTHREAD_ONCE_INIT;
+
+static void build_dither_table(uint8_t table[16][256], int bits) {
+    int max = (1 << bits) - 1;
+    for (int v = 0; v < 256; v++) {
+        int q = v >> (8 - bits);
+        int lo = q << (8 - bits) | q >> (2 * bits - 8);
+        if (lo > v) {
+            q--;
+            lo = q << (8 - bits) | q >> (2 * bits - 8);
+        }
+        int frac = 0;
+        if (q < max) {
+            int hi = (q + 1) << (8 - bits) | (q + 1) >> (2 * bits - 8);
+            frac = ((v - lo) * 32 + (hi - lo)) / (2 * (hi - lo));   /* Rounded 0-16 */
+        }
+        for (int t = 0; t < 16; t++) {
+            table[t][v] = (uint8_t)(q + (frac > t));
+        }
+    }
+}
+
+static void build_dither_tables(void) {
+    build_dither_table(dither5, 5);
+    build_dither_table(dither6, 6);
+}
+
+void pixel_convert_rgb565(const void* src, int src_pitch, void* dst, int dst_pitch,
+                          int width, int height, bool dither) {
+    if (dither) {
+        pthread_once(&dither_once, build_dither_tables);
+    }
+
+    for (int y = 0; y < height; y++) {
+        const uint32_t* in = (const uint32_t*)((const uint8_t*)src + (size_t)y * src_pitch);
+        uint16_t* out = (uint16_t*)((uint8_t*)dst + (size_t)y * dst_pitch);
+
+        if (!dither) {
+            for (int x = 0; x < width; x++) {
+                out[x] = pack_rgb565(in[x]);
+            }
+            continue;
+        }
+
+        const uint8_t* row = bayer4[y & 3];
+        for (int x = 0; x < width; x++) {
+            uint32_t p = in[x];
+            int t = row[x & 3];
+            out[x] = (uint16_t)(dither5[t][(p >> 16) & 0xFF] << 11 |
+                                dither6[t][(p >> 8) & 0xFF] << 5 |
+                                dither5[t][p & 0xFF]);
+        }
+    }
+}
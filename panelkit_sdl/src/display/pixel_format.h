@@ -0,0 +1,78 @@
+/**
+ * @file pixel_format.h
+ * @brief Framebuffer pixel formats and 32-to-16-bit conversion
+ *
+ * Panels on SPI and parallel-RGB buses are often 16-bit. Rendering them
+ * in RGB565 end to end (render target, cached textures, scanout buffer)
+ * halves the memory traffic of every fill, blit and present.
+ *
+ * Solid fills and alpha-blended content (text, skins) are quantized by the
+ * software renderer as they are drawn. Opaque images (photos, map tiles,
+ * baked gradients) are converted once when cached, optionally with a 4x4
+ * ordered dither so smooth gradients do not band.
+ *
+ * Nothing here depends on SDL; the display backend maps these formats to
+ * SDL_PIXELFORMAT_* values.
+ */
+
+#ifndef PANELKIT_PIXEL_FORMAT_H
+#define PANELKIT_PIXEL_FORMAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Render target and scanout pixel format.
+ */
+typedef enum {
+    DISPLAY_PIXEL_FORMAT_XRGB8888,  /**< 32-bit, 8 bits per channel */
+    DISPLAY_PIXEL_FORMAT_RGB565     /**< 16-bit, 5/6/5 bits per channel */
+} DisplayPixelFormat;
+
+/**
+ * Get the configuration name of a pixel format.
+ *
+ * @param format Pixel format
+ * @return "xrgb8888" or "rgb565" (never NULL)
+ */
+const char* display_pixel_format_name(DisplayPixelFormat format);
+
+/**
+ * Parse a configuration name ("xrgb8888", "rgb565").
+ *
+ * @param name Format name (required)
+ * @param format Output pixel format (required)
+ * @return true if the name was recognised
+ */
+bool display_pixel_format_parse(const char* name, DisplayPixelFormat* format);
+
+/**
+ * Get the storage size of one pixel.
+ *
+ * @param format Pixel format
+ * @return 4 or 2
+ */
+int display_pixel_format_bytes(DisplayPixelFormat format);
+
+/**
+ * Convert a rectangle of XRGB8888 pixels to RGB565.
+ *
+ * Without dithering each channel is truncated, matching what the software
+ * renderer does for fills and blits. With dithering each channel rounds up
+ * to the next 16-bit level when its position between levels exceeds a 4x4
+ * Bayer threshold, so colours that are exactly representable stay flat and
+ * gradients break up into a fine regular pattern instead of bands.
+ *
+ * @param src Source pixels (alpha ignored)
+ * @param src_pitch Source bytes per row
+ * @param dst Destination pixels
+ * @param dst_pitch Destination bytes per row
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param dither Apply ordered dithering
+ * @note The dither pattern is anchored to the rectangle's top-left corner
+ */
+void pixel_convert_rgb565(const void* src, int src_pitch, void* dst, int dst_pitch,
+                          int width, int height, bool dither);
+
+#endif /* PANELKIT_PIXEL_FORMAT_H */
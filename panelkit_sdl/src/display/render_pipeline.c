@@ -0,0 +1,267 @@
+/**
+ * @file render_pipeline.c
+ * @brief Triple-buffered display list handoff to a render thread
+ */
+
+#include "render_pipeline.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include "../core/realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define PIPELINE_BUFFER_COUNT 3
+
+struct RenderPipeline {
+    DisplayBackend* backend;
+    FrameScheduler* scheduler;          /* Update thread only (synchronous mode) */
+    DisplayListTextureCache* cache;     /* Render thread only */
+    RfbServer* mirror;                  /* Guarded by mutex; read by the rendering thread */
+
+    /* Triple buffer: indices into lists[] */
+    DisplayList* lists[PIPELINE_BUFFER_COUNT];
+    int back;                           /* Update thread only */
+    int ready;                          /* Guarded by mutex */
+    int front;                          /* Render thread only */
+    bool ready_fresh;                   /* Guarded by mutex */
+
+    /* Render thread */
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool threaded;
+    bool running;                       /* Guarded by mutex */
+
+    /* Statistics (guarded by mutex) */
+    RenderPipelineStats stats;
+};
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+/* Replay a list and present it; runs on whichever thread owns the renderer */
+static uint32_t render_and_present(RenderPipeline* pipeline, const DisplayList* list,
+                                   RfbServer* mirror) {
+    uint64_t start = monotonic_us();
+
+    if (display_list_execute(list, pipeline->backend->renderer, pipeline->cache) != PK_OK) {
+        log_error("Display list execution failed: %s", pk_get_last_error_context());
+    }
+
+    /* Read back before present: GPU back buffers are undefined afterwards */
+    void* pixels;
+    int pitch;
+    if (rfb_server_begin_capture(mirror, &pixels, &pitch)) {
+        SDL_Rect rect = { 0, 0, pitch / 4, pipeline->backend->actual_height };
+        bool captured = SDL_RenderReadPixels(pipeline->backend->renderer, &rect,
+                                             SDL_PIXELFORMAT_ARGB8888, pixels, pitch) == 0;
+        rfb_server_end_capture(mirror, captured);
+    }
+
+    /* Present may block on vsync; keep that wait out of the render cost */
+    if (!pipeline->threaded) {
+        frame_scheduler_mark_submit(pipeline->scheduler);
+    }
+    SDL_RenderPresent(pipeline->backend->renderer);
+    display_backend_present(pipeline->backend);
+
+    return (uint32_t)(monotonic_us() - start);
+}
+
+static void* render_thread_main(void* arg) {
+    RenderPipeline* pipeline = arg;
+
+    realtime_enter(REALTIME_ROLE_RENDER);
+    log_info("Render thread started");
+
+    pthread_mutex_lock(&pipeline->mutex);
+    while (pipeline->running) {
+        if (!pipeline->ready_fresh) {
+            pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+            continue;
+        }
+
+        /* Take the newest frame; hand our old front back for reuse */
+        int taken = pipeline->ready;
+        pipeline->ready = pipeline->front;
+        pipeline->front = taken;
+        pipeline->ready_fresh = false;
+        RfbServer* mirror = pipeline->mirror;
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        uint32_t render_us = render_and_present(pipeline, pipeline->lists[pipeline->front],
+                                                mirror);
+
+        pthread_mutex_lock(&pipeline->mutex);
+        pipeline->stats.frames_presented++;
+        pipeline->stats.last_render_us = render_us;
+    }
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    log_info("Render thread stopped");
+    return NULL;
+}
+
+RenderPipeline* render_pipeline_create(DisplayBackend* backend, FrameScheduler* scheduler,
+                                       bool threaded) {
+    if (!backend || !backend->renderer) {
+        log_error("Render pipeline requires a backend with a renderer");
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+            "render_pipeline_create: backend=%p", (void*)backend);
+        return NULL;
+    }
+
+    RenderPipeline* pipeline = calloc(1, sizeof(RenderPipeline));
+    if (!pipeline) {
+        log_error("Failed to allocate render pipeline");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "render_pipeline_create: Failed to allocate %zu bytes", sizeof(RenderPipeline));
+        return NULL;
+    }
+
+    pthread_mutex_init(&pipeline->mutex, NULL);
+    pthread_cond_init(&pipeline->cond, NULL);
+
+    pipeline->backend = backend;
+    pipeline->scheduler = scheduler;
+    pipeline->back = 0;
+    pipeline->ready = 1;
+    pipeline->front = 2;
+
+    for (int i = 0; i < PIPELINE_BUFFER_COUNT; i++) {
+        pipeline->lists[i] = display_list_create(0);
+        if (!pipeline->lists[i]) {
+            /* Error context already set by display_list_create */
+            render_pipeline_destroy(pipeline);
+            return NULL;
+        }
+    }
+
+    pipeline->cache = display_list_texture_cache_create();
+    if (!pipeline->cache) {
+        render_pipeline_destroy(pipeline);
+        return NULL;
+    }
+    display_list_texture_cache_set_format(pipeline->cache, backend->render_format,
+                                          backend->dither);
+
+    if (threaded && !backend->render_thread_safe) {
+        log_info("Backend %s renderer is bound to the main thread, rendering synchronously",
+                 backend->name);
+        threaded = false;
+    }
+
+    if (threaded) {
+        pipeline->running = true;
+        pipeline->threaded = true;
+        int rc = pthread_create(&pipeline->thread, NULL, render_thread_main, pipeline);
+        if (rc != 0) {
+            log_error("Failed to create render thread (%s), rendering synchronously",
+                      strerror(rc));
+            pipeline->running = false;
+            pipeline->threaded = false;
+            threaded = false;
+        }
+    }
+
+    pthread_mutex_lock(&pipeline->mutex);
+    pipeline->stats.threaded = threaded;
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    log_info("Render pipeline created (%s, %d display lists)",
+             threaded ? "render thread" : "synchronous", PIPELINE_BUFFER_COUNT);
+    return pipeline;
+}
+
+void render_pipeline_destroy(RenderPipeline* pipeline) {
+    if (!pipeline) {
+        return;
+    }
+
+    if (pipeline->threaded) {
+        pthread_mutex_lock(&pipeline->mutex);
+        pipeline->running = false;
+        pthread_cond_signal(&pipeline->cond);
+        pthread_mutex_unlock(&pipeline->mutex);
+        pthread_join(pipeline->thread, NULL);
+
+        log_info("Render pipeline: %llu submitted, %llu presented, %llu dropped",
+                 (unsigned long long)pipeline->stats.frames_submitted,
+                 (unsigned long long)pipeline->stats.frames_presented,
+                 (unsigned long long)pipeline->stats.frames_dropped);
+    }
+
+    /* Cache holds textures for the backend renderer; drop before lists */
+    display_list_texture_cache_destroy(pipeline->cache);
+    for (int i = 0; i < PIPELINE_BUFFER_COUNT; i++) {
+        display_list_destroy(pipeline->lists[i]);
+    }
+
+    pthread_mutex_destroy(&pipeline->mutex);
+    pthread_cond_destroy(&pipeline->cond);
+    free(pipeline);
+}
+
+DisplayList* render_pipeline_begin_frame(RenderPipeline* pipeline) {
+    if (!pipeline) {
+        return NULL;
+    }
+
+    DisplayList* list = pipeline->lists[pipeline->back];
+    display_list_reset(list);
+    return list;
+}
+
+void render_pipeline_submit(RenderPipeline* pipeline) {
+    if (!pipeline) {
+        return;
+    }
+
+    if (!pipeline->threaded) {
+        uint32_t render_us = render_and_present(pipeline, pipeline->lists[pipeline->back],
+                                                pipeline->mirror);
+        pipeline->stats.frames_submitted++;
+        pipeline->stats.frames_presented++;
+        pipeline->stats.last_render_us = render_us;
+        return;
+    }
+
+    /* Publish back as the ready frame; whatever was ready becomes our back */
+    pthread_mutex_lock(&pipeline->mutex);
+    int published = pipeline->back;
+    pipeline->back = pipeline->ready;
+    pipeline->ready = published;
+    if (pipeline->ready_fresh) {
+        pipeline->stats.frames_dropped++;
+    }
+    pipeline->ready_fresh = true;
+    pipeline->stats.frames_submitted++;
+    pthread_cond_signal(&pipeline->cond);
+    pthread_mutex_unlock(&pipeline->mutex);
+}
+
+void render_pipeline_set_mirror(RenderPipeline* pipeline, RfbServer* mirror) {
+    if (!pipeline) {
+        return;
+    }
+
+    /* The render thread picks the pointer up with its next frame */
+    pthread_mutex_lock(&pipeline->mutex);
+    pipeline->mirror = mirror;
+    pthread_mutex_unlock(&pipeline->mutex);
+}
+
+void render_pipeline_get_stats(RenderPipeline* pipeline, RenderPipelineStats* stats) {
+    if (!pipeline || !stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&pipeline->mutex);
+    *stats = pipeline->stats;
+    pthread_mutex_unlock(&pipeline->mutex);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file render_pipeline.h
+ * @brief Update/render thread split with triple-buffered display lists
+ *
+ * The update thread records each frame into a DisplayList and submits it.
+ * A render thread replays the newest submitted list onto the backend
+ * renderer and presents it, so a slow present (e.g. the SDL+DRM buffer
+ * copy) overlaps with input handling and update of the next frame.
+ *
+ * Three lists rotate between the roles back (being recorded), ready
+ * (newest complete frame) and front (being rendered). Submitting never
+ * blocks: if the render thread has not picked up the previous frame it is
+ * replaced by the newer one and counted as dropped.
+ *
+ * Backends whose renderer is bound to the creating thread (windowed SDL
+ * with a GPU renderer) run the same path synchronously on the caller's
+ * thread instead.
+ */
+
+#ifndef PANELKIT_RENDER_PIPELINE_H
+#define PANELKIT_RENDER_PIPELINE_H
+
+#include "display_backend.h"
+#include "display_list.h"
+#include "frame_scheduler.h"
+#include "rfb_server.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Opaque render pipeline handle */
+typedef struct RenderPipeline RenderPipeline;
+
+/**
+ * Render pipeline statistics.
+ */
+typedef struct {
+    uint64_t frames_submitted;  /**< Lists submitted by the update thread */
+    uint64_t frames_presented;  /**< Lists executed and presented */
+    uint64_t frames_dropped;    /**< Lists replaced before being presented */
+    uint32_t last_render_us;    /**< Execute + present time of the last frame */
+    bool threaded;              /**< True if a render thread is running */
+} RenderPipelineStats;
+
+/**
+ * Create a render pipeline for a display backend.
+ *
+ * @param backend Display backend to present to (required, borrowed)
+ * @param scheduler Frame scheduler to mark before a blocking present in
+ *                  synchronous mode (can be NULL, borrowed)
+ * @param threaded Request a dedicated render thread
+ * @return New pipeline or NULL on error (caller owns)
+ * @note Falls back to synchronous rendering if the backend's renderer
+ *       cannot be used from another thread
+ */
+RenderPipeline* render_pipeline_create(DisplayBackend* backend, FrameScheduler* scheduler,
+                                       bool threaded);
+
+/**
+ * Stop the render thread and destroy the pipeline.
+ *
+ * @param pipeline Pipeline to destroy (can be NULL)
+ */
+void render_pipeline_destroy(RenderPipeline* pipeline);
+
+/**
+ * Get an empty display list to record the next frame into.
+ *
+ * @param pipeline Render pipeline (required)
+ * @return Back buffer list (owned by pipeline, valid until submit)
+ */
+DisplayList* render_pipeline_begin_frame(RenderPipeline* pipeline);
+
+/**
+ * Publish the recorded frame for rendering.
+ *
+ * @param pipeline Render pipeline (required)
+ * @note Never blocks in threaded mode; renders and presents inline otherwise
+ */
+void render_pipeline_submit(RenderPipeline* pipeline);
+
+/**
+ * Attach a remote screen server that frames are captured for.
+ *
+ * @param pipeline Render pipeline (required)
+ * @param mirror RFB server (borrowed), or NULL to detach
+ * @note Captures happen on the rendering thread between execute and
+ *       present, only while the server asks for a frame. A frame already
+ *       in flight may still use a detached server, so destroy the server
+ *       after render_pipeline_destroy().
+ */
+void render_pipeline_set_mirror(RenderPipeline* pipeline, RfbServer* mirror);
+
+/**
+ * Get pipeline statistics.
+ *
+ * @param pipeline Render pipeline (required)
+ * @param stats Output statistics snapshot (required)
+ */
+void render_pipeline_get_stats(RenderPipeline* pipeline, RenderPipelineStats* stats);
+
+/**
+ * @note Thread Safety: begin_frame/submit must be called from a single
+ *       update thread. get_stats may be called from any thread.
+ */
+
+#endif /* PANELKIT_RENDER_PIPELINE_H */
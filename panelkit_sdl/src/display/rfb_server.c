@@ -0,0 +1,1363 @@
+/**
+ * @file rfb_server.c
+ * @brief RFB 3.3/3.7/3.8 server with tile damage detection and ZRLE encoding
+ */
+
+#include "rfb_server.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include "../core/realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define RFB_TILE 64                     /* Damage grid and ZRLE tile size */
+#define RFB_ENCODING_RAW 0
+#define RFB_ENCODING_ZRLE 16
+#define RFB_IDLE_AFTER 8                /* Unchanged captures before idle_fps */
+#define RFB_HANDSHAKE_TIMEOUT_MS 5000
+#define RFB_SEND_TIMEOUT_MS 5000
+#define RFB_INPUT_BUFFER 4096
+#define RFB_MAX_ENCODINGS ((RFB_INPUT_BUFFER - 4) / 4)
+#define RFB_ZRLE_MAX_PALETTE 127
+
+/* Frame slots: render thread fills CAPTURE and swaps it with PENDING;
+ * the server thread swaps PENDING into WORK and WORK into SENT */
+enum { SLOT_CAPTURE, SLOT_PENDING, SLOT_WORK, SLOT_SENT, SLOT_COUNT };
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} RfbBuffer;
+
+typedef struct {
+    uint8_t bits_per_pixel;
+    uint8_t depth;
+    bool big_endian;
+    bool true_colour;
+    uint16_t red_max, green_max, blue_max;
+    uint8_t red_shift, green_shift, blue_shift;
+} RfbPixelFormat;
+
+typedef struct {
+    int x, y, w, h;
+} RfbRect;
+
+struct RfbServer {
+    RfbServerConfig config;
+    char bind_address[64];
+    char desktop_name[64];
+    int width;
+    int height;
+
+    int listen_fd;
+    int wake_pipe[2];
+    int port;
+    pthread_t thread;
+    bool thread_started;
+    atomic_bool running;
+
+    /* Frame handoff */
+    uint32_t* frames[SLOT_COUNT];
+    int slot[SLOT_COUNT];               /* CAPTURE: render thread, PENDING: mutex,
+                                         * WORK/SENT: server thread */
+    bool pending_fresh;                 /* Guarded by mutex */
+    atomic_bool want_frame;             /* Set by server thread, cleared by render thread */
+    uint64_t capture_start_ns;          /* Render thread only */
+    pthread_mutex_t mutex;
+
+    /* Session state (server thread only) */
+    int client_fd;
+    RfbPixelFormat format;
+    uint32_t red_table[256];
+    uint32_t green_table[256];
+    uint32_t blue_table[256];
+    int bytes_per_pixel;
+    int cpixel_bytes;
+    int cpixel_offset;                  /* First byte of the CPIXEL within PIXEL */
+    bool zrle;
+    bool update_requested;
+    bool full_requested;                /* Non-incremental request outstanding */
+    RfbRect request;
+    bool sent_valid;                    /* SENT holds what the viewer shows */
+    bool capture_requested;
+    uint64_t next_capture_ns;
+    int unchanged_streak;
+    uint8_t buttons;
+    int pointer_x;
+    int pointer_y;
+    uint8_t input[RFB_INPUT_BUFFER];
+    size_t input_len;
+    size_t input_skip;                  /* Cut text bytes still to discard */
+
+    /* Encoder scratch (server thread only) */
+    uint8_t* dirty;
+    int tiles_x;
+    int tiles_y;
+    RfbRect* rects;
+    int rect_capacity;
+    uint32_t tile_pixels[RFB_TILE * RFB_TILE];
+    RfbBuffer out;
+    RfbBuffer tile_data;
+#ifdef HAVE_ZLIB
+    z_stream zstream;
+    bool zstream_ready;
+#endif
+
+    /* Statistics (guarded by mutex) */
+    RfbServerStats stats;
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Output buffer
+
+static bool buffer_reserve(RfbBuffer* buffer, size_t extra) {
+    if (buffer->failed) {
+        return false;
+    }
+    if (buffer->size + extra <= buffer->capacity) {
+        return true;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 16384;
+    while (capacity < buffer->size + extra) {
+        capacity *= 2;
+    }
+    uint8_t* data = realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static void buffer_put(RfbBuffer* buffer, const void* data, size_t size) {
+    if (buffer_reserve(buffer, size)) {
+        memcpy(buffer->data + buffer->size, data, size);
+        buffer->size += size;
+    }
+}
+
+static void buffer_u8(RfbBuffer* buffer, uint8_t value) {
+    buffer_put(buffer, &value, 1);
+}
+
+static void buffer_u16(RfbBuffer* buffer, uint16_t value) {
+    uint8_t bytes[2] = { (uint8_t)(value >> 8), (uint8_t)value };
+    buffer_put(buffer, bytes, 2);
+}
+
+static void buffer_u32(RfbBuffer* buffer, uint32_t value) {
+    uint8_t bytes[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16),
+                         (uint8_t)(value >> 8), (uint8_t)value };
+    buffer_put(buffer, bytes, 4);
+}
+
+static uint16_t read_u16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t read_u32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Socket helpers
+
+static bool send_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/* Blocking read of exactly size bytes (handshake only; SO_RCVTIMEO bounds it) */
+static bool recv_all(int fd, uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = recv(fd, data, size, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static void set_socket_timeouts(int fd, int recv_ms, int send_ms) {
+    struct timeval tv = { recv_ms / 1000, (recv_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    tv = (struct timeval){ send_ms / 1000, (send_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+// Pixel formats
+
+static const RfbPixelFormat k_native_format = {
+    .bits_per_pixel = 32, .depth = 24, .big_endian = false, .true_colour = true,
+    .red_max = 255, .green_max = 255, .blue_max = 255,
+    .red_shift = 16, .green_shift = 8, .blue_shift = 0
+};
+
+static void format_encode(const RfbPixelFormat* format, uint8_t out[16]) {
+    memset(out, 0, 16);
+    out[0] = format->bits_per_pixel;
+    out[1] = format->depth;
+    out[2] = format->big_endian;
+    out[3] = format->true_colour;
+    out[4] = (uint8_t)(format->red_max >> 8);
+    out[5] = (uint8_t)format->red_max;
+    out[6] = (uint8_t)(format->green_max >> 8);
+    out[7] = (uint8_t)format->green_max;
+    out[8] = (uint8_t)(format->blue_max >> 8);
+    out[9] = (uint8_t)format->blue_max;
+    out[10] = format->red_shift;
+    out[11] = format->green_shift;
+    out[12] = format->blue_shift;
+}
+
+static RfbPixelFormat format_decode(const uint8_t* in) {
+    RfbPixelFormat format = {
+        .bits_per_pixel = in[0], .depth = in[1],
+        .big_endian = in[2] != 0, .true_colour = in[3] != 0,
+        .red_max = read_u16(in + 4), .green_max = read_u16(in + 6),
+        .blue_max = read_u16(in + 8),
+        .red_shift = in[10], .green_shift = in[11], .blue_shift = in[12]
+    };
+    return format;
+}
+
+static bool format_supported(const RfbPixelFormat* format) {
+    int bpp = format->bits_per_pixel;
+    return format->true_colour && (bpp == 8 || bpp == 16 || bpp == 32) &&
+           format->red_shift < bpp && format->green_shift < bpp && format->blue_shift < bpp;
+}
+
+/* Lookup tables from 8-bit channels to the viewer's pixel values, plus the
+ * ZRLE compact pixel layout (3 bytes when the colour bits allow it) */
+static void apply_format(RfbServer* server, const RfbPixelFormat* format) {
+    server->format = *format;
+    for (int i = 0; i < 256; i++) {
+        server->red_table[i] = (uint32_t)((i * format->red_max + 127) / 255) << format->red_shift;
+        server->green_table[i] = (uint32_t)((i * format->green_max + 127) / 255) << format->green_shift;
+        server->blue_table[i] = (uint32_t)((i * format->blue_max + 127) / 255) << format->blue_shift;
+    }
+    server->bytes_per_pixel = format->bits_per_pixel / 8;
+    server->cpixel_bytes = server->bytes_per_pixel;
+    server->cpixel_offset = 0;
+
+    if (format->bits_per_pixel == 32 && format->depth <= 24) {
+        uint32_t mask = ((uint32_t)format->red_max << format->red_shift) |
+                        ((uint32_t)format->green_max << format->green_shift) |
+                        ((uint32_t)format->blue_max << format->blue_shift);
+        if ((mask & 0xFF000000u) == 0) {
+            server->cpixel_bytes = 3;
+            server->cpixel_offset = format->big_endian ? 1 : 0;
+        } else if ((mask & 0x000000FFu) == 0) {
+            server->cpixel_bytes = 3;
+            server->cpixel_offset = format->big_endian ? 0 : 1;
+        }
+    }
+}
+
+static inline uint32_t convert_pixel(const RfbServer* server, uint32_t argb) {
+    return server->red_table[(argb >> 16) & 0xFF] |
+           server->green_table[(argb >> 8) & 0xFF] |
+           server->blue_table[argb & 0xFF];
+}
+
+/* Pixel value in the viewer's byte order */
+static inline void pixel_bytes(const RfbServer* server, uint32_t value, uint8_t out[4]) {
+    int n = server->bytes_per_pixel;
+    for (int i = 0; i < n; i++) {
+        int shift = server->format.big_endian ? (n - 1 - i) * 8 : i * 8;
+        out[i] = (uint8_t)(value >> shift);
+    }
+}
+
+static inline void put_cpixel(const RfbServer* server, RfbBuffer* buffer, uint32_t value) {
+    uint8_t bytes[4];
+    pixel_bytes(server, value, bytes);
+    buffer_put(buffer, bytes + server->cpixel_offset, (size_t)server->cpixel_bytes);
+}
+
+// Damage detection
+
+/* Mark 64x64 tiles that differ, then merge them into rectangles: runs of
+ * tiles along a row, extended downwards while the next row has the same run */
+static int compute_damage(RfbServer* server, const uint32_t* current, const uint32_t* previous) {
+    int width = server->width;
+    memset(server->dirty, 0, (size_t)server->tiles_x * (size_t)server->tiles_y);
+
+    for (int y = 0; y < server->height; y++) {
+        const uint32_t* row = current + (size_t)y * (size_t)width;
+        const uint32_t* old = previous + (size_t)y * (size_t)width;
+        if (memcmp(row, old, (size_t)width * 4) == 0) {
+            continue;
+        }
+        uint8_t* dirty_row = server->dirty + (size_t)(y / RFB_TILE) * (size_t)server->tiles_x;
+        for (int tx = 0; tx < server->tiles_x; tx++) {
+            if (dirty_row[tx]) {
+                continue;
+            }
+            int x0 = tx * RFB_TILE;
+            int n = width - x0 < RFB_TILE ? width - x0 : RFB_TILE;
+            if (memcmp(row + x0, old + x0, (size_t)n * 4) != 0) {
+                dirty_row[tx] = 1;
+            }
+        }
+    }
+
+    int count = 0;
+    for (int ty = 0; ty < server->tiles_y; ty++) {
+        int this_row_start = count;
+        const uint8_t* dirty_row = server->dirty + (size_t)ty * (size_t)server->tiles_x;
+        int tx = 0;
+        while (tx < server->tiles_x) {
+            if (!dirty_row[tx]) {
+                tx++;
+                continue;
+            }
+            int start = tx;
+            while (tx < server->tiles_x && dirty_row[tx]) {
+                tx++;
+            }
+            RfbRect rect = { start * RFB_TILE, ty * RFB_TILE,
+                             (tx - start) * RFB_TILE, RFB_TILE };
+            if (rect.x + rect.w > server->width) {
+                rect.w = server->width - rect.x;
+            }
+            if (rect.y + rect.h > server->height) {
+                rect.h = server->height - rect.y;
+            }
+
+            bool merged = false;
+            for (int i = 0; i < this_row_start; i++) {
+                RfbRect* above = &server->rects[i];
+                if (above->x == rect.x && above->w == rect.w && above->y + above->h == rect.y) {
+                    above->h += rect.h;
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                server->rects[count++] = rect;
+            }
+        }
+    }
+    return count;
+}
+
+static bool clip_rect(RfbRect* rect, const RfbRect* clip) {
+    int x0 = rect->x > clip->x ? rect->x : clip->x;
+    int y0 = rect->y > clip->y ? rect->y : clip->y;
+    int x1 = rect->x + rect->w < clip->x + clip->w ? rect->x + rect->w : clip->x + clip->w;
+    int y1 = rect->y + rect->h < clip->y + clip->h ? rect->y + rect->h : clip->y + clip->h;
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+    *rect = (RfbRect){ x0, y0, x1 - x0, y1 - y0 };
+    return true;
+}
+
+// Encoding
+
+static void encode_raw(RfbServer* server, const uint32_t* frame, const RfbRect* rect) {
+    size_t row_bytes = (size_t)rect->w * (size_t)server->bytes_per_pixel;
+    for (int y = rect->y; y < rect->y + rect->h; y++) {
+        if (!buffer_reserve(&server->out, row_bytes)) {
+            return;
+        }
+        const uint32_t* src = frame + (size_t)y * (size_t)server->width + rect->x;
+        uint8_t* dst = server->out.data + server->out.size;
+        for (int x = 0; x < rect->w; x++) {
+            pixel_bytes(server, convert_pixel(server, src[x]), dst);
+            dst += server->bytes_per_pixel;
+        }
+        server->out.size += row_bytes;
+    }
+}
+
+#ifdef HAVE_ZLIB
+
+/* Bytes used by a ZRLE run length */
+static inline size_t run_length_bytes(int run) {
+    return (size_t)(run - 1) / 255 + 1;
+}
+
+static void put_run_length(RfbBuffer* buffer, int run) {
+    run -= 1;
+    while (run >= 255) {
+        buffer_u8(buffer, 255);
+        run -= 255;
+    }
+    buffer_u8(buffer, (uint8_t)run);
+}
+
+static int palette_index(const uint32_t* palette, int count, uint32_t value, int* hint) {
+    if (*hint < count && palette[*hint] == value) {
+        return *hint;
+    }
+    for (int i = 0; i < count; i++) {
+        if (palette[i] == value) {
+            *hint = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Pick the smallest of solid, packed palette, palette RLE, plain RLE and
+ * raw for one tile of already converted pixels */
+static void encode_zrle_tile(RfbServer* server, const uint32_t* px, int w, int h) {
+    RfbBuffer* out = &server->tile_data;
+    int n = w * h;
+    size_t cp = (size_t)server->cpixel_bytes;
+
+    uint32_t palette[RFB_ZRLE_MAX_PALETTE];
+    int colours = 0;
+    bool palette_ok = true;
+    int hint = 0;
+    size_t plain_rle = 0;
+    size_t palette_rle = 0;
+
+    for (int i = 0; i < n;) {
+        uint32_t value = px[i];
+        int run = 1;
+        while (i + run < n && px[i + run] == value) {
+            run++;
+        }
+        plain_rle += cp + run_length_bytes(run);
+        palette_rle += run == 1 ? 1 : 1 + run_length_bytes(run);
+        if (palette_ok && palette_index(palette, colours, value, &hint) < 0) {
+            if (colours == RFB_ZRLE_MAX_PALETTE) {
+                palette_ok = false;
+            } else {
+                hint = colours;
+                palette[colours++] = value;
+            }
+        }
+        i += run;
+    }
+
+    if (palette_ok && colours == 1) {
+        buffer_u8(out, 1);
+        put_cpixel(server, out, palette[0]);
+        return;
+    }
+
+    enum { SUB_RAW, SUB_PACKED, SUB_PALETTE_RLE, SUB_PLAIN_RLE } best = SUB_RAW;
+    size_t best_size = (size_t)n * cp;
+    if (plain_rle < best_size) {
+        best = SUB_PLAIN_RLE;
+        best_size = plain_rle;
+    }
+    int bits = colours <= 2 ? 1 : colours <= 4 ? 2 : 4;
+    if (palette_ok) {
+        size_t packed = (size_t)colours * cp + (size_t)h * (size_t)((w * bits + 7) / 8);
+        if (colours <= 16 && packed < best_size) {
+            best = SUB_PACKED;
+            best_size = packed;
+        }
+        if ((size_t)colours * cp + palette_rle < best_size) {
+            best = SUB_PALETTE_RLE;
+        }
+    }
+
+    switch (best) {
+    case SUB_RAW:
+        buffer_u8(out, 0);
+        for (int i = 0; i < n; i++) {
+            put_cpixel(server, out, px[i]);
+        }
+        break;
+
+    case SUB_PLAIN_RLE:
+        buffer_u8(out, 128);
+        for (int i = 0; i < n;) {
+            int run = 1;
+            while (i + run < n && px[i + run] == px[i]) {
+                run++;
+            }
+            put_cpixel(server, out, px[i]);
+            put_run_length(out, run);
+            i += run;
+        }
+        break;
+
+    case SUB_PACKED:
+        buffer_u8(out, (uint8_t)colours);
+        for (int i = 0; i < colours; i++) {
+            put_cpixel(server, out, palette[i]);
+        }
+        for (int y = 0; y < h; y++) {
+            uint8_t byte = 0;
+            int used = 0;
+            for (int x = 0; x < w; x++) {
+                int index = palette_index(palette, colours, px[y * w + x], &hint);
+                byte = (uint8_t)(byte | (index << (8 - bits - used)));
+                used += bits;
+                if (used == 8) {
+                    buffer_u8(out, byte);
+                    byte = 0;
+                    used = 0;
+                }
+            }
+            if (used > 0) {
+                buffer_u8(out, byte);
+            }
+        }
+        break;
+
+    case SUB_PALETTE_RLE:
+        buffer_u8(out, (uint8_t)(128 + colours));
+        for (int i = 0; i < colours; i++) {
+            put_cpixel(server, out, palette[i]);
+        }
+        for (int i = 0; i < n;) {
+            int run = 1;
+            while (i + run < n && px[i + run] == px[i]) {
+                run++;
+            }
+            int index = palette_index(palette, colours, px[i], &hint);
+            if (run == 1) {
+                buffer_u8(out, (uint8_t)index);
+            } else {
+                buffer_u8(out, (uint8_t)(index | 128));
+                put_run_length(out, run);
+            }
+            i += run;
+        }
+        break;
+    }
+}
+
+/* ZRLE rectangle: tiles left to right, top to bottom, deflated on the
+ * session's single zlib stream and flushed per rectangle */
+static bool encode_zrle(RfbServer* server, const uint32_t* frame, const RfbRect* rect) {
+    server->tile_data.size = 0;
+    for (int ty = rect->y; ty < rect->y + rect->h; ty += RFB_TILE) {
+        int th = rect->y + rect->h - ty < RFB_TILE ? rect->y + rect->h - ty : RFB_TILE;
+        for (int tx = rect->x; tx < rect->x + rect->w; tx += RFB_TILE) {
+            int tw = rect->x + rect->w - tx < RFB_TILE ? rect->x + rect->w - tx : RFB_TILE;
+            for (int y = 0; y < th; y++) {
+                const uint32_t* src = frame + (size_t)(ty + y) * (size_t)server->width + tx;
+                uint32_t* dst = server->tile_pixels + y * tw;
+                for (int x = 0; x < tw; x++) {
+                    dst[x] = convert_pixel(server, src[x]);
+                }
+            }
+            encode_zrle_tile(server, server->tile_pixels, tw, th);
+        }
+    }
+    if (server->tile_data.failed) {
+        return false;
+    }
+
+    size_t length_at = server->out.size;
+    buffer_u32(&server->out, 0);
+    z_stream* z = &server->zstream;
+    z->next_in = server->tile_data.data;
+    z->avail_in = (uInt)server->tile_data.size;
+    do {
+        if (!buffer_reserve(&server->out, 16384)) {
+            return false;
+        }
+        z->next_out = server->out.data + server->out.size;
+        z->avail_out = 16384;
+        if (deflate(z, Z_SYNC_FLUSH) == Z_STREAM_ERROR) {
+            return false;
+        }
+        server->out.size += 16384 - z->avail_out;
+    } while (z->avail_out == 0);
+
+    uint32_t length = (uint32_t)(server->out.size - length_at - 4);
+    uint8_t* p = server->out.data + length_at;
+    p[0] = (uint8_t)(length >> 24);
+    p[1] = (uint8_t)(length >> 16);
+    p[2] = (uint8_t)(length >> 8);
+    p[3] = (uint8_t)length;
+    return true;
+}
+
+#endif /* HAVE_ZLIB */
+
+// Session
+
+static uint64_t capture_interval_ns(const RfbServer* server) {
+    int fps = server->unchanged_streak >= RFB_IDLE_AFTER ?
+        server->config.idle_fps : server->config.max_fps;
+    return 1000000000ull / (uint64_t)(fps > 0 ? fps : 1);
+}
+
+static void end_session(RfbServer* server, const char* reason) {
+    if (server->client_fd < 0) {
+        return;
+    }
+    log_info("Remote viewer disconnected: %s", reason);
+    close(server->client_fd);
+    server->client_fd = -1;
+    server->update_requested = false;
+    server->capture_requested = false;
+    atomic_store(&server->want_frame, false);
+#ifdef HAVE_ZLIB
+    if (server->zstream_ready) {
+        deflateEnd(&server->zstream);
+        server->zstream_ready = false;
+    }
+#endif
+    pthread_mutex_lock(&server->mutex);
+    server->stats.connected = false;
+    pthread_mutex_unlock(&server->mutex);
+}
+
+static bool allocate_frames(RfbServer* server) {
+    if (server->frames[0]) {
+        return true;
+    }
+    size_t frame_bytes = (size_t)server->width * (size_t)server->height * 4;
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        server->frames[i] = calloc(1, frame_bytes);
+        if (!server->frames[i]) {
+            for (int j = 0; j < i; j++) {
+                free(server->frames[j]);
+                server->frames[j] = NULL;
+            }
+            return false;
+        }
+        server->slot[i] = i;
+    }
+    return true;
+}
+
+/* Version, security (None), ClientInit and ServerInit; blocking with timeouts */
+static bool handshake(RfbServer* server, int fd) {
+    static const char k_version[] = "RFB 003.008\n";
+    uint8_t buffer[16];
+
+    if (!send_all(fd, (const uint8_t*)k_version, 12) || !recv_all(fd, buffer, 12)) {
+        return false;
+    }
+    int major = 0;
+    int minor = 0;
+    buffer[12] = '\0';
+    if (sscanf((const char*)buffer, "RFB %3d.%3d", &major, &minor) != 2 || major != 3) {
+        log_warn("Remote viewer sent an unsupported protocol version");
+        return false;
+    }
+
+    if (minor < 7) {
+        /* 3.3: the server picks the security type */
+        uint8_t none[4] = { 0, 0, 0, 1 };
+        if (!send_all(fd, none, 4)) {
+            return false;
+        }
+    } else {
+        uint8_t types[2] = { 1, 1 };
+        uint8_t chosen = 0;
+        if (!send_all(fd, types, 2) || !recv_all(fd, &chosen, 1) || chosen != 1) {
+            return false;
+        }
+        if (minor >= 8) {
+            uint8_t ok[4] = { 0, 0, 0, 0 };
+            if (!send_all(fd, ok, 4)) {
+                return false;
+            }
+        }
+    }
+
+    uint8_t shared = 0;
+    if (!recv_all(fd, &shared, 1)) {
+        return false;
+    }
+
+    RfbBuffer* out = &server->out;
+    out->size = 0;
+    out->failed = false;
+    buffer_u16(out, (uint16_t)server->width);
+    buffer_u16(out, (uint16_t)server->height);
+    uint8_t format[16];
+    format_encode(&k_native_format, format);
+    buffer_put(out, format, 16);
+    size_t name_length = strlen(server->desktop_name);
+    buffer_u32(out, (uint32_t)name_length);
+    buffer_put(out, server->desktop_name, name_length);
+    return !out->failed && send_all(fd, out->data, out->size);
+}
+
+static void accept_viewer(RfbServer* server) {
+    struct sockaddr_in peer;
+    socklen_t peer_length = sizeof(peer);
+    int fd = accept(server->listen_fd, (struct sockaddr*)&peer, &peer_length);
+    if (fd < 0) {
+        return;
+    }
+
+    char address[INET_ADDRSTRLEN] = "?";
+    inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address));
+
+    /* One session at a time: a reconnecting viewer replaces a stale one */
+    if (server->client_fd >= 0) {
+        end_session(server, "replaced by a new connection");
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    set_socket_timeouts(fd, RFB_HANDSHAKE_TIMEOUT_MS, RFB_SEND_TIMEOUT_MS);
+
+    if (!allocate_frames(server)) {
+        log_error("Remote viewer %s refused: out of memory for frame buffers", address);
+        close(fd);
+        return;
+    }
+    if (!handshake(server, fd)) {
+        log_warn("Remote viewer %s: handshake failed", address);
+        close(fd);
+        return;
+    }
+
+#ifdef HAVE_ZLIB
+    memset(&server->zstream, 0, sizeof(server->zstream));
+    server->zstream_ready = deflateInit(&server->zstream, server->config.compression) == Z_OK;
+#endif
+    server->client_fd = fd;
+    apply_format(server, &k_native_format);
+    server->zrle = false;
+    server->update_requested = false;
+    server->full_requested = false;
+    server->sent_valid = false;
+    server->capture_requested = false;
+    server->unchanged_streak = 0;
+    server->next_capture_ns = 0;
+    server->buttons = 0;
+    server->pointer_x = -1;
+    server->pointer_y = -1;
+    server->input_len = 0;
+    server->input_skip = 0;
+
+    pthread_mutex_lock(&server->mutex);
+    server->stats.sessions++;
+    server->stats.connected = true;
+    pthread_mutex_unlock(&server->mutex);
+    log_info("Remote viewer connected from %s (%dx%d)", address, server->width, server->height);
+}
+
+static void emit_input(RfbServer* server, SDL_Event* event) {
+    server->config.on_input(event, server->config.input_user_data);
+    pthread_mutex_lock(&server->mutex);
+    server->stats.input_events++;
+    pthread_mutex_unlock(&server->mutex);
+}
+
+/* RFB button mask to SDL mouse events: bits 0-2 are left/middle/right,
+ * 3-6 are wheel up/down/left/right (sent as press + release) */
+static void handle_pointer(RfbServer* server, uint8_t mask, int x, int y) {
+    if (server->config.view_only || !server->config.on_input) {
+        return;
+    }
+    x = x < server->width ? x : server->width - 1;
+    y = y < server->height ? y : server->height - 1;
+
+    static const uint8_t k_sdl_buttons[3] = { SDL_BUTTON_LEFT, SDL_BUTTON_MIDDLE, SDL_BUTTON_RIGHT };
+    uint32_t state = 0;
+    for (int i = 0; i < 3; i++) {
+        if (server->buttons & (1 << i)) {
+            state |= SDL_BUTTON(k_sdl_buttons[i]);
+        }
+    }
+
+    if (x != server->pointer_x || y != server->pointer_y) {
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        event.type = SDL_MOUSEMOTION;
+        event.motion.state = state;
+        event.motion.x = x;
+        event.motion.y = y;
+        event.motion.xrel = server->pointer_x >= 0 ? x - server->pointer_x : 0;
+        event.motion.yrel = server->pointer_y >= 0 ? y - server->pointer_y : 0;
+        emit_input(server, &event);
+        server->pointer_x = x;
+        server->pointer_y = y;
+    }
+
+    uint8_t changed = (uint8_t)(mask ^ server->buttons);
+    for (int i = 0; i < 3; i++) {
+        if (!(changed & (1 << i))) {
+            continue;
+        }
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        bool down = (mask & (1 << i)) != 0;
+        event.type = down ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+        event.button.button = k_sdl_buttons[i];
+        event.button.state = down ? SDL_PRESSED : SDL_RELEASED;
+        event.button.clicks = 1;
+        event.button.x = x;
+        event.button.y = y;
+        emit_input(server, &event);
+    }
+
+    static const int k_wheel[4][2] = { { 0, 1 }, { 0, -1 }, { -1, 0 }, { 1, 0 } };
+    for (int i = 0; i < 4; i++) {
+        uint8_t bit = (uint8_t)(1 << (3 + i));
+        if ((mask & bit) && !(server->buttons & bit)) {
+            SDL_Event event;
+            memset(&event, 0, sizeof(event));
+            event.type = SDL_MOUSEWHEEL;
+            event.wheel.x = k_wheel[i][0];
+            event.wheel.y = k_wheel[i][1];
+            event.wheel.direction = SDL_MOUSEWHEEL_NORMAL;
+            emit_input(server, &event);
+        }
+    }
+    server->buttons = mask;
+
+    /* Input usually changes the screen: leave the idle rate right away */
+    if (server->unchanged_streak >= RFB_IDLE_AFTER) {
+        server->unchanged_streak = 0;
+        server->next_capture_ns = monotonic_ns();
+    }
+}
+
+/* Parse complete client messages from the input buffer.
+ * @return false if the viewer sent something we can't handle */
+static bool process_messages(RfbServer* server) {
+    uint8_t* in = server->input;
+
+    for (;;) {
+        if (server->input_skip > 0) {
+            size_t drop = server->input_skip < server->input_len ?
+                server->input_skip : server->input_len;
+            memmove(in, in + drop, server->input_len - drop);
+            server->input_len -= drop;
+            server->input_skip -= drop;
+        }
+        if (server->input_len == 0) {
+            return true;
+        }
+
+        size_t need;
+        switch (in[0]) {
+        case 0: need = 20; break;                         /* SetPixelFormat */
+        case 2:                                           /* SetEncodings */
+            if (server->input_len < 4) {
+                return true;
+            }
+            if (read_u16(in + 2) > RFB_MAX_ENCODINGS) {
+                return false;
+            }
+            need = 4 + 4 * (size_t)read_u16(in + 2);
+            break;
+        case 3: need = 10; break;                         /* FramebufferUpdateRequest */
+        case 4: need = 8; break;                          /* KeyEvent */
+        case 5: need = 6; break;                          /* PointerEvent */
+        case 6: need = 8; break;                          /* ClientCutText header */
+        default:
+            log_warn("Remote viewer sent unknown message type %d", in[0]);
+            return false;
+        }
+        if (server->input_len < need) {
+            return true;
+        }
+
+        switch (in[0]) {
+        case 0: {
+            RfbPixelFormat format = format_decode(in + 4);
+            if (!format_supported(&format)) {
+                log_warn("Remote viewer asked for an unsupported pixel format "
+                         "(%d bpp, true colour %d)", format.bits_per_pixel, format.true_colour);
+                return false;
+            }
+            apply_format(server, &format);
+            /* Everything on the viewer is now stale */
+            server->sent_valid = false;
+            break;
+        }
+        case 2: {
+            int count = read_u16(in + 2);
+            server->zrle = false;
+#ifdef HAVE_ZLIB
+            for (int i = 0; i < count; i++) {
+                if ((int32_t)read_u32(in + 4 + 4 * i) == RFB_ENCODING_ZRLE) {
+                    server->zrle = server->zstream_ready;
+                }
+            }
+#else
+            (void)count;
+#endif
+            log_debug("Remote viewer encodings: %d offered, using %s",
+                      count, server->zrle ? "ZRLE" : "raw");
+            break;
+        }
+        case 3: {
+            RfbRect rect = { read_u16(in + 2), read_u16(in + 4),
+                             read_u16(in + 6), read_u16(in + 8) };
+            RfbRect bounds = { 0, 0, server->width, server->height };
+            if (clip_rect(&rect, &bounds)) {
+                server->request = rect;
+                server->update_requested = true;
+                if (!in[1]) {
+                    server->full_requested = true;
+                    server->next_capture_ns = 0;
+                }
+            }
+            break;
+        }
+        case 5:
+            handle_pointer(server, in[1], read_u16(in + 2), read_u16(in + 4));
+            break;
+        case 6:
+            server->input_skip = read_u32(in + 4);
+            break;
+        default:
+            break;                                        /* Keys are not mapped */
+        }
+
+        memmove(in, in + need, server->input_len - need);
+        server->input_len -= need;
+    }
+}
+
+static bool read_client(RfbServer* server) {
+    ssize_t n = recv(server->client_fd, server->input + server->input_len,
+                     sizeof(server->input) - server->input_len, MSG_DONTWAIT);
+    if (n == 0) {
+        end_session(server, "closed by viewer");
+        return false;
+    }
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return true;
+        }
+        end_session(server, strerror(errno));
+        return false;
+    }
+    server->input_len += (size_t)n;
+    if (!process_messages(server)) {
+        end_session(server, "protocol error");
+        return false;
+    }
+    return true;
+}
+
+/* Encode the damaged part of the work frame and send it */
+static void send_update(RfbServer* server) {
+    uint64_t start = monotonic_ns();
+    const uint32_t* work = server->frames[server->slot[SLOT_WORK]];
+
+    int count;
+    if (!server->sent_valid || server->full_requested) {
+        server->rects[0] = server->request;
+        count = 1;
+    } else {
+        count = compute_damage(server, work, server->frames[server->slot[SLOT_SENT]]);
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            RfbRect rect = server->rects[i];
+            if (clip_rect(&rect, &server->request)) {
+                server->rects[kept++] = rect;
+            }
+        }
+        count = kept;
+    }
+
+    if (count == 0) {
+        server->unchanged_streak++;
+        server->next_capture_ns = start + capture_interval_ns(server);
+        pthread_mutex_lock(&server->mutex);
+        server->stats.frames_unchanged++;
+        pthread_mutex_unlock(&server->mutex);
+        return;
+    }
+
+    RfbBuffer* out = &server->out;
+    out->size = 0;
+    out->failed = false;
+    server->tile_data.failed = false;
+    buffer_u8(out, 0);
+    buffer_u8(out, 0);
+    buffer_u16(out, (uint16_t)count);
+    uint64_t pixels = 0;
+    bool ok = true;
+    for (int i = 0; i < count && ok; i++) {
+        const RfbRect* rect = &server->rects[i];
+        buffer_u16(out, (uint16_t)rect->x);
+        buffer_u16(out, (uint16_t)rect->y);
+        buffer_u16(out, (uint16_t)rect->w);
+        buffer_u16(out, (uint16_t)rect->h);
+        pixels += (uint64_t)rect->w * (uint64_t)rect->h;
+#ifdef HAVE_ZLIB
+        if (server->zrle) {
+            buffer_u32(out, RFB_ENCODING_ZRLE);
+            ok = encode_zrle(server, work, rect);
+            continue;
+        }
+#endif
+        buffer_u32(out, RFB_ENCODING_RAW);
+        encode_raw(server, work, rect);
+    }
+    uint32_t encode_us = (uint32_t)((monotonic_ns() - start) / 1000);
+
+    if (!ok || out->failed) {
+        end_session(server, "out of memory encoding update");
+        return;
+    }
+    if (!send_all(server->client_fd, out->data, out->size)) {
+        end_session(server, errno == EAGAIN ? "send timed out" : strerror(errno));
+        return;
+    }
+
+    /* SENT now mirrors the viewer; outside a partial request it still holds
+     * the older pixels, so only that region is taken from WORK */
+    if (server->request.x == 0 && server->request.y == 0 &&
+        server->request.w == server->width && server->request.h == server->height) {
+        int sent = server->slot[SLOT_SENT];
+        server->slot[SLOT_SENT] = server->slot[SLOT_WORK];
+        server->slot[SLOT_WORK] = sent;
+    } else if (server->sent_valid) {
+        uint32_t* sent = server->frames[server->slot[SLOT_SENT]];
+        for (int y = server->request.y; y < server->request.y + server->request.h; y++) {
+            size_t offset = (size_t)y * (size_t)server->width + (size_t)server->request.x;
+            memcpy(sent + offset, work + offset, (size_t)server->request.w * 4);
+        }
+    }
+    /* A partial first request leaves the rest unknown; keep sending in full */
+    server->sent_valid = server->sent_valid ||
+        (server->request.w == server->width && server->request.h == server->height);
+    server->update_requested = false;
+    server->full_requested = false;
+    server->unchanged_streak = 0;
+    server->next_capture_ns = start + capture_interval_ns(server);
+
+    pthread_mutex_lock(&server->mutex);
+    server->stats.updates_sent++;
+    server->stats.rects_sent += (uint64_t)count;
+    server->stats.pixels_sent += pixels;
+    server->stats.bytes_sent += out->size;
+    server->stats.last_encode_us = encode_us;
+    pthread_mutex_unlock(&server->mutex);
+}
+
+static void handle_frame(RfbServer* server) {
+    pthread_mutex_lock(&server->mutex);
+    bool fresh = server->pending_fresh;
+    if (fresh) {
+        int pending = server->slot[SLOT_PENDING];
+        server->slot[SLOT_PENDING] = server->slot[SLOT_WORK];
+        server->slot[SLOT_WORK] = pending;
+        server->pending_fresh = false;
+    }
+    pthread_mutex_unlock(&server->mutex);
+
+    server->capture_requested = false;
+    if (server->client_fd < 0 || !server->update_requested) {
+        return;
+    }
+    if (!fresh) {
+        /* Readback failed; try again after the usual interval */
+        server->next_capture_ns = monotonic_ns() + capture_interval_ns(server);
+        return;
+    }
+    send_update(server);
+}
+
+static void* server_thread_main(void* arg) {
+    RfbServer* server = arg;
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+    log_info("Remote screen server listening on %s:%d", server->bind_address, server->port);
+
+    while (atomic_load(&server->running)) {
+        int timeout = -1;
+        if (server->client_fd >= 0 && server->update_requested && !server->capture_requested) {
+            uint64_t now = monotonic_ns();
+            if (now >= server->next_capture_ns) {
+                server->capture_requested = true;
+                atomic_store_explicit(&server->want_frame, true, memory_order_release);
+            } else {
+                timeout = (int)((server->next_capture_ns - now + 999999) / 1000000);
+            }
+        }
+
+        struct pollfd fds[3] = {
+            { server->wake_pipe[0], POLLIN, 0 },
+            { server->listen_fd, POLLIN, 0 },
+            { server->client_fd, POLLIN, 0 }
+        };
+        int count = server->client_fd >= 0 ? 3 : 2;
+        if (poll(fds, (nfds_t)count, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERRNO("Remote screen server poll failed");
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(server->wake_pipe[0], drain, sizeof(drain)) > 0) {
+            }
+            if (!atomic_load(&server->running)) {
+                break;
+            }
+            if (server->capture_requested) {
+                handle_frame(server);
+            }
+        }
+        if (count == 3 && (fds[2].revents & (POLLIN | POLLHUP | POLLERR))) {
+            read_client(server);
+        }
+        if (fds[1].revents & POLLIN) {
+            accept_viewer(server);
+        }
+    }
+
+    end_session(server, "server stopping");
+    log_info("Remote screen server stopped");
+    return NULL;
+}
+
+RfbServerConfig rfb_server_default_config(void) {
+    RfbServerConfig config = {
+        .bind_address = "127.0.0.1",
+        .port = 5900,
+        .max_fps = 15,
+        .idle_fps = 2,
+        .compression = 6,
+        .view_only = false,
+        .desktop_name = "PanelKit",
+        .on_input = NULL,
+        .input_user_data = NULL
+    };
+    return config;
+}
+
+RfbServer* rfb_server_create(const RfbServerConfig* config, int width, int height) {
+    PK_CHECK_NULL_WITH_CONTEXT(width > 0 && height > 0 && width <= 65535 && height <= 65535,
+                               PK_ERROR_INVALID_PARAM,
+                               "rfb_server_create: invalid framebuffer size %dx%d", width, height);
+
+    RfbServer* server = calloc(1, sizeof(RfbServer));
+    if (!server) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "rfb_server_create: Failed to allocate %zu bytes", sizeof(RfbServer));
+        return NULL;
+    }
+
+    server->config = config ? *config : rfb_server_default_config();
+    RfbServerConfig defaults = rfb_server_default_config();
+    snprintf(server->bind_address, sizeof(server->bind_address), "%s",
+             server->config.bind_address ? server->config.bind_address : defaults.bind_address);
+    snprintf(server->desktop_name, sizeof(server->desktop_name), "%s",
+             server->config.desktop_name ? server->config.desktop_name : defaults.desktop_name);
+    server->config.bind_address = server->bind_address;
+    server->config.desktop_name = server->desktop_name;
+    if (server->config.max_fps <= 0) {
+        server->config.max_fps = defaults.max_fps;
+    }
+    if (server->config.idle_fps <= 0 || server->config.idle_fps > server->config.max_fps) {
+        server->config.idle_fps = server->config.max_fps;
+    }
+    if (server->config.compression < 1 || server->config.compression > 9) {
+        server->config.compression = defaults.compression;
+    }
+
+    server->width = width;
+    server->height = height;
+    server->listen_fd = -1;
+    server->client_fd = -1;
+    server->wake_pipe[0] = -1;
+    server->wake_pipe[1] = -1;
+    server->tiles_x = (width + RFB_TILE - 1) / RFB_TILE;
+    server->tiles_y = (height + RFB_TILE - 1) / RFB_TILE;
+    server->rect_capacity = server->tiles_x * server->tiles_y;
+    server->dirty = calloc((size_t)server->rect_capacity, 1);
+    server->rects = calloc((size_t)server->rect_capacity, sizeof(RfbRect));
+    if (!server->dirty || !server->rects) {
+        free(server->dirty);
+        free(server->rects);
+        free(server);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "rfb_server_create: Failed to allocate damage map for %dx%d", width, height);
+        return NULL;
+    }
+    pthread_mutex_init(&server->mutex, NULL);
+    atomic_init(&server->running, false);
+    atomic_init(&server->want_frame, false);
+    apply_format(server, &k_native_format);
+    return server;
+}
+
+bool rfb_server_start(RfbServer* server) {
+    PK_CHECK_FALSE_WITH_CONTEXT(server != NULL, PK_ERROR_NULL_PARAM,
+                                "rfb_server_start: server is NULL");
+    if (server->thread_started) {
+        return true;
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)server->config.port);
+    if (inet_pton(AF_INET, server->bind_address, &address.sin_addr) != 1) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "rfb_server_start: invalid bind address '%s'", server->bind_address);
+        return false;
+    }
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "rfb_server_start: socket failed: %s", strerror(errno));
+        return false;
+    }
+    int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(server->listen_fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(server->listen_fd, 2) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "rfb_server_start: cannot listen on %s:%d: %s",
+            server->bind_address, server->config.port, strerror(errno));
+        close(server->listen_fd);
+        server->listen_fd = -1;
+        return false;
+    }
+    socklen_t length = sizeof(address);
+    getsockname(server->listen_fd, (struct sockaddr*)&address, &length);
+    server->port = ntohs(address.sin_port);
+
+    if (pipe(server->wake_pipe) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "rfb_server_start: pipe failed: %s", strerror(errno));
+        close(server->listen_fd);
+        server->listen_fd = -1;
+        return false;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(server->wake_pipe[i], F_SETFL, fcntl(server->wake_pipe[i], F_GETFL) | O_NONBLOCK);
+    }
+
+    atomic_store(&server->running, true);
+    int rc = pthread_create(&server->thread, NULL, server_thread_main, server);
+    if (rc != 0) {
+        atomic_store(&server->running, false);
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "rfb_server_start: pthread_create failed: %s", strerror(rc));
+        return false;
+    }
+    server->thread_started = true;
+    return true;
+}
+
+void rfb_server_destroy(RfbServer* server) {
+    if (!server) {
+        return;
+    }
+
+    if (server->thread_started) {
+        atomic_store(&server->running, false);
+        ssize_t written = write(server->wake_pipe[1], "q", 1);
+        (void)written;
+        pthread_join(server->thread, NULL);
+
+        log_info("Remote screen server: %llu sessions, %llu updates, %llu KB sent",
+                 (unsigned long long)server->stats.sessions,
+                 (unsigned long long)server->stats.updates_sent,
+                 (unsigned long long)(server->stats.bytes_sent / 1024));
+    }
+
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (server->wake_pipe[i] >= 0) {
+            close(server->wake_pipe[i]);
+        }
+    }
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        free(server->frames[i]);
+    }
+    free(server->dirty);
+    free(server->rects);
+    free(server->out.data);
+    free(server->tile_data.data);
+    pthread_mutex_destroy(&server->mutex);
+    free(server);
+}
+
+bool rfb_server_begin_capture(RfbServer* server, void** pixels, int* pitch) {
+    if (!server || !atomic_load_explicit(&server->want_frame, memory_order_acquire)) {
+        return false;
+    }
+    server->capture_start_ns = monotonic_ns();
+    *pixels = server->frames[server->slot[SLOT_CAPTURE]];
+    *pitch = server->width * 4;
+    return true;
+}
+
+void rfb_server_end_capture(RfbServer* server, bool captured) {
+    if (!server) {
+        return;
+    }
+    atomic_store(&server->want_frame, false);
+
+    pthread_mutex_lock(&server->mutex);
+    if (captured) {
+        int capture = server->slot[SLOT_CAPTURE];
+        server->slot[SLOT_CAPTURE] = server->slot[SLOT_PENDING];
+        server->slot[SLOT_PENDING] = capture;
+        server->pending_fresh = true;
+        server->stats.frames_captured++;
+    }
+    server->stats.last_capture_us = (uint32_t)((monotonic_ns() - server->capture_start_ns) / 1000);
+    pthread_mutex_unlock(&server->mutex);
+
+    /* Non-blocking: a full pipe already means "wake up" */
+    ssize_t written = write(server->wake_pipe[1], "f", 1);
+    (void)written;
+}
+
+void rfb_server_get_stats(RfbServer* server, RfbServerStats* stats) {
+    if (!server || !stats) {
+        return;
+    }
+    pthread_mutex_lock(&server->mutex);
+    *stats = server->stats;
+    pthread_mutex_unlock(&server->mutex);
+}
+
+int rfb_server_get_port(RfbServer* server) {
+    return server ? server->port : 0;
+}
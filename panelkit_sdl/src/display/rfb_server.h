@@ -0,0 +1,159 @@
+/**
+ * @file rfb_server.h
+ * @brief Remote screen mirroring over RFB (VNC) for support sessions
+ *
+ * A server thread accepts one VNC viewer at a time. While the viewer has
+ * an update request outstanding, the render pipeline hands the next
+ * presented frame over with rfb_server_begin_capture() and
+ * rfb_server_end_capture(); the server thread compares it against the
+ * last frame sent, in 64x64 tiles, and encodes only the changed
+ * rectangles (ZRLE when built with zlib, raw otherwise). Remote pointer
+ * input is turned into SDL mouse events and handed to a callback, which
+ * the application forwards to the input handler.
+ *
+ * Cost on the render thread:
+ * - no viewer connected: one atomic load per frame
+ * - viewer connected: one framebuffer readback per captured frame, at most
+ *   max_fps and dropping to idle_fps while the screen is not changing.
+ *   Diffing, encoding and sending all happen on the server thread.
+ *
+ * There is no authentication (VNC password auth needs DES, which is not
+ * in the tree). The default bind address is loopback; reach it through
+ * an SSH tunnel.
+ *
+ * Typical wiring:
+ * @code
+ *   RfbServerConfig cfg = rfb_server_default_config();
+ *   cfg.on_input = forward_to_input_handler;
+ *   RfbServer* rfb = rfb_server_create(&cfg, width, height);
+ *   rfb_server_start(rfb);
+ *   render_pipeline_set_mirror(pipeline, rfb);
+ * @endcode
+ */
+
+#ifndef PANELKIT_RFB_SERVER_H
+#define PANELKIT_RFB_SERVER_H
+
+#include "core/sdl_includes.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Opaque RFB server handle */
+typedef struct RfbServer RfbServer;
+
+/**
+ * Deliver a remote input event. Called on the server thread.
+ *
+ * @param event Mouse motion, button or wheel event in framebuffer coordinates
+ * @param user_data Context from the configuration
+ */
+typedef void (*rfb_input_func)(SDL_Event* event, void* user_data);
+
+/**
+ * RFB server configuration.
+ */
+typedef struct {
+    const char* bind_address;   /**< Listen address (IPv4 dotted quad) */
+    int port;                   /**< TCP port */
+    int max_fps;                /**< Capture rate cap while the screen changes */
+    int idle_fps;               /**< Capture rate after several unchanged frames */
+    int compression;            /**< zlib level for ZRLE (1-9) */
+    bool view_only;             /**< Ignore remote pointer input */
+    const char* desktop_name;   /**< Name shown by the viewer */
+    rfb_input_func on_input;    /**< Remote input sink (NULL = view only) */
+    void* input_user_data;      /**< Passed to on_input */
+} RfbServerConfig;
+
+/**
+ * RFB server statistics.
+ */
+typedef struct {
+    uint64_t sessions;          /**< Viewers accepted */
+    uint64_t frames_captured;   /**< Frames handed over by the render thread */
+    uint64_t frames_unchanged;  /**< Captures with nothing to send */
+    uint64_t updates_sent;      /**< FramebufferUpdate messages sent */
+    uint64_t rects_sent;        /**< Rectangles in those updates */
+    uint64_t pixels_sent;       /**< Pixels covered by those rectangles */
+    uint64_t bytes_sent;        /**< Bytes written to viewers */
+    uint64_t input_events;      /**< SDL events generated from remote input */
+    uint32_t last_capture_us;   /**< Render thread time of the last capture */
+    uint32_t last_encode_us;    /**< Diff + encode time of the last update */
+    bool connected;             /**< A viewer is connected */
+} RfbServerStats;
+
+/**
+ * Get default server configuration.
+ *
+ * @return 127.0.0.1:5900, 15 fps (2 fps idle), zlib level 6, input enabled
+ */
+RfbServerConfig rfb_server_default_config(void);
+
+/**
+ * Create an RFB server for a framebuffer of the given size.
+ *
+ * @param config Server configuration (NULL for defaults)
+ * @param width Framebuffer width in pixels
+ * @param height Framebuffer height in pixels
+ * @return New server or NULL on error (caller owns)
+ * @note Nothing is listened on until rfb_server_start() is called
+ */
+RfbServer* rfb_server_create(const RfbServerConfig* config, int width, int height);
+
+/**
+ * Stop the server thread, disconnect the viewer and destroy the server.
+ *
+ * @param server Server to destroy (can be NULL)
+ * @note Destroy after the render pipeline it is attached to
+ */
+void rfb_server_destroy(RfbServer* server);
+
+/**
+ * Bind the listening socket and start the server thread.
+ *
+ * @param server RFB server (required)
+ * @return true on success, false on error (error context set)
+ */
+bool rfb_server_start(RfbServer* server);
+
+/**
+ * Ask whether the next frame should be captured, and where to put it.
+ *
+ * Returns false (one atomic load) unless a viewer is waiting for an
+ * update and the capture interval has passed. On true the caller must
+ * write the frame as SDL_PIXELFORMAT_ARGB8888 and call
+ * rfb_server_end_capture().
+ *
+ * @param server RFB server (can be NULL)
+ * @param pixels Output: frame buffer to fill (width x height)
+ * @param pitch Output: bytes per row of pixels
+ * @return true if a frame is wanted
+ * @note Render thread only
+ */
+bool rfb_server_begin_capture(RfbServer* server, void** pixels, int* pitch);
+
+/**
+ * Hand a captured frame to the server thread.
+ *
+ * @param server RFB server (required)
+ * @param captured false if the readback failed (frame is discarded)
+ * @note Render thread only; never blocks on the network
+ */
+void rfb_server_end_capture(RfbServer* server, bool captured);
+
+/**
+ * Get server statistics.
+ *
+ * @param server RFB server (required)
+ * @param stats Output statistics (required)
+ */
+void rfb_server_get_stats(RfbServer* server, RfbServerStats* stats);
+
+/**
+ * Get the TCP port the server listens on (useful with port 0).
+ *
+ * @param server RFB server (required)
+ * @return Port number, or 0 if not started
+ */
+int rfb_server_get_port(RfbServer* server);
+
+#endif /* PANELKIT_RFB_SERVER_H */
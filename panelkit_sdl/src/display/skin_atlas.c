@@ -0,0 +1,545 @@
+/**
+ * @file skin_atlas.c
+ * @brief Nine-slice skin atlas packing, generation and drawing
+ */
+
+#include "skin_atlas.h"
+#include "../core/logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define SKIN_ATLAS_DEFAULT_SIZE 512
+#define SKIN_ATLAS_MAX_REGIONS 64
+#define SKIN_ATLAS_PADDING 1
+
+/* Stretchable center of generated regions; taller so gradients survive */
+#define GENERATED_CENTER_WIDTH 4
+#define GENERATED_CENTER_HEIGHT 16
+
+struct SkinAtlas {
+    SDL_Surface* surface;       /* ARGB8888, shared with display lists */
+    SkinRegion regions[SKIN_ATLAS_MAX_REGIONS];
+    int region_count;
+    bool sealed;                /* Set on first draw; pixels are immutable after */
+
+    /* Shelf packer state */
+    int cursor_x;
+    int cursor_y;
+    int shelf_height;
+};
+
+static const char* const skin_classes[] = { "button", "panel" };
+static const char* const skin_states[] = { "normal", "hovered", "pressed", "disabled" };
+
+// Lifecycle
+
+SkinAtlas* skin_atlas_create(int width, int height) {
+    if (width <= 0) {
+        width = SKIN_ATLAS_DEFAULT_SIZE;
+    }
+    if (height <= 0) {
+        height = SKIN_ATLAS_DEFAULT_SIZE;
+    }
+
+    SkinAtlas* atlas = calloc(1, sizeof(SkinAtlas));
+    if (!atlas) {
+        log_error("Failed to allocate skin atlas");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "skin_atlas_create: Failed to allocate %zu bytes", sizeof(SkinAtlas));
+        return NULL;
+    }
+
+    atlas->surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32,
+                                                    SDL_PIXELFORMAT_ARGB8888);
+    if (!atlas->surface) {
+        log_error("Failed to create %dx%d skin atlas surface: %s", width, height, SDL_GetError());
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "skin_atlas_create: SDL_CreateRGBSurfaceWithFormat failed: %s", SDL_GetError());
+        free(atlas);
+        return NULL;
+    }
+
+    /* New surfaces are zeroed (fully transparent); blend when drawn */
+    SDL_SetSurfaceBlendMode(atlas->surface, SDL_BLENDMODE_BLEND);
+
+    log_debug("Created %dx%d skin atlas", width, height);
+    return atlas;
+}
+
+void skin_atlas_destroy(SkinAtlas* atlas) {
+    if (!atlas) {
+        return;
+    }
+
+    display_list_release_surface(atlas->surface);
+    free(atlas);
+}
+
+// Packing
+
+/* Reserve space for a w x h image using simple shelf packing */
+static bool atlas_allocate(SkinAtlas* atlas, int w, int h, SDL_Rect* out) {
+    int padded_w = w + SKIN_ATLAS_PADDING;
+    int padded_h = h + SKIN_ATLAS_PADDING;
+
+    if (atlas->cursor_x + padded_w > atlas->surface->w) {
+        atlas->cursor_x = 0;
+        atlas->cursor_y += atlas->shelf_height;
+        atlas->shelf_height = 0;
+    }
+
+    if (atlas->cursor_x + padded_w > atlas->surface->w ||
+        atlas->cursor_y + padded_h > atlas->surface->h) {
+        return false;
+    }
+
+    *out = (SDL_Rect){ atlas->cursor_x, atlas->cursor_y, w, h };
+    atlas->cursor_x += padded_w;
+    if (padded_h > atlas->shelf_height) {
+        atlas->shelf_height = padded_h;
+    }
+    return true;
+}
+
+PkError skin_atlas_add_surface(SkinAtlas* atlas, const char* name,
+                               SDL_Surface* image, const SkinInsets* insets) {
+    PK_CHECK_ERROR_WITH_CONTEXT(atlas != NULL && name != NULL && image != NULL && insets != NULL,
+                               PK_ERROR_NULL_PARAM,
+                               "skin_atlas_add_surface: atlas=%p, name=%p, image=%p, insets=%p",
+                               (void*)atlas, (void*)name, (void*)image, (void*)insets);
+    PK_CHECK_ERROR_WITH_CONTEXT(!atlas->sealed, PK_ERROR_INVALID_STATE,
+                               "skin_atlas_add_surface: atlas already in use, cannot add '%s'",
+                               name);
+    PK_CHECK_ERROR_WITH_CONTEXT(insets->left >= 0 && insets->right >= 0 &&
+                               insets->top >= 0 && insets->bottom >= 0 &&
+                               insets->left + insets->right <= image->w &&
+                               insets->top + insets->bottom <= image->h,
+                               PK_ERROR_INVALID_PARAM,
+                               "skin_atlas_add_surface: insets %d/%d/%d/%d exceed %dx%d image '%s'",
+                               insets->left, insets->top, insets->right, insets->bottom,
+                               image->w, image->h, name);
+
+    if (skin_atlas_find(atlas, name)) {
+        pk_set_last_error_with_context(PK_ERROR_ALREADY_EXISTS,
+            "skin_atlas_add_surface: region '%s' already exists", name);
+        return PK_ERROR_ALREADY_EXISTS;
+    }
+
+    if (atlas->region_count >= SKIN_ATLAS_MAX_REGIONS) {
+        pk_set_last_error_with_context(PK_ERROR_RESOURCE_LIMIT,
+            "skin_atlas_add_surface: region limit (%d) reached adding '%s'",
+            SKIN_ATLAS_MAX_REGIONS, name);
+        return PK_ERROR_RESOURCE_LIMIT;
+    }
+
+    SDL_Rect rect;
+    if (!atlas_allocate(atlas, image->w, image->h, &rect)) {
+        pk_set_last_error_with_context(PK_ERROR_RESOURCE_LIMIT,
+            "skin_atlas_add_surface: no room for %dx%d region '%s' in %dx%d atlas",
+            image->w, image->h, name, atlas->surface->w, atlas->surface->h);
+        return PK_ERROR_RESOURCE_LIMIT;
+    }
+
+    /* Copy pixels including alpha rather than blending onto the atlas */
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!converted) {
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "skin_atlas_add_surface: SDL_ConvertSurfaceFormat failed for '%s': %s",
+            name, SDL_GetError());
+        return PK_ERROR_SDL;
+    }
+    SDL_SetSurfaceBlendMode(converted, SDL_BLENDMODE_NONE);
+
+    int rc = SDL_BlitSurface(converted, NULL, atlas->surface, &rect);
+    SDL_FreeSurface(converted);
+    if (rc < 0) {
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "skin_atlas_add_surface: SDL_BlitSurface failed for '%s': %s",
+            name, SDL_GetError());
+        return PK_ERROR_SDL;
+    }
+
+    SkinRegion* region = &atlas->regions[atlas->region_count++];
+    strncpy(region->name, name, sizeof(region->name) - 1);
+    region->name[sizeof(region->name) - 1] = '\0';
+    region->rect = rect;
+    region->insets = *insets;
+
+    log_debug("Packed skin region '%s' (%dx%d) at %d,%d",
+              name, rect.w, rect.h, rect.x, rect.y);
+    return PK_OK;
+}
+
+PkError skin_atlas_add_bmp(SkinAtlas* atlas, const char* name, const char* path,
+                           const SkinInsets* insets) {
+    PK_CHECK_ERROR_WITH_CONTEXT(path != NULL, PK_ERROR_NULL_PARAM,
+                               "skin_atlas_add_bmp: path is NULL");
+
+    SDL_Surface* image = SDL_LoadBMP(path);
+    if (!image) {
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "skin_atlas_add_bmp: Failed to load '%s': %s", path, SDL_GetError());
+        return PK_ERROR_NOT_FOUND;
+    }
+
+    PkError err = skin_atlas_add_surface(atlas, name, image, insets);
+    SDL_FreeSurface(image);
+    return err;
+}
+
+// Procedural generation
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/* Signed distance from (px, py) to a rounded rectangle; negative inside */
+static float rounded_rect_distance(float px, float py, float x0, float y0,
+                                   float x1, float y1, float radius) {
+    float cx = (x0 + x1) * 0.5f;
+    float cy = (y0 + y1) * 0.5f;
+    float qx = fabsf(px - cx) - ((x1 - x0) * 0.5f - radius);
+    float qy = fabsf(py - cy) - ((y1 - y0) * 0.5f - radius);
+    float ox = qx > 0.0f ? qx : 0.0f;
+    float oy = qy > 0.0f ? qy : 0.0f;
+    float inside = qx > qy ? qx : qy;
+    return sqrtf(ox * ox + oy * oy) + (inside < 0.0f ? inside : 0.0f) - radius;
+}
+
+static Uint8 lerp_channel(Uint8 a, Uint8 b, float t) {
+    return (Uint8)((float)a + ((float)b - (float)a) * t + 0.5f);
+}
+
+PkError skin_atlas_add_generated(SkinAtlas* atlas, const char* name, const SkinStyle* style) {
+    PK_CHECK_ERROR_WITH_CONTEXT(style != NULL, PK_ERROR_NULL_PARAM,
+                               "skin_atlas_add_generated: style is NULL");
+
+    int shadow = style->shadow_size > 0 ? style->shadow_size : 0;
+    int border = style->border_width > 0 ? style->border_width : 0;
+    int radius = style->corner_radius > border ? style->corner_radius : border;
+    int offset = shadow / 2;    /* Shadow falls slightly below the body */
+
+    SkinInsets insets = {
+        .left = shadow + radius,
+        .top = shadow - offset + radius,
+        .right = shadow + radius,
+        .bottom = shadow + offset + radius
+    };
+    int width = insets.left + insets.right + GENERATED_CENTER_WIDTH;
+    int height = insets.top + insets.bottom + GENERATED_CENTER_HEIGHT;
+
+    SDL_Surface* image = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32,
+                                                        SDL_PIXELFORMAT_ARGB8888);
+    if (!image) {
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "skin_atlas_add_generated: Failed to create %dx%d surface for '%s': %s",
+            width, height, name ? name : "(null)", SDL_GetError());
+        return PK_ERROR_SDL;
+    }
+
+    /* Body rectangle inside the shadow margin */
+    float bx0 = (float)shadow;
+    float by0 = (float)(shadow - offset);
+    float bx1 = (float)(width - shadow);
+    float by1 = (float)(height - shadow - offset);
+
+    Uint32* pixels = image->pixels;
+    int stride = image->pitch / 4;
+
+    for (int y = 0; y < height; y++) {
+        float py = (float)y + 0.5f;
+        float t = clampf((py - by0) / (by1 - by0), 0.0f, 1.0f);
+        SDL_Color fill = {
+            lerp_channel(style->top_color.r, style->bottom_color.r, t),
+            lerp_channel(style->top_color.g, style->bottom_color.g, t),
+            lerp_channel(style->top_color.b, style->bottom_color.b, t),
+            lerp_channel(style->top_color.a, style->bottom_color.a, t)
+        };
+
+        for (int x = 0; x < width; x++) {
+            float px = (float)x + 0.5f;
+            float d = rounded_rect_distance(px, py, bx0, by0, bx1, by1, (float)radius);
+
+            /* Body color: border blended over fill near the edge */
+            SDL_Color body = fill;
+            if (border > 0) {
+                float b = clampf(d + (float)border + 0.5f, 0.0f, 1.0f);
+                body.r = lerp_channel(fill.r, style->border_color.r, b);
+                body.g = lerp_channel(fill.g, style->border_color.g, b);
+                body.b = lerp_channel(fill.b, style->border_color.b, b);
+                body.a = lerp_channel(fill.a, style->border_color.a, b);
+            }
+            float body_a = clampf(0.5f - d, 0.0f, 1.0f) * (float)body.a / 255.0f;
+
+            /* Shadow: same shape shifted down, fading out over shadow px */
+            float shadow_a = 0.0f;
+            if (shadow > 0) {
+                float ds = rounded_rect_distance(px, py - (float)offset, bx0, by0,
+                                                 bx1, by1, (float)radius);
+                float falloff = 1.0f - clampf(ds / (float)shadow, 0.0f, 1.0f);
+                shadow_a = falloff * falloff * (float)style->shadow_alpha / 255.0f;
+            }
+
+            /* Body over black shadow */
+            float out_a = body_a + shadow_a * (1.0f - body_a);
+            Uint8 r = 0, g = 0, b = 0;
+            if (out_a > 0.0f) {
+                r = (Uint8)((float)body.r * body_a / out_a + 0.5f);
+                g = (Uint8)((float)body.g * body_a / out_a + 0.5f);
+                b = (Uint8)((float)body.b * body_a / out_a + 0.5f);
+            }
+            pixels[y * stride + x] = SDL_MapRGBA(image->format, r, g, b,
+                                                 (Uint8)(out_a * 255.0f + 0.5f));
+        }
+    }
+
+    PkError err = skin_atlas_add_surface(atlas, name, image, &insets);
+    SDL_FreeSurface(image);
+    return err;
+}
+
+PkError skin_atlas_load_builtin(SkinAtlas* atlas) {
+    PK_CHECK_ERROR_WITH_CONTEXT(atlas != NULL, PK_ERROR_NULL_PARAM,
+                               "skin_atlas_load_builtin: atlas is NULL");
+
+    /* Same palette as the flat button defaults, with depth added */
+    static const struct {
+        const char* name;
+        SkinStyle style;
+    } builtin[] = {
+        { "button.normal",   { {122, 122, 122, 255}, { 88,  88,  88, 255}, { 50,  50,  50, 255}, 2, 8, 4, 110 } },
+        { "button.hovered",  { {142, 142, 142, 255}, {106, 106, 106, 255}, { 50,  50,  50, 255}, 2, 8, 4, 110 } },
+        { "button.pressed",  { { 68,  68,  68, 255}, { 90,  90,  90, 255}, { 40,  40,  40, 255}, 2, 8, 4,  40 } },
+        { "button.disabled", { {188, 188, 188, 255}, {170, 170, 170, 255}, {140, 140, 140, 255}, 2, 8, 4,  50 } },
+        { "panel.normal",    { { 48,  48,  48, 255}, { 38,  38,  38, 255}, { 64,  64,  64, 255}, 1, 12, 6, 120 } }
+    };
+
+    for (size_t i = 0; i < sizeof(builtin) / sizeof(builtin[0]); i++) {
+        PkError err = skin_atlas_add_generated(atlas, builtin[i].name, &builtin[i].style);
+        if (err != PK_OK) {
+            return err;
+        }
+    }
+
+    log_info("Loaded built-in skin (%d regions)", atlas->region_count);
+    return PK_OK;
+}
+
+/* Fetches one skin image by path or asset name; NULL when absent */
+typedef SDL_Surface* (*SkinImageLoader)(const char* name, void* context);
+
+static SDL_Surface* load_file_image(const char* path, void* context) {
+    (void)context;
+    return SDL_LoadBMP(path);
+}
+
+static SDL_Surface* load_bundle_image(const char* name, void* context) {
+    AssetBundle* bundle = context;
+    if (!asset_bundle_contains(bundle, name)) {
+        return NULL;
+    }
+    AssetView view;
+    if (!asset_bundle_get(bundle, name, &view)) {
+        log_warn("Skipping skin image %s: %s", name, pk_get_last_error_context());
+        return NULL;
+    }
+    return SDL_LoadBMP_RW(SDL_RWFromConstMem(view.data, (int)view.size), 1);
+}
+
+/* <root>/<class>_<state>.bmp for every region the built-in skin provides */
+static PkError load_skin_set(SkinAtlas* atlas, const char* root, const char* label, int slice,
+                             SkinImageLoader load, void* context) {
+    SkinInsets insets = { slice, slice, slice, slice };
+    int loaded = 0;
+
+    for (size_t c = 0; c < sizeof(skin_classes) / sizeof(skin_classes[0]); c++) {
+        for (size_t s = 0; s < sizeof(skin_states) / sizeof(skin_states[0]); s++) {
+            char path[512];
+            char name[SKIN_REGION_NAME_MAX];
+            snprintf(path, sizeof(path), "%s%s%s_%s.bmp", root, root[0] ? "/" : "",
+                     skin_classes[c], skin_states[s]);
+            snprintf(name, sizeof(name), "%s.%s", skin_classes[c], skin_states[s]);
+
+            SDL_Surface* image = load(path, context);
+            if (!image) {
+                log_debug("Skin image %s not present", path);
+                continue;
+            }
+            PkError err = skin_atlas_add_surface(atlas, name, image, &insets);
+            SDL_FreeSurface(image);
+            if (err == PK_OK) {
+                loaded++;
+            } else {
+                log_warn("Skipping skin image %s: %s", path, pk_get_last_error_context());
+            }
+        }
+    }
+
+    if (loaded == 0) {
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "skin_atlas: no skin images found in '%s'", label);
+        return PK_ERROR_NOT_FOUND;
+    }
+
+    log_info("Loaded skin from %s (%d regions)", label, loaded);
+    return PK_OK;
+}
+
+PkError skin_atlas_load_directory(SkinAtlas* atlas, const char* directory, int slice) {
+    PK_CHECK_ERROR_WITH_CONTEXT(atlas != NULL && directory != NULL, PK_ERROR_NULL_PARAM,
+                               "skin_atlas_load_directory: atlas=%p, directory=%p",
+                               (void*)atlas, (void*)directory);
+
+    return load_skin_set(atlas, directory, directory, slice, load_file_image, NULL);
+}
+
+PkError skin_atlas_load_bundle(SkinAtlas* atlas, AssetBundle* bundle, const char* prefix,
+                               int slice) {
+    PK_CHECK_ERROR_WITH_CONTEXT(atlas != NULL && bundle != NULL && prefix != NULL,
+                               PK_ERROR_NULL_PARAM,
+                               "skin_atlas_load_bundle: atlas=%p, bundle=%p, prefix=%p",
+                               (void*)atlas, (void*)bundle, (void*)prefix);
+
+    char label[256];
+    snprintf(label, sizeof(label), "bundle:%s", prefix);
+    return load_skin_set(atlas, prefix, label, slice, load_bundle_image, bundle);
+}
+
+PkError skin_atlas_load_source(SkinAtlas* atlas, const char* source, int slice,
+                               AssetBundle* bundle) {
+    PK_CHECK_ERROR_WITH_CONTEXT(atlas != NULL && source != NULL, PK_ERROR_NULL_PARAM,
+                               "skin_atlas_load_source: atlas=%p, source=%p",
+                               (void*)atlas, (void*)source);
+
+    if (strcmp(source, "builtin") == 0) {
+        return skin_atlas_load_builtin(atlas);
+    }
+    if (strncmp(source, "bundle:", 7) == 0) {
+        if (!bundle) {
+            pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+                "skin_atlas_load_source: '%s' needs an asset bundle (system.assets.bundle)",
+                source);
+            return PK_ERROR_NOT_FOUND;
+        }
+        return skin_atlas_load_bundle(atlas, bundle, source + 7, slice);
+    }
+    return skin_atlas_load_directory(atlas, source, slice);
+}
+
+// Lookup and drawing
+
+const SkinRegion* skin_atlas_find(const SkinAtlas* atlas, const char* name) {
+    if (!atlas || !name) {
+        return NULL;
+    }
+
+    for (int i = 0; i < atlas->region_count; i++) {
+        if (strcmp(atlas->regions[i].name, name) == 0) {
+            return &atlas->regions[i];
+        }
+    }
+    return NULL;
+}
+
+const SkinRegion* skin_atlas_find_state(const SkinAtlas* atlas, const char* skin_class,
+                                        const char* state) {
+    if (!atlas || !skin_class || !state) {
+        return NULL;
+    }
+
+    char name[SKIN_REGION_NAME_MAX];
+    snprintf(name, sizeof(name), "%s.%s", skin_class, state);
+    const SkinRegion* region = skin_atlas_find(atlas, name);
+    if (region || strcmp(state, "normal") == 0) {
+        return region;
+    }
+
+    snprintf(name, sizeof(name), "%s.normal", skin_class);
+    return skin_atlas_find(atlas, name);
+}
+
+const SDL_Surface* skin_atlas_get_surface(const SkinAtlas* atlas) {
+    return atlas ? atlas->surface : NULL;
+}
+
+/* Split a span into three parts, shrinking the borders if it is too small */
+static void nine_slice_span(int start, int length, int lo, int hi, float out[4]) {
+    if (lo + hi > length && lo + hi > 0) {
+        float scale = (float)length / (float)(lo + hi);
+        float scaled_lo = (float)lo * scale;
+        out[0] = (float)start;
+        out[1] = (float)start + scaled_lo;
+        out[2] = out[1];
+        out[3] = (float)(start + length);
+        return;
+    }
+
+    out[0] = (float)start;
+    out[1] = (float)(start + lo);
+    out[2] = (float)(start + length - hi);
+    out[3] = (float)(start + length);
+}
+
+int skin_atlas_draw(DisplayList* list, SkinAtlas* atlas, const SkinRegion* region,
+                    const SDL_Rect* dst) {
+    if (!list || !atlas || !region || !dst) {
+        return SDL_SetError("skin_atlas_draw: invalid parameter");
+    }
+    if (dst->w <= 0 || dst->h <= 0) {
+        return 0;
+    }
+
+    /* The render thread may now hold the atlas pixels */
+    atlas->sealed = true;
+
+    float xs[4], ys[4];
+    nine_slice_span(dst->x, dst->w, region->insets.left, region->insets.right, xs);
+    nine_slice_span(dst->y, dst->h, region->insets.top, region->insets.bottom, ys);
+
+    float inv_w = 1.0f / (float)atlas->surface->w;
+    float inv_h = 1.0f / (float)atlas->surface->h;
+    const SDL_Rect* r = &region->rect;
+    float us[4] = {
+        (float)r->x * inv_w,
+        (float)(r->x + region->insets.left) * inv_w,
+        (float)(r->x + r->w - region->insets.right) * inv_w,
+        (float)(r->x + r->w) * inv_w
+    };
+    float vs[4] = {
+        (float)r->y * inv_h,
+        (float)(r->y + region->insets.top) * inv_h,
+        (float)(r->y + r->h - region->insets.bottom) * inv_h,
+        (float)(r->y + r->h) * inv_h
+    };
+
+    /* 4x4 grid of vertices, 9 quads of two triangles each */
+    SDL_Vertex vertices[16];
+    int indices[54];
+    int n = 0;
+
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) {
+            vertices[row * 4 + col] = (SDL_Vertex){
+                .position = { xs[col], ys[row] },
+                .color = { 255, 255, 255, 255 },
+                .tex_coord = { us[col], vs[row] }
+            };
+        }
+    }
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            int tl = row * 4 + col;
+            indices[n++] = tl;
+            indices[n++] = tl + 1;
+            indices[n++] = tl + 4;
+            indices[n++] = tl + 1;
+            indices[n++] = tl + 5;
+            indices[n++] = tl + 4;
+        }
+    }
+
+    return display_list_geometry(list, atlas->surface, vertices, 16, indices, n);
+}
@@ -0,0 +1,222 @@
+/**
+ * @file skin_atlas.h
+ * @brief Nine-slice skin images packed into a single texture atlas
+ *
+ * A skin is a set of named nine-slice regions ("button.normal",
+ * "button.pressed", "panel.normal", ...) packed into one surface at
+ * startup. Drawing a region stretches its center and edges to any size
+ * while keeping the corners intact, so rounded, shadowed or gradient
+ * chrome costs 9 textured quads per widget. All quads sample the same
+ * atlas, so consecutive skinned widgets are merged into a single
+ * geometry draw call by the display list.
+ *
+ * Regions come from BMP files (SDL core, no extra image library), on disk
+ * or in an asset bundle, or are generated procedurally from a SkinStyle. Once a region has been drawn
+ * the atlas is sealed: its pixels are shared with the render thread and
+ * must not change.
+ */
+
+#ifndef PANELKIT_SKIN_ATLAS_H
+#define PANELKIT_SKIN_ATLAS_H
+
+#include "core/sdl_includes.h"
+#include "display_list.h"
+#include "../core/error.h"
+#include "../core/asset_bundle.h"
+#include <stdbool.h>
+
+/** Opaque skin atlas handle */
+typedef struct SkinAtlas SkinAtlas;
+
+/** Maximum region name length including terminator */
+#define SKIN_REGION_NAME_MAX 48
+
+/**
+ * Nine-slice insets: size of the fixed border on each side.
+ */
+typedef struct {
+    int left;
+    int top;
+    int right;
+    int bottom;
+} SkinInsets;
+
+/**
+ * A named region of the atlas.
+ */
+typedef struct {
+    char name[SKIN_REGION_NAME_MAX];
+    SDL_Rect rect;              /**< Pixel rectangle within the atlas */
+    SkinInsets insets;          /**< Nine-slice borders within rect */
+} SkinRegion;
+
+/**
+ * Parameters for a procedurally generated region.
+ */
+typedef struct {
+    SDL_Color top_color;        /**< Fill color at the top edge */
+    SDL_Color bottom_color;     /**< Fill color at the bottom edge */
+    SDL_Color border_color;     /**< Outline color */
+    int border_width;           /**< Outline width in pixels (0 = none) */
+    int corner_radius;          /**< Corner radius in pixels */
+    int shadow_size;            /**< Drop shadow blur/offset in pixels (0 = none) */
+    Uint8 shadow_alpha;         /**< Drop shadow opacity at its darkest */
+} SkinStyle;
+
+// Lifecycle
+
+/**
+ * Create an empty skin atlas.
+ *
+ * @param width Atlas width in pixels (0 for default)
+ * @param height Atlas height in pixels (0 for default)
+ * @return New atlas or NULL on error (caller owns)
+ */
+SkinAtlas* skin_atlas_create(int width, int height);
+
+/**
+ * Destroy a skin atlas.
+ *
+ * @param atlas Atlas to destroy (can be NULL)
+ * @note Display lists still referencing the atlas keep its surface alive
+ */
+void skin_atlas_destroy(SkinAtlas* atlas);
+
+// Packing
+
+/**
+ * Pack an image into the atlas as a named region.
+ *
+ * @param atlas Skin atlas (required)
+ * @param name Region name, e.g. "button.pressed" (required, copied)
+ * @param image Source image (required, borrowed; pixels are copied)
+ * @param insets Nine-slice borders (required)
+ * @return PK_OK on success, error code on failure
+ * @note Fails with PK_ERROR_RESOURCE_LIMIT when the atlas is full and
+ *       PK_ERROR_INVALID_STATE once the atlas has been drawn from
+ */
+PkError skin_atlas_add_surface(SkinAtlas* atlas, const char* name,
+                               SDL_Surface* image, const SkinInsets* insets);
+
+/**
+ * Load a BMP file and pack it into the atlas.
+ *
+ * @param atlas Skin atlas (required)
+ * @param name Region name (required, copied)
+ * @param path Path to a 24- or 32-bit BMP file (required)
+ * @param insets Nine-slice borders (required)
+ * @return PK_OK on success, PK_ERROR_NOT_FOUND if the file cannot be loaded
+ */
+PkError skin_atlas_add_bmp(SkinAtlas* atlas, const char* name, const char* path,
+                           const SkinInsets* insets);
+
+/**
+ * Generate a rounded, gradient-filled, shadowed region and pack it.
+ *
+ * @param atlas Skin atlas (required)
+ * @param name Region name (required, copied)
+ * @param style Appearance parameters (required)
+ * @return PK_OK on success, error code on failure
+ */
+PkError skin_atlas_add_generated(SkinAtlas* atlas, const char* name, const SkinStyle* style);
+
+/**
+ * Populate the atlas with the built-in skin.
+ *
+ * @param atlas Skin atlas (required)
+ * @return PK_OK on success, error code on failure
+ * @note Provides button.{normal,hovered,pressed,disabled} and panel.normal
+ */
+PkError skin_atlas_load_builtin(SkinAtlas* atlas);
+
+/**
+ * Populate the atlas from a directory of BMP files.
+ *
+ * Looks for <class>_<state>.bmp (e.g. button_pressed.bmp) for the same
+ * regions the built-in skin provides. Missing files are skipped.
+ *
+ * @param atlas Skin atlas (required)
+ * @param directory Directory containing the images (required)
+ * @param slice Nine-slice inset applied to every side of every image
+ * @return PK_OK if at least one region was loaded, error code otherwise
+ */
+PkError skin_atlas_load_directory(SkinAtlas* atlas, const char* directory, int slice);
+
+/**
+ * Populate the atlas from BMP images in an asset bundle.
+ *
+ * Looks for <prefix>/<class>_<state>.bmp, as skin_atlas_load_directory()
+ * does on disk. Stored entries are decoded straight from the mapping.
+ *
+ * @param atlas Skin atlas (required)
+ * @param bundle Asset bundle (required)
+ * @param prefix Directory within the bundle, e.g. "skins" ("" for the root)
+ * @param slice Nine-slice inset applied to every side of every image
+ * @return PK_OK if at least one region was loaded, error code otherwise
+ */
+PkError skin_atlas_load_bundle(SkinAtlas* atlas, AssetBundle* bundle, const char* prefix,
+                               int slice);
+
+/**
+ * Populate the atlas from a ui.skin.source value: "builtin",
+ * "bundle:<prefix>" or a directory.
+ *
+ * @param atlas Skin atlas (required)
+ * @param source Skin source (required)
+ * @param slice Nine-slice inset for image skins
+ * @param bundle Asset bundle for "bundle:" sources (can be NULL)
+ * @return PK_OK on success, error code otherwise
+ */
+PkError skin_atlas_load_source(SkinAtlas* atlas, const char* source, int slice,
+                               AssetBundle* bundle);
+
+// Lookup and drawing
+
+/**
+ * Find a region by name.
+ *
+ * @param atlas Skin atlas (can be NULL)
+ * @param name Region name (required)
+ * @return Region (owned by atlas) or NULL if not present
+ */
+const SkinRegion* skin_atlas_find(const SkinAtlas* atlas, const char* name);
+
+/**
+ * Find the region for a widget class in a given state.
+ *
+ * @param atlas Skin atlas (can be NULL)
+ * @param skin_class Widget class, e.g. "button" (required)
+ * @param state State name, e.g. "pressed" (required)
+ * @return "<class>.<state>", falling back to "<class>.normal", or NULL
+ */
+const SkinRegion* skin_atlas_find_state(const SkinAtlas* atlas, const char* skin_class,
+                                        const char* state);
+
+/**
+ * Get the atlas surface regions are packed into.
+ *
+ * @param atlas Skin atlas (can be NULL)
+ * @return ARGB8888 surface (owned by atlas, read-only) or NULL
+ */
+const SDL_Surface* skin_atlas_get_surface(const SkinAtlas* atlas);
+
+/**
+ * Record a region stretched over a destination rectangle.
+ *
+ * @param list Display list to record into (required)
+ * @param atlas Skin atlas the region belongs to (required)
+ * @param region Region to draw (required)
+ * @param dst Destination rectangle (required)
+ * @return 0 on success, -1 on failure with SDL_GetError() set
+ * @note Borders shrink proportionally when dst is smaller than the insets
+ */
+int skin_atlas_draw(DisplayList* list, SkinAtlas* atlas, const SkinRegion* region,
+                    const SDL_Rect* dst);
+
+/**
+ * @note Thread Safety: Build the atlas on one thread before drawing from
+ *       it. Drawing only records into a display list and may be done by
+ *       the update thread while the render thread executes older lists.
+ */
+
+#endif /* PANELKIT_SKIN_ATLAS_H */
@@ -0,0 +1,63 @@
+/**
+ * @file yuv_frame.c
+ * @brief Reference-counted planar YUV 4:2:0 frames
+ */
+
+#include "yuv_frame.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include <stdlib.h>
+
+YuvFrame* yuv_frame_create(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "yuv_frame_create: invalid size %dx%d", width, height);
+        return NULL;
+    }
+
+    width = (width + 1) & ~1;
+    height = (height + 1) & ~1;
+
+    size_t luma = (size_t)width * (size_t)height;
+    size_t chroma = luma / 4;
+
+    /* Header and all three planes in one allocation */
+    YuvFrame* frame = malloc(sizeof(YuvFrame) + luma + chroma * 2);
+    if (!frame) {
+        log_error("Failed to allocate %dx%d YUV frame", width, height);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "yuv_frame_create: Failed to allocate %zu bytes",
+            sizeof(YuvFrame) + luma + chroma * 2);
+        return NULL;
+    }
+
+    uint8_t* pixels = (uint8_t*)(frame + 1);
+    frame->width = width;
+    frame->height = height;
+    frame->planes[0] = pixels;
+    frame->planes[1] = pixels + luma;
+    frame->planes[2] = pixels + luma + chroma;
+    frame->pitches[0] = width;
+    frame->pitches[1] = width / 2;
+    frame->pitches[2] = width / 2;
+    frame->sequence = 0;
+    atomic_init(&frame->refcount, 1);
+
+    return frame;
+}
+
+void yuv_frame_retain(YuvFrame* frame) {
+    if (frame) {
+        atomic_fetch_add_explicit(&frame->refcount, 1, memory_order_relaxed);
+    }
+}
+
+void yuv_frame_release(YuvFrame* frame) {
+    if (frame && atomic_fetch_sub_explicit(&frame->refcount, 1, memory_order_acq_rel) == 1) {
+        free(frame);
+    }
+}
+
+int yuv_frame_is_exclusive(YuvFrame* frame) {
+    return atomic_load_explicit(&frame->refcount, memory_order_acquire) == 1;
+}
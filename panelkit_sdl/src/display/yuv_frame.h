@@ -0,0 +1,65 @@
+/**
+ * @file yuv_frame.h
+ * @brief Reference-counted planar YUV 4:2:0 frames
+ *
+ * Video producers decode directly into a YuvFrame's planes. The frame is
+ * then recorded into a display list by reference (no copy) and uploaded
+ * to a streaming texture on the render thread. A producer may reuse a
+ * frame once it holds the only reference again.
+ */
+
+#ifndef PANELKIT_YUV_FRAME_H
+#define PANELKIT_YUV_FRAME_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * Planar I420 frame (Y plane, then U and V at half resolution).
+ */
+typedef struct YuvFrame {
+    int width;                  /**< Luma width in pixels (even) */
+    int height;                 /**< Luma height in pixels (even) */
+    uint8_t* planes[3];         /**< Y, U, V plane pointers */
+    int pitches[3];             /**< Bytes per row of each plane */
+    uint64_t sequence;          /**< Bumped by the producer on every new picture */
+    atomic_int refcount;
+} YuvFrame;
+
+/**
+ * Allocate a frame.
+ *
+ * @param width Frame width (rounded up to even)
+ * @param height Frame height (rounded up to even)
+ * @return New frame with one reference, or NULL on error
+ */
+YuvFrame* yuv_frame_create(int width, int height);
+
+/**
+ * Take a reference to a frame.
+ *
+ * @param frame Frame to retain (can be NULL)
+ */
+void yuv_frame_retain(YuvFrame* frame);
+
+/**
+ * Drop a reference; frees the frame on the last one.
+ *
+ * @param frame Frame to release (can be NULL)
+ */
+void yuv_frame_release(YuvFrame* frame);
+
+/**
+ * Check whether the caller holds the only reference.
+ *
+ * @param frame Frame to check (required)
+ * @return Non-zero if the frame may be written to
+ */
+int yuv_frame_is_exclusive(YuvFrame* frame);
+
+/**
+ * @note Thread Safety: Reference counting is atomic. Plane contents must
+ *       only be written while the writer holds the only reference.
+ */
+
+#endif /* PANELKIT_YUV_FRAME_H */
@@ -4,7 +4,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <time.h>
 #include "core/logger.h"
 #include "core/error.h"
 
@@ -12,6 +14,10 @@
 #define INITIAL_SUBSCRIPTIONS_CAPACITY 32
 #define INITIAL_EVENTS_CAPACITY 16
 #define MAX_SUBSCRIPTIONS_PER_EVENT 100  // Phase 3: Prevent runaway subscriptions
+#define MAX_PRIORITY_RULES 32
+#define MAX_QUEUED_EVENTS_PER_PRIORITY 1024
+#define DEFAULT_LOW_BUDGET_US 2000
+#define DEFAULT_MAX_DEFER_MS 100
 
 // Subscription entry - maps handler+context to an event
 typedef struct {
@@ -21,12 +27,22 @@ typedef struct {
     bool owns_context;  // True if context should be freed on unsubscribe
 } Subscription;
 
-// Event data for deferred/queued events (future enhancement)
+// Priority class for an event name or name prefix
 typedef struct {
+    char pattern[MAX_EVENT_NAME_LENGTH];  // Without the trailing '*'
+    bool prefix;
+    EventPriority priority;
+} PriorityRule;
+
+// Event waiting for event_dispatch_pending, payload copied inline
+typedef struct QueuedEvent {
+    struct QueuedEvent* next;
     char event_name[MAX_EVENT_NAME_LENGTH];
-    void* data;
+    uint64_t sequence;
+    uint64_t posted_ns;
     size_t data_size;
-} EventData;
+    unsigned char data[];
+} QueuedEvent;
 
 // Main event system structure
 struct EventSystem {
@@ -38,10 +54,33 @@ struct EventSystem {
     size_t num_subscriptions;
     size_t subscription_capacity;
     
-    // Statistics
-    size_t total_events_published;
+    // Statistics (updated under the read lock, hence atomic)
+    atomic_size_t total_events_published;
+    
+    // Debugging observer; changed under the write lock, called under the read lock
+    event_tap_func tap;
+    void* tap_context;
+    
+    // Priority classes (under the rwlock, read when events are posted)
+    PriorityRule priority_rules[MAX_PRIORITY_RULES];
+    size_t num_priority_rules;
+    
+    // Queued events, one FIFO per priority class
+    pthread_mutex_t queue_lock;
+    QueuedEvent* queue_head[EVENT_PRIORITY_COUNT];
+    QueuedEvent* queue_tail[EVENT_PRIORITY_COUNT];
+    uint64_t next_sequence;
+    uint32_t low_budget_us;
+    uint32_t max_defer_ms;
+    EventQueueStats queue_stats;
 };
 
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 EventSystem* event_system_create(void) {
     EventSystem* system = calloc(1, sizeof(EventSystem));
     if (!system) {
@@ -73,6 +112,26 @@ EventSystem* event_system_create(void) {
     }
     system->subscription_capacity = INITIAL_SUBSCRIPTIONS_CAPACITY;
     
+    if (pthread_mutex_init(&system->queue_lock, NULL) != 0) {
+        log_error("Failed to initialize event queue lock");
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                                       "pthread_mutex_init failed");
+        free(system->subscriptions);
+        pthread_rwlock_destroy(&system->lock);
+        free(system);
+        return NULL;
+    }
+    system->low_budget_us = DEFAULT_LOW_BUDGET_US;
+    system->max_defer_ms = DEFAULT_MAX_DEFER_MS;
+    
+    // Default classes: touch handling never waits behind data refreshes
+    event_set_priority(system, "input.*", EVENT_PRIORITY_HIGH);
+    event_set_priority(system, "ui.*", EVENT_PRIORITY_HIGH);
+    event_set_priority(system, "app.page_transition", EVENT_PRIORITY_HIGH);
+    event_set_priority(system, "api.*", EVENT_PRIORITY_LOW);
+    event_set_priority(system, "weather.*", EVENT_PRIORITY_LOW);
+    event_set_priority(system, "telemetry.*", EVENT_PRIORITY_LOW);
+    
     log_info("Event system created with capacity for %zu subscriptions", 
              system->subscription_capacity);
     return system;
@@ -96,8 +155,24 @@ void event_system_destroy(EventSystem* system) {
     pthread_rwlock_unlock(&system->lock);
     pthread_rwlock_destroy(&system->lock);
     
+    // Undelivered events are dropped
+    size_t undelivered = 0;
+    for (int p = 0; p < EVENT_PRIORITY_COUNT; p++) {
+        QueuedEvent* event = system->queue_head[p];
+        while (event) {
+            QueuedEvent* next = event->next;
+            free(event);
+            event = next;
+            undelivered++;
+        }
+    }
+    pthread_mutex_destroy(&system->queue_lock);
+    if (undelivered > 0) {
+        log_debug("Dropped %zu queued events", undelivered);
+    }
+    
     log_debug("Event system destroyed after %zu total events", 
-              system->total_events_published);
+              atomic_load(&system->total_events_published));
     free(system);
 }
 
@@ -169,11 +244,12 @@ static bool event_subscribe_internal(EventSystem* system,
     sub->owns_context = owns_context;
     
     system->num_subscriptions++;
+    size_t total_subscriptions = system->num_subscriptions;
     
     pthread_rwlock_unlock(&system->lock);
     
     log_debug("Subscribed handler %p to event '%s' (total subs: %zu, owns_context: %s)", 
-              (void*)handler, event_name, system->num_subscriptions,
+              (void*)handler, event_name, total_subscriptions,
               owns_context ? "true" : "false");
     return true;
 }
@@ -186,9 +262,10 @@ bool event_subscribe(EventSystem* system,
     return event_subscribe_internal(system, event_name, handler, context, false);
 }
 
-bool event_unsubscribe(EventSystem* system, 
-                       const char* event_name,
-                       event_handler_func handler) {
+// Remove the first subscription matching handler (and context if asked)
+static bool unsubscribe_matching(EventSystem* system, const char* event_name,
+                                 event_handler_func handler, void* context,
+                                 bool match_context) {
     PK_CHECK_FALSE_WITH_CONTEXT(system != NULL, PK_ERROR_NULL_PARAM,
                                 "system is NULL");
     PK_CHECK_FALSE_WITH_CONTEXT(event_name != NULL, PK_ERROR_NULL_PARAM,
@@ -201,7 +278,8 @@ bool event_unsubscribe(EventSystem* system,
     // Find and remove first matching subscription
     for (size_t i = 0; i < system->num_subscriptions; i++) {
         Subscription* sub = &system->subscriptions[i];
-        if (strcmp(sub->event_name, event_name) == 0 && sub->handler == handler) {
+        if (strcmp(sub->event_name, event_name) == 0 && sub->handler == handler &&
+            (!match_context || sub->context == context)) {
             // Free owned context if needed (Pattern 1: Parent Owns Child)
             if (sub->owns_context && sub->context) {
                 free(sub->context);
@@ -228,6 +306,19 @@ bool event_unsubscribe(EventSystem* system,
     return false;
 }
 
+bool event_unsubscribe(EventSystem* system, 
+                       const char* event_name,
+                       event_handler_func handler) {
+    return unsubscribe_matching(system, event_name, handler, NULL, false);
+}
+
+bool event_unsubscribe_context(EventSystem* system,
+                               const char* event_name,
+                               event_handler_func handler,
+                               void* context) {
+    return unsubscribe_matching(system, event_name, handler, context, true);
+}
+
 bool event_unsubscribe_all(EventSystem* system, const char* event_name) {
     if (!system || !event_name) {
         return false;
@@ -290,6 +381,11 @@ PkError event_emit(EventSystem* system,
     
     pthread_rwlock_rdlock(&system->lock);
     
+    // An attached tap sees every event, including those nobody handles
+    if (system->tap) {
+        system->tap(event_name, data, data_size, system->tap_context);
+    }
+    
     // Count matching subscriptions first
     size_t match_count = 0;
     for (size_t i = 0; i < system->num_subscriptions; i++) {
@@ -323,7 +419,7 @@ PkError event_emit(EventSystem* system,
     }
     
     // Update statistics while we have the lock
-    ((EventSystem*)system)->total_events_published++;
+    atomic_fetch_add(&system->total_events_published, 1);
     
     pthread_rwlock_unlock(&system->lock);
     
@@ -361,6 +457,278 @@ bool event_publish(EventSystem* system,
     return event_emit(system, event_name, data, data_size) == PK_OK;
 }
 
+// Observer called by event_emit before any handler
+void event_system_set_tap(EventSystem* system, event_tap_func tap, void* context) {
+    if (!system) {
+        return;
+    }
+    
+    // Taking the write lock waits out emits still inside the old tap
+    pthread_rwlock_wrlock(&system->lock);
+    system->tap = tap;
+    system->tap_context = context;
+    pthread_rwlock_unlock(&system->lock);
+}
+
+// ============================================================================
+// Priorities and Queued Dispatch
+// ============================================================================
+
+bool event_set_priority(EventSystem* system, const char* pattern, EventPriority priority) {
+    PK_CHECK_FALSE_WITH_CONTEXT(system != NULL, PK_ERROR_NULL_PARAM,
+                                "system is NULL");
+    PK_CHECK_FALSE_WITH_CONTEXT(pattern != NULL, PK_ERROR_NULL_PARAM,
+                                "pattern is NULL");
+    PK_CHECK_FALSE_WITH_CONTEXT(priority >= EVENT_PRIORITY_HIGH &&
+                                priority < EVENT_PRIORITY_COUNT,
+                                PK_ERROR_INVALID_PARAM,
+                                "Invalid priority %d for '%s'", (int)priority, pattern);
+    
+    size_t length = strlen(pattern);
+    bool prefix = length > 0 && pattern[length - 1] == '*';
+    if (prefix) {
+        length--;
+    }
+    if (length == 0 || length >= MAX_EVENT_NAME_LENGTH) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+                                       "Invalid event priority pattern '%s'", pattern);
+        return false;
+    }
+    
+    pthread_rwlock_wrlock(&system->lock);
+    
+    // Replace an existing rule for the same pattern
+    PriorityRule* rule = NULL;
+    for (size_t i = 0; i < system->num_priority_rules; i++) {
+        PriorityRule* candidate = &system->priority_rules[i];
+        if (candidate->prefix == prefix && strlen(candidate->pattern) == length &&
+            strncmp(candidate->pattern, pattern, length) == 0) {
+            rule = candidate;
+            break;
+        }
+    }
+    if (!rule) {
+        if (system->num_priority_rules >= MAX_PRIORITY_RULES) {
+            pthread_rwlock_unlock(&system->lock);
+            pk_set_last_error_with_context(PK_ERROR_RESOURCE_LIMIT,
+                                           "Event priority rules full (%d), cannot add '%s'",
+                                           MAX_PRIORITY_RULES, pattern);
+            return false;
+        }
+        rule = &system->priority_rules[system->num_priority_rules++];
+        memcpy(rule->pattern, pattern, length);
+        rule->pattern[length] = '\0';
+        rule->prefix = prefix;
+    }
+    rule->priority = priority;
+    
+    pthread_rwlock_unlock(&system->lock);
+    
+    log_debug("Event priority: '%s' -> %d", pattern, (int)priority);
+    return true;
+}
+
+// Resolve under the read lock: exact name first, then the longest prefix
+static EventPriority lookup_priority(EventSystem* system, const char* event_name) {
+    EventPriority priority = EVENT_PRIORITY_NORMAL;
+    size_t best = 0;
+    
+    for (size_t i = 0; i < system->num_priority_rules; i++) {
+        const PriorityRule* rule = &system->priority_rules[i];
+        if (!rule->prefix) {
+            if (strcmp(rule->pattern, event_name) == 0) {
+                return rule->priority;
+            }
+            continue;
+        }
+        size_t length = strlen(rule->pattern);
+        if (length > best && strncmp(rule->pattern, event_name, length) == 0) {
+            priority = rule->priority;
+            best = length;
+        }
+    }
+    return priority;
+}
+
+EventPriority event_get_priority(EventSystem* system, const char* event_name) {
+    if (!system || !event_name) {
+        return EVENT_PRIORITY_NORMAL;
+    }
+    
+    pthread_rwlock_rdlock(&system->lock);
+    EventPriority priority = lookup_priority(system, event_name);
+    pthread_rwlock_unlock(&system->lock);
+    return priority;
+}
+
+PkError event_post(EventSystem* system,
+                   const char* event_name,
+                   const void* data,
+                   size_t data_size) {
+    if (!system || !event_name || strlen(event_name) >= MAX_EVENT_NAME_LENGTH) {
+        log_error("Invalid parameters for event post");
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+                                       "event_post: system=%p, event_name=%s, name_len=%zu",
+                                       system, event_name ? event_name : "NULL",
+                                       event_name ? strlen(event_name) : 0);
+        return PK_ERROR_INVALID_PARAM;
+    }
+    if (data_size > 0 && !data) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+                                       "event_post: data_size=%zu but data is NULL",
+                                       data_size);
+        return PK_ERROR_INVALID_PARAM;
+    }
+    
+    EventPriority priority = event_get_priority(system, event_name);
+    
+    QueuedEvent* event = malloc(sizeof(QueuedEvent) + data_size);
+    if (!event) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to queue event '%s' (%zu bytes)",
+                                       event_name, data_size);
+        return PK_ERROR_OUT_OF_MEMORY;
+    }
+    event->next = NULL;
+    strcpy(event->event_name, event_name);
+    event->data_size = data_size;
+    if (data_size > 0) {
+        memcpy(event->data, data, data_size);
+    }
+    
+    pthread_mutex_lock(&system->queue_lock);
+    
+    if (system->queue_stats.pending[priority] >= MAX_QUEUED_EVENTS_PER_PRIORITY) {
+        system->queue_stats.dropped[priority]++;
+        pthread_mutex_unlock(&system->queue_lock);
+        free(event);
+        pk_set_last_error_with_context(PK_ERROR_EVENT_QUEUE_FULL,
+                                       "Event queue for priority %d full (%d), dropped '%s'",
+                                       (int)priority, MAX_QUEUED_EVENTS_PER_PRIORITY,
+                                       event_name);
+        return PK_ERROR_EVENT_QUEUE_FULL;
+    }
+    
+    event->sequence = system->next_sequence++;
+    event->posted_ns = monotonic_ns();
+    if (system->queue_tail[priority]) {
+        system->queue_tail[priority]->next = event;
+    } else {
+        system->queue_head[priority] = event;
+    }
+    system->queue_tail[priority] = event;
+    system->queue_stats.pending[priority]++;
+    system->queue_stats.posted[priority]++;
+    
+    pthread_mutex_unlock(&system->queue_lock);
+    return PK_OK;
+}
+
+void event_set_dispatch_budget(EventSystem* system, uint32_t low_budget_us,
+                               uint32_t max_defer_ms) {
+    if (!system) {
+        return;
+    }
+    
+    pthread_mutex_lock(&system->queue_lock);
+    system->low_budget_us = low_budget_us;
+    system->max_defer_ms = max_defer_ms;
+    pthread_mutex_unlock(&system->queue_lock);
+}
+
+size_t event_dispatch_pending(EventSystem* system) {
+    if (!system) {
+        return 0;
+    }
+    
+    // Events posted from here on (including by the handlers we call) wait
+    // for the next dispatch, so a handler re-posting cannot spin us forever
+    pthread_mutex_lock(&system->queue_lock);
+    uint64_t horizon = system->next_sequence;
+    uint64_t budget_ns = (uint64_t)system->low_budget_us * 1000ULL;
+    uint64_t max_defer_ns = (uint64_t)system->max_defer_ms * 1000000ULL;
+    pthread_mutex_unlock(&system->queue_lock);
+    
+    size_t delivered = 0;
+    size_t low_delivered = 0;
+    uint64_t low_ns = 0;
+    
+    for (;;) {
+        pthread_mutex_lock(&system->queue_lock);
+        
+        // Highest class with an eligible event; each class is FIFO, so its
+        // head is also its oldest
+        int priority = EVENT_PRIORITY_HIGH;
+        for (; priority < EVENT_PRIORITY_COUNT; priority++) {
+            QueuedEvent* head = system->queue_head[priority];
+            if (head && head->sequence < horizon) {
+                break;
+            }
+        }
+        if (priority == EVENT_PRIORITY_COUNT) {
+            pthread_mutex_unlock(&system->queue_lock);
+            break;
+        }
+        
+        QueuedEvent* event = system->queue_head[priority];
+        uint64_t now = monotonic_ns();
+        bool forced = false;
+        
+        // Low events stop at the budget, except the first one of each
+        // dispatch. A backlog that has waited max_defer_ms may run on into
+        // a second budget: it drains faster without making any one frame
+        // pay for all of it.
+        if (priority == EVENT_PRIORITY_LOW && budget_ns > 0 && low_delivered > 0 &&
+            low_ns >= budget_ns) {
+            bool aged = max_defer_ns > 0 && now - event->posted_ns >= max_defer_ns;
+            if (!aged || low_ns >= 2 * budget_ns) {
+                system->queue_stats.deferrals++;
+                pthread_mutex_unlock(&system->queue_lock);
+                break;
+            }
+            forced = true;
+        }
+        
+        system->queue_head[priority] = event->next;
+        if (!event->next) {
+            system->queue_tail[priority] = NULL;
+        }
+        system->queue_stats.pending[priority]--;
+        system->queue_stats.dispatched[priority]++;
+        uint64_t wait_us = (now - event->posted_ns) / 1000;
+        if (wait_us > system->queue_stats.max_wait_us[priority]) {
+            system->queue_stats.max_wait_us[priority] = wait_us;
+        }
+        if (forced) {
+            system->queue_stats.forced++;
+        }
+        
+        pthread_mutex_unlock(&system->queue_lock);
+        
+        event_emit(system, event->event_name, event->data_size > 0 ? event->data : NULL,
+                   event->data_size);
+        free(event);
+        delivered++;
+        
+        if (priority == EVENT_PRIORITY_LOW) {
+            low_delivered++;
+            low_ns += monotonic_ns() - now;
+        }
+    }
+    
+    return delivered;
+}
+
+void event_system_get_queue_stats(EventSystem* system, EventQueueStats* stats) {
+    if (!system || !stats) {
+        return;
+    }
+    
+    pthread_mutex_lock(&system->queue_lock);
+    *stats = system->queue_stats;
+    pthread_mutex_unlock(&system->queue_lock);
+}
+
 // Statistics functions
 size_t event_system_get_subscription_count(EventSystem* system) {
     if (!system) {
@@ -545,11 +913,19 @@ bool event_subscribe_api_refresh_requested(EventSystem* system, api_refresh_requ
 // API State Changed Event
 IMPLEMENT_TYPED_PUBLISH(api_state_changed, "api.state_changed", ApiStateChangeData)
 
+bool event_post_api_state_changed(EventSystem* system, const ApiStateChangeData* data) {
+    return event_post(system, "api.state_changed", data, sizeof(ApiStateChangeData)) == PK_OK;
+}
+
 // API User Data Updated Event
 bool event_publish_api_user_data_updated(EventSystem* system, const void* user_data, size_t size) {
     return event_publish(system, "api.user_data_updated", user_data, size);
 }
 
+bool event_post_api_user_data_updated(EventSystem* system, const void* user_data, size_t size) {
+    return event_post(system, "api.user_data_updated", user_data, size) == PK_OK;
+}
+
 // API Refresh Event
 IMPLEMENT_TYPED_PUBLISH(api_refresh, "system.api_refresh", ApiRefreshData)
 
@@ -562,5 +938,12 @@ bool event_publish_weather_request(EventSystem* system, const char* location) {
 IMPLEMENT_TYPED_PUBLISH(touch_down, "input.touch_down", TouchEventData)
 IMPLEMENT_TYPED_PUBLISH(touch_up, "input.touch_up", TouchEventData)
 
+// State Changed Event
+IMPLEMENT_TYPED_PUBLISH(state_changed, "state.changed", StateChangedEventData)
+
+bool event_post_state_changed(EventSystem* system, const StateChangedEventData* data) {
+    return event_post(system, "state.changed", data, sizeof(StateChangedEventData)) == PK_OK;
+}
+
 // Note: Additional subscribe/unsubscribe implementations would follow the same pattern
 // For brevity, showing the key ones that are actually used in the codebase
\ No newline at end of file
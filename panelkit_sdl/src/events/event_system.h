@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include "../core/error.h"
 
 /** Opaque event system handle */
@@ -21,6 +22,48 @@ typedef void (*event_handler_func)(const char* event_name,
                                   size_t data_size,
                                   void* context);
 
+/**
+ * Observer of every emitted event (see event_system_set_tap).
+ * 
+ * @param event_name Name of the event (borrowed reference)
+ * @param data Event data payload (borrowed, only valid during the call)
+ * @param data_size Size of the data payload in bytes
+ * @param context Context given to event_system_set_tap
+ * @note Runs on the emitting thread with the event system's read lock
+ *       held: it must not block and must not call into the event system
+ */
+typedef void (*event_tap_func)(const char* event_name,
+                               const void* data,
+                               size_t data_size,
+                               void* context);
+
+/**
+ * Priority class of an event type, used by queued dispatch.
+ *
+ * High events (input, page transitions) are dispatched first and in full.
+ * Normal events follow. Low events (data refreshes, telemetry) share a
+ * per-frame time budget; whatever does not fit waits for the next frame.
+ */
+typedef enum {
+    EVENT_PRIORITY_HIGH = 0,
+    EVENT_PRIORITY_NORMAL,
+    EVENT_PRIORITY_LOW,
+    EVENT_PRIORITY_COUNT
+} EventPriority;
+
+/**
+ * Queued dispatch statistics, per priority class where indexed.
+ */
+typedef struct {
+    size_t pending[EVENT_PRIORITY_COUNT];      /**< Events waiting now */
+    uint64_t posted[EVENT_PRIORITY_COUNT];     /**< Events queued */
+    uint64_t dispatched[EVENT_PRIORITY_COUNT]; /**< Events delivered */
+    uint64_t dropped[EVENT_PRIORITY_COUNT];    /**< Events refused (queue full) */
+    uint64_t max_wait_us[EVENT_PRIORITY_COUNT]; /**< Longest time an event waited */
+    uint64_t deferrals;                        /**< Dispatches that left low events for later */
+    uint64_t forced;                           /**< Aged low events delivered over budget */
+} EventQueueStats;
+
 // Event system lifecycle
 
 /**
@@ -67,6 +110,86 @@ bool event_publish(EventSystem* system,
                    const void* data, 
                    size_t data_size);
 
+// Priorities and queued dispatch
+
+/**
+ * Set the priority class of an event type.
+ * 
+ * @param system Event system (required)
+ * @param pattern Event name, or a prefix ending in '*' ("api.*") (required)
+ * @param priority Priority class for matching events
+ * @return true on success, false on error
+ * @note An exact name beats a prefix; a longer prefix beats a shorter one.
+ *       Unmatched events are normal. Created systems already class
+ *       "input.*", "ui.*" and "app.page_transition" high and "api.*",
+ *       "weather.*" and "telemetry.*" low.
+ */
+bool event_set_priority(EventSystem* system, const char* pattern, EventPriority priority);
+
+/**
+ * Get the priority class an event name resolves to.
+ * 
+ * @param system Event system (required)
+ * @param event_name Event identifier (required)
+ * @return Priority class (normal if unmatched or on error)
+ */
+EventPriority event_get_priority(EventSystem* system, const char* event_name);
+
+/**
+ * Queue an event for the next event_dispatch_pending().
+ * 
+ * @param system Event system (required)
+ * @param event_name Event identifier (required)
+ * @param data Event data payload (can be NULL)
+ * @param data_size Size of data in bytes (0 if data is NULL)
+ * @return PK_OK on success, PK_ERROR_EVENT_QUEUE_FULL if the event's
+ *         class already holds its limit, other error code on failure
+ * @note Data is copied internally - caller can free after return
+ * @note Handlers run on the dispatching thread, not the caller's; use this
+ *       from worker threads and for events that may wait a frame
+ */
+PkError event_post(EventSystem* system,
+                   const char* event_name,
+                   const void* data,
+                   size_t data_size);
+
+/**
+ * Set the per-frame budget for low-priority events.
+ * 
+ * @param system Event system (required)
+ * @param low_budget_us Time low events may take per dispatch (0 = unlimited)
+ * @param max_defer_ms Age after which low events may use a second budget
+ *                     to catch up (0 = never)
+ */
+void event_set_dispatch_budget(EventSystem* system, uint32_t low_budget_us,
+                               uint32_t max_defer_ms);
+
+/**
+ * Deliver queued events: every high event, then every normal event, then
+ * low events until the budget is spent.
+ * 
+ * @param system Event system (required)
+ * @return Number of events delivered
+ * @note Call once per frame from the thread that owns the handlers. Events
+ *       posted during the call (by handlers or other threads) wait for the
+ *       next one.
+ * @note Starvation: the low budget is spent on low events only, so no
+ *       amount of high or normal traffic crowds them out; at least one low
+ *       event goes out per call; and while the oldest has waited
+ *       max_defer_ms, low events may run to twice the budget. A frame
+ *       therefore never spends more than two budgets (plus one handler)
+ *       on low events.
+ */
+size_t event_dispatch_pending(EventSystem* system);
+
+/**
+ * Get queued dispatch statistics.
+ * 
+ * @param system Event system (required)
+ * @param stats Output statistics snapshot (required)
+ */
+void event_system_get_queue_stats(EventSystem* system, EventQueueStats* stats);
+
 // Subscription management
 
 /**
@@ -98,6 +221,22 @@ bool event_unsubscribe(EventSystem* system,
                        const char* event_name,
                        event_handler_func handler);
 
+/**
+ * Unsubscribe one subscriber's handler from an event.
+ * 
+ * @param system Event system (required)
+ * @param event_name Event identifier (required)
+ * @param handler Handler to remove (required)
+ * @param context Context the handler was subscribed with
+ * @return true if found and removed, false otherwise
+ * @note Use when several subscribers share a handler (e.g. widgets of
+ *       different displays on one event system)
+ */
+bool event_unsubscribe_context(EventSystem* system,
+                               const char* event_name,
+                               event_handler_func handler,
+                               void* context);
+
 /**
  * Unsubscribe all handlers from an event.
  * 
@@ -109,6 +248,18 @@ bool event_unsubscribe_all(EventSystem* system, const char* event_name);
 
 // Statistics and debugging
 
+/**
+ * Attach or detach an observer that sees every emitted event, subscribed
+ * or not, before its handlers run.
+ * 
+ * @param system Event system (required)
+ * @param tap Observer, or NULL to detach
+ * @param context Passed to the observer
+ * @note Once this returns with NULL, no call to the previous observer is
+ *       still running. With nothing attached, emitting costs one branch.
+ */
+void event_system_set_tap(EventSystem* system, event_tap_func tap, void* context);
+
 /**
  * Get total number of active subscriptions.
  * 
@@ -138,7 +289,8 @@ bool event_system_has_subscribers(EventSystem* system, const char* event_name);
 /**
  * @note Thread Safety: All functions are thread-safe.
  *       The event system uses internal locking to ensure safe
- *       concurrent access from multiple threads.
+ *       concurrent access from multiple threads. event_dispatch_pending
+ *       should only be called from one thread.
  */
 
 #endif // EVENT_SYSTEM_H
\ No newline at end of file
@@ -26,6 +26,7 @@ typedef void (*api_refresh_handler)(const ApiRefreshData* data, void* context);
 typedef void (*weather_request_handler)(const char* location, void* context);
 typedef void (*touch_down_handler)(const TouchEventData* data, void* context);
 typedef void (*touch_up_handler)(const TouchEventData* data, void* context);
+typedef void (*state_changed_handler)(const StateChangedEventData* data, void* context);
 
 // Typed publish functions
 bool event_publish_button_pressed(EventSystem* system, const ButtonEventData* data);
@@ -38,6 +39,12 @@ bool event_publish_api_refresh(EventSystem* system, const ApiRefreshData* data);
 bool event_publish_weather_request(EventSystem* system, const char* location);
 bool event_publish_touch_down(EventSystem* system, const TouchEventData* data);
 bool event_publish_touch_up(EventSystem* system, const TouchEventData* data);
+bool event_publish_state_changed(EventSystem* system, const StateChangedEventData* data);
+
+// Typed post functions (queued for the next dispatch; see event_post)
+bool event_post_api_state_changed(EventSystem* system, const ApiStateChangeData* data);
+bool event_post_api_user_data_updated(EventSystem* system, const void* user_data, size_t size);
+bool event_post_state_changed(EventSystem* system, const StateChangedEventData* data);
 
 // Typed subscribe functions
 bool event_subscribe_button_pressed(EventSystem* system, button_pressed_handler handler, void* context);
@@ -0,0 +1,464 @@
+/**
+ * @file event_tap.c
+ * @brief Unix-socket event tap: filtered binary records drained by a server thread
+ */
+
+#include "event_tap.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include "../core/realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define TAP_RING_BYTES (256 * 1024)
+#define TAP_DRAIN_INTERVAL_MS 20
+#define TAP_HANDSHAKE_TIMEOUT_MS 2000
+#define TAP_SEND_TIMEOUT_MS 2000
+#define TAP_FILTER_LINE 1024
+
+typedef struct {
+    char pattern[64];               /* Without the trailing '*' */
+    size_t length;
+    bool prefix;
+} TapFilter;
+
+struct EventTap {
+    EventSystem* events;
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    int listen_fd;
+    int client_fd;
+    int wake_pipe[2];
+    pthread_t thread;
+    bool thread_started;
+    atomic_bool running;
+
+    /* The connected client's filters; only changed while detached */
+    TapFilter filters[EVENT_TAP_MAX_FILTERS];
+    int filter_count;
+
+    /* Records waiting to be sent; head and tail only grow */
+    pthread_mutex_t ring_lock;
+    uint8_t* ring;
+    uint64_t head;
+    uint64_t tail;
+    uint32_t sequence;
+    uint32_t dropped_since_record;
+
+    /* Drain buffer (server thread only) */
+    uint8_t* out;
+
+    EventTapStats stats;            /* Under ring_lock */
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool filters_match(const EventTap* tap, const char* event_name) {
+    for (int i = 0; i < tap->filter_count; i++) {
+        const TapFilter* filter = &tap->filters[i];
+        if (filter->prefix ? strncmp(event_name, filter->pattern, filter->length) == 0
+                           : strcmp(event_name, filter->pattern) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ring_write(EventTap* tap, const void* data, size_t size) {
+    size_t offset = (size_t)(tap->head % TAP_RING_BYTES);
+    size_t first = size < TAP_RING_BYTES - offset ? size : TAP_RING_BYTES - offset;
+    memcpy(tap->ring + offset, data, first);
+    memcpy(tap->ring, (const uint8_t*)data + first, size - first);
+    tap->head += size;
+}
+
+/* Event system observer: runs on the emitting thread, must not block */
+static void tap_observe(const char* event_name, const void* data, size_t data_size,
+                        void* context) {
+    EventTap* tap = context;
+    if (!filters_match(tap, event_name)) {
+        return;
+    }
+
+    size_t name_length = strlen(event_name);
+    size_t captured = data_size < EVENT_TAP_MAX_CAPTURE ? data_size : EVENT_TAP_MAX_CAPTURE;
+    size_t total = sizeof(EventTapRecord) + name_length + captured;
+    EventTapRecord record = {
+        .magic = EVENT_TAP_MAGIC,
+        .timestamp_ns = monotonic_ns(),
+        .data_size = (uint32_t)data_size,
+        .name_length = (uint16_t)name_length,
+        .captured = (uint16_t)captured
+    };
+
+    pthread_mutex_lock(&tap->ring_lock);
+    if (TAP_RING_BYTES - (tap->head - tap->tail) < total) {
+        tap->dropped_since_record++;
+        tap->stats.dropped++;
+        pthread_mutex_unlock(&tap->ring_lock);
+        return;
+    }
+    record.sequence = tap->sequence++;
+    record.dropped = tap->dropped_since_record;
+    tap->dropped_since_record = 0;
+    ring_write(tap, &record, sizeof(record));
+    ring_write(tap, event_name, name_length);
+    if (captured > 0) {
+        ring_write(tap, data, captured);
+    }
+    tap->stats.events++;
+    pthread_mutex_unlock(&tap->ring_lock);
+}
+
+// Socket helpers
+
+static bool send_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static void set_socket_timeouts(int fd, int recv_ms, int send_ms) {
+    struct timeval tv = { recv_ms / 1000, (recv_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    tv = (struct timeval){ send_ms / 1000, (send_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+/* Read the filter line (SO_RCVTIMEO bounds it) */
+static bool read_filters(EventTap* tap, int fd) {
+    char line[TAP_FILTER_LINE];
+    size_t length = 0;
+    while (length < sizeof(line) - 1) {
+        ssize_t n = recv(fd, line + length, 1, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (line[length] == '\n') {
+            break;
+        }
+        length++;
+    }
+    line[length] = '\0';
+
+    tap->filter_count = 0;
+    char* save = NULL;
+    for (char* token = strtok_r(line, " \t\r", &save);
+         token && tap->filter_count < EVENT_TAP_MAX_FILTERS;
+         token = strtok_r(NULL, " \t\r", &save)) {
+        size_t token_length = strlen(token);
+        TapFilter* filter = &tap->filters[tap->filter_count];
+        filter->prefix = token[token_length - 1] == '*';
+        filter->length = filter->prefix ? token_length - 1 : token_length;
+        if (filter->length >= sizeof(filter->pattern)) {
+            log_warn("Event tap: filter '%s' too long, ignored", token);
+            continue;
+        }
+        memcpy(filter->pattern, token, filter->length);
+        filter->pattern[filter->length] = '\0';
+        tap->filter_count++;
+    }
+    return tap->filter_count > 0;
+}
+
+static void end_session(EventTap* tap, const char* reason) {
+    if (tap->client_fd < 0) {
+        return;
+    }
+
+    event_system_set_tap(tap->events, NULL, NULL);
+    close(tap->client_fd);
+    tap->client_fd = -1;
+
+    pthread_mutex_lock(&tap->ring_lock);
+    tap->stats.connected = false;
+    uint64_t events = tap->stats.events;
+    uint64_t dropped = tap->stats.dropped;
+    pthread_mutex_unlock(&tap->ring_lock);
+    log_info("Event tap client disconnected (%s); %llu events, %llu dropped in total",
+             reason, (unsigned long long)events, (unsigned long long)dropped);
+}
+
+static void accept_client(EventTap* tap) {
+    int fd = accept(tap->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    /* One client at a time: a new one replaces a forgotten session */
+    end_session(tap, "replaced by a new connection");
+
+    set_socket_timeouts(fd, TAP_HANDSHAKE_TIMEOUT_MS, TAP_SEND_TIMEOUT_MS);
+    if (!read_filters(tap, fd)) {
+        log_warn("Event tap: client sent no filters");
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&tap->ring_lock);
+    tap->head = 0;
+    tap->tail = 0;
+    tap->sequence = 0;
+    tap->dropped_since_record = 0;
+    tap->stats.sessions++;
+    tap->stats.connected = true;
+    pthread_mutex_unlock(&tap->ring_lock);
+
+    tap->client_fd = fd;
+    event_system_set_tap(tap->events, tap_observe, tap);
+    if (!send_all(fd, (const uint8_t*)EVENT_TAP_HELLO, strlen(EVENT_TAP_HELLO))) {
+        end_session(tap, "greeting failed");
+        return;
+    }
+    log_info("Event tap client connected (%d filter%s, first '%s%s')", tap->filter_count,
+             tap->filter_count == 1 ? "" : "s", tap->filters[0].pattern,
+             tap->filters[0].prefix ? "*" : "");
+}
+
+/* Send everything queued so far. Producers only write into free space,
+ * so [tail, head) is copied out without the lock and released afterwards;
+ * emitters only ever wait for the index updates. */
+static void drain_ring(EventTap* tap) {
+    for (;;) {
+        pthread_mutex_lock(&tap->ring_lock);
+        uint64_t tail = tap->tail;
+        size_t size = (size_t)(tap->head - tail);
+        pthread_mutex_unlock(&tap->ring_lock);
+
+        if (size == 0) {
+            return;
+        }
+        if (size > TAP_RING_BYTES / 4) {
+            size = TAP_RING_BYTES / 4;
+        }
+        size_t offset = (size_t)(tail % TAP_RING_BYTES);
+        size_t first = size < TAP_RING_BYTES - offset ? size : TAP_RING_BYTES - offset;
+        memcpy(tap->out, tap->ring + offset, first);
+        memcpy(tap->out + first, tap->ring, size - first);
+
+        pthread_mutex_lock(&tap->ring_lock);
+        tap->tail += size;
+        pthread_mutex_unlock(&tap->ring_lock);
+
+        if (!send_all(tap->client_fd, tap->out, size)) {
+            end_session(tap, errno == EAGAIN ? "client stopped reading" : strerror(errno));
+            return;
+        }
+        pthread_mutex_lock(&tap->ring_lock);
+        tap->stats.bytes_sent += size;
+        pthread_mutex_unlock(&tap->ring_lock);
+    }
+}
+
+static void* tap_thread_main(void* arg) {
+    EventTap* tap = arg;
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+    log_info("Event tap listening on %s", tap->path);
+
+    while (atomic_load(&tap->running)) {
+        struct pollfd fds[3] = {
+            { tap->wake_pipe[0], POLLIN, 0 },
+            { tap->listen_fd, POLLIN, 0 },
+            { tap->client_fd, POLLIN, 0 }
+        };
+        int count = tap->client_fd >= 0 ? 3 : 2;
+        int timeout = tap->client_fd >= 0 ? TAP_DRAIN_INTERVAL_MS : -1;
+        if (poll(fds, (nfds_t)count, timeout) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERRNO("Event tap poll failed");
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[64];
+            while (read(tap->wake_pipe[0], drain, sizeof(drain)) > 0) {
+            }
+            if (!atomic_load(&tap->running)) {
+                break;
+            }
+        }
+        if (count == 3 && (fds[2].revents & (POLLIN | POLLHUP | POLLERR))) {
+            /* Clients only talk during the handshake: anything now is a hangup */
+            char discard[256];
+            ssize_t n = recv(tap->client_fd, discard, sizeof(discard), MSG_DONTWAIT);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                end_session(tap, "client closed");
+            }
+        }
+        if (tap->client_fd >= 0) {
+            drain_ring(tap);
+        }
+        if (fds[1].revents & POLLIN) {
+            accept_client(tap);
+        }
+    }
+
+    end_session(tap, "tap stopping");
+    return NULL;
+}
+
+EventTap* event_tap_create(EventSystem* events, const char* socket_path) {
+    PK_CHECK_NULL_WITH_CONTEXT(events != NULL, PK_ERROR_NULL_PARAM,
+                               "event_tap_create: events is NULL");
+    PK_CHECK_NULL_WITH_CONTEXT(socket_path != NULL && socket_path[0] != '\0',
+                               PK_ERROR_NULL_PARAM, "event_tap_create: socket_path is empty");
+
+    EventTap* tap = calloc(1, sizeof(EventTap));
+    if (!tap) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "event_tap_create: Failed to allocate %zu bytes", sizeof(EventTap));
+        return NULL;
+    }
+    if (strlen(socket_path) >= sizeof(tap->path)) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "event_tap_create: socket path '%s' longer than %zu bytes",
+            socket_path, sizeof(tap->path) - 1);
+        free(tap);
+        return NULL;
+    }
+    snprintf(tap->path, sizeof(tap->path), "%s", socket_path);
+    tap->events = events;
+    tap->listen_fd = -1;
+    tap->client_fd = -1;
+    tap->wake_pipe[0] = -1;
+    tap->wake_pipe[1] = -1;
+    atomic_init(&tap->running, false);
+    pthread_mutex_init(&tap->ring_lock, NULL);
+
+    tap->ring = malloc(TAP_RING_BYTES);
+    tap->out = malloc(TAP_RING_BYTES / 4);
+    if (!tap->ring || !tap->out) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "event_tap_create: Failed to allocate %d byte ring", TAP_RING_BYTES);
+        event_tap_destroy(tap);
+        return NULL;
+    }
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, tap->path, strlen(tap->path));
+
+    /* Replace a stale socket from a previous run, never any other file */
+    struct stat existing;
+    if (lstat(tap->path, &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            pk_set_last_error_with_context(PK_ERROR_ALREADY_EXISTS,
+                "event_tap_create: %s exists and is not a socket", tap->path);
+            event_tap_destroy(tap);
+            return NULL;
+        }
+        unlink(tap->path);
+    }
+
+    tap->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (tap->listen_fd < 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "event_tap_create: socket failed: %s", strerror(errno));
+        event_tap_destroy(tap);
+        return NULL;
+    }
+    /* Owner-only before listen(), so nobody can connect in between; the
+     * socket's own mode (fchmod) does not govern connect() on Linux */
+    int rc = bind(tap->listen_fd, (struct sockaddr*)&address, sizeof(address));
+    if (rc == 0) {
+        rc = chmod(tap->path, 0600);
+    }
+    if (rc != 0 || listen(tap->listen_fd, 2) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "event_tap_create: cannot listen on %s: %s", tap->path, strerror(errno));
+        close(tap->listen_fd);
+        tap->listen_fd = -1;
+        event_tap_destroy(tap);
+        return NULL;
+    }
+
+    if (pipe(tap->wake_pipe) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "event_tap_create: pipe failed: %s", strerror(errno));
+        event_tap_destroy(tap);
+        return NULL;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(tap->wake_pipe[i], F_SETFL, fcntl(tap->wake_pipe[i], F_GETFL) | O_NONBLOCK);
+        fcntl(tap->wake_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    atomic_store(&tap->running, true);
+    rc = pthread_create(&tap->thread, NULL, tap_thread_main, tap);
+    if (rc != 0) {
+        atomic_store(&tap->running, false);
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "event_tap_create: pthread_create failed: %s", strerror(rc));
+        event_tap_destroy(tap);
+        return NULL;
+    }
+    tap->thread_started = true;
+    return tap;
+}
+
+void event_tap_destroy(EventTap* tap) {
+    if (!tap) {
+        return;
+    }
+
+    if (tap->thread_started) {
+        atomic_store(&tap->running, false);
+        ssize_t written = write(tap->wake_pipe[1], "q", 1);
+        (void)written;
+        pthread_join(tap->thread, NULL);
+    }
+
+    if (tap->listen_fd >= 0) {
+        close(tap->listen_fd);
+        unlink(tap->path);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (tap->wake_pipe[i] >= 0) {
+            close(tap->wake_pipe[i]);
+        }
+    }
+    free(tap->ring);
+    free(tap->out);
+    pthread_mutex_destroy(&tap->ring_lock);
+    free(tap);
+}
+
+void event_tap_get_stats(EventTap* tap, EventTapStats* stats) {
+    if (!tap || !stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&tap->ring_lock);
+    *stats = tap->stats;
+    pthread_mutex_unlock(&tap->ring_lock);
+}
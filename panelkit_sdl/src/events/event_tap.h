@@ -0,0 +1,112 @@
+/**
+ * @file event_tap.h
+ * @brief Live view of the event stream over a Unix socket
+ *
+ * Watching button presses, page transitions and API events in the field
+ * should not need a restart with debug logging, which changes timing. An
+ * EventTap listens on a Unix socket; a client (panelkit-tap) connects,
+ * sends the event names it wants, and from then on receives every
+ * matching event as a binary record.
+ *
+ * Cost on the emitting thread:
+ * - no client connected: nothing is attached to the event system, so
+ *   event_emit pays one not-taken branch
+ * - client connected: a filter match, and for matches a clock read and a
+ *   copy of the name and up to EVENT_TAP_MAX_CAPTURE payload bytes into a
+ *   ring under a short lock. Nothing blocks: when the ring is full the
+ *   record is dropped and the loss reported in the next one.
+ *
+ * A background thread drains the ring to the client every few
+ * milliseconds. One client at a time; a new connection replaces the
+ * current one. The socket is created owner-only (0600).
+ *
+ * Protocol (host byte order, client and server share the machine):
+ * - client sends one line of space-separated filters: an event name, a
+ *   prefix ending in '*' ("api.*"), or "*" for everything
+ * - server answers EVENT_TAP_HELLO once the filters are attached
+ * - then a stream of EventTapRecord headers, each followed by name_length
+ *   bytes of name and captured bytes of payload
+ */
+
+#ifndef PANELKIT_EVENT_TAP_H
+#define PANELKIT_EVENT_TAP_H
+
+#include "event_system.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Socket path panelkit-tap connects to unless told otherwise */
+#define EVENT_TAP_DEFAULT_SOCKET "/tmp/panelkit-events.sock"
+
+/** Greeting sent after the client's filters are in place (8 bytes) */
+#define EVENT_TAP_HELLO "PKTAP 1\n"
+
+/** First field of every record */
+#define EVENT_TAP_MAGIC 0x5041544Bu
+
+/** Payload bytes copied per event; the rest is counted, not sent */
+#define EVENT_TAP_MAX_CAPTURE 256
+
+/** Filters a client may send */
+#define EVENT_TAP_MAX_FILTERS 16
+
+/**
+ * Record header on the wire.
+ */
+typedef struct {
+    uint32_t magic;                 /**< EVENT_TAP_MAGIC */
+    uint32_t sequence;              /**< Counts records sent this session */
+    uint64_t timestamp_ns;          /**< CLOCK_MONOTONIC at emit */
+    uint32_t data_size;             /**< Payload size as emitted */
+    uint16_t name_length;           /**< Name bytes following (no NUL) */
+    uint16_t captured;              /**< Payload bytes following the name */
+    uint32_t dropped;               /**< Matching events lost to a full ring just before this one */
+    uint32_t reserved;
+} EventTapRecord;
+
+/** Opaque event tap handle */
+typedef struct EventTap EventTap;
+
+/**
+ * Event tap statistics.
+ */
+typedef struct {
+    uint64_t sessions;              /**< Clients accepted */
+    uint64_t events;                /**< Records queued for clients */
+    uint64_t dropped;               /**< Matching events lost to a full ring */
+    uint64_t bytes_sent;            /**< Bytes written to clients */
+    bool connected;                 /**< A client is attached */
+} EventTapStats;
+
+/**
+ * Listen for tap clients.
+ *
+ * @param events Event system to observe (required, must outlive the tap)
+ * @param socket_path Unix socket path (required); a stale socket there is
+ *                    replaced, any other file is left alone and fails
+ * @return New tap or NULL on error (caller owns, error context set)
+ */
+EventTap* event_tap_create(EventSystem* events, const char* socket_path);
+
+/**
+ * Detach from the event system, disconnect the client, remove the socket.
+ *
+ * @param tap Tap to destroy (can be NULL)
+ * @note Destroy before the event system
+ */
+void event_tap_destroy(EventTap* tap);
+
+/**
+ * Get tap statistics.
+ *
+ * @param tap Event tap (required)
+ * @param stats Output statistics snapshot (required)
+ */
+void event_tap_get_stats(EventTap* tap, EventTapStats* stats);
+
+/**
+ * @note Thread Safety: create and destroy from one thread; get_stats from
+ *       any thread.
+ */
+
+#endif /* PANELKIT_EVENT_TAP_H */
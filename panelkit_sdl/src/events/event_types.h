@@ -19,6 +19,7 @@ typedef struct {
     int page;
     uint32_t timestamp;
     char button_text[32];
+    int display;            // Display the button is on (0 = primary)
 } ButtonEventData;
 
 // Page change event data
@@ -48,4 +49,12 @@ typedef struct {
     char source[32];
 } ApiRefreshData;
 
+// State store change event data (one per set, remove or committed transaction)
+typedef struct {
+    uint64_t version;
+    uint32_t key_count;         // Keys changed, may exceed those listed
+    uint32_t listed_count;      // Keys packed into `keys`
+    char keys[1024];            // NUL-separated "type:id" keys
+} StateChangedEventData;
+
 #endif // EVENT_TYPES_H
\ No newline at end of file
@@ -16,6 +16,9 @@
 /* Thread safety for event pushing */
 static pthread_mutex_t event_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* Queued motion events a late-latch peek reads without allocating */
+#define INPUT_PEEK_BATCH 32
+
 /* Create input handler with configuration */
 InputHandler* input_handler_create(const InputConfig* config) {
     if (!config) {
@@ -161,6 +164,31 @@ bool input_handler_push_event(InputHandler* handler, SDL_Event* event) {
         return false;
     }
     
+    /* Tag pointer events with the display this handler serves */
+    if (handler->config.window_id) {
+        switch (event->type) {
+            case SDL_MOUSEMOTION:
+                event->motion.windowID = handler->config.window_id;
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                event->button.windowID = handler->config.window_id;
+                break;
+            case SDL_MOUSEWHEEL:
+                event->wheel.windowID = handler->config.window_id;
+                break;
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+            case SDL_FINGERDOWN:
+            case SDL_FINGERUP:
+            case SDL_FINGERMOTION:
+                event->tfinger.windowID = handler->config.window_id;
+                break;
+#endif
+            default:
+                break;
+        }
+    }
+    
     /* Thread-safe SDL event push */
     pthread_mutex_lock(&event_mutex);
     int result = SDL_PushEvent(event);
@@ -179,6 +207,86 @@ bool input_handler_push_event(InputHandler* handler, SDL_Event* event) {
     return true;
 }
 
+/* Window a motion event belongs to (0 if SDL cannot say) */
+static Uint32 motion_window_id(const SDL_Event* event) {
+    if (event->type == SDL_MOUSEMOTION) {
+        return event->motion.windowID;
+    }
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+    if (event->type == SDL_FINGERMOTION) {
+        return event->tfinger.windowID;
+    }
+#endif
+    return 0;
+}
+
+/* Find newest queued event of one type for a window without removing it.
+ * SDL peeks from the head of the queue, so the whole run of that type is
+ * read: a fast drag easily queues more than one batch of motions. */
+static bool peek_newest_of_type(Uint32 type, Uint32 window_id, SDL_Event* newest) {
+    int queued = SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, type, type);
+    if (queued <= 0) {
+        return false;
+    }
+    
+    SDL_Event batch[INPUT_PEEK_BATCH];
+    SDL_Event* pending = batch;
+    if (queued > INPUT_PEEK_BATCH) {
+        pending = malloc((size_t)queued * sizeof(SDL_Event));
+        if (!pending) {
+            /* Latch the oldest batch rather than nothing */
+            pending = batch;
+            queued = INPUT_PEEK_BATCH;
+        }
+    }
+    
+    bool found = false;
+    int count = SDL_PeepEvents(pending, queued, SDL_PEEKEVENT, type, type);
+    for (int i = count - 1; i >= 0; i--) {
+        if (!window_id || motion_window_id(&pending[i]) == window_id) {
+            *newest = pending[i];
+            found = true;
+            break;
+        }
+    }
+    
+    if (pending != batch) {
+        free(pending);
+    }
+    return found;
+}
+
+/* Peek latest pointer motion for late latching */
+bool input_handler_peek_latest_motion(InputHandler* handler, SDL_Event* event) {
+    if (!handler || !event) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+            "input_handler_peek_latest_motion: handler=%p, event=%p",
+            (void*)handler, (void*)event);
+        return false;
+    }
+    
+    SDL_Event mouse, finger;
+    
+    pthread_mutex_lock(&event_mutex);
+    SDL_PumpEvents();
+    Uint32 window_id = handler->config.window_id;
+    bool have_mouse = peek_newest_of_type(SDL_MOUSEMOTION, window_id, &mouse);
+    bool have_finger = peek_newest_of_type(SDL_FINGERMOTION, window_id, &finger);
+    pthread_mutex_unlock(&event_mutex);
+    
+    if (have_mouse && have_finger) {
+        *event = SDL_TICKS_PASSED(finger.common.timestamp, mouse.common.timestamp) ? finger : mouse;
+    } else if (have_finger) {
+        *event = finger;
+    } else if (have_mouse) {
+        *event = mouse;
+    } else {
+        return false;
+    }
+    
+    return true;
+}
+
 /* Cleanup and destroy handler */
 void input_handler_destroy(InputHandler* handler) {
     if (!handler) {
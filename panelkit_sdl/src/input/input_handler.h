@@ -51,6 +51,7 @@ typedef struct {
     bool enable_mouse_emulation; /* Emulate mouse from touch events */
     int reconnect_attempts;      /* Number of reconnection attempts on device loss (0 = disabled) */
     int reconnect_delay_ms;      /* Delay between reconnection attempts in milliseconds */
+    Uint32 window_id;            /* Window pointer events belong to (0 = leave as delivered) */
 } InputConfig;
 
 /* Forward declarations for implementation types */
@@ -186,6 +187,19 @@ const struct InputHandler_stats* input_handler_get_stats(InputHandler* handler);
  */
 bool input_handler_push_event(InputHandler* handler, SDL_Event* event);
 
+/**
+ * Peek the newest pending pointer motion without consuming it.
+ * 
+ * @param handler Input handler (required)
+ * @param event Output for the newest mouse or finger motion event (required)
+ * @return true if a motion event was pending, false otherwise
+ * @note Main thread only (pumps SDL events). The event stays queued and is
+ *       delivered normally on the next poll; used to late-latch drag input
+ *       immediately before rendering. With a window_id configured, only
+ *       motion for that window is considered.
+ */
+bool input_handler_peek_latest_motion(InputHandler* handler, SDL_Event* event);
+
 /**
  * Destroy input handler.
  * 
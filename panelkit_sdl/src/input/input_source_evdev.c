@@ -10,12 +10,14 @@
 #include "input_handler.h"
 #include "../core/logger.h"
 #include "../core/error.h"
+#include "../core/realtime.h"
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <pthread.h>
+#include <poll.h>
 #include <dirent.h>
 #include <linux/input.h>
 #include <sys/ioctl.h>
@@ -25,6 +27,12 @@
 #define BTN_TOUCH 0x14a
 #endif
 
+/* How long a blocked read waits before rechecking thread_running */
+#define READ_POLL_TIMEOUT_MS 100
+
+/* Events read per syscall; a multitouch frame is rarely more than this */
+#define READ_BATCH_EVENTS 64
+
 /* Maximum number of simultaneous touch points to track */
 #define MAX_TOUCH_POINTS 10
 
@@ -193,22 +201,42 @@ static void evdev_cleanup(InputSource* source) {
 static void* evdev_read_thread(void* arg) {
     InputSource* source = (InputSource*)arg;
     EvdevData* data = source->impl.evdev;
-    struct input_event ev;
+    struct input_event events[READ_BATCH_EVENTS];
     
+    realtime_enter(REALTIME_ROLE_INPUT);
     log_info("Evdev read thread started for %s", data->device_path);
     
+    /* Sleep in poll() until the device has data: a touch wakes the thread
+     * immediately instead of on the next polling tick */
+    struct pollfd pfd = { .fd = data->fd, .events = POLLIN };
+    
     while (data->thread_running) {
-        ssize_t bytes = read(data->fd, &ev, sizeof(ev));
+        int ready = poll(&pfd, 1, READ_POLL_TIMEOUT_MS);
+        if (ready == 0 || (ready < 0 && errno == EINTR)) {
+            continue; /* Timeout or signal, recheck thread_running */
+        }
         
-        if (bytes == sizeof(ev)) {
-            process_touch_event(data, &ev);
+        ssize_t bytes;
+        if (ready < 0) {
+            bytes = -1;
+        } else if (!(pfd.revents & POLLIN)) {
+            errno = ENODEV; /* POLLERR/POLLHUP: the device went away */
+            bytes = -1;
+        } else {
+            /* Drain everything queued (usually a whole SYN_REPORT frame) */
+            bytes = read(data->fd, events, sizeof(events));
+        }
+        
+        if (bytes > 0) {
+            size_t count = (size_t)bytes / sizeof(events[0]);
+            for (size_t i = 0; i < count; i++) {
+                process_touch_event(data, &events[i]);
+            }
         } else if (bytes < 0) {
             if (errno == EINTR) {
                 continue; /* Interrupted, retry */
             } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                /* No data available (non-blocking mode) */
-                usleep(1000); /* Sleep 1ms to avoid busy loop */
-                continue;
+                continue; /* Spurious wakeup, poll again */
             } else if (errno == ENODEV) {
                 log_error("Input device disconnected");
                 pk_set_last_error_with_context(PK_ERROR_INPUT_DEVICE_NOT_FOUND,
@@ -228,9 +256,6 @@ static void* evdev_read_thread(void* arg) {
                 break;
             }
         }
-        
-        /* Small sleep to avoid consuming too much CPU */
-        usleep(100); /* 0.1ms */
     }
     
     log_info("Evdev read thread exiting");
@@ -262,8 +287,8 @@ static void process_touch_event(EvdevData* data, const struct input_event* ev) {
                             float norm_y = (float)(touch->y - data->abs_y.minimum) / 
                                          (data->abs_y.maximum - data->abs_y.minimum);
                             
-                            log_info("Touch UP: slot=%d id=%d pos=(%.3f,%.3f)", 
-                                    data->current_slot, touch->id, norm_x, norm_y);
+                            log_debug("Touch UP: slot=%d id=%d pos=(%.3f,%.3f)", 
+                                     data->current_slot, touch->id, norm_x, norm_y);
                             
                             inject_sdl_touch_event(data, SDL_FINGERUP, touch->id, 
                                                  norm_x, norm_y, 0.0f);
@@ -280,8 +305,8 @@ static void process_touch_event(EvdevData* data, const struct input_event* ev) {
                         touch->pressure = 1.0f;
                         touch->sent_down = false;  // Will send on SYN_REPORT
                         
-                        log_info("Touch DOWN detected: slot=%d id=%d", 
-                                data->current_slot, touch->id);
+                        log_debug("Touch DOWN detected: slot=%d id=%d", 
+                                 data->current_slot, touch->id);
                     }
                     break;
                     
@@ -308,7 +333,7 @@ static void process_touch_event(EvdevData* data, const struct input_event* ev) {
                         data->touches[0].active = true;
                         data->touches[0].id = 0;
                         data->touches[0].sent_down = false;
-                        log_info("Simple touch protocol: touch detected");
+                        log_debug("Simple touch protocol: touch detected");
                     }
                     break;
                     
@@ -328,7 +353,7 @@ static void process_touch_event(EvdevData* data, const struct input_event* ev) {
                     float norm_y = (float)(data->touches[0].y - data->abs_y.minimum) / 
                                  (data->abs_y.maximum - data->abs_y.minimum);
                     
-                    log_info("Simple touch UP: pos=(%.3f,%.3f)", norm_x, norm_y);
+                    log_debug("Simple touch UP: pos=(%.3f,%.3f)", norm_x, norm_y);
                     inject_sdl_touch_event(data, SDL_FINGERUP, 0, norm_x, norm_y, 0.0f);
                     
                     data->touches[0].active = false;
@@ -350,8 +375,8 @@ static void process_touch_event(EvdevData* data, const struct input_event* ev) {
                         
                         /* Send motion or down event */
                         if (!touch->sent_down) {
-                            log_info("Sending FINGERDOWN: slot=%d id=%d pos=(%.3f,%.3f)", 
-                                    i, touch->id, norm_x, norm_y);
+                            log_debug("Sending FINGERDOWN: slot=%d id=%d pos=(%.3f,%.3f)", 
+                                     i, touch->id, norm_x, norm_y);
                             inject_sdl_touch_event(data, SDL_FINGERDOWN, touch->id,
                                                  norm_x, norm_y, touch->pressure);
                             touch->sent_down = true;
@@ -11,6 +11,7 @@
 struct JsonValue {
     jsmntok_t* token;
     const char* json_string;
+    JsonParser* owner;
 };
 
 struct JsonParser {
@@ -56,8 +57,9 @@ JsonError json_parser_parse(JsonParser* parser, const char* json_string, size_t
     memcpy(parser->json_string, json_string, length);
     parser->json_string[length] = '\0';
     
-    // Reset parser
+    // Reset parser; values handed out for the previous document are stale
     jsmn_init(&parser->parser);
+    parser->value_pool_index = 0;
     
     // Parse JSON
     int result = jsmn_parse(&parser->parser, parser->json_string, length, 
@@ -74,6 +76,7 @@ JsonError json_parser_parse(JsonParser* parser, const char* json_string, size_t
     if (parser->token_count > 0) {
         parser->root_value.token = &parser->tokens[0];
         parser->root_value.json_string = parser->json_string;
+        parser->root_value.owner = parser;
     }
     
     log_debug("JSON parsed successfully: %d tokens", parser->token_count);
@@ -96,6 +99,20 @@ static int json_token_equal(const char* json, jsmntok_t* token, const char* str)
     return 0;
 }
 
+// Values live in the parser's pool so lookups don't overwrite each other
+static JsonValue* pool_value(JsonValue* parent, jsmntok_t* token) {
+    JsonParser* parser = parent->owner;
+    if (parser->value_pool_index >= MAX_JSON_VALUES) {
+        log_error("JSON value pool exhausted (%d lookups)", MAX_JSON_VALUES);
+        return NULL;
+    }
+    JsonValue* value = &parser->value_pool[parser->value_pool_index++];
+    value->token = token;
+    value->json_string = parent->json_string;
+    value->owner = parser;
+    return value;
+}
+
 static int skip_tokens(jsmntok_t* token) {
     int count = 1;
     if (token->type == JSMN_OBJECT || token->type == JSMN_ARRAY) {
@@ -124,10 +141,7 @@ JsonValue* json_object_get(JsonValue* object, const char* key) {
         // Check if this key matches
         if (json_token_equal(json, &tokens[i], key)) {
             // Found the key, return the value
-            static JsonValue value;
-            value.token = &tokens[i + 1];
-            value.json_string = json;
-            return &value;
+            return pool_value(object, &tokens[i + 1]);
         }
         
         // Skip to next key-value pair
@@ -151,10 +165,7 @@ JsonValue* json_array_get(JsonValue* array, int index) {
         i += skip_tokens(&tokens[i]);
     }
     
-    static JsonValue value;
-    value.token = &tokens[i];
-    value.json_string = array->json_string;
-    return &value;
+    return pool_value(array, &tokens[i]);
 }
 
 int json_array_size(JsonValue* array) {
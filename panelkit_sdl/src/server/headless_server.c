@@ -0,0 +1,608 @@
+/**
+ * @file headless_server.c
+ * @brief Instance setup, shared resources and frame loop of the panel server
+ */
+
+#include "headless_server.h"
+#include "../core/sdl_includes.h"
+#include "../core/logger.h"
+#include "../core/error.h"
+#include "../display/panel_server.h"
+#include "../display/rfb_server.h"
+#include "../display/skin_atlas.h"
+#include "../api/api_manager.h"
+#include "../api/api_parsers.h"
+#include "../events/event_system.h"
+#include "../state/state_store.h"
+#include "../ui/widget.h"
+#include "../ui/widget_integration.h"
+#include "../ui/widget_manager.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_MAX_FONT_SIZES 16
+#define SERVER_INPUT_QUEUE 64
+#define SERVER_STATS_INTERVAL_NS (10ull * 1000000000ull)
+
+typedef struct {
+    char path[CONFIG_MAX_PATH];
+    ConfigManager* manager;
+} CachedConfig;
+
+typedef struct {
+    int size;
+    TTF_Font* font;
+} CachedFont;
+
+typedef struct {
+    char name[64];
+    const Config* config;           /* Shared with instances naming the same file */
+    WidgetIntegration* integration; /* Own state store, events and widgets */
+    int panel;                      /* Index in the PanelServer */
+    RfbServer* viewer;              /* NULL without base_port */
+    uint32_t frames;                /* Frames recorded since the last FPS update */
+
+    /* Viewer input: queued on the RFB thread, drained on the main thread */
+    pthread_mutex_t input_mutex;
+    SDL_Event input[SERVER_INPUT_QUEUE];
+    int input_count;
+} ServerInstance;
+
+typedef struct {
+    const Config* config;
+    const void* font_data;
+    size_t font_size;
+
+    CachedConfig* configs;
+    int config_count;
+    CachedFont fonts[SERVER_MAX_FONT_SIZES];
+    int font_count;
+    SkinAtlas* skin;
+    ApiManager* api;
+
+    PanelServer* panels;
+    ServerInstance** instances;     /* Stable addresses: viewers hold them */
+    int instance_count;
+} HeadlessServer;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_stop_signal(int signum) {
+    (void)signum;
+    stop_requested = 1;
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static SDL_Color color_from_hex(const char* hex) {
+    SDL_Color color = {33, 33, 33, 255};
+    unsigned int rgb;
+    if (hex && hex[0] == '#' && strlen(hex) == 7 && sscanf(hex + 1, "%06x", &rgb) == 1) {
+        color.r = (rgb >> 16) & 0xFF;
+        color.g = (rgb >> 8) & 0xFF;
+        color.b = rgb & 0xFF;
+    }
+    return color;
+}
+
+/* Parsed configuration for a path, loading it on first use */
+static const Config* server_config_for(HeadlessServer* server, const char* path) {
+    if (strcmp(path, "-") == 0) {
+        return server->config;
+    }
+
+    for (int i = 0; i < server->config_count; i++) {
+        if (strcmp(server->configs[i].path, path) == 0) {
+            return config_manager_get_config(server->configs[i].manager);
+        }
+    }
+
+    if (access(path, R_OK) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "Instance configuration %s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    CachedConfig* configs = realloc(server->configs,
+                                    (size_t)(server->config_count + 1) * sizeof(CachedConfig));
+    if (!configs) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "server_config_for: Failed to grow config cache");
+        return NULL;
+    }
+    server->configs = configs;
+
+    /* Defaults plus this file only; system and user files are the server's */
+    ConfigManagerOptions options = {
+        .local_config_path = path,
+        .skip_system_config = true,
+        .skip_user_config = true
+    };
+    ConfigManager* manager = config_manager_create(&options);
+    if (!manager || !config_manager_load(manager)) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+            "Instance configuration %s could not be loaded", path);
+        config_manager_destroy(manager);
+        return NULL;
+    }
+
+    CachedConfig* cached = &server->configs[server->config_count++];
+    snprintf(cached->path, sizeof(cached->path), "%s", path);
+    cached->manager = manager;
+    return config_manager_get_config(manager);
+}
+
+/* Font at a point size, shared by every instance that asks for it */
+static TTF_Font* server_font(HeadlessServer* server, int size) {
+    for (int i = 0; i < server->font_count; i++) {
+        if (server->fonts[i].size == size) {
+            return server->fonts[i].font;
+        }
+    }
+
+    if (server->font_count == SERVER_MAX_FONT_SIZES) {
+        pk_set_last_error_with_context(PK_ERROR_RESOURCE_LIMIT,
+            "server_font: More than %d font sizes in use", SERVER_MAX_FONT_SIZES);
+        return NULL;
+    }
+
+    SDL_RWops* rw = SDL_RWFromConstMem(server->font_data, (int)server->font_size);
+    TTF_Font* font = rw ? TTF_OpenFontRW(rw, 1, size) : NULL;
+    if (!font) {
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "server_font: %dpt font failed: %s", size, TTF_GetError());
+        return NULL;
+    }
+
+    server->fonts[server->font_count].size = size;
+    server->fonts[server->font_count].font = font;
+    server->font_count++;
+    return font;
+}
+
+/* Viewer pointer input, called on the instance's RFB server thread */
+static void on_viewer_input(SDL_Event* event, void* user_data) {
+    ServerInstance* instance = user_data;
+
+    pthread_mutex_lock(&instance->input_mutex);
+    if (instance->input_count < SERVER_INPUT_QUEUE) {
+        instance->input[instance->input_count++] = *event;
+    }
+    pthread_mutex_unlock(&instance->input_mutex);
+}
+
+static void instance_drain_input(ServerInstance* instance) {
+    SDL_Event events[SERVER_INPUT_QUEUE];
+
+    pthread_mutex_lock(&instance->input_mutex);
+    int count = instance->input_count;
+    memcpy(events, instance->input, (size_t)count * sizeof(SDL_Event));
+    instance->input_count = 0;
+    pthread_mutex_unlock(&instance->input_mutex);
+
+    for (int i = 0; i < count; i++) {
+        widget_manager_handle_event(instance->integration->widget_manager, &events[i]);
+    }
+}
+
+/* One fetch serves every instance */
+static void on_api_data(const UserData* data, void* context) {
+    HeadlessServer* server = context;
+    if (!data) {
+        return;
+    }
+
+    for (int i = 0; i < server->instance_count; i++) {
+        widget_integration_mirror_user_data(server->instances[i]->integration, data,
+                                            sizeof(*data));
+    }
+}
+
+static void on_api_error(ApiError error, const char* message, void* context) {
+    (void)context;
+    log_error("API error: %s - %s", api_error_string(error), message ? message : "Unknown error");
+}
+
+static void on_api_refresh(const char* event_name, const void* data, size_t data_size,
+                           void* context) {
+    (void)event_name; (void)data; (void)data_size;
+    HeadlessServer* server = context;
+    if (server->api) {
+        api_manager_refresh_now(server->api);
+    }
+}
+
+static void instance_destroy(ServerInstance* instance) {
+    if (!instance) {
+        return;
+    }
+    rfb_server_destroy(instance->viewer);
+    widget_integration_destroy(instance->integration);
+    pthread_mutex_destroy(&instance->input_mutex);
+    free(instance);
+}
+
+static ServerInstance* instance_create(HeadlessServer* server, const char* name,
+                                       const char* config_path) {
+    const Config* config = server_config_for(server, config_path);
+    if (!config) {
+        return NULL;
+    }
+
+    TTF_Font* font = server_font(server, config->ui.fonts.regular_size);
+    TTF_Font* large_font = server_font(server, config->ui.fonts.large_size);
+    TTF_Font* small_font = server_font(server, config->ui.fonts.small_size);
+    if (!font || !large_font || !small_font) {
+        return NULL;
+    }
+
+    int panel = panel_server_add_panel(server->panels, config->display.width,
+                                       config->display.height);
+    if (panel < 0) {
+        return NULL;
+    }
+
+    ServerInstance* instance = calloc(1, sizeof(ServerInstance));
+    if (!instance) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "instance_create: Failed to allocate %zu bytes", sizeof(ServerInstance));
+        return NULL;
+    }
+    snprintf(instance->name, sizeof(instance->name), "%s", name);
+    instance->config = config;
+    instance->panel = panel;
+    pthread_mutex_init(&instance->input_mutex, NULL);
+
+    instance->integration = widget_integration_create(
+        panel_server_get_renderer(server->panels, panel));
+    if (!instance->integration) {
+        instance_destroy(instance);
+        return NULL;
+    }
+
+    WidgetIntegration* integration = instance->integration;
+    widget_integration_set_dimensions(integration, config->display.width,
+                                      config->display.height);
+    widget_integration_set_fonts(integration, font, large_font, small_font);
+    widget_integration_set_skin(integration, server->skin);
+    widget_integration_create_shadow_widgets(integration);
+    widget_integration_enable_events(integration);
+    widget_integration_enable_button_handling(integration);
+
+    SDL_Color background = color_from_hex(config->ui.colors.background);
+    state_store_set(integration->state_store, "app", "bg_color", &background,
+                    sizeof(SDL_Color));
+    event_set_dispatch_budget(integration->event_system,
+                              (uint32_t)config->system.events.low_budget_us,
+                              (uint32_t)config->system.events.max_defer_ms);
+    event_subscribe(integration->event_system, "system.api_refresh", on_api_refresh, server);
+
+    return instance;
+}
+
+/* Attach a viewer on base_port + index; an instance without one still renders */
+static void instance_start_viewer(HeadlessServer* server, ServerInstance* instance, int index) {
+    const ConfigRemote* remote = &server->config->system.remote;
+    int port = server->config->system.server.base_port + index;
+    if (port > 65535) {
+        log_warn("Instance %s: no port left for a viewer", instance->name);
+        return;
+    }
+
+    RfbServerConfig viewer_config = rfb_server_default_config();
+    viewer_config.bind_address = remote->bind;
+    viewer_config.port = port;
+    viewer_config.max_fps = remote->max_fps;
+    viewer_config.idle_fps = remote->idle_fps;
+    viewer_config.compression = remote->compression;
+    viewer_config.view_only = remote->view_only;
+    viewer_config.desktop_name = instance->name;
+    viewer_config.on_input = on_viewer_input;
+    viewer_config.input_user_data = instance;
+
+    instance->viewer = rfb_server_create(&viewer_config, instance->config->display.width,
+                                         instance->config->display.height);
+    if (!instance->viewer || !rfb_server_start(instance->viewer)) {
+        log_warn("Instance %s: viewer unavailable: %s", instance->name,
+                 pk_get_last_error_context());
+        rfb_server_destroy(instance->viewer);
+        instance->viewer = NULL;
+        return;
+    }
+    panel_server_set_mirror(server->panels, instance->panel, instance->viewer);
+}
+
+/* Read the instance list; lines are "name config" with # comments */
+static bool load_instances(HeadlessServer* server, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "Instance list %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    char line[CONFIG_MAX_PATH + 128];
+    int line_number = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+
+        char name[64];
+        char config_path[CONFIG_MAX_PATH];
+        char extra[2];
+        int fields = sscanf(line, "%63s %255s %1s", name, config_path, extra);
+        if (fields <= 0) {
+            continue;
+        }
+        if (fields != 2) {
+            pk_set_last_error_with_context(PK_ERROR_PARSE,
+                "Instance list %s:%d: expected \"name config\"", path, line_number);
+            ok = false;
+            break;
+        }
+
+        ServerInstance** instances = realloc(server->instances,
+            (size_t)(server->instance_count + 1) * sizeof(ServerInstance*));
+        if (!instances) {
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                "load_instances: Failed to grow to %d instances", server->instance_count + 1);
+            ok = false;
+            break;
+        }
+        server->instances = instances;
+
+        ServerInstance* instance = instance_create(server, name, config_path);
+        if (!instance) {
+            log_error("Instance %s (%s:%d): %s", name, path, line_number,
+                      pk_get_last_error_context());
+            ok = false;
+            break;
+        }
+        server->instances[server->instance_count++] = instance;
+    }
+    fclose(file);
+
+    if (ok && server->instance_count == 0) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+            "Instance list %s names no instances", path);
+        ok = false;
+    }
+    return ok;
+}
+
+/* Record one instance's frame into its panel's back list */
+static void instance_record(HeadlessServer* server, ServerInstance* instance, double dt) {
+    WidgetIntegration* integration = instance->integration;
+    DisplayList* list = panel_server_begin_frame(server->panels, instance->panel);
+
+    instance_drain_input(instance);
+    event_dispatch_pending(integration->event_system);
+
+    SDL_Color background = {33, 33, 33, 255};
+    size_t size;
+    time_t timestamp;
+    SDL_Color* stored = state_store_get(integration->state_store, "app", "bg_color",
+                                        &size, &timestamp);
+    if (stored && size == sizeof(SDL_Color)) {
+        background = *stored;
+    }
+    free(stored);
+
+    display_list_set_draw_color(list, background.r, background.g, background.b, background.a);
+    display_list_clear(list);
+
+    widget_integration_update_rendering(integration);
+    if (integration->page_manager) {
+        if (integration->page_manager->update) {
+            integration->page_manager->update(integration->page_manager, dt);
+        }
+        if (integration->page_manager->render) {
+            integration->page_manager->render(integration->page_manager, list);
+        }
+    }
+    instance->frames++;
+}
+
+static void log_throughput(HeadlessServer* server, const PanelServerStats* now,
+                           const PanelServerStats* last, double seconds) {
+    uint64_t panel_frames = now->panel_frames - last->panel_frames;
+    uint64_t batches = now->frames - last->frames;
+    double raster_s = (double)(now->raster_ns - last->raster_ns) / 1e9;
+    if (batches == 0 || seconds <= 0) {
+        return;
+    }
+
+    /* Per core: panel frames per second of worker time spent rasterizing */
+    log_info("Server: %d panels, %.0f panel-frames/s, %.0f per core (%d workers), "
+             "record %.2f ms, wait %.2f ms per batch",
+             server->instance_count, (double)panel_frames / seconds,
+             raster_s > 0 ? (double)panel_frames / raster_s : 0.0, now->workers,
+             (double)(now->record_ns - last->record_ns) / (double)batches / 1e6,
+             (double)(now->wait_ns - last->wait_ns) / (double)batches / 1e6);
+}
+
+static void server_run_loop(HeadlessServer* server) {
+    int fps = server->config->system.server.fps;
+    uint64_t period_ns = fps > 0 ? 1000000000ull / (uint64_t)fps : 0;
+    uint64_t last_ns = monotonic_ns();
+    uint64_t next_tick_ns = last_ns;
+    uint64_t fps_ns = last_ns;
+    uint64_t stats_ns = last_ns;
+    PanelServerStats last_stats;
+    panel_server_get_stats(server->panels, &last_stats);
+
+    while (!stop_requested) {
+        uint64_t now_ns = monotonic_ns();
+        double dt = (double)(now_ns - last_ns) / 1e9;
+        last_ns = now_ns;
+
+        api_manager_update(server->api, SDL_GetTicks());
+
+        for (int i = 0; i < server->instance_count; i++) {
+            instance_record(server, server->instances[i], dt);
+        }
+        panel_server_submit(server->panels);
+
+        if (now_ns - fps_ns >= 1000000000ull) {
+            for (int i = 0; i < server->instance_count; i++) {
+                ServerInstance* instance = server->instances[i];
+                widget_integration_update_fps(instance->integration, instance->frames);
+                instance->frames = 0;
+            }
+            fps_ns = now_ns;
+        }
+
+        if (now_ns - stats_ns >= SERVER_STATS_INTERVAL_NS) {
+            PanelServerStats stats;
+            panel_server_get_stats(server->panels, &stats);
+            log_throughput(server, &stats, &last_stats, (double)(now_ns - stats_ns) / 1e9);
+            last_stats = stats;
+            stats_ns = now_ns;
+        }
+
+        if (period_ns == 0) {
+            continue;
+        }
+
+        /* Absolute ticks so recording time does not stretch the period */
+        next_tick_ns += period_ns;
+        if (next_tick_ns + period_ns < monotonic_ns()) {
+            next_tick_ns = monotonic_ns();
+        }
+        struct timespec tick = {
+            .tv_sec = (time_t)(next_tick_ns / 1000000000ull),
+            .tv_nsec = (long)(next_tick_ns % 1000000000ull)
+        };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tick, NULL);
+    }
+}
+
+static void server_destroy(HeadlessServer* server) {
+    /* Workers capture into the viewers: stop them first */
+    panel_server_destroy(server->panels);
+    if (server->api) {
+        api_manager_destroy(server->api);
+    }
+    for (int i = 0; i < server->instance_count; i++) {
+        instance_destroy(server->instances[i]);
+    }
+    free(server->instances);
+    for (int i = 0; i < server->font_count; i++) {
+        TTF_CloseFont(server->fonts[i].font);
+    }
+    skin_atlas_destroy(server->skin);
+    for (int i = 0; i < server->config_count; i++) {
+        config_manager_destroy(server->configs[i].manager);
+    }
+    free(server->configs);
+}
+
+int headless_server_run(const Config* config, const char* instances_path,
+                        const void* font_data, size_t font_size, AssetBundle* assets) {
+    if (!config || !instances_path || !font_data) {
+        log_error("Headless server needs a configuration, instance list and font");
+        return 1;
+    }
+
+    HeadlessServer server = {
+        .config = config,
+        .font_data = font_data,
+        .font_size = font_size
+    };
+
+    /* No video subsystem: panels are software renderers on plain surfaces */
+    if (SDL_Init(0) != 0 || TTF_Init() == -1) {
+        log_error("SDL initialization failed: %s", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    const ConfigServer* server_cfg = &config->system.server;
+    DisplayPixelFormat pixel_format = DISPLAY_PIXEL_FORMAT_XRGB8888;
+    display_pixel_format_parse(config->display.pixel_format, &pixel_format);
+    PanelServerConfig panel_config = panel_server_default_config();
+    panel_config.workers = server_cfg->workers;
+    panel_config.pixel_format = pixel_format;
+    panel_config.dither = config->display.dither;
+
+    int status = 1;
+    server.panels = panel_server_create(&panel_config);
+    if (!server.panels) {
+        log_error("Panel server unavailable: %s", pk_get_last_error_context());
+        goto done;
+    }
+
+    /* Skin atlas for button chrome, shared read-only by every panel */
+    if (strcmp(config->ui.skin.source, "none") != 0) {
+        server.skin = skin_atlas_create(0, 0);
+        if (server.skin) {
+            PkError skin_err = skin_atlas_load_source(server.skin, config->ui.skin.source,
+                                                      config->ui.skin.slice, assets);
+            if (skin_err != PK_OK) {
+                log_warn("Failed to load skin '%s': %s - using flat widgets",
+                         config->ui.skin.source, pk_get_last_error_context());
+                skin_atlas_destroy(server.skin);
+                server.skin = NULL;
+            }
+        }
+    }
+
+    if (!load_instances(&server, instances_path)) {
+        log_error("Headless server: %s", pk_get_last_error_context());
+        goto done;
+    }
+    if (server_cfg->base_port > 0) {
+        for (int i = 0; i < server.instance_count; i++) {
+            instance_start_viewer(&server, server.instances[i], i);
+        }
+    }
+
+    /* One API client for all instances */
+    ApiManagerConfig api_config = api_manager_default_config();
+    api_config.timeout_seconds = config->api.default_timeout_ms / 1000;
+    api_config.retry_count = config->api.default_retry_count;
+    api_config.retry_delay_ms = config->api.default_retry_delay_ms;
+    server.api = api_manager_create(&api_config);
+    if (!server.api) {
+        log_error("Failed to create API manager");
+        goto done;
+    }
+    api_manager_set_data_callback(server.api, on_api_data, &server);
+    api_manager_set_error_callback(server.api, on_api_error, NULL);
+    api_manager_fetch_user_async(server.api);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    log_info("Headless server running: %d instances, %d config files, %d font sizes, "
+             "%d fps%s", server.instance_count, server.config_count, server.font_count,
+             server_cfg->fps, server_cfg->fps == 0 ? " (unpaced)" : "");
+    server_run_loop(&server);
+    log_info("Headless server stopping");
+    status = 0;
+
+done:
+    server_destroy(&server);
+    api_parsers_cleanup();
+    TTF_Quit();
+    SDL_Quit();
+    return status;
+}
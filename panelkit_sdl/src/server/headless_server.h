@@ -0,0 +1,52 @@
+/**
+ * @file headless_server.h
+ * @brief Many virtual panels served from one process without a display
+ *
+ * Each instance is a complete panel: its own configuration, state store,
+ * event system and widget tree, rendered offscreen and optionally shown
+ * to a VNC viewer on its own port. Instances are listed in a text file,
+ * one per line:
+ *
+ *   # name      config
+ *   lobby       /etc/panelkit/lobby.yaml
+ *   kitchen     /etc/panelkit/kitchen.yaml
+ *   kitchen-2   /etc/panelkit/kitchen.yaml
+ *   default     -
+ *
+ * "-" uses the server's own configuration. Instances naming the same file
+ * share one parsed copy of it.
+ *
+ * Read-only resources are loaded once and shared by every instance: the
+ * font (one TTF_Font per point size), the skin atlas and the API manager,
+ * whose data is mirrored into each instance's state store. Frames are
+ * recorded on the main thread and rasterized on a PanelServer worker pool
+ * (see panel_server.h).
+ *
+ * Video and map widgets are not created for instances; each would own a
+ * capture device or tile loader.
+ */
+
+#ifndef PANELKIT_HEADLESS_SERVER_H
+#define PANELKIT_HEADLESS_SERVER_H
+
+#include "../config/config_manager.h"
+#include "../core/asset_bundle.h"
+#include <stddef.h>
+
+/**
+ * Run the server until SIGINT or SIGTERM.
+ *
+ * @param config Server configuration (system.server; system.remote for the
+ *               viewers' bind address and rates; api and ui.skin for the
+ *               shared resources)
+ * @param instances_path Instance list file (required)
+ * @param font_data TrueType font every instance renders with (required)
+ * @param font_size Size of font_data in bytes
+ * @param assets Asset bundle for "bundle:" skins (can be NULL)
+ * @return Process exit status (0 after a clean shutdown)
+ * @note Call without SDL video initialized; panels need none
+ */
+int headless_server_run(const Config* config, const char* instances_path,
+                        const void* font_data, size_t font_size, AssetBundle* assets);
+
+#endif /* PANELKIT_HEADLESS_SERVER_H */
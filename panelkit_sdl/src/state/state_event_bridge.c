@@ -1,16 +1,24 @@
 #include "state_event_bridge.h"
 #include "state_store.h"
 #include "../events/event_system.h"
+#include "../events/event_system_typed.h"
 #include "../core/logger.h"
 #include "../core/error.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+// Events state_event_bridge_subscribe() can bridge
+#define MAX_BRIDGE_SUBSCRIPTIONS 32
+#define MAX_BRIDGE_EVENT_NAME 128
+
 // Bridge context passed to event handler
 typedef struct {
     StateStore* store;
+    EventSystem* events;
     StateEventBridgeConfig config;
+    char subscribed[MAX_BRIDGE_SUBSCRIPTIONS][MAX_BRIDGE_EVENT_NAME];
+    size_t subscribed_count;
 } BridgeContext;
 
 // Global bridge context (single bridge per process)
@@ -79,6 +87,33 @@ static void bridge_event_handler(const char* event_name,
     }
 }
 
+// Store change listener: queue one coalesced event. Runs on the writing
+// thread, so handlers get it from the next event_dispatch_pending()
+static void bridge_change_listener(const StateChange* change, void* context) {
+    BridgeContext* bridge = (BridgeContext*)context;
+    
+    StateChangedEventData event_data;
+    memset(&event_data, 0, sizeof(event_data));
+    event_data.version = change->version;
+    event_data.key_count = (uint32_t)change->key_count;
+    
+    size_t offset = 0;
+    for (size_t i = 0; i < change->key_count; i++) {
+        size_t len = strlen(change->keys[i]) + 1;
+        if (offset + len > sizeof(event_data.keys)) {
+            break;
+        }
+        memcpy(event_data.keys + offset, change->keys[i], len);
+        offset += len;
+        event_data.listed_count++;
+    }
+    
+    if (!event_post_state_changed(bridge->events, &event_data)) {
+        log_warn("State change %llu not posted: %s", (unsigned long long)change->version,
+                 pk_get_last_error_context());
+    }
+}
+
 PkError state_event_bridge_init(StateStore* store, 
                                EventSystem* events,
                                const StateEventBridgeConfig* config) {
@@ -94,7 +129,7 @@ PkError state_event_bridge_init(StateStore* store,
     }
     
     // Create bridge context
-    g_bridge_context = malloc(sizeof(BridgeContext));
+    g_bridge_context = calloc(1, sizeof(BridgeContext));
     if (!g_bridge_context) {
         pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
             "state_event_bridge_init: Failed to allocate bridge context (%zu bytes)",
@@ -103,16 +138,21 @@ PkError state_event_bridge_init(StateStore* store,
     }
     
     g_bridge_context->store = store;
+    g_bridge_context->events = events;
     if (config) {
         g_bridge_context->config = *config;
     } else {
         g_bridge_context->config = state_event_bridge_default_config();
     }
     
-    // Subscribe to all events using wildcard pattern
-    // For now, we'll need to subscribe to specific events
-    // TODO: Implement wildcard subscription in event system
+    if (!state_store_add_change_listener(store, bridge_change_listener, g_bridge_context)) {
+        PkError err = pk_get_last_error();
+        free(g_bridge_context);
+        g_bridge_context = NULL;
+        return err != PK_OK ? err : PK_ERROR_RESOURCE_LIMIT;
+    }
     
+    // Events are cached only for names passed to state_event_bridge_subscribe()
     log_info("State-event bridge initialized (auto_cache=%s, event_as_type=%s)",
              g_bridge_context->config.auto_cache_all ? "yes" : "no",
              g_bridge_context->config.use_event_as_type ? "yes" : "no");
@@ -125,8 +165,12 @@ void state_event_bridge_cleanup(StateStore* store, EventSystem* events) {
         return;
     }
     
-    // TODO: Unsubscribe from all events
-    
+    for (size_t i = 0; i < g_bridge_context->subscribed_count; i++) {
+        event_unsubscribe_context(g_bridge_context->events, g_bridge_context->subscribed[i],
+                                  bridge_event_handler, g_bridge_context);
+    }
+    state_store_remove_change_listener(g_bridge_context->store, bridge_change_listener,
+                                       g_bridge_context);
     free(g_bridge_context);
     g_bridge_context = NULL;
     
@@ -193,6 +237,13 @@ PkError state_event_bridge_subscribe(EventSystem* events, const char* event_name
             events, event_name);
         return PK_ERROR_NULL_PARAM;
     }
+    if (g_bridge_context->subscribed_count == MAX_BRIDGE_SUBSCRIPTIONS ||
+        strlen(event_name) >= MAX_BRIDGE_EVENT_NAME) {
+        pk_set_last_error_with_context(PK_ERROR_RESOURCE_LIMIT,
+            "state_event_bridge_subscribe: cannot track '%s' (%zu of %d events bridged)",
+            event_name, g_bridge_context->subscribed_count, MAX_BRIDGE_SUBSCRIPTIONS);
+        return PK_ERROR_RESOURCE_LIMIT;
+    }
     
     bool success = event_subscribe(events, event_name, 
                                   bridge_event_handler, g_bridge_context);
@@ -209,6 +260,7 @@ PkError state_event_bridge_subscribe(EventSystem* events, const char* event_name
         return PK_ERROR_SYSTEM;
     }
     
+    strcpy(g_bridge_context->subscribed[g_bridge_context->subscribed_count++], event_name);
     log_info("State bridge subscribed to event '%s'", event_name);
     return PK_OK;
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
  * @file state_event_bridge.h
  * @brief Bridge between event system and state store
  * 
- * Automatically caches events in the state store based on configuration.
+ * Automatically caches events in the state store based on configuration,
+ * and posts store changes as "state.changed" events (one per set, remove
+ * or committed transaction). They are queued, so handlers run in the next
+ * event_dispatch_pending() rather than on the thread that wrote.
  */
 
 #ifndef STATE_EVENT_BRIDGE_H
@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <pthread.h>
 #include <assert.h>
 #include <time.h>
@@ -14,6 +16,11 @@
 #define MAX_STATE_ITEM_SIZE (1024 * 1024)  // 1MB max per item for safety
 #define MAX_TYPE_NAME_LENGTH 64
 #define MAX_ID_LENGTH 128
+#define INITIAL_INDEX_CAPACITY 64        // Hash slots, power of two
+#define INDEX_NOT_FOUND ((size_t)-1)
+#define MAX_CHANGE_LISTENERS 8
+#define MAX_COMPUTED_INPUTS 8
+#define INITIAL_COMPUTED_CAPACITY 8
 
 // Type configuration storage
 typedef struct {
@@ -24,12 +31,67 @@ typedef struct {
 // Stored data item with compound key
 typedef struct {
     char compound_key[MAX_COMPOUND_KEY_LENGTH];  // "type_name:id"
+    size_t type_len;    // Type is compound_key[0..type_len), id follows the colon
+    size_t type_slot;   // Position in the type index posting list
+    size_t id_slot;     // Position in the id index posting list
     void* data;
     size_t data_size;
     time_t timestamp;
     time_t expires_at;  // 0 means never expires
+    uint64_t version;   // Store version that last wrote this item
 } StoredItem;
 
+// Posting list: positions in items[] of all items sharing one type or one id
+typedef struct {
+    char* key;          // NULL marks an empty hash slot
+    size_t key_len;
+    uint32_t hash;
+    size_t* positions;
+    size_t count;
+    size_t capacity;
+} IndexEntry;
+
+// Open-addressed hash table of posting lists
+typedef struct {
+    IndexEntry* entries;
+    size_t capacity;    // Power of two
+    size_t used;        // Occupied slots; a list is deleted when it empties
+} KeyIndex;
+
+// Registered change listener
+typedef struct {
+    state_store_change_callback callback;
+    void* context;
+} ChangeListener;
+
+// Stored key a computed entry depends on
+typedef struct {
+    char type_name[MAX_TYPE_NAME_LENGTH];
+    char id[MAX_ID_LENGTH];
+} ComputedInputKey;
+
+// Memoized derived entry. The definition is immutable once registered;
+// the cache is guarded by cache_lock, which is always taken before the
+// store lock, never while holding it.
+typedef struct {
+    char type_name[MAX_TYPE_NAME_LENGTH];
+    char id[MAX_ID_LENGTH];
+    ComputedInputKey inputs[MAX_COMPUTED_INPUTS];
+    size_t input_count;
+    size_t value_size;
+    state_store_compute_fn compute;
+    void* context;
+    
+    pthread_mutex_t cache_lock;
+    bool cache_valid;
+    bool has_value;             // Last compute produced a value
+    void* value;                // value_size bytes
+    time_t value_timestamp;     // Newest input timestamp
+    uint64_t input_versions[MAX_COMPUTED_INPUTS];  // 0 = missing
+    uint64_t reads;
+    uint64_t recomputes;
+} ComputedEntry;
+
 // Main state store structure
 struct StateStore {
     pthread_rwlock_t lock;
@@ -43,6 +105,25 @@ struct StateStore {
     StoredItem* items;
     size_t num_items;
     size_t item_capacity;
+    
+    // Indexes over items[]: type name -> items, id -> items (guarded by lock)
+    KeyIndex type_index;
+    KeyIndex id_index;
+    
+    // Inserts since creation, drives opportunistic cleanup (guarded by lock)
+    size_t insert_count;
+    
+    // Bumped once per set, remove or committed transaction (guarded by lock)
+    uint64_t version;
+    
+    // Change listeners, called after the lock is released (guarded by lock)
+    ChangeListener listeners[MAX_CHANGE_LISTENERS];
+    size_t num_listeners;
+    
+    // Computed entries, never removed before destroy (array guarded by lock)
+    ComputedEntry** computed;
+    size_t num_computed;
+    size_t computed_capacity;
 };
 
 // Default configuration for new types
@@ -55,6 +136,7 @@ static const DataTypeConfig DEFAULT_TYPE_CONFIG = {
 
 // Forward declarations
 size_t state_store_cleanup_expired(StateStore* store);
+static void computed_free(ComputedEntry* entry);
 
 // Helper function to create compound key
 static void make_compound_key(char* buffer, size_t buffer_size, 
@@ -62,29 +144,261 @@ static void make_compound_key(char* buffer, size_t buffer_size,
     snprintf(buffer, buffer_size, "%s:%s", type_name, id);
 }
 
-// Helper function to split compound key
-static bool split_compound_key(const char* compound_key, 
-                             char* type_name, size_t type_name_size,
-                             char* id, size_t id_size) {
-    const char* colon = strchr(compound_key, ':');
-    if (!colon) {
+// Item key accessors
+
+static const char* item_id(const StoredItem* item) {
+    return item->compound_key + item->type_len + 1;
+}
+
+// Key index (caller must hold the lock)
+
+static uint32_t index_hash(const char* key, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool index_init(KeyIndex* index) {
+    index->entries = calloc(INITIAL_INDEX_CAPACITY, sizeof(IndexEntry));
+    if (!index->entries) {
+        return false;
+    }
+    index->capacity = INITIAL_INDEX_CAPACITY;
+    index->used = 0;
+    return true;
+}
+
+// Drop all posting lists but keep the table allocation
+static void index_clear(KeyIndex* index) {
+    for (size_t i = 0; i < index->capacity; i++) {
+        free(index->entries[i].key);
+        free(index->entries[i].positions);
+    }
+    memset(index->entries, 0, index->capacity * sizeof(IndexEntry));
+    index->used = 0;
+}
+
+static void index_free(KeyIndex* index) {
+    if (index->entries) {
+        index_clear(index);
+        free(index->entries);
+        index->entries = NULL;
+    }
+}
+
+static IndexEntry* index_probe(const KeyIndex* index, const char* key, size_t len,
+                               uint32_t hash) {
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        IndexEntry* entry = &index->entries[i];
+        if (!entry->key ||
+            (entry->hash == hash && entry->key_len == len &&
+             memcmp(entry->key, key, len) == 0)) {
+            return entry;
+        }
+    }
+}
+
+static IndexEntry* index_lookup(const KeyIndex* index, const char* key, size_t len) {
+    IndexEntry* entry = index_probe(index, key, len, index_hash(key, len));
+    return entry->key ? entry : NULL;
+}
+
+static bool index_grow(KeyIndex* index) {
+    size_t new_capacity = index->capacity * 2;
+    IndexEntry* new_entries = calloc(new_capacity, sizeof(IndexEntry));
+    if (!new_entries) {
         return false;
     }
     
-    size_t type_len = colon - compound_key;
-    if (type_len >= type_name_size) {
+    for (size_t i = 0; i < index->capacity; i++) {
+        IndexEntry* entry = &index->entries[i];
+        if (!entry->key) {
+            continue;
+        }
+        size_t mask = new_capacity - 1;
+        size_t slot = entry->hash & mask;
+        while (new_entries[slot].key) {
+            slot = (slot + 1) & mask;
+        }
+        new_entries[slot] = *entry;
+    }
+    
+    free(index->entries);
+    index->entries = new_entries;
+    index->capacity = new_capacity;
+    return true;
+}
+
+// Delete a posting list, shifting later entries of its probe run back into
+// the hole so lookups never meet a tombstone
+static void index_delete_entry(KeyIndex* index, IndexEntry* entry) {
+    size_t mask = index->capacity - 1;
+    size_t hole = (size_t)(entry - index->entries);
+    free(entry->key);
+    free(entry->positions);
+    
+    for (size_t i = (hole + 1) & mask; index->entries[i].key; i = (i + 1) & mask) {
+        // Entry i may fill the hole only if the hole lies between its home and i
+        size_t home = index->entries[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            index->entries[hole] = index->entries[i];
+            hole = i;
+        }
+    }
+    memset(&index->entries[hole], 0, sizeof(IndexEntry));
+    index->used--;
+}
+
+// Drop one position from a posting list, deleting the list once it empties
+static void index_remove_position(KeyIndex* index, IndexEntry* entry, StoredItem* items,
+                                  size_t slot, bool id_list) {
+    size_t moved = entry->positions[--entry->count];
+    if (slot < entry->count) {
+        entry->positions[slot] = moved;
+        if (id_list) {
+            items[moved].id_slot = slot;
+        } else {
+            items[moved].type_slot = slot;
+        }
+    }
+    if (entry->count == 0) {
+        index_delete_entry(index, entry);
+    }
+}
+
+// Append an item position to the key's posting list
+static bool index_insert(KeyIndex* index, const char* key, size_t len,
+                         size_t position, size_t* slot_out) {
+    // Keep load factor under 3/4
+    if ((index->used + 1) * 4 > index->capacity * 3 && !index_grow(index)) {
         return false;
     }
     
-    strncpy(type_name, compound_key, type_len);
-    type_name[type_len] = '\0';
+    uint32_t hash = index_hash(key, len);
+    IndexEntry* entry = index_probe(index, key, len, hash);
+    if (!entry->key) {
+        entry->key = malloc(len + 1);
+        if (!entry->key) {
+            return false;
+        }
+        memcpy(entry->key, key, len);
+        entry->key[len] = '\0';
+        entry->key_len = len;
+        entry->hash = hash;
+        index->used++;
+    }
+    
+    if (entry->count >= entry->capacity) {
+        size_t new_capacity = entry->capacity ? entry->capacity * 2 : 4;
+        size_t* positions = realloc(entry->positions, new_capacity * sizeof(size_t));
+        if (!positions) {
+            if (entry->count == 0) {
+                index_delete_entry(index, entry);
+            }
+            return false;
+        }
+        entry->positions = positions;
+        entry->capacity = new_capacity;
+    }
+    
+    *slot_out = entry->count;
+    entry->positions[entry->count++] = position;
+    return true;
+}
+
+// Remove items[position] from both indexes in O(1) using its stored slots
+static void index_remove_item_locked(StateStore* store, size_t position) {
+    StoredItem* item = &store->items[position];
+    
+    IndexEntry* entry = index_lookup(&store->type_index, item->compound_key, item->type_len);
+    if (entry && item->type_slot < entry->count) {
+        index_remove_position(&store->type_index, entry, store->items, item->type_slot, false);
+    }
+    
+    const char* id = item_id(item);
+    entry = index_lookup(&store->id_index, id, strlen(id));
+    if (entry && item->id_slot < entry->count) {
+        index_remove_position(&store->id_index, entry, store->items, item->id_slot, true);
+    }
+}
+
+// Add items[position] to both indexes
+static bool index_add_item_locked(StateStore* store, size_t position) {
+    StoredItem* item = &store->items[position];
     
-    strncpy(id, colon + 1, id_size - 1);
-    id[id_size - 1] = '\0';
+    if (!index_insert(&store->type_index, item->compound_key, item->type_len,
+                      position, &item->type_slot)) {
+        return false;
+    }
     
+    const char* id = item_id(item);
+    if (!index_insert(&store->id_index, id, strlen(id), position, &item->id_slot)) {
+        // Undo the type entry so the indexes stay consistent
+        IndexEntry* entry = index_lookup(&store->type_index, item->compound_key, item->type_len);
+        if (entry && entry->count > 0 && --entry->count == 0) {
+            index_delete_entry(&store->type_index, entry);
+        }
+        return false;
+    }
     return true;
 }
 
+// Point the index entries of an item that moved in items[] at its new position
+static void index_move_item_locked(StateStore* store, size_t position) {
+    StoredItem* item = &store->items[position];
+    
+    IndexEntry* entry = index_lookup(&store->type_index, item->compound_key, item->type_len);
+    if (entry && item->type_slot < entry->count) {
+        entry->positions[item->type_slot] = position;
+    }
+    
+    const char* id = item_id(item);
+    entry = index_lookup(&store->id_index, id, strlen(id));
+    if (entry && item->id_slot < entry->count) {
+        entry->positions[item->id_slot] = position;
+    }
+}
+
+// Rebuild both indexes after items[] was compacted
+static void index_rebuild_locked(StateStore* store) {
+    index_clear(&store->type_index);
+    index_clear(&store->id_index);
+    for (size_t i = 0; i < store->num_items; i++) {
+        if (!index_add_item_locked(store, i)) {
+            // Only reachable on OOM; lookups fall back to not-found for the rest
+            log_error("Failed to rebuild state store index at item %zu of %zu",
+                      i, store->num_items);
+            break;
+        }
+    }
+}
+
+// Exact lookup through the id index; returns INDEX_NOT_FOUND if absent
+static size_t find_item_locked(StateStore* store, const char* type_name, const char* id) {
+    IndexEntry* entry = index_lookup(&store->id_index, id, strlen(id));
+    if (!entry) {
+        return INDEX_NOT_FOUND;
+    }
+    
+    size_t type_len = strlen(type_name);
+    for (size_t i = 0; i < entry->count; i++) {
+        StoredItem* item = &store->items[entry->positions[i]];
+        if (item->type_len == type_len && memcmp(item->compound_key, type_name, type_len) == 0) {
+            return entry->positions[i];
+        }
+    }
+    return INDEX_NOT_FOUND;
+}
+
+static bool item_expired(const StoredItem* item, time_t now) {
+    return item->expires_at > 0 && now > item->expires_at;
+}
+
 StateStore* state_store_create(void) {
     StateStore* store = calloc(1, sizeof(StateStore));
     if (!store) {
@@ -130,6 +444,18 @@ StateStore* state_store_create(void) {
     }
     store->item_capacity = INITIAL_STORE_CAPACITY;
     
+    if (!index_init(&store->type_index) || !index_init(&store->id_index)) {
+        log_error("Failed to allocate state store indexes");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate state store indexes");
+        index_free(&store->type_index);
+        free(store->items);
+        free(store->type_configs);
+        pthread_rwlock_destroy(&store->lock);
+        free(store);
+        return NULL;
+    }
+    
     log_info("State store created with capacity %zu items, %zu type configs", 
              store->item_capacity, store->type_config_capacity);
     return store;
@@ -145,6 +471,14 @@ void state_store_destroy(StateStore* store) {
         free(store->items[i].data);
     }
     free(store->items);
+    index_free(&store->type_index);
+    index_free(&store->id_index);
+    
+    // Clean up computed entries
+    for (size_t i = 0; i < store->num_computed; i++) {
+        computed_free(store->computed[i]);
+    }
+    free(store->computed);
     
     // Clean up type configs
     free(store->type_configs);
@@ -198,38 +532,49 @@ bool state_store_configure_type(StateStore* store, const DataTypeConfig* config)
     return true;
 }
 
-DataTypeConfig state_store_get_type_config(StateStore* store, const char* type_name) {
-    DataTypeConfig config = DEFAULT_TYPE_CONFIG;
-    
-    if (!store || !type_name) {
-        return config;
-    }
-    
-    pthread_rwlock_rdlock(&store->lock);
-    
+// Look up a type config; caller must hold the lock (read or write)
+static DataTypeConfig find_type_config_locked(StateStore* store, const char* type_name) {
     for (size_t i = 0; i < store->num_type_configs; i++) {
         if (strcmp(store->type_configs[i].type_name, type_name) == 0) {
-            config = store->type_configs[i].config;
-            pthread_rwlock_unlock(&store->lock);
-            return config;
+            return store->type_configs[i].config;
         }
     }
     
-    pthread_rwlock_unlock(&store->lock);
-    
     // Return default config with type name filled in
+    DataTypeConfig config = DEFAULT_TYPE_CONFIG;
     strncpy(config.type_name, type_name, sizeof(config.type_name) - 1);
     return config;
 }
 
+DataTypeConfig state_store_get_type_config(StateStore* store, const char* type_name) {
+    if (!store || !type_name) {
+        return DEFAULT_TYPE_CONFIG;
+    }
+    
+    pthread_rwlock_rdlock(&store->lock);
+    DataTypeConfig config = find_type_config_locked(store, type_name);
+    pthread_rwlock_unlock(&store->lock);
+    
+    return config;
+}
+
 // Core data operations
-bool state_store_set(StateStore* store, const char* type_name, const char* id,
-                     const void* data, size_t data_size) {
-    if (!store || !type_name || !id || !data || data_size == 0) {
-        log_error("Invalid parameters for state_store_set");
+
+// Outcome of applying one staged write under the lock
+typedef enum {
+    APPLY_FAILED,       // Out of memory; data was freed
+    APPLY_SKIPPED,      // Caching disabled for the type; data was freed
+    APPLY_STORED        // Inserted or replaced
+} ApplyResult;
+
+// Check set parameters; shared by state_store_set and transactions
+static bool validate_set_params(const char* caller, const char* type_name, const char* id,
+                                const void* data, size_t data_size) {
+    if (!type_name || !id || !data || data_size == 0) {
+        log_error("Invalid parameters for %s", caller);
         pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
-                                       "state_store_set: store=%p, type=%s, id=%s, data=%p, size=%zu",
-                                       store, type_name ? type_name : "NULL",
+                                       "%s: type=%s, id=%s, data=%p, size=%zu",
+                                       caller, type_name ? type_name : "NULL",
                                        id ? id : "NULL", data, data_size);
         return false;
     }
@@ -259,66 +604,66 @@ bool state_store_set(StateStore* store, const char* type_name, const char* id,
         return false;
     }
     
-    char compound_key[MAX_COMPOUND_KEY_LENGTH];
-    make_compound_key(compound_key, sizeof(compound_key), type_name, id);
-    
-    pthread_rwlock_wrlock(&store->lock);
+    return true;
+}
+
+// Make room for `additional` new items; caller must hold the write lock
+static bool reserve_items_locked(StateStore* store, size_t additional) {
+    if (store->num_items + additional <= store->item_capacity) {
+        return true;
+    }
     
-    // Check if caching is enabled for this type
-    DataTypeConfig config = state_store_get_type_config(store, type_name);
+    size_t new_capacity = store->item_capacity * 2;
+    while (new_capacity < store->num_items + additional) {
+        new_capacity *= 2;
+    }
+    StoredItem* new_items = realloc(store->items, new_capacity * sizeof(StoredItem));
+    if (!new_items) {
+        log_error("Failed to expand items array");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to expand state items from %zu to %zu",
+                                       store->item_capacity, new_capacity);
+        return false;
+    }
+    store->items = new_items;
+    store->item_capacity = new_capacity;
+    return true;
+}
+
+// Store a value, taking ownership of `data`; caller must hold the write lock
+static ApplyResult apply_set_locked(StateStore* store, const char* type_name, const char* id,
+                                    const char* compound_key, void* data, size_t data_size,
+                                    time_t now) {
+    // Check if caching is enabled for this type (lock already held)
+    DataTypeConfig config = find_type_config_locked(store, type_name);
     if (!config.cache_enabled) {
-        pthread_rwlock_unlock(&store->lock);
+        free(data);
         log_debug("Caching disabled for type '%s', data not stored", type_name);
-        return true; // Success but not stored
+        return APPLY_SKIPPED;
     }
     
-    time_t now = time(NULL);
     time_t expires_at = (config.retention_seconds > 0) ? 
                        now + config.retention_seconds : 0;
     
     // Look for existing item with same compound key
-    for (size_t i = 0; i < store->num_items; i++) {
-        if (strcmp(store->items[i].compound_key, compound_key) == 0) {
-            // Replace existing item
-            StoredItem* item = &store->items[i];
-            
-            // Free old data and allocate new
-            free(item->data);
-            item->data = malloc(data_size);
-            if (!item->data) {
-                log_error("Failed to allocate data for existing item");
-                pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
-                                               "Failed to allocate %zu bytes for state update of '%s'",
-                                               data_size, compound_key);
-                pthread_rwlock_unlock(&store->lock);
-                return false;
-            }
-            
-            memcpy(item->data, data, data_size);
-            item->data_size = data_size;
-            item->timestamp = now;
-            item->expires_at = expires_at;
-            
-            pthread_rwlock_unlock(&store->lock);
-            log_debug("Updated existing item: %s", compound_key);
-            return true;
-        }
+    size_t existing = find_item_locked(store, type_name, id);
+    if (existing != INDEX_NOT_FOUND) {
+        // Replace existing item
+        StoredItem* item = &store->items[existing];
+        free(item->data);
+        item->data = data;
+        item->data_size = data_size;
+        item->timestamp = now;
+        item->expires_at = expires_at;
+        item->version = store->version + 1;  // Caller bumps the version next
+        log_debug("Updated existing item: %s", compound_key);
+        return APPLY_STORED;
     }
     
     // Expand items array if needed
-    if (store->num_items >= store->item_capacity) {
-        size_t new_capacity = store->item_capacity * 2;
-        StoredItem* new_items = realloc(store->items, new_capacity * sizeof(StoredItem));
-        if (!new_items) {
-            log_error("Failed to expand items array");
-            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
-                                           "Failed to expand state items from %zu to %zu",
-                                           store->item_capacity, new_capacity);
-            pthread_rwlock_unlock(&store->lock);
-            return false;
-        }
-        store->items = new_items;
-        store->item_capacity = new_capacity;
+    if (!reserve_items_locked(store, 1)) {
+        free(data);
+        return APPLY_FAILED;
     }
     
     // Add new item
@@ -326,190 +671,928 @@ bool state_store_set(StateStore* store, const char* type_name, const char* id,
     
     strncpy(new_item->compound_key, compound_key, MAX_COMPOUND_KEY_LENGTH - 1);
     new_item->compound_key[MAX_COMPOUND_KEY_LENGTH - 1] = '\0';
-    
-    new_item->data = malloc(data_size);
-    if (!new_item->data) {
-        log_error("Failed to allocate data for new item");
-        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
-                                       "Failed to allocate %zu bytes for new state item '%s'",
-                                       data_size, compound_key);
-        pthread_rwlock_unlock(&store->lock);
-        return false;
-    }
-    
-    memcpy(new_item->data, data, data_size);
+    new_item->type_len = strlen(type_name);
+    new_item->data = data;
     new_item->data_size = data_size;
     new_item->timestamp = now;
     new_item->expires_at = expires_at;
+    new_item->version = store->version + 1;
     
-    store->num_items++;
-    
-    pthread_rwlock_unlock(&store->lock);
+    if (!index_add_item_locked(store, store->num_items)) {
+        log_error("Failed to index new item");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to index new state item '%s'", compound_key);
+        free(data);
+        return APPLY_FAILED;
+    }
     
+    store->num_items++;
+    store->insert_count++;
     log_debug("Added new item: %s (%zu bytes)", compound_key, data_size);
-    
-    // Phase 3: Opportunistic garbage collection of expired items
-    // Only run occasionally to avoid overhead
-    static int set_count = 0;
-    if (++set_count % 100 == 0) {
-        state_store_cleanup_expired(store);
+    return APPLY_STORED;
+}
+
+// Remove one item by key; caller must hold the write lock
+static bool apply_remove_locked(StateStore* store, const char* type_name, const char* id) {
+    size_t i = find_item_locked(store, type_name, id);
+    if (i == INDEX_NOT_FOUND) {
+        return false;
     }
     
+    // Free data
+    index_remove_item_locked(store, i);
+    free(store->items[i].data);
+    
+    // Move last item to this position if not already last
+    if (i < store->num_items - 1) {
+        store->items[i] = store->items[store->num_items - 1];
+        index_move_item_locked(store, i);
+    }
+    store->num_items--;
     return true;
 }
 
-void* state_store_get(StateStore* store, const char* type_name, const char* id,
-                      size_t* size_out, time_t* timestamp_out) {
-    if (!store || !type_name || !id) {
+// Change notification
+
+// Bump the version and copy the listener table; caller must hold the write lock
+static uint64_t begin_notify_locked(StateStore* store, ChangeListener* listeners,
+                                    size_t* listener_count) {
+    memcpy(listeners, store->listeners, store->num_listeners * sizeof(ChangeListener));
+    *listener_count = store->num_listeners;
+    return ++store->version;
+}
+
+// Deliver a change to the listeners copied under the lock (lock not held)
+static void notify_listeners(const ChangeListener* listeners, size_t listener_count,
+                             uint64_t version, const char* const* keys, size_t key_count) {
+    StateChange change = { version, keys, key_count };
+    for (size_t i = 0; i < listener_count; i++) {
+        listeners[i].callback(&change, listeners[i].context);
+    }
+}
+
+bool state_store_set(StateStore* store, const char* type_name, const char* id,
+                     const void* data, size_t data_size) {
+    if (!store) {
         pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
-                                       "state_store_get: store=%p, type=%s, id=%s",
-                                       store, type_name ? type_name : "NULL",
-                                       id ? id : "NULL");
-        return NULL;
+                                       "state_store_set: store is NULL");
+        return false;
+    }
+    if (!validate_set_params("state_store_set", type_name, id, data, data_size)) {
+        return false;
     }
     
     char compound_key[MAX_COMPOUND_KEY_LENGTH];
     make_compound_key(compound_key, sizeof(compound_key), type_name, id);
     
-    pthread_rwlock_rdlock(&store->lock);
-    
-    for (size_t i = 0; i < store->num_items; i++) {
-        if (strcmp(store->items[i].compound_key, compound_key) == 0) {
-            StoredItem* item = &store->items[i];
-            
-            // Check if expired
-            time_t now = time(NULL);
-            if (item->expires_at > 0 && now > item->expires_at) {
-                pthread_rwlock_unlock(&store->lock);
-                log_debug("Item expired: %s", compound_key);
-                return NULL;
-            }
-            
-            // Allocate copy of data to return (caller must free)
-            void* data_copy = malloc(item->data_size);
-            if (!data_copy) {
-                pthread_rwlock_unlock(&store->lock);
-                log_error("Failed to allocate copy of data");
-                pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
-                                               "Failed to allocate %zu bytes for state data copy of '%s'",
-                                               item->data_size, compound_key);
-                return NULL;
-            }
-            
-            memcpy(data_copy, item->data, item->data_size);
-            
-            if (size_out) {
-                *size_out = item->data_size;
-            }
-            if (timestamp_out) {
-                *timestamp_out = item->timestamp;
-            }
-            
-            pthread_rwlock_unlock(&store->lock);
-            // log_debug("Retrieved item: %s (%zu bytes)", compound_key, item->data_size); // Too verbose
-            return data_copy;
-        }
-    }
-    
-    pthread_rwlock_unlock(&store->lock);
-    pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
-                                   "State item '%s' not found", compound_key);
-    return NULL;
-}
-
-bool state_store_has(StateStore* store, const char* type_name, const char* id) {
-    if (!store || !type_name || !id) {
+    // Copy before taking the lock to keep the write section short
+    void* data_copy = malloc(data_size);
+    if (!data_copy) {
+        log_error("Failed to allocate data for item");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate %zu bytes for state item '%s'",
+                                       data_size, compound_key);
         return false;
     }
+    memcpy(data_copy, data, data_size);
     
-    char compound_key[MAX_COMPOUND_KEY_LENGTH];
-    make_compound_key(compound_key, sizeof(compound_key), type_name, id);
+    pthread_rwlock_wrlock(&store->lock);
     
-    pthread_rwlock_rdlock(&store->lock);
+    size_t inserts_before = store->insert_count;
+    ApplyResult result = apply_set_locked(store, type_name, id, compound_key,
+                                          data_copy, data_size, time(NULL));
     
-    for (size_t i = 0; i < store->num_items; i++) {
-        if (strcmp(store->items[i].compound_key, compound_key) == 0) {
-            // Check expiration
-            time_t now = time(NULL);
-            if (store->items[i].expires_at > 0 && now > store->items[i].expires_at) {
-                pthread_rwlock_unlock(&store->lock);
-                return false;  // Expired
-            }
-            pthread_rwlock_unlock(&store->lock);
-            return true;
-        }
+    ChangeListener listeners[MAX_CHANGE_LISTENERS];
+    size_t listener_count = 0;
+    uint64_t version = 0;
+    if (result == APPLY_STORED) {
+        version = begin_notify_locked(store, listeners, &listener_count);
     }
+    bool run_cleanup = store->insert_count / 100 != inserts_before / 100;
     
     pthread_rwlock_unlock(&store->lock);
-    return false;
-}
-
-bool state_store_remove(StateStore* store, const char* type_name, const char* id) {
-    if (!store || !type_name || !id) {
+    
+    if (result == APPLY_FAILED) {
         return false;
     }
     
-    char compound_key[MAX_COMPOUND_KEY_LENGTH];
-    make_compound_key(compound_key, sizeof(compound_key), type_name, id);
-    
-    pthread_rwlock_wrlock(&store->lock);
+    if (result == APPLY_STORED) {
+        const char* keys[1] = { compound_key };
+        notify_listeners(listeners, listener_count, version, keys, 1);
+    }
     
-    for (size_t i = 0; i < store->num_items; i++) {
-        if (strcmp(store->items[i].compound_key, compound_key) == 0) {
-            // Free data
-            free(store->items[i].data);
-            
-            // Move last item to this position if not already last
-            if (i < store->num_items - 1) {
-                store->items[i] = store->items[store->num_items - 1];
-            }
-            store->num_items--;
-            
-            pthread_rwlock_unlock(&store->lock);
-            log_debug("Removed item: %s", compound_key);
-            return true;
-        }
+    // Phase 3: Opportunistic garbage collection of expired items
+    // Only run occasionally to avoid overhead
+    if (run_cleanup) {
+        state_store_cleanup_expired(store);
     }
     
-    pthread_rwlock_unlock(&store->lock);
-    return false;
+    return true; // Skipped (caching disabled) also counts as success
 }
 
-bool state_store_clear_type(StateStore* store, const char* type_name) {
-    if (!store || !type_name) {
+// Computed entries
+
+// Find a computed entry by key; caller must hold the lock (read or write)
+static ComputedEntry* find_computed_locked(StateStore* store, const char* type_name,
+                                           const char* id) {
+    for (size_t i = 0; i < store->num_computed; i++) {
+        ComputedEntry* entry = store->computed[i];
+        if (strcmp(entry->id, id) == 0 && strcmp(entry->type_name, type_name) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Bring the cached value up to date with the inputs; caller must hold
+// entry->cache_lock and not the store lock. Returns false on OOM.
+static bool computed_refresh(StateStore* store, ComputedEntry* entry) {
+    const StoredItem* found[MAX_COMPUTED_INPUTS];
+    uint64_t versions[MAX_COMPUTED_INPUTS];
+    StateComputeInput inputs[MAX_COMPUTED_INPUTS];
+    void* copies[MAX_COMPUTED_INPUTS] = {0};
+    time_t now = time(NULL);
+    bool current = entry->cache_valid;
+    bool ok = true;
+    
+    pthread_rwlock_rdlock(&store->lock);
+    
+    // Input versions decide whether the cached value is still good
+    for (size_t i = 0; i < entry->input_count; i++) {
+        size_t position = find_item_locked(store, entry->inputs[i].type_name,
+                                           entry->inputs[i].id);
+        found[i] = NULL;
+        if (position != INDEX_NOT_FOUND && !item_expired(&store->items[position], now)) {
+            found[i] = &store->items[position];
+        }
+        versions[i] = found[i] ? found[i]->version : 0;
+        current = current && versions[i] == entry->input_versions[i];
+    }
+    
+    // Snapshot the inputs so compute runs without the store lock
+    for (size_t i = 0; !current && i < entry->input_count; i++) {
+        inputs[i] = (StateComputeInput){
+            .type_name = entry->inputs[i].type_name,
+            .id = entry->inputs[i].id
+        };
+        if (!found[i]) {
+            continue;
+        }
+        copies[i] = malloc(found[i]->data_size);
+        if (!copies[i]) {
+            ok = false;
+            break;
+        }
+        memcpy(copies[i], found[i]->data, found[i]->data_size);
+        inputs[i].data = copies[i];
+        inputs[i].data_size = found[i]->data_size;
+        inputs[i].timestamp = found[i]->timestamp;
+    }
+    
+    pthread_rwlock_unlock(&store->lock);
+    
+    entry->reads++;
+    if (current) {
+        return true;
+    }
+    
+    if (ok) {
+        time_t newest = 0;
+        for (size_t i = 0; i < entry->input_count; i++) {
+            if (inputs[i].timestamp > newest) {
+                newest = inputs[i].timestamp;
+            }
+        }
+        memset(entry->value, 0, entry->value_size);
+        entry->has_value = entry->compute(inputs, entry->input_count, entry->value,
+                                          entry->context);
+        entry->value_timestamp = newest;
+        memcpy(entry->input_versions, versions, entry->input_count * sizeof(uint64_t));
+        entry->cache_valid = true;
+        entry->recomputes++;
+    } else {
+        log_error("Failed to snapshot inputs for computed entry %s:%s",
+                  entry->type_name, entry->id);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to snapshot inputs of computed entry '%s:%s'",
+                                       entry->type_name, entry->id);
+    }
+    
+    for (size_t i = 0; i < entry->input_count; i++) {
+        free(copies[i]);
+    }
+    return ok;
+}
+
+// Read a computed entry like a stored item (store lock not held)
+static void* computed_get(StateStore* store, ComputedEntry* entry,
+                          size_t* size_out, time_t* timestamp_out) {
+    pthread_mutex_lock(&entry->cache_lock);
+    
+    if (!computed_refresh(store, entry)) {
+        pthread_mutex_unlock(&entry->cache_lock);
+        return NULL;
+    }
+    if (!entry->has_value) {
+        pthread_mutex_unlock(&entry->cache_lock);
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+                                       "Computed item '%s:%s' has no value for its inputs",
+                                       entry->type_name, entry->id);
+        return NULL;
+    }
+    
+    void* data_copy = malloc(entry->value_size);
+    if (!data_copy) {
+        pthread_mutex_unlock(&entry->cache_lock);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate %zu bytes for computed item '%s:%s'",
+                                       entry->value_size, entry->type_name, entry->id);
+        return NULL;
+    }
+    memcpy(data_copy, entry->value, entry->value_size);
+    if (size_out) {
+        *size_out = entry->value_size;
+    }
+    if (timestamp_out) {
+        *timestamp_out = entry->value_timestamp;
+    }
+    
+    pthread_mutex_unlock(&entry->cache_lock);
+    return data_copy;
+}
+
+void* state_store_get(StateStore* store, const char* type_name, const char* id,
+                      size_t* size_out, time_t* timestamp_out) {
+    if (!store || !type_name || !id) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+                                       "state_store_get: store=%p, type=%s, id=%s",
+                                       store, type_name ? type_name : "NULL",
+                                       id ? id : "NULL");
+        return NULL;
+    }
+    
+    char compound_key[MAX_COMPOUND_KEY_LENGTH];
+    make_compound_key(compound_key, sizeof(compound_key), type_name, id);
+    
+    pthread_rwlock_rdlock(&store->lock);
+    
+    size_t position = find_item_locked(store, type_name, id);
+    if (position != INDEX_NOT_FOUND && store->items[position].data) {
+        StoredItem* item = &store->items[position];
+        
+        // Check if expired
+        if (item_expired(item, time(NULL))) {
+            pthread_rwlock_unlock(&store->lock);
+            log_debug("Item expired: %s", compound_key);
+            return NULL;
+        }
+        
+        // Allocate copy of data to return (caller must free)
+        void* data_copy = malloc(item->data_size);
+        if (!data_copy) {
+            pthread_rwlock_unlock(&store->lock);
+            log_error("Failed to allocate copy of data");
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                           "Failed to allocate %zu bytes for state data copy of '%s'",
+                                           item->data_size, compound_key);
+            return NULL;
+        }
+        
+        memcpy(data_copy, item->data, item->data_size);
+        
+        if (size_out) {
+            *size_out = item->data_size;
+        }
+        if (timestamp_out) {
+            *timestamp_out = item->timestamp;
+        }
+        
+        pthread_rwlock_unlock(&store->lock);
+        // log_debug("Retrieved item: %s (%zu bytes)", compound_key, item->data_size); // Too verbose
+        return data_copy;
+    }
+    
+    ComputedEntry* computed = position == INDEX_NOT_FOUND ?
+                              find_computed_locked(store, type_name, id) : NULL;
+    pthread_rwlock_unlock(&store->lock);
+    
+    if (computed) {
+        return computed_get(store, computed, size_out, timestamp_out);
+    }
+    
+    pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+                                   "State item '%s' not found", compound_key);
+    return NULL;
+}
+
+bool state_store_has(StateStore* store, const char* type_name, const char* id) {
+    if (!store || !type_name || !id) {
+        return false;
+    }
+    
+    pthread_rwlock_rdlock(&store->lock);
+    
+    size_t position = find_item_locked(store, type_name, id);
+    bool found = position != INDEX_NOT_FOUND &&
+                 !item_expired(&store->items[position], time(NULL));
+    ComputedEntry* computed = position == INDEX_NOT_FOUND ?
+                              find_computed_locked(store, type_name, id) : NULL;
+    
+    pthread_rwlock_unlock(&store->lock);
+    
+    if (computed) {
+        pthread_mutex_lock(&computed->cache_lock);
+        found = computed_refresh(store, computed) && computed->has_value;
+        pthread_mutex_unlock(&computed->cache_lock);
+    }
+    return found;
+}
+
+bool state_store_remove(StateStore* store, const char* type_name, const char* id) {
+    if (!store || !type_name || !id) {
+        return false;
+    }
+    
+    char compound_key[MAX_COMPOUND_KEY_LENGTH];
+    make_compound_key(compound_key, sizeof(compound_key), type_name, id);
+    
+    pthread_rwlock_wrlock(&store->lock);
+    
+    if (!apply_remove_locked(store, type_name, id)) {
+        pthread_rwlock_unlock(&store->lock);
+        return false;
+    }
+    
+    ChangeListener listeners[MAX_CHANGE_LISTENERS];
+    size_t listener_count = 0;
+    uint64_t version = begin_notify_locked(store, listeners, &listener_count);
+    
+    pthread_rwlock_unlock(&store->lock);
+    log_debug("Removed item: %s", compound_key);
+    
+    const char* keys[1] = { compound_key };
+    notify_listeners(listeners, listener_count, version, keys, 1);
+    return true;
+}
+
+// Change listeners
+
+bool state_store_add_change_listener(StateStore* store, state_store_change_callback callback,
+                                     void* user_context) {
+    if (!store || !callback) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+                                       "state_store_add_change_listener: store=%p, callback=%s",
+                                       (void*)store, callback ? "set" : "NULL");
+        return false;
+    }
+    
+    pthread_rwlock_wrlock(&store->lock);
+    if (store->num_listeners >= MAX_CHANGE_LISTENERS) {
+        pthread_rwlock_unlock(&store->lock);
+        pk_set_last_error_with_context(PK_ERROR_RESOURCE_LIMIT,
+                                       "State store already has %d change listeners",
+                                       MAX_CHANGE_LISTENERS);
+        return false;
+    }
+    store->listeners[store->num_listeners++] = (ChangeListener){ callback, user_context };
+    pthread_rwlock_unlock(&store->lock);
+    return true;
+}
+
+bool state_store_remove_change_listener(StateStore* store, state_store_change_callback callback,
+                                        void* user_context) {
+    if (!store || !callback) {
         return false;
     }
     
     pthread_rwlock_wrlock(&store->lock);
+    for (size_t i = 0; i < store->num_listeners; i++) {
+        if (store->listeners[i].callback == callback &&
+            store->listeners[i].context == user_context) {
+            memmove(&store->listeners[i], &store->listeners[i + 1],
+                    (store->num_listeners - i - 1) * sizeof(ChangeListener));
+            store->num_listeners--;
+            pthread_rwlock_unlock(&store->lock);
+            return true;
+        }
+    }
+    pthread_rwlock_unlock(&store->lock);
+    return false;
+}
+
+uint64_t state_store_get_version(StateStore* store) {
+    if (!store) {
+        return 0;
+    }
+    
+    pthread_rwlock_rdlock(&store->lock);
+    uint64_t version = store->version;
+    pthread_rwlock_unlock(&store->lock);
+    return version;
+}
+
+// Computed state
+
+// Check a definition and build its entry; returns NULL on error
+static ComputedEntry* computed_create(const ComputedStateConfig* config) {
+    if (!config->type_name || !config->id || !config->inputs || !config->compute ||
+        config->input_count == 0 || config->input_count > MAX_COMPUTED_INPUTS ||
+        config->value_size == 0 || config->value_size > MAX_STATE_ITEM_SIZE) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+                                       "state_store_define_computed: type=%s, id=%s, "
+                                       "inputs=%zu, value_size=%zu",
+                                       config->type_name ? config->type_name : "NULL",
+                                       config->id ? config->id : "NULL",
+                                       config->input_count, config->value_size);
+        return NULL;
+    }
+    if (strlen(config->type_name) >= MAX_TYPE_NAME_LENGTH ||
+        strlen(config->id) >= MAX_ID_LENGTH) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+                                       "Computed key '%s:%s' is too long",
+                                       config->type_name, config->id);
+        return NULL;
+    }
+    
+    ComputedEntry* entry = calloc(1, sizeof(ComputedEntry));
+    if (!entry) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate computed entry");
+        return NULL;
+    }
     
-    char type_prefix[MAX_TYPE_NAME_LENGTH + 2];
-    snprintf(type_prefix, sizeof(type_prefix), "%s:", type_name);
-    size_t prefix_len = strlen(type_prefix);
+    strcpy(entry->type_name, config->type_name);
+    strcpy(entry->id, config->id);
+    entry->input_count = config->input_count;
+    entry->value_size = config->value_size;
+    entry->compute = config->compute;
+    entry->context = config->user_context;
+    
+    for (size_t i = 0; i < config->input_count; i++) {
+        const char* key = config->inputs[i];
+        const char* colon = key ? strchr(key, ':') : NULL;
+        size_t type_len = colon ? (size_t)(colon - key) : 0;
+        if (!colon || type_len == 0 || type_len >= MAX_TYPE_NAME_LENGTH ||
+            strlen(colon + 1) >= MAX_ID_LENGTH) {
+            pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+                                           "Computed entry '%s:%s' input %zu is not "
+                                           "a \"type:id\" key: %s",
+                                           config->type_name, config->id, i,
+                                           key ? key : "NULL");
+            free(entry);
+            return NULL;
+        }
+        memcpy(entry->inputs[i].type_name, key, type_len);
+        strcpy(entry->inputs[i].id, colon + 1);
+    }
+    
+    entry->value = malloc(config->value_size);
+    if (!entry->value) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate %zu byte computed value",
+                                       config->value_size);
+        free(entry);
+        return NULL;
+    }
+    
+    if (pthread_mutex_init(&entry->cache_lock, NULL) != 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                                       "pthread_mutex_init failed for computed entry");
+        free(entry->value);
+        free(entry);
+        return NULL;
+    }
+    return entry;
+}
+
+static bool computed_same_definition(const ComputedEntry* a, const ComputedEntry* b) {
+    return a->compute == b->compute && a->context == b->context &&
+           a->value_size == b->value_size && a->input_count == b->input_count &&
+           memcmp(a->inputs, b->inputs, a->input_count * sizeof(ComputedInputKey)) == 0;
+}
+
+static void computed_free(ComputedEntry* entry) {
+    pthread_mutex_destroy(&entry->cache_lock);
+    free(entry->value);
+    free(entry);
+}
+
+bool state_store_define_computed(StateStore* store, const ComputedStateConfig* config) {
+    if (!store || !config) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+                                       "state_store_define_computed: store=%p, config=%p",
+                                       (void*)store, (const void*)config);
+        return false;
+    }
+    
+    ComputedEntry* entry = computed_create(config);
+    if (!entry) {
+        return false;
+    }
+    
+    pthread_rwlock_wrlock(&store->lock);
+    
+    ComputedEntry* existing = find_computed_locked(store, entry->type_name, entry->id);
+    if (existing) {
+        bool same = computed_same_definition(existing, entry);
+        pthread_rwlock_unlock(&store->lock);
+        computed_free(entry);
+        if (!same) {
+            pk_set_last_error_with_context(PK_ERROR_ALREADY_EXISTS,
+                                           "Computed entry '%s:%s' is already defined "
+                                           "differently", config->type_name, config->id);
+        }
+        return same;
+    }
+    
+    if (store->num_computed >= store->computed_capacity) {
+        size_t new_capacity = store->computed_capacity ?
+                              store->computed_capacity * 2 : INITIAL_COMPUTED_CAPACITY;
+        ComputedEntry** new_computed = realloc(store->computed,
+                                               new_capacity * sizeof(ComputedEntry*));
+        if (!new_computed) {
+            pthread_rwlock_unlock(&store->lock);
+            computed_free(entry);
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                           "Failed to grow computed entry table to %zu",
+                                           new_capacity);
+            return false;
+        }
+        store->computed = new_computed;
+        store->computed_capacity = new_capacity;
+    }
+    store->computed[store->num_computed++] = entry;
+    
+    pthread_rwlock_unlock(&store->lock);
+    log_info("Defined computed state '%s:%s' over %zu inputs",
+             entry->type_name, entry->id, entry->input_count);
+    return true;
+}
+
+bool state_store_get_computed_stats(StateStore* store, const char* type_name, const char* id,
+                                    ComputedStateStats* stats) {
+    if (!store || !type_name || !id || !stats) {
+        return false;
+    }
+    
+    pthread_rwlock_rdlock(&store->lock);
+    ComputedEntry* entry = find_computed_locked(store, type_name, id);
+    pthread_rwlock_unlock(&store->lock);
+    
+    if (!entry) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&entry->cache_lock);
+    stats->reads = entry->reads;
+    stats->recomputes = entry->recomputes;
+    pthread_mutex_unlock(&entry->cache_lock);
+    return true;
+}
+
+// Transactions
+
+// One staged write; a later write to the same key replaces it
+typedef struct {
+    char type_name[MAX_TYPE_NAME_LENGTH];
+    char id[MAX_ID_LENGTH];
+    char compound_key[MAX_COMPOUND_KEY_LENGTH];
+    uint32_t key_hash;  // Cheap duplicate check before strcmp
+    void* data;         // Owned copy, NULL for a remove
+    size_t data_size;
+} StagedWrite;
+
+struct StateTransaction {
+    StateStore* store;
+    StagedWrite* writes;
+    size_t count;
+    size_t capacity;
+    bool failed;        // A staging error makes commit discard everything
+};
+
+StateTransaction* state_store_begin(StateStore* store) {
+    if (!store) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM, "state_store_begin: store is NULL");
+        return NULL;
+    }
+    
+    StateTransaction* txn = calloc(1, sizeof(StateTransaction));
+    if (!txn) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate state transaction");
+        return NULL;
+    }
+    txn->store = store;
+    return txn;
+}
+
+// Find or append the staged slot for a key (lengths already validated)
+static StagedWrite* txn_stage(StateTransaction* txn, const char* type_name, const char* id) {
+    size_t type_len = strlen(type_name);
+    size_t id_len = strlen(id);
+    char compound_key[MAX_COMPOUND_KEY_LENGTH];
+    memcpy(compound_key, type_name, type_len);
+    compound_key[type_len] = ':';
+    memcpy(compound_key + type_len + 1, id, id_len + 1);
+    uint32_t key_hash = index_hash(compound_key, type_len + 1 + id_len);
+    
+    for (size_t i = 0; i < txn->count; i++) {
+        if (txn->writes[i].key_hash == key_hash &&
+            strcmp(txn->writes[i].compound_key, compound_key) == 0) {
+            free(txn->writes[i].data);
+            txn->writes[i].data = NULL;
+            return &txn->writes[i];
+        }
+    }
+    
+    if (txn->count >= txn->capacity) {
+        size_t new_capacity = txn->capacity ? txn->capacity * 2 : 8;
+        StagedWrite* writes = realloc(txn->writes, new_capacity * sizeof(StagedWrite));
+        if (!writes) {
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                           "Failed to grow state transaction to %zu writes",
+                                           new_capacity);
+            return NULL;
+        }
+        txn->writes = writes;
+        txn->capacity = new_capacity;
+    }
+    
+    StagedWrite* write = &txn->writes[txn->count++];
+    memcpy(write->type_name, type_name, type_len + 1);
+    memcpy(write->id, id, id_len + 1);
+    memcpy(write->compound_key, compound_key, type_len + id_len + 2);
+    write->key_hash = key_hash;
+    write->data = NULL;
+    write->data_size = 0;
+    return write;
+}
+
+bool state_store_txn_set(StateTransaction* txn, const char* type_name, const char* id,
+                         const void* data, size_t data_size) {
+    if (!txn) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM, "state_store_txn_set: txn is NULL");
+        return false;
+    }
+    if (!validate_set_params("state_store_txn_set", type_name, id, data, data_size)) {
+        txn->failed = true;
+        return false;
+    }
+    
+    void* data_copy = malloc(data_size);
+    StagedWrite* write = data_copy ? txn_stage(txn, type_name, id) : NULL;
+    if (!write) {
+        free(data_copy);
+        if (!data_copy) {
+            pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                           "Failed to allocate %zu bytes for staged '%s:%s'",
+                                           data_size, type_name, id);
+        }
+        txn->failed = true;
+        return false;
+    }
+    
+    memcpy(data_copy, data, data_size);
+    write->data = data_copy;
+    write->data_size = data_size;
+    return true;
+}
+
+bool state_store_txn_remove(StateTransaction* txn, const char* type_name, const char* id) {
+    if (!txn || !type_name || !id) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+                                       "state_store_txn_remove: txn=%p, type=%s, id=%s",
+                                       (void*)txn, type_name ? type_name : "NULL",
+                                       id ? id : "NULL");
+        if (txn) {
+            txn->failed = true;
+        }
+        return false;
+    }
+    if (strlen(type_name) >= MAX_TYPE_NAME_LENGTH || strlen(id) >= MAX_ID_LENGTH) {
+        // Could never have been stored; nothing to remove
+        return true;
+    }
     
+    if (!txn_stage(txn, type_name, id)) {
+        txn->failed = true;
+        return false;
+    }
+    return true;
+}
+
+void state_store_abort(StateTransaction* txn) {
+    if (!txn) {
+        return;
+    }
+    for (size_t i = 0; i < txn->count; i++) {
+        free(txn->writes[i].data);
+    }
+    free(txn->writes);
+    free(txn);
+}
+
+bool state_store_commit(StateTransaction* txn) {
+    if (!txn) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM, "state_store_commit: txn is NULL");
+        return false;
+    }
+    if (txn->failed) {
+        log_warn("Discarding state transaction with %zu writes after a staging error",
+                 txn->count);
+        state_store_abort(txn);
+        pk_set_last_error_with_context(PK_ERROR_INVALID_STATE,
+                                       "state_store_commit: transaction had a staging error");
+        return false;
+    }
+    if (txn->count == 0) {
+        state_store_abort(txn);
+        return true;
+    }
+    
+    StateStore* store = txn->store;
+    const char** keys = malloc(txn->count * sizeof(const char*));
+    if (!keys) {
+        state_store_abort(txn);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate commit key list");
+        return false;
+    }
+    
+    // Count inserts that may be needed before touching anything
+    size_t max_inserts = 0;
+    for (size_t i = 0; i < txn->count; i++) {
+        max_inserts += txn->writes[i].data != NULL;
+    }
+    
+    pthread_rwlock_wrlock(&store->lock);
+    
+    if (!reserve_items_locked(store, max_inserts)) {
+        pthread_rwlock_unlock(&store->lock);
+        free(keys);
+        state_store_abort(txn);
+        return false;
+    }
+    
+    time_t now = time(NULL);
+    size_t inserts_before = store->insert_count;
+    size_t key_count = 0;
+    bool ok = true;
+    
+    for (size_t i = 0; i < txn->count; i++) {
+        StagedWrite* write = &txn->writes[i];
+        bool changed;
+        if (write->data) {
+            ApplyResult result = apply_set_locked(store, write->type_name, write->id,
+                                                  write->compound_key, write->data,
+                                                  write->data_size, now);
+            write->data = NULL;  // Ownership moved to the store
+            changed = result == APPLY_STORED;
+            ok &= result != APPLY_FAILED;
+        } else {
+            changed = apply_remove_locked(store, write->type_name, write->id);
+        }
+        if (changed) {
+            keys[key_count++] = write->compound_key;
+        }
+    }
+    
+    ChangeListener listeners[MAX_CHANGE_LISTENERS];
+    size_t listener_count = 0;
+    uint64_t version = 0;
+    if (key_count > 0) {
+        version = begin_notify_locked(store, listeners, &listener_count);
+    }
+    bool run_cleanup = store->insert_count / 100 != inserts_before / 100;
+    
+    pthread_rwlock_unlock(&store->lock);
+    
+    if (!ok) {
+        // Only reachable if indexing a new item ran out of memory
+        log_error("State transaction partially applied (%zu of %zu writes)",
+                  key_count, txn->count);
+    }
+    
+    log_debug("Committed state transaction: %zu writes, %zu changed, version %llu",
+              txn->count, key_count, (unsigned long long)version);
+    
+    if (key_count > 0) {
+        notify_listeners(listeners, listener_count, version, keys, key_count);
+    }
+    
+    free(keys);
+    state_store_abort(txn);
+    
+    if (run_cleanup) {
+        state_store_cleanup_expired(store);
+    }
+    return ok;
+}
+
+// Bulk removal
+
+typedef bool (*item_predicate)(const StoredItem* item, const void* context);
+
+// Remove every item the predicate selects, compacting items[] and rebuilding
+// the index. The removed keys are copied into one allocation (*keys, caller
+// frees) so they can be notified after the lock is dropped; *keys is NULL if
+// that allocation failed. Caller must hold the write lock.
+static size_t remove_matching_locked(StateStore* store, item_predicate matches,
+                                     const void* context, const char*** keys) {
     size_t removed = 0;
+    size_t key_bytes = 0;
+    for (size_t i = 0; i < store->num_items; i++) {
+        if (matches(&store->items[i], context)) {
+            removed++;
+            key_bytes += strlen(store->items[i].compound_key) + 1;
+        }
+    }
+    *keys = NULL;
+    if (removed == 0) {
+        return 0;
+    }
+    
+    *keys = malloc(removed * sizeof(const char*) + key_bytes);
+    char* text = *keys ? (char*)(*keys + removed) : NULL;
+    size_t key_index = 0;
     size_t write_idx = 0;
     
-    // Remove all items matching type prefix
     for (size_t read_idx = 0; read_idx < store->num_items; read_idx++) {
-        if (strncmp(store->items[read_idx].compound_key, type_prefix, prefix_len) == 0) {
-            // Item matches type - free and skip
-            free(store->items[read_idx].data);
-            removed++;
+        StoredItem* item = &store->items[read_idx];
+        if (matches(item, context)) {
+            if (text) {
+                size_t len = strlen(item->compound_key) + 1;
+                memcpy(text, item->compound_key, len);
+                (*keys)[key_index++] = text;
+                text += len;
+            }
+            free(item->data);
         } else {
             // Keep item - move to write position
             if (write_idx != read_idx) {
-                store->items[write_idx] = store->items[read_idx];
+                store->items[write_idx] = *item;
             }
             write_idx++;
         }
     }
     
     store->num_items = write_idx;
+    index_rebuild_locked(store);
+    return removed;
+}
+
+// Notify a bulk removal; without a key list, report the pattern that was cleared
+static void notify_removed(const ChangeListener* listeners, size_t listener_count,
+                           uint64_t version, const char** keys, size_t removed,
+                           const char* fallback_pattern) {
+    if (keys) {
+        notify_listeners(listeners, listener_count, version, keys, removed);
+    } else {
+        log_error("Out of memory listing %zu removed state keys; notifying '%s'",
+                  removed, fallback_pattern);
+        const char* pattern[1] = { fallback_pattern };
+        notify_listeners(listeners, listener_count, version, pattern, 1);
+    }
+}
+
+static bool item_has_type(const StoredItem* item, const void* context) {
+    const char* type_name = context;
+    return strncmp(item->compound_key, type_name, item->type_len) == 0 &&
+           type_name[item->type_len] == '\0';
+}
+
+static bool item_any(const StoredItem* item, const void* context) {
+    (void)item;
+    (void)context;
+    return true;
+}
+
+bool state_store_clear_type(StateStore* store, const char* type_name) {
+    if (!store || !type_name) {
+        return false;
+    }
+    
+    pthread_rwlock_wrlock(&store->lock);
+    
+    const char** keys;
+    size_t removed = remove_matching_locked(store, item_has_type, type_name, &keys);
+    
+    ChangeListener listeners[MAX_CHANGE_LISTENERS];
+    size_t listener_count = 0;
+    uint64_t version = 0;
+    if (removed > 0) {
+        version = begin_notify_locked(store, listeners, &listener_count);
+    }
     pthread_rwlock_unlock(&store->lock);
     
     if (removed > 0) {
         log_info("Cleared %zu items of type '%s'", removed, type_name);
+        
+        char pattern[MAX_TYPE_NAME_LENGTH + 3];
+        snprintf(pattern, sizeof(pattern), "%.*s:*", MAX_TYPE_NAME_LENGTH - 1, type_name);
+        notify_removed(listeners, listener_count, version, keys, removed, pattern);
     }
+    free(keys);
     return removed > 0;
 }
 
@@ -520,104 +1603,418 @@ void state_store_clear_all(StateStore* store) {
     
     pthread_rwlock_wrlock(&store->lock);
     
-    // Free all data
-    for (size_t i = 0; i < store->num_items; i++) {
-        free(store->items[i].data);
-    }
-    
-    size_t count = store->num_items;
-    store->num_items = 0;
+    const char** keys;
+    size_t count = remove_matching_locked(store, item_any, NULL, &keys);
     
+    ChangeListener listeners[MAX_CHANGE_LISTENERS];
+    size_t listener_count = 0;
+    uint64_t version = 0;
+    if (count > 0) {
+        version = begin_notify_locked(store, listeners, &listener_count);
+    }
     pthread_rwlock_unlock(&store->lock);
+    
     log_info("Cleared all %zu items from state store", count);
+    if (count > 0) {
+        notify_removed(listeners, listener_count, version, keys, count, "*:*");
+    }
+    free(keys);
 }
 
-// Iteration
-bool state_store_iterate(StateStore* store, const char* type_name,
-                        state_store_iterator iterator, void* context) {
-    if (!store || !iterator) {
-        return false;
+// Key matching for wildcard queries
+
+typedef enum {
+    MATCH_ANY,          // "*"
+    MATCH_EXACT,        // No wildcards
+    MATCH_PREFIX,       // "abc*"
+    MATCH_SUFFIX,       // "*abc"
+    MATCH_GLOB          // Anything else with '*' or '?'
+} MatchKind;
+
+// One side (type or id) of a compiled "type:id" pattern
+typedef struct {
+    MatchKind kind;
+    const char* text;   // Literal part for EXACT/PREFIX/SUFFIX, whole pattern for GLOB
+    size_t len;
+} KeyMatcher;
+
+static KeyMatcher matcher_compile(const char* pattern, size_t len) {
+    KeyMatcher m = { MATCH_GLOB, pattern, len };
+    
+    size_t stars = 0;
+    bool question = false;
+    for (size_t i = 0; i < len; i++) {
+        stars += pattern[i] == '*';
+        question |= pattern[i] == '?';
     }
     
-    pthread_rwlock_rdlock(&store->lock);
-    
-    // If type_name specified, build prefix to match
-    char type_prefix[MAX_TYPE_NAME_LENGTH + 2];
-    size_t prefix_len = 0;
-    if (type_name) {
-        snprintf(type_prefix, sizeof(type_prefix), "%s:", type_name);
-        prefix_len = strlen(type_prefix);
+    if (question || stars > 1) {
+        if (stars == len) {
+            m.kind = MATCH_ANY;
+        }
+        return m;
     }
-    
-    bool continue_iteration = true;
-    time_t now = time(NULL);
-    
-    for (size_t i = 0; i < store->num_items && continue_iteration; i++) {
-        StoredItem* item = &store->items[i];
-        
-        // Skip if doesn't match type filter
-        if (type_name && strncmp(item->compound_key, type_prefix, prefix_len) != 0) {
+    if (stars == 0) {
+        m.kind = MATCH_EXACT;
+    } else if (len == 1) {
+        m.kind = MATCH_ANY;
+    } else if (pattern[len - 1] == '*') {
+        m.kind = MATCH_PREFIX;
+        m.len = len - 1;
+    } else if (pattern[0] == '*') {
+        m.kind = MATCH_SUFFIX;
+        m.text = pattern + 1;
+        m.len = len - 1;
+    }
+    return m;
+}
+
+// Iterative glob with single-star backtracking: '*' any run, '?' one char
+static bool glob_match(const char* p, size_t plen, const char* s, size_t slen) {
+    size_t pi = 0, si = 0;
+    size_t star = INDEX_NOT_FOUND, resume = 0;
+    
+    while (si < slen) {
+        if (pi < plen && (p[pi] == '?' || p[pi] == s[si])) {
+            pi++;
+            si++;
+        } else if (pi < plen && p[pi] == '*') {
+            star = pi++;
+            resume = si;
+        } else if (star != INDEX_NOT_FOUND) {
+            pi = star + 1;
+            si = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (pi < plen && p[pi] == '*') {
+        pi++;
+    }
+    return pi == plen;
+}
+
+static bool matcher_match(const KeyMatcher* m, const char* s, size_t len) {
+    switch (m->kind) {
+        case MATCH_ANY:
+            return true;
+        case MATCH_EXACT:
+            return len == m->len && memcmp(s, m->text, len) == 0;
+        case MATCH_PREFIX:
+            return len >= m->len && memcmp(s, m->text, m->len) == 0;
+        case MATCH_SUFFIX:
+            return len >= m->len && memcmp(s + len - m->len, m->text, m->len) == 0;
+        case MATCH_GLOB:
+            return glob_match(m->text, m->len, s, len);
+    }
+    return false;
+}
+
+// Snapshot iteration
+//
+// Matching items are copied out under the read lock and callbacks run after
+// it is released, so callbacks may read or write the store and a slow
+// callback never blocks writers.
+
+typedef struct {
+    const char* type_name;
+    const char* id;
+    const void* data;
+    size_t data_size;
+    time_t timestamp;
+} SnapshotEntry;
+
+typedef struct {
+    SnapshotEntry* entries;
+    size_t count;
+    char* arena;        // Keys and payloads for all entries
+} Snapshot;
+
+typedef struct {
+    size_t* positions;
+    size_t count;
+    size_t capacity;
+} PositionList;
+
+static bool position_list_push(PositionList* list, size_t position) {
+    if (list->count >= list->capacity) {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : 32;
+        size_t* positions = realloc(list->positions, new_capacity * sizeof(size_t));
+        if (!positions) {
+            return false;
+        }
+        list->positions = positions;
+        list->capacity = new_capacity;
+    }
+    list->positions[list->count++] = position;
+    return true;
+}
+
+// Filter one posting list (or all items if NULL) against both matchers
+static bool collect_candidates_locked(StateStore* store, const IndexEntry* entry,
+                                      const KeyMatcher* type_match, const KeyMatcher* id_match,
+                                      time_t now, PositionList* out) {
+    size_t count = entry ? entry->count : store->num_items;
+    for (size_t i = 0; i < count; i++) {
+        size_t position = entry ? entry->positions[i] : i;
+        StoredItem* item = &store->items[position];
+        if (!item->data || item_expired(item, now)) {
             continue;
         }
-        
-        // Skip if expired
-        if (item->expires_at > 0 && now > item->expires_at) {
+        if (!matcher_match(type_match, item->compound_key, item->type_len)) {
+            continue;
+        }
+        const char* id = item_id(item);
+        if (!matcher_match(id_match, id, strlen(id))) {
             continue;
         }
+        if (!position_list_push(out, position)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Choose the cheapest index path for a query and collect matching positions
+static bool find_matches_locked(StateStore* store, const KeyMatcher* type_match,
+                                const KeyMatcher* id_match, PositionList* out) {
+    time_t now = time(NULL);
+    
+    // An exact side reduces the query to one posting list
+    if (type_match->kind == MATCH_EXACT || id_match->kind == MATCH_EXACT) {
+        const IndexEntry* by_type = type_match->kind == MATCH_EXACT ?
+            index_lookup(&store->type_index, type_match->text, type_match->len) : NULL;
+        const IndexEntry* by_id = id_match->kind == MATCH_EXACT ?
+            index_lookup(&store->id_index, id_match->text, id_match->len) : NULL;
         
-        // Split compound key
-        char item_type[MAX_TYPE_NAME_LENGTH];
-        char item_id[MAX_ID_LENGTH];
-        if (!split_compound_key(item->compound_key, 
-                              item_type, sizeof(item_type),
-                              item_id, sizeof(item_id))) {
+        const IndexEntry* entry;
+        if (type_match->kind == MATCH_EXACT && id_match->kind == MATCH_EXACT) {
+            if (!by_type || !by_id) {
+                return true;
+            }
+            entry = by_type->count <= by_id->count ? by_type : by_id;
+        } else {
+            entry = type_match->kind == MATCH_EXACT ? by_type : by_id;
+            if (!entry) {
+                return true;
+            }
+        }
+        return collect_candidates_locked(store, entry, type_match, id_match, now, out);
+    }
+    
+    // Partial patterns match against distinct keys, then expand their lists
+    const KeyIndex* index = NULL;
+    const KeyMatcher* key_match = NULL;
+    if (type_match->kind != MATCH_ANY) {
+        index = &store->type_index;
+        key_match = type_match;
+    } else if (id_match->kind != MATCH_ANY) {
+        index = &store->id_index;
+        key_match = id_match;
+    }
+    
+    if (!index) {
+        return collect_candidates_locked(store, NULL, type_match, id_match, now, out);
+    }
+    
+    for (size_t i = 0; i < index->capacity; i++) {
+        const IndexEntry* entry = &index->entries[i];
+        if (!entry->key || entry->count == 0 ||
+            !matcher_match(key_match, entry->key, entry->key_len)) {
             continue;
         }
+        if (!collect_candidates_locked(store, entry, type_match, id_match, now, out)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void snapshot_free(Snapshot* snapshot) {
+    free(snapshot->entries);
+    free(snapshot->arena);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+// Copy the matched items into one arena; caller must hold the lock
+static bool snapshot_copy_locked(StateStore* store, const PositionList* matches,
+                                 Snapshot* snapshot) {
+    if (matches->count == 0) {
+        return true;
+    }
+    
+    // Payloads first and aligned so callbacks can cast them to structs,
+    // then the keys packed after them
+    const size_t align = _Alignof(max_align_t);
+    size_t data_size = 0;
+    size_t key_size = 0;
+    for (size_t i = 0; i < matches->count; i++) {
+        StoredItem* item = &store->items[matches->positions[i]];
+        data_size += (item->data_size + align - 1) & ~(align - 1);
+        key_size += strlen(item->compound_key) + 1;
+    }
+    
+    snapshot->entries = malloc(matches->count * sizeof(SnapshotEntry));
+    snapshot->arena = malloc(data_size + key_size);
+    if (!snapshot->entries || !snapshot->arena) {
+        return false;
+    }
+    
+    char* data_cursor = snapshot->arena;
+    char* key_cursor = snapshot->arena + data_size;
+    for (size_t i = 0; i < matches->count; i++) {
+        StoredItem* item = &store->items[matches->positions[i]];
+        SnapshotEntry* entry = &snapshot->entries[i];
+        
+        memcpy(data_cursor, item->data, item->data_size);
+        entry->data = data_cursor;
+        entry->data_size = item->data_size;
+        entry->timestamp = item->timestamp;
+        data_cursor += (item->data_size + align - 1) & ~(align - 1);
         
-        // Call iterator
-        continue_iteration = iterator(item_type, item_id, 
-                                    item->data, item->data_size,
-                                    item->timestamp, context);
+        size_t key_len = strlen(item->compound_key);
+        memcpy(key_cursor, item->compound_key, key_len + 1);
+        key_cursor[item->type_len] = '\0';
+        entry->type_name = key_cursor;
+        entry->id = key_cursor + item->type_len + 1;
+        key_cursor += key_len + 1;
     }
+    snapshot->count = matches->count;
+    return true;
+}
+
+// Take a snapshot of all items matching both sides of a query
+static bool snapshot_take(StateStore* store, const KeyMatcher* type_match,
+                          const KeyMatcher* id_match, Snapshot* snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    PositionList matches = {0};
     
+    pthread_rwlock_rdlock(&store->lock);
+    bool ok = find_matches_locked(store, type_match, id_match, &matches) &&
+              snapshot_copy_locked(store, &matches, snapshot);
     pthread_rwlock_unlock(&store->lock);
-    return true;
+    
+    if (!ok) {
+        log_error("Failed to allocate state store snapshot (%zu items)", matches.count);
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+                                       "Failed to allocate state store snapshot of %zu items",
+                                       matches.count);
+        snapshot_free(snapshot);
+    }
+    
+    free(matches.positions);
+    return ok;
+}
+
+static bool iterate_matching(StateStore* store, const KeyMatcher* type_match,
+                             const KeyMatcher* id_match,
+                             state_store_iterator callback, void* user_context) {
+    Snapshot snapshot;
+    if (!snapshot_take(store, type_match, id_match, &snapshot)) {
+        return false;
+    }
+    
+    bool completed = true;
+    for (size_t i = 0; i < snapshot.count && completed; i++) {
+        SnapshotEntry* entry = &snapshot.entries[i];
+        completed = callback(entry->type_name, entry->id, entry->data,
+                             entry->data_size, entry->timestamp, user_context);
+    }
+    
+    snapshot_free(&snapshot);
+    return completed;
+}
+
+// Iteration
+bool state_store_iterate_all(StateStore* store, state_store_iterator callback, void* user_context) {
+    if (!store || !callback) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+                                       "state_store_iterate_all: store=%p, callback=%s",
+                                       (void*)store, callback ? "set" : "NULL");
+        return false;
+    }
+    
+    KeyMatcher any = { MATCH_ANY, "", 0 };
+    return iterate_matching(store, &any, &any, callback, user_context);
+}
+
+bool state_store_iterate_by_type(StateStore* store, const char* type_name,
+                                 state_store_iterator callback, void* user_context) {
+    if (!store || !type_name || !callback) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+                                       "state_store_iterate_by_type: store=%p, type=%s, callback=%s",
+                                       (void*)store, type_name ? type_name : "NULL",
+                                       callback ? "set" : "NULL");
+        return false;
+    }
+    
+    // Exact even if the name contains '*'
+    KeyMatcher type_match = { MATCH_EXACT, type_name, strlen(type_name) };
+    KeyMatcher any = { MATCH_ANY, "", 0 };
+    return iterate_matching(store, &type_match, &any, callback, user_context);
+}
+
+bool state_store_iterate_wildcard(StateStore* store, const char* pattern,
+                                  state_store_iterator callback, void* user_context) {
+    if (!store || !pattern || !callback) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+                                       "state_store_iterate_wildcard: store=%p, pattern=%s, callback=%s",
+                                       (void*)store, pattern ? pattern : "NULL",
+                                       callback ? "set" : "NULL");
+        return false;
+    }
+    
+    // "type" alone is shorthand for "type:*"
+    const char* colon = strchr(pattern, ':');
+    KeyMatcher type_match = matcher_compile(pattern, colon ? (size_t)(colon - pattern) : strlen(pattern));
+    KeyMatcher id_match = colon ? matcher_compile(colon + 1, strlen(colon + 1)) :
+                                  (KeyMatcher){ MATCH_ANY, "", 0 };
+    
+    return iterate_matching(store, &type_match, &id_match, callback, user_context);
+}
+
+// Legacy entry point: NULL type iterates everything
+bool state_store_iterate(StateStore* store, const char* type_name,
+                        state_store_iterator iterator, void* context) {
+    return type_name ? state_store_iterate_by_type(store, type_name, iterator, context) :
+                       state_store_iterate_all(store, iterator, context);
 }
 
 // Statistics
-size_t state_store_get_item_count(StateStore* store, const char* type_name) {
+size_t state_store_get_total_items(StateStore* store) {
     if (!store) {
         return 0;
     }
     
     pthread_rwlock_rdlock(&store->lock);
     
-    if (!type_name) {
-        // Count all non-expired items
-        size_t count = 0;
-        time_t now = time(NULL);
-        for (size_t i = 0; i < store->num_items; i++) {
-            if (store->items[i].expires_at == 0 || now <= store->items[i].expires_at) {
-                count++;
-            }
+    // Count all non-expired items
+    size_t count = 0;
+    time_t now = time(NULL);
+    for (size_t i = 0; i < store->num_items; i++) {
+        if (!item_expired(&store->items[i], now)) {
+            count++;
         }
-        pthread_rwlock_unlock(&store->lock);
-        return count;
     }
     
-    // Count items of specific type
-    char type_prefix[MAX_TYPE_NAME_LENGTH + 2];
-    snprintf(type_prefix, sizeof(type_prefix), "%s:", type_name);
-    size_t prefix_len = strlen(type_prefix);
+    pthread_rwlock_unlock(&store->lock);
+    return count;
+}
+
+size_t state_store_get_items_by_type(StateStore* store, const char* type_name) {
+    if (!store || !type_name) {
+        return 0;
+    }
+    
+    pthread_rwlock_rdlock(&store->lock);
     
+    // Count non-expired items of this type through the type index
     size_t count = 0;
     time_t now = time(NULL);
-    
-    for (size_t i = 0; i < store->num_items; i++) {
-        if (strncmp(store->items[i].compound_key, type_prefix, prefix_len) == 0) {
-            if (store->items[i].expires_at == 0 || now <= store->items[i].expires_at) {
-                count++;
-            }
+    IndexEntry* entry = index_lookup(&store->type_index, type_name, strlen(type_name));
+    for (size_t i = 0; entry && i < entry->count; i++) {
+        if (!item_expired(&store->items[entry->positions[i]], now)) {
+            count++;
         }
     }
     
@@ -625,40 +2022,43 @@ size_t state_store_get_item_count(StateStore* store, const char* type_name) {
     return count;
 }
 
+size_t state_store_get_item_count(StateStore* store, const char* type_name) {
+    return type_name ? state_store_get_items_by_type(store, type_name) :
+                       state_store_get_total_items(store);
+}
+
 // Phase 3: Remove expired items
+// Expiry test for bulk removal; context is the current time
+static bool item_expired_now(const StoredItem* item, const void* context) {
+    if (item_expired(item, *(const time_t*)context)) {
+        log_debug("Cleaned up expired item: %s", item->compound_key);
+        return true;
+    }
+    return false;
+}
+
 size_t state_store_cleanup_expired(StateStore* store) {
     if (!store) return 0;
     
     pthread_rwlock_wrlock(&store->lock);
     
     time_t now = time(NULL);
-    size_t removed = 0;
-    size_t write_idx = 0;
+    const char** keys;
+    size_t removed = remove_matching_locked(store, item_expired_now, &now, &keys);
     
-    // Compact array, removing expired items
-    for (size_t read_idx = 0; read_idx < store->num_items; read_idx++) {
-        StoredItem* item = &store->items[read_idx];
-        
-        if (item->expires_at > 0 && now > item->expires_at) {
-            // Item expired - free and skip
-            free(item->data);
-            removed++;
-            log_debug("Cleaned up expired item: %s", item->compound_key);
-        } else {
-            // Keep item - move to write position if needed
-            if (write_idx != read_idx) {
-                store->items[write_idx] = store->items[read_idx];
-            }
-            write_idx++;
-        }
+    ChangeListener listeners[MAX_CHANGE_LISTENERS];
+    size_t listener_count = 0;
+    uint64_t version = 0;
+    if (removed > 0) {
+        version = begin_notify_locked(store, listeners, &listener_count);
     }
-    
-    store->num_items = write_idx;
     pthread_rwlock_unlock(&store->lock);
     
     if (removed > 0) {
         log_info("Cleaned up %zu expired state items", removed);
+        notify_removed(listeners, listener_count, version, keys, removed, "*:*");
     }
+    free(keys);
     
     return removed;
 }
\ No newline at end of file
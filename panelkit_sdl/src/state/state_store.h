@@ -3,7 +3,9 @@
  * @brief Key-value state storage system
  * 
  * Thread-safe storage for application state with namespace support,
- * TTL, and change notifications.
+ * TTL, and change notifications. Related writes can be grouped into a
+ * transaction that readers observe all at once and that produces a single
+ * notification. Derived values can be defined as memoized computed keys.
  */
 
 #ifndef STATE_STORE_H
@@ -11,11 +13,15 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 
 /** Opaque state store handle */
 typedef struct StateStore StateStore;
 
+/** Opaque batch of staged writes (see state_store_begin) */
+typedef struct StateTransaction StateTransaction;
+
 /** Data type handle (opaque, assigned at runtime) */
 typedef unsigned int DataType;
 
@@ -38,16 +44,85 @@ typedef struct {
  * 
  * @param type_name Data type name (borrowed reference)
  * @param id Item identifier within type (borrowed reference)
- * @param data Item data payload (borrowed reference, only valid during callback)
+ * @param data Item data payload (snapshot copy, only valid during callback)
  * @param data_size Size of data in bytes
  * @param timestamp When item was stored
  * @param user_context User-provided context (optional)
  * @return true to continue iteration, false to stop
+ * @note Callbacks run without the store lock held and may call back
+ *       into the store
  */
 typedef bool (*state_store_iterator)(const char* type_name, const char* id,
                                     const void* data, size_t data_size, 
                                     time_t timestamp, void* user_context);
 
+/**
+ * Change notification delivered to listeners.
+ */
+typedef struct {
+    uint64_t version;           /**< Store version after this change */
+    const char* const* keys;    /**< Changed compound keys ("type:id"), borrowed */
+    size_t key_count;           /**< Number of keys */
+} StateChange;
+
+/**
+ * Change listener callback.
+ * 
+ * @param change Changed keys and new version (only valid during callback)
+ * @param user_context User-provided context (optional)
+ * @note Called on the writing thread after the store lock is released.
+ *       Concurrent writers may deliver notifications out of version order.
+ */
+typedef void (*state_store_change_callback)(const StateChange* change, void* user_context);
+
+/**
+ * One input of a computed entry, as passed to its compute function.
+ */
+typedef struct {
+    const char* type_name;      /**< Input type (borrowed) */
+    const char* id;             /**< Input id (borrowed) */
+    const void* data;           /**< Snapshot copy, NULL if missing or expired */
+    size_t data_size;           /**< Size of data in bytes (0 if missing) */
+    time_t timestamp;           /**< When the input was stored (0 if missing) */
+} StateComputeInput;
+
+/**
+ * Compute function for a derived entry.
+ * 
+ * @param inputs Input values in definition order (only valid during the call)
+ * @param input_count Number of inputs
+ * @param output Zeroed buffer of the entry's value_size to fill in
+ * @param user_context User-provided context (optional)
+ * @return true if a value was produced, false if the entry should read
+ *         as missing for these inputs
+ * @note Must be a pure function of its inputs: it only runs again when an
+ *       input changes. Called without the store lock held, but must not
+ *       read the entry it computes.
+ */
+typedef bool (*state_store_compute_fn)(const StateComputeInput* inputs, size_t input_count,
+                                       void* output, void* user_context);
+
+/**
+ * Definition of a computed (derived) entry.
+ */
+typedef struct {
+    const char* type_name;      /**< Type of the computed key (required) */
+    const char* id;             /**< Id of the computed key (required) */
+    const char* const* inputs;  /**< Stored input keys as "type:id" (1-8, required) */
+    size_t input_count;         /**< Number of inputs */
+    size_t value_size;          /**< Size of the computed value in bytes */
+    state_store_compute_fn compute;  /**< Compute function (required) */
+    void* user_context;         /**< Passed to compute (can be NULL) */
+} ComputedStateConfig;
+
+/**
+ * Computed entry statistics.
+ */
+typedef struct {
+    uint64_t reads;             /**< Reads of the computed key */
+    uint64_t recomputes;        /**< Times the compute function ran */
+} ComputedStateStats;
+
 // State store lifecycle
 
 /**
@@ -113,6 +188,7 @@ bool state_store_set(StateStore* store, const char* type_name, const char* id,
  * @param timestamp_out Receives storage timestamp (can be NULL)
  * @return Data pointer or NULL if not found (caller must free)
  * @note Returns copy of data - caller owns memory
+ * @note Also reads computed entries, recomputing them if an input changed
  */
 void* state_store_get(StateStore* store, const char* type_name, const char* id,
                       size_t* size_out, time_t* timestamp_out);
@@ -137,7 +213,140 @@ bool state_store_has(StateStore* store, const char* type_name, const char* id);
  */
 bool state_store_remove(StateStore* store, const char* type_name, const char* id);
 
+// Transactions
+//
+// Writes staged in a transaction are applied under one write-lock
+// acquisition on commit: readers see either none or all of them, the store
+// version is bumped once, and listeners get one notification listing every
+// changed key.
+
+/**
+ * Start a transaction.
+ * 
+ * @param store State store (required)
+ * @return New transaction or NULL on error (consumed by commit or abort)
+ * @note Takes no lock; nothing is visible until state_store_commit()
+ */
+StateTransaction* state_store_begin(StateStore* store);
+
+/**
+ * Stage a write.
+ * 
+ * @param txn Transaction (required)
+ * @param type_name Data type identifier (required)
+ * @param id Item identifier within type (required)
+ * @param data Data payload (required, copied)
+ * @param data_size Size of data in bytes
+ * @return true on success, false on error
+ * @note A later write or remove of the same key replaces this one.
+ *       A failed stage causes the whole transaction to be discarded on commit.
+ */
+bool state_store_txn_set(StateTransaction* txn, const char* type_name, const char* id,
+                         const void* data, size_t data_size);
+
+/**
+ * Stage a removal.
+ * 
+ * @param txn Transaction (required)
+ * @param type_name Data type identifier (required)
+ * @param id Item identifier within type (required)
+ * @return true on success, false on error
+ */
+bool state_store_txn_remove(StateTransaction* txn, const char* type_name, const char* id);
+
+/**
+ * Apply all staged writes atomically and free the transaction.
+ * 
+ * @param txn Transaction (required, invalid after return)
+ * @return true on success, false if nothing was applied due to a staging
+ *         error, or if memory ran out part way through (logged)
+ */
+bool state_store_commit(StateTransaction* txn);
+
+/**
+ * Discard all staged writes and free the transaction.
+ * 
+ * @param txn Transaction (can be NULL, invalid after return)
+ */
+void state_store_abort(StateTransaction* txn);
+
+// Change notifications
+
+/**
+ * Register a change listener.
+ * 
+ * @param store State store (required)
+ * @param callback Listener (required)
+ * @param user_context Passed to callback (can be NULL)
+ * @return true on success, false if the listener table (8) is full
+ * @note Each set and remove notifies with one key, each commit with all
+ *       changed keys, and each clear or expiry cleanup with every key it
+ *       removed (or, if listing them runs out of memory, with a single
+ *       wildcard pattern such as "type:*" or "*:*").
+ */
+bool state_store_add_change_listener(StateStore* store, state_store_change_callback callback,
+                                     void* user_context);
+
+/**
+ * Unregister a change listener.
+ * 
+ * @param store State store (required)
+ * @param callback Listener to remove
+ * @param user_context Context it was registered with
+ * @return true if removed, false if not found
+ * @note A notification already in flight on another thread may still
+ *       reach the listener after this returns
+ */
+bool state_store_remove_change_listener(StateStore* store, state_store_change_callback callback,
+                                        void* user_context);
+
+/**
+ * Get the store version.
+ * 
+ * @param store State store (required)
+ * @return Counter bumped on every change (0 for a new store)
+ */
+uint64_t state_store_get_version(StateStore* store);
+
+// Computed state
+//
+// A computed entry is a memoized pure function of up to 8 stored keys. It
+// reads like a normal key through state_store_get() and state_store_has();
+// the value is recomputed on read only when the version of one of its
+// inputs has changed since the last computation, so derived work (unit
+// conversion, formatting) runs once per data change instead of once per
+// reader per frame. Computed keys are not stored items: they do not appear
+// in iteration, counts or change notifications, and a stored item with
+// the same key takes precedence.
+
+/**
+ * Define a computed entry.
+ * 
+ * @param store State store (required)
+ * @param config Definition (required, strings are copied)
+ * @return true on success or if an identical definition already exists,
+ *         false on error or if the key is defined differently
+ * @note Definitions live as long as the store
+ */
+bool state_store_define_computed(StateStore* store, const ComputedStateConfig* config);
+
+/**
+ * Get statistics for a computed entry.
+ * 
+ * @param store State store (required)
+ * @param type_name Type of the computed key (required)
+ * @param id Id of the computed key (required)
+ * @param stats Receives the statistics (required)
+ * @return true on success, false if no such computed entry exists
+ */
+bool state_store_get_computed_stats(StateStore* store, const char* type_name, const char* id,
+                                    ComputedStateStats* stats);
+
 // Iteration and queries
+//
+// Matching items are copied into a snapshot under the read lock and the
+// callback runs after the lock is released. Writes made while callbacks
+// run are not visible to that iteration. Order is unspecified.
 
 /**
  * Iterate over all items in the store.
@@ -145,7 +354,7 @@ bool state_store_remove(StateStore* store, const char* type_name, const char* id
  * @param store State store (required)
  * @param callback Iterator function (required)
  * @param user_context Context passed to callback (can be NULL)
- * @return true if iteration completed, false if stopped early
+ * @return true if iteration completed, false if stopped early or on error
  */
 bool state_store_iterate_all(StateStore* store, state_store_iterator callback, void* user_context);
 
@@ -156,7 +365,8 @@ bool state_store_iterate_all(StateStore* store, state_store_iterator callback, v
  * @param type_name Type to iterate (required)
  * @param callback Iterator function (required)
  * @param user_context Context passed to callback (can be NULL)
- * @return true if iteration completed, false if stopped early
+ * @return true if iteration completed, false if stopped early or on error
+ * @note Uses the type index: cost is O(items of this type)
  */
 bool state_store_iterate_by_type(StateStore* store, const char* type_name,
                                  state_store_iterator callback, void* user_context);
@@ -168,11 +378,17 @@ bool state_store_iterate_by_type(StateStore* store, const char* type_name,
  * @param pattern Wildcard pattern (required)
  * @param callback Iterator function (required)
  * @param user_context Context passed to callback (can be NULL)
- * @return true if iteration completed, false if stopped early
+ * @return true if iteration completed, false if stopped early or on error
  * @note Pattern examples:
  *       - "weather_current:*" - all weather data
  *       - "*:91007" - all types for location 91007
  *       - "*:*" - all data (same as iterate_all)
+ *       - "weather_*:910??" - '*' matches any run, '?' one character
+ *       A pattern without ':' matches types ("weather_current" is
+ *       "weather_current:*").
+ * @note An exact type or id costs O(matches) through the type or id
+ *       index; a partial pattern on one side is matched against the
+ *       distinct types or ids first, then expanded.
  */
 bool state_store_iterate_wildcard(StateStore* store, const char* pattern,
                                   state_store_iterator callback, void* user_context);
@@ -187,6 +403,22 @@ bool state_store_iterate_wildcard(StateStore* store, const char* pattern,
  */
 size_t state_store_cleanup_expired(StateStore* store);
 
+/**
+ * Remove every item of one type.
+ *
+ * @param store State store (required)
+ * @param type_name Type identifier (required)
+ * @return true if any items were removed
+ */
+bool state_store_clear_type(StateStore* store, const char* type_name);
+
+/**
+ * Remove every item.
+ *
+ * @param store State store (required)
+ */
+void state_store_clear_all(StateStore* store);
+
 /**
  * Get total number of items in store.
  * 
@@ -0,0 +1,249 @@
+/**
+ * @file panelkit_bundle.c
+ * @brief panelkit-bundle: build and inspect asset bundles
+ *
+ * Packs fonts, skins and other read-only assets into the indexed archive
+ * PanelKit maps at startup (see core/asset_bundle.h):
+ *
+ *   $ panelkit-bundle create build/panelkit-assets.pkb \
+ *         -z0 fonts/regular.ttf=fonts/font-sans-regular.ttf -z9 skins/
+ *   $ panelkit-bundle create -a build/target/panelkit fonts/regular.ttf=...
+ *   $ panelkit-bundle list build/panelkit-assets.pkb
+ *         size     stored  codec   hash              name
+ *       305608     305608  stored  6d0b2c1ee5a4f4c1  fonts/regular.ttf
+ *        16438       1262  deflate 91f0a7c1b2d3e4f5  skins/button_normal.bmp
+ *
+ * An asset argument is NAME=PATH, or a path naming itself. A directory
+ * adds every regular file below it, named under the directory's name.
+ * Fonts are best stored (-z0): FreeType reads them in place from the
+ * mapping, where deflating would trade flash for a heap copy.
+ */
+
+#include "../core/asset_bundle.h"
+#include "../core/error.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define DEFAULT_LEVEL 9
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s create [-z LEVEL] [-a] OUTPUT ASSET...\n"
+            "       %s list BUNDLE\n"
+            "       %s verify BUNDLE\n"
+            "       %s cat BUNDLE NAME\n"
+            "\n"
+            "Build and inspect PanelKit asset bundles.\n"
+            "\n"
+            "  -z LEVEL  0 stores, 1-9 deflates where it saves an eighth or more\n"
+            "            (default %d); may be repeated between assets\n"
+            "  -a        Append to OUTPUT (an executable) instead of replacing it\n"
+            "  ASSET     NAME=PATH, FILE, or DIRECTORY (added recursively)\n"
+            "\n"
+            "Examples:\n"
+            "  %s create build/panelkit-assets.pkb -z0 fonts/regular.ttf=fonts/font-sans-regular.ttf\n"
+            "  %s create -a build/target/panelkit -z9 skins/\n",
+            program, program, program, program, DEFAULT_LEVEL, program, program);
+}
+
+static bool add_path(AssetBundleWriter* writer, const char* name, const char* path, int level);
+
+static bool add_directory(AssetBundleWriter* writer, const char* name, const char* path,
+                          int level) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        fprintf(stderr, "Cannot open directory %s\n", path);
+        return false;
+    }
+
+    bool ok = true;
+    struct dirent* entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char child_name[ASSET_BUNDLE_MAX_NAME + 1];
+        char child_path[1024];
+        size_t name_length = strlen(name);
+        bool slash = name_length > 0 && name[name_length - 1] != '/';
+        int n = snprintf(child_name, sizeof(child_name), "%s%s%s",
+                         name, slash ? "/" : "", entry->d_name);
+        int p = snprintf(child_path, sizeof(child_path), "%s/%s", path, entry->d_name);
+        if (n < 0 || (size_t)n >= sizeof(child_name) || p < 0 || (size_t)p >= sizeof(child_path)) {
+            fprintf(stderr, "Name too long: %s/%s\n", path, entry->d_name);
+            ok = false;
+            break;
+        }
+        ok = add_path(writer, child_name, child_path, level);
+    }
+    closedir(dir);
+    return ok;
+}
+
+static bool add_path(AssetBundleWriter* writer, const char* name, const char* path, int level) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "Cannot stat %s\n", path);
+        return false;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        return add_directory(writer, name, path, level);
+    }
+    if (!S_ISREG(st.st_mode)) {
+        return true;
+    }
+    if (!asset_bundle_writer_add_file(writer, name, path, level)) {
+        fprintf(stderr, "%s\n", pk_get_last_error_context());
+        return false;
+    }
+    return true;
+}
+
+static int command_create(int argc, char* argv[]) {
+    int level = DEFAULT_LEVEL;
+    bool append = false;
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "+z:a")) != -1) {
+        switch (opt) {
+        case 'z':
+            level = atoi(optarg);
+            break;
+        case 'a':
+            append = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (argc - optind < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const char* output = argv[optind];
+    AssetBundleWriter* writer = asset_bundle_writer_create();
+    if (!writer) {
+        fprintf(stderr, "%s\n", pk_get_last_error_context());
+        return 1;
+    }
+
+    bool ok = true;
+    for (int i = optind + 1; ok && i < argc; i++) {
+        /* -zN between assets changes the level for those that follow */
+        if (strncmp(argv[i], "-z", 2) == 0) {
+            level = atoi(argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "0"));
+            continue;
+        }
+        char name[ASSET_BUNDLE_MAX_NAME + 1];
+        const char* path = argv[i];
+        const char* equals = strchr(argv[i], '=');
+        if (equals) {
+            size_t length = (size_t)(equals - argv[i]);
+            if (length >= sizeof(name)) {
+                fprintf(stderr, "Name too long: %s\n", argv[i]);
+                ok = false;
+                break;
+            }
+            memcpy(name, argv[i], length);
+            name[length] = '\0';
+            path = equals + 1;
+        } else {
+            /* Named by path: "skins/" holds skins/button_normal.bmp, ... */
+            snprintf(name, sizeof(name), "%s", path);
+            size_t length = strlen(name);
+            while (length > 0 && name[length - 1] == '/') {
+                name[--length] = '\0';
+            }
+        }
+        ok = add_path(writer, name, path, level);
+    }
+
+    if (ok && !asset_bundle_writer_save(writer, output, append)) {
+        fprintf(stderr, "%s\n", pk_get_last_error_context());
+        ok = false;
+    }
+    asset_bundle_writer_destroy(writer);
+    return ok ? 0 : 1;
+}
+
+static int command_list(AssetBundle* bundle) {
+    uint64_t total_size = 0;
+    uint64_t total_stored = 0;
+    uint32_t count = asset_bundle_count(bundle);
+
+    printf("%10s %10s  %-7s %-16s  %s\n", "size", "stored", "codec", "hash", "name");
+    for (uint32_t i = 0; i < count; i++) {
+        AssetInfo info;
+        if (!asset_bundle_info(bundle, i, &info)) {
+            continue;
+        }
+        printf("%10llu %10llu  %-7s %016llx  %s\n",
+               (unsigned long long)info.size, (unsigned long long)info.stored_size,
+               info.compression == ASSET_COMPRESSION_DEFLATE ? "deflate" : "stored",
+               (unsigned long long)info.hash, info.name);
+        total_size += info.size;
+        total_stored += info.stored_size;
+    }
+    printf("%10llu %10llu  %u assets\n",
+           (unsigned long long)total_size, (unsigned long long)total_stored, count);
+    return 0;
+}
+
+static int command_verify(AssetBundle* bundle) {
+    uint32_t failures = asset_bundle_verify(bundle);
+    printf("%u of %u assets intact\n", asset_bundle_count(bundle) - failures,
+           asset_bundle_count(bundle));
+    return failures ? 1 : 0;
+}
+
+static int command_cat(AssetBundle* bundle, const char* name) {
+    AssetView view;
+    if (!asset_bundle_get(bundle, name, &view)) {
+        fprintf(stderr, "%s\n", pk_get_last_error_context());
+        return 1;
+    }
+    return fwrite(view.data, 1, view.size, stdout) == view.size ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+        usage(argv[0]);
+        return argc < 2 ? 2 : 0;
+    }
+
+    const char* command = argv[1];
+    if (strcmp(command, "create") == 0) {
+        return command_create(argc, argv);
+    }
+
+    bool takes_name = strcmp(command, "cat") == 0;
+    if ((strcmp(command, "list") != 0 && strcmp(command, "verify") != 0 && !takes_name) ||
+        argc != (takes_name ? 4 : 3)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    AssetBundle* bundle = asset_bundle_open(argv[2]);
+    if (!bundle) {
+        fprintf(stderr, "%s\n", pk_get_last_error_context());
+        return 1;
+    }
+
+    int status;
+    if (strcmp(command, "list") == 0) {
+        status = command_list(bundle);
+    } else if (strcmp(command, "verify") == 0) {
+        status = command_verify(bundle);
+    } else {
+        status = command_cat(bundle, argv[3]);
+    }
+    asset_bundle_close(bundle);
+    return status;
+}
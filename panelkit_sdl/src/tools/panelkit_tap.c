@@ -0,0 +1,206 @@
+/**
+ * @file panelkit_tap.c
+ * @brief panelkit-tap: print a running panel's event stream
+ *
+ * Connects to the event tap socket (see events/event_tap.h), subscribes
+ * with the filters given on the command line and prints one line per
+ * event until interrupted:
+ *
+ *   $ panelkit-tap 'ui.*' app.page_transition
+ *        0.000000      0  ui.button_pressed            16  00000000 01000000 ...
+ *        0.412310      1  app.page_transition           4  01000000
+ *   --- 37 events dropped (tap ring full) ---
+ *
+ * Times are seconds since the first event shown. Payloads are printed as
+ * text when they are a NUL-terminated string, otherwise as hex (the first
+ * 32 bytes, or everything captured with -x).
+ */
+
+#include "../events/event_tap.h"
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define DEFAULT_HEX_BYTES 32
+
+static volatile sig_atomic_t stop_requested;
+
+static void on_signal(int signum) {
+    (void)signum;
+    stop_requested = 1;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [-s SOCKET] [-x] [FILTER...]\n"
+            "\n"
+            "Print a running PanelKit's events as they are emitted.\n"
+            "\n"
+            "  -s SOCKET  Tap socket (default %s)\n"
+            "  -x         Dump every captured payload byte\n"
+            "  FILTER     Event name, or prefix ending in '*' (default: '*')\n"
+            "\n"
+            "Examples:\n"
+            "  %s                      # everything\n"
+            "  %s 'ui.*' 'input.*'     # touches and buttons\n"
+            "  %s -x api.user_data_updated\n",
+            program, EVENT_TAP_DEFAULT_SOCKET, program, program, program);
+}
+
+/* Read exactly size bytes; false on EOF, error or interrupt */
+static bool read_all(int fd, void* data, size_t size) {
+    uint8_t* p = data;
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR && !stop_requested) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool is_text(const uint8_t* data, size_t size) {
+    if (size < 2 || data[size - 1] != '\0') {
+        return false;
+    }
+    for (size_t i = 0; i + 1 < size; i++) {
+        if (!isprint(data[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void print_payload(const uint8_t* data, size_t captured, uint32_t data_size,
+                          bool full_hex) {
+    if (captured == data_size && is_text(data, captured)) {
+        printf(" \"%s\"", (const char*)data);
+        return;
+    }
+    size_t shown = full_hex ? captured : (captured < DEFAULT_HEX_BYTES ? captured : DEFAULT_HEX_BYTES);
+    for (size_t i = 0; i < shown; i++) {
+        printf("%s%02x", i % 4 == 0 ? " " : "", data[i]);
+        if (full_hex && i % 32 == 31 && i + 1 < shown) {
+            printf("\n%*s", 60, "");
+        }
+    }
+    if (shown < data_size) {
+        printf(" ...");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* socket_path = EVENT_TAP_DEFAULT_SOCKET;
+    bool full_hex = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:xh")) != -1) {
+        switch (opt) {
+        case 's':
+            socket_path = optarg;
+            break;
+        case 'x':
+            full_hex = true;
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    /* Filter line: the remaining arguments, or everything */
+    char filters[1024] = "";
+    size_t length = 0;
+    for (int i = optind; i < argc; i++) {
+        int n = snprintf(filters + length, sizeof(filters) - length, "%s%s",
+                         length ? " " : "", argv[i]);
+        if (n < 0 || (size_t)n >= sizeof(filters) - length) {
+            fprintf(stderr, "Too many filters\n");
+            return 2;
+        }
+        length += (size_t)n;
+    }
+    if (length == 0) {
+        length = (size_t)snprintf(filters, sizeof(filters), "*");
+    }
+    filters[length++] = '\n';
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socket_path);
+        return 2;
+    }
+    memcpy(address.sun_path, socket_path, strlen(socket_path));
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        fprintf(stderr, "Cannot connect to %s: %s\n"
+                "Is PanelKit running with system.tap enabled?\n",
+                socket_path, strerror(errno));
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    char hello[sizeof(EVENT_TAP_HELLO) - 1];
+    if (write(fd, filters, length) != (ssize_t)length ||
+        !read_all(fd, hello, sizeof(hello)) ||
+        memcmp(hello, EVENT_TAP_HELLO, sizeof(hello)) != 0) {
+        fprintf(stderr, "Tap handshake failed on %s\n", socket_path);
+        close(fd);
+        return 1;
+    }
+    fprintf(stderr, "Tapping %s (%.*s)\n", socket_path, (int)(length - 1), filters);
+
+    uint64_t first_ns = 0;
+    unsigned long long events = 0;
+    unsigned long long dropped = 0;
+    uint8_t body[UINT16_MAX + EVENT_TAP_MAX_CAPTURE];
+    EventTapRecord record;
+
+    while (!stop_requested && read_all(fd, &record, sizeof(record))) {
+        if (record.magic != EVENT_TAP_MAGIC) {
+            fprintf(stderr, "Stream out of sync (magic %08x)\n", record.magic);
+            break;
+        }
+        if (!read_all(fd, body, (size_t)record.name_length + record.captured)) {
+            break;
+        }
+        if (record.dropped > 0) {
+            printf("--- %u events dropped (tap ring full) ---\n", record.dropped);
+            dropped += record.dropped;
+        }
+        if (events++ == 0) {
+            first_ns = record.timestamp_ns;
+        }
+
+        printf("%12.6f %6u  %-28.*s %6u ",
+               (double)(record.timestamp_ns - first_ns) / 1e9, record.sequence,
+               (int)record.name_length, (const char*)body, record.data_size);
+        print_payload(body + record.name_length, record.captured, record.data_size, full_hex);
+        putchar('\n');
+        fflush(stdout);
+    }
+
+    close(fd);
+    fprintf(stderr, "%llu events, %llu dropped\n", events, dropped);
+    return 0;
+}
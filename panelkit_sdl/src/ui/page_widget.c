@@ -6,7 +6,7 @@
 #include "core/error.h"
 
 // Forward declarations for virtual functions
-static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer);
+static PkError page_widget_render(Widget* widget, DisplayList* list);
 static void page_widget_handle_event(Widget* widget, const SDL_Event* event);
 static void page_widget_layout(Widget* widget);
 static void page_widget_destroy(Widget* widget);
@@ -251,12 +251,12 @@ Widget* page_widget_create_content_container(PageWidget* page) {
     return container;
 }
 
-static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
+static PkError page_widget_render(Widget* widget, DisplayList* list) {
     PageWidget* page = (PageWidget*)widget;
     PK_CHECK_ERROR_WITH_CONTEXT(page != NULL, PK_ERROR_NULL_PARAM,
                                "page widget is NULL in page_widget_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in page_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in page_widget_render");
     
     log_debug("PAGE RENDER: %s at (%d,%d) size %dx%d bg(%d,%d,%d) children=%zu", 
               widget->id, widget->bounds.x, widget->bounds.y,
@@ -265,12 +265,12 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
               widget->child_count);
     
     // Draw background
-    SDL_SetRenderDrawColor(renderer,
+    display_list_set_draw_color(list,
                           page->background_color.r,
                           page->background_color.g,
                           page->background_color.b,
                           page->background_color.a);
-    if (SDL_RenderFillRect(renderer, &widget->bounds) < 0) {
+    if (display_list_fill_rect(list, &widget->bounds) < 0) {
         pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
                                        "Failed to fill page background: %s",
                                        SDL_GetError());
@@ -286,16 +286,16 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
     };
     
     // Slightly darker title bar
-    SDL_SetRenderDrawColor(renderer,
+    display_list_set_draw_color(list,
                           page->background_color.r * 0.9,
                           page->background_color.g * 0.9,
                           page->background_color.b * 0.9,
                           page->background_color.a);
-    SDL_RenderFillRect(renderer, &title_bar);
+    display_list_fill_rect(list, &title_bar);
     
     // Draw title text indicator
     if (strlen(page->title) > 0) {
-        SDL_SetRenderDrawColor(renderer,
+        display_list_set_draw_color(list,
                              page->title_color.r,
                              page->title_color.g,
                              page->title_color.b,
@@ -307,7 +307,7 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
             (int)(strlen(page->title) * 10),
             20
         };
-        SDL_RenderDrawRect(renderer, &title_rect);
+        display_list_draw_rect(list, &title_rect);
     }
     
     // Set clip rect for scrollable content
@@ -317,7 +317,7 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
         widget->bounds.w,
         widget->bounds.h - 50
     };
-    SDL_RenderSetClipRect(renderer, &content_rect);
+    display_list_set_clip_rect(list, &content_rect);
     
     // Apply scroll offset to children
     int saved_y[widget->child_count];
@@ -329,13 +329,13 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
     
     // Render children
     for (size_t i = 0; i < widget->child_count; i++) {
-        PkError err = widget_render(widget->children[i], renderer);
+        PkError err = widget_render(widget->children[i], list);
         if (err != PK_OK) {
             // Restore original positions before returning
             for (size_t j = 0; j < widget->child_count; j++) {
                 widget->children[j]->bounds.y = saved_y[j];
             }
-            SDL_RenderSetClipRect(renderer, NULL);
+            display_list_set_clip_rect(list, NULL);
             return err;
         }
     }
@@ -346,7 +346,7 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
     }
     
     // Clear clip rect
-    SDL_RenderSetClipRect(renderer, NULL);
+    display_list_set_clip_rect(list, NULL);
     
     // Draw scroll indicator if needed
     if (page->max_scroll > 0) {
@@ -357,8 +357,8 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
             widget->bounds.h - 50
         };
         
-        SDL_SetRenderDrawColor(renderer, 200, 200, 200, 100);
-        SDL_RenderFillRect(renderer, &scroll_track);
+        display_list_set_draw_color(list, 200, 200, 200, 100);
+        display_list_fill_rect(list, &scroll_track);
         
         // Scroll thumb
         float scroll_ratio = (float)page->scroll_position / page->max_scroll;
@@ -373,8 +373,8 @@ static PkError page_widget_render(Widget* widget, SDL_Renderer* renderer) {
             (int)thumb_height
         };
         
-        SDL_SetRenderDrawColor(renderer, 100, 100, 100, 200);
-        if (SDL_RenderFillRect(renderer, &scroll_thumb) < 0) {
+        display_list_set_draw_color(list, 100, 100, 100, 200);
+        if (display_list_fill_rect(list, &scroll_thumb) < 0) {
             pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
                                            "Failed to draw scroll thumb: %s",
                                            SDL_GetError());
@@ -394,7 +394,10 @@ static void page_widget_handle_event(Widget* widget, const SDL_Event* event) {
     // Handle scroll events
     if (event->type == SDL_MOUSEWHEEL && 
         widget_contains_point(widget, event->wheel.mouseX, event->wheel.mouseY)) {
-        page_widget_scroll(page, -event->wheel.y * 20);
+        Widget* hit = widget_hit_test(widget, event->wheel.mouseX, event->wheel.mouseY);
+        if (!hit || !widget_has_state(hit, WIDGET_STATE_CAPTURES_DRAG)) {
+            page_widget_scroll(page, -event->wheel.y * 20);
+        }
     }
     
     // Handle touch/mouse drag for scrolling
@@ -405,6 +408,10 @@ static void page_widget_handle_event(Widget* widget, const SDL_Event* event) {
     switch (event->type) {
         case SDL_MOUSEBUTTONDOWN:
             if (widget_contains_point(widget, event->button.x, event->button.y)) {
+                Widget* hit = widget_hit_test(widget, event->button.x, event->button.y);
+                if (hit && widget_has_state(hit, WIDGET_STATE_CAPTURES_DRAG)) {
+                    break;  // The child pans itself
+                }
                 is_dragging = true;
                 drag_start_y = event->button.y;
                 drag_start_scroll = page->scroll_position;
@@ -1,6 +1,7 @@
 #include "widget.h"
 #include "../events/event_system.h"
 #include "../state/state_store.h"
+#include "../display/skin_atlas.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -90,8 +91,8 @@ void widget_destroy(Widget* widget) {
     // Unsubscribe from all events
     if (widget->event_system) {
         for (size_t i = 0; i < widget->event_count; i++) {
-            event_unsubscribe(widget->event_system, widget->subscribed_events[i],
-                            widget_event_handler_callback);
+            event_unsubscribe_context(widget->event_system, widget->subscribed_events[i],
+                                      widget_event_handler_callback, widget);
             free(widget->subscribed_events[i]);
         }
     }
@@ -305,8 +306,8 @@ bool widget_unsubscribe_event(Widget* widget, const char* event_name) {
         if (strcmp(widget->subscribed_events[i], event_name) == 0) {
             // Unsubscribe from event system
             if (widget->event_system) {
-                event_unsubscribe(widget->event_system, event_name,
-                                widget_event_handler_callback);
+                event_unsubscribe_context(widget->event_system, event_name,
+                                          widget_event_handler_callback, widget);
             }
             
             // Remove from array
@@ -333,8 +334,8 @@ PkError widget_connect_systems(Widget* widget, EventSystem* events, StateStore*
     // Unsubscribe from old system if changing
     if (widget->event_system && widget->event_system != events) {
         for (size_t i = 0; i < widget->event_count; i++) {
-            event_unsubscribe(widget->event_system, widget->subscribed_events[i],
-                            widget_event_handler_callback);
+            event_unsubscribe_context(widget->event_system, widget->subscribed_events[i],
+                                      widget_event_handler_callback, widget);
         }
     }
     
@@ -352,8 +353,8 @@ PkError widget_connect_systems(Widget* widget, EventSystem* events, StateStore*
                 
                 // Unsubscribe what we've done so far
                 for (size_t j = 0; j < i; j++) {
-                    event_unsubscribe(events, widget->subscribed_events[j],
-                                    widget_event_handler_callback);
+                    event_unsubscribe_context(events, widget->subscribed_events[j],
+                                              widget_event_handler_callback, widget);
                 }
                 
                 // Clear the system references
@@ -541,11 +542,11 @@ void widget_update_child_bounds(Widget* parent) {
     }
 }
 
-PkError widget_render(Widget* widget, SDL_Renderer* renderer) {
+PkError widget_render(Widget* widget, DisplayList* list) {
     PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
                                "widget is NULL in widget_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in widget_render");
     
     if (!widget_is_visible(widget)) {
         return PK_OK;  // Not an error - widget is hidden
@@ -558,7 +559,7 @@ PkError widget_render(Widget* widget, SDL_Renderer* renderer) {
     
     // Render this widget
     if (widget->render) {
-        PkError err = widget->render(widget, renderer);
+        PkError err = widget->render(widget, list);
         if (err != PK_OK) {
             pk_set_last_error_with_context(err,
                                            "Failed to render widget '%s' of type %d",
@@ -569,7 +570,7 @@ PkError widget_render(Widget* widget, SDL_Renderer* renderer) {
     
     // Render children
     for (size_t i = 0; i < widget->child_count; i++) {
-        PkError err = widget_render(widget->children[i], renderer);
+        PkError err = widget_render(widget->children[i], list);
         if (err != PK_OK) {
             // Context already set by recursive call
             return err;
@@ -582,6 +583,42 @@ PkError widget_render(Widget* widget, SDL_Renderer* renderer) {
     return PK_OK;
 }
 
+void widget_set_skin(Widget* widget, SkinAtlas* skin, const char* skin_class) {
+    if (!widget) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+                                       "widget is NULL in widget_set_skin");
+        return;
+    }
+    
+    widget->skin = skin;
+    if (skin && skin_class) {
+        strncpy(widget->skin_class, skin_class, sizeof(widget->skin_class) - 1);
+        widget->skin_class[sizeof(widget->skin_class) - 1] = '\0';
+    } else {
+        widget->skin_class[0] = '\0';
+    }
+    
+    widget_invalidate(widget);
+}
+
+// Skin region for the widget's current state, NULL to render flat
+static const SkinRegion* widget_skin_region(const Widget* widget) {
+    if (!widget->skin || widget->skin_class[0] == '\0') {
+        return NULL;
+    }
+    
+    const char* state = "normal";
+    if (widget->state_flags & WIDGET_STATE_DISABLED) {
+        state = "disabled";
+    } else if (widget->state_flags & WIDGET_STATE_PRESSED) {
+        state = "pressed";
+    } else if (widget->state_flags & WIDGET_STATE_HOVERED) {
+        state = "hovered";
+    }
+    
+    return skin_atlas_find_state(widget->skin, widget->skin_class, state);
+}
+
 void widget_invalidate(Widget* widget) {
     if (!widget) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
@@ -714,62 +751,73 @@ void widget_update(Widget* widget, double delta_time) {
 
 // Default implementations
 
-PkError widget_default_render(Widget* widget, SDL_Renderer* renderer) {
+PkError widget_default_render(Widget* widget, DisplayList* list) {
     PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
                                "widget is NULL in widget_default_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in widget_default_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in widget_default_render");
     
     log_debug("DEFAULT RENDER: %s at (%d,%d,%dx%d) bg(%d,%d,%d)", 
               widget->id, widget->bounds.x, widget->bounds.y,
               widget->bounds.w, widget->bounds.h,
               widget->background_color.r, widget->background_color.g, widget->background_color.b);
     
-    // Draw background
-    if (SDL_SetRenderDrawColor(renderer, 
-                              widget->background_color.r,
-                              widget->background_color.g,
-                              widget->background_color.b,
-                              widget->background_color.a) < 0) {
-        pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
-                                       "SDL_SetRenderDrawColor failed: %s",
-                                       SDL_GetError());
-        return PK_ERROR_RENDER_FAILED;
-    }
-    
-    if (SDL_RenderFillRect(renderer, &widget->bounds) < 0) {
-        pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
-                                       "SDL_RenderFillRect failed for widget '%s': %s",
-                                       widget->id, SDL_GetError());
-        return PK_ERROR_RENDER_FAILED;
-    }
-    
-    // Draw border
-    if (widget->border_width > 0) {
-        if (SDL_SetRenderDrawColor(renderer,
-                                  widget->border_color.r,
-                                  widget->border_color.g,
-                                  widget->border_color.b,
-                                  widget->border_color.a) < 0) {
+    const SkinRegion* region = widget_skin_region(widget);
+    if (region) {
+        // Nine-slice chrome replaces background and border
+        if (skin_atlas_draw(list, widget->skin, region, &widget->bounds) < 0) {
+            pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                           "Skin draw failed for widget '%s': %s",
+                                           widget->id, SDL_GetError());
+            return PK_ERROR_RENDER_FAILED;
+        }
+    } else {
+        // Draw background
+        if (display_list_set_draw_color(list, 
+                                  widget->background_color.r,
+                                  widget->background_color.g,
+                                  widget->background_color.b,
+                                  widget->background_color.a) < 0) {
             pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
-                                           "SDL_SetRenderDrawColor failed for border: %s",
+                                           "SDL_SetRenderDrawColor failed: %s",
                                            SDL_GetError());
             return PK_ERROR_RENDER_FAILED;
         }
         
-        for (int i = 0; i < widget->border_width; i++) {
-            SDL_Rect border_rect = {
-                widget->bounds.x + i,
-                widget->bounds.y + i,
-                widget->bounds.w - i * 2,
-                widget->bounds.h - i * 2
-            };
-            if (SDL_RenderDrawRect(renderer, &border_rect) < 0) {
+        if (display_list_fill_rect(list, &widget->bounds) < 0) {
+            pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                           "SDL_RenderFillRect failed for widget '%s': %s",
+                                           widget->id, SDL_GetError());
+            return PK_ERROR_RENDER_FAILED;
+        }
+        
+        // Draw border
+        if (widget->border_width > 0) {
+            if (display_list_set_draw_color(list,
+                                      widget->border_color.r,
+                                      widget->border_color.g,
+                                      widget->border_color.b,
+                                      widget->border_color.a) < 0) {
                 pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
-                                               "SDL_RenderDrawRect failed: %s",
+                                               "SDL_SetRenderDrawColor failed for border: %s",
                                                SDL_GetError());
                 return PK_ERROR_RENDER_FAILED;
             }
+        
+            for (int i = 0; i < widget->border_width; i++) {
+                SDL_Rect border_rect = {
+                    widget->bounds.x + i,
+                    widget->bounds.y + i,
+                    widget->bounds.w - i * 2,
+                    widget->bounds.h - i * 2
+                };
+                if (display_list_draw_rect(list, &border_rect) < 0) {
+                    pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                                   "SDL_RenderDrawRect failed: %s",
+                                                   SDL_GetError());
+                    return PK_ERROR_RENDER_FAILED;
+                }
+            }
         }
     }
     
@@ -777,7 +825,7 @@ PkError widget_default_render(Widget* widget, SDL_Renderer* renderer) {
     for (size_t i = 0; i < widget->child_count; i++) {
         Widget* child = widget->children[i];
         if (child && child->render && !(child->state_flags & WIDGET_STATE_HIDDEN)) {
-            PkError err = child->render(child, renderer);
+            PkError err = child->render(child, list);
             if (err != PK_OK) {
                 // Context already set by child
                 return err;
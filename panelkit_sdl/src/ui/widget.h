@@ -13,10 +13,12 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "../core/error.h"
+#include "../display/display_list.h"
 
 // Forward declarations
 typedef struct EventSystem EventSystem;
 typedef struct StateStore StateStore;
+typedef struct SkinAtlas SkinAtlas;
 typedef struct Widget Widget;
 
 // Widget types enumeration
@@ -37,14 +39,15 @@ typedef enum {
     WIDGET_STATE_FOCUSED   = 1 << 2,
     WIDGET_STATE_DISABLED  = 1 << 3,
     WIDGET_STATE_HIDDEN    = 1 << 4,
-    WIDGET_STATE_DIRTY     = 1 << 5  // Needs redraw
+    WIDGET_STATE_DIRTY     = 1 << 5, // Needs redraw
+    WIDGET_STATE_CAPTURES_DRAG = 1 << 6  // Pans itself; containers don't swipe or scroll
 } WidgetState;
 
 // Widget event handler function types
 typedef void (*widget_event_handler)(Widget* widget, const SDL_Event* event);
 typedef void (*widget_data_handler)(Widget* widget, const char* event_name,
                                    const void* data, size_t data_size);
-typedef PkError (*widget_render_func)(Widget* widget, SDL_Renderer* renderer);
+typedef PkError (*widget_render_func)(Widget* widget, DisplayList* list);
 typedef void (*widget_update_func)(Widget* widget, double delta_time);
 typedef void (*widget_destroy_func)(Widget* widget);
 
@@ -80,6 +83,10 @@ struct Widget {
     int border_width;
     int padding;
     
+    // Skin (nine-slice chrome replaces flat background and border)
+    SkinAtlas* skin;           // Not owned, NULL = flat
+    char skin_class[16];       // Region prefix, e.g. "button"
+    
     // References (not owned)
     EventSystem* event_system;
     StateStore* state_store;
@@ -304,18 +311,30 @@ void widget_update_child_bounds(Widget* parent);
  * Render widget and all visible children.
  * 
  * @param widget Widget to render
- * @param renderer SDL renderer to draw to
+ * @param list Display list to record into
  * @note Skips hidden widgets and their children
  */
 /**
  * Render widget and its children recursively.
  * 
  * @param widget Widget to render (required)
- * @param renderer SDL renderer to use (required)
+ * @param list Display list to record into (required)
  * @return PK_OK on success, error code on failure
  * @note Performs layout if needed before rendering
  */
-PkError widget_render(Widget* widget, SDL_Renderer* renderer);
+PkError widget_render(Widget* widget, DisplayList* list);
+
+/**
+ * Draw widget chrome from a skin atlas instead of flat colors.
+ * 
+ * @param widget Widget to skin (required)
+ * @param skin Skin atlas (borrowed, NULL to return to flat rendering)
+ * @param skin_class Region prefix, e.g. "button" (copied, can be NULL with NULL skin)
+ * @note The region is chosen per state: "<class>.disabled", ".pressed",
+ *       ".hovered", falling back to "<class>.normal". Widgets whose class
+ *       has no region in the atlas keep rendering flat.
+ */
+void widget_set_skin(Widget* widget, SkinAtlas* skin, const char* skin_class);
 
 /**
  * Mark widget as needing redraw.
@@ -373,10 +392,10 @@ void widget_update(Widget* widget, double delta_time);
  * Default rendering implementation.
  * 
  * @param widget Widget to render
- * @param renderer SDL renderer
+ * @param list Display list to record into
  * @note Draws background, border, and children
  */
-PkError widget_default_render(Widget* widget, SDL_Renderer* renderer);
+PkError widget_default_render(Widget* widget, DisplayList* list);
 
 /**
  * Default event handling implementation.
@@ -4,6 +4,7 @@
 #include "widgets/weather_widget.h"
 #include "widgets/page_manager_widget.h"
 #include "widgets/text_widget.h"
+#include "widgets/gauge_widget.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -214,6 +215,29 @@ Widget* widget_factory_create_label(const char* id, void* params) {
     return label;
 }
 
+Widget* widget_factory_create_gauge(const char* id, void* params) {
+    if (!id) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+            "widget_factory_create_gauge: id is NULL");
+        return NULL;
+    }
+    GaugeConfig config = gauge_widget_default_config();
+    
+    GaugeParams* gauge_params = (GaugeParams*)params;
+    if (gauge_params) {
+        config.title = gauge_params->title;
+        config.unit = gauge_params->unit;
+        config.value_event = gauge_params->value_event;
+        if (gauge_params->max_value > gauge_params->min_value) {
+            config.min_value = gauge_params->min_value;
+            config.max_value = gauge_params->max_value;
+            config.warn_from = gauge_params->max_value;
+        }
+    }
+    
+    return gauge_widget_create(id, &config);
+}
+
 Widget* widget_factory_create_container(const char* id, void* params) {
     if (!id) {
         pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
@@ -252,6 +276,7 @@ WidgetFactory* widget_factory_create_default(void) {
     widget_factory_register(factory, "button", widget_factory_create_button);
     widget_factory_register(factory, "weather", widget_factory_create_weather);
     widget_factory_register(factory, "label", widget_factory_create_label);
+    widget_factory_register(factory, "gauge", widget_factory_create_gauge);
     widget_factory_register(factory, "container", widget_factory_create_container);
     
     log_info("Created default widget factory with built-in types");
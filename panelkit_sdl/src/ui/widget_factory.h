@@ -93,6 +93,15 @@ typedef struct {
     const char* text;     /**< Display text */
 } LabelParams;
 
+/** Gauge widget creation parameters */
+typedef struct {
+    const char* title;        /**< Label above the hub (can be NULL) */
+    const char* unit;         /**< Label below the hub (can be NULL) */
+    float min_value;          /**< Scale start */
+    float max_value;          /**< Scale end */
+    const char* value_event;  /**< Event carrying the value (can be NULL) */
+} GaugeParams;
+
 /** Container widget creation parameters */
 typedef struct {
     int columns;          /**< Number of columns */
@@ -145,6 +154,16 @@ Widget* widget_factory_create_weather(const char* id, void* params);
  */
 Widget* widget_factory_create_label(const char* id, void* params);
 
+/**
+ * Create a gauge widget.
+ * 
+ * @param id Widget identifier (required)
+ * @param params GaugeParams or NULL for a 0-100 gauge
+ * @return New gauge widget or NULL on error (caller owns)
+ * @note Labels need a font: call gauge_widget_set_font() afterwards
+ */
+Widget* widget_factory_create_gauge(const char* id, void* params);
+
 /**
  * Create a container widget.
  * 
@@ -201,7 +220,7 @@ Widget* widget_factory_create_container_typed(const char* id, const ContainerPar
  * Create a factory with built-in widgets pre-registered.
  * 
  * @return New factory with standard widgets or NULL on error (caller owns)
- * @note Registers: button, weather, label, container types
+ * @note Registers: button, weather, label, gauge, container types
  */
 WidgetFactory* widget_factory_create_default(void);
 
@@ -19,6 +19,7 @@ typedef struct SDL_Color SDL_Color;
 typedef struct WidgetManager WidgetManager;
 typedef struct WidgetFactory WidgetFactory;
 typedef struct Widget Widget;
+typedef struct SkinAtlas SkinAtlas;
 
 // SDL_ttf forward declaration - use the correct struct name
 #ifndef SDL_TTF_H_
@@ -45,6 +46,16 @@ typedef struct WidgetIntegration {
     // Renderer reference (for future widget rendering)
     SDL_Renderer* renderer;
     
+    // Display this layer drives (0 = primary). Per-display state
+    // (current_page, fps, show_debug) lives under state_scope: "app" for
+    // the primary, "display<N>" for the others
+    int display_index;
+    char state_scope[16];
+    
+    // The primary owns the state store and event system; other displays
+    // share them
+    bool owns_shared;
+    
     // Migration state tracking
     bool widget_system_enabled;
     bool events_enabled;
@@ -59,16 +70,47 @@ typedef struct WidgetIntegration {
     TTF_Font* font_regular;
     TTF_Font* font_large;
     TTF_Font* font_small;
+    
+    // Skin for button chrome (passed in, not owned, NULL = flat)
+    SkinAtlas* skin;
+    
+    // Live video feed on the welcome page (empty source = none)
+    char video_source[256];
+    int video_width;
+    int video_height;
+    
+    // Tile map on the welcome page (empty source = none)
+    char map_source[256];
+    char map_cache_dir[256];
+    int map_cache_mb;
+    int map_memory_mb;
+    int map_min_zoom;
+    int map_max_zoom;
+    double map_zoom;
+    double map_lat;
+    double map_lon;
 } WidgetIntegration;
 
 // Lifecycle
+// Displays after the first get their own widget tree on the primary's state
+// store and event system; destroy them before the primary
 WidgetIntegration* widget_integration_create(SDL_Renderer* renderer);
+WidgetIntegration* widget_integration_create_for_display(SDL_Renderer* renderer,
+                                                         WidgetIntegration* primary,
+                                                         int display_index);
 void widget_integration_destroy(WidgetIntegration* integration);
 
 // Setup
 void widget_integration_set_dimensions(WidgetIntegration* integration, int width, int height);
 void widget_integration_set_fonts(WidgetIntegration* integration, 
                                   TTF_Font* regular, TTF_Font* large, TTF_Font* small);
+void widget_integration_set_skin(WidgetIntegration* integration, SkinAtlas* skin);
+void widget_integration_set_video(WidgetIntegration* integration, const char* source,
+                                  int width, int height);
+void widget_integration_set_map(WidgetIntegration* integration, const char* source,
+                                const char* cache_dir, int cache_mb, int memory_mb);
+void widget_integration_set_map_view(WidgetIntegration* integration, double lat, double lon,
+                                     double zoom, int min_zoom, int max_zoom);
 
 // Migration controls - enable components gradually
 void widget_integration_enable_events(WidgetIntegration* integration);
@@ -84,6 +126,8 @@ void widget_integration_mirror_page_change(WidgetIntegration* integration,
                                           int from_page, int to_page);
 
 // State integration - mirror existing state into widget system
+// Safe from the API fetch thread: the events they raise are queued (low
+// priority) and delivered by event_dispatch_pending() on the main loop
 void widget_integration_mirror_user_data(WidgetIntegration* integration,
                                         const void* user_data, size_t data_size);
 void widget_integration_mirror_api_state(WidgetIntegration* integration,
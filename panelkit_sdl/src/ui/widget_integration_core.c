@@ -10,7 +10,17 @@
 #include "core/logger.h"
 #include "core/error.h"
 
-WidgetIntegration* widget_integration_create(SDL_Renderer* renderer) {
+// Release the state store and event system if this layer created them
+static void integration_release_shared(WidgetIntegration* integration) {
+    if (integration->owns_shared) {
+        event_system_destroy(integration->event_system);
+        state_store_destroy(integration->state_store);
+    }
+}
+
+static WidgetIntegration* integration_create(SDL_Renderer* renderer,
+                                             WidgetIntegration* primary,
+                                             int display_index) {
     if (!renderer) {
         pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM, "renderer cannot be NULL");
         return NULL;
@@ -25,26 +35,42 @@ WidgetIntegration* widget_integration_create(SDL_Renderer* renderer) {
     }
     
     integration->renderer = renderer;
-    
-    // Create state store (always available)
-    integration->state_store = state_store_create();
-    if (!integration->state_store) {
-        pk_set_last_error_with_context(PK_ERROR_SYSTEM, 
-            "widget_integration_create: Failed to create state store for integration");
-        log_error("Failed to create state store for integration");
-        free(integration);
-        return NULL;
+    integration->display_index = display_index;
+    if (display_index == 0) {
+        strcpy(integration->state_scope, "app");
+    } else {
+        snprintf(integration->state_scope, sizeof(integration->state_scope),
+                 "display%d", display_index);
     }
     
-    // Create event system (always available)
-    integration->event_system = event_system_create();
-    if (!integration->event_system) {
-        pk_set_last_error_with_context(PK_ERROR_SYSTEM, 
-            "widget_integration_create: Failed to create event system for integration");
-        log_error("Failed to create event system for integration");
-        state_store_destroy(integration->state_store);
-        free(integration);
-        return NULL;
+    if (primary) {
+        // Other displays share state, events and everything subscribed to them
+        integration->state_store = primary->state_store;
+        integration->event_system = primary->event_system;
+        integration->owns_shared = false;
+    } else {
+        integration->owns_shared = true;
+        
+        // Create state store (always available)
+        integration->state_store = state_store_create();
+        if (!integration->state_store) {
+            pk_set_last_error_with_context(PK_ERROR_SYSTEM, 
+                "widget_integration_create: Failed to create state store for integration");
+            log_error("Failed to create state store for integration");
+            free(integration);
+            return NULL;
+        }
+        
+        // Create event system (always available)
+        integration->event_system = event_system_create();
+        if (!integration->event_system) {
+            pk_set_last_error_with_context(PK_ERROR_SYSTEM, 
+                "widget_integration_create: Failed to create event system for integration");
+            log_error("Failed to create event system for integration");
+            state_store_destroy(integration->state_store);
+            free(integration);
+            return NULL;
+        }
     }
     
     // Create widget manager (but don't create widgets yet)
@@ -55,8 +81,7 @@ WidgetIntegration* widget_integration_create(SDL_Renderer* renderer) {
         pk_set_last_error_with_context(PK_ERROR_SYSTEM, 
             "widget_integration_create: Failed to create widget manager for integration");
         log_error("Failed to create widget manager for integration");
-        event_system_destroy(integration->event_system);
-        state_store_destroy(integration->state_store);
+        integration_release_shared(integration);
         free(integration);
         return NULL;
     }
@@ -68,8 +93,7 @@ WidgetIntegration* widget_integration_create(SDL_Renderer* renderer) {
             "widget_integration_create: Failed to create widget factory for integration");
         log_error("Failed to create widget factory for integration");
         widget_manager_destroy(integration->widget_manager);
-        event_system_destroy(integration->event_system);
-        state_store_destroy(integration->state_store);
+        integration_release_shared(integration);
         free(integration);
         return NULL;
     }
@@ -88,10 +112,31 @@ WidgetIntegration* widget_integration_create(SDL_Renderer* renderer) {
     // Initialize application state in state store
     widget_integration_init_app_state(integration);
     
-    log_info("Widget integration layer created (running in background)");
+    if (primary) {
+        log_info("Widget integration layer created for display %d (shared state)",
+                 display_index);
+    } else {
+        log_info("Widget integration layer created (running in background)");
+    }
     return integration;
 }
 
+WidgetIntegration* widget_integration_create(SDL_Renderer* renderer) {
+    return integration_create(renderer, NULL, 0);
+}
+
+WidgetIntegration* widget_integration_create_for_display(SDL_Renderer* renderer,
+                                                         WidgetIntegration* primary,
+                                                         int display_index) {
+    if (!primary || display_index <= 0) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "widget_integration_create_for_display: primary=%p, display_index=%d",
+            (void*)primary, display_index);
+        return NULL;
+    }
+    return integration_create(renderer, primary, display_index);
+}
+
 void widget_integration_destroy(WidgetIntegration* integration) {
     if (!integration) {
         return;
@@ -102,8 +147,10 @@ void widget_integration_destroy(WidgetIntegration* integration) {
     
     widget_factory_destroy(integration->widget_factory);
     widget_manager_destroy(integration->widget_manager);
-    event_system_destroy(integration->event_system);
-    state_store_destroy(integration->state_store);
+    // A display sharing the event system leaves its typed subscriptions
+    // (button, page transition, refresh) registered; they go with the
+    // primary's event system, so secondaries are destroyed only at shutdown
+    integration_release_shared(integration);
     free(integration);
     
     log_info("Widget integration layer destroyed");
@@ -136,6 +183,73 @@ void widget_integration_set_fonts(WidgetIntegration* integration,
               (void*)regular, (void*)large, (void*)small);
 }
 
+void widget_integration_set_skin(WidgetIntegration* integration, SkinAtlas* skin) {
+    if (!integration) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM, "integration cannot be NULL");
+        return;
+    }
+    
+    integration->skin = skin;
+    
+    log_debug("Set integration skin: %p", (void*)skin);
+}
+
+void widget_integration_set_video(WidgetIntegration* integration, const char* source,
+                                  int width, int height) {
+    if (!integration) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM, "integration cannot be NULL");
+        return;
+    }
+    
+    integration->video_source[0] = '\0';
+    if (source) {
+        strncpy(integration->video_source, source, sizeof(integration->video_source) - 1);
+        integration->video_source[sizeof(integration->video_source) - 1] = '\0';
+    }
+    integration->video_width = width;
+    integration->video_height = height;
+    
+    log_debug("Set integration video: '%s' %dx%d", integration->video_source, width, height);
+}
+
+void widget_integration_set_map(WidgetIntegration* integration, const char* source,
+                                const char* cache_dir, int cache_mb, int memory_mb) {
+    if (!integration) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM, "integration cannot be NULL");
+        return;
+    }
+    
+    integration->map_source[0] = '\0';
+    if (source) {
+        strncpy(integration->map_source, source, sizeof(integration->map_source) - 1);
+        integration->map_source[sizeof(integration->map_source) - 1] = '\0';
+    }
+    integration->map_cache_dir[0] = '\0';
+    if (cache_dir) {
+        strncpy(integration->map_cache_dir, cache_dir, sizeof(integration->map_cache_dir) - 1);
+        integration->map_cache_dir[sizeof(integration->map_cache_dir) - 1] = '\0';
+    }
+    integration->map_cache_mb = cache_mb;
+    integration->map_memory_mb = memory_mb;
+    
+    log_debug("Set integration map: '%s' cache '%s' (%d MB disk, %d MB memory)",
+              integration->map_source, integration->map_cache_dir, cache_mb, memory_mb);
+}
+
+void widget_integration_set_map_view(WidgetIntegration* integration, double lat, double lon,
+                                     double zoom, int min_zoom, int max_zoom) {
+    if (!integration) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM, "integration cannot be NULL");
+        return;
+    }
+    
+    integration->map_lat = lat;
+    integration->map_lon = lon;
+    integration->map_zoom = zoom;
+    integration->map_min_zoom = min_zoom;
+    integration->map_max_zoom = max_zoom;
+}
+
 void widget_integration_enable_events(WidgetIntegration* integration) {
     if (!integration) {
         return;
@@ -17,6 +17,16 @@ static void widget_button_click_handler(const ButtonEventData* data, void* conte
 static void widget_page_transition_handler(int target_page, void* context);
 static void widget_api_refresh_handler(uint32_t timestamp, void* context);
 
+// app.page_transition carries only a page number and addresses the primary
+// display; other displays change page directly
+static void request_page_transition(WidgetIntegration* integration, int target_page) {
+    if (integration->display_index == 0) {
+        event_publish_page_transition(integration->event_system, target_page);
+    } else {
+        widget_page_transition_handler(target_page, integration);
+    }
+}
+
 void widget_integration_mirror_touch_event(WidgetIntegration* integration, 
                                           int x, int y, bool is_down) {
     if (!integration) {
@@ -53,14 +63,16 @@ void widget_integration_mirror_button_press(WidgetIntegration* integration,
     int current_page = 0;
     size_t size;
     time_t timestamp;
-    int* stored_page = (int*)state_store_get(integration->state_store, "app", "current_page", &size, &timestamp);
+    int* stored_page = (int*)state_store_get(integration->state_store, integration->state_scope,
+                                             "current_page", &size, &timestamp);
     if (stored_page) {
         current_page = *stored_page;
         free(stored_page);
     }
     
     // Mirror button press to widget event system
-    ButtonEventData button_data = {button_index, current_page, SDL_GetTicks(), {0}};
+    ButtonEventData button_data = {button_index, current_page, SDL_GetTicks(), {0},
+                                   integration->display_index};
     
     if (button_text) {
         strncpy(button_data.button_text, button_text, sizeof(button_data.button_text) - 1);
@@ -82,7 +94,8 @@ void widget_integration_mirror_page_change(WidgetIntegration* integration,
     }
     
     // Update current page in state store
-    state_store_set(integration->state_store, "app", "current_page", &to_page, sizeof(int));
+    state_store_set(integration->state_store, integration->state_scope, "current_page",
+                    &to_page, sizeof(int));
     
     // Mirror page change to widget event system
     PageChangeEventData page_data = {from_page, to_page, SDL_GetTicks()};
@@ -107,13 +120,17 @@ void widget_integration_enable_button_handling(WidgetIntegration* integration) {
     event_subscribe_button_pressed(integration->event_system, 
                                   widget_button_click_handler, integration);
     
-    // Subscribe to page transition events
-    event_subscribe_page_transition(integration->event_system, 
-                                   widget_page_transition_handler, integration);
-    
-    // Subscribe to API refresh events
-    event_subscribe_api_refresh_requested(integration->event_system, 
-                                         widget_api_refresh_handler, integration);
+    // Page transition requests address the primary display and API refresh
+    // is global, so only the primary's layer handles them
+    if (integration->display_index == 0) {
+        // Subscribe to page transition events
+        event_subscribe_page_transition(integration->event_system, 
+                                       widget_page_transition_handler, integration);
+        
+        // Subscribe to API refresh events
+        event_subscribe_api_refresh_requested(integration->event_system, 
+                                             widget_api_refresh_handler, integration);
+    }
     
     log_debug("Enabled widget-based button handling with event subscriptions");
 }
@@ -125,6 +142,11 @@ static void widget_button_click_handler(const ButtonEventData* button_data, void
         return;
     }
     
+    // Every display's layer sees every press on the shared event system
+    if (button_data->display != integration->display_index) {
+        return;
+    }
+    
     log_debug("Widget button click handler: page=%d button=%d text='%s'",
              button_data->page, button_data->button_index, button_data->button_text);
     
@@ -133,7 +155,7 @@ static void widget_button_click_handler(const ButtonEventData* button_data, void
         switch (button_data->button_index) {
             case 0: { // "Change Color" button - should transition to page 1
                 int target_page = 1;
-                event_publish_page_transition(integration->event_system, target_page);
+                request_page_transition(integration, target_page);
                 log_debug("Widget handler: Page transition to %d requested via event system", target_page);
                 break;
             }
@@ -174,7 +196,7 @@ static void widget_button_click_handler(const ButtonEventData* button_data, void
             }
             case 3: { // Go to Page 1 button
                 int target_page = 0;
-                event_publish_page_transition(integration->event_system, target_page);
+                request_page_transition(integration, target_page);
                 log_debug("Widget handler: Page transition to %d requested via event system", target_page);
                 break;
             }
@@ -202,7 +224,8 @@ static void widget_page_transition_handler(int target_page, void* context) {
     log_debug("Widget page transition handler: transitioning to page %d", target_page);
     
     // Update state store with new page
-    state_store_set(integration->state_store, "app", "current_page", &target_page, sizeof(int));
+    state_store_set(integration->state_store, integration->state_scope, "current_page",
+                    &target_page, sizeof(int));
     
     // Use page manager widget
     if (integration->page_manager) {
@@ -239,5 +262,6 @@ void widget_integration_page_changed_callback(int from_page, int to_page, void*
     log_debug("Page manager widget changed page: %d -> %d", from_page, to_page);
     
     // Update state store with new page
-    state_store_set(integration->state_store, "app", "current_page", &to_page, sizeof(int));
+    state_store_set(integration->state_store, integration->state_scope, "current_page",
+                    &to_page, sizeof(int));
 }
\ No newline at end of file
@@ -24,43 +24,61 @@ void widget_integration_init_app_state(WidgetIntegration* integration) {
     
     log_debug("Initializing application state in state store");
     
-    // Application running state
-    bool quit = false;
-    state_store_set(integration->state_store, "app", "quit", &quit, sizeof(bool));
+    // Written as one transaction so widgets never see a partial initial state
+    StateTransaction* txn = state_store_begin(integration->state_store);
+    if (!txn) {
+        log_error("Failed to begin app state transaction: %s", pk_get_last_error_context());
+        return;
+    }
+    
+    // Per-display keys live under the display's scope
+    const char* scope = integration->state_scope;
     
     // Current page (initially 0)
     int current_page = 0;
-    state_store_set(integration->state_store, "app", "current_page", &current_page, sizeof(int));
-    
-    // Show time flag
-    bool show_time = true;
-    state_store_set(integration->state_store, "app", "show_time", &show_time, sizeof(bool));
+    state_store_txn_set(txn, scope, "current_page", &current_page, sizeof(int));
     
     // Show debug flag  
     bool show_debug = true;
-    state_store_set(integration->state_store, "app", "show_debug", &show_debug, sizeof(bool));
-    
-    // Background color
-    SDL_Color bg_color = {33, 33, 33, 255};
-    state_store_set(integration->state_store, "app", "bg_color", &bg_color, sizeof(SDL_Color));
-    
-    // Page 1 text
-    const char* page1_text = "Welcome to Page 1! Swipe right to see buttons.";
-    state_store_set(integration->state_store, "app", "page1_text", page1_text, strlen(page1_text) + 1);
-    
-    // Page 1 text color index  
-    int page1_text_color = 0;
-    state_store_set(integration->state_store, "app", "page1_text_color", &page1_text_color, sizeof(int));
+    state_store_txn_set(txn, scope, "show_debug", &show_debug, sizeof(bool));
     
     // FPS and debug data
     Uint32 fps = 0;
-    state_store_set(integration->state_store, "app", "fps", &fps, sizeof(Uint32));
+    state_store_txn_set(txn, scope, "fps", &fps, sizeof(Uint32));
     
-    Uint32 frame_count = 0;
-    state_store_set(integration->state_store, "app", "frame_count", &frame_count, sizeof(Uint32));
+    // Application-wide keys are written once, by the display that owns the store
+    if (integration->owns_shared) {
+        // Application running state
+        bool quit = false;
+        state_store_txn_set(txn, "app", "quit", &quit, sizeof(bool));
+        
+        // Show time flag
+        bool show_time = true;
+        state_store_txn_set(txn, "app", "show_time", &show_time, sizeof(bool));
+        
+        // Background color
+        SDL_Color bg_color = {33, 33, 33, 255};
+        state_store_txn_set(txn, "app", "bg_color", &bg_color, sizeof(SDL_Color));
+        
+        // Page 1 text
+        const char* page1_text = "Welcome to Page 1! Swipe right to see buttons.";
+        state_store_txn_set(txn, "app", "page1_text", page1_text, strlen(page1_text) + 1);
+        
+        // Page 1 text color index  
+        int page1_text_color = 0;
+        state_store_txn_set(txn, "app", "page1_text_color", &page1_text_color, sizeof(int));
+        
+        Uint32 frame_count = 0;
+        state_store_txn_set(txn, "app", "frame_count", &frame_count, sizeof(Uint32));
+        
+        Uint32 fps_timer = 0;
+        state_store_txn_set(txn, "app", "fps_timer", &fps_timer, sizeof(Uint32));
+    }
     
-    Uint32 fps_timer = 0;
-    state_store_set(integration->state_store, "app", "fps_timer", &fps_timer, sizeof(Uint32));
+    if (!state_store_commit(txn)) {
+        log_error("Failed to initialize application state: %s", pk_get_last_error_context());
+        return;
+    }
     
     log_debug("Application state initialized in state store");
 }
@@ -78,7 +96,7 @@ int widget_integration_get_current_page(WidgetIntegration* integration) {
     
     size_t size;
     time_t timestamp;
-    int* page = (int*)state_store_get(integration->state_store, "app", "current_page", &size, &timestamp);
+    int* page = (int*)state_store_get(integration->state_store, integration->state_scope, "current_page", &size, &timestamp);
     if (page && size == sizeof(int)) {
         int result = *page;
         free(page);
@@ -91,7 +109,7 @@ int widget_integration_get_current_page(WidgetIntegration* integration) {
 void widget_integration_update_fps(WidgetIntegration* integration, Uint32 fps) {
     if (!integration || !integration->state_store) return;
     
-    state_store_set(integration->state_store, "app", "fps", &fps, sizeof(Uint32));
+    state_store_set(integration->state_store, integration->state_scope, "fps", &fps, sizeof(Uint32));
 }
 
 // Get show_debug flag from state store
@@ -100,7 +118,7 @@ bool widget_integration_get_show_debug(WidgetIntegration* integration) {
     
     size_t size;
     time_t timestamp;
-    bool* show_debug = (bool*)state_store_get(integration->state_store, "app", "show_debug", &size, &timestamp);
+    bool* show_debug = (bool*)state_store_get(integration->state_store, integration->state_scope, "show_debug", &size, &timestamp);
     if (show_debug && size == sizeof(bool)) {
         bool result = *show_debug;
         free(show_debug);
@@ -177,9 +195,10 @@ void widget_integration_mirror_user_data(WidgetIntegration* integration,
     // Store user data in widget state store
     state_store_set(integration->state_store, "api_data", "user", user_data, data_size);
     
-    // Also publish as event if events are enabled
+    // Also publish as event if events are enabled. Queued: this runs on the
+    // API fetch thread, and handlers belong to the main loop's next frame
     if (integration->events_enabled) {
-        event_publish_api_user_data_updated(integration->event_system, user_data, data_size);
+        event_post_api_user_data_updated(integration->event_system, user_data, data_size);
     }
     
     log_debug("Mirrored user data (%zu bytes) to widget state", data_size);
@@ -214,7 +233,7 @@ void widget_integration_mirror_api_state(WidgetIntegration* integration,
         strncpy(state_data.state_name, state_name, sizeof(state_data.state_name) - 1);
         strncpy(state_data.value, value, sizeof(state_data.value) - 1);
         
-        event_publish_api_state_changed(integration->event_system, &state_data);
+        event_post_api_state_changed(integration->event_system, &state_data);
     }
     
     log_debug("Mirrored API state: %s = %s", state_name, value);
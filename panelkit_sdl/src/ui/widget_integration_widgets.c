@@ -11,6 +11,8 @@
 #include "widgets/text_widget.h"
 #include "widgets/time_widget.h"
 #include "widgets/data_display_widget.h"
+#include "widgets/video_widget.h"
+#include "widgets/map_widget.h"
 #include "page_widget.h"
 #include "../core/sdl_includes.h"
 #include <stdlib.h>
@@ -79,6 +81,9 @@ void widget_integration_create_shadow_widgets(WidgetIntegration* integration) {
                                                     "button", "page0_button0", NULL);
         if (button) {
             widget_set_relative_bounds(button, 20, 100, 200, 50);
+            if (integration->skin) {
+                widget_set_skin(button, integration->skin, "button");
+            }
             
             // Create text widget as child of button
             Widget* label = (Widget*)text_widget_create("page0_button0_text", "Change Text Color", integration->font_regular);
@@ -108,6 +113,7 @@ void widget_integration_create_shadow_widgets(WidgetIntegration* integration) {
                 if (click_data) {
                     click_data->button_index = 0;
                     click_data->page = 0;
+                    click_data->display = integration->display_index;
                     click_data->timestamp = 0; // Will be set when clicked
                     strncpy(click_data->button_text, "Change Text Color", sizeof(click_data->button_text) - 1);
                     log_debug("Setting up button page0_button0: index=0 page=0 text='Change Text Color'");
@@ -144,6 +150,9 @@ void widget_integration_create_shadow_widgets(WidgetIntegration* integration) {
                     int y = row * (button_height + 10) + 10;
                     
                     widget_set_relative_bounds(button, x, y, button_width, button_height);
+                    if (integration->skin) {
+                        widget_set_skin(button, integration->skin, "button");
+                    }
                     
                     // Create text widget as child of button
                     char text_id[64];
@@ -175,6 +184,7 @@ void widget_integration_create_shadow_widgets(WidgetIntegration* integration) {
                         if (click_data) {
                             click_data->button_index = i;
                             click_data->page = 1;
+                            click_data->display = integration->display_index;
                             click_data->timestamp = 0; // Will be set when clicked
                             strncpy(click_data->button_text, button_labels[i], sizeof(click_data->button_text) - 1);
                             log_debug("Setting up button %s: index=%d page=1 text='%s'", 
@@ -328,6 +338,49 @@ void widget_integration_populate_page_widgets(WidgetIntegration* integration) {
             text_widget_set_alignment(instruction_text, TEXT_ALIGN_CENTER);
             widget_add_child(page, instruction_text);
         }
+        
+        // Live video feed to the right of the button
+        if (integration->video_source[0]) {
+            Widget* video = video_widget_create("page0_video", integration->video_source,
+                integration->video_width, integration->video_height);
+            if (video) {
+                widget_set_bounds(video, 240, 100,
+                    integration->screen_width - 260, 170);
+                widget_add_child(page, video);
+                if (video_widget_start(video) != PK_OK) {
+                    log_warn("Video feed '%s' not started: %s",
+                             integration->video_source, pk_get_last_error_context());
+                }
+            }
+        }
+        
+        // Tile map below the instructions, if the screen leaves room
+        int map_height = integration->screen_height - 370;
+        if (integration->map_source[0] && map_height >= 80) {
+            MapWidgetConfig map_config = map_widget_default_config();
+            map_config.source = integration->map_source;
+            map_config.cache_dir = integration->map_cache_dir[0] ? integration->map_cache_dir : NULL;
+            map_config.disk_cache_mb = (size_t)integration->map_cache_mb;
+            map_config.memory_cache_mb = (size_t)integration->map_memory_mb;
+            map_config.min_zoom = integration->map_min_zoom;
+            map_config.max_zoom = integration->map_max_zoom;
+            map_config.zoom = integration->map_zoom;
+            map_latlon_to_world(integration->map_lat, integration->map_lon,
+                                &map_config.center_x, &map_config.center_y);
+            
+            Widget* map = map_widget_create("page0_map", &map_config);
+            if (map) {
+                widget_set_bounds(map, 20, 350, integration->screen_width - 40, map_height);
+                widget_add_child(page, map);
+                if (map_widget_start(map) != PK_OK) {
+                    log_warn("Map tiles from '%s' not loading: %s",
+                             integration->map_source, pk_get_last_error_context());
+                }
+            }
+        } else if (integration->map_source[0]) {
+            log_warn("Screen too small for the map (%dpx left below the page text)",
+                     map_height);
+        }
     }
     
     // Populate Page 1 (Buttons and data page)
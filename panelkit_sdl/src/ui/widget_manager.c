@@ -313,22 +313,18 @@ void widget_manager_update(WidgetManager* manager) {
     widget_update(manager->active_root, delta_time);
 }
 
-PkError widget_manager_render(WidgetManager* manager) {
+PkError widget_manager_render(WidgetManager* manager, DisplayList* list) {
     PK_CHECK_ERROR_WITH_CONTEXT(manager != NULL, PK_ERROR_NULL_PARAM,
                                "manager is NULL in widget_manager_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in widget_manager_render");
     
     if (!manager->active_root) {
         // No active root is not an error - just nothing to render
         return PK_OK;
     }
     
-    if (!manager->renderer) {
-        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
-                                       "renderer is NULL in widget_manager_render");
-        return PK_ERROR_NULL_PARAM;
-    }
-    
-    PkError err = widget_render(manager->active_root, manager->renderer);
+    PkError err = widget_render(manager->active_root, list);
     if (err != PK_OK) {
         pk_set_last_error_with_context(err,
                                        "Failed to render active root '%s'",
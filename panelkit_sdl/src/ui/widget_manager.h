@@ -35,7 +35,7 @@ typedef struct WidgetManager {
     EventSystem* event_system;
     StateStore* state_store;
     
-    // Rendering context
+    // Rendering context (output size queries; drawing goes through DisplayList)
     SDL_Renderer* renderer;
     
     // Timing
@@ -129,10 +129,11 @@ void widget_manager_update(WidgetManager* manager);
  * Render the active root widget and its children.
  * 
  * @param manager Widget manager (required)
+ * @param list Display list to record into (required)
  * @return PK_OK on success, error code on failure
  * @note Only renders if active root is set
  */
-PkError widget_manager_render(WidgetManager* manager);
+PkError widget_manager_render(WidgetManager* manager, DisplayList* list);
 
 /* Widget finding */
 
@@ -9,7 +9,7 @@
 #include "core/error.h"
 
 // Forward declarations for virtual functions
-static PkError button_widget_render(Widget* widget, SDL_Renderer* renderer);
+static PkError button_widget_render(Widget* widget, DisplayList* list);
 static void button_widget_handle_event(Widget* widget, const SDL_Event* event);
 static void button_widget_destroy(Widget* widget);
 
@@ -192,12 +192,12 @@ void button_widget_click(ButtonWidget* button) {
     }
 }
 
-static PkError button_widget_render(Widget* widget, SDL_Renderer* renderer) {
+static PkError button_widget_render(Widget* widget, DisplayList* list) {
     ButtonWidget* button = (ButtonWidget*)widget;
     PK_CHECK_ERROR_WITH_CONTEXT(button != NULL, PK_ERROR_NULL_PARAM,
                                "button is NULL in button_widget_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in button_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in button_widget_render");
     
     log_debug("BUTTON RENDER: %s at (%d,%d) size %dx%d color (%d,%d,%d) children=%zu", 
               button->base.id, widget->bounds.x, widget->bounds.y, 
@@ -227,7 +227,7 @@ static PkError button_widget_render(Widget* widget, SDL_Renderer* renderer) {
     }
     
     // Call base render for background and border
-    PkError err = widget_default_render(widget, renderer);
+    PkError err = widget_default_render(widget, list);
     if (err != PK_OK) {
         return err;
     }
@@ -236,7 +236,7 @@ static PkError button_widget_render(Widget* widget, SDL_Renderer* renderer) {
     
     // Draw focus indicator
     if (widget_has_state(widget, WIDGET_STATE_FOCUSED)) {
-        if (SDL_SetRenderDrawColor(renderer, 0, 120, 255, 255) < 0) {
+        if (display_list_set_draw_color(list, 0, 120, 255, 255) < 0) {
             pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
                                            "Failed to set focus color: %s",
                                            SDL_GetError());
@@ -248,7 +248,7 @@ static PkError button_widget_render(Widget* widget, SDL_Renderer* renderer) {
             widget->bounds.w + 4,
             widget->bounds.h + 4
         };
-        if (SDL_RenderDrawRect(renderer, &focus_rect) < 0) {
+        if (display_list_draw_rect(list, &focus_rect) < 0) {
             pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
                                            "Failed to draw focus rect: %s",
                                            SDL_GetError());
@@ -5,7 +5,7 @@
 #include "core/error.h"
 
 // Forward declarations
-static PkError data_display_widget_render(Widget* widget, SDL_Renderer* renderer);
+static PkError data_display_widget_render(Widget* widget, DisplayList* list);
 static void data_display_widget_destroy(Widget* widget);
 static void data_display_widget_layout(Widget* widget);
 
@@ -185,11 +185,11 @@ static void data_display_widget_layout(Widget* widget) {
     }
 }
 
-static PkError data_display_widget_render(Widget* widget, SDL_Renderer* renderer) {
+static PkError data_display_widget_render(Widget* widget, DisplayList* list) {
     PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
                                "widget is NULL in data_display_widget_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in data_display_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in data_display_widget_render");
     
     // Layout children
     data_display_widget_layout(widget);
@@ -197,7 +197,7 @@ static PkError data_display_widget_render(Widget* widget, SDL_Renderer* renderer
     // Render all child text widgets
     for (size_t i = 0; i < widget->child_count; i++) {
         if (widget->children[i] && widget->children[i]->render) {
-            PkError err = widget->children[i]->render(widget->children[i], renderer);
+            PkError err = widget->children[i]->render(widget->children[i], list);
             if (err != PK_OK) {
                 return err;
             }
@@ -0,0 +1,562 @@
+#include "gauge_widget.h"
+#include "../core/error.h"
+#include "../core/logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+/* Solid white rows below the face, after one transparent row so filtering
+ * at the face's bottom edge never picks them up. The needle samples the
+ * middle of the strip. */
+#define GAUGE_STRIP_ROWS 4
+#define GAUGE_STRIP_TOP(height) ((height) + 1)
+
+/* Value arc tessellation over a full sweep */
+#define GAUGE_ARC_SEGMENTS 48
+#define GAUGE_HUB_SEGMENTS 12
+
+/* Face layout as fractions of the dial radius */
+#define SCALE_RADIUS 0.90f
+#define MAJOR_TICK_INNER 0.76f
+#define MINOR_TICK_INNER 0.83f
+#define WARN_INNER 0.80f
+#define VALUE_ARC_INNER 0.91f
+#define VALUE_ARC_OUTER 0.99f
+#define NEEDLE_LENGTH 0.82f
+#define NEEDLE_TAIL 0.18f
+#define HUB_RADIUS 0.08f
+
+#define DEG_TO_RAD 0.017453292519943295f
+
+/* Face quad + needle + hub, or face quad + value arc */
+#define GAUGE_MAX_VERTICES (4 + 2 * (GAUGE_ARC_SEGMENTS + 1) + 4 + GAUGE_HUB_SEGMENTS + 1)
+#define GAUGE_MAX_INDICES (6 + 6 * GAUGE_ARC_SEGMENTS + 6 + 3 * GAUGE_HUB_SEGMENTS)
+
+// Forward declarations
+static void gauge_widget_update(Widget* widget, double delta_time);
+static PkError gauge_widget_render(Widget* widget, DisplayList* list);
+static void gauge_widget_handle_data_event(Widget* widget, const char* event_name,
+                                           const void* data, size_t data_size);
+static void gauge_widget_destroy(Widget* widget);
+
+GaugeConfig gauge_widget_default_config(void) {
+    GaugeConfig config = {
+        .min_value = 0.0f,
+        .max_value = 100.0f,
+        .start_angle = -135.0f,
+        .sweep_angle = 270.0f,
+        .major_ticks = 10,
+        .minor_ticks = 5,
+        .warn_from = 100.0f,
+        .response_time = 0.25f,
+        .style = GAUGE_STYLE_NEEDLE,
+        .face_color = {30, 32, 36, 255},
+        .scale_color = {220, 220, 220, 255},
+        .warn_color = {220, 60, 50, 255},
+        .needle_color = {255, 140, 0, 255}
+    };
+    return config;
+}
+
+Widget* gauge_widget_create(const char* id, const GaugeConfig* config) {
+    if (!id) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+            "gauge_widget_create: id is NULL");
+        return NULL;
+    }
+
+    GaugeConfig defaults = gauge_widget_default_config();
+    if (!config) {
+        config = &defaults;
+    }
+    if (!(config->max_value > config->min_value) ||
+        config->sweep_angle <= 0.0f || config->sweep_angle > 360.0f) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "gauge_widget_create: invalid scale for '%s' (%g-%g over %g degrees)",
+            id, config->min_value, config->max_value, config->sweep_angle);
+        return NULL;
+    }
+
+    GaugeWidget* gauge = calloc(1, sizeof(GaugeWidget));
+    if (!gauge) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "gauge_widget_create: Failed to allocate %zu bytes", sizeof(GaugeWidget));
+        return NULL;
+    }
+
+    // Initialize base widget
+    Widget* base = &gauge->base;
+    strncpy(base->id, id, sizeof(base->id) - 1);
+    base->type = WIDGET_TYPE_CUSTOM;
+    base->state_flags = WIDGET_STATE_NORMAL;
+
+    // Set widget methods
+    base->update = gauge_widget_update;
+    base->render = gauge_widget_render;
+    base->handle_data_event = gauge_widget_handle_data_event;
+    base->destroy = gauge_widget_destroy;
+
+    // Initialize arrays
+    base->child_capacity = 0;
+    base->children = NULL;
+    base->event_capacity = 2;
+    base->subscribed_events = calloc(base->event_capacity, sizeof(char*));
+    if (!base->subscribed_events) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "gauge_widget_create: Failed to allocate event array");
+        free(gauge);
+        return NULL;
+    }
+
+    // Copy configuration; strings live in the widget
+    gauge->config = *config;
+    strncpy(gauge->title, config->title ? config->title : "", sizeof(gauge->title) - 1);
+    strncpy(gauge->unit, config->unit ? config->unit : "", sizeof(gauge->unit) - 1);
+    gauge->config.title = gauge->title;
+    gauge->config.unit = gauge->unit;
+    gauge->config.value_event = NULL;
+    if (gauge->config.minor_ticks < 1) {
+        gauge->config.minor_ticks = 1;
+    }
+    if (gauge->config.major_ticks < 0) {
+        gauge->config.major_ticks = 0;
+    }
+
+    gauge->target_value = config->min_value;
+    gauge->display_value = config->min_value;
+    gauge->face_dirty = true;
+
+    // Set default size
+    base->bounds.w = 160;
+    base->bounds.h = 160;
+
+    if (config->value_event && config->value_event[0]) {
+        widget_subscribe_event(base, config->value_event);
+    }
+
+    log_debug("Created gauge widget '%s' (%g-%g)", id, config->min_value, config->max_value);
+    return (Widget*)gauge;
+}
+
+void gauge_widget_set_value(Widget* widget, float value) {
+    if (!widget || widget->render != gauge_widget_render) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "gauge_widget_set_value: Invalid widget");
+        return;
+    }
+    GaugeWidget* gauge = (GaugeWidget*)widget;
+
+    if (gauge->target_value != value) {
+        gauge->target_value = value;
+        widget_invalidate(widget);
+    }
+}
+
+void gauge_widget_set_value_immediate(Widget* widget, float value) {
+    if (!widget || widget->render != gauge_widget_render) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "gauge_widget_set_value_immediate: Invalid widget");
+        return;
+    }
+    GaugeWidget* gauge = (GaugeWidget*)widget;
+
+    gauge->target_value = value;
+    gauge->display_value = value;
+    widget_invalidate(widget);
+}
+
+float gauge_widget_get_display_value(Widget* widget) {
+    if (!widget || widget->render != gauge_widget_render) {
+        return 0.0f;
+    }
+    return ((GaugeWidget*)widget)->display_value;
+}
+
+void gauge_widget_set_font(Widget* widget, TTF_Font* font) {
+    if (!widget || widget->render != gauge_widget_render) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "gauge_widget_set_font: Invalid widget");
+        return;
+    }
+    GaugeWidget* gauge = (GaugeWidget*)widget;
+
+    gauge->config.font = font;
+    gauge->face_dirty = true;
+    widget_invalidate(widget);
+}
+
+static void gauge_widget_update(Widget* widget, double delta_time) {
+    if (!widget) return;
+    GaugeWidget* gauge = (GaugeWidget*)widget;
+
+    float diff = gauge->target_value - gauge->display_value;
+    if (diff == 0.0f) {
+        return;
+    }
+
+    /* Exponential approach: frame-rate independent and never overshoots */
+    float settle = (gauge->config.max_value - gauge->config.min_value) * 0.0005f;
+    if (gauge->config.response_time <= 0.0f || fabsf(diff) <= settle) {
+        gauge->display_value = gauge->target_value;
+    } else {
+        float k = 1.0f - expf(-(float)delta_time / gauge->config.response_time);
+        gauge->display_value += diff * k;
+    }
+    widget_invalidate(widget);
+}
+
+static void gauge_widget_handle_data_event(Widget* widget, const char* event_name,
+                                           const void* data, size_t data_size) {
+    if (!widget || !data) return;
+
+    if (data_size == sizeof(double)) {
+        gauge_widget_set_value(widget, (float)*(const double*)data);
+    } else if (data_size == sizeof(float)) {
+        gauge_widget_set_value(widget, *(const float*)data);
+    } else {
+        log_debug("Gauge '%s' ignored '%s' payload of %zu bytes",
+                  widget->id, event_name, data_size);
+    }
+}
+
+// Static face
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static float value_fraction(const GaugeConfig* config, float value) {
+    return clampf((value - config->min_value) / (config->max_value - config->min_value),
+                  0.0f, 1.0f);
+}
+
+/* Coverage of the band [inner, outer] at radius r, antialiased over 1px */
+static float band_coverage(float r, float inner, float outer) {
+    return clampf(r - inner + 0.5f, 0.0f, 1.0f) * clampf(outer - r + 0.5f, 0.0f, 1.0f);
+}
+
+/* Coverage of the angular span [a0, a1] (degrees) at radius r */
+static float span_coverage(float angle, float r, float a0, float a1) {
+    return clampf((angle - a0) * DEG_TO_RAD * r + 0.5f, 0.0f, 1.0f) *
+           clampf((a1 - angle) * DEG_TO_RAD * r + 0.5f, 0.0f, 1.0f);
+}
+
+static void blend_over(float rgb[3], SDL_Color color, float coverage) {
+    float a = coverage * (float)color.a / 255.0f;
+    rgb[0] += ((float)color.r - rgb[0]) * a;
+    rgb[1] += ((float)color.g - rgb[1]) * a;
+    rgb[2] += ((float)color.b - rgb[2]) * a;
+}
+
+/* Blit a label centered on (cx, cy) */
+static void blit_label(SDL_Surface* face, TTF_Font* font, const char* text,
+                       SDL_Color color, float cx, float cy) {
+    if (!font || !text || !text[0]) {
+        return;
+    }
+    SDL_Surface* label = TTF_RenderUTF8_Blended(font, text, color);
+    if (!label) {
+        return;
+    }
+    SDL_Rect dst = {
+        (int)(cx - (float)label->w * 0.5f + 0.5f),
+        (int)(cy - (float)label->h * 0.5f + 0.5f),
+        label->w, label->h
+    };
+    SDL_BlitSurface(label, NULL, face, &dst);
+    SDL_FreeSurface(label);
+}
+
+static void draw_tick_labels(GaugeWidget* gauge, SDL_Surface* face, float cx, float cy,
+                             float radius) {
+    const GaugeConfig* config = &gauge->config;
+    if (!config->font) {
+        return;
+    }
+
+    float step = (config->max_value - config->min_value) / (float)(config->major_ticks > 0 ?
+                                                                   config->major_ticks : 1);
+    bool integral = fabsf(step - roundf(step)) < 0.001f &&
+                    fabsf(config->min_value - roundf(config->min_value)) < 0.001f;
+    /* A full circle would print the first and last label on top of each other */
+    int last = config->sweep_angle >= 360.0f ? config->major_ticks - 1 : config->major_ticks;
+
+    for (int i = 0; config->major_ticks > 0 && i <= last; i++) {
+        float value = config->min_value + step * (float)i;
+        char text[16];
+        snprintf(text, sizeof(text), integral ? "%.0f" : "%.1f", value);
+
+        int w = 0, h = 0;
+        TTF_SizeUTF8(config->font, text, &w, &h);
+        float extent = (float)(w > h ? w : h) * 0.5f;
+        float r = radius * MAJOR_TICK_INNER - extent - 2.0f;
+        float angle = (config->start_angle + config->sweep_angle * (float)i /
+                       (float)config->major_ticks) * DEG_TO_RAD;
+        blit_label(face, config->font, text, config->scale_color,
+                   cx + r * sinf(angle), cy - r * cosf(angle));
+    }
+
+    blit_label(face, config->font, gauge->title, config->scale_color, cx, cy - radius * 0.35f);
+    blit_label(face, config->font, gauge->unit, config->scale_color, cx, cy + radius * 0.40f);
+}
+
+/* Draw the dial into a new surface (zero-filled, so the separator row
+ * stays transparent); the white strip goes below it */
+static SDL_Surface* gauge_build_face(GaugeWidget* gauge, int width, int height) {
+    const GaugeConfig* config = &gauge->config;
+    SDL_Surface* face = SDL_CreateRGBSurfaceWithFormat(0, width,
+                                                       GAUGE_STRIP_TOP(height) + GAUGE_STRIP_ROWS, 32,
+                                                       SDL_PIXELFORMAT_ARGB8888);
+    if (!face) {
+        pk_set_last_error_with_context(PK_ERROR_SDL,
+            "gauge_build_face: Failed to create %dx%d surface for '%s': %s",
+            width, GAUGE_STRIP_TOP(height) + GAUGE_STRIP_ROWS, gauge->base.id, SDL_GetError());
+        return NULL;
+    }
+
+    float cx = (float)width * 0.5f;
+    float cy = (float)height * 0.5f;
+    float radius = (float)(width < height ? width : height) * 0.5f - 1.0f;
+    float sweep = config->sweep_angle;
+    int tick_count = config->major_ticks * config->minor_ticks;
+    float tick_step = tick_count > 0 ? sweep / (float)tick_count : 0.0f;
+    float major_half = fmaxf(1.0f, radius * 0.012f);
+    float minor_half = fmaxf(0.5f, radius * 0.006f);
+    float scale_half = fmaxf(0.5f, radius * 0.008f);
+    float warn_start = value_fraction(config, config->warn_from) * sweep;
+    bool has_warn = config->warn_from < config->max_value;
+
+    Uint32* pixels = face->pixels;
+    int stride = face->pitch / 4;
+
+    for (int y = 0; y < height; y++) {
+        float dy = (float)y + 0.5f - cy;
+        for (int x = 0; x < width; x++) {
+            float dx = (float)x + 0.5f - cx;
+            float r = sqrtf(dx * dx + dy * dy);
+            float disc = clampf(radius - r + 0.5f, 0.0f, 1.0f);
+            if (disc <= 0.0f) {
+                pixels[y * stride + x] = 0;
+                continue;
+            }
+
+            /* Degrees clockwise from the scale start; the half of the gap
+             * nearer the start goes negative so tick 0 antialiases */
+            float angle = atan2f(dx, -dy) / DEG_TO_RAD - config->start_angle;
+            angle = fmodf(angle, 360.0f);
+            if (angle < 0.0f) {
+                angle += 360.0f;
+            }
+            if (angle > (sweep + 360.0f) * 0.5f) {
+                angle -= 360.0f;
+            }
+
+            float rgb[3] = { config->face_color.r, config->face_color.g, config->face_color.b };
+
+            if (has_warn) {
+                blend_over(rgb, config->warn_color,
+                           band_coverage(r, radius * WARN_INNER, radius * SCALE_RADIUS) *
+                           span_coverage(angle, r, warn_start, sweep));
+            }
+
+            blend_over(rgb, config->scale_color,
+                       band_coverage(r, radius * SCALE_RADIUS - scale_half,
+                                     radius * SCALE_RADIUS + scale_half) *
+                       span_coverage(angle, r, 0.0f, sweep));
+
+            if (tick_count > 0 && r >= radius * MAJOR_TICK_INNER - 1.0f &&
+                r <= radius * SCALE_RADIUS + 1.0f) {
+                int k = (int)floorf(angle / tick_step + 0.5f);
+                if (k >= 0 && k <= tick_count) {
+                    bool major = k % config->minor_ticks == 0;
+                    float off = fabsf(angle - (float)k * tick_step) * DEG_TO_RAD * r;
+                    float half = major ? major_half : minor_half;
+                    float inner = radius * (major ? MAJOR_TICK_INNER : MINOR_TICK_INNER);
+                    blend_over(rgb, config->scale_color,
+                               clampf(half + 0.5f - off, 0.0f, 1.0f) *
+                               band_coverage(r, inner, radius * SCALE_RADIUS));
+                }
+            }
+
+            pixels[y * stride + x] = SDL_MapRGBA(face->format,
+                                                 (Uint8)(rgb[0] + 0.5f),
+                                                 (Uint8)(rgb[1] + 0.5f),
+                                                 (Uint8)(rgb[2] + 0.5f),
+                                                 (Uint8)(disc * config->face_color.a + 0.5f));
+        }
+    }
+
+    draw_tick_labels(gauge, face, cx, cy, radius);
+
+    SDL_Rect strip = { 0, GAUGE_STRIP_TOP(height), width, GAUGE_STRIP_ROWS };
+    SDL_FillRect(face, &strip, SDL_MapRGBA(face->format, 255, 255, 255, 255));
+    return face;
+}
+
+// Per-frame geometry
+
+typedef struct {
+    SDL_Vertex vertices[GAUGE_MAX_VERTICES];
+    int indices[GAUGE_MAX_INDICES];
+    int vertex_count;
+    int index_count;
+    SDL_FPoint white;       /* Texture coordinate inside the white strip */
+} GaugeBatch;
+
+static int batch_vertex(GaugeBatch* batch, float x, float y, SDL_Color color,
+                        float u, float v) {
+    batch->vertices[batch->vertex_count] = (SDL_Vertex){
+        .position = { x, y },
+        .color = color,
+        .tex_coord = { u, v }
+    };
+    return batch->vertex_count++;
+}
+
+static int batch_solid(GaugeBatch* batch, float x, float y, SDL_Color color) {
+    return batch_vertex(batch, x, y, color, batch->white.x, batch->white.y);
+}
+
+static void batch_triangle(GaugeBatch* batch, int a, int b, int c) {
+    batch->indices[batch->index_count++] = a;
+    batch->indices[batch->index_count++] = b;
+    batch->indices[batch->index_count++] = c;
+}
+
+static void batch_needle(GaugeBatch* batch, const GaugeConfig* config, float cx, float cy,
+                         float radius, float angle) {
+    float ux = sinf(angle);
+    float uy = -cosf(angle);
+    float half_width = fmaxf(1.5f, radius * 0.035f);
+    SDL_Color color = config->needle_color;
+
+    int tip = batch_solid(batch, cx + ux * radius * NEEDLE_LENGTH,
+                          cy + uy * radius * NEEDLE_LENGTH, color);
+    int left = batch_solid(batch, cx - uy * half_width, cy + ux * half_width, color);
+    int right = batch_solid(batch, cx + uy * half_width, cy - ux * half_width, color);
+    int tail = batch_solid(batch, cx - ux * radius * NEEDLE_TAIL,
+                           cy - uy * radius * NEEDLE_TAIL, color);
+    batch_triangle(batch, tip, left, right);
+    batch_triangle(batch, left, tail, right);
+
+    int center = batch_solid(batch, cx, cy, color);
+    int first = batch->vertex_count;
+    float hub = fmaxf(2.0f, radius * HUB_RADIUS);
+    for (int i = 0; i < GAUGE_HUB_SEGMENTS; i++) {
+        float a = (float)i * (2.0f * (float)M_PI / GAUGE_HUB_SEGMENTS);
+        batch_solid(batch, cx + hub * cosf(a), cy + hub * sinf(a), color);
+    }
+    for (int i = 0; i < GAUGE_HUB_SEGMENTS; i++) {
+        batch_triangle(batch, center, first + i, first + (i + 1) % GAUGE_HUB_SEGMENTS);
+    }
+}
+
+static void batch_value_arc(GaugeBatch* batch, const GaugeConfig* config, float cx, float cy,
+                            float radius, float fraction) {
+    int segments = (int)ceilf(GAUGE_ARC_SEGMENTS * fraction);
+    if (segments < 1 || fraction <= 0.0f) {
+        return;
+    }
+
+    float inner = radius * VALUE_ARC_INNER;
+    float outer = radius * VALUE_ARC_OUTER;
+    float start = config->start_angle * DEG_TO_RAD;
+    float span = config->sweep_angle * fraction * DEG_TO_RAD;
+    int first = batch->vertex_count;
+
+    for (int i = 0; i <= segments; i++) {
+        float a = start + span * (float)i / (float)segments;
+        float s = sinf(a);
+        float c = cosf(a);
+        batch_solid(batch, cx + inner * s, cy - inner * c, config->needle_color);
+        batch_solid(batch, cx + outer * s, cy - outer * c, config->needle_color);
+    }
+    for (int i = 0; i < segments; i++) {
+        int v = first + i * 2;
+        batch_triangle(batch, v, v + 1, v + 2);
+        batch_triangle(batch, v + 1, v + 3, v + 2);
+    }
+}
+
+static PkError gauge_widget_render(Widget* widget, DisplayList* list) {
+    PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
+                               "widget is NULL in gauge_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in gauge_widget_render");
+    GaugeWidget* gauge = (GaugeWidget*)widget;
+    int width = widget->bounds.w;
+    int height = widget->bounds.h;
+
+    if (width <= 2 || height <= 2) {
+        return PK_OK;
+    }
+
+    // Rebuild the face only when its inputs changed
+    if (gauge->face_dirty || !gauge->face || gauge->face_w != width || gauge->face_h != height) {
+        SDL_Surface* face = gauge_build_face(gauge, width, height);
+        if (!face) {
+            return PK_ERROR_SDL;
+        }
+        /* Display lists still in flight keep their own reference */
+        display_list_release_surface(gauge->face);
+        gauge->face = face;
+        gauge->face_w = width;
+        gauge->face_h = height;
+        gauge->face_dirty = false;
+    }
+
+    GaugeBatch batch;
+    batch.vertex_count = 0;
+    batch.index_count = 0;
+    float total_h = (float)(GAUGE_STRIP_TOP(height) + GAUGE_STRIP_ROWS);
+    batch.white = (SDL_FPoint){
+        0.5f, ((float)GAUGE_STRIP_TOP(height) + GAUGE_STRIP_ROWS * 0.5f) / total_h
+    };
+
+    // Face quad
+    float x0 = (float)widget->bounds.x;
+    float y0 = (float)widget->bounds.y;
+    float x1 = x0 + (float)width;
+    float y1 = y0 + (float)height;
+    float v1 = (float)height / total_h;
+    SDL_Color white = {255, 255, 255, 255};
+    int tl = batch_vertex(&batch, x0, y0, white, 0.0f, 0.0f);
+    int tr = batch_vertex(&batch, x1, y0, white, 1.0f, 0.0f);
+    int bl = batch_vertex(&batch, x0, y1, white, 0.0f, v1);
+    int br = batch_vertex(&batch, x1, y1, white, 1.0f, v1);
+    batch_triangle(&batch, tl, tr, bl);
+    batch_triangle(&batch, tr, br, bl);
+
+    // Moving part
+    const GaugeConfig* config = &gauge->config;
+    float cx = x0 + (float)width * 0.5f;
+    float cy = y0 + (float)height * 0.5f;
+    float radius = (float)(width < height ? width : height) * 0.5f - 1.0f;
+    float fraction = value_fraction(config, gauge->display_value);
+
+    if (config->style == GAUGE_STYLE_ARC) {
+        batch_value_arc(&batch, config, cx, cy, radius, fraction);
+    } else {
+        float angle = (config->start_angle + config->sweep_angle * fraction) * DEG_TO_RAD;
+        batch_needle(&batch, config, cx, cy, radius, angle);
+    }
+
+    if (display_list_geometry(list, gauge->face, batch.vertices, batch.vertex_count,
+                              batch.indices, batch.index_count) < 0) {
+        pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                       "Failed to record gauge widget '%s': %s",
+                                       widget->id, SDL_GetError());
+        return PK_ERROR_RENDER_FAILED;
+    }
+
+    return PK_OK;
+}
+
+static void gauge_widget_destroy(Widget* widget) {
+    if (!widget) return;
+    GaugeWidget* gauge = (GaugeWidget*)widget;
+
+    display_list_release_surface(gauge->face);
+    gauge->face = NULL;
+}
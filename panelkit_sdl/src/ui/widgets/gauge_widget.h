@@ -0,0 +1,118 @@
+/**
+ * @file gauge_widget.h
+ * @brief Analog gauge/dial widget with a cached static face
+ *
+ * The dial face (disc, scale arc, warning zone, ticks, tick labels, title
+ * and unit) is drawn once in software into a surface and reused until the
+ * widget is resized or restyled. Each frame records a single geometry
+ * command: the face as a textured quad plus the needle or value arc,
+ * textured from a solid white strip kept below the face so the moving
+ * parts share the face's texture. A screen of gauges therefore costs one
+ * draw call per gauge.
+ *
+ * The displayed value eases towards the target value over response_time,
+ * driven by the update delta.
+ */
+
+#ifndef GAUGE_WIDGET_H
+#define GAUGE_WIDGET_H
+
+#include "../widget.h"
+
+/** How the current value is shown */
+typedef enum {
+    GAUGE_STYLE_NEEDLE,     /**< Tapered needle with a hub */
+    GAUGE_STYLE_ARC         /**< Filled arc from the scale start to the value */
+} GaugeStyle;
+
+/**
+ * Gauge appearance and scale.
+ */
+typedef struct {
+    float min_value;            /**< Scale start */
+    float max_value;            /**< Scale end (> min_value) */
+    float start_angle;          /**< Degrees clockwise from 12 o'clock */
+    float sweep_angle;          /**< Degrees covered by the scale (1-360) */
+    int major_ticks;            /**< Labeled intervals on the scale (0 = none) */
+    int minor_ticks;            /**< Subdivisions per major interval */
+    float warn_from;            /**< Warning zone start; >= max_value disables */
+    float response_time;        /**< Seconds to settle ~63% of a change (0 = snap) */
+    GaugeStyle style;
+    const char* title;          /**< Label above the hub (copied, can be NULL) */
+    const char* unit;           /**< Label below the hub (copied, can be NULL) */
+    const char* value_event;    /**< Event carrying a float/double value (copied, can be NULL) */
+    TTF_Font* font;             /**< Font for labels (borrowed, NULL = no labels) */
+    SDL_Color face_color;
+    SDL_Color scale_color;      /**< Scale arc, ticks and labels */
+    SDL_Color warn_color;
+    SDL_Color needle_color;     /**< Needle or value arc */
+} GaugeConfig;
+
+typedef struct GaugeWidget {
+    Widget base;  // Must be first member for casting
+
+    GaugeConfig config;
+    char title[32];
+    char unit[16];
+
+    // Value animation
+    float target_value;
+    float display_value;
+
+    // Cached face: face_w x face_h dial above a solid white strip
+    SDL_Surface* face;
+    int face_w;
+    int face_h;
+    bool face_dirty;
+} GaugeWidget;
+
+/**
+ * Get default gauge configuration.
+ *
+ * @return 0-100 scale over 270 degrees, 10 major and 5 minor ticks, needle
+ */
+GaugeConfig gauge_widget_default_config(void);
+
+/**
+ * Create a new gauge widget.
+ *
+ * @param id Unique identifier for the widget (required)
+ * @param config Gauge configuration (NULL for defaults)
+ * @return New gauge widget or NULL on error (caller owns)
+ * @note Subscribes to config->value_event when set
+ */
+Widget* gauge_widget_create(const char* id, const GaugeConfig* config);
+
+/**
+ * Set the value the gauge animates towards.
+ *
+ * @param widget Gauge widget
+ * @param value New value (clamped to the scale when drawn)
+ */
+void gauge_widget_set_value(Widget* widget, float value);
+
+/**
+ * Jump straight to a value without animating.
+ *
+ * @param widget Gauge widget
+ * @param value New value
+ */
+void gauge_widget_set_value_immediate(Widget* widget, float value);
+
+/**
+ * Get the value currently shown (mid-animation values included).
+ *
+ * @param widget Gauge widget
+ * @return Displayed value, or 0 for an invalid widget
+ */
+float gauge_widget_get_display_value(Widget* widget);
+
+/**
+ * Set the label font. Rebuilds the cached face.
+ *
+ * @param widget Gauge widget
+ * @param font Font for labels (borrowed, NULL = no labels)
+ */
+void gauge_widget_set_font(Widget* widget, TTF_Font* font);
+
+#endif // GAUGE_WIDGET_H
@@ -0,0 +1,1225 @@
+#include "map_widget.h"
+#include "../core/error.h"
+#include "../core/logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifdef HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+#define MAP_TILE_BUCKETS 1024           /* Power of two */
+#define MAP_MAX_VISIBLE 256
+#define MAP_MAX_PREFETCH 64
+#define MAP_MAX_KEEP 512
+#define MAP_FALLBACK_LEVELS 4           /* Ancestors searched for a stand-in */
+#define MAP_COARSE_LEVELS 2             /* Level of the coarse tile requested first */
+#define MAP_OVERZOOM 2                  /* Display zoom beyond the deepest tile level */
+#define MAP_MAX_TILE_PX 1024
+
+#define MAP_POLL_BATCH 16               /* Results taken per update */
+#define MAP_UPLOADS_PER_FRAME 2         /* Prefetched textures created per frame */
+#define MAP_KEEP_MS 10000               /* Off-screen textures older than this are dropped */
+#define MAP_RETRY_MS 5000               /* Failed tiles are retried after this */
+#define MAP_PLACEHOLDER_BYTES 64        /* Accounted size of missing/failed entries */
+
+#define MAP_FLING_FRICTION 4.0          /* Velocity decay rate, 1/s */
+#define MAP_FLING_STOP 20.0             /* Fling ends below this, px/s */
+#define MAP_VELOCITY_WINDOW_MS 30.0     /* Pointer velocity smoothing */
+#define MAP_HOLD_MS 60                  /* Pointer still this long = no fling */
+#define MAP_ZOOM_RATE 12.0              /* Zoom animation rate, 1/s */
+#define MAP_WHEEL_STEP 0.5
+#define MAP_DOUBLE_TAP_MS 300
+#define MAP_TAP_SLOP 12.0f
+
+#define MAP_MAX_LATITUDE 85.0511287798
+
+typedef enum {
+    MAP_TILE_PENDING,           // Wanted on screen, not loaded yet
+    MAP_TILE_READY,
+    MAP_TILE_MISSING,
+    MAP_TILE_FAILED
+} MapTileState;
+
+typedef struct MapTile {
+    TileKey key;
+    MapTileState state;
+    SDL_Surface* surface;       // READY only
+    size_t bytes;
+    uint64_t last_used;         // Frame, for memory LRU
+    uint64_t resident_frame;    // Last frame its texture was drawn or kept
+    uint32_t arrived_ms;
+    uint32_t shown_ms;          // Last drawn or uploaded ahead of time
+    bool requested_visible;     // Was wanted on screen before it arrived
+    bool drawn;
+    struct MapTile* next;
+} MapTile;
+
+typedef struct {
+    SDL_FingerID id;
+    float x;
+    float y;
+} MapFinger;
+
+/* Tile grid covering a viewport at one level */
+typedef struct {
+    int level;
+    int n;                      // Tiles per axis
+    double tile_px;             // On-screen tile edge
+    double left;                // Viewport origin in level pixels
+    double top;
+    int tx0, tx1;               // Inclusive; x wraps
+    int ty0, ty1;               // Inclusive; clamped
+} MapView;
+
+typedef struct {
+    Widget base;  // Must be first member for casting
+
+    MapWidgetConfig config;
+    char source[512];
+    char cache_dir[512];
+    TileLoader* loader;
+
+    // View
+    double center_x;
+    double center_y;
+    double zoom;
+    double target_zoom;
+    float anchor_x;             // Zoom anchor relative to the widget center
+    float anchor_y;
+    bool zooming;
+    double velocity_x;          // Content velocity, px/s
+    double velocity_y;
+    bool view_changed;
+
+    // Pointer tracking
+    bool dragging;
+    bool mouse_drag;
+    bool moved;
+    float last_x;
+    float last_y;
+    float press_x;
+    float press_y;
+    float pending_dx;           // Motion not yet folded into velocity
+    float pending_dy;
+    uint32_t velocity_ms;
+    uint32_t last_tap_ms;
+    float last_tap_x;
+    float last_tap_y;
+    MapFinger fingers[2];
+    int finger_count;
+    float pinch_distance;
+    double pinch_zoom;
+
+    // Decoded tile cache
+    MapTile* buckets[MAP_TILE_BUCKETS];
+    uint32_t tile_count;
+    size_t cache_bytes;
+    size_t cache_budget;
+    uint64_t frame;
+    MapTile* keep[MAP_MAX_KEEP];
+
+    MapWidgetStats stats;
+} MapWidget;
+
+// Forward declarations
+static void map_widget_update(Widget* widget, double delta_time);
+static PkError map_widget_render(Widget* widget, DisplayList* list);
+static void map_widget_handle_event(Widget* widget, const SDL_Event* event);
+static void map_widget_destroy(Widget* widget);
+
+MapWidgetConfig map_widget_default_config(void) {
+    MapWidgetConfig config = {
+        .disk_cache_mb = 256,
+        .memory_cache_mb = 64,
+        .gpu_tiles = 64,
+        .tile_size = 256,
+        .min_zoom = 0,
+        .max_zoom = 19,
+        .zoom = 2.0,
+        .center_x = 0.5,
+        .center_y = 0.5,
+        .workers = 2,
+        .prefetch_ms = 500.0f
+    };
+    return config;
+}
+
+bool map_widget_supports_jpeg(void) {
+#ifdef HAVE_TURBOJPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+void map_latlon_to_world(double lat, double lon, double* x, double* y) {
+    if (lat > MAP_MAX_LATITUDE) {
+        lat = MAP_MAX_LATITUDE;
+    } else if (lat < -MAP_MAX_LATITUDE) {
+        lat = -MAP_MAX_LATITUDE;
+    }
+    double phi = lat * M_PI / 180.0;
+    double wx = (lon + 180.0) / 360.0;
+    wx -= floor(wx);
+    if (x) *x = wx;
+    if (y) *y = (1.0 - log(tan(phi) + 1.0 / cos(phi)) / M_PI) * 0.5;
+}
+
+// Decoding (tile loader workers)
+
+static void* map_decode_tile(const uint8_t* data, size_t size, void* user_data) {
+    (void)user_data;
+
+    if (size > 2 && data[0] == 0xFF && data[1] == 0xD8) {
+#ifdef HAVE_TURBOJPEG
+        tjhandle decoder = tjInitDecompress();
+        if (!decoder) {
+            return NULL;
+        }
+        int width, height, subsamp, colorspace;
+        SDL_Surface* surface = NULL;
+        if (tjDecompressHeader3(decoder, data, (unsigned long)size,
+                                &width, &height, &subsamp, &colorspace) == 0 &&
+            width > 0 && height > 0 && width <= MAP_MAX_TILE_PX && height <= MAP_MAX_TILE_PX) {
+            surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGB888);
+        }
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        int pixel_format = TJPF_BGRX;
+#else
+        int pixel_format = TJPF_XRGB;
+#endif
+        if (surface && tjDecompress2(decoder, data, (unsigned long)size, surface->pixels,
+                                     width, surface->pitch, height, pixel_format,
+                                     TJFLAG_FASTDCT) < 0) {
+            log_debug("Tile JPEG decode error: %s", tjGetErrorStr2(decoder));
+            SDL_FreeSurface(surface);
+            surface = NULL;
+        }
+        tjDestroy(decoder);
+        return surface;
+#else
+        return NULL;
+#endif
+    }
+
+    if (size > 2 && data[0] == 'B' && data[1] == 'M') {
+        SDL_Surface* surface = SDL_LoadBMP_RW(SDL_RWFromConstMem(data, (int)size), 1);
+        if (surface && (surface->w > MAP_MAX_TILE_PX || surface->h > MAP_MAX_TILE_PX)) {
+            SDL_FreeSurface(surface);
+            surface = NULL;
+        }
+        return surface;
+    }
+
+    return NULL;
+}
+
+static void map_free_tile_image(void* image, void* user_data) {
+    (void)user_data;
+    display_list_release_surface(image);
+}
+
+// Decoded tile cache
+
+static uint32_t tile_hash(TileKey key) {
+    uint32_t h = (uint32_t)key.z * 0x9E3779B1u;
+    h ^= (uint32_t)key.x * 0x85EBCA77u;
+    h ^= (uint32_t)key.y * 0xC2B2AE3Du;
+    h ^= h >> 15;
+    return h & (MAP_TILE_BUCKETS - 1);
+}
+
+static MapTile* tile_find(const MapWidget* map, TileKey key) {
+    for (MapTile* tile = map->buckets[tile_hash(key)]; tile; tile = tile->next) {
+        if (tile->key.z == key.z && tile->key.x == key.x && tile->key.y == key.y) {
+            return tile;
+        }
+    }
+    return NULL;
+}
+
+static MapTile* tile_insert(MapWidget* map, TileKey key) {
+    MapTile* tile = calloc(1, sizeof(MapTile));
+    if (!tile) {
+        return NULL;
+    }
+    uint32_t bucket = tile_hash(key);
+    tile->key = key;
+    tile->next = map->buckets[bucket];
+    map->buckets[bucket] = tile;
+    map->tile_count++;
+    return tile;
+}
+
+static void tile_remove(MapWidget* map, MapTile* tile) {
+    MapTile** link = &map->buckets[tile_hash(tile->key)];
+    while (*link && *link != tile) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = tile->next;
+    }
+    map->cache_bytes -= tile->bytes;
+    map->tile_count--;
+    /* Display lists still in flight keep their own reference */
+    display_list_release_surface(tile->surface);
+    free(tile);
+}
+
+static void tile_set_bytes(MapWidget* map, MapTile* tile, size_t bytes) {
+    map->cache_bytes = map->cache_bytes - tile->bytes + bytes;
+    tile->bytes = bytes;
+}
+
+/* Evict least recently used tiles, never ones used this frame */
+static void cache_evict(MapWidget* map) {
+    while (map->cache_bytes > map->cache_budget) {
+        MapTile* oldest = NULL;
+        for (int b = 0; b < MAP_TILE_BUCKETS; b++) {
+            for (MapTile* tile = map->buckets[b]; tile; tile = tile->next) {
+                if (tile->last_used < map->frame &&
+                    (!oldest || tile->last_used < oldest->last_used)) {
+                    oldest = tile;
+                }
+            }
+        }
+        if (!oldest) {
+            return;
+        }
+        tile_remove(map, oldest);
+        map->stats.evictions++;
+    }
+}
+
+static void cache_clear(MapWidget* map) {
+    for (int b = 0; b < MAP_TILE_BUCKETS; b++) {
+        while (map->buckets[b]) {
+            tile_remove(map, map->buckets[b]);
+        }
+    }
+}
+
+Widget* map_widget_create(const char* id, const MapWidgetConfig* config) {
+    if (!id || !config || !config->source) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+            "map_widget_create: id=%p, config=%p", (void*)id, (void*)config);
+        return NULL;
+    }
+    if (config->tile_size < 16 || config->tile_size > MAP_MAX_TILE_PX ||
+        config->min_zoom < 0 || config->max_zoom > 24 || config->min_zoom > config->max_zoom) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "map_widget_create: invalid tile size %d or zoom range %d-%d for '%s'",
+            config->tile_size, config->min_zoom, config->max_zoom, id);
+        return NULL;
+    }
+
+    MapWidget* map = calloc(1, sizeof(MapWidget));
+    if (!map) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "map_widget_create: Failed to allocate %zu bytes", sizeof(MapWidget));
+        return NULL;
+    }
+
+    // Initialize base widget
+    Widget* base = &map->base;
+    strncpy(base->id, id, sizeof(base->id) - 1);
+    base->type = WIDGET_TYPE_CUSTOM;
+    base->state_flags = WIDGET_STATE_NORMAL | WIDGET_STATE_CAPTURES_DRAG;
+    base->background_color = (SDL_Color){40, 44, 48, 255};
+
+    // Set widget methods
+    base->update = map_widget_update;
+    base->render = map_widget_render;
+    base->handle_event = map_widget_handle_event;
+    base->destroy = map_widget_destroy;
+
+    // Copy configuration; strings live in the widget
+    map->config = *config;
+    snprintf(map->source, sizeof(map->source), "%s", config->source);
+    snprintf(map->cache_dir, sizeof(map->cache_dir), "%s",
+             config->cache_dir ? config->cache_dir : "");
+    map->config.source = map->source;
+    map->config.cache_dir = map->cache_dir[0] ? map->cache_dir : NULL;
+    if (map->config.gpu_tiles < 0) {
+        map->config.gpu_tiles = 0;
+    } else if (map->config.gpu_tiles > MAP_MAX_KEEP) {
+        map->config.gpu_tiles = MAP_MAX_KEEP;
+    }
+    map->cache_budget = (config->memory_cache_mb > 0 ? config->memory_cache_mb : 1) * 1024 * 1024;
+
+    map->zoom = config->zoom;
+    map->target_zoom = config->zoom;
+    map_widget_set_center(base, config->center_x, config->center_y);
+    map_widget_set_zoom(base, config->zoom, false);
+
+    base->bounds.w = 320;
+    base->bounds.h = 240;
+
+    log_info("Created map widget '%s' for %s", id, map->source);
+    return base;
+}
+
+PkError map_widget_start(Widget* widget) {
+    PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL && widget->render == map_widget_render,
+                               PK_ERROR_INVALID_PARAM, "Invalid widget in map_widget_start");
+    MapWidget* map = (MapWidget*)widget;
+
+    if (map->loader) {
+        return PK_OK;
+    }
+
+    TileLoaderConfig loader_config = tile_loader_default_config();
+    loader_config.source = map->source;
+    loader_config.cache_dir = map->config.cache_dir;
+    loader_config.disk_cache_mb = map->config.disk_cache_mb;
+    if (map->config.workers > 0) {
+        loader_config.workers = map->config.workers;
+    }
+    loader_config.decode = map_decode_tile;
+    loader_config.free_image = map_free_tile_image;
+    loader_config.user_data = map;
+
+    map->loader = tile_loader_create(&loader_config);
+    if (!map->loader) {
+        // Error context set by tile_loader_create
+        return pk_get_last_error();
+    }
+    if (!map_widget_supports_jpeg()) {
+        log_warn("Map '%s': built without libjpeg-turbo, only BMP tiles can be shown",
+                 widget->id);
+    }
+    return PK_OK;
+}
+
+void map_widget_stop(Widget* widget) {
+    if (!widget || widget->render != map_widget_render) {
+        return;
+    }
+    MapWidget* map = (MapWidget*)widget;
+
+    tile_loader_destroy(map->loader);
+    map->loader = NULL;
+}
+
+// View
+
+static double map_world_px(const MapWidget* map, double zoom) {
+    return (double)map->config.tile_size * exp2(zoom);
+}
+
+static double clampd(double v, double lo, double hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static void map_normalize_center(MapWidget* map) {
+    map->center_x -= floor(map->center_x);
+    map->center_y = clampd(map->center_y, 0.0, 1.0);
+}
+
+static void map_compute_view(const MapWidget* map, double center_x, double center_y,
+                             double zoom, MapView* view) {
+    int level = (int)floor(zoom + 0.5);
+    if (level < map->config.min_zoom) level = map->config.min_zoom;
+    if (level > map->config.max_zoom) level = map->config.max_zoom;
+
+    const SDL_Rect* bounds = &map->base.bounds;
+    view->level = level;
+    view->n = 1 << level;
+    view->tile_px = (double)map->config.tile_size * exp2(zoom - level);
+    view->left = center_x * view->n * view->tile_px - bounds->w * 0.5;
+    view->top = center_y * view->n * view->tile_px - bounds->h * 0.5;
+    view->tx0 = (int)floor(view->left / view->tile_px);
+    view->tx1 = (int)floor((view->left + bounds->w - 1) / view->tile_px);
+    view->ty0 = (int)floor(view->top / view->tile_px);
+    view->ty1 = (int)floor((view->top + bounds->h - 1) / view->tile_px);
+    if (view->ty0 < 0) view->ty0 = 0;
+    if (view->ty1 > view->n - 1) view->ty1 = view->n - 1;
+    /* A world narrower than the widget repeats; don't walk it more than twice */
+    if (view->tx1 - view->tx0 >= 2 * view->n) {
+        view->tx1 = view->tx0 + 2 * view->n - 1;
+    }
+}
+
+static int wrap_tile(int t, int n) {
+    t %= n;
+    return t < 0 ? t + n : t;
+}
+
+/* Screen rect of a tile; edges are rounded so neighbours never leave seams */
+static SDL_Rect map_tile_rect(const MapWidget* map, const MapView* view, int tx, int ty) {
+    const SDL_Rect* bounds = &map->base.bounds;
+    int x0 = (int)floor(tx * view->tile_px - view->left + 0.5);
+    int x1 = (int)floor((tx + 1) * view->tile_px - view->left + 0.5);
+    int y0 = (int)floor(ty * view->tile_px - view->top + 0.5);
+    int y1 = (int)floor((ty + 1) * view->tile_px - view->top + 0.5);
+    SDL_Rect rect = { bounds->x + x0, bounds->y + y0, x1 - x0, y1 - y0 };
+    return rect;
+}
+
+static void map_pan(MapWidget* map, double dx, double dy) {
+    double world = map_world_px(map, map->zoom);
+    map->center_x -= dx / world;
+    map->center_y -= dy / world;
+    map_normalize_center(map);
+    map->view_changed = true;
+}
+
+/* Zoom keeping the point at (ax, ay) from the widget center fixed */
+static void map_zoom_around(MapWidget* map, double zoom, double ax, double ay) {
+    zoom = clampd(zoom, map->config.min_zoom, map->config.max_zoom + MAP_OVERZOOM);
+    double before = map_world_px(map, map->zoom);
+    double after = map_world_px(map, zoom);
+    map->center_x += ax / before - ax / after;
+    map->center_y += ay / before - ay / after;
+    map->zoom = zoom;
+    map_normalize_center(map);
+    map->view_changed = true;
+}
+
+/* Start an animated zoom towards a level, anchored at a screen point */
+static void map_zoom_to(MapWidget* map, double zoom, float screen_x, float screen_y) {
+    const SDL_Rect* bounds = &map->base.bounds;
+    map->target_zoom = clampd(zoom, map->config.min_zoom, map->config.max_zoom + MAP_OVERZOOM);
+    map->anchor_x = screen_x - (bounds->x + bounds->w * 0.5f);
+    map->anchor_y = screen_y - (bounds->y + bounds->h * 0.5f);
+    map->zooming = true;
+    map->velocity_x = 0.0;
+    map->velocity_y = 0.0;
+}
+
+void map_widget_set_center(Widget* widget, double x, double y) {
+    if (!widget || widget->render != map_widget_render) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "map_widget_set_center: Invalid widget");
+        return;
+    }
+    MapWidget* map = (MapWidget*)widget;
+
+    map->center_x = x;
+    map->center_y = y;
+    map->velocity_x = 0.0;
+    map->velocity_y = 0.0;
+    map_normalize_center(map);
+    map->view_changed = true;
+}
+
+void map_widget_set_center_latlon(Widget* widget, double lat, double lon) {
+    double x, y;
+    map_latlon_to_world(lat, lon, &x, &y);
+    map_widget_set_center(widget, x, y);
+}
+
+void map_widget_set_zoom(Widget* widget, double zoom, bool animate) {
+    if (!widget || widget->render != map_widget_render) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "map_widget_set_zoom: Invalid widget");
+        return;
+    }
+    MapWidget* map = (MapWidget*)widget;
+
+    if (animate) {
+        map_zoom_to(map, zoom, widget->bounds.x + widget->bounds.w * 0.5f,
+                    widget->bounds.y + widget->bounds.h * 0.5f);
+    } else {
+        map->zooming = false;
+        map_zoom_around(map, zoom, 0.0, 0.0);
+        map->target_zoom = map->zoom;
+    }
+}
+
+double map_widget_get_zoom(Widget* widget) {
+    if (!widget || widget->render != map_widget_render) {
+        return 0.0;
+    }
+    return ((MapWidget*)widget)->zoom;
+}
+
+void map_widget_get_stats(Widget* widget, MapWidgetStats* stats) {
+    if (!widget || widget->render != map_widget_render || !stats) {
+        return;
+    }
+    MapWidget* map = (MapWidget*)widget;
+
+    *stats = map->stats;
+    stats->tiles_cached = map->tile_count;
+    stats->cache_bytes = map->cache_bytes;
+    memset(&stats->loader, 0, sizeof(stats->loader));
+    if (map->loader) {
+        tile_loader_get_stats(map->loader, &stats->loader);
+    }
+}
+
+// Update: results, animation, requests
+
+/* Take finished tiles from the loader; returns true if any arrived */
+static bool map_poll_tiles(MapWidget* map, uint32_t now) {
+    TileResult results[MAP_POLL_BATCH];
+    int count = tile_loader_poll(map->loader, results, MAP_POLL_BATCH);
+
+    for (int i = 0; i < count; i++) {
+        TileResult* result = &results[i];
+        MapTile* tile = tile_find(map, result->key);
+        if (!tile) {
+            tile = tile_insert(map, result->key);
+        }
+        if (!tile || tile->state == MAP_TILE_READY) {
+            // Duplicate load or out of memory
+            if (result->image) {
+                map_free_tile_image(result->image, map);
+            }
+            continue;
+        }
+
+        tile->last_used = map->frame;
+        tile->arrived_ms = now;
+        switch (result->status) {
+            case TILE_STATUS_OK: {
+                SDL_Surface* surface = result->image;
+                tile->state = MAP_TILE_READY;
+                tile->surface = surface;
+                tile_set_bytes(map, tile, (size_t)surface->pitch * (size_t)surface->h);
+                break;
+            }
+            case TILE_STATUS_MISSING:
+                tile->state = MAP_TILE_MISSING;
+                tile_set_bytes(map, tile, MAP_PLACEHOLDER_BYTES);
+                break;
+            case TILE_STATUS_ERROR:
+                tile->state = MAP_TILE_FAILED;
+                tile_set_bytes(map, tile, MAP_PLACEHOLDER_BYTES);
+                break;
+        }
+    }
+
+    if (count > 0) {
+        cache_evict(map);
+    }
+    return count > 0;
+}
+
+static bool map_needs_load(const MapTile* tile, uint32_t now) {
+    return !tile || tile->state == MAP_TILE_PENDING ||
+           (tile->state == MAP_TILE_FAILED && now - tile->arrived_ms >= MAP_RETRY_MS);
+}
+
+/* True if the tile or one of its near ancestors can be drawn */
+static bool map_has_coverage(const MapWidget* map, TileKey key) {
+    for (int d = 0; d <= MAP_FALLBACK_LEVELS && key.z - d >= 0; d++) {
+        TileKey ancestor = { key.z - d, key.x >> d, key.y >> d };
+        const MapTile* tile = tile_find(map, ancestor);
+        if (tile && tile->state == MAP_TILE_READY) {
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    TileKey key;
+    double distance;
+} MapWanted;
+
+static int compare_wanted(const void* a, const void* b) {
+    double da = ((const MapWanted*)a)->distance;
+    double db = ((const MapWanted*)b)->distance;
+    return (da > db) - (da < db);
+}
+
+static void map_request(MapWidget* map, TileKey key, TilePriority priority, uint32_t now) {
+    MapTile* tile = tile_find(map, key);
+    if (map_needs_load(tile, now)) {
+        tile_loader_request(map->loader, key, priority);
+    }
+}
+
+static void map_request_tiles(MapWidget* map, uint32_t now) {
+    const SDL_Rect* bounds = &map->base.bounds;
+    MapView view;
+    map_compute_view(map, map->center_x, map->center_y, map->zoom, &view);
+
+    // Visible tiles, center-out; coarse stand-ins first where nothing covers
+    MapWanted wanted[MAP_MAX_VISIBLE];
+    int wanted_count = 0;
+    double mid_x = view.left + bounds->w * 0.5;
+    double mid_y = view.top + bounds->h * 0.5;
+    int coarse_level = view.level - MAP_COARSE_LEVELS;
+    if (coarse_level < map->config.min_zoom) {
+        coarse_level = map->config.min_zoom;
+    }
+
+    for (int ty = view.ty0; ty <= view.ty1; ty++) {
+        for (int tx = view.tx0; tx <= view.tx1 && wanted_count < MAP_MAX_VISIBLE; tx++) {
+            TileKey key = { view.level, wrap_tile(tx, view.n), ty };
+            MapTile* tile = tile_find(map, key);
+            if (!map_needs_load(tile, now)) {
+                continue;
+            }
+            if (!tile) {
+                // Placeholder: its arrival does not count as a prefetch hit
+                tile = tile_insert(map, key);
+                if (tile) {
+                    tile->state = MAP_TILE_PENDING;
+                    tile_set_bytes(map, tile, MAP_PLACEHOLDER_BYTES);
+                }
+            }
+            if (tile) {
+                tile->requested_visible = true;
+                tile->last_used = map->frame;
+            }
+            if (coarse_level < view.level && !map_has_coverage(map, key)) {
+                int d = view.level - coarse_level;
+                TileKey coarse = { coarse_level, key.x >> d, key.y >> d };
+                map_request(map, coarse, TILE_PRIORITY_VISIBLE, now);
+            }
+            double dx = (tx + 0.5) * view.tile_px - mid_x;
+            double dy = (ty + 0.5) * view.tile_px - mid_y;
+            wanted[wanted_count].key = key;
+            wanted[wanted_count].distance = dx * dx + dy * dy;
+            wanted_count++;
+        }
+    }
+
+    qsort(wanted, (size_t)wanted_count, sizeof(MapWanted), compare_wanted);
+    for (int i = 0; i < wanted_count; i++) {
+        tile_loader_request(map->loader, wanted[i].key, TILE_PRIORITY_VISIBLE);
+    }
+
+    // Prefetch where the viewport is heading, plus a ring around it
+    double lookahead = map->config.prefetch_ms / 1000.0;
+    double world = map_world_px(map, map->zoom);
+    double ahead_x = map->center_x - map->velocity_x * lookahead / world;
+    double ahead_y = clampd(map->center_y - map->velocity_y * lookahead / world, 0.0, 1.0);
+    double ahead_zoom = map->zooming ? map->target_zoom : map->zoom;
+
+    MapView ahead;
+    map_compute_view(map, ahead_x, ahead_y, ahead_zoom, &ahead);
+
+    /* The prefetch area, cached tiles included, must fit in the memory
+     * cache next to two screens of visible tiles; otherwise prefetched
+     * tiles evict each other and are fetched again forever */
+    size_t tile_bytes = (size_t)map->config.tile_size * (size_t)map->config.tile_size * 4;
+    int visible = (view.tx1 - view.tx0 + 1) * (view.ty1 - view.ty0 + 1);
+    int budget = (int)(map->cache_budget / tile_bytes) - 2 * visible;
+    int prefetch_limit = budget < MAP_MAX_PREFETCH ? budget : MAP_MAX_PREFETCH;
+    int considered = 0;
+    const MapView* views[2] = { &ahead, &view };
+    for (int v = 0; v < 2; v++) {
+        const MapView* pv = views[v];
+        for (int ty = pv->ty0 - 1; ty <= pv->ty1 + 1; ty++) {
+            if (ty < 0 || ty >= pv->n) {
+                continue;
+            }
+            for (int tx = pv->tx0 - 1; tx <= pv->tx1 + 1 && considered < prefetch_limit; tx++) {
+                if (pv->level == view.level && tx >= view.tx0 && tx <= view.tx1 &&
+                    ty >= view.ty0 && ty <= view.ty1) {
+                    continue;  // Visible, requested above
+                }
+                considered++;
+                TileKey key = { pv->level, wrap_tile(tx, pv->n), ty };
+                if (map_needs_load(tile_find(map, key), now)) {
+                    tile_loader_request(map->loader, key, TILE_PRIORITY_PREFETCH);
+                }
+            }
+        }
+    }
+
+    tile_loader_prune(map->loader);
+}
+
+// Whether any of the widget overlaps the screen (the root's bounds)
+static bool map_on_screen(const Widget* widget) {
+    const Widget* root = widget;
+    while (root->parent) {
+        root = root->parent;
+    }
+    SDL_Rect visible;
+    return !(widget->state_flags & WIDGET_STATE_HIDDEN) &&
+           SDL_IntersectRect(&widget->bounds, &root->bounds, &visible);
+}
+
+static void map_widget_update(Widget* widget, double delta_time) {
+    if (!widget) return;
+    MapWidget* map = (MapWidget*)widget;
+    uint32_t now = SDL_GetTicks();
+    double dt = delta_time > 0.1 ? 0.1 : delta_time;
+    bool changed = false;
+
+    if (map->loader) {
+        changed |= map_poll_tiles(map, now);
+    }
+
+    // Holding still mid-drag: nothing to predict
+    if (map->dragging && now - map->velocity_ms > MAP_HOLD_MS) {
+        map->velocity_x = 0.0;
+        map->velocity_y = 0.0;
+    }
+
+    // Fling
+    if (!map->dragging && (map->velocity_x != 0.0 || map->velocity_y != 0.0)) {
+        map_pan(map, map->velocity_x * dt, map->velocity_y * dt);
+        double decay = exp(-MAP_FLING_FRICTION * dt);
+        map->velocity_x *= decay;
+        map->velocity_y *= decay;
+        if (hypot(map->velocity_x, map->velocity_y) < MAP_FLING_STOP) {
+            map->velocity_x = 0.0;
+            map->velocity_y = 0.0;
+        }
+    }
+
+    // Zoom animation
+    if (map->zooming) {
+        double diff = map->target_zoom - map->zoom;
+        double step = diff * (1.0 - exp(-MAP_ZOOM_RATE * dt));
+        if (fabs(diff) < 0.002) {
+            step = diff;
+            map->zooming = false;
+        }
+        map_zoom_around(map, map->zoom + step, map->anchor_x, map->anchor_y);
+    }
+
+    if (map->loader) {
+        if (map_on_screen(widget)) {
+            map_request_tiles(map, now);
+        } else {
+            // Off screen: drop queued fetches; in-flight tiles still land
+            tile_loader_prune(map->loader);
+        }
+    }
+
+    if (changed || map->view_changed) {
+        map->view_changed = false;
+        widget_invalidate(widget);
+    }
+}
+
+// Input
+
+static void map_touch_point(Widget* widget, const SDL_Event* event, float* x, float* y) {
+    // Touch coordinates are normalized to the screen, which the root spans
+    Widget* root = widget;
+    while (root->parent) {
+        root = root->parent;
+    }
+    *x = event->tfinger.x * root->bounds.w;
+    *y = event->tfinger.y * root->bounds.h;
+}
+
+static void map_begin_drag(MapWidget* map, float x, float y, bool mouse) {
+    map->dragging = true;
+    map->mouse_drag = mouse;
+    map->moved = false;
+    map->last_x = x;
+    map->last_y = y;
+    map->press_x = x;
+    map->press_y = y;
+    map->pending_dx = 0.0f;
+    map->pending_dy = 0.0f;
+    map->velocity_ms = SDL_GetTicks();
+    map->velocity_x = 0.0;
+    map->velocity_y = 0.0;
+    map->zooming = false;
+}
+
+static void map_drag_to(MapWidget* map, float x, float y) {
+    float dx = x - map->last_x;
+    float dy = y - map->last_y;
+    map->last_x = x;
+    map->last_y = y;
+    if (fabsf(x - map->press_x) > MAP_TAP_SLOP || fabsf(y - map->press_y) > MAP_TAP_SLOP) {
+        map->moved = true;
+    }
+    map_pan(map, dx, dy);
+
+    // Smooth velocity over a short window; events can share a timestamp
+    map->pending_dx += dx;
+    map->pending_dy += dy;
+    uint32_t now = SDL_GetTicks();
+    uint32_t elapsed = now - map->velocity_ms;
+    if (elapsed >= 4) {
+        double alpha = elapsed / (elapsed + MAP_VELOCITY_WINDOW_MS);
+        map->velocity_x += alpha * (map->pending_dx * 1000.0 / elapsed - map->velocity_x);
+        map->velocity_y += alpha * (map->pending_dy * 1000.0 / elapsed - map->velocity_y);
+        map->pending_dx = 0.0f;
+        map->pending_dy = 0.0f;
+        map->velocity_ms = now;
+    }
+}
+
+static void map_end_drag(MapWidget* map) {
+    map->dragging = false;
+    if (SDL_GetTicks() - map->velocity_ms > MAP_HOLD_MS) {
+        map->velocity_x = 0.0;
+        map->velocity_y = 0.0;
+    }
+}
+
+static float map_pinch_distance(const MapWidget* map) {
+    return hypotf(map->fingers[1].x - map->fingers[0].x, map->fingers[1].y - map->fingers[0].y);
+}
+
+static void map_pinch_midpoint(const MapWidget* map, float* x, float* y) {
+    *x = (map->fingers[0].x + map->fingers[1].x) * 0.5f;
+    *y = (map->fingers[0].y + map->fingers[1].y) * 0.5f;
+}
+
+static void map_handle_touch(MapWidget* map, const SDL_Event* event) {
+    Widget* widget = &map->base;
+    float x, y;
+    map_touch_point(widget, event, &x, &y);
+
+    int index = -1;
+    for (int i = 0; i < map->finger_count; i++) {
+        if (map->fingers[i].id == event->tfinger.fingerId) {
+            index = i;
+        }
+    }
+
+    switch (event->type) {
+        case SDL_FINGERDOWN:
+            if (map->finger_count == 0) {
+                if (!widget_contains_point(widget, (int)x, (int)y)) {
+                    break;
+                }
+                uint32_t now = SDL_GetTicks();
+                if (now - map->last_tap_ms < MAP_DOUBLE_TAP_MS &&
+                    fabsf(x - map->last_tap_x) < MAP_TAP_SLOP * 2 &&
+                    fabsf(y - map->last_tap_y) < MAP_TAP_SLOP * 2) {
+                    map->last_tap_ms = 0;
+                    map_begin_drag(map, x, y, false);
+                    map_zoom_to(map, floor(map->zoom + 0.5) + 1.0, x, y);
+                } else {
+                    map_begin_drag(map, x, y, false);
+                }
+                map->fingers[0] = (MapFinger){ event->tfinger.fingerId, x, y };
+                map->finger_count = 1;
+            } else if (map->finger_count == 1 && index < 0) {
+                map->fingers[1] = (MapFinger){ event->tfinger.fingerId, x, y };
+                map->finger_count = 2;
+                map->pinch_distance = map_pinch_distance(map);
+                map->pinch_zoom = map->zoom;
+                map->zooming = false;
+                map->moved = true;
+                map_pinch_midpoint(map, &map->last_x, &map->last_y);
+            }
+            break;
+
+        case SDL_FINGERMOTION:
+            if (index < 0) {
+                break;
+            }
+            map->fingers[index].x = x;
+            map->fingers[index].y = y;
+            if (map->finger_count == 1) {
+                map_drag_to(map, x, y);
+            } else {
+                float mid_x, mid_y;
+                map_pinch_midpoint(map, &mid_x, &mid_y);
+                map_pan(map, mid_x - map->last_x, mid_y - map->last_y);
+                map->last_x = mid_x;
+                map->last_y = mid_y;
+                float distance = map_pinch_distance(map);
+                if (map->pinch_distance > 1.0f && distance > 1.0f) {
+                    const SDL_Rect* bounds = &widget->bounds;
+                    map_zoom_around(map, map->pinch_zoom + log2(distance / map->pinch_distance),
+                                    mid_x - (bounds->x + bounds->w * 0.5),
+                                    mid_y - (bounds->y + bounds->h * 0.5));
+                }
+                map->velocity_x = 0.0;
+                map->velocity_y = 0.0;
+            }
+            break;
+
+        case SDL_FINGERUP:
+            if (index < 0) {
+                break;
+            }
+            map->fingers[index] = map->fingers[map->finger_count - 1];
+            map->finger_count--;
+            if (map->finger_count == 1) {
+                // Keep panning with the remaining finger
+                map_begin_drag(map, map->fingers[0].x, map->fingers[0].y, false);
+                map->moved = true;
+            } else {
+                map_end_drag(map);
+                if (!map->moved) {
+                    map->last_tap_ms = SDL_GetTicks();
+                    map->last_tap_x = x;
+                    map->last_tap_y = y;
+                }
+            }
+            break;
+    }
+}
+
+static void map_widget_handle_event(Widget* widget, const SDL_Event* event) {
+    if (!widget || !event) return;
+    MapWidget* map = (MapWidget*)widget;
+
+    switch (event->type) {
+        case SDL_MOUSEBUTTONDOWN:
+            // Touch is handled from finger events, not SDL's synthesized mouse
+            if (event->button.which == SDL_TOUCH_MOUSEID || event->button.button != SDL_BUTTON_LEFT ||
+                !widget_contains_point(widget, event->button.x, event->button.y)) {
+                break;
+            }
+            map_begin_drag(map, (float)event->button.x, (float)event->button.y, true);
+            if (event->button.clicks >= 2) {
+                map_zoom_to(map, floor(map->zoom + 0.5) + 1.0,
+                            (float)event->button.x, (float)event->button.y);
+            }
+            break;
+
+        case SDL_MOUSEMOTION:
+            if (event->motion.which != SDL_TOUCH_MOUSEID && map->dragging && map->mouse_drag) {
+                map_drag_to(map, (float)event->motion.x, (float)event->motion.y);
+            }
+            break;
+
+        case SDL_MOUSEBUTTONUP:
+            if (event->button.which != SDL_TOUCH_MOUSEID && map->dragging && map->mouse_drag) {
+                map_end_drag(map);
+            }
+            break;
+
+        case SDL_MOUSEWHEEL:
+            if (event->wheel.y != 0 &&
+                widget_contains_point(widget, event->wheel.mouseX, event->wheel.mouseY)) {
+                double from = map->zooming ? map->target_zoom : map->zoom;
+                map_zoom_to(map, from + event->wheel.y * MAP_WHEEL_STEP,
+                            (float)event->wheel.mouseX, (float)event->wheel.mouseY);
+            }
+            break;
+
+        case SDL_FINGERDOWN:
+        case SDL_FINGERMOTION:
+        case SDL_FINGERUP:
+            if (!map->mouse_drag || !map->dragging) {
+                map_handle_touch(map, event);
+            }
+            break;
+    }
+}
+
+// Rendering
+
+/* Clip a copy to the widget by hand: a clip rect command would replace the
+ * enclosing page's clip for the widgets drawn after this one */
+static int map_copy_clipped(const MapWidget* map, DisplayList* list, SDL_Surface* surface,
+                            const SDL_Rect* src, const SDL_Rect* dst) {
+    SDL_Rect full = { 0, 0, surface->w, surface->h };
+    if (!src) {
+        src = &full;
+    }
+    SDL_Rect visible;
+    if (!SDL_IntersectRect(dst, &map->base.bounds, &visible)) {
+        return 0;
+    }
+    if (visible.w == dst->w && visible.h == dst->h) {
+        return display_list_copy_surface(list, surface, src, dst);
+    }
+
+    double sx = (double)src->w / dst->w;
+    double sy = (double)src->h / dst->h;
+    SDL_Rect part = {
+        src->x + (int)floor((visible.x - dst->x) * sx + 0.5),
+        src->y + (int)floor((visible.y - dst->y) * sy + 0.5),
+        (int)floor(visible.w * sx + 0.5),
+        (int)floor(visible.h * sy + 0.5)
+    };
+    if (part.w < 1) part.w = 1;
+    if (part.h < 1) part.h = 1;
+    return display_list_copy_surface(list, surface, &part, &visible);
+}
+
+static int map_draw_tile(MapWidget* map, DisplayList* list, MapTile* tile,
+                         const SDL_Rect* src, const SDL_Rect* dst, uint32_t now) {
+    tile->last_used = map->frame;
+    tile->resident_frame = map->frame;
+    tile->shown_ms = now;
+    if (!tile->drawn) {
+        tile->drawn = true;
+        if (!tile->requested_visible) {
+            map->stats.prefetch_hits++;
+        }
+    }
+    return map_copy_clipped(map, list, tile->surface, src, dst);
+}
+
+/* Draw stand-ins for a tile that is not ready: the nearest cached ancestor
+ * scaled up, then whichever children are cached scaled down over it */
+static int map_draw_fallback(MapWidget* map, DisplayList* list, TileKey key,
+                             const SDL_Rect* dst, uint32_t now, bool* drew) {
+    *drew = false;
+    for (int d = 1; d <= MAP_FALLBACK_LEVELS && key.z - d >= 0; d++) {
+        TileKey ancestor_key = { key.z - d, key.x >> d, key.y >> d };
+        MapTile* ancestor = tile_find(map, ancestor_key);
+        if (!ancestor || ancestor->state != MAP_TILE_READY) {
+            continue;
+        }
+        int span_w = ancestor->surface->w >> d;
+        int span_h = ancestor->surface->h >> d;
+        if (span_w < 1 || span_h < 1) {
+            break;
+        }
+        int mask = (1 << d) - 1;
+        SDL_Rect src = { (key.x & mask) * span_w, (key.y & mask) * span_h, span_w, span_h };
+        if (map_draw_tile(map, list, ancestor, &src, dst, now) < 0) {
+            return -1;
+        }
+        *drew = true;
+        break;
+    }
+
+    if (key.z >= map->config.max_zoom) {
+        return 0;
+    }
+    int half_w = dst->w / 2;
+    int half_h = dst->h / 2;
+    for (int i = 0; i < 4; i++) {
+        TileKey child_key = { key.z + 1, key.x * 2 + (i & 1), key.y * 2 + (i >> 1) };
+        MapTile* child = tile_find(map, child_key);
+        if (!child || child->state != MAP_TILE_READY) {
+            continue;
+        }
+        SDL_Rect quarter = {
+            dst->x + ((i & 1) ? half_w : 0), dst->y + ((i >> 1) ? half_h : 0),
+            (i & 1) ? dst->w - half_w : half_w, (i >> 1) ? dst->h - half_h : half_h
+        };
+        if (map_draw_tile(map, list, child, NULL, &quarter, now) < 0) {
+            return -1;
+        }
+        *drew = true;
+    }
+    return 0;
+}
+
+static int compare_shown_desc(const void* a, const void* b) {
+    uint32_t sa = (*(MapTile* const*)a)->shown_ms;
+    uint32_t sb = (*(MapTile* const*)b)->shown_ms;
+    return (sa < sb) - (sa > sb);
+}
+
+/* Keep textures of recently shown tiles, and upload a few newly arrived
+ * ones ahead of time, so panning back or onwards needs no upload */
+static int map_keep_textures(MapWidget* map, DisplayList* list, uint32_t now) {
+    int count = 0;
+    int uploads = 0;
+    for (int b = 0; b < MAP_TILE_BUCKETS; b++) {
+        for (MapTile* tile = map->buckets[b]; tile; tile = tile->next) {
+            if (tile->state != MAP_TILE_READY || tile->resident_frame == map->frame) {
+                continue;
+            }
+            bool resident = tile->resident_frame + 1 == map->frame;
+            if (resident && now - tile->shown_ms < MAP_KEEP_MS && count < MAP_MAX_KEEP) {
+                map->keep[count++] = tile;
+            } else if (!resident && !tile->drawn && tile->shown_ms == 0 &&
+                       now - tile->arrived_ms < MAP_KEEP_MS &&
+                       uploads < MAP_UPLOADS_PER_FRAME && count < MAP_MAX_KEEP) {
+                tile->shown_ms = now;
+                map->keep[count++] = tile;
+                uploads++;
+            }
+        }
+    }
+
+    if (count > map->config.gpu_tiles) {
+        qsort(map->keep, (size_t)count, sizeof(MapTile*), compare_shown_desc);
+        count = map->config.gpu_tiles;
+    }
+    for (int i = 0; i < count; i++) {
+        if (display_list_keep_texture(list, map->keep[i]->surface) < 0) {
+            return -1;
+        }
+        map->keep[i]->resident_frame = map->frame;
+    }
+    map->stats.textures_kept = (uint32_t)count;
+    return 0;
+}
+
+static PkError map_widget_render(Widget* widget, DisplayList* list) {
+    PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
+                               "widget is NULL in map_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in map_widget_render");
+    MapWidget* map = (MapWidget*)widget;
+    const SDL_Rect* bounds = &widget->bounds;
+
+    if (bounds->w <= 0 || bounds->h <= 0) {
+        return PK_OK;
+    }
+
+    map->frame++;
+    uint32_t now = SDL_GetTicks();
+    SDL_Color bg = widget->background_color;
+    if (display_list_set_draw_color(list, bg.r, bg.g, bg.b, bg.a) < 0 ||
+        display_list_fill_rect(list, bounds) < 0) {
+        goto record_failed;
+    }
+
+    MapView view;
+    map_compute_view(map, map->center_x, map->center_y, map->zoom, &view);
+    uint32_t drawn = 0;
+    uint32_t fallback = 0;
+
+    for (int ty = view.ty0; ty <= view.ty1; ty++) {
+        for (int tx = view.tx0; tx <= view.tx1; tx++) {
+            TileKey key = { view.level, wrap_tile(tx, view.n), ty };
+            SDL_Rect dst = map_tile_rect(map, &view, tx, ty);
+            MapTile* tile = tile_find(map, key);
+
+            if (tile && tile->state == MAP_TILE_READY) {
+                if (map_draw_tile(map, list, tile, NULL, &dst, now) < 0) {
+                    goto record_failed;
+                }
+                drawn++;
+                continue;
+            }
+
+            if (tile) {
+                tile->last_used = map->frame;
+            }
+
+            bool drew;
+            if (map_draw_fallback(map, list, key, &dst, now, &drew) < 0) {
+                goto record_failed;
+            }
+            if (drew) {
+                drawn++;
+                fallback++;
+            }
+        }
+    }
+
+    if (map_keep_textures(map, list, now) < 0) {
+        goto record_failed;
+    }
+
+    map->stats.tiles_drawn = drawn;
+    map->stats.fallback_tiles = fallback;
+    return PK_OK;
+
+record_failed:
+    pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                   "Failed to record map widget '%s': %s",
+                                   widget->id, SDL_GetError());
+    return PK_ERROR_RENDER_FAILED;
+}
+
+static void map_widget_destroy(Widget* widget) {
+    if (!widget) return;
+    MapWidget* map = (MapWidget*)widget;
+
+    map_widget_stop(widget);
+
+    log_info("Map widget '%s': %u tiles cached (%zu KB), %llu evicted, %llu prefetch hits",
+             widget->id, map->tile_count, map->cache_bytes / 1024,
+             (unsigned long long)map->stats.evictions,
+             (unsigned long long)map->stats.prefetch_hits);
+
+    cache_clear(map);
+
+    // Base cleanup frees the widget itself
+}
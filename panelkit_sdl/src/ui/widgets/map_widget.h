@@ -0,0 +1,154 @@
+/**
+ * @file map_widget.h
+ * @brief Pannable, zoomable slippy-map tile widget
+ *
+ * Tiles come from a TileLoader (local tile directory or HTTP tile server)
+ * and are decoded off the UI thread. Three cache levels keep panning
+ * smooth: compressed tiles on disk (network sources), decoded surfaces in
+ * memory under a byte budget, and GPU textures for the tiles on screen
+ * plus a bounded set of recently shown or prefetched ones.
+ *
+ * Every update the widget asks for the visible tiles center-out, then for
+ * the tiles the viewport will reach within the prefetch lookahead at its
+ * current pan velocity. While a tile loads, its nearest cached ancestor is
+ * drawn scaled up (or its cached children scaled down), so the map is never
+ * blank where anything coarser is known.
+ *
+ * Drag or swipe to pan (with fling), pinch, mouse wheel or double-tap to
+ * zoom. The widget claims drags, so enclosing pages do not swipe or scroll
+ * while the map is being panned.
+ */
+
+#ifndef MAP_WIDGET_H
+#define MAP_WIDGET_H
+
+#include "../widget.h"
+#include "tile_loader.h"
+
+/**
+ * Map widget configuration.
+ */
+typedef struct {
+    const char* source;         /**< Tile path or URL template with {z}/{x}/{y} (required) */
+    const char* cache_dir;      /**< Disk cache for network tiles (NULL = none) */
+    size_t disk_cache_mb;       /**< Disk cache budget */
+    size_t memory_cache_mb;     /**< Decoded tiles kept in memory */
+    int gpu_tiles;              /**< Off-screen tiles whose textures stay resident */
+    int tile_size;              /**< Tile edge in pixels */
+    int min_zoom;
+    int max_zoom;               /**< Deepest tile level requested (display zooms further) */
+    double zoom;                /**< Initial zoom level (fractional) */
+    double center_x;            /**< Initial center, Web Mercator x in [0, 1) */
+    double center_y;            /**< Initial center, Web Mercator y in [0, 1] */
+    int workers;                /**< Tile loader threads */
+    float prefetch_ms;          /**< Velocity lookahead for prefetch (0 = ring only) */
+} MapWidgetConfig;
+
+/**
+ * Map statistics.
+ */
+typedef struct {
+    uint32_t tiles_cached;      /**< Decoded tiles in memory */
+    size_t cache_bytes;         /**< Memory used by decoded tiles */
+    uint32_t tiles_drawn;       /**< Tiles drawn in the last frame */
+    uint32_t fallback_tiles;    /**< Of those, drawn from another zoom level */
+    uint32_t textures_kept;     /**< Off-screen textures kept in the last frame */
+    uint64_t evictions;         /**< Decoded tiles evicted from memory */
+    uint64_t prefetch_hits;     /**< Tiles already cached when first drawn */
+    TileLoaderStats loader;     /**< Loader statistics (zero when stopped) */
+} MapWidgetStats;
+
+/**
+ * Get default map configuration.
+ *
+ * @return 256px tiles, zoom 0-19 starting at 2, 64MB memory cache,
+ *         64 resident off-screen textures, 500ms prefetch lookahead
+ */
+MapWidgetConfig map_widget_default_config(void);
+
+/**
+ * Create a map widget.
+ *
+ * @param id Unique identifier for the widget (required)
+ * @param config Map configuration (required)
+ * @return New map widget or NULL on error (caller owns)
+ * @note Tiles are not loaded until map_widget_start() is called
+ */
+Widget* map_widget_create(const char* id, const MapWidgetConfig* config);
+
+/**
+ * Start the tile loader.
+ *
+ * @param widget Map widget
+ * @return PK_OK on success, error code on failure
+ */
+PkError map_widget_start(Widget* widget);
+
+/**
+ * Stop the tile loader. Cached tiles stay in memory.
+ *
+ * @param widget Map widget
+ */
+void map_widget_stop(Widget* widget);
+
+/**
+ * Center the map on a Web Mercator position.
+ *
+ * @param widget Map widget
+ * @param x Normalized x in [0, 1) (wrapped)
+ * @param y Normalized y in [0, 1] (clamped)
+ */
+void map_widget_set_center(Widget* widget, double x, double y);
+
+/**
+ * Center the map on a geographic position.
+ *
+ * @param widget Map widget
+ * @param lat Latitude in degrees (clamped to +-85.0511)
+ * @param lon Longitude in degrees
+ */
+void map_widget_set_center_latlon(Widget* widget, double lat, double lon);
+
+/**
+ * Set the zoom level around the widget center.
+ *
+ * @param widget Map widget
+ * @param zoom New zoom level (clamped to the configured range)
+ * @param animate Ease towards the new level instead of jumping
+ */
+void map_widget_set_zoom(Widget* widget, double zoom, bool animate);
+
+/**
+ * Get the current (possibly mid-animation) zoom level.
+ *
+ * @param widget Map widget
+ * @return Zoom level, or 0 for an invalid widget
+ */
+double map_widget_get_zoom(Widget* widget);
+
+/**
+ * Get map statistics.
+ *
+ * @param widget Map widget
+ * @param stats Output statistics snapshot
+ */
+void map_widget_get_stats(Widget* widget, MapWidgetStats* stats);
+
+/**
+ * Convert latitude/longitude to normalized Web Mercator coordinates.
+ *
+ * @param lat Latitude in degrees (clamped to +-85.0511)
+ * @param lon Longitude in degrees
+ * @param x Output x in [0, 1)
+ * @param y Output y in [0, 1]
+ */
+void map_latlon_to_world(double lat, double lon, double* x, double* y);
+
+/**
+ * Check which tile formats this build can decode.
+ *
+ * @return true if JPEG tiles are supported (libjpeg-turbo); BMP always is
+ */
+bool map_widget_supports_jpeg(void);
+
+#endif // MAP_WIDGET_H
@@ -20,7 +20,7 @@
 
 // Forward declarations
 static void page_manager_update(Widget* widget, double delta_time);
-static PkError page_manager_render(Widget* widget, SDL_Renderer* renderer);
+static PkError page_manager_render(Widget* widget, DisplayList* list);
 static void page_manager_handle_event(Widget* widget, const SDL_Event* event);
 static void page_manager_destroy(Widget* widget);
 
@@ -81,9 +81,12 @@ Widget* page_manager_widget_create(const char* id, int page_count) {
     // Initialize page management
     manager->page_count = page_count;
     manager->pages = calloc(page_count, sizeof(Widget*));
-    if (!manager->pages) {
+    manager->was_on_screen = calloc(page_count, sizeof(bool));
+    if (!manager->pages || !manager->was_on_screen) {
         pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
                                        "Failed to allocate pages array for page manager");
+        free(manager->pages);
+        free(manager->was_on_screen);
         free(base->subscribed_events);
         free(base->children);
         free(manager);
@@ -253,6 +256,59 @@ void page_manager_set_page_changed_callback(Widget* widget,
     manager->callback_user_data = user_data;
 }
 
+// Position pages from the current transition offset
+static void page_manager_layout_pages(Widget* widget) {
+    PageManagerWidget* manager = (PageManagerWidget*)widget;
+    
+    for (int i = 0; i < manager->page_count; i++) {
+        if (manager->pages[i]) {
+            float page_offset = (i - manager->current_page) + manager->transition_offset;
+            int new_x = widget->bounds.x + (int)(page_offset * widget->bounds.w);
+            int new_y = widget->bounds.y;
+            
+            // Update page position
+            manager->pages[i]->bounds.x = new_x;
+            manager->pages[i]->bounds.y = new_y;
+            
+            // Update all child widget positions recursively
+            widget_update_child_bounds(manager->pages[i]);
+        }
+    }
+}
+
+// Late-latch the newest pointer position into an active drag
+void page_manager_latch_motion(Widget* widget, const SDL_Event* event) {
+    if (!widget || !event || widget->type != WIDGET_TYPE_CONTAINER) return;
+    PageManagerWidget* manager = (PageManagerWidget*)widget;
+    
+    if (!manager->is_dragging || manager->transition_state != PAGE_TRANSITION_DRAGGING) {
+        return;
+    }
+    
+    int x;
+    if (event->type == SDL_MOUSEMOTION) {
+        x = event->motion.x;
+    } else if (event->type == SDL_FINGERMOTION) {
+        x = (int)(event->tfinger.x * widget->bounds.w);
+    } else {
+        return;
+    }
+    
+    page_manager_handle_swipe(widget, (float)(x - manager->drag_start_x), false);
+    page_manager_layout_pages(widget);
+}
+
+// A page is on screen if it is shown and overlaps the manager's viewport
+static bool page_manager_page_on_screen(const PageManagerWidget* manager, int index) {
+    const Widget* page = manager->pages[index];
+    if (!page || (page->state_flags & WIDGET_STATE_HIDDEN)) {
+        return false;
+    }
+    int viewport_left = manager->base.bounds.x;
+    int viewport_right = manager->base.bounds.x + manager->base.bounds.w;
+    return page->bounds.x + page->bounds.w > viewport_left && page->bounds.x < viewport_right;
+}
+
 // Update function
 static void page_manager_update(Widget* widget, double delta_time) {
     PageManagerWidget* manager = (PageManagerWidget*)widget;
@@ -302,28 +358,26 @@ static void page_manager_update(Widget* widget, double delta_time) {
     }
     
     // Update child pages positions based on transition
+    page_manager_layout_pages(widget);
+    
+    // Animate the widgets on the pages being shown; off-screen pages rest.
+    // A page that just left gets one more update so its widgets (the map's
+    // tile fetching) can see they are off screen and pause.
     for (int i = 0; i < manager->page_count; i++) {
-        if (manager->pages[i]) {
-            float page_offset = (i - manager->current_page) + manager->transition_offset;
-            int new_x = widget->bounds.x + (int)(page_offset * widget->bounds.w);
-            int new_y = widget->bounds.y;
-            
-            // Update page position
-            manager->pages[i]->bounds.x = new_x;
-            manager->pages[i]->bounds.y = new_y;
-            
-            // Update all child widget positions recursively
-            widget_update_child_bounds(manager->pages[i]);
+        bool on_screen = page_manager_page_on_screen(manager, i);
+        if (on_screen || manager->was_on_screen[i]) {
+            widget_update(manager->pages[i], delta_time);
         }
+        manager->was_on_screen[i] = on_screen;
     }
 }
 
 // Render function
-static PkError page_manager_render(Widget* widget, SDL_Renderer* renderer) {
+static PkError page_manager_render(Widget* widget, DisplayList* list) {
     PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
                                "widget is NULL in page_manager_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in page_manager_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in page_manager_render");
     PageManagerWidget* manager = (PageManagerWidget*)widget;
     
     log_debug("PAGE MANAGER RENDER: %d pages, current=%d, bounds=(%d,%d,%dx%d)", 
@@ -331,7 +385,7 @@ static PkError page_manager_render(Widget* widget, SDL_Renderer* renderer) {
               widget->bounds.x, widget->bounds.y, widget->bounds.w, widget->bounds.h);
     
     // Set clipping rectangle
-    SDL_RenderSetClipRect(renderer, &widget->bounds);
+    display_list_set_clip_rect(list, &widget->bounds);
     
     // Render visible pages
     for (int i = 0; i < manager->page_count; i++) {
@@ -343,18 +397,14 @@ static PkError page_manager_render(Widget* widget, SDL_Renderer* renderer) {
                       manager->pages[i]->render);
             
             if (!(manager->pages[i]->state_flags & WIDGET_STATE_HIDDEN)) {
-                // Check if page is visible (any part of it is within the viewport)
                 int page_x = manager->pages[i]->bounds.x;
-                int page_right = page_x + manager->pages[i]->bounds.w;
-                int viewport_left = widget->bounds.x;
-                int viewport_right = widget->bounds.x + widget->bounds.w;
                 
-                if (page_right > viewport_left && page_x < viewport_right) {
+                if (page_manager_page_on_screen(manager, i)) {
                     log_debug("    Page %d is visible, calling render", i);
                     if (manager->pages[i]->render) {
-                        PkError err = manager->pages[i]->render(manager->pages[i], renderer);
+                        PkError err = manager->pages[i]->render(manager->pages[i], list);
                         if (err != PK_OK) {
-                            SDL_RenderSetClipRect(renderer, NULL);
+                            display_list_set_clip_rect(list, NULL);
                             return err;
                         }
                     }
@@ -375,7 +425,7 @@ static PkError page_manager_render(Widget* widget, SDL_Renderer* renderer) {
         int start_x = widget->bounds.x + (widget->bounds.w - total_width) / 2;
         int y = widget->bounds.y + widget->bounds.h - 30;
         
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        display_list_set_blend_mode(list, SDL_BLENDMODE_BLEND);
         
         for (int i = 0; i < manager->page_count; i++) {
             int x = start_x + i * indicator_spacing;
@@ -390,23 +440,23 @@ static PkError page_manager_render(Widget* widget, SDL_Renderer* renderer) {
             
             // Draw indicator
             int alpha = (int)(manager->indicator_alpha * (0.3f + 0.7f * highlight));
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, alpha);
+            display_list_set_draw_color(list, 255, 255, 255, alpha);
             
             SDL_Rect indicator = {x, y, indicator_size, indicator_size};
-            if (SDL_RenderFillRect(renderer, &indicator) < 0) {
+            if (display_list_fill_rect(list, &indicator) < 0) {
                 pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
                                                "Failed to draw page indicator: %s",
                                                SDL_GetError());
-                SDL_RenderSetClipRect(renderer, NULL);
+                display_list_set_clip_rect(list, NULL);
                 return PK_ERROR_RENDER_FAILED;
             }
         }
         
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        display_list_set_blend_mode(list, SDL_BLENDMODE_NONE);
     }
     
     // Clear clipping
-    SDL_RenderSetClipRect(renderer, NULL);
+    display_list_set_clip_rect(list, NULL);
     
     return PK_OK;
 }
@@ -416,13 +466,8 @@ static void page_manager_handle_event(Widget* widget, const SDL_Event* event) {
     if (!widget || !event) return;
     PageManagerWidget* manager = (PageManagerWidget*)widget;
     
-    // Track drag state
-    static bool is_dragging = false;
-    static int drag_start_x = 0;
-    static int drag_page_start = 0;
-    
     // Don't handle events if we're not the target of a drag
-    if (!is_dragging && event->type != SDL_MOUSEBUTTONDOWN && event->type != SDL_FINGERDOWN) {
+    if (!manager->is_dragging && event->type != SDL_MOUSEBUTTONDOWN && event->type != SDL_FINGERDOWN) {
         return;
     }
     
@@ -433,12 +478,19 @@ static void page_manager_handle_event(Widget* widget, const SDL_Event* event) {
                     event->button.x : 
                     (int)(event->tfinger.x * widget->bounds.w);
             
-            if (widget_contains_point(widget, x, 
-                (event->type == SDL_MOUSEBUTTONDOWN) ? event->button.y : 
-                (int)(event->tfinger.y * widget->bounds.h))) {
-                is_dragging = true;
-                drag_start_x = x;
-                drag_page_start = manager->current_page;
+            int y = (event->type == SDL_MOUSEBUTTONDOWN) ? 
+                    event->button.y : 
+                    (int)(event->tfinger.y * widget->bounds.h);
+            
+            // Leave drags that start on a panning widget (e.g. a map) to it
+            Widget* hit = widget_hit_test(widget, x, y);
+            if (hit && widget_has_state(hit, WIDGET_STATE_CAPTURES_DRAG)) {
+                break;
+            }
+            
+            if (widget_contains_point(widget, x, y)) {
+                manager->is_dragging = true;
+                manager->drag_start_x = x;
                 manager->drag_offset = 0.0f;
                 manager->transition_state = PAGE_TRANSITION_DRAGGING;
                 
@@ -452,14 +504,14 @@ static void page_manager_handle_event(Widget* widget, const SDL_Event* event) {
         
         case SDL_MOUSEMOTION:
         case SDL_FINGERMOTION: {
-            if (is_dragging) {
+            if (manager->is_dragging) {
                 int x = (event->type == SDL_MOUSEMOTION) ? 
                         event->motion.x : 
                         (int)(event->tfinger.x * widget->bounds.w);
                 
-                float delta_x = (float)(x - drag_start_x);
+                float delta_x = (float)(x - manager->drag_start_x);
                 log_debug("Page manager drag: delta_x=%.1f, start_x=%d, current_x=%d", 
-                         delta_x, drag_start_x, x);
+                         delta_x, manager->drag_start_x, x);
                 page_manager_handle_swipe(widget, delta_x, false);
             }
             break;
@@ -467,14 +519,14 @@ static void page_manager_handle_event(Widget* widget, const SDL_Event* event) {
         
         case SDL_MOUSEBUTTONUP:
         case SDL_FINGERUP: {
-            if (is_dragging) {
+            if (manager->is_dragging) {
                 int x = (event->type == SDL_MOUSEBUTTONUP) ? 
                         event->button.x : 
                         (int)(event->tfinger.x * widget->bounds.w);
                 
-                float delta_x = (float)(x - drag_start_x);
+                float delta_x = (float)(x - manager->drag_start_x);
                 page_manager_handle_swipe(widget, delta_x, true);
-                is_dragging = false;
+                manager->is_dragging = false;
             }
             break;
         }
@@ -489,6 +541,7 @@ static void page_manager_destroy(Widget* widget) {
     if (manager->pages) {
         free(manager->pages);
     }
+    free(manager->was_on_screen);
     
     // Base cleanup happens in widget_destroy
 }
\ No newline at end of file
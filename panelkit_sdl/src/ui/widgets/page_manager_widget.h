@@ -27,12 +27,17 @@ typedef struct PageManagerWidget {
     int target_page;
     int page_count;
     Widget** pages;  // Array of page widgets
+    bool* was_on_screen;  // Per page, as of the previous update
     
     // Transition state
     PageTransitionState transition_state;
     float transition_offset;  // -1.0 to 1.0
     float drag_offset;
     
+    // Drag tracking
+    bool is_dragging;
+    int drag_start_x;
+    
     // Page indicators
     bool show_indicators;
     int indicator_alpha;
@@ -106,6 +111,17 @@ void page_manager_handle_swipe(Widget* widget, float offset, bool is_complete);
  */
 void page_manager_update_drag(Widget* widget, float delta_x);
 
+/**
+ * Apply the newest pointer motion to an in-progress drag.
+ * 
+ * Called just before rendering so the page offset reflects the latest
+ * touch position rather than the one seen at the top of the frame.
+ * 
+ * @param widget Page manager widget
+ * @param event Mouse or finger motion event (ignored if not dragging)
+ */
+void page_manager_latch_motion(Widget* widget, const SDL_Event* event);
+
 /**
  * Set callback for page change notifications.
  * 
@@ -5,9 +5,9 @@
 #include <string.h>
 
 // Forward declarations
-static PkError text_widget_render(Widget* widget, SDL_Renderer* renderer);
+static PkError text_widget_render(Widget* widget, DisplayList* list);
 static void text_widget_destroy(Widget* widget);
-static void text_widget_update_texture(TextWidget* text_widget, SDL_Renderer* renderer);
+static void text_widget_update_surface(TextWidget* text_widget);
 
 Widget* text_widget_create(const char* id, const char* text, TTF_Font* font) {
     if (!id) {
@@ -123,51 +123,47 @@ void text_widget_set_font(Widget* widget, TTF_Font* font) {
     widget->state_flags |= WIDGET_STATE_DIRTY;
 }
 
-static void text_widget_update_texture(TextWidget* text_widget, SDL_Renderer* renderer) {
-    if (!text_widget->needs_update || !text_widget->font || !renderer) return;
+static void text_widget_update_surface(TextWidget* text_widget) {
+    if (!text_widget->needs_update || !text_widget->font) return;
     
-    // Destroy old texture
-    if (text_widget->texture) {
-        SDL_DestroyTexture(text_widget->texture);
-        text_widget->texture = NULL;
+    // Drop old surface (display lists still in flight keep their own reference)
+    if (text_widget->surface) {
+        display_list_release_surface(text_widget->surface);
+        text_widget->surface = NULL;
     }
     
-    // Create surface from text
-    SDL_Surface* surface = TTF_RenderText_Blended(text_widget->font, 
+    // Create surface from text - never modified afterwards
+    text_widget->surface = TTF_RenderText_Blended(text_widget->font, 
                                                   text_widget->text, 
                                                   text_widget->color);
-    if (!surface) return;
+    if (!text_widget->surface) return;
     
-    // Create texture from surface
-    text_widget->texture = SDL_CreateTextureFromSurface(renderer, surface);
-    text_widget->texture_width = surface->w;
-    text_widget->texture_height = surface->h;
-    
-    SDL_FreeSurface(surface);
+    text_widget->surface_width = text_widget->surface->w;
+    text_widget->surface_height = text_widget->surface->h;
     text_widget->needs_update = false;
 }
 
-static PkError text_widget_render(Widget* widget, SDL_Renderer* renderer) {
+static PkError text_widget_render(Widget* widget, DisplayList* list) {
     PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
                                "widget is NULL in text_widget_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in text_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in text_widget_render");
     TextWidget* text_widget = (TextWidget*)widget;
     
-    // Update texture if needed
-    text_widget_update_texture(text_widget, renderer);
+    // Update surface if needed
+    text_widget_update_surface(text_widget);
     
-    if (!text_widget->texture) return PK_OK;  // No text to render
+    if (!text_widget->surface) return PK_OK;  // No text to render
     
     // Calculate destination rectangle based on alignment
     SDL_Rect dest = widget->bounds;
     
     switch (text_widget->alignment) {
         case TEXT_ALIGN_CENTER:
-            dest.x = widget->bounds.x + (widget->bounds.w - text_widget->texture_width) / 2;
+            dest.x = widget->bounds.x + (widget->bounds.w - text_widget->surface_width) / 2;
             break;
         case TEXT_ALIGN_RIGHT:
-            dest.x = widget->bounds.x + widget->bounds.w - text_widget->texture_width;
+            dest.x = widget->bounds.x + widget->bounds.w - text_widget->surface_width;
             break;
         case TEXT_ALIGN_LEFT:
         default:
@@ -175,13 +171,13 @@ static PkError text_widget_render(Widget* widget, SDL_Renderer* renderer) {
             break;
     }
     
-    dest.y = widget->bounds.y + (widget->bounds.h - text_widget->texture_height) / 2;
-    dest.w = text_widget->texture_width;
-    dest.h = text_widget->texture_height;
+    dest.y = widget->bounds.y + (widget->bounds.h - text_widget->surface_height) / 2;
+    dest.w = text_widget->surface_width;
+    dest.h = text_widget->surface_height;
     
-    if (SDL_RenderCopy(renderer, text_widget->texture, NULL, &dest) < 0) {
+    if (display_list_copy_surface(list, text_widget->surface, NULL, &dest) < 0) {
         pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
-                                       "SDL_RenderCopy failed for text widget '%s': %s",
+                                       "Failed to record text widget '%s': %s",
                                        widget->id, SDL_GetError());
         return PK_ERROR_RENDER_FAILED;
     }
@@ -196,7 +192,7 @@ static void text_widget_destroy(Widget* widget) {
     if (text_widget->text) {
         free(text_widget->text);
     }
-    if (text_widget->texture) {
-        SDL_DestroyTexture(text_widget->texture);
+    if (text_widget->surface) {
+        display_list_release_surface(text_widget->surface);
     }
 }
\ No newline at end of file
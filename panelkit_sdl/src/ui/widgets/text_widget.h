@@ -27,10 +27,10 @@ typedef struct TextWidget {
     bool wrap;
     int max_width;
     
-    // Cached texture for performance
-    SDL_Texture* texture;
-    int texture_width;
-    int texture_height;
+    // Cached rendered text (immutable once created, shared with display lists)
+    SDL_Surface* surface;
+    int surface_width;
+    int surface_height;
     bool needs_update;
 } TextWidget;
 
@@ -49,7 +49,7 @@ Widget* text_widget_create(const char* id, const char* text, TTF_Font* font);
  * 
  * @param widget Text widget to update
  * @param text New text to display (copied)
- * @note Invalidates cached texture
+ * @note Invalidates cached text surface
  */
 void text_widget_set_text(Widget* widget, const char* text);
 
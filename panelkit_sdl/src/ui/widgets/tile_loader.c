@@ -0,0 +1,802 @@
+/**
+ * @file tile_loader.c
+ * @brief Asynchronous map tile fetching and decoding
+ */
+
+#define _GNU_SOURCE
+#include "tile_loader.h"
+#include "../../core/error.h"
+#include "../../core/logger.h"
+#include "../../core/realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <curl/curl.h>
+
+#define TILE_LOADER_MAX_WORKERS 8
+#define TILE_MAX_ZOOM 30
+#define TILE_MAX_BYTES (8 * 1024 * 1024)
+#define TILE_PATH_MAX 1024
+
+/* Trim the disk cache to this fraction of its budget so trims are rare */
+#define DISK_TRIM_TARGET 0.9
+
+typedef struct {
+    TileKey key;
+    TilePriority priority;
+    uint64_t sequence;          /* Request order within an epoch */
+    uint32_t epoch;             /* Prune epoch of the latest request */
+} PendingRequest;
+
+typedef struct {
+    TileLoader* loader;
+    int index;
+    CURL* curl;                 /* Reused so keep-alive connections persist */
+} TileWorker;
+
+struct TileLoader {
+    char source[TILE_PATH_MAX];
+    char cache_dir[TILE_PATH_MAX];
+    bool network;
+    uint64_t disk_budget;
+    int max_pending;
+    int timeout_ms;
+    tile_decode_func decode;
+    tile_free_func free_image;
+    void* user_data;
+
+    pthread_t threads[TILE_LOADER_MAX_WORKERS];
+    TileWorker workers[TILE_LOADER_MAX_WORKERS];
+    int worker_count;
+    atomic_bool running;
+
+    // Guarded by mutex
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    PendingRequest* pending;
+    int pending_count;
+    TileKey in_flight[TILE_LOADER_MAX_WORKERS];
+    bool in_flight_used[TILE_LOADER_MAX_WORKERS];
+    TileResult* results;
+    int result_count;
+    int result_capacity;
+    uint64_t sequence;
+    uint32_t epoch;
+    TileLoaderStats stats;
+
+    // Disk cache accounting (guarded by disk_mutex)
+    pthread_mutex_t disk_mutex;
+    uint64_t disk_bytes;
+};
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    bool overflow;
+} TileBuffer;
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+TileLoaderConfig tile_loader_default_config(void) {
+    TileLoaderConfig config = {
+        .disk_cache_mb = 256,
+        .workers = 2,
+        .max_pending = 256,
+        .timeout_ms = 10000
+    };
+    return config;
+}
+
+bool tile_loader_format_source(const char* source, TileKey key, char* out, size_t out_size) {
+    if (!source || !out || out_size == 0) {
+        return false;
+    }
+
+    size_t len = 0;
+    for (const char* p = source; *p; p++) {
+        char number[16];
+        const char* insert = NULL;
+        if (strncmp(p, "{z}", 3) == 0) {
+            snprintf(number, sizeof(number), "%d", key.z);
+            insert = number;
+        } else if (strncmp(p, "{x}", 3) == 0) {
+            snprintf(number, sizeof(number), "%d", key.x);
+            insert = number;
+        } else if (strncmp(p, "{y}", 3) == 0) {
+            snprintf(number, sizeof(number), "%d", key.y);
+            insert = number;
+        }
+
+        if (insert) {
+            size_t n = strlen(insert);
+            if (len + n >= out_size) {
+                return false;
+            }
+            memcpy(out + len, insert, n);
+            len += n;
+            p += 2;
+        } else {
+            if (len + 1 >= out_size) {
+                return false;
+            }
+            out[len++] = *p;
+        }
+    }
+    out[len] = '\0';
+    return true;
+}
+
+static bool key_valid(TileKey key) {
+    if (key.z < 0 || key.z > TILE_MAX_ZOOM) {
+        return false;
+    }
+    long long limit = 1ll << key.z;
+    return key.x >= 0 && key.y >= 0 && key.x < limit && key.y < limit;
+}
+
+static bool key_equal(TileKey a, TileKey b) {
+    return a.z == b.z && a.x == b.x && a.y == b.y;
+}
+
+// Disk cache
+
+/* Create every missing directory leading up to the last '/' in path */
+static void make_parent_dirs(const char* path) {
+    char dir[TILE_PATH_MAX + 1];
+    size_t length = strlen(path);
+    if (length >= sizeof(dir)) {
+        return;
+    }
+    memcpy(dir, path, length + 1);
+    for (char* p = dir + 1; *p; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(dir, 0755);
+            *p = '/';
+        }
+    }
+}
+
+static bool disk_cache_path(const TileLoader* loader, TileKey key, char* out, size_t out_size) {
+    int n = snprintf(out, out_size, "%s/%d/%d/%d.tile", loader->cache_dir, key.z, key.x, key.y);
+    return n > 0 && (size_t)n < out_size;
+}
+
+typedef struct {
+    char* path;
+    struct timespec mtime;
+    uint64_t size;
+} CachedFile;
+
+typedef struct {
+    CachedFile* files;
+    size_t count;
+    size_t capacity;
+    uint64_t total;
+} CacheScan;
+
+static void scan_cache_dir(const char* dir, int depth, CacheScan* scan) {
+    DIR* d = opendir(dir);
+    if (!d) {
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char path[TILE_PATH_MAX];
+        int n = snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (n < 0 || (size_t)n >= sizeof(path)) {
+            continue;
+        }
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+
+        /* Layout is z/x/y.tile; don't wander further than that */
+        if (S_ISDIR(st.st_mode)) {
+            if (depth < 2) {
+                scan_cache_dir(path, depth + 1, scan);
+            }
+            continue;
+        }
+        scan->total += (uint64_t)st.st_size;
+        if (!scan->files) {
+            continue;  // Totals only
+        }
+        if (scan->count == scan->capacity) {
+            size_t capacity = scan->capacity ? scan->capacity * 2 : 1024;
+            CachedFile* files = realloc(scan->files, capacity * sizeof(CachedFile));
+            if (!files) {
+                continue;
+            }
+            scan->files = files;
+            scan->capacity = capacity;
+        }
+        char* copy = strdup(path);
+        if (copy) {
+            scan->files[scan->count++] = (CachedFile){ copy, st.st_mtim, (uint64_t)st.st_size };
+        }
+    }
+    closedir(d);
+}
+
+static int compare_mtime(const void* a, const void* b) {
+    const CachedFile* fa = a;
+    const CachedFile* fb = b;
+    if (fa->mtime.tv_sec != fb->mtime.tv_sec) {
+        return (fa->mtime.tv_sec > fb->mtime.tv_sec) - (fa->mtime.tv_sec < fb->mtime.tv_sec);
+    }
+    return (fa->mtime.tv_nsec > fb->mtime.tv_nsec) - (fa->mtime.tv_nsec < fb->mtime.tv_nsec);
+}
+
+/* Delete least recently used files until the cache fits the trim target */
+static void disk_cache_trim(TileLoader* loader) {
+    CacheScan scan = { 0 };
+    scan.files = malloc(1024 * sizeof(CachedFile));
+    scan.capacity = scan.files ? 1024 : 0;
+    if (!scan.files) {
+        return;
+    }
+    scan_cache_dir(loader->cache_dir, 0, &scan);
+    qsort(scan.files, scan.count, sizeof(CachedFile), compare_mtime);
+
+    uint64_t target = (uint64_t)((double)loader->disk_budget * DISK_TRIM_TARGET);
+    uint64_t total = scan.total;
+    size_t removed = 0;
+    for (size_t i = 0; i < scan.count && total > target; i++) {
+        if (unlink(scan.files[i].path) == 0) {
+            total -= scan.files[i].size;
+            removed++;
+        }
+    }
+    for (size_t i = 0; i < scan.count; i++) {
+        free(scan.files[i].path);
+    }
+    free(scan.files);
+
+    loader->disk_bytes = total;
+    log_debug("Tile disk cache trimmed: %zu files removed, %llu KB kept",
+              removed, (unsigned long long)(total / 1024));
+}
+
+static void disk_cache_store(TileLoader* loader, TileKey key, const TileBuffer* buffer) {
+    char path[TILE_PATH_MAX];
+    char tmp[TILE_PATH_MAX + 16];
+    if (!loader->cache_dir[0] || !disk_cache_path(loader, key, path, sizeof(path))) {
+        return;
+    }
+
+    /* Write then rename so a crash never leaves a truncated tile behind */
+    snprintf(tmp, sizeof(tmp), "%s.%lu", path, (unsigned long)pthread_self());
+    make_parent_dirs(path);
+    FILE* file = fopen(tmp, "wb");
+    if (!file) {
+        return;
+    }
+    bool ok = fwrite(buffer->data, 1, buffer->size, file) == buffer->size;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return;
+    }
+
+    pthread_mutex_lock(&loader->disk_mutex);
+    loader->disk_bytes += buffer->size;
+    if (loader->disk_budget > 0 && loader->disk_bytes > loader->disk_budget) {
+        disk_cache_trim(loader);
+    }
+    pthread_mutex_unlock(&loader->disk_mutex);
+}
+
+// Fetching
+
+/* Read a whole file; sets *missing when it does not exist */
+static bool read_file(const char* path, TileBuffer* buffer, bool* missing) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        *missing = errno == ENOENT || errno == ENOTDIR;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fileno(file), &st) != 0 || st.st_size <= 0 || st.st_size > TILE_MAX_BYTES) {
+        fclose(file);
+        return false;
+    }
+    buffer->data = malloc((size_t)st.st_size);
+    if (!buffer->data) {
+        fclose(file);
+        return false;
+    }
+    buffer->size = fread(buffer->data, 1, (size_t)st.st_size, file);
+    fclose(file);
+    return buffer->size == (size_t)st.st_size;
+}
+
+static size_t tile_write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    TileBuffer* buffer = userp;
+    size_t bytes = size * nmemb;
+
+    if (buffer->size + bytes > TILE_MAX_BYTES) {
+        buffer->overflow = true;
+        return 0;
+    }
+    if (buffer->size + bytes > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 32 * 1024;
+        while (capacity < buffer->size + bytes) {
+            capacity *= 2;
+        }
+        uint8_t* data = realloc(buffer->data, capacity);
+        if (!data) {
+            return 0;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, contents, bytes);
+    buffer->size += bytes;
+    return bytes;
+}
+
+static int tile_progress_callback(void* clientp, curl_off_t dltotal, curl_off_t dlnow,
+                                  curl_off_t ultotal, curl_off_t ulnow) {
+    (void)dltotal;
+    (void)dlnow;
+    (void)ultotal;
+    (void)ulnow;
+    TileLoader* loader = clientp;
+    return atomic_load(&loader->running) ? 0 : 1;
+}
+
+static TileStatus fetch_network(TileWorker* worker, const char* url, TileBuffer* buffer) {
+    TileLoader* loader = worker->loader;
+    if (!worker->curl) {
+        worker->curl = curl_easy_init();
+        if (!worker->curl) {
+            return TILE_STATUS_ERROR;
+        }
+    }
+
+    CURL* curl = worker->curl;
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, tile_write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, buffer);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, tile_progress_callback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, loader);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)loader->timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (long)loader->timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "PanelKit/1.0");
+
+    CURLcode res = curl_easy_perform(curl);
+    long http_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+    if (res != CURLE_OK) {
+        if (atomic_load(&loader->running)) {
+            log_debug("Tile fetch %s failed: %s%s", url, curl_easy_strerror(res),
+                      buffer->overflow ? " (tile too large)" : "");
+        }
+        return TILE_STATUS_ERROR;
+    }
+    if (http_code == 404 || http_code == 410 || http_code == 204) {
+        return TILE_STATUS_MISSING;
+    }
+    if (http_code != 200 || buffer->size == 0) {
+        log_debug("Tile fetch %s: HTTP %ld", url, http_code);
+        return TILE_STATUS_ERROR;
+    }
+    return TILE_STATUS_OK;
+}
+
+/* Fetch and decode one tile; fills everything in result but the key */
+static void load_tile(TileWorker* worker, TileKey key, TileResult* result) {
+    TileLoader* loader = worker->loader;
+    TileBuffer buffer = { 0 };
+    uint64_t start = monotonic_us();
+    bool network_fetch = false;
+
+    result->status = TILE_STATUS_ERROR;
+    result->image = NULL;
+    result->from_disk_cache = false;
+
+    char location[TILE_PATH_MAX];
+    if (!tile_loader_format_source(loader->source, key, location, sizeof(location))) {
+        return;
+    }
+
+    if (!loader->network) {
+        const char* path = strncmp(location, "file://", 7) == 0 ? location + 7 : location;
+        bool missing = false;
+        if (!read_file(path, &buffer, &missing)) {
+            result->status = missing ? TILE_STATUS_MISSING : TILE_STATUS_ERROR;
+            free(buffer.data);
+            return;
+        }
+    } else {
+        char cached[TILE_PATH_MAX];
+        bool missing = false;
+        if (loader->cache_dir[0] && disk_cache_path(loader, key, cached, sizeof(cached)) &&
+            read_file(cached, &buffer, &missing)) {
+            /* Mark as recently used for the trim order */
+            utimensat(AT_FDCWD, cached, NULL, 0);
+            result->from_disk_cache = true;
+        } else {
+            free(buffer.data);
+            buffer = (TileBuffer){ 0 };
+            TileStatus status = fetch_network(worker, location, &buffer);
+            if (status != TILE_STATUS_OK) {
+                result->status = status;
+                free(buffer.data);
+                return;
+            }
+            network_fetch = true;
+        }
+    }
+
+    void* image = loader->decode(buffer.data, buffer.size, loader->user_data);
+    if (image) {
+        result->status = TILE_STATUS_OK;
+        result->image = image;
+        if (network_fetch) {
+            disk_cache_store(loader, key, &buffer);
+        }
+    } else {
+        log_debug("Tile %d/%d/%d: could not decode %zu bytes", key.z, key.x, key.y, buffer.size);
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+    loader->stats.bytes_read += buffer.size;
+    if (result->from_disk_cache) {
+        loader->stats.disk_hits++;
+    } else if (network_fetch) {
+        loader->stats.network_fetches++;
+    }
+    pthread_mutex_unlock(&loader->mutex);
+
+    free(buffer.data);
+    uint64_t elapsed = monotonic_us() - start;
+    result->load_us = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+}
+
+// Queue
+
+/* Lower is more urgent: priority, then the latest epoch, then request order */
+static bool request_before(const PendingRequest* a, const PendingRequest* b) {
+    if (a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+    if (a->epoch != b->epoch) {
+        return a->epoch > b->epoch;
+    }
+    return a->sequence < b->sequence;
+}
+
+static bool push_result(TileLoader* loader, const TileResult* result) {
+    if (loader->result_count == loader->result_capacity) {
+        int capacity = loader->result_capacity ? loader->result_capacity * 2 : 64;
+        TileResult* results = realloc(loader->results, (size_t)capacity * sizeof(TileResult));
+        if (!results) {
+            return false;
+        }
+        loader->results = results;
+        loader->result_capacity = capacity;
+    }
+    loader->results[loader->result_count++] = *result;
+    return true;
+}
+
+static void* tile_worker_main(void* arg) {
+    TileWorker* worker = arg;
+    TileLoader* loader = worker->loader;
+
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+
+    pthread_mutex_lock(&loader->mutex);
+    while (atomic_load(&loader->running)) {
+        if (loader->pending_count == 0) {
+            pthread_cond_wait(&loader->cond, &loader->mutex);
+            continue;
+        }
+
+        int best = 0;
+        for (int i = 1; i < loader->pending_count; i++) {
+            if (request_before(&loader->pending[i], &loader->pending[best])) {
+                best = i;
+            }
+        }
+        TileKey key = loader->pending[best].key;
+        loader->pending[best] = loader->pending[--loader->pending_count];
+        loader->in_flight[worker->index] = key;
+        loader->in_flight_used[worker->index] = true;
+        pthread_mutex_unlock(&loader->mutex);
+
+        TileResult result = { .key = key };
+        load_tile(worker, key, &result);
+
+        pthread_mutex_lock(&loader->mutex);
+        loader->in_flight_used[worker->index] = false;
+        switch (result.status) {
+            case TILE_STATUS_OK:      loader->stats.loaded++; break;
+            case TILE_STATUS_MISSING: loader->stats.missing++; break;
+            case TILE_STATUS_ERROR:   loader->stats.errors++; break;
+        }
+        if (!push_result(loader, &result) && result.image) {
+            loader->free_image(result.image, loader->user_data);
+        }
+    }
+    pthread_mutex_unlock(&loader->mutex);
+
+    if (worker->curl) {
+        curl_easy_cleanup(worker->curl);
+        worker->curl = NULL;
+    }
+    return NULL;
+}
+
+TileLoader* tile_loader_create(const TileLoaderConfig* config) {
+    PK_CHECK_NULL_WITH_CONTEXT(config != NULL, PK_ERROR_NULL_PARAM,
+                               "tile_loader_create: config is NULL");
+    PK_CHECK_NULL_WITH_CONTEXT(config->source != NULL && config->source[0] != '\0',
+                               PK_ERROR_INVALID_PARAM, "tile_loader_create: source is empty");
+    PK_CHECK_NULL_WITH_CONTEXT(config->decode != NULL && config->free_image != NULL,
+                               PK_ERROR_NULL_PARAM,
+                               "tile_loader_create: decode and free_image are required");
+
+    if (strlen(config->source) >= TILE_PATH_MAX ||
+        (config->cache_dir && strlen(config->cache_dir) >= TILE_PATH_MAX - 64)) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_PARAM,
+            "tile_loader_create: source or cache_dir path too long");
+        return NULL;
+    }
+
+    TileLoader* loader = calloc(1, sizeof(TileLoader));
+    if (!loader) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "tile_loader_create: Failed to allocate %zu bytes", sizeof(TileLoader));
+        return NULL;
+    }
+
+    snprintf(loader->source, sizeof(loader->source), "%s", config->source);
+    loader->network = strncmp(config->source, "http://", 7) == 0 ||
+                      strncmp(config->source, "https://", 8) == 0;
+    if (loader->network && config->cache_dir && config->cache_dir[0]) {
+        snprintf(loader->cache_dir, sizeof(loader->cache_dir), "%s", config->cache_dir);
+        size_t len = strlen(loader->cache_dir);
+        while (len > 1 && loader->cache_dir[len - 1] == '/') {
+            loader->cache_dir[--len] = '\0';
+        }
+    }
+    loader->disk_budget = (uint64_t)config->disk_cache_mb * 1024 * 1024;
+    loader->max_pending = config->max_pending > 0 ? config->max_pending : 256;
+    loader->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 10000;
+    loader->decode = config->decode;
+    loader->free_image = config->free_image;
+    loader->user_data = config->user_data;
+
+    loader->pending = calloc((size_t)loader->max_pending, sizeof(PendingRequest));
+    if (!loader->pending) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "tile_loader_create: Failed to allocate %d pending requests", loader->max_pending);
+        free(loader);
+        return NULL;
+    }
+
+    pthread_mutex_init(&loader->mutex, NULL);
+    pthread_cond_init(&loader->cond, NULL);
+    pthread_mutex_init(&loader->disk_mutex, NULL);
+
+    if (loader->cache_dir[0]) {
+        char probe[TILE_PATH_MAX + 1];
+        snprintf(probe, sizeof(probe), "%s/", loader->cache_dir);
+        make_parent_dirs(probe);
+        CacheScan scan = { 0 };
+        scan_cache_dir(loader->cache_dir, 0, &scan);
+        loader->disk_bytes = scan.total;
+    }
+
+    int workers = config->workers;
+    if (workers < 1) {
+        workers = 1;
+    } else if (workers > TILE_LOADER_MAX_WORKERS) {
+        workers = TILE_LOADER_MAX_WORKERS;
+    }
+
+    atomic_init(&loader->running, true);
+    for (int i = 0; i < workers; i++) {
+        loader->workers[i] = (TileWorker){ .loader = loader, .index = i };
+        int rc = pthread_create(&loader->threads[i], NULL, tile_worker_main, &loader->workers[i]);
+        if (rc != 0) {
+            log_error("Failed to start tile worker %d: %s", i, strerror(rc));
+            if (i == 0) {
+                pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+                    "tile_loader_create: pthread_create failed: %s", strerror(rc));
+                atomic_store(&loader->running, false);
+                tile_loader_destroy(loader);
+                return NULL;
+            }
+            break;
+        }
+        loader->worker_count++;
+    }
+
+    log_info("Tile loader: %s, %d workers%s%s (%llu KB cached)", loader->source,
+             loader->worker_count, loader->cache_dir[0] ? ", disk cache " : "",
+             loader->cache_dir, (unsigned long long)(loader->disk_bytes / 1024));
+    return loader;
+}
+
+void tile_loader_destroy(TileLoader* loader) {
+    if (!loader) {
+        return;
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+    atomic_store(&loader->running, false);
+    pthread_cond_broadcast(&loader->cond);
+    pthread_mutex_unlock(&loader->mutex);
+
+    for (int i = 0; i < loader->worker_count; i++) {
+        pthread_join(loader->threads[i], NULL);
+    }
+
+    for (int i = 0; i < loader->result_count; i++) {
+        if (loader->results[i].image) {
+            loader->free_image(loader->results[i].image, loader->user_data);
+        }
+    }
+
+    log_info("Tile loader: %llu loaded (%llu from disk, %llu downloaded), %llu missing, "
+             "%llu errors, %llu pruned",
+             (unsigned long long)loader->stats.loaded,
+             (unsigned long long)loader->stats.disk_hits,
+             (unsigned long long)loader->stats.network_fetches,
+             (unsigned long long)loader->stats.missing,
+             (unsigned long long)loader->stats.errors,
+             (unsigned long long)loader->stats.pruned);
+
+    pthread_cond_destroy(&loader->cond);
+    pthread_mutex_destroy(&loader->mutex);
+    pthread_mutex_destroy(&loader->disk_mutex);
+    free(loader->results);
+    free(loader->pending);
+    free(loader);
+}
+
+bool tile_loader_request(TileLoader* loader, TileKey key, TilePriority priority) {
+    if (!loader || !key_valid(key) || priority < 0 || priority >= TILE_PRIORITY_COUNT) {
+        return false;
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+
+    for (int i = 0; i < loader->worker_count; i++) {
+        if (loader->in_flight_used[i] && key_equal(loader->in_flight[i], key)) {
+            pthread_mutex_unlock(&loader->mutex);
+            return true;
+        }
+    }
+    for (int i = 0; i < loader->result_count; i++) {
+        if (key_equal(loader->results[i].key, key)) {
+            pthread_mutex_unlock(&loader->mutex);
+            return true;  // Done, waiting to be polled
+        }
+    }
+
+    PendingRequest request = {
+        .key = key,
+        .priority = priority,
+        .sequence = ++loader->sequence,
+        .epoch = loader->epoch
+    };
+
+    for (int i = 0; i < loader->pending_count; i++) {
+        PendingRequest* existing = &loader->pending[i];
+        if (key_equal(existing->key, key)) {
+            if (existing->priority < request.priority) {
+                request.priority = existing->priority;
+            }
+            *existing = request;
+            pthread_mutex_unlock(&loader->mutex);
+            return true;
+        }
+    }
+
+    if (loader->pending_count == loader->max_pending) {
+        /* Full: replace the least urgent request if this one beats it */
+        int worst = 0;
+        for (int i = 1; i < loader->pending_count; i++) {
+            if (request_before(&loader->pending[worst], &loader->pending[i])) {
+                worst = i;
+            }
+        }
+        if (!request_before(&request, &loader->pending[worst])) {
+            pthread_mutex_unlock(&loader->mutex);
+            return false;
+        }
+        loader->pending[worst] = request;
+        loader->stats.pruned++;
+    } else {
+        loader->pending[loader->pending_count++] = request;
+    }
+    loader->stats.requested++;
+
+    pthread_cond_signal(&loader->cond);
+    pthread_mutex_unlock(&loader->mutex);
+    return true;
+}
+
+int tile_loader_prune(TileLoader* loader) {
+    if (!loader) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+    int dropped = 0;
+    for (int i = loader->pending_count - 1; i >= 0; i--) {
+        if (loader->pending[i].epoch != loader->epoch) {
+            loader->pending[i] = loader->pending[--loader->pending_count];
+            dropped++;
+        }
+    }
+    loader->epoch++;
+    loader->stats.pruned += (uint64_t)dropped;
+    pthread_mutex_unlock(&loader->mutex);
+    return dropped;
+}
+
+int tile_loader_poll(TileLoader* loader, TileResult* results, int max_results) {
+    if (!loader || !results || max_results <= 0) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+    int count = loader->result_count < max_results ? loader->result_count : max_results;
+    if (count == 0) {
+        pthread_mutex_unlock(&loader->mutex);
+        return 0;
+    }
+    memcpy(results, loader->results, (size_t)count * sizeof(TileResult));
+    memmove(loader->results, loader->results + count,
+            (size_t)(loader->result_count - count) * sizeof(TileResult));
+    loader->result_count -= count;
+    pthread_mutex_unlock(&loader->mutex);
+    return count;
+}
+
+void tile_loader_get_stats(TileLoader* loader, TileLoaderStats* stats) {
+    if (!loader || !stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&loader->mutex);
+    *stats = loader->stats;
+    stats->pending = (uint32_t)loader->pending_count;
+    stats->in_flight = 0;
+    for (int i = 0; i < loader->worker_count; i++) {
+        if (loader->in_flight_used[i]) {
+            stats->in_flight++;
+        }
+    }
+    pthread_mutex_unlock(&loader->mutex);
+}
@@ -0,0 +1,188 @@
+/**
+ * @file tile_loader.h
+ * @brief Asynchronous map tile fetching and decoding
+ *
+ * Worker threads load tiles from a local tile directory or an HTTP tile
+ * server and decode them with a caller-supplied function, so neither I/O
+ * nor image decoding happens on the UI thread. Network tiles are kept
+ * compressed in an on-disk cache directory that is trimmed to a size
+ * budget, oldest first.
+ *
+ * Requests carry a priority (visible tiles before prefetch) and are
+ * re-issued by the caller whenever its viewport changes; tile_loader_prune()
+ * then drops queued requests that were not asked for again, so a fast pan
+ * never leaves the workers busy with tiles that scrolled away.
+ *
+ * Sources are templates with {z}, {x} and {y} placeholders:
+ * - "/srv/tiles/{z}/{x}/{y}.jpg" or "file:///srv/tiles/{z}/{x}/{y}.jpg"
+ * - "https://tiles.example.com/{z}/{x}/{y}.png"
+ */
+
+#ifndef TILE_LOADER_H
+#define TILE_LOADER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Opaque tile loader handle */
+typedef struct TileLoader TileLoader;
+
+/** Tile address in the slippy-map scheme (y grows southwards) */
+typedef struct {
+    int z;
+    int x;
+    int y;
+} TileKey;
+
+/** Request priority, most urgent first */
+typedef enum {
+    TILE_PRIORITY_VISIBLE,      /**< On screen now (or a fallback for one) */
+    TILE_PRIORITY_PREFETCH,     /**< Expected on screen soon */
+    TILE_PRIORITY_COUNT
+} TilePriority;
+
+/** Outcome of one request */
+typedef enum {
+    TILE_STATUS_OK,             /**< Decoded image attached */
+    TILE_STATUS_MISSING,        /**< No such tile (file absent, HTTP 404) */
+    TILE_STATUS_ERROR           /**< Fetch or decode failed; may be retried */
+} TileStatus;
+
+/**
+ * Decode compressed tile bytes into an image. Called on a worker thread.
+ *
+ * @return Image handed to the caller through tile_loader_poll(), or NULL
+ */
+typedef void* (*tile_decode_func)(const uint8_t* data, size_t size, void* user_data);
+
+/** Free an image returned by the decoder (results dropped at shutdown) */
+typedef void (*tile_free_func)(void* image, void* user_data);
+
+/**
+ * Tile loader configuration.
+ */
+typedef struct {
+    const char* source;         /**< Tile path or URL template (required) */
+    const char* cache_dir;      /**< Disk cache for network tiles (NULL = none) */
+    size_t disk_cache_mb;       /**< Disk cache budget (0 = unlimited) */
+    int workers;                /**< Loader threads (1-8) */
+    int max_pending;            /**< Queued requests kept; lowest priority dropped beyond */
+    int timeout_ms;             /**< Network fetch timeout */
+    tile_decode_func decode;    /**< Decoder (required) */
+    tile_free_func free_image;  /**< Image destructor (required) */
+    void* user_data;            /**< Passed to decode and free_image */
+} TileLoaderConfig;
+
+/**
+ * One finished request.
+ */
+typedef struct {
+    TileKey key;
+    TileStatus status;
+    void* image;                /**< Decoded image, owned by the caller (OK only) */
+    bool from_disk_cache;       /**< Network tile served from the disk cache */
+    uint32_t load_us;           /**< Fetch plus decode time */
+} TileResult;
+
+/**
+ * Loader statistics.
+ */
+typedef struct {
+    uint64_t requested;         /**< Requests queued (duplicates excluded) */
+    uint64_t pruned;            /**< Queued requests dropped as stale or over max_pending */
+    uint64_t loaded;            /**< Tiles decoded */
+    uint64_t missing;           /**< Tiles that do not exist */
+    uint64_t errors;            /**< Fetch or decode failures */
+    uint64_t disk_hits;         /**< Network tiles served from the disk cache */
+    uint64_t network_fetches;   /**< Tiles downloaded */
+    uint64_t bytes_read;        /**< Compressed bytes read or downloaded */
+    uint32_t pending;           /**< Requests waiting for a worker */
+    uint32_t in_flight;         /**< Requests being loaded */
+} TileLoaderStats;
+
+/**
+ * Get default loader configuration.
+ *
+ * @return 2 workers, 256 pending requests, 10s timeout, 256MB disk cache
+ */
+TileLoaderConfig tile_loader_default_config(void);
+
+/**
+ * Create a tile loader and start its workers.
+ *
+ * @param config Loader configuration (required)
+ * @return New loader or NULL on error (caller owns)
+ * @note Creates cache_dir if it does not exist
+ */
+TileLoader* tile_loader_create(const TileLoaderConfig* config);
+
+/**
+ * Stop the workers and destroy the loader.
+ *
+ * @param loader Loader to destroy (can be NULL)
+ * @note In-flight network transfers abort; undelivered images are freed
+ */
+void tile_loader_destroy(TileLoader* loader);
+
+/**
+ * Ask for a tile.
+ *
+ * Duplicates of a queued request refresh it (and raise its priority if
+ * needed); requests for a tile that is being loaded or waiting to be polled
+ * are ignored. Within a priority, tiles are loaded in the order they were
+ * requested since the last prune, so request the center of the viewport
+ * first.
+ *
+ * @param loader Tile loader (required)
+ * @param key Tile to load
+ * @param priority Request priority
+ * @return true if queued or already queued/in flight, false if invalid or
+ *         the queue is full of more urgent requests
+ */
+bool tile_loader_request(TileLoader* loader, TileKey key, TilePriority priority);
+
+/**
+ * Drop queued requests that were not requested again since the previous
+ * prune. Call once after re-issuing the wanted tiles for a viewport.
+ *
+ * @param loader Tile loader (required)
+ * @return Number of requests dropped
+ */
+int tile_loader_prune(TileLoader* loader);
+
+/**
+ * Collect finished requests without blocking.
+ *
+ * @param loader Tile loader (required)
+ * @param results Output array (required)
+ * @param max_results Capacity of results
+ * @return Number of results written
+ */
+int tile_loader_poll(TileLoader* loader, TileResult* results, int max_results);
+
+/**
+ * Get loader statistics.
+ *
+ * @param loader Tile loader (required)
+ * @param stats Output statistics (required)
+ */
+void tile_loader_get_stats(TileLoader* loader, TileLoaderStats* stats);
+
+/**
+ * Expand a source template for one tile.
+ *
+ * @param source Template with {z}, {x} and {y}
+ * @param key Tile address
+ * @param out Output buffer
+ * @param out_size Size of out
+ * @return true on success, false if the result does not fit
+ */
+bool tile_loader_format_source(const char* source, TileKey key, char* out, size_t out_size);
+
+/**
+ * @note Thread Safety: request, prune, poll and get_stats may be called
+ *       from any thread, but results are meant for one consumer.
+ */
+
+#endif // TILE_LOADER_H
@@ -7,7 +7,7 @@
 
 // Forward declarations
 static void time_widget_update(Widget* widget, double delta_time);
-static PkError time_widget_render(Widget* widget, SDL_Renderer* renderer);
+static PkError time_widget_render(Widget* widget, DisplayList* list);
 static void time_widget_destroy(Widget* widget);
 
 Widget* time_widget_create(const char* id, const char* format, TTF_Font* font) {
@@ -122,11 +122,11 @@ static void time_widget_update(Widget* widget, double delta_time) {
     }
 }
 
-static PkError time_widget_render(Widget* widget, SDL_Renderer* renderer) {
+static PkError time_widget_render(Widget* widget, DisplayList* list) {
     PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
                                "widget is NULL in time_widget_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in time_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in time_widget_render");
     TimeWidget* time_widget = (TimeWidget*)widget;
     
     // Position text widget
@@ -137,7 +137,7 @@ static PkError time_widget_render(Widget* widget, SDL_Renderer* renderer) {
     // Render children (text widget)
     for (size_t i = 0; i < widget->child_count; i++) {
         if (widget->children[i] && widget->children[i]->render) {
-            PkError err = widget->children[i]->render(widget->children[i], renderer);
+            PkError err = widget->children[i]->render(widget->children[i], list);
             if (err != PK_OK) {
                 return err;
             }
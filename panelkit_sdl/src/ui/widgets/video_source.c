@@ -0,0 +1,481 @@
+/**
+ * @file video_source.c
+ * @brief MJPEG-over-HTTP and V4L2 frame capture
+ */
+
+#include "video_source.h"
+#include "core/logger.h"
+#include <curl/curl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+#endif
+
+#define VIDEO_URI_MAX 256
+#define VIDEO_RECONNECT_MS 1000
+#define VIDEO_POLL_MS 100
+#define MJPEG_BUFFER_INITIAL (256 * 1024)
+#define MJPEG_BUFFER_MAX (8 * 1024 * 1024)
+#define V4L2_BUFFER_COUNT 4
+
+typedef enum {
+    VIDEO_SOURCE_HTTP,
+    VIDEO_SOURCE_V4L2
+} VideoSourceType;
+
+struct VideoSource {
+    VideoSourceType type;
+    char uri[VIDEO_URI_MAX];        /* URL or device path */
+    int width;
+    int height;
+    bool accept_jpeg;
+
+    /* MJPEG stream parser state (HTTP) */
+    uint8_t* buffer;
+    size_t buffer_size;
+    size_t buffer_capacity;
+    uint32_t skipped;
+
+    /* Per-run callback state */
+    video_packet_callback callback;
+    void* user_data;
+    const atomic_bool* running;
+};
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+/* Sleep in short steps so a stop request is honored promptly */
+static void interruptible_sleep(const atomic_bool* running, int ms) {
+    while (ms > 0 && atomic_load(running)) {
+        int step = ms < VIDEO_POLL_MS ? ms : VIDEO_POLL_MS;
+        sleep_ms(step);
+        ms -= step;
+    }
+}
+
+// Lifecycle
+
+VideoSource* video_source_create(const char* uri, int width, int height, bool accept_jpeg) {
+    PK_CHECK_NULL_WITH_CONTEXT(uri != NULL && uri[0] != '\0', PK_ERROR_INVALID_PARAM,
+                               "video_source_create: uri is empty");
+
+    VideoSource* source = calloc(1, sizeof(VideoSource));
+    if (!source) {
+        log_error("Failed to allocate video source");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "video_source_create: Failed to allocate %zu bytes", sizeof(VideoSource));
+        return NULL;
+    }
+
+    if (strncmp(uri, "v4l2:", 5) == 0) {
+        source->type = VIDEO_SOURCE_V4L2;
+        uri += 5;
+    } else if (strncmp(uri, "/dev/", 5) == 0) {
+        source->type = VIDEO_SOURCE_V4L2;
+    } else {
+        source->type = VIDEO_SOURCE_HTTP;
+    }
+
+    strncpy(source->uri, uri, sizeof(source->uri) - 1);
+    source->width = width;
+    source->height = height;
+    source->accept_jpeg = accept_jpeg;
+
+    if (source->type == VIDEO_SOURCE_HTTP && !accept_jpeg) {
+        log_error("MJPEG source %s needs JPEG decoding (built without libjpeg-turbo)", uri);
+        pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+            "video_source_create: MJPEG source '%s' requires libjpeg-turbo", uri);
+        free(source);
+        return NULL;
+    }
+
+    return source;
+}
+
+void video_source_destroy(VideoSource* source) {
+    if (!source) {
+        return;
+    }
+
+    free(source->buffer);
+    free(source);
+}
+
+// MJPEG over HTTP
+
+static const uint8_t* find_marker(const uint8_t* data, size_t size, uint8_t marker) {
+    for (size_t i = 0; i + 1 < size; i++) {
+        if (data[i] == 0xFF && data[i + 1] == marker) {
+            return data + i;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Split the byte stream on JPEG SOI/EOI markers. This works for
+ * multipart/x-mixed-replace regardless of boundary or part headers, and
+ * for a plain file of concatenated JPEGs. Marker bytes cannot occur inside
+ * entropy-coded data (0xFF is stuffed), so the scan is unambiguous for
+ * camera streams.
+ */
+static void mjpeg_deliver_complete(VideoSource* source) {
+    const uint8_t* data = source->buffer;
+    size_t size = source->buffer_size;
+    const uint8_t* latest = NULL;
+    size_t latest_size = 0;
+    size_t consumed = 0;
+    uint32_t complete = 0;
+
+    for (;;) {
+        const uint8_t* soi = find_marker(data + consumed, size - consumed, 0xD8);
+        if (!soi) {
+            /* Keep a trailing 0xFF in case the marker is split */
+            consumed = size > 0 && data[size - 1] == 0xFF ? size - 1 : size;
+            break;
+        }
+
+        size_t start = (size_t)(soi - data);
+        const uint8_t* eoi = find_marker(soi + 2, size - start - 2, 0xD9);
+        if (!eoi) {
+            consumed = start;
+            break;
+        }
+
+        latest = soi;
+        latest_size = (size_t)(eoi - soi) + 2;
+        consumed = start + latest_size;
+        complete++;
+    }
+
+    if (latest) {
+        /* Older complete frames in this chunk are late: skip them undecoded */
+        source->skipped += complete - 1;
+        VideoPacket packet = {
+            .format = VIDEO_PACKET_JPEG,
+            .data = latest,
+            .size = latest_size,
+            .skipped = source->skipped
+        };
+        source->callback(&packet, source->user_data);
+        source->skipped = 0;
+    }
+
+    if (consumed > 0) {
+        memmove(source->buffer, source->buffer + consumed, size - consumed);
+        source->buffer_size = size - consumed;
+    }
+}
+
+static size_t mjpeg_write_callback(void* contents, size_t size, size_t nmemb, void* user_data) {
+    VideoSource* source = user_data;
+    size_t realsize = size * nmemb;
+
+    if (source->buffer_size + realsize > source->buffer_capacity) {
+        size_t new_capacity = source->buffer_capacity ? source->buffer_capacity : MJPEG_BUFFER_INITIAL;
+        while (new_capacity < source->buffer_size + realsize) {
+            new_capacity *= 2;
+        }
+        if (new_capacity > MJPEG_BUFFER_MAX) {
+            /* No frame boundary in 8MB: not an MJPEG stream, or corrupt */
+            log_warn("MJPEG stream %s: no frame found in %d bytes, resyncing",
+                     source->uri, MJPEG_BUFFER_MAX);
+            source->buffer_size = 0;
+            new_capacity = source->buffer_capacity;
+            if (realsize > new_capacity) {
+                return 0;
+            }
+        } else {
+            uint8_t* buffer = realloc(source->buffer, new_capacity);
+            if (!buffer) {
+                log_error("Failed to grow MJPEG buffer to %zu bytes", new_capacity);
+                return 0;
+            }
+            source->buffer = buffer;
+            source->buffer_capacity = new_capacity;
+        }
+    }
+
+    memcpy(source->buffer + source->buffer_size, contents, realsize);
+    source->buffer_size += realsize;
+
+    mjpeg_deliver_complete(source);
+    return realsize;
+}
+
+static int mjpeg_progress_callback(void* user_data, curl_off_t dltotal, curl_off_t dlnow,
+                                   curl_off_t ultotal, curl_off_t ulnow) {
+    (void)dltotal; (void)dlnow; (void)ultotal; (void)ulnow;
+    VideoSource* source = user_data;
+    return atomic_load(source->running) ? 0 : 1;   /* Non-zero aborts the transfer */
+}
+
+static PkError http_run(VideoSource* source) {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        pk_set_last_error_with_context(PK_ERROR_NETWORK,
+            "video_source_run: curl_easy_init failed for '%s'", source->uri);
+        return PK_ERROR_NETWORK;
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, source->uri);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, mjpeg_write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, source);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, mjpeg_progress_callback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, source);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    /* A stalled camera looks like a slow transfer; reconnect after 10s */
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 10L);
+
+    while (atomic_load(source->running)) {
+        source->buffer_size = 0;
+        source->skipped = 0;
+
+        log_info("Connecting to MJPEG stream %s", source->uri);
+        CURLcode res = curl_easy_perform(curl);
+        if (!atomic_load(source->running)) {
+            break;
+        }
+
+        if (res == CURLE_OK) {
+            log_info("MJPEG stream %s ended, reconnecting", source->uri);
+        } else {
+            log_warn("MJPEG stream %s failed: %s, reconnecting in %dms",
+                     source->uri, curl_easy_strerror(res), VIDEO_RECONNECT_MS);
+        }
+        interruptible_sleep(source->running, VIDEO_RECONNECT_MS);
+    }
+
+    curl_easy_cleanup(curl);
+    return PK_OK;
+}
+
+// V4L2 capture
+
+#ifdef __linux__
+
+typedef struct {
+    void* start;
+    size_t length;
+} V4l2Buffer;
+
+static int xioctl(int fd, unsigned long request, void* arg) {
+    int rc;
+    do {
+        rc = ioctl(fd, request, arg);
+    } while (rc == -1 && errno == EINTR);
+    return rc;
+}
+
+/* Ask for MJPEG when we can decode it (far less USB bandwidth), else YUYV */
+static bool v4l2_set_format(VideoSource* source, int fd, struct v4l2_format* fmt) {
+    uint32_t candidates[2];
+    int count = 0;
+    if (source->accept_jpeg) {
+        candidates[count++] = V4L2_PIX_FMT_MJPEG;
+    }
+    candidates[count++] = V4L2_PIX_FMT_YUYV;
+
+    for (int i = 0; i < count; i++) {
+        memset(fmt, 0, sizeof(*fmt));
+        fmt->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt->fmt.pix.width = (uint32_t)source->width;
+        fmt->fmt.pix.height = (uint32_t)source->height;
+        fmt->fmt.pix.pixelformat = candidates[i];
+        fmt->fmt.pix.field = V4L2_FIELD_ANY;
+
+        if (xioctl(fd, VIDIOC_S_FMT, fmt) == 0 && fmt->fmt.pix.pixelformat == candidates[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static PkError v4l2_run(VideoSource* source) {
+    int fd = open(source->uri, O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        log_error("Failed to open video device %s: %s", source->uri, strerror(errno));
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+            "video_source_run: cannot open '%s': %s", source->uri, strerror(errno));
+        return PK_ERROR_NOT_FOUND;
+    }
+
+    PkError result = PK_OK;
+    V4l2Buffer buffers[V4L2_BUFFER_COUNT];
+    unsigned int buffer_count = 0;
+    bool streaming = false;
+
+    struct v4l2_format fmt;
+    if (!v4l2_set_format(source, fd, &fmt)) {
+        pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+            "video_source_run: %s supports neither MJPEG nor YUYV capture", source->uri);
+        result = PK_ERROR_INVALID_CONFIG;
+        goto cleanup;
+    }
+
+    VideoPacketFormat format = fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_MJPEG ?
+                               VIDEO_PACKET_JPEG : VIDEO_PACKET_YUYV;
+    log_info("Capturing %s at %ux%u (%s)", source->uri, fmt.fmt.pix.width,
+             fmt.fmt.pix.height, format == VIDEO_PACKET_JPEG ? "MJPEG" : "YUYV");
+
+    struct v4l2_requestbuffers req = {
+        .count = V4L2_BUFFER_COUNT,
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .memory = V4L2_MEMORY_MMAP
+    };
+    if (xioctl(fd, VIDIOC_REQBUFS, &req) < 0 || req.count == 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "video_source_run: VIDIOC_REQBUFS failed on %s: %s", source->uri, strerror(errno));
+        result = PK_ERROR_SYSTEM;
+        goto cleanup;
+    }
+
+    for (unsigned int i = 0; i < req.count && i < V4L2_BUFFER_COUNT; i++) {
+        struct v4l2_buffer buf = {
+            .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+            .memory = V4L2_MEMORY_MMAP,
+            .index = i
+        };
+        if (xioctl(fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            break;
+        }
+        buffers[i].length = buf.length;
+        buffers[i].start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                fd, buf.m.offset);
+        if (buffers[i].start == MAP_FAILED) {
+            break;
+        }
+        buffer_count++;
+        xioctl(fd, VIDIOC_QBUF, &buf);
+    }
+
+    if (buffer_count == 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "video_source_run: failed to map capture buffers on %s", source->uri);
+        result = PK_ERROR_SYSTEM;
+        goto cleanup;
+    }
+
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_STREAMON, &type) < 0) {
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "video_source_run: VIDIOC_STREAMON failed on %s: %s", source->uri, strerror(errno));
+        result = PK_ERROR_SYSTEM;
+        goto cleanup;
+    }
+    streaming = true;
+
+    while (atomic_load(source->running)) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, VIDEO_POLL_MS);
+        if (ready <= 0) {
+            continue;
+        }
+
+        /* Drain the queue, keeping only the newest filled buffer */
+        struct v4l2_buffer newest;
+        bool have_newest = false;
+        uint32_t skipped = 0;
+        for (;;) {
+            struct v4l2_buffer buf = {
+                .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+                .memory = V4L2_MEMORY_MMAP
+            };
+            if (xioctl(fd, VIDIOC_DQBUF, &buf) < 0) {
+                break;
+            }
+            if (have_newest) {
+                xioctl(fd, VIDIOC_QBUF, &newest);
+                skipped++;
+            }
+            newest = buf;
+            have_newest = true;
+        }
+
+        if (!have_newest) {
+            continue;
+        }
+
+        VideoPacket packet = {
+            .format = format,
+            .data = buffers[newest.index].start,
+            .size = newest.bytesused,
+            .width = (int)fmt.fmt.pix.width,
+            .height = (int)fmt.fmt.pix.height,
+            .stride = (int)fmt.fmt.pix.bytesperline,
+            .skipped = skipped
+        };
+        source->callback(&packet, source->user_data);
+        xioctl(fd, VIDIOC_QBUF, &newest);
+    }
+
+cleanup:
+    if (streaming) {
+        xioctl(fd, VIDIOC_STREAMOFF, &type);
+    }
+    for (unsigned int i = 0; i < buffer_count; i++) {
+        munmap(buffers[i].start, buffers[i].length);
+    }
+    close(fd);
+    return result;
+}
+
+#else
+
+static PkError v4l2_run(VideoSource* source) {
+    pk_set_last_error_with_context(PK_ERROR_INVALID_CONFIG,
+        "video_source_run: V4L2 capture is only available on Linux ('%s')", source->uri);
+    return PK_ERROR_INVALID_CONFIG;
+}
+
+#endif
+
+// Capture loop
+
+PkError video_source_run(VideoSource* source, video_packet_callback callback,
+                         void* user_data, const atomic_bool* running) {
+    PK_CHECK_ERROR_WITH_CONTEXT(source != NULL && callback != NULL && running != NULL,
+                               PK_ERROR_NULL_PARAM,
+                               "video_source_run: source=%p, callback=%p, running=%p",
+                               (void*)source, (void*)callback, (void*)running);
+
+    source->callback = callback;
+    source->user_data = user_data;
+    source->running = running;
+
+    if (source->type == VIDEO_SOURCE_HTTP) {
+        return http_run(source);
+    }
+
+    /* Devices can be unplugged; retry opening until stopped */
+    while (atomic_load(running)) {
+        PkError err = v4l2_run(source);
+        if (err == PK_OK || !atomic_load(running)) {
+            break;
+        }
+        if (err == PK_ERROR_INVALID_CONFIG) {
+            return err;
+        }
+        log_warn("Video capture on %s failed: %s, retrying in %dms",
+                 source->uri, pk_get_last_error_context(), VIDEO_RECONNECT_MS);
+        interruptible_sleep(running, VIDEO_RECONNECT_MS);
+    }
+    return PK_OK;
+}
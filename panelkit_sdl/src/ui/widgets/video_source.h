@@ -0,0 +1,82 @@
+/**
+ * @file video_source.h
+ * @brief Camera frame capture for the video widget
+ *
+ * Delivers compressed or raw frames from either an MJPEG stream over
+ * HTTP (multipart/x-mixed-replace, or any URL libcurl can read) or a
+ * V4L2 capture device. Capture runs on the caller's thread; when several
+ * frames are available at once only the newest is delivered, so a slow
+ * consumer skips frames instead of falling behind.
+ */
+
+#ifndef VIDEO_SOURCE_H
+#define VIDEO_SOURCE_H
+
+#include "../../core/error.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Opaque video source handle */
+typedef struct VideoSource VideoSource;
+
+/** Frame encodings a source can deliver */
+typedef enum {
+    VIDEO_PACKET_JPEG,          /**< Complete JPEG image (size from bitstream) */
+    VIDEO_PACKET_YUYV           /**< Packed YUV 4:2:2 (V4L2_PIX_FMT_YUYV) */
+} VideoPacketFormat;
+
+/**
+ * One captured frame. Data is only valid during the callback.
+ */
+typedef struct {
+    VideoPacketFormat format;
+    const uint8_t* data;
+    size_t size;
+    int width;                  /**< Raw formats only (0 for JPEG) */
+    int height;                 /**< Raw formats only (0 for JPEG) */
+    int stride;                 /**< Bytes per row for raw formats */
+    uint32_t skipped;           /**< Older frames discarded since the last packet */
+} VideoPacket;
+
+/** Called on the capture thread for each delivered frame */
+typedef void (*video_packet_callback)(const VideoPacket* packet, void* user_data);
+
+/**
+ * Create a video source.
+ *
+ * @param uri "http://...", "https://..." or "file://..." for MJPEG,
+ *            "/dev/videoN" or "v4l2:/dev/videoN" for a capture device
+ * @param width Requested capture width (V4L2 only, drivers may adjust)
+ * @param height Requested capture height (V4L2 only)
+ * @param accept_jpeg True if the consumer can decode JPEG packets
+ * @return New source or NULL on error (caller owns)
+ */
+VideoSource* video_source_create(const char* uri, int width, int height, bool accept_jpeg);
+
+/**
+ * Destroy a video source.
+ *
+ * @param source Source to destroy (can be NULL, must not be running)
+ */
+void video_source_destroy(VideoSource* source);
+
+/**
+ * Capture frames until `running` becomes false.
+ *
+ * @param source Video source (required)
+ * @param callback Frame callback (required)
+ * @param user_data Passed to callback
+ * @param running Stop flag polled at least every 100ms (required)
+ * @return PK_OK when stopped, error code if the source cannot be opened
+ * @note HTTP streams reconnect after errors or end of stream
+ */
+PkError video_source_run(VideoSource* source, video_packet_callback callback,
+                         void* user_data, const atomic_bool* running);
+
+/**
+ * @note Thread Safety: A source must be run by one thread at a time.
+ */
+
+#endif // VIDEO_SOURCE_H
@@ -0,0 +1,540 @@
+#include "video_widget.h"
+#include "video_source.h"
+#include "../core/error.h"
+#include "../core/logger.h"
+#include "../core/realtime.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+// Frames owned by the worker; one is decoded into while others are in flight
+// (latest, current, and up to three display lists)
+#define VIDEO_FRAME_POOL_SIZE 6
+
+typedef struct {
+    Widget base;  // Must be first member for casting
+
+    char source_uri[256];
+    int capture_width;
+    int capture_height;
+
+    // Worker thread
+    VideoSource* source;
+    pthread_t thread;
+    bool thread_started;
+    atomic_bool running;
+
+    // Worker-only state
+    YuvFrame* pool[VIDEO_FRAME_POOL_SIZE];
+    uint64_t sequence;
+#ifdef HAVE_TURBOJPEG
+    tjhandle decoder;
+    uint8_t* scratch;             // Non-4:2:0 JPEGs decode here first
+    size_t scratch_size;
+#endif
+
+    // Handoff to the UI thread (guarded by mutex)
+    pthread_mutex_t mutex;
+    YuvFrame* latest;             // Newest decoded frame not yet shown
+    VideoWidgetStats stats;
+
+    // UI thread only
+    YuvFrame* current;            // Frame being displayed
+} VideoWidget;
+
+// Forward declarations for virtual functions
+static void video_widget_update(Widget* widget, double delta_time);
+static PkError video_widget_render(Widget* widget, DisplayList* list);
+static void video_widget_destroy(Widget* widget);
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+bool video_widget_supports_jpeg(void) {
+#ifdef HAVE_TURBOJPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+Widget* video_widget_create(const char* id, const char* source,
+                            int capture_width, int capture_height) {
+    if (!id || !source) {
+        pk_set_last_error_with_context(PK_ERROR_NULL_PARAM,
+            "video_widget_create: id=%p, source=%p", (void*)id, (void*)source);
+        return NULL;
+    }
+
+    VideoWidget* video = calloc(1, sizeof(VideoWidget));
+    if (!video) {
+        log_error("Failed to allocate video widget");
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "video_widget_create: Failed to allocate %zu bytes", sizeof(VideoWidget));
+        return NULL;
+    }
+
+    // Initialize base widget
+    Widget* base = &video->base;
+    strncpy(base->id, id, sizeof(base->id) - 1);
+    base->type = WIDGET_TYPE_CUSTOM;
+    base->state_flags = WIDGET_STATE_NORMAL;
+    base->background_color = (SDL_Color){0, 0, 0, 255};
+
+    // Set virtual functions
+    base->update = video_widget_update;
+    base->render = video_widget_render;
+    base->destroy = video_widget_destroy;
+
+    // No children or subscriptions
+    base->child_capacity = 1;
+    base->children = calloc(1, sizeof(Widget*));
+    if (!base->children) {
+        pk_set_last_error_with_context(PK_ERROR_OUT_OF_MEMORY,
+            "video_widget_create: Failed to allocate children array");
+        free(video);
+        return NULL;
+    }
+
+    strncpy(video->source_uri, source, sizeof(video->source_uri) - 1);
+    video->capture_width = capture_width > 0 ? capture_width : 640;
+    video->capture_height = capture_height > 0 ? capture_height : 480;
+    atomic_init(&video->running, false);
+    pthread_mutex_init(&video->mutex, NULL);
+
+    base->bounds.w = 320;
+    base->bounds.h = 240;
+
+    log_info("Created video widget '%s' for %s", id, source);
+    return base;
+}
+
+// Worker: frame pool
+
+// Get a frame the worker may write to, or NULL if all are still in flight
+static YuvFrame* video_acquire_frame(VideoWidget* video, int width, int height) {
+    width = (width + 1) & ~1;
+    height = (height + 1) & ~1;
+
+    int free_slot = -1;
+    for (int i = 0; i < VIDEO_FRAME_POOL_SIZE; i++) {
+        YuvFrame* frame = video->pool[i];
+        if (!frame) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (yuv_frame_is_exclusive(frame)) {
+            if (frame->width == width && frame->height == height) {
+                return frame;
+            }
+            // Resolution changed; recycle the slot
+            yuv_frame_release(frame);
+            video->pool[i] = NULL;
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+        }
+    }
+
+    if (free_slot < 0) {
+        return NULL;
+    }
+
+    video->pool[free_slot] = yuv_frame_create(width, height);
+    return video->pool[free_slot];
+}
+
+// Hand a decoded frame to the UI thread, replacing any frame not yet shown
+static void video_publish_frame(VideoWidget* video, YuvFrame* frame, uint32_t decode_us) {
+    frame->sequence = ++video->sequence;
+    yuv_frame_retain(frame);
+
+    pthread_mutex_lock(&video->mutex);
+    if (video->latest) {
+        video->stats.frames_dropped++;
+        yuv_frame_release(video->latest);
+    }
+    video->latest = frame;
+    video->stats.frames_decoded++;
+    video->stats.last_decode_us = decode_us;
+    video->stats.width = frame->width;
+    video->stats.height = frame->height;
+    pthread_mutex_unlock(&video->mutex);
+}
+
+// Worker: decoders
+
+// Packed YUYV 4:2:2 to planar 4:2:0, averaging chroma over row pairs
+static bool video_decode_yuyv(VideoWidget* video, const VideoPacket* packet, YuvFrame** out) {
+    int width = packet->width;
+    int height = packet->height;
+    if (width <= 0 || height <= 0 || packet->stride < width * 2 ||
+        packet->size < (size_t)packet->stride * (size_t)height) {
+        return false;
+    }
+
+    YuvFrame* frame = video_acquire_frame(video, width, height);
+    *out = frame;
+    if (!frame) {
+        return true;  // Pool exhausted: drop, not an error
+    }
+
+    for (int y = 0; y < height; y += 2) {
+        const uint8_t* row0 = packet->data + (size_t)y * (size_t)packet->stride;
+        const uint8_t* row1 = y + 1 < height ? row0 + packet->stride : row0;
+        uint8_t* y0 = frame->planes[0] + (size_t)y * (size_t)frame->pitches[0];
+        uint8_t* y1 = y0 + frame->pitches[0];
+        uint8_t* u = frame->planes[1] + (size_t)(y / 2) * (size_t)frame->pitches[1];
+        uint8_t* v = frame->planes[2] + (size_t)(y / 2) * (size_t)frame->pitches[2];
+
+        for (int x = 0; x + 1 < width; x += 2) {
+            const uint8_t* p0 = row0 + x * 2;
+            const uint8_t* p1 = row1 + x * 2;
+            y0[x] = p0[0];
+            y0[x + 1] = p0[2];
+            y1[x] = p1[0];
+            y1[x + 1] = p1[2];
+            u[x / 2] = (uint8_t)((p0[1] + p1[1] + 1) / 2);
+            v[x / 2] = (uint8_t)((p0[3] + p1[3] + 1) / 2);
+        }
+    }
+
+    return true;
+}
+
+#ifdef HAVE_TURBOJPEG
+// JPEG to planar 4:2:0; 4:2:0 streams decode straight into the frame
+static bool video_decode_jpeg(VideoWidget* video, const VideoPacket* packet, YuvFrame** out) {
+    int width, height, subsamp, colorspace;
+    *out = NULL;
+
+    if (tjDecompressHeader3(video->decoder, packet->data, (unsigned long)packet->size,
+                            &width, &height, &subsamp, &colorspace) < 0) {
+        log_debug("JPEG header error: %s", tjGetErrorStr2(video->decoder));
+        return false;
+    }
+
+    YuvFrame* frame = video_acquire_frame(video, width, height);
+    *out = frame;
+    if (!frame) {
+        return true;  // Pool exhausted: drop, not an error
+    }
+
+    if (subsamp == TJSAMP_420 && frame->width == width && frame->height == height) {
+        if (tjDecompressToYUVPlanes(video->decoder, packet->data, (unsigned long)packet->size,
+                                    frame->planes, width, frame->pitches, height,
+                                    TJFLAG_FASTDCT) < 0) {
+            log_debug("JPEG decode error: %s", tjGetErrorStr2(video->decoder));
+            return false;
+        }
+        return true;
+    }
+
+    // Other subsampling (typically 4:2:2 from USB webcams): decode natively,
+    // then resample chroma onto the 4:2:0 grid
+    int components = subsamp == TJSAMP_GRAY ? 1 : 3;
+    int plane_w[3] = {0}, plane_h[3] = {0};
+    size_t plane_size[3] = {0};
+    size_t total = 0;
+    for (int c = 0; c < components; c++) {
+        plane_w[c] = tjPlaneWidth(c, width, subsamp);
+        plane_h[c] = tjPlaneHeight(c, height, subsamp);
+        if (plane_w[c] <= 0 || plane_h[c] <= 0) {
+            return false;
+        }
+        plane_size[c] = (size_t)plane_w[c] * (size_t)plane_h[c];
+        total += plane_size[c];
+    }
+
+    if (total > video->scratch_size) {
+        uint8_t* scratch = realloc(video->scratch, total);
+        if (!scratch) {
+            log_error("Failed to allocate %zu byte JPEG scratch buffer", total);
+            return false;
+        }
+        video->scratch = scratch;
+        video->scratch_size = total;
+    }
+
+    unsigned char* planes[3] = { video->scratch, NULL, NULL };
+    if (components == 3) {
+        planes[1] = planes[0] + plane_size[0];
+        planes[2] = planes[1] + plane_size[1];
+    }
+    if (tjDecompressToYUVPlanes(video->decoder, packet->data, (unsigned long)packet->size,
+                                planes, width, plane_w, height, TJFLAG_FASTDCT) < 0) {
+        log_debug("JPEG decode error: %s", tjGetErrorStr2(video->decoder));
+        return false;
+    }
+
+    for (int y = 0; y < height; y++) {
+        memcpy(frame->planes[0] + (size_t)y * (size_t)frame->pitches[0],
+               planes[0] + (size_t)y * (size_t)plane_w[0], (size_t)width);
+    }
+
+    int chroma_w = frame->width / 2;
+    int chroma_h = frame->height / 2;
+    for (int c = 1; c < 3; c++) {
+        for (int y = 0; y < chroma_h; y++) {
+            uint8_t* dst = frame->planes[c] + (size_t)y * (size_t)frame->pitches[c];
+            if (components == 1) {
+                memset(dst, 128, (size_t)chroma_w);
+                continue;
+            }
+            const uint8_t* src = planes[c] + (size_t)(y * plane_h[c] / chroma_h) * (size_t)plane_w[c];
+            for (int x = 0; x < chroma_w; x++) {
+                dst[x] = src[x * plane_w[c] / chroma_w];
+            }
+        }
+    }
+
+    return true;
+}
+#endif
+
+// Worker: capture callback and thread
+
+static void video_on_packet(const VideoPacket* packet, void* user_data) {
+    VideoWidget* video = user_data;
+
+    pthread_mutex_lock(&video->mutex);
+    video->stats.frames_received += 1 + packet->skipped;
+    video->stats.frames_dropped += packet->skipped;
+    pthread_mutex_unlock(&video->mutex);
+
+    uint64_t start = monotonic_us();
+    YuvFrame* frame = NULL;
+    bool ok = false;
+
+    switch (packet->format) {
+        case VIDEO_PACKET_YUYV:
+            ok = video_decode_yuyv(video, packet, &frame);
+            break;
+        case VIDEO_PACKET_JPEG:
+#ifdef HAVE_TURBOJPEG
+            ok = video_decode_jpeg(video, packet, &frame);
+#endif
+            break;
+    }
+
+    if (!ok) {
+        pthread_mutex_lock(&video->mutex);
+        video->stats.decode_errors++;
+        pthread_mutex_unlock(&video->mutex);
+        return;
+    }
+
+    if (!frame) {
+        // Every pooled frame is still queued for display: this one is late
+        pthread_mutex_lock(&video->mutex);
+        video->stats.frames_dropped++;
+        pthread_mutex_unlock(&video->mutex);
+        return;
+    }
+
+    video_publish_frame(video, frame, (uint32_t)(monotonic_us() - start));
+}
+
+static void* video_worker_main(void* arg) {
+    VideoWidget* video = arg;
+
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+    log_info("Video worker for '%s' started", video->base.id);
+
+#ifdef HAVE_TURBOJPEG
+    video->decoder = tjInitDecompress();
+    if (!video->decoder) {
+        log_error("Failed to initialize JPEG decoder for '%s'", video->base.id);
+        return NULL;
+    }
+#endif
+
+    if (video_source_run(video->source, video_on_packet, video, &video->running) != PK_OK) {
+        log_error("Video source %s stopped: %s", video->source_uri, pk_get_last_error_context());
+    }
+
+#ifdef HAVE_TURBOJPEG
+    tjDestroy(video->decoder);
+    video->decoder = NULL;
+    free(video->scratch);
+    video->scratch = NULL;
+    video->scratch_size = 0;
+#endif
+
+    log_info("Video worker for '%s' stopped", video->base.id);
+    return NULL;
+}
+
+PkError video_widget_start(Widget* widget) {
+    PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
+                               "widget is NULL in video_widget_start");
+    VideoWidget* video = (VideoWidget*)widget;
+
+    if (video->thread_started) {
+        return PK_OK;
+    }
+
+    video->source = video_source_create(video->source_uri, video->capture_width,
+                                        video->capture_height, video_widget_supports_jpeg());
+    if (!video->source) {
+        // Error context set by video_source_create
+        return pk_get_last_error();
+    }
+
+    atomic_store(&video->running, true);
+    int rc = pthread_create(&video->thread, NULL, video_worker_main, video);
+    if (rc != 0) {
+        log_error("Failed to create video worker for '%s': %s", widget->id, strerror(rc));
+        pk_set_last_error_with_context(PK_ERROR_SYSTEM,
+            "video_widget_start: pthread_create failed: %s", strerror(rc));
+        atomic_store(&video->running, false);
+        video_source_destroy(video->source);
+        video->source = NULL;
+        return PK_ERROR_SYSTEM;
+    }
+
+    video->thread_started = true;
+    return PK_OK;
+}
+
+void video_widget_stop(Widget* widget) {
+    VideoWidget* video = (VideoWidget*)widget;
+    if (!video || !video->thread_started) {
+        return;
+    }
+
+    atomic_store(&video->running, false);
+    pthread_join(video->thread, NULL);
+    video->thread_started = false;
+
+    video_source_destroy(video->source);
+    video->source = NULL;
+}
+
+void video_widget_get_stats(Widget* widget, VideoWidgetStats* stats) {
+    VideoWidget* video = (VideoWidget*)widget;
+    if (!video || !stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&video->mutex);
+    *stats = video->stats;
+    pthread_mutex_unlock(&video->mutex);
+}
+
+// UI thread
+
+// Largest rectangle with the frame's aspect ratio centered in bounds
+static SDL_Rect video_fit_rect(const SDL_Rect* bounds, int frame_w, int frame_h) {
+    SDL_Rect dst = *bounds;
+    if ((int64_t)bounds->w * frame_h > (int64_t)bounds->h * frame_w) {
+        dst.w = (int)((int64_t)bounds->h * frame_w / frame_h);
+        dst.x += (bounds->w - dst.w) / 2;
+    } else {
+        dst.h = (int)((int64_t)bounds->w * frame_h / frame_w);
+        dst.y += (bounds->h - dst.h) / 2;
+    }
+    return dst;
+}
+
+// Mark the widget dirty when the worker has published a frame not yet shown.
+// Only this widget's rect changes, so parents are not invalidated; the flag
+// is cleared by widget_render once the frame has been drawn.
+static void video_widget_update(Widget* widget, double delta_time) {
+    (void)delta_time;
+    if (!widget) return;
+    VideoWidget* video = (VideoWidget*)widget;
+
+    pthread_mutex_lock(&video->mutex);
+    bool pending = video->latest != NULL;
+    pthread_mutex_unlock(&video->mutex);
+
+    if (pending) {
+        widget_set_state(widget, WIDGET_STATE_DIRTY, true);
+    }
+}
+
+static PkError video_widget_render(Widget* widget, DisplayList* list) {
+    PK_CHECK_ERROR_WITH_CONTEXT(widget != NULL, PK_ERROR_NULL_PARAM,
+                               "widget is NULL in video_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in video_widget_render");
+    VideoWidget* video = (VideoWidget*)widget;
+
+    // Latch the newest decoded frame
+    pthread_mutex_lock(&video->mutex);
+    if (video->latest) {
+        yuv_frame_release(video->current);
+        video->current = video->latest;
+        video->latest = NULL;
+        video->stats.frames_shown++;
+    }
+    pthread_mutex_unlock(&video->mutex);
+
+    SDL_Rect dst = widget->bounds;
+    if (video->current) {
+        dst = video_fit_rect(&widget->bounds, video->current->width, video->current->height);
+    }
+
+    // Background for letterboxing, or the whole rect until the first frame
+    if (!video->current || dst.w != widget->bounds.w || dst.h != widget->bounds.h) {
+        SDL_Color bg = widget->background_color;
+        if (display_list_set_draw_color(list, bg.r, bg.g, bg.b, bg.a) < 0 ||
+            display_list_fill_rect(list, &widget->bounds) < 0) {
+            pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                           "Failed to draw video background for '%s': %s",
+                                           widget->id, SDL_GetError());
+            return PK_ERROR_RENDER_FAILED;
+        }
+    }
+
+    if (video->current) {
+        if (display_list_copy_yuv(list, video, video->current, &dst) < 0) {
+            pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
+                                           "Failed to record video frame for '%s': %s",
+                                           widget->id, SDL_GetError());
+            return PK_ERROR_RENDER_FAILED;
+        }
+    }
+
+    return PK_OK;
+}
+
+static void video_widget_destroy(Widget* widget) {
+    VideoWidget* video = (VideoWidget*)widget;
+    if (!video) {
+        return;
+    }
+
+    video_widget_stop(widget);
+
+    log_info("Video widget '%s': %llu received, %llu shown, %llu dropped, %llu errors",
+             widget->id,
+             (unsigned long long)video->stats.frames_received,
+             (unsigned long long)video->stats.frames_shown,
+             (unsigned long long)video->stats.frames_dropped,
+             (unsigned long long)video->stats.decode_errors);
+
+    // Display lists keep their own references to frames still in flight
+    yuv_frame_release(video->latest);
+    yuv_frame_release(video->current);
+    for (int i = 0; i < VIDEO_FRAME_POOL_SIZE; i++) {
+        yuv_frame_release(video->pool[i]);
+    }
+
+    pthread_mutex_destroy(&video->mutex);
+
+    // Base cleanup frees the widget itself
+}
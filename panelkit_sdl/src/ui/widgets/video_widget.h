@@ -0,0 +1,77 @@
+/**
+ * @file video_widget.h
+ * @brief Live camera feed widget
+ *
+ * Shows frames from an MJPEG stream or V4L2 device. Capture and JPEG
+ * decoding run on a worker thread straight into YUV 4:2:0 frames; the
+ * widget records the newest frame into the display list by reference and
+ * the render thread uploads it to a streaming texture. Frames that are
+ * superseded before they are shown are dropped, never queued.
+ */
+
+#ifndef VIDEO_WIDGET_H
+#define VIDEO_WIDGET_H
+
+#include "../widget.h"
+#include <stdint.h>
+
+/**
+ * Video feed statistics.
+ */
+typedef struct {
+    uint64_t frames_received;   /**< Frames delivered by the source */
+    uint64_t frames_decoded;    /**< Frames decoded into YUV */
+    uint64_t frames_shown;      /**< Frames recorded for display */
+    uint64_t frames_dropped;    /**< Late frames skipped or replaced before display */
+    uint64_t decode_errors;     /**< Corrupt or unsupported frames */
+    uint32_t last_decode_us;    /**< Decode time of the last frame */
+    int width;                  /**< Current stream resolution */
+    int height;
+} VideoWidgetStats;
+
+/**
+ * Create a video widget.
+ *
+ * @param id Unique identifier for the widget
+ * @param source "http://host/stream.mjpg", "file://..." or "/dev/videoN"
+ * @param capture_width Requested capture width for V4L2 devices
+ * @param capture_height Requested capture height for V4L2 devices
+ * @return New video widget or NULL on error (caller owns)
+ * @note Capture does not start until video_widget_start() is called
+ */
+Widget* video_widget_create(const char* id, const char* source,
+                            int capture_width, int capture_height);
+
+/**
+ * Start the capture/decode worker.
+ *
+ * @param widget Video widget
+ * @return PK_OK on success, error code on failure
+ */
+PkError video_widget_start(Widget* widget);
+
+/**
+ * Stop the capture/decode worker.
+ *
+ * @param widget Video widget
+ * @note Blocks until the worker exits (at most ~100ms plus one decode)
+ */
+void video_widget_stop(Widget* widget);
+
+/**
+ * Get feed statistics.
+ *
+ * @param widget Video widget
+ * @param stats Output statistics snapshot
+ */
+void video_widget_get_stats(Widget* widget, VideoWidgetStats* stats);
+
+/**
+ * Check whether JPEG decoding is available in this build.
+ *
+ * @return true if built with libjpeg-turbo
+ * @note Without it only V4L2 devices in YUYV mode can be shown
+ */
+bool video_widget_supports_jpeg(void);
+
+#endif // VIDEO_WIDGET_H
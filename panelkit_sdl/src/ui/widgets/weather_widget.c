@@ -10,11 +10,12 @@
 #include "core/error.h"
 
 // Forward declarations for virtual functions
-static PkError weather_widget_render(Widget* widget, SDL_Renderer* renderer);
+static PkError weather_widget_render(Widget* widget, DisplayList* list);
 static void weather_widget_handle_event(Widget* widget, const SDL_Event* event);
 static void weather_widget_handle_data_event(Widget* widget, const char* event_name,
                                            const void* data, size_t data_size);
 static void weather_widget_destroy(Widget* widget);
+static void weather_widget_data_changed(WeatherWidget* weather);
 
 WeatherWidget* weather_widget_create(const char* id, const char* location) {
     if (!id) {
@@ -100,6 +101,8 @@ void weather_widget_set_location(WeatherWidget* widget, const char* location) {
     
     strncpy(widget->current_weather.location, location,
             sizeof(widget->current_weather.location) - 1);
+    widget->view_valid = false;
+    widget->view_defined = false;
     widget_invalidate(&widget->base);
 }
 
@@ -143,7 +146,7 @@ void weather_widget_set_data(WeatherWidget* widget, const WeatherData* data) {
     widget->current_weather = *data;
     widget->has_data = true;
     widget->last_update = time(NULL);
-    widget_invalidate(&widget->base);
+    weather_widget_data_changed(widget);
 }
 
 void weather_widget_request_update(WeatherWidget* widget) {
@@ -164,15 +167,112 @@ void weather_widget_request_update(WeatherWidget* widget) {
     log_debug("Weather widget requested update for '%s'", request.location);
 }
 
-static PkError weather_widget_render(Widget* widget, SDL_Renderer* renderer) {
+// Derived view
+
+// Compute function for "weather_view:<location>"; input 0 is WeatherData
+static bool weather_view_compute(const StateComputeInput* inputs, size_t input_count,
+                                 void* output, void* user_context) {
+    (void)user_context;
+    if (input_count < 1 || !inputs[0].data || inputs[0].data_size != sizeof(WeatherData)) {
+        return false;
+    }
+    
+    const WeatherData* data = inputs[0].data;
+    WeatherView* view = output;
+    
+    view->temperature_f = data->temperature;
+    view->temperature_c = (data->temperature - 32.0f) * 5.0f / 9.0f;
+    
+    int percent = (int)((data->temperature - 32.0f) / 68.0f * 100.0f);
+    if (percent < 0) percent = 0;
+    if (percent > 100) percent = 100;
+    view->temperature_percent = percent;
+    view->temperature_color = (SDL_Color){
+        (Uint8)(percent * 2), 50, (Uint8)((100 - percent) * 2), 255
+    };
+    
+    int humidity = (int)data->humidity;
+    view->humidity_percent = humidity < 0 ? 0 : (humidity > 100 ? 100 : humidity);
+    view->has_description = data->description[0] != '\0';
+    view->updated = inputs[0].timestamp;
+    return true;
+}
+
+// Publish new data: through the state store if connected, locally otherwise
+static void weather_widget_data_changed(WeatherWidget* weather) {
+    if (weather->base.state_store) {
+        state_store_set(weather->base.state_store, "weather_data",
+                        weather->current_weather.location,
+                        &weather->current_weather, sizeof(weather->current_weather));
+    }
+    weather->view_valid = false;
+    widget_invalidate(&weather->base);
+}
+
+// Bring the view up to date; cheap unless the underlying data changed
+static void weather_widget_refresh_view(WeatherWidget* weather) {
+    StateStore* store = weather->base.state_store;
+    const char* location = weather->current_weather.location;
+    
+    if (store && !weather->view_defined) {
+        char input_key[96];
+        snprintf(input_key, sizeof(input_key), "weather_data:%s", location);
+        const char* inputs[] = { input_key };
+        ComputedStateConfig config = {
+            .type_name = "weather_view",
+            .id = location,
+            .inputs = inputs,
+            .input_count = 1,
+            .value_size = sizeof(WeatherView),
+            .compute = weather_view_compute
+        };
+        weather->view_defined = state_store_define_computed(store, &config);
+        if (!weather->view_defined) {
+            log_warn("Weather widget '%s' falling back to local view: %s",
+                     weather->base.id, pk_get_last_error_context());
+        }
+    }
+    
+    if (weather->view_defined) {
+        uint64_t version = state_store_get_version(store);
+        if (weather->view_valid && version == weather->view_version) {
+            return;
+        }
+        size_t size = 0;
+        WeatherView* view = state_store_get(store, "weather_view", location, &size, NULL);
+        if (view && size == sizeof(WeatherView)) {
+            weather->view = *view;
+            weather->view_valid = true;
+            weather->view_version = version;
+        }
+        free(view);
+        if (weather->view_valid) {
+            return;
+        }
+    }
+    
+    // No store, or the stored data is gone: derive from the local copy
+    if (!weather->view_valid && weather->has_data) {
+        StateComputeInput input = {
+            .type_name = "weather_data",
+            .id = location,
+            .data = &weather->current_weather,
+            .data_size = sizeof(weather->current_weather),
+            .timestamp = weather->last_update
+        };
+        weather->view_valid = weather_view_compute(&input, 1, &weather->view, NULL);
+    }
+}
+
+static PkError weather_widget_render(Widget* widget, DisplayList* list) {
     WeatherWidget* weather = (WeatherWidget*)widget;
     PK_CHECK_ERROR_WITH_CONTEXT(weather != NULL, PK_ERROR_NULL_PARAM,
                                "weather widget is NULL in weather_widget_render");
-    PK_CHECK_ERROR_WITH_CONTEXT(renderer != NULL, PK_ERROR_NULL_PARAM,
-                               "renderer is NULL in weather_widget_render");
+    PK_CHECK_ERROR_WITH_CONTEXT(list != NULL, PK_ERROR_NULL_PARAM,
+                               "list is NULL in weather_widget_render");
     
     // Call base render for background and border
-    PkError err = widget_default_render(widget, renderer);
+    PkError err = widget_default_render(widget, list);
     if (err != PK_OK) {
         return err;
     }
@@ -185,15 +285,19 @@ static PkError weather_widget_render(Widget* widget, SDL_Renderer* renderer) {
         widget->bounds.h - widget->padding * 2
     };
     
-    if (!weather->has_data) {
+    if (weather->has_data) {
+        weather_widget_refresh_view(weather);
+    }
+    
+    if (!weather->has_data || !weather->view_valid) {
         // Draw loading indicator
-        SDL_SetRenderDrawColor(renderer, 180, 180, 180, 255);
+        display_list_set_draw_color(list, 180, 180, 180, 255);
         SDL_Rect loading_rect = {
             content.x + content.w / 2 - 30,
             content.y + content.h / 2 - 10,
             60, 20
         };
-        if (SDL_RenderDrawRect(renderer, &loading_rect) < 0) {
+        if (display_list_draw_rect(list, &loading_rect) < 0) {
             pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
                                            "Failed to draw loading rect: %s",
                                            SDL_GetError());
@@ -206,74 +310,66 @@ static PkError weather_widget_render(Widget* widget, SDL_Renderer* renderer) {
     int y_offset = content.y;
     
     // Location
-    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
+    display_list_set_draw_color(list, 100, 100, 100, 255);
     SDL_Rect location_rect = {content.x, y_offset, content.w, 25};
-    SDL_RenderDrawRect(renderer, &location_rect);
+    display_list_draw_rect(list, &location_rect);
     y_offset += 30;
     
     // Temperature
-    float temp = weather->current_weather.temperature;
-    if (weather->use_celsius) {
-        temp = (temp - 32.0f) * 5.0f / 9.0f;
-    }
-    
-    SDL_SetRenderDrawColor(renderer, 50, 50, 200, 255);
+    const WeatherView* view = &weather->view;
+    display_list_set_draw_color(list, 50, 50, 200, 255);
     SDL_Rect temp_rect = {content.x, y_offset, content.w, 40};
-    SDL_RenderDrawRect(renderer, &temp_rect);
+    display_list_draw_rect(list, &temp_rect);
     
     // Draw temperature indicator (blue for cold, red for hot)
-    int temp_indicator = (int)((temp - 32.0f) / 68.0f * 100.0f);  // 0-100 scale
-    if (temp_indicator < 0) temp_indicator = 0;
-    if (temp_indicator > 100) temp_indicator = 100;
-    
-    SDL_SetRenderDrawColor(renderer, 
-                          temp_indicator * 2, 
-                          50, 
-                          (100 - temp_indicator) * 2, 
+    display_list_set_draw_color(list, 
+                          view->temperature_color.r, 
+                          view->temperature_color.g, 
+                          view->temperature_color.b, 
                           255);
     SDL_Rect temp_bar = {
         temp_rect.x + 5,
         temp_rect.y + 5,
-        (temp_rect.w - 10) * temp_indicator / 100,
+        (temp_rect.w - 10) * view->temperature_percent / 100,
         temp_rect.h - 10
     };
-    SDL_RenderFillRect(renderer, &temp_bar);
+    display_list_fill_rect(list, &temp_bar);
     y_offset += 45;
     
     // Humidity
-    if (weather->show_humidity && weather->current_weather.humidity > 0) {
-        SDL_SetRenderDrawColor(renderer, 100, 150, 200, 255);
+    if (weather->show_humidity && view->humidity_percent > 0) {
+        display_list_set_draw_color(list, 100, 150, 200, 255);
         SDL_Rect humidity_rect = {content.x, y_offset, content.w, 20};
-        SDL_RenderDrawRect(renderer, &humidity_rect);
+        display_list_draw_rect(list, &humidity_rect);
         
         // Humidity bar
-        int humidity_width = (int)(content.w * weather->current_weather.humidity / 100.0f);
+        int humidity_width = content.w * view->humidity_percent / 100;
         SDL_Rect humidity_bar = {
             humidity_rect.x + 2,
             humidity_rect.y + 2,
             humidity_width - 4,
             humidity_rect.h - 4
         };
-        SDL_RenderFillRect(renderer, &humidity_bar);
+        display_list_fill_rect(list, &humidity_bar);
         y_offset += 25;
     }
     
     // Description
-    if (weather->show_description && strlen(weather->current_weather.description) > 0) {
-        SDL_SetRenderDrawColor(renderer, 150, 150, 150, 255);
+    if (weather->show_description && view->has_description) {
+        display_list_set_draw_color(list, 150, 150, 150, 255);
         SDL_Rect desc_rect = {content.x, y_offset, content.w, 20};
-        SDL_RenderDrawRect(renderer, &desc_rect);
+        display_list_draw_rect(list, &desc_rect);
     }
     
     // Update indicator
     time_t now = time(NULL);
-    int age = (int)(now - weather->last_update);
+    int age = (int)(now - view->updated);
     if (age < 60) {
-        SDL_SetRenderDrawColor(renderer, 0, 200, 0, 255);
+        display_list_set_draw_color(list, 0, 200, 0, 255);
     } else if (age < 300) {
-        SDL_SetRenderDrawColor(renderer, 200, 200, 0, 255);
+        display_list_set_draw_color(list, 200, 200, 0, 255);
     } else {
-        SDL_SetRenderDrawColor(renderer, 200, 0, 0, 255);
+        display_list_set_draw_color(list, 200, 0, 0, 255);
     }
     
     SDL_Rect update_indicator = {
@@ -281,7 +377,7 @@ static PkError weather_widget_render(Widget* widget, SDL_Renderer* renderer) {
         widget->bounds.y + 5,
         10, 10
     };
-    if (SDL_RenderFillRect(renderer, &update_indicator) < 0) {
+    if (display_list_fill_rect(list, &update_indicator) < 0) {
         pk_set_last_error_with_context(PK_ERROR_RENDER_FAILED,
                                        "Failed to draw update indicator: %s",
                                        SDL_GetError());
@@ -341,18 +437,10 @@ static void weather_widget_handle_data_event(Widget* widget, const char* event_n
                 weather->current_weather.timestamp = weather_data->timestamp;
                 weather->has_data = true;
                 weather->last_update = time(NULL);
-                widget_invalidate(widget);
+                weather_widget_data_changed(weather);
             }
         }
     }
-    
-    // Store in state store if available
-    if (widget->state_store && weather->has_data) {
-        state_store_set(widget->state_store, "weather_data",
-                       weather->current_weather.location,
-                       &weather->current_weather,
-                       sizeof(weather->current_weather));
-    }
 }
 
 static void weather_widget_destroy(Widget* widget) {
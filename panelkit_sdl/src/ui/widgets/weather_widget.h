@@ -10,6 +10,7 @@
 #define WEATHER_WIDGET_H
 
 #include "../widget.h"
+#include <stdint.h>
 #include <time.h>
 
 // Weather data structure
@@ -21,6 +22,19 @@ typedef struct {
     time_t timestamp;
 } WeatherData;
 
+// Display values derived from WeatherData. Published as the computed state
+// key "weather_view:<location>" over "weather_data:<location>", so they are
+// worked out once per weather update rather than every frame.
+typedef struct {
+    float temperature_f;
+    float temperature_c;
+    int temperature_percent;    // 0-100 on a 32-100°F comfort scale
+    SDL_Color temperature_color;  // Blue (cold) to red (hot)
+    int humidity_percent;       // 0-100
+    bool has_description;
+    time_t updated;             // When the source data was stored
+} WeatherView;
+
 // Weather widget - displays weather information and subscribes to weather events
 typedef struct WeatherWidget {
     Widget base;  // Must be first member for casting
@@ -37,6 +51,12 @@ typedef struct WeatherWidget {
     // Update tracking
     time_t last_update;
     int update_interval;  // seconds
+    
+    // Derived display values, refreshed when the state store version moves
+    WeatherView view;
+    bool view_valid;
+    bool view_defined;      // Computed key registered with the state store
+    uint64_t view_version;  // Store version the view was read at
 } WeatherWidget;
 
 /**
@@ -0,0 +1,660 @@
+/**
+ * @file mock_api_server.c
+ * @brief Local HTTP stand-in for API services with fault injection
+ *
+ * One thread accepts, one thread per connection serves keep-alive
+ * requests. All waits are sliced into short polls so stopping the server
+ * never waits on a throttled body or a held connection.
+ */
+
+#define _GNU_SOURCE
+#include "mock_api_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define MOCK_POLL_MS 100
+#define MOCK_REQUEST_MAX 8192
+
+struct MockApiServer {
+    MockRoute* routes;
+    size_t route_count;
+    atomic_ulong* route_requests;   /* Drives each route's burst cycle */
+
+    int listener;
+    int port;
+    pthread_t accept_thread;
+    atomic_bool stopping;
+    atomic_int active_connections;
+
+    pthread_mutex_t rng_lock;
+    uint64_t rng_state;
+
+    atomic_ulong connections;
+    atomic_ulong requests;
+    atomic_ulong responses_ok;
+    atomic_ulong responses_error;
+    atomic_ulong responses_missing;
+    atomic_ulong hangs;
+    atomic_ulong bytes_sent;
+};
+
+typedef struct {
+    MockApiServer* server;
+    int fd;
+} Connection;
+
+/* Sampling */
+
+static double sample_uniform(MockApiServer* server) {
+    pthread_mutex_lock(&server->rng_lock);
+    /* xorshift64* */
+    uint64_t x = server->rng_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    server->rng_state = x;
+    pthread_mutex_unlock(&server->rng_lock);
+    return (double)((x * 2685821657736338717ull) >> 11) / 9007199254740992.0;
+}
+
+static int sample_latency_ms(MockApiServer* server, const MockLatency* latency) {
+    double ms;
+    switch (latency->kind) {
+        case MOCK_LATENCY_FIXED:
+            ms = latency->mean_ms;
+            break;
+        case MOCK_LATENCY_UNIFORM:
+            ms = latency->min_ms + sample_uniform(server) * (latency->max_ms - latency->min_ms);
+            break;
+        case MOCK_LATENCY_NORMAL: {
+            /* Box-Muller */
+            double u1 = sample_uniform(server);
+            double u2 = sample_uniform(server);
+            double z = sqrt(-2.0 * log(u1 > 0.0 ? u1 : 1e-12)) * cos(2.0 * M_PI * u2);
+            ms = latency->mean_ms + z * latency->stddev_ms;
+            break;
+        }
+        case MOCK_LATENCY_EXPONENTIAL: {
+            double u = sample_uniform(server);
+            ms = -latency->mean_ms * log(1.0 - u);
+            break;
+        }
+        default:
+            return 0;
+    }
+    if (ms < latency->min_ms) {
+        ms = latency->min_ms;
+    }
+    if (latency->max_ms > 0 && ms > latency->max_ms) {
+        ms = latency->max_ms;
+    }
+    return ms > 0.0 ? (int)ms : 0;
+}
+
+/* Waiting and I/O */
+
+/* Sleep in short slices; false if the server is stopping */
+static bool pause_ms(MockApiServer* server, int ms) {
+    while (ms > 0 && !atomic_load(&server->stopping)) {
+        int slice = ms < MOCK_POLL_MS ? ms : MOCK_POLL_MS;
+        struct timespec ts = { slice / 1000, (long)(slice % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+        ms -= slice;
+    }
+    return !atomic_load(&server->stopping);
+}
+
+/* 1 = readable, 0 = stopping, -1 = error */
+static int wait_readable(MockApiServer* server, int fd) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    while (!atomic_load(&server->stopping)) {
+        int r = poll(&pfd, 1, MOCK_POLL_MS);
+        if (r > 0) {
+            return 1;
+        }
+        if (r < 0 && errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static bool send_all(MockApiServer* server, int fd, const void* data, size_t size) {
+    const char* p = data;
+    while (size > 0) {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        atomic_fetch_add(&server->bytes_sent, (unsigned long)n);
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/* Body with throttle and drip applied */
+static bool send_body(MockApiServer* server, int fd, const MockRoute* route,
+                      const char* body, size_t size) {
+    size_t chunk = size;
+    if (route->drip_bytes > 0) {
+        chunk = (size_t)route->drip_bytes;
+    } else if (route->bytes_per_sec > 0) {
+        chunk = route->bytes_per_sec / 20 > 0 ? route->bytes_per_sec / 20 : 1;
+    }
+    if (chunk == 0) {
+        return true;
+    }
+
+    uint64_t start = now_ms();
+    size_t sent = 0;
+    while (sent < size) {
+        size_t n = size - sent < chunk ? size - sent : chunk;
+        if (!send_all(server, fd, body + sent, n)) {
+            return false;
+        }
+        sent += n;
+        if (sent == size) {
+            break;
+        }
+
+        /* Pace against the start so rounding does not accumulate */
+        int wait = route->drip_interval_ms;
+        if (route->bytes_per_sec > 0) {
+            uint64_t due = start + (uint64_t)sent * 1000u / route->bytes_per_sec;
+            uint64_t now = now_ms();
+            if (due > now && (int)(due - now) > wait) {
+                wait = (int)(due - now);
+            }
+        }
+        if (!pause_ms(server, wait)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 404: return "Not Found";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default:  return "Status";
+    }
+}
+
+static bool send_response(MockApiServer* server, int fd, const MockRoute* route,
+                          int status, const char* content_type,
+                          const char* body, size_t size) {
+    char header[256];
+    int len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 %d %s\r\n"
+                       "Content-Type: %s\r\n"
+                       "Content-Length: %zu\r\n"
+                       "Connection: keep-alive\r\n\r\n",
+                       status, status_text(status), content_type, size);
+    if (!send_all(server, fd, header, (size_t)len)) {
+        return false;
+    }
+    return route ? send_body(server, fd, route, body, size) : send_all(server, fd, body, size);
+}
+
+/* Requests */
+
+static const MockRoute* find_route(MockApiServer* server, const char* path, size_t* index) {
+    size_t path_len = strcspn(path, "?");
+    for (size_t i = 0; i < server->route_count; i++) {
+        const char* route_path = server->routes[i].path;
+        if (strcmp(route_path, "*") == 0 ||
+            (strlen(route_path) == path_len && strncmp(route_path, path, path_len) == 0)) {
+            *index = i;
+            return &server->routes[i];
+        }
+    }
+    return NULL;
+}
+
+/* Hold the connection without answering until the client gives up */
+static void hold_connection(MockApiServer* server, int fd) {
+    char scratch[512];
+    while (wait_readable(server, fd) > 0) {
+        if (recv(fd, scratch, sizeof(scratch), 0) <= 0) {
+            break;
+        }
+    }
+}
+
+/* Returns false when the connection should be closed */
+static bool handle_request(MockApiServer* server, int fd, const char* path) {
+    atomic_fetch_add(&server->requests, 1);
+
+    size_t index = 0;
+    const MockRoute* route = find_route(server, path, &index);
+    if (!route) {
+        static const char missing[] = "{\"error\":\"no such route\"}";
+        atomic_fetch_add(&server->responses_missing, 1);
+        return send_response(server, fd, NULL, 404, "application/json",
+                             missing, sizeof(missing) - 1);
+    }
+
+    unsigned long n = atomic_fetch_add(&server->route_requests[index], 1);
+
+    if (route->hang_rate > 0.0 && sample_uniform(server) < route->hang_rate) {
+        atomic_fetch_add(&server->hangs, 1);
+        hold_connection(server, fd);
+        return false;
+    }
+
+    if (!pause_ms(server, sample_latency_ms(server, &route->latency))) {
+        return false;
+    }
+
+    if (route->burst_every > 0 && (int)(n % (unsigned long)route->burst_every) < route->burst_length) {
+        static const char injected[] = "{\"error\":\"injected fault\"}";
+        atomic_fetch_add(&server->responses_error, 1);
+        return send_response(server, fd, route, route->burst_status ? route->burst_status : 503,
+                             "application/json", injected, sizeof(injected) - 1);
+    }
+
+    atomic_fetch_add(&server->responses_ok, 1);
+    return send_response(server, fd, route, route->status ? route->status : 200,
+                         route->content_type ? route->content_type : "application/json",
+                         route->body ? route->body : "", route->body_size);
+}
+
+static size_t content_length(const char* headers) {
+    const char* p = headers;
+    while ((p = strchr(p, '\n')) != NULL) {
+        p++;
+        if (strncasecmp(p, "Content-Length:", 15) == 0) {
+            return (size_t)strtoul(p + 15, NULL, 10);
+        }
+    }
+    return 0;
+}
+
+static void* connection_main(void* arg) {
+    Connection* conn = arg;
+    MockApiServer* server = conn->server;
+    int fd = conn->fd;
+    free(conn);
+
+    char buf[MOCK_REQUEST_MAX + 1];
+    size_t len = 0;
+    size_t discard = 0;     /* Request body bytes still to skip */
+
+    while (wait_readable(server, fd) > 0) {
+        ssize_t n = recv(fd, buf + len, MOCK_REQUEST_MAX - len, 0);
+        if (n <= 0) {
+            break;
+        }
+        len += (size_t)n;
+
+        for (;;) {
+            size_t skip = discard < len ? discard : len;
+            memmove(buf, buf + skip, len - skip);
+            len -= skip;
+            discard -= skip;
+            if (discard > 0) {
+                break;
+            }
+
+            buf[len] = '\0';
+            char* end = strstr(buf, "\r\n\r\n");
+            if (!end) {
+                if (len == MOCK_REQUEST_MAX) {
+                    goto done;  /* Oversized header block */
+                }
+                break;
+            }
+            *end = '\0';
+
+            char method[16];
+            char path[1024];
+            if (sscanf(buf, "%15s %1023s", method, path) != 2) {
+                goto done;
+            }
+            discard = (size_t)(end + 4 - buf) + content_length(buf);
+            if (!handle_request(server, fd, path)) {
+                goto done;
+            }
+        }
+    }
+
+done:
+    close(fd);
+    atomic_fetch_sub(&server->active_connections, 1);
+    return NULL;
+}
+
+static void* accept_main(void* arg) {
+    MockApiServer* server = arg;
+    while (!atomic_load(&server->stopping)) {
+        int fd = accept(server->listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        Connection* conn = malloc(sizeof(Connection));
+        pthread_t thread;
+        if (!conn) {
+            close(fd);
+            continue;
+        }
+        conn->server = server;
+        conn->fd = fd;
+        atomic_fetch_add(&server->connections, 1);
+        atomic_fetch_add(&server->active_connections, 1);
+        if (pthread_create(&thread, NULL, connection_main, conn) != 0) {
+            atomic_fetch_sub(&server->active_connections, 1);
+            close(fd);
+            free(conn);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+/* Lifecycle */
+
+MockApiServer* mock_api_server_start(const MockRoute* routes, size_t route_count,
+                                     int port, unsigned int seed) {
+    MockApiServer* server = calloc(1, sizeof(MockApiServer));
+    if (!server) {
+        return NULL;
+    }
+    server->routes = calloc(route_count ? route_count : 1, sizeof(MockRoute));
+    server->route_requests = calloc(route_count ? route_count : 1, sizeof(atomic_ulong));
+    if (!server->routes || !server->route_requests) {
+        goto failed;
+    }
+    if (route_count) {
+        memcpy(server->routes, routes, route_count * sizeof(MockRoute));
+    }
+    server->route_count = route_count;
+    server->rng_state = ((uint64_t)seed << 1) | 1u;
+    pthread_mutex_init(&server->rng_lock, NULL);
+
+    server->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listener < 0) {
+        goto failed;
+    }
+    int reuse = 1;
+    setsockopt(server->listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr = {0};
+    socklen_t addr_len = sizeof(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(server->listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(server->listener, 64) < 0 ||
+        getsockname(server->listener, (struct sockaddr*)&addr, &addr_len) < 0) {
+        fprintf(stderr, "mock_api_server: cannot listen on port %d: %s\n", port, strerror(errno));
+        close(server->listener);
+        goto failed;
+    }
+    server->port = ntohs(addr.sin_port);
+
+    if (pthread_create(&server->accept_thread, NULL, accept_main, server) != 0) {
+        close(server->listener);
+        goto failed;
+    }
+    return server;
+
+failed:
+    free(server->route_requests);
+    free(server->routes);
+    free(server);
+    return NULL;
+}
+
+int mock_api_server_port(const MockApiServer* server) {
+    return server ? server->port : 0;
+}
+
+void mock_api_server_url(const MockApiServer* server, const char* path,
+                         char* url, size_t url_size) {
+    snprintf(url, url_size, "http://127.0.0.1:%d%s", mock_api_server_port(server),
+             path ? path : "/");
+}
+
+void mock_api_server_get_stats(MockApiServer* server, MockServerStats* stats) {
+    stats->connections = atomic_load(&server->connections);
+    stats->requests = atomic_load(&server->requests);
+    stats->responses_ok = atomic_load(&server->responses_ok);
+    stats->responses_error = atomic_load(&server->responses_error);
+    stats->responses_missing = atomic_load(&server->responses_missing);
+    stats->hangs = atomic_load(&server->hangs);
+    stats->bytes_sent = atomic_load(&server->bytes_sent);
+}
+
+void mock_api_server_reset_stats(MockApiServer* server) {
+    atomic_store(&server->connections, 0);
+    atomic_store(&server->requests, 0);
+    atomic_store(&server->responses_ok, 0);
+    atomic_store(&server->responses_error, 0);
+    atomic_store(&server->responses_missing, 0);
+    atomic_store(&server->hangs, 0);
+    atomic_store(&server->bytes_sent, 0);
+    for (size_t i = 0; i < server->route_count; i++) {
+        atomic_store(&server->route_requests[i], 0);
+    }
+}
+
+void mock_api_server_stop(MockApiServer* server) {
+    if (!server) {
+        return;
+    }
+    atomic_store(&server->stopping, true);
+    shutdown(server->listener, SHUT_RDWR);
+    pthread_join(server->accept_thread, NULL);
+    close(server->listener);
+
+    while (atomic_load(&server->active_connections) > 0) {
+        usleep(10000);
+    }
+    pthread_mutex_destroy(&server->rng_lock);
+    free(server->route_requests);
+    free(server->routes);
+    free(server);
+}
+
+/* Route files */
+
+static char* read_file(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = malloc(n > 0 ? (size_t)n + 1 : 1);
+    if (data && n > 0 && fread(data, 1, (size_t)n, f) != (size_t)n) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    if (data) {
+        data[n > 0 ? n : 0] = '\0';
+        *size = n > 0 ? (size_t)n : 0;
+    }
+    return data;
+}
+
+static bool parse_option(MockRoute* route, const char* key, const char* value) {
+    if (strcmp(key, "latency") == 0) {
+        int a = 0, b = 0;
+        if (sscanf(value, "fixed:%d", &a) == 1) {
+            route->latency.kind = MOCK_LATENCY_FIXED;
+            route->latency.mean_ms = a;
+        } else if (sscanf(value, "uniform:%d:%d", &a, &b) == 2) {
+            route->latency.kind = MOCK_LATENCY_UNIFORM;
+            route->latency.min_ms = a;
+            route->latency.max_ms = b;
+        } else if (sscanf(value, "normal:%d:%d", &a, &b) == 2) {
+            route->latency.kind = MOCK_LATENCY_NORMAL;
+            route->latency.mean_ms = a;
+            route->latency.stddev_ms = b;
+        } else if (sscanf(value, "exp:%d", &a) == 1) {
+            route->latency.kind = MOCK_LATENCY_EXPONENTIAL;
+            route->latency.mean_ms = a;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    if (strcmp(key, "max_ms") == 0) {
+        route->latency.max_ms = atoi(value);
+        return true;
+    }
+    if (strcmp(key, "bps") == 0) {
+        route->bytes_per_sec = (uint32_t)strtoul(value, NULL, 10);
+        return true;
+    }
+    if (strcmp(key, "drip") == 0) {
+        return sscanf(value, "%d:%d", &route->drip_bytes, &route->drip_interval_ms) == 2;
+    }
+    if (strcmp(key, "burst") == 0) {
+        return sscanf(value, "%d/%d:%d", &route->burst_length, &route->burst_every,
+                      &route->burst_status) >= 2;
+    }
+    if (strcmp(key, "hang") == 0) {
+        route->hang_rate = atof(value);
+        return true;
+    }
+    if (strcmp(key, "type") == 0) {
+        route->content_type = strdup(value);
+        return route->content_type != NULL;
+    }
+    return false;
+}
+
+int mock_api_server_load_routes(const char* path, MockRoute** routes) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    /* Body files are relative to the route file */
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char* slash = strrchr(dir, '/');
+    if (slash) {
+        slash[1] = '\0';
+    } else {
+        dir[0] = '\0';
+    }
+
+    MockRoute* table = NULL;
+    int count = 0;
+    char line[1024];
+    int line_no = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        char* hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+        char* save = NULL;
+        char* route_path = strtok_r(line, " \t\r\n", &save);
+        if (!route_path) {
+            continue;
+        }
+        char* status = strtok_r(NULL, " \t\r\n", &save);
+        char* body_file = strtok_r(NULL, " \t\r\n", &save);
+        if (!status || !body_file) {
+            fprintf(stderr, "%s:%d: expected <path> <status> <body-file>\n", path, line_no);
+            goto failed;
+        }
+
+        MockRoute* grown = realloc(table, (size_t)(count + 1) * sizeof(MockRoute));
+        if (!grown) {
+            goto failed;
+        }
+        table = grown;
+        MockRoute* route = &table[count++];
+        memset(route, 0, sizeof(*route));
+        route->path = strdup(route_path);
+        route->status = atoi(status);
+
+        if (strcmp(body_file, "-") != 0) {
+            char body_path[1024];
+            snprintf(body_path, sizeof(body_path), "%s%s",
+                     body_file[0] == '/' ? "" : dir, body_file);
+            route->body = read_file(body_path, &route->body_size);
+            if (!route->body) {
+                fprintf(stderr, "%s:%d: cannot read %s\n", path, line_no, body_path);
+                goto failed;
+            }
+        }
+
+        char* option;
+        while ((option = strtok_r(NULL, " \t\r\n", &save)) != NULL) {
+            char* eq = strchr(option, '=');
+            if (!eq) {
+                fprintf(stderr, "%s:%d: expected key=value, got %s\n", path, line_no, option);
+                goto failed;
+            }
+            *eq = '\0';
+            if (!parse_option(route, option, eq + 1)) {
+                fprintf(stderr, "%s:%d: bad option %s=%s\n", path, line_no, option, eq + 1);
+                goto failed;
+            }
+        }
+    }
+
+    fclose(f);
+    *routes = table;
+    return count;
+
+failed:
+    fclose(f);
+    mock_api_server_free_routes(table, count);
+    return -1;
+}
+
+void mock_api_server_free_routes(MockRoute* routes, int route_count) {
+    for (int i = 0; i < route_count; i++) {
+        free((char*)routes[i].path);
+        free((char*)routes[i].body);
+        free((char*)routes[i].content_type);
+    }
+    free(routes);
+}
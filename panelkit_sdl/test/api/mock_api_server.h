@@ -0,0 +1,117 @@
+/**
+ * @file mock_api_server.h
+ * @brief Local HTTP stand-in for API services with fault injection
+ *
+ * Replays canned responses per path over loopback HTTP/1.1 (keep-alive
+ * supported) so the API client, manager and parsers can be exercised and
+ * benchmarked offline. Each route can add sampled latency, throttle or
+ * drip-feed its body, answer with periodic 5xx bursts, or never answer
+ * at all so the client's timeout fires.
+ *
+ * Runs in-process on its own threads (tests and benchmarks link this
+ * file) or standalone via mock_api_server_main.c with a route file.
+ */
+
+#ifndef PANELKIT_MOCK_API_SERVER_H
+#define PANELKIT_MOCK_API_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct MockApiServer MockApiServer;
+
+/* Latency added before the response headers are sent */
+typedef enum {
+    MOCK_LATENCY_NONE,
+    MOCK_LATENCY_FIXED,         /* mean_ms */
+    MOCK_LATENCY_UNIFORM,       /* min_ms .. max_ms */
+    MOCK_LATENCY_NORMAL,        /* mean_ms +/- stddev_ms, clamped to min/max */
+    MOCK_LATENCY_EXPONENTIAL    /* mean_ms, clamped to min/max (long tail) */
+} MockLatencyKind;
+
+typedef struct {
+    MockLatencyKind kind;
+    int mean_ms;
+    int stddev_ms;
+    int min_ms;
+    int max_ms;                 /* 0 = no upper clamp */
+} MockLatency;
+
+typedef struct {
+    const char* path;           /* Exact path, query ignored; "*" matches all */
+    int status;                 /* HTTP status for normal responses (0 = 200) */
+    const char* content_type;   /* NULL = application/json */
+    const char* body;           /* Borrowed; must outlive the server */
+    size_t body_size;
+
+    MockLatency latency;
+    uint32_t bytes_per_sec;     /* Body throttle (0 = unlimited) */
+    int drip_bytes;             /* Send the body in chunks of this size... */
+    int drip_interval_ms;       /* ...with this pause between them */
+
+    int burst_length;           /* Answer burst_length requests in every */
+    int burst_every;            /* burst_every with burst_status (0 = never) */
+    int burst_status;           /* 0 = 503 */
+    double hang_rate;           /* Fraction of requests never answered */
+} MockRoute;
+
+typedef struct {
+    uint64_t connections;
+    uint64_t requests;
+    uint64_t responses_ok;
+    uint64_t responses_error;   /* Injected 5xx */
+    uint64_t responses_missing; /* 404 for unknown paths */
+    uint64_t hangs;
+    uint64_t bytes_sent;
+} MockServerStats;
+
+/**
+ * Start serving on 127.0.0.1.
+ *
+ * @param routes Route table, copied (bodies stay borrowed)
+ * @param route_count Number of routes
+ * @param port TCP port, 0 for an ephemeral one
+ * @param seed Seed for latency and hang sampling (same seed, same sequence)
+ * @return Server, or NULL if the socket could not be set up
+ */
+MockApiServer* mock_api_server_start(const MockRoute* routes, size_t route_count,
+                                     int port, unsigned int seed);
+
+/** Port the server is listening on */
+int mock_api_server_port(const MockApiServer* server);
+
+/** Write "http://127.0.0.1:<port><path>" into url */
+void mock_api_server_url(const MockApiServer* server, const char* path,
+                         char* url, size_t url_size);
+
+/** Snapshot of the counters */
+void mock_api_server_get_stats(MockApiServer* server, MockServerStats* stats);
+
+/** Zero the counters and restart every route's burst cycle */
+void mock_api_server_reset_stats(MockApiServer* server);
+
+/**
+ * Stop the server, closing held and in-progress connections.
+ * Blocks until every connection thread has exited (~100 ms).
+ */
+void mock_api_server_stop(MockApiServer* server);
+
+/**
+ * Load routes from a text file, one per line:
+ *
+ *   <path> <status> <body-file> [key=value ...]
+ *
+ * Keys: latency=fixed:MEAN | uniform:MIN:MAX | normal:MEAN:STDDEV |
+ * exp:MEAN, max_ms=N, bps=N, drip=BYTES:MS, burst=LEN/EVERY[:STATUS],
+ * hang=RATE, type=CONTENT_TYPE. Body files are relative to the route
+ * file; "-" means an empty body. '#' starts a comment.
+ *
+ * @return Number of routes loaded, -1 on error (message on stderr)
+ * @note Free with mock_api_server_free_routes()
+ */
+int mock_api_server_load_routes(const char* path, MockRoute** routes);
+
+/** Free a route table returned by mock_api_server_load_routes() */
+void mock_api_server_free_routes(MockRoute* routes, int route_count);
+
+#endif /* PANELKIT_MOCK_API_SERVER_H */
@@ -0,0 +1,71 @@
+/**
+ * @file mock_api_server_main.c
+ * @brief Standalone mock API server for manual and on-target testing
+ *
+ * Usage: mock_api_server <routes-file> [port] [seed]
+ *
+ * Serves the routes until interrupted, then prints the request counters.
+ * Point an ApiManager at it (ApiManagerConfig.base_url =
+ * "http://127.0.0.1:8091/api/") or use curl to see the injected latency
+ * and faults by hand. See routes.example for the route file format.
+ */
+
+#include "mock_api_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t g_running = 1;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_running = 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <routes-file> [port] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    MockRoute* routes = NULL;
+    int count = mock_api_server_load_routes(argv[1], &routes);
+    if (count < 0) {
+        return 1;
+    }
+
+    int port = argc > 2 ? atoi(argv[2]) : 8091;
+    unsigned int seed = argc > 3 ? (unsigned int)strtoul(argv[3], NULL, 10) : 1;
+
+    MockApiServer* server = mock_api_server_start(routes, (size_t)count, port, seed);
+    if (!server) {
+        mock_api_server_free_routes(routes, count);
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    printf("Serving %d routes on http://127.0.0.1:%d/\n", count, mock_api_server_port(server));
+    for (int i = 0; i < count; i++) {
+        printf("  %-24s %3d  %zu bytes\n", routes[i].path,
+               routes[i].status ? routes[i].status : 200, routes[i].body_size);
+    }
+
+    while (g_running) {
+        pause();
+    }
+
+    MockServerStats stats;
+    mock_api_server_get_stats(server, &stats);
+    mock_api_server_stop(server);
+    mock_api_server_free_routes(routes, count);
+
+    printf("\nconnections=%llu requests=%llu ok=%llu injected_5xx=%llu 404=%llu hangs=%llu bytes=%llu\n",
+           (unsigned long long)stats.connections, (unsigned long long)stats.requests,
+           (unsigned long long)stats.responses_ok, (unsigned long long)stats.responses_error,
+           (unsigned long long)stats.responses_missing, (unsigned long long)stats.hangs,
+           (unsigned long long)stats.bytes_sent);
+    return 0;
+}
@@ -0,0 +1,399 @@
+/**
+ * @file bench_api_client.c
+ * @brief API client and manager under degraded network conditions
+ *
+ * Runs entirely against the in-process mock API server (test/api), so no
+ * network is needed. Measures request throughput, checks that retries
+ * ride out 5xx bursts, that hung and drip-fed responses end in timeouts
+ * instead of wedging a lane, that throttled bodies arrive intact at the
+ * configured rate, and that a 60 Hz main loop driving ApiManager keeps
+ * its frame budget while the upstream is slow and failing.
+ *
+ * Requires libcurl; build with `make build-bench-api`.
+ */
+
+#include "bench_common.h"
+#include "../api/mock_api_server.h"
+#include "../../src/core/logger.h"
+#include "../../src/api/api_client.h"
+#include "../../src/api/api_manager.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <curl/curl.h>
+
+#define BENCH_THREADS 4
+#define FRAME_BUDGET_US 16667
+
+static char* g_fixture;
+static size_t g_fixture_size;
+static char* g_large_body;
+static size_t g_large_size;
+
+static MockApiServer* g_server;
+
+/* Routes, sharing the recorded fixture */
+enum {
+    ROUTE_FAST,
+    ROUTE_WAN,
+    ROUTE_OVERLOADED,
+    ROUTE_HANG,
+    ROUTE_DRIP,
+    ROUTE_THROTTLED,
+    ROUTE_DEGRADED,
+    ROUTE_COUNT
+};
+
+static void build_routes(MockRoute* routes) {
+    memset(routes, 0, ROUTE_COUNT * sizeof(MockRoute));
+    for (int i = 0; i < ROUTE_COUNT; i++) {
+        routes[i].body = g_fixture;
+        routes[i].body_size = g_fixture_size;
+    }
+    routes[ROUTE_FAST].path = "/fast/";
+
+    routes[ROUTE_WAN].path = "/wan/";
+    routes[ROUTE_WAN].latency = (MockLatency){ MOCK_LATENCY_NORMAL, 20, 5, 5, 40 };
+
+    routes[ROUTE_OVERLOADED].path = "/overloaded/";
+    routes[ROUTE_OVERLOADED].burst_length = 2;
+    routes[ROUTE_OVERLOADED].burst_every = 3;
+
+    routes[ROUTE_HANG].path = "/hang/";
+    routes[ROUTE_HANG].hang_rate = 1.0;
+
+    routes[ROUTE_DRIP].path = "/drip/";
+    routes[ROUTE_DRIP].drip_bytes = 8;
+    routes[ROUTE_DRIP].drip_interval_ms = 400;
+
+    routes[ROUTE_THROTTLED].path = "/throttled/";
+    routes[ROUTE_THROTTLED].body = g_large_body;
+    routes[ROUTE_THROTTLED].body_size = g_large_size;
+    routes[ROUTE_THROTTLED].bytes_per_sec = 32768;
+
+    /* Cellular link on a bad day */
+    routes[ROUTE_DEGRADED].path = "/degraded/";
+    routes[ROUTE_DEGRADED].latency = (MockLatency){ MOCK_LATENCY_EXPONENTIAL, 150, 0, 20, 800 };
+    routes[ROUTE_DEGRADED].bytes_per_sec = 4096;
+    routes[ROUTE_DEGRADED].burst_length = 1;
+    routes[ROUTE_DEGRADED].burst_every = 4;
+}
+
+static char* read_fixture(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = n > 0 ? malloc((size_t)n + 1) : NULL;
+    if (data && fread(data, 1, (size_t)n, f) == (size_t)n) {
+        data[n] = '\0';
+        *size = (size_t)n;
+    } else {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+static ApiClient* create_client(int timeout_seconds, int max_retries) {
+    ApiClientConfig config = api_client_default_config();
+    config.timeout_seconds = timeout_seconds;
+    config.max_retries = max_retries;
+    config.initial_backoff_ms = 20;
+    config.lane_slots[API_PRIORITY_SCHEDULED] = BENCH_THREADS;
+    return api_client_create(&config);
+}
+
+/* Throughput */
+
+typedef struct {
+    ApiClient* client;
+    const char* url;
+    long iterations;
+    int failures;
+} Worker;
+
+static void* request_worker(void* arg) {
+    Worker* w = arg;
+    for (long i = 0; i < w->iterations; i++) {
+        ApiResponse response;
+        ApiClientError err = api_client_request(w->client, HTTP_METHOD_GET, w->url,
+                                                NULL, &response);
+        if (err != API_CLIENT_SUCCESS || response.size != g_fixture_size ||
+            memcmp(response.data, g_fixture, response.size) != 0) {
+            w->failures++;
+        }
+        api_response_cleanup(&response);
+    }
+    return NULL;
+}
+
+static int run_workers(ApiClient* client, const char* url, int threads, long iterations,
+                       const char* name, const char* param) {
+    pthread_t tids[BENCH_THREADS];
+    Worker workers[BENCH_THREADS];
+    int failures = 0;
+
+    uint64_t start = bench_now_ns();
+    for (int t = 0; t < threads; t++) {
+        workers[t] = (Worker){ client, url, iterations, 0 };
+        pthread_create(&tids[t], NULL, request_worker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        STRESS_CHECK(failures, workers[t].failures == 0,
+                     "%s: worker %d saw %d bad responses", name, t, workers[t].failures);
+    }
+    bench_report(name, param, iterations * threads, bench_now_ns() - start);
+    return failures;
+}
+
+static int bench_throughput(long iterations) {
+    int failures = 0;
+    char url[128];
+    ApiClient* client = create_client(5, 0);
+
+    mock_api_server_url(g_server, "/fast/", url, sizeof(url));
+    failures += run_workers(client, url, 1, iterations, "request_loopback", "threads=1");
+    failures += run_workers(client, url, BENCH_THREADS, iterations, "request_loopback", "threads=4");
+
+    /* Latency-bound: slots, not CPU, set the rate */
+    mock_api_server_url(g_server, "/wan/", url, sizeof(url));
+    long wan_iterations = iterations / 20 + 1;
+    failures += run_workers(client, url, 1, wan_iterations, "request_wan_20ms", "threads=1");
+    failures += run_workers(client, url, BENCH_THREADS, wan_iterations, "request_wan_20ms", "threads=4");
+
+    api_client_destroy(client);
+    return failures;
+}
+
+/* Faults */
+
+static int bench_retries(long iterations) {
+    int failures = 0;
+    char url[128];
+    mock_api_server_url(g_server, "/overloaded/", url, sizeof(url));
+
+    /* Two 503s in every three requests: each call needs exactly 3 attempts */
+    ApiClient* client = create_client(5, 3);
+    mock_api_server_reset_stats(g_server);
+    long n = iterations / 50 + 1;
+    failures += run_workers(client, url, 1, n, "retry_5xx_burst", "2 of 3 fail");
+
+    MockServerStats stats;
+    mock_api_server_get_stats(g_server, &stats);
+    STRESS_CHECK(failures, stats.requests == (uint64_t)n * 3,
+                 "expected %ld attempts for %ld requests, server saw %llu",
+                 n * 3, n, (unsigned long long)stats.requests);
+    api_client_destroy(client);
+
+    /* Without retries the burst surfaces as an error */
+    client = create_client(5, 0);
+    mock_api_server_reset_stats(g_server);
+    ApiResponse response;
+    ApiClientError err = api_client_request(client, HTTP_METHOD_GET, url, NULL, &response);
+    STRESS_CHECK(failures, err == API_CLIENT_ERROR_NETWORK && response.http_code == 503,
+                 "unretried burst returned %s / HTTP %ld",
+                 api_client_error_string(err), response.http_code);
+    api_response_cleanup(&response);
+    api_client_destroy(client);
+    return failures;
+}
+
+static int bench_timeouts(void) {
+    int failures = 0;
+    char url[128];
+    ApiClient* client = create_client(1, 0);
+
+    const char* paths[] = { "/hang/", "/drip/" };
+    const char* names[] = { "timeout_no_response", "timeout_drip_body" };
+    for (int i = 0; i < 2; i++) {
+        mock_api_server_url(g_server, paths[i], url, sizeof(url));
+        ApiResponse response;
+        uint64_t start = bench_now_ns();
+        ApiClientError err = api_client_request(client, HTTP_METHOD_GET, url, NULL, &response);
+        uint64_t elapsed = bench_now_ns() - start;
+        bench_report(names[i], "timeout=1s", 1, elapsed);
+        STRESS_CHECK(failures, err == API_CLIENT_ERROR_TIMEOUT,
+                     "%s returned %s", names[i], api_client_error_string(err));
+        STRESS_CHECK(failures, elapsed < 2500000000ull,
+                     "%s took %.0f ms to time out", names[i], (double)elapsed / 1e6);
+        api_response_cleanup(&response);
+    }
+
+    /* The lane is free again straight away */
+    mock_api_server_url(g_server, "/fast/", url, sizeof(url));
+    failures += run_workers(client, url, 1, 1, "request_after_timeout", "");
+
+    api_client_destroy(client);
+    return failures;
+}
+
+static int bench_throttle(void) {
+    int failures = 0;
+    char url[128];
+    ApiClient* client = create_client(10, 0);
+    mock_api_server_url(g_server, "/throttled/", url, sizeof(url));
+
+    ApiResponse response;
+    uint64_t start = bench_now_ns();
+    ApiClientError err = api_client_request(client, HTTP_METHOD_GET, url, NULL, &response);
+    uint64_t elapsed = bench_now_ns() - start;
+
+    double expected_s = (double)g_large_size / 32768.0;
+    char param[32];
+    snprintf(param, sizeof(param), "%zuB@32KB/s", g_large_size);
+    bench_report("throttled_body", param, 1, elapsed);
+    STRESS_CHECK(failures, err == API_CLIENT_SUCCESS && response.size == g_large_size &&
+                 memcmp(response.data, g_large_body, g_large_size) == 0,
+                 "throttled body corrupted or failed: %s", api_client_error_string(err));
+    STRESS_CHECK(failures, (double)elapsed / 1e9 > expected_s * 0.8 &&
+                 (double)elapsed / 1e9 < expected_s * 1.5 + 0.5,
+                 "throttled body took %.2f s, expected ~%.2f s",
+                 (double)elapsed / 1e9, expected_s);
+    STRESS_CHECK(failures, response.bytes_received > g_large_size,
+                 "bytes_received %llu does not include headers",
+                 (unsigned long long)response.bytes_received);
+
+    api_response_cleanup(&response);
+    api_client_destroy(client);
+    return failures;
+}
+
+/* Main loop */
+
+static atomic_int g_data_callbacks;
+static atomic_int g_error_callbacks;
+
+static void on_data(const UserData* data, void* context) {
+    (void)context;
+    if (data->is_valid && data->name[0]) {
+        atomic_fetch_add(&g_data_callbacks, 1);
+    }
+}
+
+static void on_error(ApiError error, const char* message, void* context) {
+    (void)error; (void)message; (void)context;
+    atomic_fetch_add(&g_error_callbacks, 1);
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* 60 Hz loop driving auto-refresh against the degraded route; the API
+ * work on the loop thread must stay far inside the frame budget */
+static int bench_main_loop(int seconds) {
+    int failures = 0;
+    char url[128];
+    mock_api_server_url(g_server, "/degraded/", url, sizeof(url));
+
+    ApiManagerConfig config = api_manager_default_config();
+    config.base_url = url;
+    config.timeout_seconds = 2;
+    config.retry_count = 1;
+    config.retry_delay_ms = 50;
+    config.auto_refresh = true;
+    config.refresh_interval_ms = 100;
+
+    ApiManager* manager = api_manager_create(&config);
+    if (!manager) {
+        fprintf(stderr, "Failed to create API manager\n");
+        return 1;
+    }
+    api_manager_set_data_callback(manager, on_data, NULL);
+    api_manager_set_error_callback(manager, on_error, NULL);
+    atomic_store(&g_data_callbacks, 0);
+    atomic_store(&g_error_callbacks, 0);
+
+    int frames = seconds * 60;
+    uint32_t* work_us = malloc((size_t)frames * sizeof(uint32_t));
+    uint64_t loop_start = bench_now_ns();
+    api_manager_fetch_user_async(manager);
+
+    for (int f = 0; f < frames; f++) {
+        uint64_t frame_start = bench_now_ns();
+        uint32_t now_ms = (uint32_t)((frame_start - loop_start) / 1000000u);
+
+        /* Errors park the manager; the app retries on the next refresh */
+        if (api_manager_get_state(manager) == API_STATE_ERROR) {
+            api_manager_fetch_user_async(manager);
+        }
+        api_manager_update(manager, now_ms);
+
+        uint64_t work = bench_now_ns() - frame_start;
+        work_us[f] = (uint32_t)(work / 1000u);
+        if (work / 1000u < FRAME_BUDGET_US) {
+            usleep((useconds_t)(FRAME_BUDGET_US - work / 1000u));
+        }
+    }
+
+    qsort(work_us, (size_t)frames, sizeof(uint32_t), compare_u32);
+    uint32_t p50 = work_us[frames / 2];
+    uint32_t p99 = work_us[frames * 99 / 100];
+    uint32_t worst = work_us[frames - 1];
+    printf("%-32s %-20s p50 %6u us  p99 %6u us  max %6u us\n",
+           "main_loop_api_work", "degraded", p50, p99, worst);
+    printf("%-32s %-20s %d data, %d errors in %d s\n",
+           "main_loop_api_results", "", atomic_load(&g_data_callbacks),
+           atomic_load(&g_error_callbacks), seconds);
+
+    STRESS_CHECK(failures, worst < FRAME_BUDGET_US / 4,
+                 "API work blocked the main loop for %u us", worst);
+    STRESS_CHECK(failures, atomic_load(&g_data_callbacks) > 0,
+                 "no user data parsed from the degraded upstream");
+
+    api_manager_destroy(manager);
+    free(work_us);
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_api_client");
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    const char* fixture = argc > 2 ? argv[2] : "api/fixtures/randomuser.json";
+    g_fixture = read_fixture(fixture, &g_fixture_size);
+    if (!g_fixture) {
+        fprintf(stderr, "Cannot read fixture %s\n", fixture);
+        return 1;
+    }
+    g_large_size = 48 * 1024;
+    g_large_body = malloc(g_large_size);
+    for (size_t i = 0; i < g_large_size; i++) {
+        g_large_body[i] = g_fixture[i % g_fixture_size];
+    }
+
+    MockRoute routes[ROUTE_COUNT];
+    build_routes(routes);
+    g_server = mock_api_server_start(routes, ROUTE_COUNT, 0, 1);
+    if (!g_server) {
+        fprintf(stderr, "Failed to start mock API server\n");
+        return 1;
+    }
+
+    long iterations = bench_iterations() / 100 + 1;
+    int failures = 0;
+
+    bench_header("api_client (mock server)");
+    failures += bench_throughput(iterations);
+    failures += bench_retries(iterations);
+    failures += bench_timeouts();
+    failures += bench_throttle();
+    failures += bench_main_loop(3);
+
+    mock_api_server_stop(g_server);
+    free(g_large_body);
+    free(g_fixture);
+    curl_global_cleanup();
+    logger_shutdown();
+
+    printf("%s (%d failures)\n", failures ? "BENCH FAILED" : "BENCH PASSED", failures);
+    return failures ? 1 : 0;
+}
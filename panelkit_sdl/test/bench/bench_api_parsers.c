@@ -0,0 +1,681 @@
+/**
+ * @file bench_api_parsers.c
+ * @brief JSON vs CBOR vs MessagePack response decoding
+ *
+ * Transcodes representative payloads from JSON into CBOR and MessagePack,
+ * then compares wire size and decode time:
+ *
+ *   randomuser  The recorded profile fixture through the registered
+ *               parsers (json_parser/jsmn vs binary field tables)
+ *   telemetry   256 sensor readings decoded into a struct array; the JSON
+ *               side is a hand-written jsmn token walk, the best case for
+ *               a tokenizing parser
+ *
+ * Also checks that every format decodes to the same result, that
+ * truncated and corrupted binary bodies are rejected without reading
+ * out of bounds, and that ApiManager negotiates and parses CBOR and
+ * MessagePack end to end against the mock API server.
+ *
+ * Requires libcurl; build with `make build-bench-api`.
+ */
+
+#include "bench_common.h"
+#include "../api/mock_api_server.h"
+#include "../../src/core/logger.h"
+#include "../../src/api/api_client.h"
+#include "../../src/api/api_manager.h"
+#include "../../src/api/api_parsers.h"
+#include "../../src/api/binary_reader.h"
+#define JSMN_HEADER
+#include "../../src/json/jsmn.h"
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <curl/curl.h>
+
+#define TELEMETRY_READINGS 256
+
+/* Growable output buffer for the transcoders */
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+} Buffer;
+
+static void buf_put(Buffer* buf, const void* bytes, size_t n) {
+    if (buf->len + n > buf->cap) {
+        buf->cap = (buf->len + n) * 2;
+        buf->data = realloc(buf->data, buf->cap);
+        if (!buf->data) {
+            abort();
+        }
+    }
+    memcpy(buf->data + buf->len, bytes, n);
+    buf->len += n;
+}
+
+static void buf_byte(Buffer* buf, uint8_t b) {
+    buf_put(buf, &b, 1);
+}
+
+static void buf_be(Buffer* buf, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        buf_byte(buf, (uint8_t)(value >> (i * 8)));
+    }
+}
+
+/* Encoders: the subset of each format a JSON document needs */
+
+static void cbor_head(Buffer* buf, int major, uint64_t value) {
+    uint8_t m = (uint8_t)(major << 5);
+    if (value < 24) {
+        buf_byte(buf, m | (uint8_t)value);
+    } else if (value <= 0xff) {
+        buf_byte(buf, m | 24);
+        buf_be(buf, value, 1);
+    } else if (value <= 0xffff) {
+        buf_byte(buf, m | 25);
+        buf_be(buf, value, 2);
+    } else if (value <= 0xffffffffu) {
+        buf_byte(buf, m | 26);
+        buf_be(buf, value, 4);
+    } else {
+        buf_byte(buf, m | 27);
+        buf_be(buf, value, 8);
+    }
+}
+
+static void msgpack_sized(Buffer* buf, uint8_t fix, uint8_t fix_limit, uint8_t op8,
+                          uint8_t op16, uint8_t op32, size_t n) {
+    if (n < fix_limit) {
+        buf_byte(buf, fix | (uint8_t)n);
+    } else if (op8 && n <= 0xff) {
+        buf_byte(buf, op8);
+        buf_be(buf, n, 1);
+    } else if (n <= 0xffff) {
+        buf_byte(buf, op16);
+        buf_be(buf, n, 2);
+    } else {
+        buf_byte(buf, op32);
+        buf_be(buf, n, 4);
+    }
+}
+
+static void encode_int(Buffer* buf, BinaryFormat format, int64_t v) {
+    if (format == BINARY_FORMAT_CBOR) {
+        if (v >= 0) {
+            cbor_head(buf, 0, (uint64_t)v);
+        } else {
+            cbor_head(buf, 1, (uint64_t)(-1 - v));
+        }
+        return;
+    }
+    if (v >= 0 && v <= 127) {
+        buf_byte(buf, (uint8_t)v);
+    } else if (v < 0 && v >= -32) {
+        buf_byte(buf, (uint8_t)(int8_t)v);
+    } else if (v > 0) {
+        int bytes = v <= 0xff ? 1 : v <= 0xffff ? 2 : v <= 0xffffffffll ? 4 : 8;
+        buf_byte(buf, bytes == 1 ? 0xcc : bytes == 2 ? 0xcd : bytes == 4 ? 0xce : 0xcf);
+        buf_be(buf, (uint64_t)v, bytes);
+    } else {
+        int bytes = v >= INT8_MIN ? 1 : v >= INT16_MIN ? 2 : v >= INT32_MIN ? 4 : 8;
+        buf_byte(buf, bytes == 1 ? 0xd0 : bytes == 2 ? 0xd1 : bytes == 4 ? 0xd2 : 0xd3);
+        buf_be(buf, (uint64_t)v, bytes);
+    }
+}
+
+static void encode_double(Buffer* buf, BinaryFormat format, double v) {
+    float f = (float)v;
+    if ((double)f == v) {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        buf_byte(buf, format == BINARY_FORMAT_CBOR ? 0xfa : 0xca);
+        buf_be(buf, bits, 4);
+    } else {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        buf_byte(buf, format == BINARY_FORMAT_CBOR ? 0xfb : 0xcb);
+        buf_be(buf, bits, 8);
+    }
+}
+
+static void encode_string(Buffer* buf, BinaryFormat format, const char* s, size_t n) {
+    if (format == BINARY_FORMAT_CBOR) {
+        cbor_head(buf, 3, n);
+    } else {
+        msgpack_sized(buf, 0xa0, 32, 0xd9, 0xda, 0xdb, n);
+    }
+    buf_put(buf, s, n);
+}
+
+static void encode_container(Buffer* buf, BinaryFormat format, bool is_map, size_t n) {
+    if (format == BINARY_FORMAT_CBOR) {
+        cbor_head(buf, is_map ? 5 : 4, n);
+    } else if (is_map) {
+        msgpack_sized(buf, 0x80, 16, 0, 0xde, 0xdf, n);
+    } else {
+        msgpack_sized(buf, 0x90, 16, 0, 0xdc, 0xdd, n);
+    }
+}
+
+/* Re-encode one jsmn token (and its children); returns tokens consumed.
+ * Strings are copied raw: the fixtures contain no escape sequences. */
+static int transcode_token(Buffer* buf, BinaryFormat format, const char* json,
+                           const jsmntok_t* tok) {
+    const char* text = json + tok->start;
+    size_t len = (size_t)(tok->end - tok->start);
+    int used = 1;
+
+    switch (tok->type) {
+        case JSMN_OBJECT:
+        case JSMN_ARRAY: {
+            bool is_map = tok->type == JSMN_OBJECT;
+            encode_container(buf, format, is_map, (size_t)tok->size);
+            for (int i = 0; i < tok->size * (is_map ? 2 : 1); i++) {
+                used += transcode_token(buf, format, json, tok + used);
+            }
+            break;
+        }
+        case JSMN_STRING:
+            encode_string(buf, format, text, len);
+            break;
+        default:
+            if (text[0] == 't' || text[0] == 'f') {
+                bool b = text[0] == 't';
+                buf_byte(buf, format == BINARY_FORMAT_CBOR ? (b ? 0xf5 : 0xf4)
+                                                           : (b ? 0xc3 : 0xc2));
+            } else if (text[0] == 'n') {
+                buf_byte(buf, format == BINARY_FORMAT_CBOR ? 0xf6 : 0xc0);
+            } else if (memchr(text, '.', len) || memchr(text, 'e', len) || memchr(text, 'E', len)) {
+                encode_double(buf, format, strtod(text, NULL));
+            } else {
+                encode_int(buf, format, strtoll(text, NULL, 10));
+            }
+            break;
+    }
+    return used;
+}
+
+/* Tokenize JSON with a token array sized for the document */
+static int tokenize(const char* json, size_t len, jsmntok_t** tokens) {
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    int count = jsmn_parse(&parser, json, len, NULL, 0);
+    if (count <= 0) {
+        return count;
+    }
+    *tokens = malloc((size_t)count * sizeof(jsmntok_t));
+    jsmn_init(&parser);
+    return jsmn_parse(&parser, json, len, *tokens, (unsigned int)count);
+}
+
+static bool transcode(const char* json, size_t len, BinaryFormat format, Buffer* out) {
+    jsmntok_t* tokens = NULL;
+    int count = tokenize(json, len, &tokens);
+    if (count <= 0) {
+        free(tokens);
+        return false;
+    }
+    memset(out, 0, sizeof(*out));
+    transcode_token(out, format, json, tokens);
+    free(tokens);
+    return true;
+}
+
+/* Payloads */
+
+typedef struct {
+    const char* json;
+    size_t json_size;
+    Buffer cbor;
+    Buffer msgpack;
+} Payload;
+
+static bool payload_init(Payload* payload, const char* json, size_t json_size) {
+    payload->json = json;
+    payload->json_size = json_size;
+    return transcode(json, json_size, BINARY_FORMAT_CBOR, &payload->cbor) &&
+           transcode(json, json_size, BINARY_FORMAT_MSGPACK, &payload->msgpack);
+}
+
+static void payload_free(Payload* payload) {
+    free(payload->cbor.data);
+    free(payload->msgpack.data);
+}
+
+static void report_sizes(const char* name, const Payload* payload) {
+    printf("%-32s %-20s %8zu B json %8zu B cbor (%3.0f%%) %8zu B msgpack (%3.0f%%)\n",
+           name, "wire_size", payload->json_size,
+           payload->cbor.len, 100.0 * (double)payload->cbor.len / (double)payload->json_size,
+           payload->msgpack.len, 100.0 * (double)payload->msgpack.len / (double)payload->json_size);
+}
+
+static char* read_fixture(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = n > 0 ? malloc((size_t)n + 1) : NULL;
+    if (data && fread(data, 1, (size_t)n, f) == (size_t)n) {
+        data[n] = '\0';
+        *size = (size_t)n;
+    } else {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+/* --- randomuser: the registered parsers ----------------------------- */
+
+static int bench_randomuser(const Payload* payload, long iterations) {
+    int failures = 0;
+    static const struct {
+        const char* param;
+        ApiPayloadFormat format;
+    } cases[] = {
+        { "json", API_FORMAT_JSON },
+        { "cbor", API_FORMAT_CBOR },
+        { "msgpack", API_FORMAT_MSGPACK }
+    };
+
+    UserData expected = {0};
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const char* data = payload->json;
+        size_t size = payload->json_size;
+        if (cases[c].format == API_FORMAT_CBOR) {
+            data = (const char*)payload->cbor.data;
+            size = payload->cbor.len;
+        } else if (cases[c].format == API_FORMAT_MSGPACK) {
+            data = (const char*)payload->msgpack.data;
+            size = payload->msgpack.len;
+        }
+
+        api_parser_func parse = api_parsers_get_format("randomuser", "get_user", cases[c].format);
+        STRESS_CHECK(failures, parse != NULL, "no %s parser registered", cases[c].param);
+        if (!parse) {
+            continue;
+        }
+
+        UserData user = {0};
+        bool ok = parse(data, size, NULL, NULL, &user);
+        STRESS_CHECK(failures, ok, "%s parse failed", cases[c].param);
+        if (c == 0) {
+            expected = user;
+            STRESS_CHECK(failures, strcmp(user.name, "Ella Vidal") == 0 && user.age > 0,
+                         "unexpected JSON result '%s' age %d", user.name, user.age);
+        } else {
+            STRESS_CHECK(failures, memcmp(&user, &expected, sizeof(user)) == 0,
+                         "%s result differs from JSON ('%s' vs '%s')",
+                         cases[c].param, user.name, expected.name);
+        }
+
+        uint64_t start = bench_now_ns();
+        for (long i = 0; i < iterations; i++) {
+            UserData out = {0};
+            parse(data, size, NULL, NULL, &out);
+        }
+        bench_report("parse_randomuser", cases[c].param, iterations, bench_now_ns() - start);
+    }
+    return failures;
+}
+
+/* --- telemetry: records into a struct array ------------------------- */
+
+typedef struct {
+    char id[16];
+    int64_t ts;
+    double value;
+    int quality;
+    bool ok;
+} Reading;
+
+static const BinaryField reading_fields[] = {
+    { "id", BINARY_FIELD_STRING, offsetof(Reading, id), sizeof(((Reading*)0)->id), NULL, 0 },
+    { "ts", BINARY_FIELD_INT64, offsetof(Reading, ts), 0, NULL, 0 },
+    { "value", BINARY_FIELD_DOUBLE, offsetof(Reading, value), 0, NULL, 0 },
+    { "quality", BINARY_FIELD_INT, offsetof(Reading, quality), 0, NULL, 0 },
+    { "ok", BINARY_FIELD_BOOL, offsetof(Reading, ok), 0, NULL, 0 }
+};
+
+static char* build_telemetry_json(size_t* size) {
+    size_t cap = TELEMETRY_READINGS * 96 + 64;
+    char* json = malloc(cap);
+    size_t n = (size_t)snprintf(json, cap, "{\"device\":\"panel-01\",\"readings\":[");
+    for (int i = 0; i < TELEMETRY_READINGS; i++) {
+        n += (size_t)snprintf(json + n, cap - n,
+                              "%s{\"id\":\"sensor-%03d\",\"ts\":%lld,\"value\":%.3f,"
+                              "\"quality\":%d,\"ok\":%s}",
+                              i ? "," : "", i % 32, 1760000000000ll + i * 250ll,
+                              20.0 + (i % 97) * 0.125, 90 + i % 10, i % 13 ? "true" : "false");
+    }
+    n += (size_t)snprintf(json + n, cap - n, "]}");
+    *size = n;
+    return json;
+}
+
+static bool token_is(const char* json, const jsmntok_t* tok, const char* key) {
+    size_t len = (size_t)(tok->end - tok->start);
+    return tok->type == JSMN_STRING && strlen(key) == len &&
+           memcmp(json + tok->start, key, len) == 0;
+}
+
+static int skip_json(const jsmntok_t* tok) {
+    int used = 1;
+    int children = tok->type == JSMN_OBJECT ? tok->size * 2 :
+                   tok->type == JSMN_ARRAY ? tok->size : 0;
+    for (int i = 0; i < children; i++) {
+        used += skip_json(tok + used);
+    }
+    return used;
+}
+
+/* Tokenize, then walk the tokens into records: what a JSON decoder has
+ * to do at minimum. Returns the number of readings decoded. */
+static int decode_telemetry_json(const char* json, size_t size, jsmntok_t* tokens,
+                                 unsigned int max_tokens, Reading* out) {
+    jsmn_parser parser;
+    jsmn_init(&parser);
+    if (jsmn_parse(&parser, json, size, tokens, max_tokens) <= 0 ||
+        tokens[0].type != JSMN_OBJECT) {
+        return -1;
+    }
+
+    int count = 0;
+    int t = 1;
+    for (int k = 0; k < tokens[0].size; k++) {
+        if (!token_is(json, &tokens[t], "readings") || tokens[t + 1].type != JSMN_ARRAY) {
+            t += 1 + skip_json(&tokens[t + 1]);
+            continue;
+        }
+        int items = tokens[t + 1].size;
+        t += 2;
+        for (int i = 0; i < items && count < TELEMETRY_READINGS; i++) {
+            Reading* r = &out[count++];
+            int fields = tokens[t].size;
+            t++;
+            for (int f = 0; f < fields; f++) {
+                const jsmntok_t* key = &tokens[t];
+                const jsmntok_t* val = &tokens[t + 1];
+                const char* text = json + val->start;
+                if (token_is(json, key, "id")) {
+                    size_t len = (size_t)(val->end - val->start);
+                    len = len < sizeof(r->id) - 1 ? len : sizeof(r->id) - 1;
+                    memcpy(r->id, text, len);
+                    r->id[len] = '\0';
+                } else if (token_is(json, key, "ts")) {
+                    r->ts = strtoll(text, NULL, 10);
+                } else if (token_is(json, key, "value")) {
+                    r->value = strtod(text, NULL);
+                } else if (token_is(json, key, "quality")) {
+                    r->quality = (int)strtol(text, NULL, 10);
+                } else if (token_is(json, key, "ok")) {
+                    r->ok = text[0] == 't';
+                }
+                t += 1 + skip_json(val);
+            }
+        }
+    }
+    return count;
+}
+
+static int decode_telemetry_binary(BinaryFormat format, const Buffer* buf, Reading* out) {
+    BinaryReader reader;
+    size_t keys;
+    int count = 0;
+
+    binary_reader_init(&reader, format, buf->data, buf->len);
+    if (!binary_reader_map(&reader, &keys)) {
+        return -1;
+    }
+    for (size_t k = 0; k < keys; k++) {
+        const char* key;
+        size_t key_len;
+        size_t items;
+        if (!binary_reader_string(&reader, &key, &key_len)) {
+            return -1;
+        }
+        if (key_len != 8 || memcmp(key, "readings", 8) != 0) {
+            binary_reader_skip(&reader);
+            continue;
+        }
+        if (!binary_reader_array(&reader, &items)) {
+            return -1;
+        }
+        for (size_t i = 0; i < items; i++) {
+            if (count >= TELEMETRY_READINGS) {
+                binary_reader_skip(&reader);
+            } else if (!binary_reader_decode_map(&reader, reading_fields,
+                                                 sizeof(reading_fields) / sizeof(reading_fields[0]),
+                                                 &out[count++])) {
+                return -1;
+            }
+        }
+    }
+    return binary_reader_failed(&reader) ? -1 : count;
+}
+
+static int bench_telemetry(const Payload* payload, long iterations) {
+    int failures = 0;
+    Reading* expected = calloc(TELEMETRY_READINGS, sizeof(Reading));
+    Reading* readings = calloc(TELEMETRY_READINGS, sizeof(Reading));
+    unsigned int max_tokens = TELEMETRY_READINGS * 11 + 8;
+    jsmntok_t* tokens = malloc(max_tokens * sizeof(jsmntok_t));
+
+    int n = decode_telemetry_json(payload->json, payload->json_size, tokens, max_tokens, expected);
+    STRESS_CHECK(failures, n == TELEMETRY_READINGS, "JSON decoded %d readings", n);
+
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        decode_telemetry_json(payload->json, payload->json_size, tokens, max_tokens, readings);
+    }
+    bench_report("parse_telemetry", "json (jsmn walk)", iterations, bench_now_ns() - start);
+
+    static const struct {
+        const char* param;
+        BinaryFormat format;
+    } cases[] = {
+        { "cbor", BINARY_FORMAT_CBOR },
+        { "msgpack", BINARY_FORMAT_MSGPACK }
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const Buffer* buf = cases[c].format == BINARY_FORMAT_CBOR ? &payload->cbor : &payload->msgpack;
+
+        memset(readings, 0, TELEMETRY_READINGS * sizeof(Reading));
+        n = decode_telemetry_binary(cases[c].format, buf, readings);
+        STRESS_CHECK(failures, n == TELEMETRY_READINGS, "%s decoded %d readings", cases[c].param, n);
+        for (int i = 0; i < TELEMETRY_READINGS && n == TELEMETRY_READINGS; i++) {
+            const Reading* a = &readings[i];
+            const Reading* b = &expected[i];
+            if (strcmp(a->id, b->id) != 0 || a->ts != b->ts || a->value != b->value ||
+                a->quality != b->quality || a->ok != b->ok) {
+                STRESS_CHECK(failures, false, "%s reading %d differs from JSON", cases[c].param, i);
+                break;
+            }
+        }
+
+        start = bench_now_ns();
+        for (long i = 0; i < iterations; i++) {
+            decode_telemetry_binary(cases[c].format, buf, readings);
+        }
+        bench_report("parse_telemetry", cases[c].param, iterations, bench_now_ns() - start);
+    }
+
+    free(tokens);
+    free(readings);
+    free(expected);
+    return failures;
+}
+
+/* --- hostile input --------------------------------------------------- */
+
+/* Every truncation must be rejected, and single-byte corruption must
+ * never read past the buffer (run under ASan to make that visible).
+ * Each prefix is copied to its own allocation so overruns hit a redzone. */
+static int check_malformed(const char* name, ApiPayloadFormat format, const Buffer* buf) {
+    int failures = 0;
+    api_parser_func parse = api_parsers_get_format("randomuser", "get_user", format);
+    if (!parse) {
+        return 1;
+    }
+
+    /* Every case logs a decode error; keep them off the terminal */
+    fflush(stderr);
+    int saved_stderr = dup(STDERR_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDERR_FILENO);
+    close(devnull);
+
+    int rejected = 0;
+    for (size_t len = 0; len < buf->len; len++) {
+        char* copy = malloc(len + 1);
+        memcpy(copy, buf->data, len);
+        UserData user = {0};
+        rejected += !parse(copy, len, NULL, NULL, &user);
+        free(copy);
+    }
+
+    unsigned int seed = 1;
+    char* copy = malloc(buf->len);
+    for (int round = 0; round < 2000; round++) {
+        memcpy(copy, buf->data, buf->len);
+        seed = seed * 1103515245u + 12345u;
+        copy[(seed >> 8) % buf->len] ^= (char)(1u << ((seed >> 4) % 8));
+        UserData user = {0};
+        parse(copy, buf->len, NULL, NULL, &user);
+    }
+    free(copy);
+
+    fflush(stderr);
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+    STRESS_CHECK(failures, rejected == (int)buf->len,
+                 "%s accepted %d truncated bodies", name, (int)buf->len - rejected);
+
+    printf("%-32s %-20s %zu truncations, 2000 bit flips\n", "malformed_rejected", name, buf->len);
+    return failures;
+}
+
+/* --- end to end: negotiation through ApiManager ---------------------- */
+
+static int check_negotiation(const Payload* payload) {
+    int failures = 0;
+    MockRoute routes[3];
+    memset(routes, 0, sizeof(routes));
+    routes[0] = (MockRoute){ .path = "/json/", .body = payload->json,
+                             .body_size = payload->json_size };
+    routes[1] = (MockRoute){ .path = "/cbor/", .content_type = "application/cbor",
+                             .body = (const char*)payload->cbor.data,
+                             .body_size = payload->cbor.len };
+    routes[2] = (MockRoute){ .path = "/msgpack/", .content_type = "application/msgpack",
+                             .body = (const char*)payload->msgpack.data,
+                             .body_size = payload->msgpack.len };
+
+    MockApiServer* server = mock_api_server_start(routes, 3, 0, 1);
+    if (!server) {
+        fprintf(stderr, "Failed to start mock API server\n");
+        return 1;
+    }
+
+    UserData expected = {0};
+    for (int r = 0; r < 3; r++) {
+        char url[128];
+        mock_api_server_url(server, routes[r].path, url, sizeof(url));
+
+        ApiManagerConfig config = api_manager_default_config();
+        config.base_url = url;
+        config.retry_count = 0;
+        config.accept = API_PARSERS_ACCEPT_BINARY;
+        ApiManager* manager = api_manager_create(&config);
+
+        bool ok = manager && api_manager_fetch_user(manager) &&
+                  api_manager_get_state(manager) == API_STATE_SUCCESS;
+        STRESS_CHECK(failures, ok, "ApiManager fetch from %s failed", routes[r].path);
+        if (ok) {
+            const UserData* user = api_manager_get_user_data(manager);
+            if (r == 0) {
+                expected = *user;
+            } else {
+                STRESS_CHECK(failures, memcmp(user, &expected, sizeof(expected)) == 0,
+                             "%s user differs from JSON", routes[r].path);
+            }
+        }
+        api_manager_destroy(manager);
+
+        /* What actually crossed the link, headers included */
+        ApiClientConfig client_config = api_client_default_config();
+        client_config.accept = API_PARSERS_ACCEPT_BINARY;
+        ApiClient* client = api_client_create(&client_config);
+        ApiResponse response;
+        api_client_request(client, HTTP_METHOD_GET, url, NULL, &response);
+        ApiPayloadFormat format = api_payload_format_from_content_type(response.content_type);
+        STRESS_CHECK(failures, response.size == routes[r].body_size &&
+                     format == (ApiPayloadFormat)r,
+                     "%s: %zu bytes as %s", routes[r].path, response.size,
+                     api_payload_format_string(format));
+        printf("%-32s %-20s %8llu B received (%s)\n", "negotiated_fetch",
+               api_payload_format_string(format), (unsigned long long)response.bytes_received,
+               response.content_type ? response.content_type : "no content type");
+        api_response_cleanup(&response);
+        api_client_destroy(client);
+    }
+
+    mock_api_server_stop(server);
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_api_parsers");
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    api_parsers_init();
+
+    const char* fixture = argc > 2 ? argv[2] : "api/fixtures/randomuser.json";
+    size_t user_size = 0;
+    char* user_json = read_fixture(fixture, &user_size);
+    if (!user_json) {
+        fprintf(stderr, "Cannot read fixture %s\n", fixture);
+        return 1;
+    }
+    size_t telemetry_size = 0;
+    char* telemetry_json = build_telemetry_json(&telemetry_size);
+
+    Payload user;
+    Payload telemetry;
+    if (!payload_init(&user, user_json, user_size) ||
+        !payload_init(&telemetry, telemetry_json, telemetry_size)) {
+        fprintf(stderr, "Failed to transcode payloads\n");
+        return 1;
+    }
+
+    long iterations = bench_iterations() / 10 + 1;
+    int failures = 0;
+
+    bench_header("api_parsers (randomuser profile)");
+    report_sizes("randomuser", &user);
+    failures += bench_randomuser(&user, iterations);
+
+    bench_header("api_parsers (256 telemetry records)");
+    report_sizes("telemetry", &telemetry);
+    failures += bench_telemetry(&telemetry, iterations / 10 + 1);
+
+    bench_header("api_parsers (robustness and negotiation)");
+    failures += check_malformed("cbor", API_FORMAT_CBOR, &user.cbor);
+    failures += check_malformed("msgpack", API_FORMAT_MSGPACK, &user.msgpack);
+    failures += check_negotiation(&user);
+
+    payload_free(&user);
+    payload_free(&telemetry);
+    free(telemetry_json);
+    free(user_json);
+    api_parsers_cleanup();
+    curl_global_cleanup();
+    logger_shutdown();
+
+    printf("%s (%d failures)\n", failures ? "BENCH FAILED" : "BENCH PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,511 @@
+/**
+ * @file bench_asset_bundle.c
+ * @brief Asset bundle startup cost, memory footprint and integrity checks
+ *
+ * Measures, for a font-sized stored asset and a set of deflated skin
+ * images:
+ * - reading the font into the heap (what loading it from a file costs)
+ *   versus opening the bundle and getting the font in place
+ * - bundle open (index validation) with 1000 entries
+ * - lookup of a stored entry, first use of a deflated entry (inflate and
+ *   hash) and later, cached gets
+ * - anonymous (private) and file-backed RSS after touching the font as a
+ *   heap copy versus through the mapping
+ *
+ * Then checks:
+ * - every asset round-trips byte for byte, stored and deflated, with its
+ *   content hash; stored gets point into the mapping and repeat gets of
+ *   a deflated asset share one buffer
+ * - a bundle appended to another file opens, leaves that file's bytes
+ *   alone and keeps entry data aligned
+ * - a flipped byte in deflated data fails the get, one in stored data
+ *   fails verify, and truncated, out-of-bounds or overlong-name indexes
+ *   are refused
+ * - threads racing for a deflated asset inflate it once
+ *
+ * Uses fonts/font-sans-regular.ttf when run from test/, else generated
+ * data. Exit status is non-zero if any check fails.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/core/asset_bundle.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define FONT_PATH "../fonts/font-sans-regular.ttf"
+#define GENERATED_FONT_SIZE (300 * 1024)
+#define SKIN_COUNT 19
+#define SKIN_SIDE 64
+#define MANY_ENTRIES 1000
+#define RACE_THREADS 4
+
+static int failures;
+static char bundle_path[128];
+static char many_path[128];
+static char exe_path[128];
+
+static uint8_t* font;
+static size_t font_size;
+static uint8_t* skins[SKIN_COUNT];
+static const size_t skin_size = SKIN_SIDE * SKIN_SIDE * 4;
+
+/* Resident memory split as /proc reports it, in kB */
+static void read_rss(long* anon_kb, long* file_kb) {
+    *anon_kb = *file_kb = 0;
+    FILE* file = fopen("/proc/self/status", "r");
+    if (!file) {
+        return;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        sscanf(line, "RssAnon: %ld", anon_kb);
+        sscanf(line, "RssFile: %ld", file_kb);
+    }
+    fclose(file);
+}
+
+static uint8_t* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = length > 0 ? malloc((size_t)length) : NULL;
+    if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    *size = data ? (size_t)length : 0;
+    return data;
+}
+
+static void write_file(const char* path, const void* data, size_t size) {
+    FILE* file = fopen(path, "wb");
+    if (file) {
+        fwrite(data, 1, size, file);
+        fclose(file);
+    }
+}
+
+/* Real font if available; otherwise bytes that deflate about as poorly */
+static void make_fixtures(void) {
+    font = read_file(FONT_PATH, &font_size);
+    if (!font) {
+        font_size = GENERATED_FONT_SIZE;
+        font = malloc(font_size);
+        uint32_t x = 12345;
+        for (size_t i = 0; i < font_size; i++) {
+            x = x * 1103515245u + 12345u;
+            font[i] = (uint8_t)((x >> 16) & (i % 3 ? 0xff : 0x0f));
+        }
+    }
+
+    /* Gradient BMP-like images: the kind of data skins deflate well */
+    for (int s = 0; s < SKIN_COUNT; s++) {
+        skins[s] = malloc(skin_size);
+        for (size_t i = 0; i < skin_size; i += 4) {
+            size_t y = (i / 4) / SKIN_SIDE;
+            skins[s][i] = (uint8_t)(y * 3 + (size_t)s);
+            skins[s][i + 1] = (uint8_t)(y * 2);
+            skins[s][i + 2] = (uint8_t)(128 + s);
+            skins[s][i + 3] = 255;
+        }
+    }
+}
+
+static bool build_bundle(const char* path, bool append) {
+    AssetBundleWriter* writer = asset_bundle_writer_create();
+    bool ok = writer && asset_bundle_writer_add(writer, ASSET_BUNDLE_FONT_REGULAR, font,
+                                                font_size, 0);
+    for (int s = 0; ok && s < SKIN_COUNT; s++) {
+        char name[64];
+        snprintf(name, sizeof(name), "skins/image_%02d.bmp", s);
+        ok = asset_bundle_writer_add(writer, name, skins[s], skin_size, 9);
+    }
+    ok = ok && asset_bundle_writer_save(writer, path, append);
+    if (!ok) {
+        fprintf(stderr, "Bundle build failed: %s\n", pk_get_last_error_context());
+    }
+    asset_bundle_writer_destroy(writer);
+    return ok;
+}
+
+static bool build_many(const char* path) {
+    AssetBundleWriter* writer = asset_bundle_writer_create();
+    bool ok = writer != NULL;
+    for (int i = 0; ok && i < MANY_ENTRIES; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "icons/%04d.bmp", i);
+        ok = asset_bundle_writer_add(writer, name, skins[i % SKIN_COUNT], 256, 0);
+    }
+    ok = ok && asset_bundle_writer_save(writer, path, false);
+    asset_bundle_writer_destroy(writer);
+    return ok;
+}
+
+static volatile uint64_t sink;
+
+static void bench_startup(long iterations) {
+    bench_header("Asset bundle (startup)");
+    long rounds = iterations / 1000 > 20 ? iterations / 1000 : 20;
+
+    /* Both read every font byte once (hashing stands in for FreeType) */
+    char font_file[160];
+    snprintf(font_file, sizeof(font_file), "%s.font", bundle_path);
+    write_file(font_file, font, font_size);
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < rounds; i++) {
+        size_t size;
+        uint8_t* data = read_file(font_file, &size);
+        sink += data ? asset_bundle_hash(data, size) : 0;
+        free(data);
+    }
+    bench_report("font: read file into heap", "copy", rounds, bench_now_ns() - start);
+    unlink(font_file);
+
+    start = bench_now_ns();
+    for (long i = 0; i < rounds; i++) {
+        AssetBundle* bundle = asset_bundle_open(bundle_path);
+        AssetView view;
+        if (bundle && asset_bundle_get(bundle, ASSET_BUNDLE_FONT_REGULAR, &view)) {
+            sink += asset_bundle_hash(view.data, view.size);
+        }
+        asset_bundle_close(bundle);
+    }
+    bench_report("font: open bundle + get", "zero copy", rounds, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long i = 0; i < rounds; i++) {
+        asset_bundle_close(asset_bundle_open(many_path));
+    }
+    bench_report("open (validate index)", "1000 entries", rounds, bench_now_ns() - start);
+
+    AssetBundle* many = asset_bundle_open(many_path);
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "icons/%04ld.bmp", i % MANY_ENTRIES);
+        AssetView view;
+        sink += asset_bundle_get(many, name, &view) ? view.size : 0;
+    }
+    bench_report("get stored", "1000 entries", iterations, bench_now_ns() - start);
+    asset_bundle_close(many);
+
+    /* First use inflates and hashes; each round reopens to start cold */
+    uint64_t first_ns = 0;
+    for (long i = 0; i < rounds; i++) {
+        AssetBundle* bundle = asset_bundle_open(bundle_path);
+        AssetView view;
+        start = bench_now_ns();
+        sink += asset_bundle_get(bundle, "skins/image_07.bmp", &view) ? view.size : 0;
+        first_ns += bench_now_ns() - start;
+        asset_bundle_close(bundle);
+    }
+    bench_report("get deflated, first use", "16 KB image", rounds, first_ns);
+
+    AssetBundle* bundle = asset_bundle_open(bundle_path);
+    AssetView view;
+    asset_bundle_get(bundle, "skins/image_07.bmp", &view);
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        sink += asset_bundle_get(bundle, "skins/image_07.bmp", &view) ? view.size : 0;
+    }
+    bench_report("get deflated, cached", "16 KB image", iterations, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long i = 0; i < 20; i++) {
+        sink += asset_bundle_verify(bundle);
+    }
+    bench_report("verify (hash everything)", "20 entries", 20, bench_now_ns() - start);
+    asset_bundle_close(bundle);
+}
+
+/* Touching the font through the mapping must not grow private memory */
+static void check_footprint(void) {
+    long anon0, file0, anon1, file1, anon2, file2;
+
+    /* A fresh anonymous mapping: malloc could reuse pages already resident */
+    read_rss(&anon0, &file0);
+    uint8_t* copy = mmap(NULL, font_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (copy == MAP_FAILED) {
+        failures++;
+        return;
+    }
+    memcpy(copy, font, font_size);
+    sink += asset_bundle_hash(copy, font_size);
+    read_rss(&anon1, &file1);
+
+    AssetBundle* bundle = asset_bundle_open(bundle_path);
+    AssetView view;
+    bool got = bundle && asset_bundle_get(bundle, ASSET_BUNDLE_FONT_REGULAR, &view);
+    if (got) {
+        sink += asset_bundle_hash(view.data, view.size);
+    }
+    read_rss(&anon2, &file2);
+
+    printf("%-32s %-20s anon %+6ld kB, file %+6ld kB\n", "touch font", "heap copy",
+           anon1 - anon0, file1 - file0);
+    printf("%-32s %-20s anon %+6ld kB, file %+6ld kB\n", "touch font", "bundle mapping",
+           anon2 - anon1, file2 - file1);
+
+    STRESS_CHECK(failures, got, "font get failed: %s", pk_get_last_error_context());
+    STRESS_CHECK(failures, anon2 - anon1 < 64,
+                 "mapped font grew private memory by %ld kB", anon2 - anon1);
+    STRESS_CHECK(failures, file2 - file1 >= (long)(font_size / 1024) / 2,
+                 "mapped font not counted as file-backed (%ld kB)", file2 - file1);
+    STRESS_CHECK(failures, anon1 - anon0 >= (long)(font_size / 1024) / 2,
+                 "heap copy baseline not counted (%ld kB)", anon1 - anon0);
+    asset_bundle_close(bundle);
+    munmap(copy, font_size);
+}
+
+static void check_contents(const char* path, const char* label) {
+    AssetBundle* bundle = asset_bundle_open(path);
+    STRESS_CHECK(failures, bundle != NULL, "%s: open failed: %s", label,
+                 pk_get_last_error_context());
+    if (!bundle) {
+        return;
+    }
+    STRESS_CHECK(failures, asset_bundle_count(bundle) == SKIN_COUNT + 1,
+                 "%s: %u entries", label, asset_bundle_count(bundle));
+
+    AssetView view, again;
+    bool got = asset_bundle_get(bundle, ASSET_BUNDLE_FONT_REGULAR, &view) &&
+               asset_bundle_get(bundle, ASSET_BUNDLE_FONT_REGULAR, &again);
+    STRESS_CHECK(failures, got && view.size == font_size &&
+                 memcmp(view.data, font, font_size) == 0, "%s: font differs", label);
+    STRESS_CHECK(failures, got && view.data == again.data &&
+                 (uintptr_t)view.data % ASSET_BUNDLE_ALIGN == 0,
+                 "%s: stored font not served in place, aligned", label);
+    STRESS_CHECK(failures, got && view.hash == asset_bundle_hash(font, font_size),
+                 "%s: font hash mismatch", label);
+
+    int deflated = 0;
+    for (uint32_t i = 0; i < asset_bundle_count(bundle); i++) {
+        AssetInfo info;
+        asset_bundle_info(bundle, i, &info);
+        deflated += info.compression == ASSET_COMPRESSION_DEFLATE;
+    }
+    STRESS_CHECK(failures, deflated == SKIN_COUNT, "%s: %d skins deflated", label, deflated);
+
+    for (int s = 0; s < SKIN_COUNT; s++) {
+        char name[64];
+        snprintf(name, sizeof(name), "skins/image_%02d.bmp", s);
+        got = asset_bundle_get(bundle, name, &view) && asset_bundle_get(bundle, name, &again);
+        STRESS_CHECK(failures, got && view.size == skin_size &&
+                     memcmp(view.data, skins[s], skin_size) == 0, "%s: %s differs", label, name);
+        STRESS_CHECK(failures, got && view.data == again.data,
+                     "%s: %s inflated twice", label, name);
+    }
+
+    AssetBundleStats stats;
+    asset_bundle_get_stats(bundle, &stats);
+    STRESS_CHECK(failures, stats.inflations == SKIN_COUNT &&
+                 stats.inflated_bytes == SKIN_COUNT * skin_size,
+                 "%s: %llu inflations, %llu bytes", label,
+                 (unsigned long long)stats.inflations, (unsigned long long)stats.inflated_bytes);
+    STRESS_CHECK(failures, asset_bundle_verify(bundle) == 0, "%s: verify failed", label);
+    STRESS_CHECK(failures, !asset_bundle_get(bundle, "fonts/missing.ttf", &view) &&
+                 pk_get_last_error() == PK_ERROR_NOT_FOUND &&
+                 !asset_bundle_contains(bundle, "fonts/missing.ttf"),
+                 "%s: missing asset not reported", label);
+    asset_bundle_close(bundle);
+}
+
+static void check_appended(void) {
+    uint8_t prefix[10007];
+    for (size_t i = 0; i < sizeof(prefix); i++) {
+        prefix[i] = (uint8_t)(i * 7);
+    }
+    write_file(exe_path, prefix, sizeof(prefix));
+    if (!build_bundle(exe_path, true)) {
+        failures++;
+        return;
+    }
+    check_contents(exe_path, "appended");
+
+    size_t size;
+    uint8_t* data = read_file(exe_path, &size);
+    STRESS_CHECK(failures, data && size > sizeof(prefix) &&
+                 memcmp(data, prefix, sizeof(prefix)) == 0, "appended: host file changed");
+    free(data);
+}
+
+/* Copy of the bundle file with one byte changed */
+static void write_damaged(const uint8_t* data, size_t size, size_t offset, uint8_t value,
+                          const char* path) {
+    uint8_t* copy = malloc(size);
+    memcpy(copy, data, size);
+    copy[offset] = value;
+    write_file(path, copy, size);
+    free(copy);
+}
+
+static void check_corruption(void) {
+    size_t size;
+    uint8_t* data = read_file(bundle_path, &size);
+    if (!data) {
+        failures++;
+        return;
+    }
+    const AssetBundleHeader* header = (const AssetBundleHeader*)data;
+    const AssetBundleEntry* entries = (const AssetBundleEntry*)(data + sizeof(*header));
+    const AssetBundleEntry* font_entry = &entries[0];
+    const AssetBundleEntry* skin_entry = &entries[1];
+    char damaged[160];
+    snprintf(damaged, sizeof(damaged), "%s.damaged", bundle_path);
+    AssetView view;
+
+    /* Deflated data: the get fails on the hash (or zlib) check */
+    size_t offset = (size_t)(skin_entry->offset + skin_entry->stored_size / 2);
+    write_damaged(data, size, offset, (uint8_t)(data[offset] ^ 0x5a), damaged);
+    AssetBundle* bundle = asset_bundle_open(damaged);
+    AssetBundleStats stats = {0};
+    bool got = bundle && asset_bundle_get(bundle, "skins/image_00.bmp", &view);
+    asset_bundle_get_stats(bundle, &stats);
+    STRESS_CHECK(failures, bundle && !got && pk_get_last_error() == PK_ERROR_INVALID_DATA &&
+                 stats.hash_failures == 1, "damaged deflated entry served");
+    STRESS_CHECK(failures, bundle && asset_bundle_get(bundle, "skins/image_01.bmp", &view),
+                 "intact entry refused next to a damaged one");
+    asset_bundle_close(bundle);
+
+    /* Stored data is served as-is; verify catches it */
+    offset = (size_t)(font_entry->offset + font_entry->size / 3);
+    write_damaged(data, size, offset, (uint8_t)(data[offset] ^ 0x01), damaged);
+    bundle = asset_bundle_open(damaged);
+    STRESS_CHECK(failures, bundle && asset_bundle_verify(bundle) == 1,
+                 "damaged stored entry passed verify");
+    asset_bundle_close(bundle);
+
+    /* Lost trailer, and an entry pointing past the end */
+    write_file(damaged, data, size - 1);
+    bundle = asset_bundle_open(damaged);
+    STRESS_CHECK(failures, !bundle && pk_get_last_error() == PK_ERROR_NOT_FOUND,
+                 "truncated bundle opened");
+    asset_bundle_close(bundle);
+
+    AssetBundleEntry bad = *skin_entry;
+    bad.offset = header->bundle_size;
+    uint8_t* copy = malloc(size);
+    memcpy(copy, data, size);
+    memcpy(copy + sizeof(*header) + sizeof(bad), &bad, sizeof(bad));
+    write_file(damaged, copy, size);
+    free(copy);
+    bundle = asset_bundle_open(damaged);
+    STRESS_CHECK(failures, !bundle && pk_get_last_error() == PK_ERROR_INVALID_DATA,
+                 "out-of-bounds entry accepted");
+    asset_bundle_close(bundle);
+
+    /* A name inside the name table but longer than any AssetInfo holds */
+    bad = *font_entry;
+    bad.name_offset = 0;
+    bad.name_length = ASSET_BUNDLE_MAX_NAME + 45;
+    copy = malloc(size);
+    memcpy(copy, data, size);
+    memcpy(copy + sizeof(*header), &bad, sizeof(bad));
+    write_file(damaged, copy, size);
+    free(copy);
+    bundle = asset_bundle_open(damaged);
+    STRESS_CHECK(failures, header->names_size >= bad.name_length && !bundle &&
+                 pk_get_last_error() == PK_ERROR_INVALID_DATA,
+                 "overlong entry name accepted");
+    asset_bundle_close(bundle);
+
+    unlink(damaged);
+    free(data);
+}
+
+typedef struct {
+    AssetBundle* bundle;
+    pthread_barrier_t* barrier;
+    const void* data;
+} RaceArgs;
+
+static void* race_thread(void* arg) {
+    RaceArgs* args = arg;
+    AssetView view;
+    pthread_barrier_wait(args->barrier);
+    args->data = asset_bundle_get(args->bundle, "skins/image_03.bmp", &view) ? view.data : NULL;
+    return NULL;
+}
+
+static void check_race(void) {
+    for (int round = 0; round < 50; round++) {
+        AssetBundle* bundle = asset_bundle_open(bundle_path);
+        pthread_barrier_t barrier;
+        pthread_barrier_init(&barrier, NULL, RACE_THREADS);
+        pthread_t threads[RACE_THREADS];
+        RaceArgs args[RACE_THREADS];
+        for (int t = 0; t < RACE_THREADS; t++) {
+            args[t] = (RaceArgs){ bundle, &barrier, NULL };
+            pthread_create(&threads[t], NULL, race_thread, &args[t]);
+        }
+        for (int t = 0; t < RACE_THREADS; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        pthread_barrier_destroy(&barrier);
+
+        AssetBundleStats stats;
+        asset_bundle_get_stats(bundle, &stats);
+        bool same = args[0].data != NULL;
+        for (int t = 1; t < RACE_THREADS; t++) {
+            same = same && args[t].data == args[0].data;
+        }
+        STRESS_CHECK(failures, same && stats.inflations == 1,
+                     "race round %d: %llu inflations, shared=%d", round,
+                     (unsigned long long)stats.inflations, same);
+        asset_bundle_close(bundle);
+    }
+}
+
+static void check_writer(void) {
+    AssetBundleWriter* writer = asset_bundle_writer_create();
+    STRESS_CHECK(failures, asset_bundle_writer_add(writer, "a", "x", 1, 0) &&
+                 !asset_bundle_writer_add(writer, "a", "y", 1, 0) &&
+                 pk_get_last_error() == PK_ERROR_ALREADY_EXISTS, "duplicate name accepted");
+    STRESS_CHECK(failures, !asset_bundle_writer_add(writer, "", "x", 1, 0),
+                 "empty name accepted");
+    asset_bundle_writer_destroy(writer);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_asset_bundle");
+    snprintf(bundle_path, sizeof(bundle_path), "/tmp/bench_asset_bundle.%d.pkb", (int)getpid());
+    snprintf(many_path, sizeof(many_path), "/tmp/bench_asset_bundle.%d.many.pkb", (int)getpid());
+    snprintf(exe_path, sizeof(exe_path), "/tmp/bench_asset_bundle.%d.exe", (int)getpid());
+
+    make_fixtures();
+    if (!build_bundle(bundle_path, false) || !build_many(many_path)) {
+        logger_shutdown();
+        return 1;
+    }
+    printf("Font fixture: %s (%zu bytes)\n",
+           access(FONT_PATH, R_OK) == 0 ? FONT_PATH : "generated", font_size);
+
+    bench_startup(bench_iterations());
+    check_footprint();
+    check_contents(bundle_path, "standalone");
+    check_appended();
+    check_corruption();
+    check_race();
+    check_writer();
+
+    unlink(bundle_path);
+    unlink(many_path);
+    unlink(exe_path);
+    free(font);
+    for (int s = 0; s < SKIN_COUNT; s++) {
+        free(skins[s]);
+    }
+
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
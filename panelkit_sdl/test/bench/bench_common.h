@@ -0,0 +1,63 @@
+/**
+ * @file bench_common.h
+ * @brief Shared timing and reporting helpers for benchmark programs
+ *
+ * Header-only so each benchmark stays a single standalone translation
+ * unit, matching the rest of the test directory.
+ */
+
+#ifndef PANELKIT_BENCH_COMMON_H
+#define PANELKIT_BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Default iteration count, overridable with BENCH_ITERATIONS */
+#define BENCH_DEFAULT_ITERATIONS 200000
+
+/** Monotonic clock in nanoseconds */
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/** Iteration count from environment (keeps TSan runs short) */
+static inline long bench_iterations(void) {
+    const char* env = getenv("BENCH_ITERATIONS");
+    long n = env ? strtol(env, NULL, 10) : 0;
+    return n > 0 ? n : BENCH_DEFAULT_ITERATIONS;
+}
+
+/** Print one result row: name, parameter, ns/op and ops/sec */
+static inline void bench_report(const char* name, const char* param,
+                                long ops, uint64_t elapsed_ns) {
+    double ns_per_op = ops > 0 ? (double)elapsed_ns / (double)ops : 0.0;
+    double ops_per_sec = elapsed_ns > 0 ? (double)ops * 1e9 / (double)elapsed_ns : 0.0;
+    printf("%-32s %-20s %12.1f ns/op %14.0f ops/s\n",
+           name, param, ns_per_op, ops_per_sec);
+    fflush(stdout);
+}
+
+/** Print the column header shared by all benchmarks */
+static inline void bench_header(const char* suite) {
+    printf("\n=== %s ===\n", suite);
+    printf("%-32s %-20s %18s %20s\n", "benchmark", "param", "latency", "throughput");
+}
+
+/* Stress-test assertion: count failures instead of aborting so a
+ * single run reports every broken invariant */
+#define STRESS_CHECK(failures, cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            (failures)++; \
+        } \
+    } while (0)
+
+#endif /* PANELKIT_BENCH_COMMON_H */
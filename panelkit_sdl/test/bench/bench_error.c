@@ -0,0 +1,87 @@
+/**
+ * @file bench_error.c
+ * @brief Cost of the thread-local error API
+ *
+ * Measures pk_set_last_error, pk_set_last_error_with_context (vsnprintf
+ * into TLS) and pk_get_last_error, single-threaded and with several
+ * threads hammering their own TLS slots.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include <pthread.h>
+
+static void bench_single_thread(long iterations) {
+    volatile PkError sink = PK_OK;
+
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        pk_set_last_error(PK_ERROR_NOT_FOUND);
+    }
+    bench_report("set_last_error", "-", iterations, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        pk_set_last_error_with_context(PK_ERROR_NOT_FOUND,
+                                       "State item '%s:%ld' not found", "bench", i);
+    }
+    bench_report("set_last_error_with_context", "-", iterations, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        sink = pk_get_last_error();
+    }
+    bench_report("get_last_error", "-", iterations, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        pk_clear_last_error();
+    }
+    bench_report("clear_last_error", "-", iterations, bench_now_ns() - start);
+    (void)sink;
+}
+
+static void* context_worker(void* arg) {
+    long iterations = *(long*)arg;
+    for (long i = 0; i < iterations; i++) {
+        pk_set_last_error_with_context(PK_ERROR_TIMEOUT, "worker iteration %ld", i);
+    }
+    return NULL;
+}
+
+static void bench_multi_thread(long iterations) {
+    static const int thread_counts[] = {2, 4, 8};
+    char param[32];
+
+    for (size_t c = 0; c < sizeof(thread_counts) / sizeof(thread_counts[0]); c++) {
+        int nthreads = thread_counts[c];
+        long per_thread = iterations / nthreads;
+        pthread_t threads[8];
+
+        uint64_t start = bench_now_ns();
+        for (int t = 0; t < nthreads; t++) {
+            pthread_create(&threads[t], NULL, context_worker, &per_thread);
+        }
+        for (int t = 0; t < nthreads; t++) {
+            pthread_join(threads[t], NULL);
+        }
+
+        snprintf(param, sizeof(param), "threads=%d", nthreads);
+        bench_report("set_with_context_concurrent", param,
+                     per_thread * nthreads, bench_now_ns() - start);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_error");
+
+    long iterations = bench_iterations();
+
+    bench_header("core/error");
+    bench_single_thread(iterations);
+    bench_multi_thread(iterations);
+
+    logger_shutdown();
+    return 0;
+}
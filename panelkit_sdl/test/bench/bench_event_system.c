@@ -0,0 +1,140 @@
+/**
+ * @file bench_event_system.c
+ * @brief Event system publish throughput microbenchmarks
+ *
+ * Measures event_emit cost against:
+ * - number of subscribers on the emitted event
+ * - number of unrelated subscriptions (linear lookup cost)
+ * - number of concurrent publishing threads
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/events/event_system.h"
+#include <pthread.h>
+
+static void counting_handler(const char* event_name, const void* data,
+                             size_t data_size, void* context) {
+    (void)event_name;
+    (void)data;
+    (void)data_size;
+    (*(volatile unsigned long*)context)++;
+}
+
+static void noop_handler(const char* event_name, const void* data,
+                         size_t data_size, void* context) {
+    (void)event_name;
+    (void)data;
+    (void)data_size;
+    (void)context;
+}
+
+/* Publish throughput vs subscriber count on the target event */
+static void bench_subscriber_count(long iterations) {
+    static const int counts[] = {0, 1, 4, 16, 64};
+    char param[32];
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        EventSystem* events = event_system_create();
+        unsigned long hits = 0;
+
+        for (int i = 0; i < counts[c]; i++) {
+            event_subscribe(events, "bench.target", counting_handler, &hits);
+        }
+
+        int payload = 42;
+        uint64_t start = bench_now_ns();
+        for (long i = 0; i < iterations; i++) {
+            event_emit(events, "bench.target", &payload, sizeof(payload));
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        snprintf(param, sizeof(param), "subs=%d", counts[c]);
+        bench_report("emit", param, iterations, elapsed);
+        event_system_destroy(events);
+    }
+}
+
+/* Publish cost vs unrelated subscriptions (lookup cost only) */
+static void bench_unrelated_subscriptions(long iterations) {
+    static const int counts[] = {16, 128, 1024};
+    char name[64];
+    char param[32];
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        EventSystem* events = event_system_create();
+        for (int i = 0; i < counts[c]; i++) {
+            snprintf(name, sizeof(name), "bench.other.%d", i);
+            event_subscribe(events, name, noop_handler, NULL);
+        }
+        event_subscribe(events, "bench.target", noop_handler, NULL);
+
+        uint64_t start = bench_now_ns();
+        for (long i = 0; i < iterations; i++) {
+            event_emit(events, "bench.target", NULL, 0);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        snprintf(param, sizeof(param), "unrelated=%d", counts[c]);
+        bench_report("emit_lookup", param, iterations, elapsed);
+        event_system_destroy(events);
+    }
+}
+
+typedef struct {
+    EventSystem* events;
+    long iterations;
+} PublisherArgs;
+
+static void* publisher_thread(void* arg) {
+    PublisherArgs* args = arg;
+    int payload = 7;
+    for (long i = 0; i < args->iterations; i++) {
+        event_emit(args->events, "bench.target", &payload, sizeof(payload));
+    }
+    return NULL;
+}
+
+/* Aggregate throughput with concurrent publishers sharing one system */
+static void bench_concurrent_publishers(long iterations) {
+    static const int thread_counts[] = {1, 2, 4, 8};
+    char param[32];
+
+    for (size_t c = 0; c < sizeof(thread_counts) / sizeof(thread_counts[0]); c++) {
+        int nthreads = thread_counts[c];
+        EventSystem* events = event_system_create();
+        for (int i = 0; i < 4; i++) {
+            event_subscribe(events, "bench.target", noop_handler, NULL);
+        }
+
+        pthread_t threads[8];
+        PublisherArgs args = { events, iterations / nthreads };
+
+        uint64_t start = bench_now_ns();
+        for (int t = 0; t < nthreads; t++) {
+            pthread_create(&threads[t], NULL, publisher_thread, &args);
+        }
+        for (int t = 0; t < nthreads; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        snprintf(param, sizeof(param), "threads=%d", nthreads);
+        bench_report("emit_concurrent", param, args.iterations * nthreads, elapsed);
+        event_system_destroy(events);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_event_system");
+
+    long iterations = bench_iterations();
+
+    bench_header("event_system");
+    bench_subscriber_count(iterations);
+    bench_unrelated_subscriptions(iterations / 10);
+    bench_concurrent_publishers(iterations);
+
+    logger_shutdown();
+    return 0;
+}
@@ -0,0 +1,323 @@
+/**
+ * @file bench_event_tap.c
+ * @brief Event tap cost on event_emit and stream correctness
+ *
+ * Measures event_emit with no tap client, with a client whose filters
+ * match nothing, and with a client taking every event (draining on its
+ * own thread). Then checks, against an in-process client:
+ * - records arrive in emit order with their names, sizes and payloads,
+ *   and only for the filtered events
+ * - payloads beyond EVENT_TAP_MAX_CAPTURE are truncated but their size
+ *   is reported
+ * - a client that stops reading makes events drop, never block emit
+ * - closing the client detaches the tap
+ * - the socket is created owner-only, a stale socket at the path is
+ *   replaced, and any other file there is refused and left intact
+ *
+ * Exit status is non-zero if any check fails.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/events/event_system.h"
+#include "../../src/events/event_tap.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+static int failures;
+static char socket_path[108];
+
+static void noop_handler(const char* event_name, const void* data, size_t data_size,
+                         void* context) {
+    (void)event_name;
+    (void)data;
+    (void)data_size;
+    (void)context;
+}
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static bool read_all(int fd, void* data, size_t size) {
+    uint8_t* p = data;
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+/* Connect and subscribe; returns the socket once the tap is attached */
+static int connect_client(const char* filters) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, socket_path, strlen(socket_path));
+    if (fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    char line[256];
+    int length = snprintf(line, sizeof(line), "%s\n", filters);
+    char hello[sizeof(EVENT_TAP_HELLO) - 1];
+    if (write(fd, line, (size_t)length) != length || !read_all(fd, hello, sizeof(hello)) ||
+        memcmp(hello, EVENT_TAP_HELLO, sizeof(hello)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* ---- Emit cost ---- */
+
+typedef struct {
+    int fd;
+    atomic_long records;
+} Drainer;
+
+static void* drain_thread(void* arg) {
+    Drainer* drainer = arg;
+    EventTapRecord record;
+    uint8_t body[512];
+    while (read_all(drainer->fd, &record, sizeof(record)) &&
+           read_all(drainer->fd, body, (size_t)record.name_length + record.captured)) {
+        atomic_fetch_add(&drainer->records, 1);
+    }
+    return NULL;
+}
+
+static void bench_emit(EventSystem* events, EventTap* tap, const char* param,
+                       const char* filters, long iterations) {
+    Drainer drainer = { .fd = -1 };
+    atomic_init(&drainer.records, 0);
+    pthread_t thread;
+    if (filters) {
+        drainer.fd = connect_client(filters);
+        if (drainer.fd < 0) {
+            STRESS_CHECK(failures, false, "%s: client could not connect", param);
+            return;
+        }
+        pthread_create(&thread, NULL, drain_thread, &drainer);
+    }
+
+    struct { int page; int button; uint32_t timestamp; uint32_t pad; } payload = { 1, 2, 3, 0 };
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        event_emit(events, "ui.button_pressed", &payload, sizeof(payload));
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    bench_report("emit (1 subscriber)", param, iterations, elapsed);
+
+    if (filters) {
+        sleep_ms(100);
+        EventTapStats stats;
+        event_tap_get_stats(tap, &stats);
+        printf("%-32s %-20s %ld records received, %llu dropped\n", "", "",
+               atomic_load(&drainer.records), (unsigned long long)stats.dropped);
+        shutdown(drainer.fd, SHUT_RDWR);
+        pthread_join(thread, NULL);
+        close(drainer.fd);
+        sleep_ms(100);
+    }
+}
+
+/* ---- Stream correctness ---- */
+
+static void check_stream(EventSystem* events, EventTap* tap) {
+    int fd = connect_client("ui.* app.page_transition big.event");
+    if (fd < 0) {
+        STRESS_CHECK(failures, false, "stream: client could not connect");
+        return;
+    }
+
+    /* Interleave tapped and untapped events */
+    for (int i = 0; i < 100; i++) {
+        event_emit(events, "ui.button_pressed", &i, sizeof(i));
+        event_emit(events, "api.user_data_updated", &i, sizeof(i));
+        if (i % 10 == 0) {
+            event_emit(events, "app.page_transition", &i, sizeof(i));
+        }
+    }
+    uint8_t big[1000];
+    memset(big, 0xAB, sizeof(big));
+    event_emit(events, "big.event", big, sizeof(big));
+
+    int expected_records = 100 + 10 + 1;
+    int button = 0, transition = 0;
+    for (int r = 0; r < expected_records; r++) {
+        EventTapRecord record;
+        uint8_t body[512];
+        if (!read_all(fd, &record, sizeof(record)) ||
+            !read_all(fd, body, (size_t)record.name_length + record.captured)) {
+            STRESS_CHECK(failures, false, "stream: ended after %d of %d records", r,
+                         expected_records);
+            break;
+        }
+        STRESS_CHECK(failures, record.magic == EVENT_TAP_MAGIC && record.sequence == (uint32_t)r &&
+                     record.dropped == 0,
+                     "stream: record %d has magic %08x sequence %u dropped %u", r,
+                     record.magic, record.sequence, record.dropped);
+
+        char name[128];
+        snprintf(name, sizeof(name), "%.*s", (int)record.name_length, (const char*)body);
+        const uint8_t* data = body + record.name_length;
+        int value = -1;
+        if (record.captured == sizeof(int)) {
+            memcpy(&value, data, sizeof(int));
+        }
+
+        if (strcmp(name, "ui.button_pressed") == 0) {
+            STRESS_CHECK(failures, value == button, "stream: button %d arrived as %d", button, value);
+            button++;
+        } else if (strcmp(name, "app.page_transition") == 0) {
+            STRESS_CHECK(failures, value == transition * 10, "stream: transition %d arrived as %d",
+                         transition * 10, value);
+            transition++;
+        } else if (strcmp(name, "big.event") == 0) {
+            STRESS_CHECK(failures, record.data_size == sizeof(big) &&
+                         record.captured == EVENT_TAP_MAX_CAPTURE && data[0] == 0xAB &&
+                         data[EVENT_TAP_MAX_CAPTURE - 1] == 0xAB,
+                         "stream: big payload size %u captured %u", record.data_size,
+                         record.captured);
+        } else {
+            STRESS_CHECK(failures, false, "stream: unfiltered event '%s' delivered", name);
+        }
+    }
+    STRESS_CHECK(failures, button == 100 && transition == 10,
+                 "stream: %d buttons and %d transitions", button, transition);
+
+    /* A client that stops reading: emit must not block, events drop */
+    uint8_t payload[EVENT_TAP_MAX_CAPTURE];
+    memset(payload, 0, sizeof(payload));
+    EventTapStats stats;
+    event_tap_get_stats(tap, &stats);
+    uint64_t dropped_before = stats.dropped;
+    uint64_t worst = 0;
+    for (int i = 0; i < 50000; i++) {
+        uint64_t start = bench_now_ns();
+        event_emit(events, "ui.flood", payload, sizeof(payload));
+        uint64_t took = bench_now_ns() - start;
+        if (took > worst) {
+            worst = took;
+        }
+    }
+    event_tap_get_stats(tap, &stats);
+    uint64_t dropped = stats.dropped - dropped_before;
+    printf("%-32s %-20s stalled client: %llu dropped, slowest emit %.1f us\n", "", "",
+           (unsigned long long)dropped, (double)worst / 1000.0);
+    STRESS_CHECK(failures, dropped > 0, "stalled client: nothing dropped");
+    STRESS_CHECK(failures, worst < 50000000ULL, "stalled client: an emit took %.1f ms",
+                 (double)worst / 1e6);
+
+    /* Closing detaches; the next session starts from an empty ring */
+    close(fd);
+    for (int i = 0; i < 100; i++) {
+        event_tap_get_stats(tap, &stats);
+        if (!stats.connected) {
+            break;
+        }
+        sleep_ms(10);
+    }
+    STRESS_CHECK(failures, !stats.connected, "closed client still attached");
+
+    fd = connect_client("ui.*");
+    STRESS_CHECK(failures, fd >= 0, "reconnect failed");
+    if (fd >= 0) {
+        int value = 7;
+        event_emit(events, "ui.after", &value, sizeof(value));
+        EventTapRecord record;
+        uint8_t body[64];
+        bool ok = read_all(fd, &record, sizeof(record)) &&
+                  read_all(fd, body, (size_t)record.name_length + record.captured);
+        STRESS_CHECK(failures, ok && record.sequence == 0 && record.name_length == 8 &&
+                     memcmp(body, "ui.after", 8) == 0,
+                     "reconnected stream starts with sequence %u", ok ? record.sequence : 0);
+        close(fd);
+    }
+}
+
+static void check_socket_file(EventSystem* events) {
+    /* A regular file is not ours to delete */
+    FILE* file = fopen(socket_path, "w");
+    if (file) {
+        fputs("keep", file);
+        fclose(file);
+    }
+    EventTap* tap = event_tap_create(events, socket_path);
+    STRESS_CHECK(failures, tap == NULL && pk_get_last_error() == PK_ERROR_ALREADY_EXISTS,
+                 "tap replaced a regular file");
+    event_tap_destroy(tap);
+    struct stat st;
+    STRESS_CHECK(failures, stat(socket_path, &st) == 0 && S_ISREG(st.st_mode) && st.st_size == 4,
+                 "regular file at the socket path was touched");
+    unlink(socket_path);
+
+    /* A socket left by a crashed run is replaced */
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", socket_path);
+    int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool bound = stale >= 0 && bind(stale, (struct sockaddr*)&address, sizeof(address)) == 0;
+    if (stale >= 0) {
+        close(stale);
+    }
+    STRESS_CHECK(failures, bound, "could not leave a stale socket");
+    tap = event_tap_create(events, socket_path);
+    STRESS_CHECK(failures, tap != NULL, "stale socket not replaced: %s",
+                 pk_get_last_error_context());
+    event_tap_destroy(tap);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_event_tap");
+    snprintf(socket_path, sizeof(socket_path), "/tmp/bench_event_tap.%d.sock", (int)getpid());
+
+    EventSystem* events = event_system_create();
+    event_subscribe(events, "ui.button_pressed", noop_handler, NULL);
+    EventTap* tap = event_tap_create(events, socket_path);
+    if (!tap) {
+        fprintf(stderr, "Event tap failed: %s\n", pk_get_last_error_context());
+        event_system_destroy(events);
+        logger_shutdown();
+        return 1;
+    }
+
+    struct stat st;
+    STRESS_CHECK(failures, stat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode) &&
+                 (st.st_mode & 0777) == 0600, "socket mode %o, expected 0600",
+                 (unsigned)(st.st_mode & 0777));
+
+    long iterations = bench_iterations();
+    bench_header("Event tap (emit cost by client state)");
+    bench_emit(events, tap, "no client", NULL, iterations);
+    bench_emit(events, tap, "client, no match", "input.*", iterations);
+    bench_emit(events, tap, "client, all events", "*", iterations);
+
+    check_stream(events, tap);
+
+    event_tap_destroy(tap);
+    STRESS_CHECK(failures, access(socket_path, F_OK) != 0, "socket left behind");
+    check_socket_file(events);
+    event_system_destroy(events);
+
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
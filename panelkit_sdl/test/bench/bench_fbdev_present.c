@@ -0,0 +1,222 @@
+/**
+ * @file bench_fbdev_present.c
+ * @brief Framebuffer present cost: full copies versus damage-only copies
+ *
+ * Drives FbdevOutput over plain memory pages (fbdev_output_create_memory)
+ * at 800x480, 16 and 32 bits per pixel, single and panned double buffer,
+ * with three kinds of frame: everything changed, a small clock-sized
+ * region changed, and nothing changed. A plain full-frame copy per present
+ * is the baseline. Each row also reports bytes written per frame, which is
+ * what matters on a real framebuffer where writes are uncached; after each
+ * run the visible page is checked against the last frame.
+ *
+ * Set BENCH_FBDEV to a device path (e.g. /dev/fb1) to repeat the partial
+ * and unchanged runs against real framebuffer memory. The device is
+ * written to, so use a spare one.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/display/fbdev_output.h"
+
+#define FRAME_W 800
+#define FRAME_H 480
+
+/* Region redrawn every frame in the partial case (a clock or counter) */
+#define REGION_X 600
+#define REGION_Y 20
+#define REGION_W 160
+#define REGION_H 48
+
+static int failures;
+
+static long frame_iterations(void) {
+    long n = bench_iterations() / 1000;
+    return n < 20 ? 20 : n;
+}
+
+/* Pattern that differs everywhere between consecutive values of seed */
+static void fill_frame(uint8_t* frame, int pitch, int bpp, uint32_t seed) {
+    for (int y = 0; y < FRAME_H; y++) {
+        uint8_t* row = frame + (size_t)y * pitch;
+        for (int x = 0; x < FRAME_W * bpp; x++) {
+            row[x] = (uint8_t)(x + y + seed * 37);
+        }
+    }
+}
+
+static void draw_region(uint8_t* frame, int pitch, int bpp, uint32_t seed) {
+    for (int y = REGION_Y; y < REGION_Y + REGION_H; y++) {
+        memset(frame + (size_t)y * pitch + (size_t)REGION_X * bpp, (int)(seed * 13 + 1),
+               (size_t)REGION_W * bpp);
+    }
+}
+
+static void check_front(FbdevOutput* output, const uint8_t* frame, int pitch, int bpp,
+                        const char* what) {
+    int front_pitch;
+    const uint8_t* front = fbdev_output_front(output, &front_pitch);
+    for (int y = 0; y < FRAME_H; y++) {
+        if (memcmp(front + (size_t)y * front_pitch, frame + (size_t)y * pitch,
+                   (size_t)FRAME_W * bpp) != 0) {
+            STRESS_CHECK(failures, false, "%s: visible page differs from frame at row %d",
+                         what, y);
+            return;
+        }
+    }
+}
+
+static void report_bytes(FbdevOutput* output, const FbdevStats* before, long frames) {
+    FbdevStats after;
+    fbdev_output_get_stats(output, &after);
+    printf("%-32s %-20s %12.0f bytes/frame %8llu unchanged\n", "", "",
+           (double)(after.bytes_copied - before->bytes_copied) / (double)frames,
+           (unsigned long long)(after.frames_unchanged - before->frames_unchanged));
+}
+
+static void bench_config(int bits_per_pixel, int pages, long frames) {
+    int bpp = bits_per_pixel / 8;
+    int pitch = FRAME_W * bpp;
+    char param[32];
+    snprintf(param, sizeof(param), "%dbpp %dpage%s", bits_per_pixel, pages,
+             pages > 1 ? "s" : "");
+
+    FbdevOutput* output = fbdev_output_create_memory(FRAME_W, FRAME_H, bits_per_pixel, pages);
+    uint8_t* frames_buf[2] = { malloc((size_t)pitch * FRAME_H), malloc((size_t)pitch * FRAME_H) };
+    if (!output || !frames_buf[0] || !frames_buf[1]) {
+        STRESS_CHECK(failures, false, "%s: setup failed", param);
+        fbdev_output_destroy(output);
+        free(frames_buf[0]);
+        free(frames_buf[1]);
+        return;
+    }
+    fill_frame(frames_buf[0], pitch, bpp, 0);
+    fill_frame(frames_buf[1], pitch, bpp, 1);
+
+    /* Baseline: copy the whole frame on every present */
+    int front_pitch;
+    uint8_t* page = (uint8_t*)fbdev_output_front(output, &front_pitch);
+    uint64_t start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        const uint8_t* src = frames_buf[f & 1];
+        for (int y = 0; y < FRAME_H; y++) {
+            memcpy(page + (size_t)y * front_pitch, src + (size_t)y * pitch, (size_t)pitch);
+        }
+    }
+    bench_report("full copy (baseline)", param, frames, bench_now_ns() - start);
+
+    /* Everything changes: diff cost on top of a full copy */
+    FbdevStats before;
+    fbdev_output_get_stats(output, &before);
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        fbdev_output_present(output, frames_buf[f & 1], pitch, false);
+    }
+    bench_report("present all changed", param, frames, bench_now_ns() - start);
+    report_bytes(output, &before, frames);
+    check_front(output, frames_buf[(frames - 1) & 1], pitch, bpp, "all changed");
+
+    /* Small region changes */
+    fbdev_output_get_stats(output, &before);
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        draw_region(frames_buf[0], pitch, bpp, (uint32_t)f);
+        fbdev_output_present(output, frames_buf[0], pitch, false);
+    }
+    bench_report("present region changed", param, frames, bench_now_ns() - start);
+    report_bytes(output, &before, frames);
+    check_front(output, frames_buf[0], pitch, bpp, "region changed");
+
+    /* Nothing changes (the common case on an idle panel) */
+    fbdev_output_present(output, frames_buf[0], pitch, false);
+    fbdev_output_get_stats(output, &before);
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        fbdev_output_present(output, frames_buf[0], pitch, false);
+    }
+    bench_report("present unchanged", param, frames, bench_now_ns() - start);
+    report_bytes(output, &before, frames);
+    check_front(output, frames_buf[0], pitch, bpp, "unchanged");
+
+    FbdevStats after;
+    fbdev_output_get_stats(output, &after);
+    STRESS_CHECK(failures, after.frames_unchanged - before.frames_unchanged == (uint64_t)frames,
+                 "%s: unchanged frames wrote to the framebuffer", param);
+
+    /* A present after invalidate rewrites the visible page */
+    fbdev_output_invalidate(output);
+    fbdev_output_get_stats(output, &before);
+    fbdev_output_present(output, frames_buf[0], pitch, false);
+    fbdev_output_get_stats(output, &after);
+    STRESS_CHECK(failures, after.bytes_copied - before.bytes_copied == (uint64_t)pitch * FRAME_H,
+                 "%s: invalidate rewrote %llu bytes", param,
+                 (unsigned long long)(after.bytes_copied - before.bytes_copied));
+
+    fbdev_output_destroy(output);
+    free(frames_buf[0]);
+    free(frames_buf[1]);
+}
+
+/* Partial and unchanged presents against a real framebuffer device */
+static void bench_device(const char* device, long frames) {
+    FbdevOutput* output = fbdev_output_open(device, true);
+    if (!output) {
+        printf("\n%s: %s\n", device, pk_get_last_error_context());
+        return;
+    }
+
+    FbdevInfo info;
+    fbdev_output_get_info(output, &info);
+    int bpp = info.bits_per_pixel / 8;
+    int pitch = info.width * bpp;
+    uint8_t* frame = calloc((size_t)pitch, (size_t)info.height);
+    char param[32];
+    snprintf(param, sizeof(param), "%dx%d %dbpp %dpg", info.width, info.height,
+             info.bits_per_pixel, info.pages);
+
+    bench_header(device);
+    if (frame && info.width >= REGION_X + REGION_W && info.height >= REGION_Y + REGION_H) {
+        fbdev_output_present(output, frame, pitch, false);
+        uint64_t start = bench_now_ns();
+        for (long f = 0; f < frames; f++) {
+            draw_region(frame, pitch, bpp, (uint32_t)f);
+            fbdev_output_present(output, frame, pitch, false);
+        }
+        bench_report("device region changed", param, frames, bench_now_ns() - start);
+
+        start = bench_now_ns();
+        for (long f = 0; f < frames; f++) {
+            fbdev_output_present(output, frame, pitch, false);
+        }
+        bench_report("device unchanged", param, frames, bench_now_ns() - start);
+    } else {
+        printf("%s: too small for the test region\n", device);
+    }
+
+    free(frame);
+    fbdev_output_destroy(output);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_fbdev_present");
+
+    long frames = frame_iterations();
+    bench_header("Framebuffer present (800x480 frame per op, memory pages)");
+    bench_config(16, 1, frames);
+    bench_config(16, 2, frames);
+    bench_config(32, 1, frames);
+    bench_config(32, 2, frames);
+
+    const char* device = getenv("BENCH_FBDEV");
+    if (device && *device) {
+        bench_device(device, frames);
+    }
+
+    logger_shutdown();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
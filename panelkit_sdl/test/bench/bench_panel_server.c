@@ -0,0 +1,212 @@
+/**
+ * @file bench_panel_server.c
+ * @brief Headless panel throughput: panel-frames per second and per core
+ *
+ * Sixteen 800x480 panels record a dashboard-like frame (background, cards,
+ * a shared "glyph" image blended in several places, a gauge made of
+ * geometry) on the main thread and are rasterized by a PanelServer pool of
+ * 1, 2, 4 ... workers up to the online CPU count. Each row reports the
+ * cost per panel frame; the line under it gives panel frames per second
+ * of worker time (per core) and how long the main thread spent recording
+ * and waiting per batch.
+ *
+ * Every panel's card colour depends on its index, so after each run the
+ * surfaces are checked for their own colour and for the shared image, and
+ * the pool is checked to have rasterized every panel of every batch.
+ *
+ * Requires SDL2; build with `make build-bench-display`.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/display/panel_server.h"
+#include <math.h>
+#include <unistd.h>
+
+#define PANEL_W 800
+#define PANEL_H 480
+#define PANEL_COUNT 16
+
+#define GLYPH_W 96
+#define GLYPH_H 32
+
+static int failures;
+
+static long batch_iterations(void) {
+    long n = bench_iterations() / 2000;
+    return n < 10 ? 10 : n;
+}
+
+/* Opaque white bar with a transparent border, shared by every panel */
+static SDL_Surface* create_glyph(void) {
+    SDL_Surface* glyph = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_W, GLYPH_H, 32,
+                                                        SDL_PIXELFORMAT_ARGB8888);
+    if (!glyph) {
+        return NULL;
+    }
+    for (int y = 0; y < GLYPH_H; y++) {
+        uint32_t* row = (uint32_t*)((uint8_t*)glyph->pixels + (size_t)y * glyph->pitch);
+        for (int x = 0; x < GLYPH_W; x++) {
+            bool inside = x >= 8 && x < GLYPH_W - 8 && y >= 8 && y < GLYPH_H - 8;
+            row[x] = inside ? 0xFFFFFFFF : 0x00000000;
+        }
+    }
+    SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_BLEND);
+    return glyph;
+}
+
+static SDL_Color card_color(int panel) {
+    SDL_Color color = { (Uint8)(40 + panel * 12), (Uint8)(200 - panel * 8), 90, 255 };
+    return color;
+}
+
+static void record_panel(DisplayList* list, int panel, SDL_Surface* glyph, long frame) {
+    display_list_set_draw_color(list, 20, 20, 24, 255);
+    display_list_clear(list);
+
+    /* Cards in a 4x2 grid */
+    SDL_Color color = card_color(panel);
+    display_list_set_draw_color(list, color.r, color.g, color.b, 255);
+    for (int i = 0; i < 8; i++) {
+        SDL_Rect card = { 20 + (i % 4) * 195, 20 + (i / 4) * 230, 180, 210 };
+        display_list_fill_rect(list, &card);
+    }
+
+    /* Labels from the shared image */
+    display_list_set_blend_mode(list, SDL_BLENDMODE_BLEND);
+    for (int i = 0; i < 8; i++) {
+        SDL_Rect dst = { 40 + (i % 4) * 195, 40 + (i / 4) * 230, GLYPH_W, GLYPH_H };
+        display_list_copy_surface(list, glyph, NULL, &dst);
+    }
+
+    /* Gauge: a fan of triangles whose sweep moves every frame */
+    SDL_Vertex vertices[33];
+    int indices[96];
+    float cx = 400.0f, cy = 360.0f;
+    vertices[0] = (SDL_Vertex){ { cx, cy }, { 255, 200, 0, 255 }, { 0, 0 } };
+    for (int i = 0; i < 32; i++) {
+        float angle = (float)((i + frame) % 64) * 0.098f;
+        vertices[i + 1] = (SDL_Vertex){ { cx + 80.0f * cosf(angle),
+                                          cy - 80.0f * sinf(angle) },
+                                        { 255, 200, 0, 255 }, { 0, 0 } };
+    }
+    for (int i = 0; i < 31; i++) {
+        indices[i * 3] = 0;
+        indices[i * 3 + 1] = i + 1;
+        indices[i * 3 + 2] = i + 2;
+    }
+    display_list_geometry(list, NULL, vertices, 33, indices, 93);
+}
+
+static uint32_t pixel_at(SDL_Surface* surface, int x, int y) {
+    const uint8_t* row = (const uint8_t*)surface->pixels + (size_t)y * surface->pitch;
+    return ((const uint32_t*)row)[x] & 0x00FFFFFF;
+}
+
+static void check_panels(PanelServer* server, const char* what) {
+    for (int p = 0; p < PANEL_COUNT; p++) {
+        SDL_Surface* surface = panel_server_get_surface(server, p);
+        SDL_Color color = card_color(p);
+        uint32_t card = (uint32_t)color.r << 16 | (uint32_t)color.g << 8 | color.b;
+
+        /* Card corner (no label), label centre, background between cards */
+        STRESS_CHECK(failures, pixel_at(surface, 25, 225) == card,
+                     "%s: panel %d card is %06x, expected %06x", what, p,
+                     pixel_at(surface, 25, 225), card);
+        STRESS_CHECK(failures, pixel_at(surface, 40 + GLYPH_W / 2, 40 + GLYPH_H / 2) == 0xFFFFFF,
+                     "%s: panel %d label missing", what, p);
+        STRESS_CHECK(failures, pixel_at(surface, 42, 44) == card,
+                     "%s: panel %d label border not transparent", what, p);
+        STRESS_CHECK(failures, pixel_at(surface, 210, 10) == 0x141418,
+                     "%s: panel %d background is %06x", what, p, pixel_at(surface, 210, 10));
+    }
+}
+
+static void bench_workers(int workers, SDL_Surface* glyph, long batches) {
+    char param[32];
+    snprintf(param, sizeof(param), "%d panels %dw", PANEL_COUNT, workers);
+
+    PanelServerConfig config = panel_server_default_config();
+    config.workers = workers;
+    PanelServer* server = panel_server_create(&config);
+    if (!server) {
+        STRESS_CHECK(failures, false, "%s: panel server failed", param);
+        return;
+    }
+    for (int p = 0; p < PANEL_COUNT; p++) {
+        if (panel_server_add_panel(server, PANEL_W, PANEL_H) != p) {
+            STRESS_CHECK(failures, false, "%s: add_panel failed", param);
+            panel_server_destroy(server);
+            return;
+        }
+    }
+
+    /* Warm texture caches outside the timed loop */
+    for (int p = 0; p < PANEL_COUNT; p++) {
+        record_panel(panel_server_begin_frame(server, p), p, glyph, 0);
+    }
+    panel_server_submit(server);
+    panel_server_finish(server);
+
+    PanelServerStats before;
+    panel_server_get_stats(server, &before);
+    uint64_t start = bench_now_ns();
+    for (long b = 0; b < batches; b++) {
+        for (int p = 0; p < PANEL_COUNT; p++) {
+            record_panel(panel_server_begin_frame(server, p), p, glyph, b);
+        }
+        panel_server_submit(server);
+    }
+    panel_server_finish(server);
+    uint64_t elapsed = bench_now_ns() - start;
+
+    PanelServerStats after;
+    panel_server_get_stats(server, &after);
+    uint64_t panel_frames = after.panel_frames - before.panel_frames;
+    double raster_s = (double)(after.raster_ns - before.raster_ns) / 1e9;
+    uint64_t submitted = after.frames - before.frames;
+
+    bench_report("panel frame", param, (long)panel_frames, elapsed);
+    printf("%-32s %-20s %12.0f per core %9.2f ms record %6.2f ms wait\n", "", "",
+           raster_s > 0 ? (double)panel_frames / raster_s : 0.0,
+           submitted ? (double)(after.record_ns - before.record_ns) / (double)submitted / 1e6 : 0.0,
+           submitted ? (double)(after.wait_ns - before.wait_ns) / (double)submitted / 1e6 : 0.0);
+
+    STRESS_CHECK(failures, panel_frames == (uint64_t)(batches * PANEL_COUNT),
+                 "%s: %llu panel frames rasterized, expected %ld", param,
+                 (unsigned long long)panel_frames, batches * PANEL_COUNT);
+    STRESS_CHECK(failures, after.workers == workers, "%s: %d workers running", param,
+                 after.workers);
+    check_panels(server, param);
+
+    panel_server_destroy(server);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_panel_server");
+
+    SDL_Surface* glyph = create_glyph();
+    if (!glyph) {
+        fprintf(stderr, "Failed to create test image: %s\n", SDL_GetError());
+        logger_shutdown();
+        return 1;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long batches = batch_iterations();
+    bench_header("Headless panel server (800x480 panels, software raster)");
+    for (int workers = 1; workers <= cpus && workers <= 64; workers *= 2) {
+        bench_workers(workers, glyph, batches);
+    }
+    if (cpus > 1 && (cpus & (cpus - 1)) != 0 && cpus <= 64) {
+        bench_workers((int)cpus, glyph, batches);
+    }
+
+    SDL_FreeSurface(glyph);
+    logger_shutdown();
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file bench_pixel_format.c
+ * @brief Per-frame memory cost of XRGB8888 versus RGB565 rendering
+ *
+ * Runs the operations the SDL+DRM software path does every frame, over a
+ * full 800x480 frame in each format: solid fill, 50% alpha blend, blitting
+ * a cached opaque image, and the present copy into the scanout buffer.
+ * Also measures packing an image to RGB565 (once per cached texture, with
+ * and without dithering) against converting it on every blit, and reports
+ * how far each packing drifts from the source when averaged over 4x4
+ * blocks (what the eye sees on a small pixel pitch).
+ *
+ * The loops mirror SDL's generic software fills and blits; absolute
+ * numbers depend on the target's memory bus, the 16/32-bit ratio is the
+ * interesting part.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/display/pixel_format.h"
+#include <math.h>
+
+#define FRAME_W 800
+#define FRAME_H 480
+
+static uint32_t* frame32;
+static uint16_t* frame16;
+static uint32_t* scanout32;
+static uint16_t* scanout16;
+static uint32_t* image32;
+static uint16_t* image16;
+
+static long frame_iterations(void) {
+    long n = bench_iterations() / 1000;
+    return n < 20 ? 20 : n;
+}
+
+static void bench_fill(long frames) {
+    uint64_t start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        uint32_t color = 0xFF203040u + (uint32_t)f;
+        for (size_t i = 0; i < FRAME_W * FRAME_H; i++) {
+            frame32[i] = color;
+        }
+    }
+    bench_report("fill", "xrgb8888", frames, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        uint16_t color = (uint16_t)(0x2104 + f);
+        for (size_t i = 0; i < FRAME_W * FRAME_H; i++) {
+            frame16[i] = color;
+        }
+    }
+    bench_report("fill", "rgb565", frames, bench_now_ns() - start);
+}
+
+/* Blend (src + dst) / 2 per channel, as SDL_BLENDMODE_BLEND at alpha 128;
+ * both formats halve all channels at once with a masked shift */
+static void bench_blend(long frames) {
+    const uint32_t src = 0x00C08040u;
+    uint64_t start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        for (size_t i = 0; i < FRAME_W * FRAME_H; i++) {
+            uint32_t d = frame32[i];
+            frame32[i] = 0xFF000000u | ((((d & 0xFEFEFEu) >> 1) + ((src & 0xFEFEFEu) >> 1)) & 0xFFFFFFu);
+        }
+    }
+    bench_report("blend 50%", "xrgb8888", frames, bench_now_ns() - start);
+
+    const uint16_t src16 = 0xC208;
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        for (size_t i = 0; i < FRAME_W * FRAME_H; i++) {
+            uint16_t d = frame16[i];
+            frame16[i] = (uint16_t)(((d & 0xF7DEu) >> 1) + ((src16 & 0xF7DEu) >> 1));
+        }
+    }
+    bench_report("blend 50%", "rgb565", frames, bench_now_ns() - start);
+}
+
+static void bench_blit(long frames) {
+    uint64_t start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        memcpy(frame32, image32, FRAME_W * FRAME_H * 4);
+    }
+    bench_report("blit opaque image", "xrgb8888", frames, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        memcpy(frame16, image16, FRAME_W * FRAME_H * 2);
+    }
+    bench_report("blit opaque image", "rgb565 cached", frames, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        pixel_convert_rgb565(image32, FRAME_W * 4, frame16, FRAME_W * 2, FRAME_W, FRAME_H, false);
+    }
+    bench_report("blit opaque image", "rgb565 per blit", frames, bench_now_ns() - start);
+}
+
+static void bench_present(long frames) {
+    uint64_t start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        for (int y = 0; y < FRAME_H; y++) {
+            memcpy(scanout32 + y * FRAME_W, frame32 + y * FRAME_W, FRAME_W * 4);
+        }
+    }
+    bench_report("present copy", "xrgb8888", frames, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        for (int y = 0; y < FRAME_H; y++) {
+            memcpy(scanout16 + y * FRAME_W, frame16 + y * FRAME_W, FRAME_W * 2);
+        }
+    }
+    bench_report("present copy", "rgb565", frames, bench_now_ns() - start);
+}
+
+static void bench_pack(long frames) {
+    uint64_t start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        pixel_convert_rgb565(image32, FRAME_W * 4, image16, FRAME_W * 2, FRAME_W, FRAME_H, false);
+    }
+    bench_report("pack to rgb565", "truncate", frames, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long f = 0; f < frames; f++) {
+        pixel_convert_rgb565(image32, FRAME_W * 4, image16, FRAME_W * 2, FRAME_W, FRAME_H, true);
+    }
+    bench_report("pack to rgb565", "ordered dither", frames, bench_now_ns() - start);
+}
+
+/* Mean error of 4x4 block averages against the source, in 8-bit units */
+static double block_error(const uint16_t* packed) {
+    double total = 0.0;
+    int blocks = 0;
+    for (int by = 0; by + 4 <= FRAME_H; by += 4) {
+        for (int bx = 0; bx + 4 <= FRAME_W; bx += 4) {
+            double src_sum = 0.0, out_sum = 0.0;
+            for (int y = by; y < by + 4; y++) {
+                for (int x = bx; x < bx + 4; x++) {
+                    src_sum += (image32[y * FRAME_W + x] >> 8) & 0xFF;
+                    uint32_t g = (packed[y * FRAME_W + x] >> 5) & 0x3F;
+                    out_sum += (double)(g << 2 | g >> 4);   /* Expand as scanout does */
+                }
+            }
+            total += fabs(src_sum - out_sum) / 16.0;
+            blocks++;
+        }
+    }
+    return total / blocks;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_pixel_format");
+
+    frame32 = calloc(FRAME_W * FRAME_H, 4);
+    frame16 = calloc(FRAME_W * FRAME_H, 2);
+    scanout32 = calloc(FRAME_W * FRAME_H, 4);
+    scanout16 = calloc(FRAME_W * FRAME_H, 2);
+    image32 = calloc(FRAME_W * FRAME_H, 4);
+    image16 = calloc(FRAME_W * FRAME_H, 2);
+    if (!frame32 || !frame16 || !scanout32 || !scanout16 || !image32 || !image16) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    /* Slow diagonal gradient: the case that bands at 16 bits */
+    for (int y = 0; y < FRAME_H; y++) {
+        for (int x = 0; x < FRAME_W; x++) {
+            uint32_t v = (uint32_t)(64 + (x + y) * 96 / (FRAME_W + FRAME_H));
+            image32[y * FRAME_W + x] = 0xFF000000u | v << 16 | v << 8 | (v / 2);
+        }
+    }
+
+    long frames = frame_iterations();
+    bench_header("Pixel format (800x480 frame per op)");
+    bench_fill(frames);
+    bench_blend(frames);
+    bench_blit(frames);
+    bench_present(frames);
+    bench_pack(frames);
+
+    pixel_convert_rgb565(image32, FRAME_W * 4, image16, FRAME_W * 2, FRAME_W, FRAME_H, false);
+    double truncated = block_error(image16);
+    pixel_convert_rgb565(image32, FRAME_W * 4, image16, FRAME_W * 2, FRAME_W, FRAME_H, true);
+    double dithered = block_error(image16);
+    printf("\ngradient 4x4 block error (green, 8-bit units): truncate %.2f, dither %.2f\n",
+           truncated, dithered);
+
+    free(frame32);
+    free(frame16);
+    free(scanout32);
+    free(scanout16);
+    free(image32);
+    free(image16);
+    logger_shutdown();
+    return 0;
+}
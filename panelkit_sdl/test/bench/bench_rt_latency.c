@@ -0,0 +1,314 @@
+/**
+ * @file bench_rt_latency.c
+ * @brief Worst-case input handling latency under synthetic background load
+ *
+ * A generator thread writes evdev-style touch frames (ABS_MT_POSITION_X/Y
+ * plus SYN_REPORT) into a pipe every 2ms; a reader thread waits on the
+ * pipe with poll() and read(), exactly like evdev_read_thread, and
+ * records the time from write to SYN_REPORT handled. Meanwhile the rest
+ * of the machine is kept busy:
+ * - 2 x ncpu allocator churn threads (the curl worker burst)
+ * - a log flusher doing write() + fsync() (zlog rotation, error logs)
+ *
+ * The run is repeated with the default scheduling and with the real-time
+ * profile (SCHED_FIFO input thread pinned to the last CPU, background
+ * load on the others, memory locked). Without CAP_SYS_NICE the second
+ * phase still runs, reports that SCHED_FIFO was not granted, and will
+ * look like the first.
+ *
+ * Environment:
+ * - BENCH_RT_SECONDS: duration of each phase (default 3)
+ * - BENCH_RT_MAX_US: fail if the real-time phase exceeds this worst case
+ *
+ * Exit status is non-zero if frames are lost or corrupted, or if
+ * BENCH_RT_MAX_US is set and exceeded.
+ */
+
+#define _GNU_SOURCE
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/realtime.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <linux/input.h>
+
+#define FRAME_INTERVAL_NS 2000000ull
+#define MAX_FRAMES 65536
+#define CHURN_MIN_BYTES 4096
+#define CHURN_MAX_BYTES (256 * 1024)
+#define FLUSH_CHUNK_BYTES (64 * 1024)
+
+typedef struct {
+    int read_fd;
+    int write_fd;
+    atomic_bool running;
+    atomic_bool load_running;
+
+    /* Written by the generator before the frame, read by the reader */
+    uint64_t sent_ns[MAX_FRAMES];
+    atomic_long frames_sent;
+
+    /* Reader results (preallocated, no allocation on the hot path) */
+    uint32_t latency_us[MAX_FRAMES];
+    long frames_handled;
+    long frames_corrupt;
+    bool policy_granted;
+} LatencyRun;
+
+static void* churn_thread(void* arg) {
+    LatencyRun* run = arg;
+    unsigned int seed = (unsigned int)(uintptr_t)&seed;
+
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+    while (atomic_load(&run->load_running)) {
+        size_t size = CHURN_MIN_BYTES + (size_t)rand_r(&seed) % (CHURN_MAX_BYTES - CHURN_MIN_BYTES);
+        unsigned char* block = malloc(size);
+        if (block) {
+            memset(block, (int)size, size);
+            free(block);
+        }
+    }
+    return NULL;
+}
+
+static void* flush_thread(void* arg) {
+    LatencyRun* run = arg;
+    static char chunk[FLUSH_CHUNK_BYTES];
+    char path[] = "/tmp/panelkit-rt-latency-XXXXXX";
+
+    realtime_enter(REALTIME_ROLE_BACKGROUND);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return NULL;
+    }
+    unlink(path);
+    memset(chunk, 'x', sizeof(chunk));
+
+    while (atomic_load(&run->load_running)) {
+        for (int i = 0; i < 16; i++) {
+            if (write(fd, chunk, sizeof(chunk)) < 0) {
+                break;
+            }
+        }
+        fsync(fd);
+        if (lseek(fd, 0, SEEK_SET) < 0 || ftruncate(fd, 0) < 0) {
+            break;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static void* generator_thread(void* arg) {
+    LatencyRun* run = arg;
+    struct input_event frame[3];
+    memset(frame, 0, sizeof(frame));
+    frame[0].type = EV_ABS;
+    frame[0].code = ABS_MT_POSITION_X;
+    frame[1].type = EV_ABS;
+    frame[1].code = ABS_MT_POSITION_Y;
+    frame[2].type = EV_SYN;
+    frame[2].code = SYN_REPORT;
+
+    uint64_t next = bench_now_ns();
+    long seq = 0;
+    while (atomic_load(&run->running) && seq < MAX_FRAMES) {
+        next += FRAME_INTERVAL_NS;
+        struct timespec ts = {
+            .tv_sec = (time_t)(next / 1000000000ull),
+            .tv_nsec = (long)(next % 1000000000ull)
+        };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+
+        frame[0].value = (int)seq;
+        frame[1].value = (int)(seq ^ 0x5a5a);
+        run->sent_ns[seq] = bench_now_ns();
+        atomic_store(&run->frames_sent, seq + 1);
+        if (write(run->write_fd, frame, sizeof(frame)) != (ssize_t)sizeof(frame)) {
+            break;
+        }
+        seq++;
+    }
+    return NULL;
+}
+
+/* Same wait/read structure as evdev_read_thread */
+static void* reader_thread(void* arg) {
+    LatencyRun* run = arg;
+    struct input_event events[64];
+    struct pollfd pfd = { .fd = run->read_fd, .events = POLLIN };
+    int x = -1;
+    int y = -1;
+
+    run->policy_granted = realtime_enter(REALTIME_ROLE_INPUT);
+
+    while (atomic_load(&run->running)) {
+        int ready = poll(&pfd, 1, 100);
+        if (ready <= 0) {
+            continue;
+        }
+        ssize_t bytes = read(run->read_fd, events, sizeof(events));
+        if (bytes <= 0) {
+            continue;
+        }
+
+        size_t count = (size_t)bytes / sizeof(events[0]);
+        for (size_t i = 0; i < count; i++) {
+            const struct input_event* ev = &events[i];
+            if (ev->type == EV_ABS && ev->code == ABS_MT_POSITION_X) {
+                x = ev->value;
+            } else if (ev->type == EV_ABS && ev->code == ABS_MT_POSITION_Y) {
+                y = ev->value;
+            } else if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+                uint64_t now = bench_now_ns();
+                if (x < 0 || x >= MAX_FRAMES || y != (x ^ 0x5a5a) ||
+                    x >= atomic_load(&run->frames_sent)) {
+                    run->frames_corrupt++;
+                } else {
+                    uint64_t latency = (now - run->sent_ns[x]) / 1000;
+                    run->latency_us[run->frames_handled++] =
+                        latency > UINT32_MAX ? UINT32_MAX : (uint32_t)latency;
+                }
+                x = -1;
+                y = -1;
+            }
+        }
+    }
+    return NULL;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t va = *(const uint32_t*)a;
+    uint32_t vb = *(const uint32_t*)b;
+    return va < vb ? -1 : va > vb;
+}
+
+static uint32_t percentile(const uint32_t* sorted, long count, double pct) {
+    if (count == 0) {
+        return 0;
+    }
+    long index = (long)(pct / 100.0 * (double)(count - 1) + 0.5);
+    return sorted[index];
+}
+
+/* Run one phase; returns failures and the worst case in *max_us */
+static int run_phase(const char* name, int seconds, uint32_t* max_us) {
+    LatencyRun* run = calloc(1, sizeof(LatencyRun));
+    int failures = 0;
+    int fds[2];
+
+    if (!run || pipe(fds) != 0) {
+        fprintf(stderr, "FAIL: cannot set up %s phase\n", name);
+        free(run);
+        return 1;
+    }
+    run->read_fd = fds[0];
+    run->write_fd = fds[1];
+    fcntl(run->read_fd, F_SETFL, O_NONBLOCK);
+    atomic_store(&run->running, true);
+    atomic_store(&run->load_running, true);
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int load_threads = (int)(ncpu > 0 ? ncpu : 1) * 2;
+    pthread_t* load = calloc((size_t)load_threads + 1, sizeof(pthread_t));
+    pthread_t reader, generator;
+
+    pthread_create(&reader, NULL, reader_thread, run);
+    for (int i = 0; i < load_threads; i++) {
+        pthread_create(&load[i], NULL, churn_thread, run);
+    }
+    pthread_create(&load[load_threads], NULL, flush_thread, run);
+
+    /* Locking after the threads exist covers their stacks too */
+    realtime_lock_memory();
+    pthread_create(&generator, NULL, generator_thread, run);
+
+    sleep((unsigned int)seconds);
+
+    atomic_store(&run->running, false);
+    pthread_join(generator, NULL);
+    pthread_join(reader, NULL);
+    atomic_store(&run->load_running, false);
+    for (int i = 0; i <= load_threads; i++) {
+        pthread_join(load[i], NULL);
+    }
+    free(load);
+    close(run->read_fd);
+    close(run->write_fd);
+
+    long sent = atomic_load(&run->frames_sent);
+    long handled = run->frames_handled;
+    qsort(run->latency_us, (size_t)handled, sizeof(uint32_t), compare_u32);
+    *max_us = handled > 0 ? run->latency_us[handled - 1] : 0;
+
+    printf("%-10s %7ld %7ld %8u %8u %8u %8u  %s\n", name, sent, handled,
+           percentile(run->latency_us, handled, 50.0),
+           percentile(run->latency_us, handled, 99.0),
+           percentile(run->latency_us, handled, 99.9),
+           *max_us,
+           !realtime_is_enabled() ? "SCHED_OTHER" :
+           run->policy_granted ? "SCHED_FIFO" : "SCHED_FIFO not granted");
+    fflush(stdout);
+
+    /* The final frame may still be in flight when the reader stops */
+    STRESS_CHECK(failures, handled >= sent - 1 && sent > 0,
+                 "%s: handled %ld of %ld frames", name, handled, sent);
+    STRESS_CHECK(failures, run->frames_corrupt == 0,
+                 "%s: %ld corrupt frames", name, run->frames_corrupt);
+
+    free(run);
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_rt_latency");
+
+    const char* env = getenv("BENCH_RT_SECONDS");
+    int seconds = env ? atoi(env) : 0;
+    if (seconds <= 0) {
+        seconds = 3;
+    }
+    env = getenv("BENCH_RT_MAX_US");
+    long max_allowed_us = env ? strtol(env, NULL, 10) : 0;
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("\n=== Input latency under load (%lds per phase, %ld CPUs, %ld load threads + log flusher) ===\n",
+           (long)seconds, ncpu, ncpu * 2);
+    printf("%-10s %7s %7s %8s %8s %8s %8s  %s\n",
+           "phase", "sent", "handled", "p50 us", "p99 us", "p99.9 us", "max us", "policy");
+
+    int failures = 0;
+    uint32_t default_max = 0;
+    uint32_t realtime_max = 0;
+
+    realtime_init(NULL);
+    failures += run_phase("default", seconds, &default_max);
+
+    RealtimeConfig config = realtime_default_config();
+    config.enabled = true;
+    if (ncpu > 1) {
+        snprintf(config.input_cpus, sizeof(config.input_cpus), "%ld", ncpu - 1);
+        snprintf(config.background_cpus, sizeof(config.background_cpus), "0-%ld", ncpu - 2);
+    }
+    if (!realtime_init(&config)) {
+        STRESS_CHECK(failures, false, "realtime_init rejected the bench profile");
+    } else {
+        failures += run_phase("realtime", seconds, &realtime_max);
+    }
+    realtime_shutdown();
+
+    if (max_allowed_us > 0) {
+        STRESS_CHECK(failures, realtime_max <= (uint32_t)max_allowed_us,
+                     "real-time worst case %uus exceeds BENCH_RT_MAX_US=%ld",
+                     realtime_max, max_allowed_us);
+    }
+
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "LATENCY FAILED" : "LATENCY PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,324 @@
+/**
+ * @file bench_state_store.c
+ * @brief State store get/set latency microbenchmarks
+ *
+ * Measures:
+ * - set/get latency vs number of stored items
+ * - get throughput under reader/writer thread mixes
+ * - wildcard query cost vs store size for exact, partial and full patterns
+ * - multi-key record writes: individual sets vs one transaction
+ * - derived values: formatting on every read vs a memoized computed key
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/state/state_store.h"
+#include <pthread.h>
+
+typedef struct {
+    double temperature;
+    int humidity;
+    char location[32];
+} BenchPayload;
+
+static void populate(StateStore* store, int count) {
+    BenchPayload payload = { 72.5, 40, "bench" };
+    char id[32];
+    for (int i = 0; i < count; i++) {
+        snprintf(id, sizeof(id), "item_%d", i);
+        state_store_set(store, "bench", id, &payload, sizeof(payload));
+    }
+}
+
+/* set/get latency vs item count (lookup goes through the id index) */
+static void bench_item_count(long iterations) {
+    static const int counts[] = {16, 64, 256, 1024, 4096};
+    BenchPayload payload = { 68.0, 55, "bench" };
+    char param[32];
+    char id[32];
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        StateStore* store = state_store_create();
+        populate(store, counts[c]);
+        long ops = iterations / (counts[c] / 16 + 1);
+        /* Prime stride spreads lookups across the whole store even when
+         * ops < item count, so position in the array does not skew results */
+
+        uint64_t start = bench_now_ns();
+        for (long i = 0; i < ops; i++) {
+            snprintf(id, sizeof(id), "item_%ld", (i * 7919) % counts[c]);
+            state_store_set(store, "bench", id, &payload, sizeof(payload));
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+        snprintf(param, sizeof(param), "items=%d", counts[c]);
+        bench_report("set_existing", param, ops, elapsed);
+
+        start = bench_now_ns();
+        for (long i = 0; i < ops; i++) {
+            snprintf(id, sizeof(id), "item_%ld", (i * 7919) % counts[c]);
+            free(state_store_get(store, "bench", id, NULL, NULL));
+        }
+        elapsed = bench_now_ns() - start;
+        bench_report("get_hit", param, ops, elapsed);
+
+        start = bench_now_ns();
+        for (long i = 0; i < ops; i++) {
+            free(state_store_get(store, "bench", "missing", NULL, NULL));
+        }
+        elapsed = bench_now_ns() - start;
+        bench_report("get_miss", param, ops, elapsed);
+
+        state_store_destroy(store);
+    }
+}
+
+typedef struct {
+    StateStore* store;
+    long iterations;
+    int item_count;
+    bool writer;
+} WorkerArgs;
+
+static void* store_worker(void* arg) {
+    WorkerArgs* args = arg;
+    BenchPayload payload = { 70.0, 50, "worker" };
+    char id[32];
+
+    for (long i = 0; i < args->iterations; i++) {
+        snprintf(id, sizeof(id), "item_%ld", i % args->item_count);
+        if (args->writer) {
+            payload.humidity = (int)i;
+            state_store_set(args->store, "bench", id, &payload, sizeof(payload));
+        } else {
+            free(state_store_get(args->store, "bench", id, NULL, NULL));
+        }
+    }
+    return NULL;
+}
+
+/* Aggregate throughput for reader/writer thread mixes */
+static void bench_thread_mix(long iterations) {
+    static const struct { int readers; int writers; } mixes[] = {
+        {1, 0}, {4, 0}, {3, 1}, {2, 2}, {0, 4}
+    };
+    const int item_count = 256;
+    char param[32];
+
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+        int nthreads = mixes[m].readers + mixes[m].writers;
+        StateStore* store = state_store_create();
+        populate(store, item_count);
+
+        pthread_t threads[8];
+        WorkerArgs args[8];
+        long per_thread = iterations / (nthreads * 4);
+
+        uint64_t start = bench_now_ns();
+        for (int t = 0; t < nthreads; t++) {
+            args[t] = (WorkerArgs){ store, per_thread, item_count,
+                                    t >= mixes[m].readers };
+            pthread_create(&threads[t], NULL, store_worker, &args[t]);
+        }
+        for (int t = 0; t < nthreads; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        snprintf(param, sizeof(param), "r=%d w=%d", mixes[m].readers, mixes[m].writers);
+        bench_report("mixed_ops", param, per_thread * nthreads, elapsed);
+        state_store_destroy(store);
+    }
+}
+
+static bool count_item(const char* type_name, const char* id, const void* data,
+                       size_t data_size, time_t timestamp, void* user_context) {
+    (void)type_name; (void)id; (void)data; (void)data_size; (void)timestamp;
+    (*(long*)user_context)++;
+    return true;
+}
+
+/* Wildcard queries over locations x types; exact sides should cost O(matches) */
+static void bench_wildcard(long iterations) {
+    static const char* types[] = { "weather_current", "weather_forecast", "air_quality", "alerts" };
+    static const int locations[] = {64, 256, 1024};
+    static const struct { const char* name; const char* pattern; } queries[] = {
+        { "wildcard_one_location", "*:loc_7" },
+        { "wildcard_one_type", "alerts:*" },
+        { "wildcard_type_prefix", "weather_*:loc_3" },
+        { "wildcard_id_glob", "*:loc_1?" },
+    };
+    BenchPayload payload = { 65.0, 30, "bench" };
+    char param[32];
+    char id[32];
+
+    for (size_t l = 0; l < sizeof(locations) / sizeof(locations[0]); l++) {
+        StateStore* store = state_store_create();
+        for (int i = 0; i < locations[l]; i++) {
+            snprintf(id, sizeof(id), "loc_%d", i);
+            for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+                state_store_set(store, types[t], id, &payload, sizeof(payload));
+            }
+        }
+        snprintf(param, sizeof(param), "items=%zu",
+                 (size_t)locations[l] * (sizeof(types) / sizeof(types[0])));
+
+        for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+            long ops = iterations / 64;
+            long visited = 0;
+            uint64_t start = bench_now_ns();
+            for (long i = 0; i < ops; i++) {
+                state_store_iterate_wildcard(store, queries[q].pattern, count_item, &visited);
+            }
+            bench_report(queries[q].name, param, ops, bench_now_ns() - start);
+        }
+
+        long ops = iterations / (locations[l] * 4);
+        long visited = 0;
+        uint64_t start = bench_now_ns();
+        for (long i = 0; i < ops; i++) {
+            state_store_iterate_all(store, count_item, &visited);
+        }
+        bench_report("iterate_all", param, ops, bench_now_ns() - start);
+
+        state_store_destroy(store);
+    }
+}
+
+static void count_change(const StateChange* change, void* user_context) {
+    (void)change;
+    (*(long*)user_context)++;
+}
+
+/* Writing one record of N fields: N sets (N notifications) vs one commit */
+static void bench_transaction(long iterations) {
+    static const int field_counts[] = {4, 16};
+    BenchPayload payload = { 71.0, 45, "bench" };
+    char param[32];
+    char id[32];
+
+    for (size_t f = 0; f < sizeof(field_counts) / sizeof(field_counts[0]); f++) {
+        int fields = field_counts[f];
+        long ops = iterations / fields;
+        long notifications = 0;
+        StateStore* store = state_store_create();
+        state_store_add_change_listener(store, count_change, &notifications);
+        snprintf(param, sizeof(param), "fields=%d", fields);
+
+        uint64_t start = bench_now_ns();
+        for (long i = 0; i < ops; i++) {
+            for (int k = 0; k < fields; k++) {
+                snprintf(id, sizeof(id), "field_%d", k);
+                state_store_set(store, "weather_current", id, &payload, sizeof(payload));
+            }
+        }
+        bench_report("record_individual_sets", param, ops, bench_now_ns() - start);
+
+        start = bench_now_ns();
+        for (long i = 0; i < ops; i++) {
+            StateTransaction* txn = state_store_begin(store);
+            for (int k = 0; k < fields; k++) {
+                snprintf(id, sizeof(id), "field_%d", k);
+                state_store_txn_set(txn, "weather_current", id, &payload, sizeof(payload));
+            }
+            state_store_commit(txn);
+        }
+        bench_report("record_transaction", param, ops, bench_now_ns() - start);
+
+        state_store_destroy(store);
+    }
+}
+
+/* derived value: format per read vs memoized computed key */
+
+typedef struct {
+    char text[64];
+} BenchLabel;
+
+static bool format_label(const StateComputeInput* inputs, size_t input_count,
+                         void* output, void* user_context) {
+    (void)input_count;
+    (void)user_context;
+    const BenchPayload* payload = inputs[0].data;
+    if (!payload) {
+        return false;
+    }
+    BenchLabel* label = output;
+    snprintf(label->text, sizeof(label->text), "%.1f°F / %.1f°C, %d%%",
+             payload->temperature, (payload->temperature - 32.0) * 5.0 / 9.0,
+             payload->humidity);
+    return true;
+}
+
+static void bench_computed(long iterations) {
+    BenchPayload payload = { 71.0, 45, "bench" };
+    volatile char sink = 0;
+    StateStore* store = state_store_create();
+    populate(store, 1000);
+    state_store_set(store, "weather_current", "91007", &payload, sizeof(payload));
+
+    const char* inputs[] = { "weather_current:91007" };
+    ComputedStateConfig config = {
+        .type_name = "weather_label",
+        .id = "91007",
+        .inputs = inputs,
+        .input_count = 1,
+        .value_size = sizeof(BenchLabel),
+        .compute = format_label
+    };
+    state_store_define_computed(store, &config);
+
+    // Baseline: every reader fetches the raw value and formats it
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        BenchPayload* raw = state_store_get(store, "weather_current", "91007", NULL, NULL);
+        StateComputeInput input = { "weather_current", "91007", raw, sizeof(*raw), 0 };
+        BenchLabel label;
+        format_label(&input, 1, &label, NULL);
+        sink = label.text[0];
+        free(raw);
+    }
+    bench_report("derive_per_read", "", iterations, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        BenchLabel* label = state_store_get(store, "weather_label", "91007", NULL, NULL);
+        sink = label->text[0];
+        free(label);
+    }
+    bench_report("computed_read_unchanged", "", iterations, bench_now_ns() - start);
+
+    // Input rewritten before every read: worst case, recompute each time
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        payload.humidity = (int)(i % 100);
+        state_store_set(store, "weather_current", "91007", &payload, sizeof(payload));
+        BenchLabel* label = state_store_get(store, "weather_label", "91007", NULL, NULL);
+        sink = label->text[0];
+        free(label);
+    }
+    bench_report("set_then_computed_read", "", iterations, bench_now_ns() - start);
+
+    ComputedStateStats stats;
+    state_store_get_computed_stats(store, "weather_label", "91007", &stats);
+    printf("  computed: %llu reads, %llu recomputes\n",
+           (unsigned long long)stats.reads, (unsigned long long)stats.recomputes);
+    (void)sink;
+
+    state_store_destroy(store);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "bench_state_store");
+
+    long iterations = bench_iterations();
+
+    bench_header("state_store");
+    bench_item_count(iterations);
+    bench_thread_mix(iterations);
+    bench_wildcard(iterations);
+    bench_transaction(iterations);
+    bench_computed(iterations);
+
+    logger_shutdown();
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file stress_api_client.c
+ * @brief Concurrency stress and latency benchmark for the API client
+ *
+ * Uses file:// URLs so no network or server is required. Several threads
+ * share one ApiClient (exercising its request lanes) while detached async
+ * requests run alongside. Response bodies are verified byte-for-byte.
+ *
+ * A mock API server route that never answers stands in for a slow
+ * background poll: an interactive request must complete without waiting
+ * for it, and a prefetch against it must be aborted by the interactive
+ * request.
+ *
+ * Requires SDL2 headers and libcurl; build with `make build-bench-api`.
+ */
+
+#include "bench_common.h"
+#include "../api/mock_api_server.h"
+#include "../../src/core/logger.h"
+#include "../../src/api/api_client.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <curl/curl.h>
+
+#define STRESS_THREADS 4
+#define STRESS_ASYNC_REQUESTS 32
+
+static const char* k_body = "{\"results\":[{\"name\":{\"first\":\"Stress\",\"last\":\"Test\"}}]}";
+
+static char g_url[512];
+static atomic_int g_async_done;
+static atomic_int g_async_failures;
+
+typedef struct {
+    ApiClient* client;
+    long iterations;
+    int failures;
+} SyncWorker;
+
+static void* sync_worker(void* arg) {
+    SyncWorker* w = arg;
+    for (long i = 0; i < w->iterations; i++) {
+        ApiResponse response;
+        ApiClientError err = api_client_request(w->client, HTTP_METHOD_GET,
+                                                g_url, NULL, &response);
+        if (err != API_CLIENT_SUCCESS || response.size != strlen(k_body) ||
+            memcmp(response.data, k_body, response.size) != 0) {
+            w->failures++;
+        }
+        api_response_cleanup(&response);
+    }
+    return NULL;
+}
+
+static void async_callback(ApiResponse* response, void* user_data) {
+    (void)user_data;
+    if (!response->data || response->size != strlen(k_body)) {
+        atomic_fetch_add(&g_async_failures, 1);
+    }
+    atomic_fetch_add(&g_async_done, 1);
+}
+
+static atomic_int g_prefetch_error;
+static atomic_int g_prefetch_done;
+
+static void prefetch_callback(ApiResponse* response, void* user_data) {
+    (void)user_data;
+    atomic_store(&g_prefetch_error, response->error);
+    atomic_store(&g_prefetch_done, 1);
+}
+
+/* Interactive latency with background lanes stuck on a stalled server */
+static int stress_priority_lanes(ApiClient* client) {
+    int failures = 0;
+    MockRoute stalled = { .path = "*", .hang_rate = 1.0 };
+    MockApiServer* server = mock_api_server_start(&stalled, 1, 0, 1);
+    if (!server) {
+        fprintf(stderr, "Failed to start stalled server\n");
+        return 1;
+    }
+    char slow_url[64];
+    mock_api_server_url(server, "/poll", slow_url, sizeof(slow_url));
+
+    api_client_request_async_priority(client, API_PRIORITY_PREFETCH, HTTP_METHOD_GET,
+                                      slow_url, NULL, prefetch_callback, NULL);
+    api_client_request_async(client, HTTP_METHOD_GET, slow_url, NULL, NULL, NULL);
+    usleep(200000);  /* Both background lanes now hold a stalled transfer */
+
+    uint64_t start = bench_now_ns();
+    ApiResponse response;
+    ApiClientError err = api_client_request_priority(client, API_PRIORITY_INTERACTIVE,
+                                                     HTTP_METHOD_GET, g_url, NULL,
+                                                     &response);
+    uint64_t elapsed = bench_now_ns() - start;
+    bench_report("interactive_vs_stalled_poll", "", 1, elapsed);
+    STRESS_CHECK(failures, err == API_CLIENT_SUCCESS && response.size == strlen(k_body),
+                 "interactive request failed: %s", api_client_error_string(err));
+    STRESS_CHECK(failures, elapsed < 500000000ull,
+                 "interactive request waited %.0f ms behind background work",
+                 (double)elapsed / 1e6);
+    api_response_cleanup(&response);
+
+    /* The prefetch is aborted at its next progress check */
+    for (int i = 0; i < 300 && !atomic_load(&g_prefetch_done); i++) {
+        usleep(10000);
+    }
+    STRESS_CHECK(failures, atomic_load(&g_prefetch_done) &&
+                 atomic_load(&g_prefetch_error) == API_CLIENT_ERROR_CANCELLED,
+                 "prefetch was not cancelled by the interactive request");
+
+    /* Release the scheduled lane so later tests are not held up */
+    api_client_cancel(client, API_PRIORITY_SCHEDULED);
+    mock_api_server_stop(server);
+    return failures;
+}
+
+static bool write_fixture(char* path, size_t path_size) {
+    snprintf(path, path_size, "/tmp/panelkit_stress_api_%d.json", (int)getpid());
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    fputs(k_body, f);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_api_client");
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    char path[256];
+    if (!write_fixture(path, sizeof(path))) {
+        fprintf(stderr, "Failed to write fixture file\n");
+        return 1;
+    }
+    snprintf(g_url, sizeof(g_url), "file://%s", path);
+
+    ApiClientConfig config = api_client_default_config();
+    config.max_retries = 0;
+    ApiClient* client = api_client_create(&config);
+    if (!client) {
+        fprintf(stderr, "Failed to create API client\n");
+        unlink(path);
+        return 1;
+    }
+
+    long iterations = bench_iterations() / 200 + 1;
+    int failures = 0;
+
+    bench_header("api_client");
+
+    /* Baseline single-threaded request latency */
+    SyncWorker single = { client, iterations, 0 };
+    uint64_t start = bench_now_ns();
+    sync_worker(&single);
+    bench_report("request_sync", "threads=1", iterations, bench_now_ns() - start);
+    failures += single.failures;
+
+    /* Shared client under contention, with async requests in flight */
+    atomic_store(&g_async_done, 0);
+    atomic_store(&g_async_failures, 0);
+    pthread_t threads[STRESS_THREADS];
+    SyncWorker workers[STRESS_THREADS];
+
+    start = bench_now_ns();
+    for (int i = 0; i < STRESS_ASYNC_REQUESTS; i++) {
+        if (api_client_request_async(client, HTTP_METHOD_GET, g_url, NULL,
+                                     async_callback, NULL) != API_CLIENT_SUCCESS) {
+            atomic_fetch_add(&g_async_failures, 1);
+            atomic_fetch_add(&g_async_done, 1);
+        }
+    }
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        workers[t] = (SyncWorker){ client, iterations, 0 };
+        pthread_create(&threads[t], NULL, sync_worker, &workers[t]);
+    }
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        STRESS_CHECK(failures, workers[t].failures == 0,
+                     "sync worker %d saw %d bad responses", t, workers[t].failures);
+    }
+    /* Async threads are detached; wait for their callbacks before teardown */
+    while (atomic_load(&g_async_done) < STRESS_ASYNC_REQUESTS) {
+        usleep(1000);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    bench_report("request_contended", "threads=4+async",
+                 iterations * STRESS_THREADS + STRESS_ASYNC_REQUESTS, elapsed);
+
+    STRESS_CHECK(failures, atomic_load(&g_async_failures) == 0,
+                 "%d async requests failed", atomic_load(&g_async_failures));
+
+    failures += stress_priority_lanes(client);
+
+    api_client_destroy(client);
+    unlink(path);
+    curl_global_cleanup();
+    logger_shutdown();
+
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,421 @@
+/**
+ * @file stress_bandwidth_budget.c
+ * @brief Bandwidth budget persistence, period rollover and interval scaling
+ *
+ * Checks:
+ * - counters saved by one budget load into the next, per endpoint, per
+ *   service and in total, and the save leaves no temporary file behind
+ * - counters saved on an earlier day lose their day bytes but keep the
+ *   billing period's; counters from an earlier billing period are dropped
+ * - a corrupt state file keeps its well-formed lines, and every prefix of
+ *   a saved file (a save cut short) loads without inventing bytes
+ * - intervals stay at the base rate up to an even pace, stretch by the
+ *   overspend ratio (3x checked against the expected pace), and stop at
+ *   max_stretch when overspending or exhausted, on either allowance
+ * - hidden endpoints stretch four times further and pause at 90% of the
+ *   daily or monthly allowance, and resume once visible again
+ * Also reports the cost of record and scale_interval.
+ *
+ * The budget reads the wall clock, so a run straddling local midnight (or
+ * the start of a billing period) can report a spurious rollover failure.
+ * Exit status is non-zero if any check fails.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/api/bandwidth_budget.h"
+#include <unistd.h>
+
+#define BASE_MS 60000u
+#define MAX_STRETCH 16
+
+static int failures;
+static char state_path[256];
+
+/* ---- Clock helpers mirroring the budget's period arithmetic ---- */
+
+static int tm_key(const struct tm* tm) {
+    return (tm->tm_year + 1900) * 10000 + (tm->tm_mon + 1) * 100 + tm->tm_mday;
+}
+
+static time_t local_midnight(struct tm tm) {
+    tm.tm_hour = 0;
+    tm.tm_min = 0;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+/* Today's key, yesterday's key and the current billing period's key */
+static void period_keys(int billing_day, int* today_key, int* yesterday_key, int* period_key) {
+    time_t now = time(NULL);
+    struct tm today;
+    localtime_r(&now, &today);
+    *today_key = tm_key(&today);
+
+    struct tm yesterday = today;
+    yesterday.tm_mday--;
+    time_t yesterday_start = local_midnight(yesterday);
+    localtime_r(&yesterday_start, &yesterday);
+    *yesterday_key = tm_key(&yesterday);
+
+    struct tm start = today;
+    if (today.tm_mday < billing_day) {
+        start.tm_mon--;
+    }
+    start.tm_mday = billing_day;
+    time_t period_start = local_midnight(start);
+    localtime_r(&period_start, &start);
+    *period_key = tm_key(&start);
+}
+
+/* Pace ratio the budget computes for `used` of a daily `limit` right now */
+static double day_pace(uint64_t used, uint64_t limit) {
+    time_t now = time(NULL);
+    struct tm today;
+    localtime_r(&now, &today);
+    time_t start = local_midnight(today);
+    struct tm tomorrow = today;
+    tomorrow.tm_mday++;
+    time_t end = local_midnight(tomorrow);
+
+    double elapsed = difftime(now, start);
+    if (elapsed < difftime(end, start) / 24.0) {
+        elapsed = difftime(end, start) / 24.0;
+    }
+    double remaining = difftime(end, now);
+    if (remaining < 1.0) {
+        remaining = 1.0;
+    }
+    return ((double)used / elapsed) / ((double)(limit - used) / remaining);
+}
+
+/* Bytes that make the daily pace come out at `ratio` */
+static uint64_t bytes_for_pace(uint64_t limit, double ratio) {
+    double pace_at_half = day_pace(limit / 2, limit);   /* remaining / elapsed */
+    double fraction = ratio / (pace_at_half + ratio);
+    return (uint64_t)(fraction * (double)limit);
+}
+
+/* ---- Helpers ---- */
+
+static bool write_file(const char* path, const char* content, size_t length) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(content, 1, length, file) == length;
+    return fclose(file) == 0 && ok;
+}
+
+static BandwidthBudget* create_budget(uint64_t daily, uint64_t monthly, const char* path) {
+    BandwidthBudgetConfig config = bandwidth_budget_default_config();
+    config.daily_bytes = daily;
+    config.monthly_bytes = monthly;
+    config.max_stretch = MAX_STRETCH;
+    config.state_path = path;
+    BandwidthBudget* budget = bandwidth_budget_create(&config);
+    STRESS_CHECK(failures, budget != NULL, "create failed: %s", pk_get_last_error_context());
+    return budget;
+}
+
+static BandwidthUsage usage_of(BandwidthBudget* budget, const char* service,
+                               const char* endpoint) {
+    BandwidthUsage usage;
+    if (bandwidth_budget_get_usage(budget, service, endpoint, &usage) != PK_OK) {
+        memset(&usage, 0, sizeof(usage));
+    }
+    return usage;
+}
+
+static bool usage_is(BandwidthUsage usage, uint64_t day, uint64_t month, uint64_t requests) {
+    return usage.day_bytes == day && usage.month_bytes == month && usage.requests == requests;
+}
+
+/* ---- Persistence ---- */
+
+static void test_round_trip(void) {
+    unlink(state_path);
+    BandwidthBudget* budget = create_budget(0, 0, state_path);
+    if (!budget) {
+        return;
+    }
+    for (int i = 0; i < 3; i++) {
+        bandwidth_budget_record(budget, "weather", "current", 1000);
+    }
+    bandwidth_budget_record(budget, "weather", "forecast", 5000);
+    bandwidth_budget_record(budget, "user", "profile", 200);
+    STRESS_CHECK(failures, bandwidth_budget_save(budget) == PK_OK, "save failed: %s",
+                 pk_get_last_error_context());
+    bandwidth_budget_destroy(budget);
+
+    char tmp_path[sizeof(state_path) + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", state_path);
+    STRESS_CHECK(failures, access(tmp_path, F_OK) != 0, "save left %s behind", tmp_path);
+
+    budget = create_budget(0, 0, state_path);
+    if (!budget) {
+        return;
+    }
+    BandwidthUsage total = usage_of(budget, NULL, NULL);
+    STRESS_CHECK(failures, usage_is(total, 8200, 8200, 5),
+                 "total after reload: %llu/%llu bytes, %llu requests",
+                 (unsigned long long)total.day_bytes, (unsigned long long)total.month_bytes,
+                 (unsigned long long)total.requests);
+    STRESS_CHECK(failures, usage_is(usage_of(budget, "weather", "current"), 3000, 3000, 3),
+                 "weather/current not restored");
+    STRESS_CHECK(failures, usage_is(usage_of(budget, "weather", NULL), 8000, 8000, 4),
+                 "weather service total not restored");
+    STRESS_CHECK(failures, usage_is(usage_of(budget, "user", "profile"), 200, 200, 1),
+                 "user/profile not restored");
+    bandwidth_budget_destroy(budget);
+}
+
+static void test_rollover(void) {
+    int today, yesterday, period;
+    period_keys(1, &today, &yesterday, &period);
+    char content[512];
+
+    /* Saved yesterday in the current billing period */
+    int length = snprintf(content, sizeof(content),
+                          "# PanelKit bandwidth counters\nday %d\nperiod %d\n"
+                          "total 700 900 4\nendpoint weather current 700 900 4\n",
+                          yesterday, period);
+    write_file(state_path, content, (size_t)length);
+    BandwidthBudget* budget = create_budget(0, 0, state_path);
+    if (budget) {
+        STRESS_CHECK(failures, usage_is(usage_of(budget, NULL, NULL), 0, 900, 4),
+                     "day rollover: day bytes kept or period bytes lost");
+        STRESS_CHECK(failures, usage_is(usage_of(budget, "weather", "current"), 0, 900, 4),
+                     "day rollover: endpoint day bytes kept or period bytes lost");
+        bandwidth_budget_destroy(budget);
+    }
+
+    /* Saved in an earlier billing period */
+    length = snprintf(content, sizeof(content),
+                      "day %d\nperiod 20000101\ntotal 700 900 4\n"
+                      "endpoint weather current 700 900 4\n", yesterday);
+    write_file(state_path, content, (size_t)length);
+    budget = create_budget(0, 0, state_path);
+    if (budget) {
+        STRESS_CHECK(failures, usage_is(usage_of(budget, NULL, NULL), 0, 0, 0),
+                     "billing rollover: totals kept");
+        STRESS_CHECK(failures, usage_is(usage_of(budget, "weather", "current"), 0, 0, 0),
+                     "billing rollover: endpoint counters kept");
+        bandwidth_budget_destroy(budget);
+    }
+
+    /* Today and the current period: nothing rolls */
+    length = snprintf(content, sizeof(content),
+                      "day %d\nperiod %d\ntotal 700 900 4\n", today, period);
+    write_file(state_path, content, (size_t)length);
+    budget = create_budget(0, 0, state_path);
+    if (budget) {
+        STRESS_CHECK(failures, usage_is(usage_of(budget, NULL, NULL), 700, 900, 4),
+                     "counters of the current day and period were dropped");
+        bandwidth_budget_destroy(budget);
+    }
+}
+
+static void test_damaged_files(void) {
+    int today, yesterday, period;
+    period_keys(1, &today, &yesterday, &period);
+    char content[1024];
+
+    int length = snprintf(content, sizeof(content),
+                          "day %d\nperiod %d\ngarbage line\ntotal 10 20\n"
+                          "endpoint weather current 1 2 3\n\xff\xfe\x01 binary\n"
+                          "endpoint weather forecast 4 5\nendpoint\n",
+                          today, period);
+    write_file(state_path, content, (size_t)length);
+    BandwidthBudget* budget = create_budget(0, 0, state_path);
+    if (budget) {
+        STRESS_CHECK(failures, usage_is(usage_of(budget, NULL, NULL), 0, 0, 0),
+                     "malformed total line was used");
+        STRESS_CHECK(failures, usage_is(usage_of(budget, "weather", "current"), 1, 2, 3),
+                     "well-formed endpoint line lost among corrupt ones");
+        BandwidthUsage ignored;
+        STRESS_CHECK(failures,
+                     bandwidth_budget_get_usage(budget, "weather", "forecast", &ignored) ==
+                         PK_ERROR_NOT_FOUND,
+                     "endpoint line with missing fields was loaded");
+        bandwidth_budget_destroy(budget);
+    }
+
+    write_file(state_path, "", 0);
+    budget = create_budget(0, 0, state_path);
+    if (budget) {
+        STRESS_CHECK(failures, usage_is(usage_of(budget, NULL, NULL), 0, 0, 0),
+                     "empty state file produced counters");
+        bandwidth_budget_destroy(budget);
+    }
+
+    /* Every prefix of a real save: never more than was saved */
+    length = snprintf(content, sizeof(content),
+                      "# PanelKit bandwidth counters\nday %d\nperiod %d\n"
+                      "total 123456 654321 42\nendpoint weather current 123000 654000 40\n"
+                      "endpoint user profile 456 321 2\n",
+                      today, period);
+    int bad_prefixes = 0;
+    int full_loads = 0;
+    for (int cut = 0; cut <= length; cut++) {
+        write_file(state_path, content, (size_t)cut);
+        budget = create_budget(0, 0, state_path);
+        if (!budget) {
+            bad_prefixes++;
+            continue;
+        }
+        BandwidthUsage total = usage_of(budget, NULL, NULL);
+        BandwidthUsage weather = usage_of(budget, "weather", "current");
+        BandwidthUsage user = usage_of(budget, "user", "profile");
+        if (total.day_bytes > 123456 || total.month_bytes > 654321 || total.requests > 42 ||
+            weather.day_bytes > 123000 || weather.month_bytes > 654000 ||
+            weather.requests > 40 || user.day_bytes > 456 || user.month_bytes > 321 ||
+            user.requests > 2) {
+            bad_prefixes++;
+        }
+        if (usage_is(total, 123456, 654321, 42) && usage_is(user, 456, 321, 2)) {
+            full_loads++;
+        }
+        bandwidth_budget_destroy(budget);
+    }
+    STRESS_CHECK(failures, bad_prefixes == 0,
+                 "%d of %d truncated saves failed to load or grew counters", bad_prefixes,
+                 length + 1);
+    STRESS_CHECK(failures, full_loads >= 1, "complete save did not load in full");
+}
+
+/* ---- Interval scaling ---- */
+
+static uint32_t scaled_after(uint64_t daily, uint64_t monthly, uint64_t used, bool visible) {
+    BandwidthBudget* budget = create_budget(daily, monthly, NULL);
+    if (!budget) {
+        return 0;
+    }
+    if (used > 0) {
+        bandwidth_budget_record(budget, "weather", "current", used);
+    }
+    bandwidth_budget_set_visible(budget, "weather", "current", visible);
+    uint32_t interval = bandwidth_budget_scale_interval(budget, "weather", "current", BASE_MS);
+    bandwidth_budget_destroy(budget);
+    return interval;
+}
+
+static void test_pace(void) {
+    const uint64_t limit = 1000000000ull;
+
+    STRESS_CHECK(failures, scaled_after(0, 0, 5000000, true) == BASE_MS,
+                 "unlimited budget stretched the interval");
+    STRESS_CHECK(failures, scaled_after(limit, 0, 0, true) == BASE_MS,
+                 "idle budget stretched the interval");
+    STRESS_CHECK(failures, scaled_after(limit, 0, 1, true) == BASE_MS,
+                 "spending below an even pace stretched the interval");
+
+    uint64_t used = bytes_for_pace(limit, 3.0);
+    double expected = day_pace(used, limit);
+    uint32_t interval = scaled_after(limit, 0, used, true);
+    double stretch = (double)interval / BASE_MS;
+    printf("%-32s %-20s expected %.3fx, got %.3fx\n", "pace stretch", "3x overspend",
+           expected, stretch);
+    STRESS_CHECK(failures, stretch > expected * 0.99 && stretch < expected * 1.01,
+                 "3x overspend stretched %.3fx, expected %.3fx", stretch, expected);
+
+    STRESS_CHECK(failures, scaled_after(limit, 0, limit - 1, true) == BASE_MS * MAX_STRETCH,
+                 "daily overspend not capped at max_stretch");
+    STRESS_CHECK(failures, scaled_after(0, limit, limit - 1, true) == BASE_MS * MAX_STRETCH,
+                 "monthly overspend not capped at max_stretch");
+    STRESS_CHECK(failures, scaled_after(limit, 0, limit * 2, true) == BASE_MS * MAX_STRETCH,
+                 "exhausted budget did not keep visible endpoints at max_stretch");
+    double with_monthly = (double)scaled_after(limit, limit * 1000, used, true) / BASE_MS;
+    STRESS_CHECK(failures, with_monthly > stretch * 0.99 && with_monthly < stretch * 1.01,
+                 "a slack monthly allowance changed the daily stretch (%.3fx)", with_monthly);
+}
+
+static void test_hidden(void) {
+    const uint64_t limit = 1000000000ull;
+    uint64_t cutoff = limit / 10 * 9;
+
+    STRESS_CHECK(failures, scaled_after(limit, 0, 0, false) == BASE_MS * 4,
+                 "idle hidden endpoint not stretched 4x");
+    uint32_t below = scaled_after(limit, 0, cutoff - 1, false);
+    STRESS_CHECK(failures, below >= BASE_MS * 4 && below <= BASE_MS * 4 * MAX_STRETCH,
+                 "hidden endpoint below 90%% got %u ms", below);
+    STRESS_CHECK(failures, scaled_after(limit, 0, cutoff, false) == BANDWIDTH_BUDGET_PAUSED,
+                 "hidden endpoint not paused at 90%% of the daily allowance");
+    STRESS_CHECK(failures, scaled_after(0, limit, cutoff, false) == BANDWIDTH_BUDGET_PAUSED,
+                 "hidden endpoint not paused at 90%% of the monthly allowance");
+    STRESS_CHECK(failures, scaled_after(limit, 0, limit * 2, false) == BANDWIDTH_BUDGET_PAUSED,
+                 "hidden endpoint polls with the budget exhausted");
+    STRESS_CHECK(failures, scaled_after(limit, 0, cutoff, true) != BANDWIDTH_BUDGET_PAUSED,
+                 "visible endpoint paused at 90%%");
+
+    BandwidthBudget* budget = create_budget(limit, 0, NULL);
+    if (!budget) {
+        return;
+    }
+    bandwidth_budget_record(budget, "weather", "current", cutoff);
+    STRESS_CHECK(failures,
+                 bandwidth_budget_scale_interval(budget, "other", "endpoint", BASE_MS) !=
+                     BANDWIDTH_BUDGET_PAUSED,
+                 "endpoint never marked hidden was paused");
+    bandwidth_budget_set_visible(budget, "weather", "current", false);
+    STRESS_CHECK(failures,
+                 bandwidth_budget_scale_interval(budget, "weather", "current", BASE_MS) ==
+                     BANDWIDTH_BUDGET_PAUSED,
+                 "hidden endpoint not paused");
+    bandwidth_budget_set_visible(budget, "weather", "current", true);
+    STRESS_CHECK(failures,
+                 bandwidth_budget_scale_interval(budget, "weather", "current", BASE_MS) !=
+                     BANDWIDTH_BUDGET_PAUSED,
+                 "endpoint stayed paused after becoming visible");
+    bandwidth_budget_destroy(budget);
+}
+
+/* ---- Cost ---- */
+
+static void measure(void) {
+    BandwidthBudget* budget = create_budget(1000000000ull, 30000000000ull, NULL);
+    if (!budget) {
+        return;
+    }
+    long iterations = bench_iterations();
+    char endpoint[16];
+
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        snprintf(endpoint, sizeof(endpoint), "ep%ld", i % 16);
+        bandwidth_budget_record(budget, "weather", endpoint, 1500);
+    }
+    bench_report("bandwidth_budget_record", "16 endpoints", iterations, bench_now_ns() - start);
+
+    volatile uint32_t sink = 0;
+    start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        snprintf(endpoint, sizeof(endpoint), "ep%ld", i % 16);
+        sink += bandwidth_budget_scale_interval(budget, "weather", endpoint, BASE_MS);
+    }
+    bench_report("bandwidth_budget_scale_interval", "16 endpoints", iterations,
+                 bench_now_ns() - start);
+    (void)sink;
+    bandwidth_budget_destroy(budget);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_bandwidth_budget");
+    snprintf(state_path, sizeof(state_path), "/tmp/stress_bandwidth_budget.%d.state",
+             (int)getpid());
+
+    bench_header("Bandwidth budget");
+    test_round_trip();
+    test_rollover();
+    test_damaged_files();
+    test_pace();
+    test_hidden();
+    measure();
+
+    unlink(state_path);
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
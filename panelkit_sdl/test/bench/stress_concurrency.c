@@ -0,0 +1,551 @@
+/**
+ * @file stress_concurrency.c
+ * @brief Multi-threaded stress test for event system, state store and error TLS
+ *
+ * Intended to be run under ThreadSanitizer (make build-bench-tsan) so that
+ * data races in the shared runtime are reported, but it also checks
+ * functional invariants on its own:
+ * - every emit reaches every permanent subscriber exactly once
+ * - unsubscribing with a context removes only that subscriber's entry
+ *   when every thread subscribes the same handler to the same event
+ * - readers never observe a torn state store payload
+ * - wildcard iteration sees only matching, untorn items and callbacks
+ *   can write back into the store without deadlocking
+ * - transactions are seen all-or-nothing and notify once per commit
+ * - computed keys see consistent inputs, never go backwards and are
+ *   recomputed at most once per input change
+ * - thread-local error context never leaks between threads
+ *
+ * Exit status is non-zero if any invariant is violated.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/events/event_system.h"
+#include "../../src/state/state_store.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define STRESS_THREADS 4
+#define STRESS_PERMANENT_SUBSCRIBERS 3
+#define STRESS_ITEM_COUNT 64
+
+// Event system stress
+
+static atomic_ulong g_shared_hits;
+
+static void shared_handler(const char* event_name, const void* data,
+                           size_t data_size, void* context) {
+    (void)event_name;
+    (void)data;
+    (void)data_size;
+    (void)context;
+    atomic_fetch_add(&g_shared_hits, 1);
+}
+
+static void churn_handler(const char* event_name, const void* data,
+                          size_t data_size, void* context) {
+    (void)event_name;
+    (void)data_size;
+    (void)context;
+    /* Touch the payload so TSan sees reads of emitter-owned memory */
+    volatile int value = *(const int*)data;
+    (void)value;
+}
+
+typedef struct {
+    EventSystem* events;
+    long iterations;
+    int index;
+    int failures;
+    atomic_long context_hits;   /* Deliveries to this worker's own subscription */
+} EventWorker;
+
+static void context_handler(const char* event_name, const void* data,
+                            size_t data_size, void* context) {
+    (void)event_name;
+    (void)data;
+    (void)data_size;
+    atomic_fetch_add(&((EventWorker*)context)->context_hits, 1);
+}
+
+static void* event_worker(void* arg) {
+    EventWorker* w = arg;
+    char churn_name[64];
+    snprintf(churn_name, sizeof(churn_name), "stress.churn.%d", w->index);
+
+    for (long i = 0; i < w->iterations; i++) {
+        int payload = (int)i;
+        /* Subscription churn concurrent with emits from other threads */
+        if (!event_subscribe(w->events, churn_name, churn_handler, NULL)) {
+            w->failures++;
+        }
+        event_emit(w->events, churn_name, &payload, sizeof(payload));
+        event_emit(w->events, "stress.shared", &payload, sizeof(payload));
+        if (!event_unsubscribe(w->events, churn_name, churn_handler)) {
+            w->failures++;
+        }
+
+        /* Same event and handler on every thread, told apart by context
+         * (as widgets on several displays are). Our own emit must reach our
+         * own subscription: no other thread may have removed it. */
+        if (!event_subscribe(w->events, "stress.contexts", context_handler, w)) {
+            w->failures++;
+        }
+        long hits = atomic_load(&w->context_hits);
+        event_emit(w->events, "stress.contexts", &payload, sizeof(payload));
+        if (atomic_load(&w->context_hits) == hits) {
+            w->failures++;
+        }
+        if (!event_unsubscribe_context(w->events, "stress.contexts", context_handler, w)) {
+            w->failures++;
+        }
+    }
+    return NULL;
+}
+
+static int stress_event_system(long iterations) {
+    EventSystem* events = event_system_create();
+    int failures = 0;
+
+    atomic_store(&g_shared_hits, 0);
+    for (int i = 0; i < STRESS_PERMANENT_SUBSCRIBERS; i++) {
+        event_subscribe(events, "stress.shared", shared_handler, NULL);
+    }
+
+    pthread_t threads[STRESS_THREADS];
+    EventWorker workers[STRESS_THREADS];
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        workers[t] = (EventWorker){ events, iterations, t, 0, 0 };
+        pthread_create(&threads[t], NULL, event_worker, &workers[t]);
+    }
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        failures += workers[t].failures;
+    }
+
+    unsigned long expected = (unsigned long)iterations * STRESS_THREADS *
+                             STRESS_PERMANENT_SUBSCRIBERS;
+    unsigned long hits = atomic_load(&g_shared_hits);
+    STRESS_CHECK(failures, hits == expected,
+                 "shared handler hits %lu, expected %lu", hits, expected);
+    STRESS_CHECK(failures,
+                 event_system_get_subscription_count(events) == STRESS_PERMANENT_SUBSCRIBERS,
+                 "subscription count %zu after churn",
+                 event_system_get_subscription_count(events));
+
+    event_system_destroy(events);
+    return failures;
+}
+
+// State store stress
+
+typedef struct {
+    long item;
+    long sequence;
+    long checksum;  /* item ^ sequence, detects torn writes */
+} StressPayload;
+
+typedef struct {
+    StateStore* store;
+    long iterations;
+    int role;       /* 0 = writer, 1 = reader, 2 = remover, 3 = iterator */
+    int failures;
+} StoreWorker;
+
+typedef struct {
+    StoreWorker* worker;
+    long visited;
+} IterateContext;
+
+static bool check_stress_item(const char* type_name, const char* id,
+                              const void* data, size_t data_size,
+                              time_t timestamp, void* user_context) {
+    (void)timestamp;
+    IterateContext* ctx = user_context;
+    const StressPayload* p = data;
+    long item = -1;
+
+    /* "*:item_1?" also matches the markers written below */
+    if (strcmp(type_name, "stress_marker") == 0) {
+        if (data_size != sizeof(*p) || p->item != -1 || p->checksum != -1) {
+            ctx->worker->failures++;
+            return false;
+        }
+        return true;
+    }
+
+    if (strcmp(type_name, "stress") != 0 || sscanf(id, "item_%ld", &item) != 1 ||
+        data_size != sizeof(*p) || p->item != item ||
+        (p->item ^ p->sequence) != p->checksum) {
+        ctx->worker->failures++;
+        return false;
+    }
+
+    /* Re-entrant write: would deadlock if the read lock were still held */
+    if (++ctx->visited % 16 == 0) {
+        StressPayload marker = { -1, 0, -1 };
+        state_store_set(ctx->worker->store, "stress_marker", id, &marker, sizeof(marker));
+    }
+    return true;
+}
+
+static void* store_worker(void* arg) {
+    StoreWorker* w = arg;
+    char id[32];
+
+    for (long i = 0; i < w->iterations; i++) {
+        long item = i % STRESS_ITEM_COUNT;
+        snprintf(id, sizeof(id), "item_%ld", item);
+
+        if (w->role == 0) {
+            StressPayload p = { item, i, item ^ i };
+            if (!state_store_set(w->store, "stress", id, &p, sizeof(p))) {
+                w->failures++;
+            }
+        } else if (w->role == 1) {
+            size_t size = 0;
+            StressPayload* p = state_store_get(w->store, "stress", id, &size, NULL);
+            if (p) {
+                if (size != sizeof(*p) || p->item != item ||
+                    (p->item ^ p->sequence) != p->checksum) {
+                    w->failures++;
+                }
+                free(p);
+            }
+        } else if (w->role == 2) {
+            state_store_remove(w->store, "stress", id);
+            if (i % 256 == 0) {
+                state_store_cleanup_expired(w->store);
+            }
+        } else if (i % 16 == 0) {
+            static const char* patterns[] = { "stress:*", "*:item_1?", "stress:item_2*", "st*ss" };
+            IterateContext ctx = { w, 0 };
+            state_store_iterate_wildcard(w->store, patterns[(i / 16) % 4],
+                                         check_stress_item, &ctx);
+        }
+    }
+    return NULL;
+}
+
+static int stress_state_store(long iterations) {
+    StateStore* store = state_store_create();
+    int failures = 0;
+
+    static const int roles[] = {0, 0, 1, 2, 3};
+    enum { STORE_THREADS = sizeof(roles) / sizeof(roles[0]) };
+    pthread_t threads[STORE_THREADS];
+    StoreWorker workers[STORE_THREADS];
+
+    for (int t = 0; t < STORE_THREADS; t++) {
+        workers[t] = (StoreWorker){ store, iterations, roles[t], 0 };
+        pthread_create(&threads[t], NULL, store_worker, &workers[t]);
+    }
+    for (int t = 0; t < STORE_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        STRESS_CHECK(failures, workers[t].failures == 0,
+                     "state store worker %d (role %d) saw %d bad results",
+                     t, workers[t].role, workers[t].failures);
+    }
+
+    state_store_destroy(store);
+    return failures;
+}
+
+// State transaction stress
+
+#define TXN_KEYS 4
+
+typedef struct {
+    StateStore* store;
+    long iterations;
+    bool writer;
+    int failures;
+} TxnWorker;
+
+typedef struct {
+    atomic_long notifications;
+    atomic_long bad_notifications;
+} TxnListenerStats;
+
+static void txn_listener(const StateChange* change, void* user_context) {
+    TxnListenerStats* stats = user_context;
+    atomic_fetch_add(&stats->notifications, 1);
+    if (change->key_count != TXN_KEYS) {
+        atomic_fetch_add(&stats->bad_notifications, 1);
+    }
+}
+
+typedef struct {
+    long sequence;
+    int seen;
+    bool consistent;
+} TxnCheck;
+
+static bool txn_check_item(const char* type_name, const char* id, const void* data,
+                           size_t data_size, time_t timestamp, void* user_context) {
+    (void)type_name; (void)id; (void)timestamp;
+    TxnCheck* check = user_context;
+    long sequence = data_size == sizeof(long) ? *(const long*)data : -1;
+    if (check->seen++ == 0) {
+        check->sequence = sequence;
+    } else if (sequence != check->sequence) {
+        check->consistent = false;
+    }
+    return true;
+}
+
+static void* txn_worker(void* arg) {
+    TxnWorker* w = arg;
+    char id[32];
+
+    for (long i = 0; i < w->iterations; i++) {
+        if (w->writer) {
+            /* Every key of a record carries the same sequence */
+            StateTransaction* txn = state_store_begin(w->store);
+            for (int k = 0; k < TXN_KEYS; k++) {
+                snprintf(id, sizeof(id), "field_%d", k);
+                state_store_txn_set(txn, "record", id, &i, sizeof(i));
+            }
+            if (!state_store_commit(txn)) {
+                w->failures++;
+            }
+        } else {
+            TxnCheck check = { -1, 0, true };
+            state_store_iterate_by_type(w->store, "record", txn_check_item, &check);
+            if (!check.consistent || (check.seen != 0 && check.seen != TXN_KEYS)) {
+                w->failures++;
+            }
+        }
+    }
+    return NULL;
+}
+
+static int stress_state_transactions(long iterations) {
+    StateStore* store = state_store_create();
+    TxnListenerStats stats;
+    atomic_init(&stats.notifications, 0);
+    atomic_init(&stats.bad_notifications, 0);
+    state_store_add_change_listener(store, txn_listener, &stats);
+    int failures = 0;
+
+    pthread_t threads[STRESS_THREADS];
+    TxnWorker workers[STRESS_THREADS];
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        workers[t] = (TxnWorker){ store, iterations, t == 0, 0 };
+        pthread_create(&threads[t], NULL, txn_worker, &workers[t]);
+    }
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        STRESS_CHECK(failures, workers[t].failures == 0,
+                     "transaction worker %d saw %d torn or failed commits",
+                     t, workers[t].failures);
+    }
+
+    STRESS_CHECK(failures, atomic_load(&stats.notifications) == iterations,
+                 "expected %ld commit notifications, got %ld",
+                 iterations, atomic_load(&stats.notifications));
+    STRESS_CHECK(failures, atomic_load(&stats.bad_notifications) == 0,
+                 "%ld notifications did not list all %d keys",
+                 atomic_load(&stats.bad_notifications), TXN_KEYS);
+    STRESS_CHECK(failures, state_store_get_version(store) == (uint64_t)iterations,
+                 "version %llu after %ld commits",
+                 (unsigned long long)state_store_get_version(store), iterations);
+
+    /* Clearing the record notifies every removed key, like a commit */
+    state_store_clear_type(store, "record");
+    STRESS_CHECK(failures, atomic_load(&stats.notifications) == iterations + 1 &&
+                 atomic_load(&stats.bad_notifications) == 0,
+                 "clear_type did not notify its %d removed keys", TXN_KEYS);
+
+    state_store_destroy(store);
+    return failures;
+}
+
+// Computed state stress
+
+typedef struct {
+    long sequence;
+    bool consistent;
+} RecordSummary;
+
+/* Pure function of the record fields: all must carry the same sequence */
+static bool summarize_record(const StateComputeInput* inputs, size_t input_count,
+                             void* output, void* user_context) {
+    (void)user_context;
+    RecordSummary* summary = output;
+    summary->consistent = true;
+    for (size_t i = 0; i < input_count; i++) {
+        if (!inputs[i].data || inputs[i].data_size != sizeof(long)) {
+            return false;
+        }
+        long sequence = *(const long*)inputs[i].data;
+        if (i == 0) {
+            summary->sequence = sequence;
+        } else if (sequence != summary->sequence) {
+            summary->consistent = false;
+        }
+    }
+    return true;
+}
+
+static void* computed_worker(void* arg) {
+    TxnWorker* w = arg;
+    char id[32];
+    long last_seen = -1;
+
+    for (long i = 0; i < w->iterations; i++) {
+        if (w->writer) {
+            StateTransaction* txn = state_store_begin(w->store);
+            for (int k = 0; k < TXN_KEYS; k++) {
+                snprintf(id, sizeof(id), "field_%d", k);
+                state_store_txn_set(txn, "record", id, &i, sizeof(i));
+            }
+            if (!state_store_commit(txn)) {
+                w->failures++;
+            }
+        } else {
+            size_t size = 0;
+            RecordSummary* summary = state_store_get(w->store, "record_summary", "all",
+                                                     &size, NULL);
+            if (summary) {
+                if (size != sizeof(*summary) || !summary->consistent ||
+                    summary->sequence < last_seen) {
+                    w->failures++;
+                }
+                last_seen = summary->sequence;
+                free(summary);
+            }
+        }
+    }
+    return NULL;
+}
+
+static int stress_computed_state(long iterations) {
+    StateStore* store = state_store_create();
+    int failures = 0;
+
+    const char* inputs[TXN_KEYS];
+    char keys[TXN_KEYS][32];
+    for (int k = 0; k < TXN_KEYS; k++) {
+        snprintf(keys[k], sizeof(keys[k]), "record:field_%d", k);
+        inputs[k] = keys[k];
+    }
+    ComputedStateConfig config = {
+        .type_name = "record_summary",
+        .id = "all",
+        .inputs = inputs,
+        .input_count = TXN_KEYS,
+        .value_size = sizeof(RecordSummary),
+        .compute = summarize_record
+    };
+    STRESS_CHECK(failures, state_store_define_computed(store, &config),
+                 "define_computed failed: %s", pk_get_last_error_context());
+
+    pthread_t threads[STRESS_THREADS];
+    TxnWorker workers[STRESS_THREADS];
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        workers[t] = (TxnWorker){ store, iterations, t == 0, 0 };
+        pthread_create(&threads[t], NULL, computed_worker, &workers[t]);
+    }
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        STRESS_CHECK(failures, workers[t].failures == 0,
+                     "computed worker %d saw %d inconsistent or stale summaries",
+                     t, workers[t].failures);
+    }
+
+    // One more read after the last commit must reflect it
+    RecordSummary* summary = state_store_get(store, "record_summary", "all", NULL, NULL);
+    STRESS_CHECK(failures, summary && summary->sequence == iterations - 1,
+                 "final summary sequence %ld, expected %ld",
+                 summary ? summary->sequence : -1, iterations - 1);
+    free(summary);
+
+    ComputedStateStats stats = {0};
+    state_store_get_computed_stats(store, "record_summary", "all", &stats);
+    STRESS_CHECK(failures, stats.recomputes <= (uint64_t)iterations + 1,
+                 "%llu recomputes for %ld input changes",
+                 (unsigned long long)stats.recomputes, iterations);
+
+    state_store_destroy(store);
+    return failures;
+}
+
+// Error TLS stress
+
+typedef struct {
+    long iterations;
+    int index;
+    int failures;
+} ErrorWorker;
+
+static void* error_worker(void* arg) {
+    ErrorWorker* w = arg;
+    char expected[64];
+
+    for (long i = 0; i < w->iterations; i++) {
+        PkError code = (w->index % 2) ? PK_ERROR_TIMEOUT : PK_ERROR_NOT_FOUND;
+        pk_set_last_error_with_context(code, "thread %d iteration %ld", w->index, i);
+        snprintf(expected, sizeof(expected), "thread %d iteration %ld", w->index, i);
+
+        if (pk_get_last_error() != code ||
+            strcmp(pk_get_last_error_context(), expected) != 0) {
+            w->failures++;
+        }
+    }
+    pk_clear_last_error();
+    return NULL;
+}
+
+static int stress_error_tls(long iterations) {
+    int failures = 0;
+    pthread_t threads[STRESS_THREADS];
+    ErrorWorker workers[STRESS_THREADS];
+
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        workers[t] = (ErrorWorker){ iterations, t, 0 };
+        pthread_create(&threads[t], NULL, error_worker, &workers[t]);
+    }
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        STRESS_CHECK(failures, workers[t].failures == 0,
+                     "error TLS worker %d saw %d foreign contexts",
+                     t, workers[t].failures);
+    }
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_concurrency");
+
+    long iterations = bench_iterations() / 20;
+    int failures = 0;
+
+    printf("Running concurrency stress (%d threads, %ld iterations each)\n",
+           STRESS_THREADS, iterations);
+
+    failures += stress_event_system(iterations);
+    printf("  event_system: %s\n", failures ? "FAILED" : "ok");
+
+    int store_failures = stress_state_store(iterations);
+    printf("  state_store:  %s\n", store_failures ? "FAILED" : "ok");
+    failures += store_failures;
+
+    int txn_failures = stress_state_transactions(iterations);
+    printf("  transactions: %s\n", txn_failures ? "FAILED" : "ok");
+    failures += txn_failures;
+
+    int computed_failures = stress_computed_state(iterations);
+    printf("  computed:     %s\n", computed_failures ? "FAILED" : "ok");
+    failures += computed_failures;
+
+    int error_failures = stress_error_tls(iterations);
+    printf("  error TLS:    %s\n", error_failures ? "FAILED" : "ok");
+    failures += error_failures;
+
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,310 @@
+/**
+ * @file stress_event_priority.c
+ * @brief Priority classes and per-frame budgets for queued events
+ *
+ * Checks:
+ * - priority rules resolve exact names before prefixes, longer prefixes
+ *   before shorter ones, and unmatched names to normal
+ * - one dispatch delivers high, then normal, then low events, each class
+ *   in posting order
+ * - events a handler posts wait for the next dispatch
+ * - a full class refuses events with PK_ERROR_EVENT_QUEUE_FULL
+ * - a data-refresh burst (slow low-priority handlers, posted from a
+ *   "fetch" thread) does not delay touches posted from an "input" thread:
+ *   touch latency and the longest frame are reported with the budget off
+ *   (everything in one frame) and on, and bounded when it is on
+ * - with the budget on, every low event is still delivered in order and
+ *   the backlog catches up once it has waited max_defer_ms
+ *
+ * Exit status is non-zero if any check fails.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/events/event_system.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define FRAME_US 4000
+#define REFRESH_COST_US 200
+#define BURST_EVENTS 400
+#define TOUCH_PERIOD_US 3000
+#define LOW_BUDGET_US 2000
+#define MAX_DEFER_MS 100
+
+static int failures;
+
+static void sleep_us(long us) {
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000L };
+    nanosleep(&ts, NULL);
+}
+
+static void spin_us(long us) {
+    uint64_t until = bench_now_ns() + (uint64_t)us * 1000;
+    while (bench_now_ns() < until) {
+    }
+}
+
+/* ---- Rules and ordering ---- */
+
+typedef struct {
+    char log[64];
+    int count;
+} OrderLog;
+
+static void order_handler(const char* event_name, const void* data, size_t data_size,
+                          void* context) {
+    (void)event_name;
+    (void)data_size;
+    OrderLog* log = context;
+    if (log->count < (int)sizeof(log->log) - 1) {
+        log->log[log->count++] = *(const char*)data;
+        log->log[log->count] = '\0';
+    }
+}
+
+static void test_rules(void) {
+    EventSystem* events = event_system_create();
+
+    STRESS_CHECK(failures, event_get_priority(events, "input.touch_down") == EVENT_PRIORITY_HIGH,
+                 "input.* is not high by default");
+    STRESS_CHECK(failures, event_get_priority(events, "api.user_data_updated") == EVENT_PRIORITY_LOW,
+                 "api.* is not low by default");
+    STRESS_CHECK(failures, event_get_priority(events, "state.changed") == EVENT_PRIORITY_NORMAL,
+                 "unmatched event is not normal");
+
+    event_set_priority(events, "api.refresh_*", EVENT_PRIORITY_NORMAL);
+    event_set_priority(events, "api.refresh_now", EVENT_PRIORITY_HIGH);
+    STRESS_CHECK(failures, event_get_priority(events, "api.refresh_requested") == EVENT_PRIORITY_NORMAL,
+                 "longer prefix did not win");
+    STRESS_CHECK(failures, event_get_priority(events, "api.refresh_now") == EVENT_PRIORITY_HIGH,
+                 "exact name did not win");
+    STRESS_CHECK(failures, event_get_priority(events, "api.other") == EVENT_PRIORITY_LOW,
+                 "shorter prefix lost its events");
+
+    event_set_priority(events, "api.*", EVENT_PRIORITY_NORMAL);
+    STRESS_CHECK(failures, event_get_priority(events, "api.other") == EVENT_PRIORITY_NORMAL,
+                 "re-setting a rule did not replace it");
+    STRESS_CHECK(failures, !event_set_priority(events, "*", EVENT_PRIORITY_LOW),
+                 "empty prefix accepted");
+    STRESS_CHECK(failures, !event_set_priority(events, "x", EVENT_PRIORITY_COUNT),
+                 "invalid priority accepted");
+
+    event_system_destroy(events);
+}
+
+static void test_ordering(void) {
+    EventSystem* events = event_system_create();
+    OrderLog log = { .count = 0 };
+    event_subscribe(events, "input.touch_down", order_handler, &log);
+    event_subscribe(events, "state.changed", order_handler, &log);
+    event_subscribe(events, "api.user_data_updated", order_handler, &log);
+
+    /* Lows a-d, normals A-C, highs 1-3, interleaved */
+    static const struct { const char* name; char tag; } posts[] = {
+        { "api.user_data_updated", 'a' }, { "state.changed", 'A' },
+        { "api.user_data_updated", 'b' }, { "input.touch_down", '1' },
+        { "state.changed", 'B' }, { "api.user_data_updated", 'c' },
+        { "input.touch_down", '2' }, { "state.changed", 'C' },
+        { "api.user_data_updated", 'd' }, { "input.touch_down", '3' },
+    };
+    for (size_t i = 0; i < sizeof(posts) / sizeof(posts[0]); i++) {
+        event_post(events, posts[i].name, &posts[i].tag, 1);
+    }
+    STRESS_CHECK(failures, log.count == 0, "event_post delivered synchronously");
+
+    size_t delivered = event_dispatch_pending(events);
+    STRESS_CHECK(failures, delivered == 10, "dispatch delivered %zu of 10", delivered);
+    STRESS_CHECK(failures, strcmp(log.log, "123ABCabcd") == 0,
+                 "dispatch order %s, expected 123ABCabcd", log.log);
+
+    event_system_destroy(events);
+}
+
+/* Re-posts itself every time it runs */
+static void repost_handler(const char* event_name, const void* data, size_t data_size,
+                           void* context) {
+    (*(int*)context)++;
+    event_post((EventSystem*)((void**)data)[0], event_name, data, data_size);
+}
+
+static void test_repost_and_limit(void) {
+    EventSystem* events = event_system_create();
+    int runs = 0;
+    event_subscribe(events, "bench.repost", repost_handler, &runs);
+    void* self[1] = { events };
+    event_post(events, "bench.repost", self, sizeof(self));
+
+    for (int frame = 1; frame <= 3; frame++) {
+        event_dispatch_pending(events);
+        STRESS_CHECK(failures, runs == frame, "re-posting handler ran %d times in %d dispatches",
+                     runs, frame);
+    }
+    event_unsubscribe_all(events, "bench.repost");
+    event_dispatch_pending(events);
+
+    int accepted = 0;
+    PkError last = PK_OK;
+    for (int i = 0; i < 1100; i++) {
+        last = event_post(events, "bench.flood", &i, sizeof(i));
+        if (last == PK_OK) {
+            accepted++;
+        }
+    }
+    EventQueueStats stats;
+    event_system_get_queue_stats(events, &stats);
+    STRESS_CHECK(failures, accepted == 1024 && last == PK_ERROR_EVENT_QUEUE_FULL,
+                 "flood: %d accepted, last error %d", accepted, (int)last);
+    STRESS_CHECK(failures, stats.dropped[EVENT_PRIORITY_NORMAL] == 1100 - 1024,
+                 "flood: %llu dropped", (unsigned long long)stats.dropped[EVENT_PRIORITY_NORMAL]);
+
+    event_system_destroy(events);
+}
+
+/* ---- Data-refresh burst against touch input ---- */
+
+typedef struct {
+    EventSystem* events;
+    atomic_bool stop;
+
+    /* Touch latency, post to handler (main thread only) */
+    uint64_t touch_max_ns;
+    uint64_t touch_total_ns;
+    long touches;
+
+    /* Refresh delivery order */
+    int next_refresh;
+    int refresh_out_of_order;
+} BurstContext;
+
+static void touch_handler(const char* event_name, const void* data, size_t data_size,
+                          void* context) {
+    (void)event_name;
+    (void)data_size;
+    BurstContext* ctx = context;
+    uint64_t latency = bench_now_ns() - *(const uint64_t*)data;
+    ctx->touch_total_ns += latency;
+    ctx->touches++;
+    if (latency > ctx->touch_max_ns) {
+        ctx->touch_max_ns = latency;
+    }
+}
+
+static void refresh_handler(const char* event_name, const void* data, size_t data_size,
+                            void* context) {
+    (void)event_name;
+    (void)data_size;
+    BurstContext* ctx = context;
+    if (*(const int*)data != ctx->next_refresh) {
+        ctx->refresh_out_of_order++;
+    }
+    ctx->next_refresh = *(const int*)data + 1;
+    spin_us(REFRESH_COST_US);  /* Parsing, state mirroring, re-layout */
+}
+
+static void* input_thread(void* arg) {
+    BurstContext* ctx = arg;
+    while (!atomic_load(&ctx->stop)) {
+        uint64_t now = bench_now_ns();
+        event_post(ctx->events, "input.touch_down", &now, sizeof(now));
+        sleep_us(TOUCH_PERIOD_US);
+    }
+    return NULL;
+}
+
+static void* fetch_thread(void* arg) {
+    BurstContext* ctx = arg;
+    for (int i = 0; i < BURST_EVENTS; i++) {
+        event_post(ctx->events, "api.user_data_updated", &i, sizeof(i));
+    }
+    return NULL;
+}
+
+static void bench_burst(uint32_t budget_us) {
+    BurstContext ctx = { .events = event_system_create() };
+    atomic_init(&ctx.stop, false);
+    event_set_dispatch_budget(ctx.events, budget_us, MAX_DEFER_MS);
+    event_subscribe(ctx.events, "input.touch_down", touch_handler, &ctx);
+    event_subscribe(ctx.events, "api.user_data_updated", refresh_handler, &ctx);
+
+    pthread_t input, fetch;
+    pthread_create(&input, NULL, input_thread, &ctx);
+
+    /* A few quiet frames, then the burst arrives; frames continue until it
+     * has been delivered, plus a few quiet ones */
+    uint64_t max_frame_ns = 0;
+    uint64_t start = bench_now_ns();
+    int frames = 0;
+    int quiet = 0;
+    while (quiet < 5 && frames < 10000) {
+        uint64_t frame_start = bench_now_ns();
+        event_dispatch_pending(ctx.events);
+        uint64_t frame_ns = bench_now_ns() - frame_start;
+        if (frame_ns > max_frame_ns) {
+            max_frame_ns = frame_ns;
+        }
+        if (++frames == 5) {
+            pthread_create(&fetch, NULL, fetch_thread, &ctx);
+        }
+        quiet = frames > 5 && ctx.next_refresh == BURST_EVENTS ? quiet + 1 : 0;
+        sleep_us(FRAME_US);
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+
+    atomic_store(&ctx.stop, true);
+    pthread_join(fetch, NULL);
+    pthread_join(input, NULL);
+
+    EventQueueStats stats;
+    event_system_get_queue_stats(ctx.events, &stats);
+
+    char param[32];
+    snprintf(param, sizeof(param), budget_us ? "budget=%uus" : "budget=off", budget_us);
+    bench_report("frame with refresh burst", param, frames, elapsed);
+    printf("%-32s %-20s touch avg %6.2f ms max %6.2f ms, frame max %6.2f ms, "
+           "refresh wait max %4llu ms, %llu deferrals, %llu forced\n", "", "",
+           ctx.touches ? (double)ctx.touch_total_ns / (double)ctx.touches / 1e6 : 0.0,
+           (double)ctx.touch_max_ns / 1e6, (double)max_frame_ns / 1e6,
+           (unsigned long long)(stats.max_wait_us[EVENT_PRIORITY_LOW] / 1000),
+           (unsigned long long)stats.deferrals, (unsigned long long)stats.forced);
+
+    STRESS_CHECK(failures, ctx.next_refresh == BURST_EVENTS && ctx.refresh_out_of_order == 0,
+                 "%s: refreshes delivered up to %d of %d, %d out of order", param,
+                 ctx.next_refresh, BURST_EVENTS, ctx.refresh_out_of_order);
+    STRESS_CHECK(failures, stats.dropped[EVENT_PRIORITY_LOW] == 0 &&
+                 stats.dropped[EVENT_PRIORITY_HIGH] == 0, "%s: events dropped", param);
+
+    if (budget_us > 0) {
+        /* Two budgets plus the handler that crosses the line, with slack
+         * for the poster threads preempting a handler on a single core */
+        uint64_t frame_bound_ns = (2ULL * budget_us + REFRESH_COST_US) * 1000ULL + 10000000ULL;
+        STRESS_CHECK(failures, max_frame_ns <= frame_bound_ns,
+                     "%s: longest frame %.2f ms, bound %.2f ms", param,
+                     (double)max_frame_ns / 1e6, (double)frame_bound_ns / 1e6);
+        STRESS_CHECK(failures, ctx.touch_max_ns <= frame_bound_ns + FRAME_US * 1000ULL * 2,
+                     "%s: touch waited %.2f ms", param, (double)ctx.touch_max_ns / 1e6);
+        STRESS_CHECK(failures, stats.deferrals > 0, "%s: burst was never deferred", param);
+        STRESS_CHECK(failures, stats.forced > 0,
+                     "%s: backlog older than %d ms never caught up", param, MAX_DEFER_MS);
+    }
+
+    event_system_destroy(ctx.events);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_event_priority");
+
+    test_rules();
+    test_ordering();
+    test_repost_and_limit();
+
+    bench_header("Queued events: 400 x 200us refreshes vs touches every 3 ms (4 ms frames)");
+    bench_burst(0);
+    bench_burst(LOW_BUDGET_US);
+
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
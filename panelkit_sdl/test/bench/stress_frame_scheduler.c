@@ -0,0 +1,354 @@
+/**
+ * @file stress_frame_scheduler.c
+ * @brief Frame scheduler budget and vblank targeting on a synthetic clock
+ *
+ * The scheduler runs on a fake clock and a simulated display whose
+ * vblanks fall on a fixed grid, so every timestamp, and therefore every
+ * decision, is exact.
+ *
+ * Checks:
+ * - the budget is the worst cost in history plus the safety margin, the
+ *   frame starts exactly one budget before its target vblank and lands on
+ *   it, and a frame queued for a future vblank is never targeted again
+ * - a cost spike misses exactly one deadline, raises the budget for as
+ *   many frames as the history holds, then drops back
+ * - frames costing more than a period aim two vblanks out and halve the
+ *   rate without counting missed deadlines
+ * - the refresh period converges on the measured vblank spacing
+ * - without vblank timestamps the present wait is not counted as cost
+ * - with late latching off frames start one period apart
+ * Also reports the cost of a scheduled frame.
+ *
+ * Exit status is non-zero if any check fails.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/display/frame_scheduler.h"
+
+#define NS_PER_US 1000ull
+#define NS_PER_MS 1000000ull
+#define NS_PER_SEC 1000000000ull
+
+#define PERIOD_60HZ (NS_PER_SEC / 60)
+#define MARGIN_US 2000
+
+static int failures;
+
+/* Fake clock plus a display flipping on a fixed vblank grid */
+typedef struct {
+    uint64_t now;
+    uint64_t first_vblank;
+    uint64_t period;
+    int sleeps;
+    uint64_t last_deadline;
+} SimClock;
+
+static uint64_t sim_now(void* user_data) {
+    return ((SimClock*)user_data)->now;
+}
+
+static void sim_sleep(uint64_t deadline_ns, void* user_data) {
+    SimClock* clock = user_data;
+    clock->sleeps++;
+    clock->last_deadline = deadline_ns;
+    if (deadline_ns > clock->now) {
+        clock->now = deadline_ns;
+    }
+}
+
+static uint64_t sim_vblank_at_or_after(const SimClock* clock, uint64_t t) {
+    if (t <= clock->first_vblank) {
+        return clock->first_vblank;
+    }
+    uint64_t periods = (t - clock->first_vblank + clock->period - 1) / clock->period;
+    return clock->first_vblank + periods * clock->period;
+}
+
+static void sim_init(SimClock* clock, uint64_t period) {
+    memset(clock, 0, sizeof(*clock));
+    clock->now = NS_PER_SEC;
+    clock->first_vblank = NS_PER_SEC + 10 * NS_PER_MS;
+    clock->period = period;
+}
+
+static FrameScheduler* create_scheduler(SimClock* clock, bool late_latch, int history) {
+    FrameSchedulerConfig config = frame_scheduler_default_config();
+    config.late_latch = late_latch;
+    config.target_fps = 60;
+    config.safety_margin_us = MARGIN_US;
+    config.history_frames = history;
+
+    FrameScheduler* scheduler = frame_scheduler_create(&config);
+    STRESS_CHECK(failures, scheduler != NULL, "create failed");
+    if (scheduler) {
+        frame_scheduler_set_clock(scheduler, sim_now, sim_sleep, clock);
+    }
+    return scheduler;
+}
+
+/* One loop iteration: the frame flips at the first vblank after its
+ * submit and the backend reports that vblank's timestamp */
+static uint64_t run_frame(FrameScheduler* scheduler, SimClock* clock, uint64_t cost_ns) {
+    frame_scheduler_wait(scheduler);
+    frame_scheduler_begin_frame(scheduler);
+    clock->now += cost_ns;
+    frame_scheduler_mark_submit(scheduler);
+    uint64_t vblank = sim_vblank_at_or_after(clock, clock->now);
+    frame_scheduler_end_frame(scheduler, vblank);
+    return vblank;
+}
+
+static void test_late_latch(void) {
+    SimClock clock;
+    sim_init(&clock, PERIOD_60HZ);
+    FrameScheduler* scheduler = create_scheduler(&clock, true, 16);
+    if (!scheduler) {
+        return;
+    }
+    const FrameSchedulerStats* stats = frame_scheduler_get_stats(scheduler);
+
+    /* Unpaced first frame: 4ms in, queued for the vblank 6ms later */
+    uint64_t shown = run_frame(scheduler, &clock, 4 * NS_PER_MS);
+    STRESS_CHECK(failures, shown == clock.first_vblank && clock.sleeps == 0,
+                 "first frame slept or missed the first vblank");
+
+    /* now + budget lands exactly on the pending vblank, which the next
+     * frame must not target a second time */
+    uint64_t budget = 4 * NS_PER_MS + MARGIN_US * NS_PER_US;
+    uint64_t expected = shown + PERIOD_60HZ;
+    shown = run_frame(scheduler, &clock, 4 * NS_PER_MS);
+    STRESS_CHECK(failures, clock.last_deadline == expected - budget,
+                 "started at %llu, expected %llu",
+                 (unsigned long long)clock.last_deadline,
+                 (unsigned long long)(expected - budget));
+    STRESS_CHECK(failures, shown == expected, "second frame not on the next vblank");
+
+    for (int i = 0; i < 30; i++) {
+        expected = shown + PERIOD_60HZ;
+        shown = run_frame(scheduler, &clock, 4 * NS_PER_MS);
+        STRESS_CHECK(failures, shown == expected, "frame %d skipped a vblank", i);
+        STRESS_CHECK(failures, clock.last_deadline == expected - budget,
+                     "frame %d started %lldns off its budget", i,
+                     (long long)(clock.last_deadline - (expected - budget)));
+    }
+    STRESS_CHECK(failures, stats->predicted_cost_us == 6000,
+                 "predicted %uus, expected 6000us", stats->predicted_cost_us);
+    STRESS_CHECK(failures, stats->last_latency_us == 6000,
+                 "latency %uus, expected 6000us", stats->last_latency_us);
+    STRESS_CHECK(failures, stats->last_cost_us == 4000, "cost %uus", stats->last_cost_us);
+    STRESS_CHECK(failures, stats->missed_deadlines == 0,
+                 "%llu missed deadlines at a steady 4ms",
+                 (unsigned long long)stats->missed_deadlines);
+    STRESS_CHECK(failures, stats->vblank_measured && stats->frames == 32,
+                 "frames %llu", (unsigned long long)stats->frames);
+    STRESS_CHECK(failures, stats->refresh_period_us == PERIOD_60HZ / NS_PER_US,
+                 "period drifted to %uus on an exact grid", stats->refresh_period_us);
+
+    frame_scheduler_destroy(scheduler);
+}
+
+static void test_cost_spike(void) {
+    const int history = 4;
+    SimClock clock;
+    sim_init(&clock, PERIOD_60HZ);
+    FrameScheduler* scheduler = create_scheduler(&clock, true, history);
+    if (!scheduler) {
+        return;
+    }
+    const FrameSchedulerStats* stats = frame_scheduler_get_stats(scheduler);
+
+    uint64_t shown = 0;
+    for (int i = 0; i < 8; i++) {
+        shown = run_frame(scheduler, &clock, 4 * NS_PER_MS);
+    }
+
+    /* Budgeted 6ms, took 9ms: flips one vblank late */
+    uint64_t target = shown + PERIOD_60HZ;
+    shown = run_frame(scheduler, &clock, 9 * NS_PER_MS);
+    STRESS_CHECK(failures, shown == target + PERIOD_60HZ, "spike frame did not slip one vblank");
+    STRESS_CHECK(failures, stats->missed_deadlines == 1,
+                 "%llu missed deadlines, expected 1",
+                 (unsigned long long)stats->missed_deadlines);
+
+    /* The spike stays the worst cost until it leaves the history */
+    int raised = 0;
+    for (int i = 0; i < 2 * history; i++) {
+        uint64_t expected = shown + PERIOD_60HZ;
+        shown = run_frame(scheduler, &clock, 4 * NS_PER_MS);
+        STRESS_CHECK(failures, shown == expected, "frame %d after the spike skipped a vblank", i);
+        if (stats->predicted_cost_us == 11000) {
+            STRESS_CHECK(failures, raised == i, "budget rose again at frame %d", i);
+            STRESS_CHECK(failures, stats->last_latency_us == 11000,
+                         "latency %uus with an 11ms budget", stats->last_latency_us);
+            raised++;
+        } else {
+            STRESS_CHECK(failures, stats->predicted_cost_us == 6000,
+                         "predicted %uus after the spike", stats->predicted_cost_us);
+        }
+    }
+    STRESS_CHECK(failures, raised == history,
+                 "budget raised for %d frames, expected %d", raised, history);
+    STRESS_CHECK(failures, stats->missed_deadlines == 1,
+                 "recovery frames missed deadlines");
+
+    frame_scheduler_destroy(scheduler);
+}
+
+static void test_long_frames(void) {
+    SimClock clock;
+    sim_init(&clock, PERIOD_60HZ);
+    FrameScheduler* scheduler = create_scheduler(&clock, true, 16);
+    if (!scheduler) {
+        return;
+    }
+    const FrameSchedulerStats* stats = frame_scheduler_get_stats(scheduler);
+
+    /* 20ms of work cannot make the next vblank; 22ms of budget aims two out */
+    uint64_t shown = run_frame(scheduler, &clock, 20 * NS_PER_MS);
+    shown = run_frame(scheduler, &clock, 20 * NS_PER_MS);
+    for (int i = 0; i < 20; i++) {
+        uint64_t expected = shown + 2 * PERIOD_60HZ;
+        shown = run_frame(scheduler, &clock, 20 * NS_PER_MS);
+        STRESS_CHECK(failures, shown == expected, "long frame %d not two vblanks on", i);
+        STRESS_CHECK(failures, clock.last_deadline == expected - 22 * NS_PER_MS,
+                     "long frame %d started off budget", i);
+    }
+    STRESS_CHECK(failures, stats->predicted_cost_us == 22000,
+                 "predicted %uus, expected 22000us", stats->predicted_cost_us);
+    STRESS_CHECK(failures, stats->missed_deadlines == 0,
+                 "%llu missed deadlines at half rate",
+                 (unsigned long long)stats->missed_deadlines);
+
+    frame_scheduler_destroy(scheduler);
+}
+
+static void test_period_estimate(void) {
+    /* Configured for 60 Hz, the panel runs at 50 Hz */
+    const uint64_t period = NS_PER_SEC / 50;
+    SimClock clock;
+    sim_init(&clock, period);
+    FrameScheduler* scheduler = create_scheduler(&clock, true, 16);
+    if (!scheduler) {
+        return;
+    }
+    const FrameSchedulerStats* stats = frame_scheduler_get_stats(scheduler);
+
+    for (int i = 0; i < 200; i++) {
+        run_frame(scheduler, &clock, 4 * NS_PER_MS);
+    }
+    STRESS_CHECK(failures, stats->refresh_period_us >= 19990 && stats->refresh_period_us <= 20010,
+                 "period %uus, expected 20000us", stats->refresh_period_us);
+
+    uint64_t missed = stats->missed_deadlines;
+    uint64_t shown = run_frame(scheduler, &clock, 4 * NS_PER_MS);
+    for (int i = 0; i < 20; i++) {
+        uint64_t expected = shown + period;
+        shown = run_frame(scheduler, &clock, 4 * NS_PER_MS);
+        STRESS_CHECK(failures, shown == expected, "50 Hz frame %d skipped a vblank", i);
+    }
+    STRESS_CHECK(failures, stats->missed_deadlines == missed,
+                 "missed deadlines after the period settled");
+
+    frame_scheduler_destroy(scheduler);
+}
+
+static void test_blocking_present(void) {
+    SimClock clock;
+    sim_init(&clock, PERIOD_60HZ);
+    FrameScheduler* scheduler = create_scheduler(&clock, true, 16);
+    if (!scheduler) {
+        return;
+    }
+    const FrameSchedulerStats* stats = frame_scheduler_get_stats(scheduler);
+
+    /* Present blocks until the flip and reports no timestamp */
+    uint64_t shown = 0;
+    for (int i = 0; i < 10; i++) {
+        frame_scheduler_wait(scheduler);
+        frame_scheduler_begin_frame(scheduler);
+        clock.now += 3 * NS_PER_MS;
+        frame_scheduler_mark_submit(scheduler);
+        clock.now = sim_vblank_at_or_after(&clock, clock.now);
+        if (i > 1) {
+            STRESS_CHECK(failures, clock.now == shown + PERIOD_60HZ,
+                         "blocking frame %d skipped a vblank", i);
+            STRESS_CHECK(failures, clock.last_deadline == clock.now - 5 * NS_PER_MS,
+                         "blocking frame %d started off budget", i);
+        }
+        shown = clock.now;
+        frame_scheduler_end_frame(scheduler, 0);
+    }
+    STRESS_CHECK(failures, stats->last_cost_us == 3000,
+                 "cost %uus includes the present wait", stats->last_cost_us);
+    STRESS_CHECK(failures, stats->predicted_cost_us == 5000,
+                 "predicted %uus, expected 5000us", stats->predicted_cost_us);
+    STRESS_CHECK(failures, !stats->vblank_measured, "vblank reported as measured");
+
+    frame_scheduler_destroy(scheduler);
+}
+
+static void test_fixed_cadence(void) {
+    SimClock clock;
+    sim_init(&clock, PERIOD_60HZ);
+    FrameScheduler* scheduler = create_scheduler(&clock, false, 16);
+    if (!scheduler) {
+        return;
+    }
+    const FrameSchedulerStats* stats = frame_scheduler_get_stats(scheduler);
+
+    uint64_t start = 0;
+    for (int i = 0; i < 10; i++) {
+        frame_scheduler_wait(scheduler);
+        if (i > 0) {
+            STRESS_CHECK(failures, clock.now == start + PERIOD_60HZ,
+                         "fixed frame %d started %lldns off cadence", i,
+                         (long long)(clock.now - (start + PERIOD_60HZ)));
+        }
+        start = clock.now;
+        frame_scheduler_begin_frame(scheduler);
+        clock.now += 4 * NS_PER_MS;
+        frame_scheduler_mark_submit(scheduler);
+        frame_scheduler_end_frame(scheduler, sim_vblank_at_or_after(&clock, clock.now));
+    }
+    STRESS_CHECK(failures, clock.sleeps == 9, "%d sleeps over 10 frames", clock.sleeps);
+    STRESS_CHECK(failures, stats->missed_deadlines == 0,
+                 "fixed cadence counted missed deadlines");
+
+    frame_scheduler_destroy(scheduler);
+}
+
+static void measure(void) {
+    SimClock clock;
+    sim_init(&clock, PERIOD_60HZ);
+    FrameScheduler* scheduler = create_scheduler(&clock, true, FRAME_SCHEDULER_MAX_HISTORY);
+    if (!scheduler) {
+        return;
+    }
+
+    long iterations = bench_iterations();
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        run_frame(scheduler, &clock, (uint64_t)(3 + i % 4) * NS_PER_MS);
+    }
+    bench_report("frame_scheduler frame", "64 history", iterations, bench_now_ns() - start);
+
+    frame_scheduler_destroy(scheduler);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_frame_scheduler");
+
+    bench_header("Frame scheduler");
+    test_late_latch();
+    test_cost_spike();
+    test_long_frames();
+    test_period_estimate();
+    test_blocking_present();
+    test_fixed_cadence();
+    measure();
+
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,343 @@
+/**
+ * @file stress_profiler.c
+ * @brief Sampling profiler overhead and folded stack correctness
+ *
+ * Measures a fixed compute kernel with the profiler idle, sampling at the
+ * default 99 Hz and at the 1000 Hz maximum. Then checks:
+ * - SIGUSR2 starts and stops a session, and the stop writes the output
+ * - every sample taken lands in the folded file (counts add up)
+ * - registered threads are walked through their frame pointers: worker
+ *   stacks end in spin_inner and still contain spin_outer two calls up,
+ *   under the thread's role name (spin_middle, the leaf's direct caller,
+ *   may be missing when the leaf sets up no frame)
+ * - unregistered threads are not sampled (no per-thread timer)
+ * - back-to-back start/stop cycles under load each write a valid file
+ *
+ * Build with -fno-omit-frame-pointer (the Makefile does).
+ * Exit status is non-zero if any check fails.
+ */
+
+#define _GNU_SOURCE
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/core/realtime.h"
+#include "../../src/core/profiler.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define WORKERS 2
+#define FUNCTION_SPAN 256   /* Most code bytes attributed to one function */
+
+static int failures;
+static char output[256];
+static atomic_bool workers_run;
+static atomic_long kernel_rounds;
+static volatile uint64_t sink;
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+__attribute__((noinline)) static uint64_t spin_inner(uint64_t seed) {
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        __asm__ volatile("" : "+r"(seed));
+    }
+    return seed;
+}
+
+__attribute__((noinline)) static uint64_t spin_middle(uint64_t seed) {
+    seed = spin_inner(seed);
+    __asm__ volatile("" : "+r"(seed));
+    return seed;
+}
+
+__attribute__((noinline)) static uint64_t spin_outer(uint64_t seed) {
+    seed = spin_middle(seed);
+    __asm__ volatile("" : "+r"(seed));
+    return seed;
+}
+
+static void* worker_main(void* arg) {
+    bool registered = arg != NULL;
+    if (registered) {
+        realtime_enter(REALTIME_ROLE_BACKGROUND);
+    }
+    uint64_t seed = (uint64_t)(uintptr_t)&seed;
+    while (atomic_load(&workers_run)) {
+        seed = spin_outer(seed);
+        atomic_fetch_add(&kernel_rounds, 1);
+    }
+    return (void*)(uintptr_t)(seed & 1);
+}
+
+/* Module name and file offset of a code address, as the profiler writes it */
+static bool code_offset(const void* address, char* module, size_t module_size,
+                        unsigned long* offset) {
+    FILE* maps = fopen("/proc/self/maps", "r");
+    if (!maps) {
+        return false;
+    }
+    char line[512];
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), maps)) {
+        unsigned long start, end, file_offset;
+        int path_at = 0;
+        if (sscanf(line, "%lx-%lx %*s %lx %*s %*s %n", &start, &end, &file_offset,
+                   &path_at) < 3 || (uintptr_t)address < start || (uintptr_t)address >= end) {
+            continue;
+        }
+        char* path = line + path_at;
+        path[strcspn(path, "\n")] = '\0';
+        const char* base = strrchr(path, '/');
+        snprintf(module, module_size, "%s", base ? base + 1 : path);
+        *offset = (uintptr_t)address - start + file_offset;
+        found = true;
+    }
+    fclose(maps);
+    return found;
+}
+
+static void measure(Profiler* profiler, const char* param, int ms) {
+    if (profiler && !profiler_start(profiler)) {
+        STRESS_CHECK(failures, false, "%s: start failed: %s", param, pk_get_last_error_context());
+        return;
+    }
+    uint64_t seed = 1;
+    long rounds = 0;
+    uint64_t start = bench_now_ns();
+    while (bench_now_ns() - start < (uint64_t)ms * 1000000ull) {
+        seed = spin_outer(seed);
+        rounds++;
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    if (profiler) {
+        profiler_stop(profiler);
+    }
+    sink = seed;
+    bench_report("spin kernel (2000 LCG steps)", param, rounds, elapsed);
+}
+
+typedef struct {
+    long samples;
+    int lines;
+    int malformed;
+    int worker_walked;          /* background;...;spin_outer;...;spin_inner */
+    int worker_leaf_inner;      /* background stacks ending in spin_inner */
+    int worker_stacks;
+    int other_deep;             /* "other" stacks with more than one frame */
+    int other_stacks;
+} FoldedSummary;
+
+enum { FN_INNER, FN_MIDDLE, FN_OUTER, FN_WORKER, FN_COUNT };
+
+/* Which of the worker's functions an offset falls in: the closest one
+ * starting at or before it, -1 if none is within FUNCTION_SPAN */
+static int classify(const unsigned long* starts, unsigned long offset) {
+    int best = -1;
+    for (int i = 0; i < FN_COUNT; i++) {
+        if (offset >= starts[i] && offset - starts[i] < FUNCTION_SPAN &&
+            (best < 0 || starts[i] > starts[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static bool parse_output(FoldedSummary* summary) {
+    memset(summary, 0, sizeof(*summary));
+    const void* functions[FN_COUNT] = {
+        (const void*)spin_inner, (const void*)spin_middle,
+        (const void*)spin_outer, (const void*)worker_main
+    };
+    char module[64];
+    unsigned long starts[FN_COUNT];
+    for (int i = 0; i < FN_COUNT; i++) {
+        if (!code_offset(functions[i], module, sizeof(module), &starts[i])) {
+            return false;
+        }
+    }
+
+    FILE* file = fopen(output, "r");
+    if (!file) {
+        return false;
+    }
+    static char line[8192];
+    while (fgets(line, sizeof(line), file)) {
+        summary->lines++;
+        char* space = strrchr(line, ' ');
+        long count = space ? strtol(space + 1, NULL, 10) : 0;
+        if (!space || count <= 0) {
+            summary->malformed++;
+            continue;
+        }
+        *space = '\0';
+        summary->samples += count;
+
+        /* Thread name, then frames root to leaf */
+        char* save = NULL;
+        char* thread = strtok_r(line, ";", &save);
+        int frames = 0;
+        int outer_at = -1, inner_at = -1;
+        char* frame;
+        while ((frame = strtok_r(NULL, ";", &save)) != NULL) {
+            char* plus = strrchr(frame, '+');
+            if (plus && (size_t)(plus - frame) == strlen(module) &&
+                strncmp(frame, module, strlen(module)) == 0) {
+                int function = classify(starts, strtoul(plus + 1, NULL, 16));
+                if (function == FN_INNER) {
+                    inner_at = frames;
+                } else if (function == FN_OUTER) {
+                    outer_at = frames;
+                }
+            } else if (strncmp(frame, "0x", 2) != 0 && !plus) {
+                summary->malformed++;
+            }
+            frames++;
+        }
+        if (!thread || frames == 0) {
+            summary->malformed++;
+        } else if (strcmp(thread, "background") == 0) {
+            summary->worker_stacks++;
+            if (inner_at == frames - 1) {
+                summary->worker_leaf_inner++;
+                if (outer_at >= 0 && outer_at < inner_at) {
+                    summary->worker_walked++;
+                }
+            }
+        } else if (strcmp(thread, "other") == 0) {
+            summary->other_stacks++;
+            if (frames > 1) {
+                summary->other_deep++;
+            }
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static void wait_running(Profiler* profiler, bool running) {
+    ProfilerStats stats;
+    for (int i = 0; i < 200; i++) {
+        profiler_get_stats(profiler, &stats);
+        if (stats.running == running) {
+            return;
+        }
+        sleep_ms(5);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_profiler");
+    snprintf(output, sizeof(output), "/tmp/stress_profiler.%d.folded", (int)getpid());
+    realtime_enter(REALTIME_ROLE_MAIN);
+
+    /* ---- Overhead ---- */
+    bench_header("Sampling profiler (main thread spinning)");
+    measure(NULL, "no profiler", 300);
+
+    ProfilerConfig config = profiler_default_config();
+    snprintf(config.output, sizeof(config.output), "%s", output);
+    Profiler* profiler = profiler_create(&config);
+    if (!profiler) {
+        fprintf(stderr, "Profiler failed: %s\n", pk_get_last_error_context());
+        logger_shutdown();
+        return 1;
+    }
+    measure(NULL, "idle", 300);
+    measure(profiler, "99 Hz", 300);
+    profiler_destroy(profiler);
+
+    config.frequency_hz = 1000;
+    profiler = profiler_create(&config);
+    STRESS_CHECK(failures, profiler_create(&config) == NULL, "second profiler was created");
+    measure(profiler, "1000 Hz", 300);
+
+    /* ---- SIGUSR2 session with registered and unregistered workers ---- */
+    unlink(output);
+    atomic_store(&workers_run, true);
+    pthread_t workers[WORKERS + 1];
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_create(&workers[i], NULL, worker_main, (void*)1);
+    }
+    pthread_create(&workers[WORKERS], NULL, worker_main, NULL);
+
+    ProfilerStats before, after;
+    profiler_get_stats(profiler, &before);
+    kill(getpid(), SIGUSR2);
+    wait_running(profiler, true);
+    sleep_ms(600);
+    kill(getpid(), SIGUSR2);
+    wait_running(profiler, false);
+    profiler_get_stats(profiler, &after);
+
+    atomic_store(&workers_run, false);
+    for (int i = 0; i <= WORKERS; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    long taken = (long)(after.samples - before.samples);
+    long dropped = (long)(after.dropped - before.dropped);
+    FoldedSummary summary;
+    bool parsed = parse_output(&summary);
+    printf("%-32s %-20s %ld samples (%ld dropped), %d stacks; workers %d/%d walked, "
+           "other %d/%d deep\n", "signal session", "1000 Hz", taken, dropped, summary.lines,
+           summary.worker_walked, summary.worker_stacks, summary.other_deep,
+           summary.other_stacks);
+
+    STRESS_CHECK(failures, after.sessions == before.sessions + 1 && !after.running,
+                 "SIGUSR2 did not run exactly one session (%llu -> %llu, running %d)",
+                 (unsigned long long)before.sessions, (unsigned long long)after.sessions,
+                 after.running);
+    STRESS_CHECK(failures, parsed, "no folded output at %s", output);
+    STRESS_CHECK(failures, taken > 30, "only %ld samples in 600ms at 1000Hz", taken);
+    STRESS_CHECK(failures, summary.malformed == 0, "%d malformed lines", summary.malformed);
+    STRESS_CHECK(failures, summary.samples == taken - dropped,
+                 "file holds %ld samples, profiler took %ld (%ld dropped)", summary.samples,
+                 taken, dropped);
+    STRESS_CHECK(failures, summary.worker_stacks > 0 && summary.worker_walked > 0,
+                 "no worker stack walked from spin_inner back to spin_outer");
+    STRESS_CHECK(failures, summary.other_stacks == 0,
+                 "unregistered thread was sampled: %d stacks (%d deeper than one frame)",
+                 summary.other_stacks, summary.other_deep);
+
+    /* ---- Rapid start/stop under load ---- */
+    atomic_store(&workers_run, true);
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_create(&workers[i], NULL, worker_main, (void*)1);
+    }
+    int written = 0;
+    for (int cycle = 0; cycle < 50; cycle++) {
+        STRESS_CHECK(failures, profiler_start(profiler), "cycle %d: start failed: %s", cycle,
+                     pk_get_last_error_context());
+        sleep_ms(10);
+        if (profiler_stop(profiler) && parse_output(&summary) && summary.malformed == 0) {
+            written++;
+        }
+    }
+    atomic_store(&workers_run, false);
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    STRESS_CHECK(failures, written == 50, "%d of 50 start/stop cycles wrote a valid file",
+                 written);
+    STRESS_CHECK(failures, !profiler_stop(profiler), "stop without a session succeeded");
+
+    profiler_get_stats(profiler, &after);
+    printf("%-32s %-20s %llu sessions, %llu samples, %llu dropped, %llu truncated\n",
+           "totals", "", (unsigned long long)after.sessions,
+           (unsigned long long)after.samples, (unsigned long long)after.dropped,
+           (unsigned long long)after.truncated);
+
+    profiler_destroy(profiler);
+    unlink(output);
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,530 @@
+/**
+ * @file stress_rfb_server.c
+ * @brief Remote screen server against a minimal in-process VNC viewer
+ *
+ * A fake render thread draws a test scene (flat fills, gradients, noise and
+ * two-colour "text" so every ZRLE subencoding is exercised) whenever the
+ * server asks for a frame. The viewer decodes what it receives and checks:
+ * - a full ZRLE update reproduces the scene exactly
+ * - a small change is sent as the changed tiles only
+ * - a static screen sends nothing and the capture rate drops to idle_fps
+ * - pointer events arrive as SDL mouse motion/button/wheel events
+ * - a second viewer replaces the first and gets raw RGB565 when it asks
+ * - begin_capture costs next to nothing with no viewer connected
+ *
+ * Requires SDL2 headers and zlib; build with `make build-bench-display`.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/display/rfb_server.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <zlib.h>
+
+#define FB_WIDTH 320
+#define FB_HEIGHT 200
+
+// Fake render thread
+
+static uint32_t g_scene[FB_WIDTH * FB_HEIGHT];
+static pthread_mutex_t g_scene_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int g_render_running;
+static atomic_int g_captures;
+
+static void draw_scene(void) {
+    uint32_t seed = 12345;
+    for (int y = 0; y < FB_HEIGHT; y++) {
+        for (int x = 0; x < FB_WIDTH; x++) {
+            uint32_t p;
+            if (y < 40) {
+                p = 0xFF202020;                                   /* Flat */
+            } else if (y < 100) {
+                p = 0xFF000000u | (uint32_t)(x * 255 / FB_WIDTH) << 16 |
+                    (uint32_t)(y * 2) << 8 | 0x40;                /* Gradient */
+            } else if (y < 150 && x < 128) {
+                seed = seed * 1103515245u + 12345u;
+                p = 0xFF000000u | (seed >> 8);                    /* Noise */
+            } else {
+                p = ((x / 3 + y / 5) % 4 == 0) ? 0xFFFFFFFF : 0xFF1030A0;  /* "Text" */
+            }
+            g_scene[y * FB_WIDTH + x] = p;
+        }
+    }
+}
+
+static void* render_thread(void* arg) {
+    RfbServer* server = arg;
+    while (atomic_load(&g_render_running)) {
+        void* pixels;
+        int pitch;
+        if (rfb_server_begin_capture(server, &pixels, &pitch)) {
+            pthread_mutex_lock(&g_scene_mutex);
+            for (int y = 0; y < FB_HEIGHT; y++) {
+                memcpy((uint8_t*)pixels + y * pitch, g_scene + y * FB_WIDTH, FB_WIDTH * 4);
+            }
+            pthread_mutex_unlock(&g_scene_mutex);
+            rfb_server_end_capture(server, true);
+            atomic_fetch_add(&g_captures, 1);
+        }
+        usleep(5000);                                             /* ~200 Hz */
+    }
+    return NULL;
+}
+
+// Remote input sink
+
+static SDL_Event g_events[64];
+static atomic_int g_event_count;
+
+static void on_input(SDL_Event* event, void* user_data) {
+    (void)user_data;
+    int i = atomic_load(&g_event_count);
+    if (i < 64) {
+        g_events[i] = *event;
+        atomic_store(&g_event_count, i + 1);
+    }
+}
+
+// Minimal viewer
+
+typedef struct {
+    int fd;
+    int bpp;                    /* Bytes per pixel */
+    bool rgb565;
+    uint32_t fb[FB_WIDTH * FB_HEIGHT];
+    z_stream zs;
+    uint8_t* scratch;
+    size_t scratch_size;
+    int last_rects;
+    long last_pixels;
+} Viewer;
+
+static bool read_exact(int fd, void* data, size_t size) {
+    uint8_t* p = data;
+    while (size > 0) {
+        ssize_t n = recv(fd, p, size, 0);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static uint16_t be16(const uint8_t* p) { return (uint16_t)(p[0] << 8 | p[1]); }
+static uint32_t be32(const uint8_t* p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint32_t to_client(const Viewer* v, uint32_t argb) {
+    if (!v->rgb565) {
+        return argb & 0xFFFFFF;
+    }
+    uint32_t r = ((argb >> 16) & 0xFF) * 31 + 127;
+    uint32_t g = ((argb >> 8) & 0xFF) * 63 + 127;
+    uint32_t b = (argb & 0xFF) * 31 + 127;
+    return (r / 255) << 11 | (g / 255) << 5 | (b / 255);
+}
+
+static bool viewer_connect(Viewer* v, int port, bool rgb565) {
+    memset(v, 0, sizeof(*v));
+    v->rgb565 = rgb565;
+    v->bpp = rgb565 ? 2 : 4;
+    v->fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port) };
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    struct timeval tv = { 3, 0 };
+    setsockopt(v->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (connect(v->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        return false;
+    }
+
+    uint8_t buf[64];
+    if (!read_exact(v->fd, buf, 12) || memcmp(buf, "RFB 003.008\n", 12) != 0) {
+        return false;
+    }
+    send(v->fd, "RFB 003.008\n", 12, 0);
+    if (!read_exact(v->fd, buf, 2) || buf[0] != 1 || buf[1] != 1) {
+        return false;
+    }
+    uint8_t none = 1;
+    send(v->fd, &none, 1, 0);
+    if (!read_exact(v->fd, buf, 4) || be32(buf) != 0) {
+        return false;
+    }
+    uint8_t shared = 1;
+    send(v->fd, &shared, 1, 0);
+    if (!read_exact(v->fd, buf, 24) || be16(buf) != FB_WIDTH || be16(buf + 2) != FB_HEIGHT) {
+        return false;
+    }
+    uint32_t name_length = be32(buf + 20);
+    if (name_length >= sizeof(buf) || !read_exact(v->fd, buf, name_length)) {
+        return false;
+    }
+
+    if (rgb565) {
+        uint8_t msg[20] = { 0, 0, 0, 0, 16, 16, 0, 1, 0, 31, 0, 63, 0, 31, 11, 5, 0 };
+        send(v->fd, msg, sizeof(msg), 0);
+        uint8_t enc[8] = { 2, 0, 0, 1, 0, 0, 0, 0 };              /* Raw only */
+        send(v->fd, enc, sizeof(enc), 0);
+    } else {
+        uint8_t enc[12] = { 2, 0, 0, 2, 0, 0, 0, 16, 0, 0, 0, 0 }; /* ZRLE, raw */
+        send(v->fd, enc, sizeof(enc), 0);
+    }
+    inflateInit(&v->zs);
+    return true;
+}
+
+static void viewer_close(Viewer* v) {
+    close(v->fd);
+    inflateEnd(&v->zs);
+    free(v->scratch);
+}
+
+static void viewer_request(Viewer* v, bool incremental) {
+    uint8_t msg[10] = { 3, incremental, 0, 0, 0, 0,
+                        FB_WIDTH >> 8, FB_WIDTH & 0xFF, FB_HEIGHT >> 8, FB_HEIGHT & 0xFF };
+    send(v->fd, msg, sizeof(msg), 0);
+}
+
+static void viewer_pointer(Viewer* v, uint8_t mask, int x, int y) {
+    uint8_t msg[6] = { 5, mask, (uint8_t)(x >> 8), (uint8_t)x, (uint8_t)(y >> 8), (uint8_t)y };
+    send(v->fd, msg, sizeof(msg), 0);
+}
+
+/* Pull bytes from the inflated rectangle data */
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+} Reader;
+
+static bool take(Reader* r, void* out, size_t n) {
+    if ((size_t)(r->end - r->p) < n) {
+        return false;
+    }
+    memcpy(out, r->p, n);
+    r->p += n;
+    return true;
+}
+
+static bool cpixel(Reader* r, uint32_t* value) {
+    uint8_t b[3];
+    if (!take(r, b, 3)) {
+        return false;
+    }
+    *value = (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16;
+    return true;
+}
+
+static bool run_length(Reader* r, int* run) {
+    int total = 1;
+    uint8_t b;
+    do {
+        if (!take(r, &b, 1)) {
+            return false;
+        }
+        total += b;
+    } while (b == 255);
+    *run = total;
+    return true;
+}
+
+static bool decode_zrle_tile(Viewer* v, Reader* r, int tx, int ty, int tw, int th) {
+    uint8_t sub;
+    uint32_t palette[128];
+    uint32_t px[64 * 64];
+    int n = tw * th;
+    if (!take(r, &sub, 1)) {
+        return false;
+    }
+
+    if (sub == 0) {
+        for (int i = 0; i < n; i++) {
+            if (!cpixel(r, &px[i])) return false;
+        }
+    } else if (sub == 1) {
+        if (!cpixel(r, &palette[0])) return false;
+        for (int i = 0; i < n; i++) px[i] = palette[0];
+    } else if (sub <= 16) {
+        int bits = sub == 2 ? 1 : sub <= 4 ? 2 : 4;
+        for (int i = 0; i < sub; i++) {
+            if (!cpixel(r, &palette[i])) return false;
+        }
+        for (int y = 0; y < th; y++) {
+            int used = 8;
+            uint8_t byte = 0;
+            for (int x = 0; x < tw; x++) {
+                if (used == 8) {
+                    if (!take(r, &byte, 1)) return false;
+                    used = 0;
+                }
+                int index = (byte >> (8 - bits - used)) & ((1 << bits) - 1);
+                used += bits;
+                if (index >= sub) return false;
+                px[y * tw + x] = palette[index];
+            }
+        }
+    } else if (sub == 128) {
+        for (int i = 0; i < n;) {
+            uint32_t value;
+            int run;
+            if (!cpixel(r, &value) || !run_length(r, &run) || i + run > n) return false;
+            while (run--) px[i++] = value;
+        }
+    } else if (sub >= 130) {
+        int colours = sub - 128;
+        for (int i = 0; i < colours; i++) {
+            if (!cpixel(r, &palette[i])) return false;
+        }
+        for (int i = 0; i < n;) {
+            uint8_t index;
+            int run = 1;
+            if (!take(r, &index, 1)) return false;
+            if (index & 128) {
+                index &= 127;
+                if (!run_length(r, &run)) return false;
+            }
+            if (index >= colours || i + run > n) return false;
+            while (run--) px[i++] = palette[index];
+        }
+    } else {
+        return false;
+    }
+
+    for (int y = 0; y < th; y++) {
+        memcpy(&v->fb[(ty + y) * FB_WIDTH + tx], &px[y * tw], (size_t)tw * 4);
+    }
+    return true;
+}
+
+/* Read one FramebufferUpdate; false on timeout or a decode error */
+static bool viewer_read_update(Viewer* v) {
+    uint8_t header[4];
+    if (!read_exact(v->fd, header, 4) || header[0] != 0) {
+        return false;
+    }
+    v->last_rects = be16(header + 2);
+    v->last_pixels = 0;
+    for (int i = 0; i < v->last_rects; i++) {
+        uint8_t rect[12];
+        if (!read_exact(v->fd, rect, 12)) {
+            return false;
+        }
+        int x = be16(rect), y = be16(rect + 2), w = be16(rect + 4), h = be16(rect + 6);
+        int32_t encoding = (int32_t)be32(rect + 8);
+        v->last_pixels += (long)w * h;
+
+        if (encoding == 0) {
+            uint8_t row[FB_WIDTH * 4];
+            for (int yy = 0; yy < h; yy++) {
+                if (!read_exact(v->fd, row, (size_t)w * (size_t)v->bpp)) {
+                    return false;
+                }
+                for (int xx = 0; xx < w; xx++) {
+                    uint32_t value = v->bpp == 2 ? (uint32_t)(row[xx * 2] | row[xx * 2 + 1] << 8) :
+                        (uint32_t)(row[xx * 4] | row[xx * 4 + 1] << 8 | row[xx * 4 + 2] << 16);
+                    v->fb[(y + yy) * FB_WIDTH + x + xx] = value;
+                }
+            }
+            continue;
+        }
+        if (encoding != 16) {
+            return false;
+        }
+
+        uint8_t length_bytes[4];
+        if (!read_exact(v->fd, length_bytes, 4)) {
+            return false;
+        }
+        uint32_t length = be32(length_bytes);
+        uint8_t* compressed = malloc(length);
+        if (!compressed || !read_exact(v->fd, compressed, length)) {
+            free(compressed);
+            return false;
+        }
+        size_t capacity = (size_t)w * h * 4 + 4096;
+        if (v->scratch_size < capacity) {
+            free(v->scratch);
+            v->scratch = malloc(capacity);
+            v->scratch_size = capacity;
+        }
+        v->zs.next_in = compressed;
+        v->zs.avail_in = length;
+        v->zs.next_out = v->scratch;
+        v->zs.avail_out = (uInt)v->scratch_size;
+        int rc = inflate(&v->zs, Z_SYNC_FLUSH);
+        free(compressed);
+        if (rc != Z_OK || v->zs.avail_in != 0) {
+            return false;
+        }
+        Reader reader = { v->scratch, v->scratch + (v->scratch_size - v->zs.avail_out) };
+        for (int ty = y; ty < y + h; ty += 64) {
+            int th = y + h - ty < 64 ? y + h - ty : 64;
+            for (int tx = x; tx < x + w; tx += 64) {
+                int tw = x + w - tx < 64 ? x + w - tx : 64;
+                if (!decode_zrle_tile(v, &reader, tx, ty, tw, th)) {
+                    return false;
+                }
+            }
+        }
+        if (reader.p != reader.end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int viewer_mismatches(const Viewer* v) {
+    int bad = 0;
+    pthread_mutex_lock(&g_scene_mutex);
+    for (int i = 0; i < FB_WIDTH * FB_HEIGHT; i++) {
+        bad += v->fb[i] != to_client(v, g_scene[i]);
+    }
+    pthread_mutex_unlock(&g_scene_mutex);
+    return bad;
+}
+
+static bool readable_within(int fd, int ms) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, ms) > 0;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_rfb_server");
+    int failures = 0;
+    draw_scene();
+
+    RfbServerConfig config = rfb_server_default_config();
+    config.port = 0;
+    config.max_fps = 30;
+    config.idle_fps = 2;
+    config.on_input = on_input;
+    RfbServer* server = rfb_server_create(&config, FB_WIDTH, FB_HEIGHT);
+    STRESS_CHECK(failures, server && rfb_server_start(server), "server did not start");
+    if (!server) {
+        return 1;
+    }
+
+    /* No viewer: the render thread's check must be ~free */
+    bench_header("RFB server");
+    long iterations = bench_iterations() * 10;
+    void* pixels;
+    int pitch;
+    int wanted = 0;
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        wanted += rfb_server_begin_capture(server, &pixels, &pitch);
+    }
+    bench_report("begin_capture", "no viewer", iterations, bench_now_ns() - start);
+    STRESS_CHECK(failures, wanted == 0, "frames requested with no viewer connected");
+
+    atomic_store(&g_render_running, 1);
+    pthread_t renderer;
+    pthread_create(&renderer, NULL, render_thread, server);
+
+    /* Full update reproduces the scene */
+    Viewer* viewer = calloc(1, sizeof(Viewer));
+    STRESS_CHECK(failures, viewer_connect(viewer, rfb_server_get_port(server), false),
+                 "viewer handshake failed");
+    viewer_request(viewer, false);
+    bool ok = viewer_read_update(viewer);
+    STRESS_CHECK(failures, ok, "full update not received or not decodable");
+    int bad = viewer_mismatches(viewer);
+    STRESS_CHECK(failures, bad == 0, "%d pixels differ after the full update", bad);
+    RfbServerStats stats;
+    rfb_server_get_stats(server, &stats);
+    printf("  full:      %s, %d rects, %llu bytes for %d KB of pixels, encode %u us\n",
+           ok && bad == 0 ? "ok" : "FAILED", viewer->last_rects,
+           (unsigned long long)stats.bytes_sent, FB_WIDTH * FB_HEIGHT * 4 / 1024,
+           stats.last_encode_us);
+
+    /* A small change is sent as the changed tile only */
+    pthread_mutex_lock(&g_scene_mutex);
+    for (int y = 150; y < 160; y++) {
+        for (int x = 200; x < 210; x++) {
+            g_scene[y * FB_WIDTH + x] = 0xFFFF0000;
+        }
+    }
+    pthread_mutex_unlock(&g_scene_mutex);
+    viewer_request(viewer, true);
+    ok = viewer_read_update(viewer);
+    bad = viewer_mismatches(viewer);
+    STRESS_CHECK(failures, ok && bad == 0, "incremental update wrong (%d pixels differ)", bad);
+    STRESS_CHECK(failures, viewer->last_pixels <= 64 * 64,
+                 "10x10 change sent as %ld pixels", viewer->last_pixels);
+    printf("  damage:    %s, %d rect(s), %ld pixels for a 10x10 change\n",
+           ok && bad == 0 && viewer->last_pixels <= 64 * 64 ? "ok" : "FAILED",
+           viewer->last_rects, viewer->last_pixels);
+
+    /* Static screen: nothing sent, capture rate falls to idle_fps */
+    usleep(50000);                          /* Let the server finish accounting */
+    viewer_request(viewer, true);
+    rfb_server_get_stats(server, &stats);
+    uint64_t updates_before = stats.updates_sent;
+    bool sent = readable_within(viewer->fd, 800);
+    int captures_mid = atomic_load(&g_captures);
+    sent = readable_within(viewer->fd, 1000) || sent;
+    int idle_captures = atomic_load(&g_captures) - captures_mid;
+    rfb_server_get_stats(server, &stats);
+    STRESS_CHECK(failures, !sent && stats.updates_sent == updates_before,
+                 "update sent for an unchanged screen");
+    STRESS_CHECK(failures, idle_captures <= config.idle_fps + 1,
+                 "%d captures in 1s while idle (idle_fps %d)", idle_captures, config.idle_fps);
+    printf("  idle:      %s, %d captures/s, %llu unchanged captures\n",
+           !sent && idle_captures <= config.idle_fps + 1 ? "ok" : "FAILED",
+           idle_captures, (unsigned long long)stats.frames_unchanged);
+
+    /* Pointer: move, press, release, wheel */
+    viewer_pointer(viewer, 0, 100, 50);
+    viewer_pointer(viewer, 1, 100, 50);
+    viewer_pointer(viewer, 0, 120, 60);
+    viewer_pointer(viewer, 8, 120, 60);
+    viewer_pointer(viewer, 0, 120, 60);
+    usleep(200000);
+    int n = atomic_load(&g_event_count);
+    bool pointer_ok = n == 5 &&
+        g_events[0].type == SDL_MOUSEMOTION && g_events[0].motion.x == 100 &&
+        g_events[1].type == SDL_MOUSEBUTTONDOWN && g_events[1].button.button == SDL_BUTTON_LEFT &&
+        g_events[2].type == SDL_MOUSEMOTION && g_events[2].motion.x == 120 &&
+        g_events[3].type == SDL_MOUSEBUTTONUP && g_events[3].button.y == 60 &&
+        g_events[4].type == SDL_MOUSEWHEEL && g_events[4].wheel.y == 1;
+    STRESS_CHECK(failures, pointer_ok, "unexpected input events (%d)", n);
+    printf("  pointer:   %s, %d events\n", pointer_ok ? "ok" : "FAILED", n);
+
+    /* Second viewer replaces the first and asks for raw RGB565 */
+    Viewer* second = calloc(1, sizeof(Viewer));
+    STRESS_CHECK(failures, viewer_connect(second, rfb_server_get_port(server), true),
+                 "second viewer handshake failed");
+    viewer_request(second, false);
+    ok = viewer_read_update(second);
+    bad = viewer_mismatches(second);
+    STRESS_CHECK(failures, ok && bad == 0, "RGB565 update wrong (%d pixels differ)", bad);
+    uint8_t probe;
+    STRESS_CHECK(failures, recv(viewer->fd, &probe, 1, 0) <= 0, "first viewer not disconnected");
+    rfb_server_get_stats(server, &stats);
+    STRESS_CHECK(failures, stats.sessions == 2, "expected 2 sessions, got %llu",
+                 (unsigned long long)stats.sessions);
+    printf("  replace:   %s, raw RGB565 full update %llu bytes total sent\n",
+           ok && bad == 0 ? "ok" : "FAILED", (unsigned long long)stats.bytes_sent);
+    printf("  capture:   %u us on the render thread (memcpy stand-in for readback)\n",
+           stats.last_capture_us);
+
+    viewer_close(second);
+    viewer_close(viewer);
+    free(second);
+    free(viewer);
+    atomic_store(&g_render_running, 0);
+    pthread_join(renderer, NULL);
+    rfb_server_destroy(server);
+    logger_shutdown();
+
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,369 @@
+/**
+ * @file stress_skin_atlas.c
+ * @brief Skin atlas packing and nine-slice drawing
+ *
+ * Checks:
+ * - a known set of solid images packs until the atlas overflows; every
+ *   region keeps its size, lies inside the atlas and is at least one
+ *   pixel away from every other, and the atlas holds each image's pixels
+ *   with padding and unused space left transparent
+ * - the overflowing image is reported and leaves no region or pixels
+ *   behind; duplicate names, oversized insets and images larger than the
+ *   atlas are rejected
+ * - the built-in skin packs without overlap into the default atlas
+ * - a region drawn stretched through the software renderer puts each of
+ *   its nine slices exactly where the insets say, samples nothing from
+ *   neighbouring regions or padding, and seals the atlas
+ * Also reports the cost of recording a nine-slice draw.
+ *
+ * Exit status is non-zero if any check fails.
+ */
+
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/display/skin_atlas.h"
+
+#define PACK_ATLAS_SIZE 128
+#define PACK_IMAGES 64
+
+#define DRAW_ATLAS_SIZE 64
+#define TARGET_W 96
+#define TARGET_H 64
+#define BACKGROUND 0x101010u
+#define NEIGHBOUR 0xFF00FFu
+
+static int failures;
+
+static uint32_t pixel_at(const SDL_Surface* surface, int x, int y) {
+    const uint8_t* row = (const uint8_t*)surface->pixels + (size_t)y * surface->pitch;
+    return ((const uint32_t*)row)[x];
+}
+
+static SDL_Surface* solid_image(int w, int h, uint32_t argb) {
+    SDL_Surface* image = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (image) {
+        SDL_FillRect(image, NULL, argb);
+    }
+    return image;
+}
+
+/* Opaque and distinct for every index below 192 */
+static uint32_t pack_color(int i) {
+    return 0xFF000000u | (uint32_t)(i + 1) << 16 | (uint32_t)(0xC0 - i) << 8 | 0x40u;
+}
+
+static bool rects_apart(const SDL_Rect* a, const SDL_Rect* b) {
+    return a->x + a->w < b->x || b->x + b->w < a->x ||
+           a->y + a->h < b->y || b->y + b->h < a->y;
+}
+
+/* Bounds and one pixel of separation for every pair */
+static void check_layout(const char* what, const SDL_Rect* rects, int count,
+                         const SDL_Surface* surface) {
+    for (int i = 0; i < count; i++) {
+        const SDL_Rect* r = &rects[i];
+        STRESS_CHECK(failures, r->x >= 0 && r->y >= 0 &&
+                     r->x + r->w <= surface->w && r->y + r->h <= surface->h,
+                     "%s region %d (%d,%d %dx%d) outside the %dx%d atlas",
+                     what, i, r->x, r->y, r->w, r->h, surface->w, surface->h);
+        for (int j = i + 1; j < count; j++) {
+            STRESS_CHECK(failures, rects_apart(r, &rects[j]),
+                         "%s regions %d and %d overlap or touch", what, i, j);
+        }
+    }
+}
+
+static void test_packing(void) {
+    SkinAtlas* atlas = skin_atlas_create(PACK_ATLAS_SIZE, PACK_ATLAS_SIZE);
+    STRESS_CHECK(failures, atlas != NULL, "create failed: %s", pk_get_last_error_context());
+    if (!atlas) {
+        return;
+    }
+    const SDL_Surface* surface = skin_atlas_get_surface(atlas);
+    STRESS_CHECK(failures, surface && surface->w == PACK_ATLAS_SIZE &&
+                 surface->h == PACK_ATLAS_SIZE, "atlas surface has the wrong size");
+    if (!surface) {
+        skin_atlas_destroy(atlas);
+        return;
+    }
+
+    SkinInsets insets = { 1, 1, 1, 1 };
+    SDL_Rect rects[PACK_IMAGES];
+    uint32_t colors[PACK_IMAGES];
+    int packed = 0;
+    long used_area = 0;
+    bool overflowed = false;
+    uint32_t seed = 12345;
+
+    for (int i = 0; i < PACK_IMAGES; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int w = 4 + (int)((seed >> 16) % 29);
+        seed = seed * 1103515245u + 12345u;
+        int h = 4 + (int)((seed >> 16) % 21);
+
+        char name[SKIN_REGION_NAME_MAX];
+        snprintf(name, sizeof(name), "pack.%d", i);
+        SDL_Surface* image = solid_image(w, h, pack_color(i));
+        if (!image) {
+            STRESS_CHECK(failures, false, "image %d: %s", i, SDL_GetError());
+            break;
+        }
+        PkError err = skin_atlas_add_surface(atlas, name, image, &insets);
+        SDL_FreeSurface(image);
+
+        if (err == PK_ERROR_RESOURCE_LIMIT) {
+            STRESS_CHECK(failures, strstr(pk_get_last_error_context(), "no room") != NULL,
+                         "overflow reported as: %s", pk_get_last_error_context());
+            STRESS_CHECK(failures, skin_atlas_find(atlas, name) == NULL,
+                         "overflowing image left region %s", name);
+            overflowed = true;
+            break;
+        }
+        STRESS_CHECK(failures, err == PK_OK, "adding %dx%d image %d failed: %s",
+                     w, h, i, pk_get_last_error_context());
+        if (err != PK_OK) {
+            break;
+        }
+
+        const SkinRegion* region = skin_atlas_find(atlas, name);
+        STRESS_CHECK(failures, region && region->rect.w == w && region->rect.h == h,
+                     "region %s missing or resized", name);
+        if (!region) {
+            break;
+        }
+        rects[packed] = region->rect;
+        colors[packed] = pack_color(i);
+        used_area += (long)w * h;
+        packed++;
+    }
+
+    STRESS_CHECK(failures, overflowed, "%d images fit a %dx%d atlas, expected overflow",
+                 packed, PACK_ATLAS_SIZE, PACK_ATLAS_SIZE);
+    double fill = (double)used_area / (PACK_ATLAS_SIZE * PACK_ATLAS_SIZE);
+    printf("  packed %d regions before overflow, %.0f%% of the atlas covered\n",
+           packed, fill * 100.0);
+    STRESS_CHECK(failures, fill > 0.5, "shelf packing covered only %.0f%%", fill * 100.0);
+
+    check_layout("packed", rects, packed, surface);
+
+    /* Every atlas pixel is its region's color or transparent */
+    int wrong = 0;
+    for (int y = 0; y < surface->h; y++) {
+        for (int x = 0; x < surface->w; x++) {
+            uint32_t expected = 0;
+            for (int i = 0; i < packed; i++) {
+                if (x >= rects[i].x && x < rects[i].x + rects[i].w &&
+                    y >= rects[i].y && y < rects[i].y + rects[i].h) {
+                    expected = colors[i];
+                    break;
+                }
+            }
+            uint32_t actual = pixel_at(surface, x, y);
+            if (actual != expected && wrong++ == 0) {
+                STRESS_CHECK(failures, false, "atlas pixel %d,%d is %08x, expected %08x",
+                             x, y, actual, expected);
+            }
+        }
+    }
+    STRESS_CHECK(failures, wrong == 0, "%d atlas pixels wrong", wrong);
+
+    /* Rejected additions */
+    SDL_Surface* small = solid_image(4, 4, pack_color(0));
+    SDL_Surface* huge = solid_image(PACK_ATLAS_SIZE + 1, 4, pack_color(0));
+    if (small && huge) {
+        STRESS_CHECK(failures, skin_atlas_add_surface(atlas, "pack.0", small, &insets) ==
+                     PK_ERROR_ALREADY_EXISTS, "duplicate region name accepted");
+        SkinInsets wide = { 3, 1, 2, 1 };
+        STRESS_CHECK(failures, skin_atlas_add_surface(atlas, "wide", small, &wide) ==
+                     PK_ERROR_INVALID_PARAM, "insets wider than the image accepted");
+        STRESS_CHECK(failures, skin_atlas_add_surface(atlas, "huge", huge, &insets) ==
+                     PK_ERROR_RESOURCE_LIMIT, "image wider than the atlas accepted");
+        STRESS_CHECK(failures, !skin_atlas_find(atlas, "wide") && !skin_atlas_find(atlas, "huge"),
+                     "rejected image left a region");
+    }
+    SDL_FreeSurface(small);
+    SDL_FreeSurface(huge);
+
+    skin_atlas_destroy(atlas);
+}
+
+static void test_builtin(void) {
+    static const char* const names[] = {
+        "button.normal", "button.hovered", "button.pressed", "button.disabled", "panel.normal"
+    };
+    const int count = (int)(sizeof(names) / sizeof(names[0]));
+
+    SkinAtlas* atlas = skin_atlas_create(0, 0);
+    STRESS_CHECK(failures, atlas != NULL, "create failed: %s", pk_get_last_error_context());
+    if (!atlas) {
+        return;
+    }
+    STRESS_CHECK(failures, skin_atlas_load_builtin(atlas) == PK_OK,
+                 "built-in skin failed: %s", pk_get_last_error_context());
+
+    SDL_Rect rects[5];
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        const SkinRegion* region = skin_atlas_find(atlas, names[i]);
+        STRESS_CHECK(failures, region != NULL, "built-in region %s missing", names[i]);
+        if (!region) {
+            continue;
+        }
+        STRESS_CHECK(failures, region->insets.left + region->insets.right < region->rect.w &&
+                     region->insets.top + region->insets.bottom < region->rect.h,
+                     "built-in region %s has no stretchable center", names[i]);
+        rects[found++] = region->rect;
+    }
+    check_layout("built-in", rects, found, skin_atlas_get_surface(atlas));
+
+    STRESS_CHECK(failures, skin_atlas_find_state(atlas, "button", "focused") ==
+                 skin_atlas_find(atlas, "button.normal"), "unknown state did not fall back");
+    skin_atlas_destroy(atlas);
+}
+
+/* Nine distinct opaque colors, slice (row, col) of the drawn region */
+static uint32_t slice_color(int row, int col) {
+    return 0xFF000000u | (uint32_t)(0x20 + row * 0x50) << 16 |
+           (uint32_t)(0x20 + col * 0x50) << 8 | 0x99u;
+}
+
+/* Index of the band [bounds[i], bounds[i + 1]) holding v, or -1 */
+static int band_of(int v, const int bounds[4]) {
+    for (int i = 0; i < 3; i++) {
+        if (v >= bounds[i] && v < bounds[i + 1]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void test_drawing(void) {
+    /* 12x12 region with uneven insets between two magenta neighbours */
+    const SkinInsets insets = { 3, 4, 5, 2 };
+    const int image_cols[4] = { 0, 3, 7, 12 };
+    const int image_rows[4] = { 0, 4, 10, 12 };
+
+    SkinAtlas* atlas = skin_atlas_create(DRAW_ATLAS_SIZE, DRAW_ATLAS_SIZE);
+    SDL_Surface* neighbour = solid_image(10, 30, 0xFF000000u | NEIGHBOUR);
+    SDL_Surface* image = solid_image(12, 12, 0);
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, TARGET_W, TARGET_H, 32,
+                                                         SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+    DisplayListTextureCache* cache = display_list_texture_cache_create();
+    DisplayList* list = display_list_create(0);
+    STRESS_CHECK(failures, atlas && neighbour && image && target && renderer && cache && list,
+                 "draw setup failed: %s", SDL_GetError());
+    if (!atlas || !neighbour || !image || !target || !renderer || !cache || !list) {
+        goto cleanup;
+    }
+    display_list_texture_cache_set_format(cache, SDL_PIXELFORMAT_ARGB8888, false);
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            SDL_Rect slice = { image_cols[col], image_rows[row],
+                               image_cols[col + 1] - image_cols[col],
+                               image_rows[row + 1] - image_rows[row] };
+            SDL_FillRect(image, &slice, slice_color(row, col));
+        }
+    }
+
+    SkinInsets none = { 0, 0, 0, 0 };
+    STRESS_CHECK(failures,
+                 skin_atlas_add_surface(atlas, "left", neighbour, &none) == PK_OK &&
+                 skin_atlas_add_surface(atlas, "sliced", image, &insets) == PK_OK &&
+                 skin_atlas_add_surface(atlas, "right", neighbour, &none) == PK_OK,
+                 "packing the draw atlas failed: %s", pk_get_last_error_context());
+    const SkinRegion* region = skin_atlas_find(atlas, "sliced");
+    if (!region) {
+        goto cleanup;
+    }
+    STRESS_CHECK(failures, region->rect.x > 0,
+                 "sliced region at the atlas origin, UV offsets untested");
+
+    /* Stretched both ways: centre 52x34, edges stretched along one axis */
+    const SDL_Rect dst = { 8, 8, 60, 40 };
+    const int dst_cols[4] = { dst.x, dst.x + insets.left, dst.x + dst.w - insets.right,
+                              dst.x + dst.w };
+    const int dst_rows[4] = { dst.y, dst.y + insets.top, dst.y + dst.h - insets.bottom,
+                              dst.y + dst.h };
+
+    display_list_set_draw_color(list, BACKGROUND >> 16, (BACKGROUND >> 8) & 0xFF,
+                                BACKGROUND & 0xFF, 255);
+    display_list_clear(list);
+    STRESS_CHECK(failures, skin_atlas_draw(list, atlas, region, &dst) == 0,
+                 "draw failed: %s", SDL_GetError());
+    STRESS_CHECK(failures, display_list_execute(list, renderer, cache) == PK_OK,
+                 "execute failed: %s", pk_get_last_error_context());
+
+    int wrong = 0;
+    for (int y = 0; y < TARGET_H; y++) {
+        for (int x = 0; x < TARGET_W; x++) {
+            int col = band_of(x, dst_cols);
+            int row = band_of(y, dst_rows);
+            uint32_t expected = (col < 0 || row < 0) ? BACKGROUND
+                                                     : slice_color(row, col) & 0xFFFFFF;
+            uint32_t actual = pixel_at(target, x, y) & 0xFFFFFF;
+            if (actual != expected && wrong++ == 0) {
+                STRESS_CHECK(failures, false, "drawn pixel %d,%d is %06x, expected %06x%s",
+                             x, y, actual, expected,
+                             actual == NEIGHBOUR ? " (neighbour bleed)" : "");
+            }
+        }
+    }
+    STRESS_CHECK(failures, wrong == 0, "%d drawn pixels wrong", wrong);
+
+    STRESS_CHECK(failures, skin_atlas_add_surface(atlas, "late", neighbour, &none) ==
+                 PK_ERROR_INVALID_STATE, "drawn atlas accepted a new region");
+
+cleanup:
+    display_list_destroy(list);
+    display_list_texture_cache_destroy(cache);
+    if (renderer) {
+        SDL_DestroyRenderer(renderer);
+    }
+    SDL_FreeSurface(target);
+    SDL_FreeSurface(image);
+    SDL_FreeSurface(neighbour);
+    skin_atlas_destroy(atlas);
+}
+
+static void measure(void) {
+    SkinAtlas* atlas = skin_atlas_create(0, 0);
+    DisplayList* list = display_list_create(0);
+    if (!atlas || !list || skin_atlas_load_builtin(atlas) != PK_OK) {
+        STRESS_CHECK(failures, false, "bench setup failed: %s", pk_get_last_error_context());
+        display_list_destroy(list);
+        skin_atlas_destroy(atlas);
+        return;
+    }
+    const SkinRegion* region = skin_atlas_find(atlas, "button.normal");
+
+    long iterations = bench_iterations();
+    uint64_t start = bench_now_ns();
+    for (long i = 0; i < iterations; i++) {
+        if (i % 64 == 0) {
+            display_list_reset(list);
+        }
+        SDL_Rect dst = { (int)(i % 700), 40, 100 + (int)(i % 50), 60 };
+        skin_atlas_draw(list, atlas, region, &dst);
+    }
+    bench_report("skin_atlas_draw", "64 per list", iterations, bench_now_ns() - start);
+
+    display_list_destroy(list);
+    skin_atlas_destroy(atlas);
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_skin_atlas");
+
+    bench_header("Skin atlas");
+    test_packing();
+    test_builtin();
+    test_drawing();
+    measure();
+
+    logger_shutdown();
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
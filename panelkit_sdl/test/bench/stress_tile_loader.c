@@ -0,0 +1,421 @@
+/**
+ * @file stress_tile_loader.c
+ * @brief Scheduling and caching checks for the map tile loader
+ *
+ * Runs the loader against a generated local tile directory and against the
+ * mock API server, with a fake decoder (tile bytes are copied, never parsed)
+ * so the checks need no image library:
+ * - every existing tile is delivered once, absent tiles come back MISSING
+ * - visible requests overtake queued prefetch on a single busy worker
+ * - requests not repeated before a prune are dropped unloaded
+ * - network tiles land in the disk cache and a second loader is served
+ *   from it without touching the server
+ * - the disk cache is trimmed back under its budget, oldest first
+ *
+ * Requires SDL2 headers and libcurl; build with `make build-bench-api`.
+ */
+
+#include "bench_common.h"
+#include "../api/mock_api_server.h"
+#include "../../src/core/logger.h"
+#include "../../src/ui/widgets/tile_loader.h"
+#include <stdatomic.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <curl/curl.h>
+
+#define GRID 4                      /* Local tiles: zoom 2, 4x4 */
+#define NET_TILE_BYTES (64 * 1024)
+#define NET_TILES 24                /* 1.5MB against a 1MB disk budget */
+
+static atomic_int g_decode_delay_ms;
+
+/* Copy the bytes so the result can be checked against the source */
+static void* fake_decode(const uint8_t* data, size_t size, void* user_data) {
+    (void)user_data;
+    int delay = atomic_load(&g_decode_delay_ms);
+    if (delay > 0) {
+        usleep((useconds_t)delay * 1000);
+    }
+    char* copy = malloc(size + 1);
+    if (copy) {
+        memcpy(copy, data, size);
+        copy[size] = '\0';
+    }
+    return copy;
+}
+
+static void fake_free(void* image, void* user_data) {
+    (void)user_data;
+    free(image);
+}
+
+static void sleep_ms(int ms) {
+    usleep((useconds_t)ms * 1000);
+}
+
+/* Poll until count results arrived or timeout_ms passed */
+static int collect(TileLoader* loader, TileResult* results, int count, int timeout_ms) {
+    int got = 0;
+    uint64_t deadline = bench_now_ns() + (uint64_t)timeout_ms * 1000000ull;
+    while (got < count && bench_now_ns() < deadline) {
+        int n = tile_loader_poll(loader, results + got, count - got);
+        got += n;
+        if (n == 0) {
+            sleep_ms(2);
+        }
+    }
+    return got;
+}
+
+static void free_results(TileResult* results, int count) {
+    for (int i = 0; i < count; i++) {
+        free(results[i].image);
+    }
+}
+
+static bool write_tile(const char* root, int z, int x, int y) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%d", root, z);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/%d/%d", root, z, x);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/%d/%d/%d.bmp", root, z, x, y);
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "tile %d/%d/%d", z, x, y);
+    return fclose(file) == 0;
+}
+
+static void remove_tree(const char* path) {
+    DIR* dir = opendir(path);
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            char child[1024];
+            snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+            remove_tree(child);
+        }
+        closedir(dir);
+        rmdir(path);
+    } else {
+        unlink(path);
+    }
+}
+
+/* Total size of the regular files below path */
+static uint64_t tree_bytes(const char* path, int* files) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        (*files)++;
+        return (uint64_t)st.st_size;
+    }
+    uint64_t total = 0;
+    DIR* dir = opendir(path);
+    if (!dir) {
+        return 0;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        char child[1024];
+        snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+        total += tree_bytes(child, files);
+    }
+    closedir(dir);
+    return total;
+}
+
+static TileLoaderConfig loader_config(const char* source, int workers) {
+    TileLoaderConfig config = tile_loader_default_config();
+    config.source = source;
+    config.workers = workers;
+    config.decode = fake_decode;
+    config.free_image = fake_free;
+    return config;
+}
+
+static int stress_local(const char* source) {
+    int failures = 0;
+    TileLoaderConfig config = loader_config(source, 4);
+    TileLoader* loader = tile_loader_create(&config);
+    STRESS_CHECK(failures, loader != NULL, "tile_loader_create failed");
+    if (!loader) {
+        return failures;
+    }
+
+    /* Whole grid, each tile asked for twice */
+    for (int pass = 0; pass < 2; pass++) {
+        for (int y = 0; y < GRID; y++) {
+            for (int x = 0; x < GRID; x++) {
+                TileKey key = { 2, x, y };
+                STRESS_CHECK(failures, tile_loader_request(loader, key, TILE_PRIORITY_VISIBLE),
+                             "request %d/%d refused", x, y);
+            }
+        }
+    }
+    TileKey bogus = { 2, GRID, 0 };
+    STRESS_CHECK(failures, !tile_loader_request(loader, bogus, TILE_PRIORITY_VISIBLE),
+                 "out-of-range tile accepted");
+
+    int expected = GRID * GRID;
+    TileResult results[GRID * GRID * 2];
+    int got = collect(loader, results, expected, 2000);
+    sleep_ms(50);
+    got += tile_loader_poll(loader, results + got, (int)(sizeof(results) / sizeof(results[0])) - got);
+
+    int ok = 0;
+    int mismatched = 0;
+    for (int i = 0; i < got; i++) {
+        char want[64];
+        snprintf(want, sizeof(want), "tile %d/%d/%d",
+                 results[i].key.z, results[i].key.x, results[i].key.y);
+        if (results[i].status == TILE_STATUS_OK) {
+            ok++;
+            if (!results[i].image || strcmp(results[i].image, want) != 0) {
+                mismatched++;
+            }
+        }
+    }
+    STRESS_CHECK(failures, got == expected, "expected %d results, got %d", expected, got);
+    STRESS_CHECK(failures, ok == expected, "expected %d tiles, got %d", expected, ok);
+    STRESS_CHECK(failures, mismatched == 0, "%d tiles had the wrong contents", mismatched);
+    free_results(results, got);
+
+    /* A hole in the directory is MISSING, not an error */
+    TileKey hole = { 3, 5, 5 };
+    tile_loader_request(loader, hole, TILE_PRIORITY_VISIBLE);
+    got = collect(loader, results, 1, 2000);
+    STRESS_CHECK(failures, got == 1 && results[0].status == TILE_STATUS_MISSING,
+                 "absent tile not reported missing");
+    free_results(results, got);
+
+    TileLoaderStats stats;
+    tile_loader_get_stats(loader, &stats);
+    STRESS_CHECK(failures, stats.requested == (uint64_t)expected + 1,
+                 "duplicates not merged: %llu requests", (unsigned long long)stats.requested);
+    printf("  local:    %d tiles, %llu missing, %llu errors\n", ok,
+           (unsigned long long)stats.missing, (unsigned long long)stats.errors);
+    tile_loader_destroy(loader);
+    return failures;
+}
+
+/* One slow worker: visible tiles queued after prefetch must load first */
+static int stress_priority(const char* source) {
+    int failures = 0;
+    TileLoaderConfig config = loader_config(source, 1);
+    TileLoader* loader = tile_loader_create(&config);
+    if (!loader) {
+        return 1;
+    }
+    atomic_store(&g_decode_delay_ms, 10);
+
+    for (int x = 0; x < GRID; x++) {
+        for (int y = 0; y < 2; y++) {
+            TileKey key = { 2, x, y };
+            tile_loader_request(loader, key, TILE_PRIORITY_PREFETCH);
+        }
+    }
+    sleep_ms(5);
+    for (int x = 0; x < GRID; x++) {
+        for (int y = 2; y < GRID; y++) {
+            TileKey key = { 2, x, y };
+            tile_loader_request(loader, key, TILE_PRIORITY_VISIBLE);
+        }
+    }
+
+    TileResult results[GRID * GRID];
+    int got = collect(loader, results, GRID * GRID, 3000);
+    /* At most one prefetch tile was already on the worker */
+    int last_visible = -1;
+    int prefetch_before = 0;
+    for (int i = 0; i < got; i++) {
+        if (results[i].key.y >= 2) {
+            last_visible = i;
+        }
+    }
+    for (int i = 0; i < last_visible; i++) {
+        if (results[i].key.y < 2) {
+            prefetch_before++;
+        }
+    }
+    STRESS_CHECK(failures, got == GRID * GRID, "expected %d results, got %d", GRID * GRID, got);
+    STRESS_CHECK(failures, prefetch_before <= 1,
+                 "%d prefetch tiles loaded before the last visible one", prefetch_before);
+    printf("  priority: %s (%d prefetch tiles ahead of visible)\n",
+           prefetch_before <= 1 ? "ok" : "FAILED", prefetch_before);
+    free_results(results, got);
+
+    /* Requests that are not repeated before the next prune are dropped */
+    for (int i = 0; i < 32; i++) {
+        TileKey key = { 5, i, 7 };
+        tile_loader_request(loader, key, TILE_PRIORITY_PREFETCH);
+    }
+    tile_loader_prune(loader);
+    int dropped = tile_loader_prune(loader);
+    got = collect(loader, results, 4, 200);
+    sleep_ms(50);
+    got += tile_loader_poll(loader, results + got, GRID * GRID - got);
+    free_results(results, got);
+
+    TileLoaderStats stats;
+    tile_loader_get_stats(loader, &stats);
+    STRESS_CHECK(failures, dropped >= 28, "only %d stale requests pruned", dropped);
+    STRESS_CHECK(failures, stats.pending == 0, "%u requests still pending", stats.pending);
+    printf("  prune:    %d of 32 stale requests dropped, %d loaded\n", dropped, got);
+
+    atomic_store(&g_decode_delay_ms, 0);
+    tile_loader_destroy(loader);
+    return failures;
+}
+
+static int stress_network(const char* cache_dir) {
+    int failures = 0;
+    char* body = malloc(NET_TILE_BYTES);
+    if (!body) {
+        return 1;
+    }
+    memset(body, 'T', NET_TILE_BYTES);
+    MockRoute route = {
+        .path = "*",
+        .content_type = "image/jpeg",
+        .body = body,
+        .body_size = NET_TILE_BYTES,
+        .latency = { .kind = MOCK_LATENCY_UNIFORM, .min_ms = 5, .max_ms = 20 },
+    };
+    MockApiServer* server = mock_api_server_start(&route, 1, 0, 7);
+    if (!server) {
+        fprintf(stderr, "Failed to start mock tile server\n");
+        free(body);
+        return 1;
+    }
+    char source[256];
+    mock_api_server_url(server, "/tiles/{z}/{x}/{y}.jpg", source, sizeof(source));
+
+    TileLoaderConfig config = loader_config(source, 4);
+    config.cache_dir = cache_dir;
+    config.disk_cache_mb = 0;
+
+    /* First pass downloads and fills the (unbounded) disk cache */
+    TileLoader* loader = tile_loader_create(&config);
+    STRESS_CHECK(failures, loader != NULL, "network loader not created");
+    TileResult results[NET_TILES];
+    TileLoaderStats stats = { 0 };
+    if (loader) {
+        for (int i = 0; i < 8; i++) {
+            TileKey key = { 4, i, 3 };
+            tile_loader_request(loader, key, TILE_PRIORITY_VISIBLE);
+        }
+        int got = collect(loader, results, 8, 5000);
+        int ok = 0;
+        for (int i = 0; i < got; i++) {
+            ok += results[i].status == TILE_STATUS_OK && !results[i].from_disk_cache;
+        }
+        STRESS_CHECK(failures, ok == 8, "expected 8 downloads, got %d", ok);
+        free_results(results, got);
+        tile_loader_get_stats(loader, &stats);
+        tile_loader_destroy(loader);
+    }
+    MockServerStats server_stats;
+    mock_api_server_get_stats(server, &server_stats);
+    STRESS_CHECK(failures, server_stats.requests == 8, "server saw %llu requests",
+                 (unsigned long long)server_stats.requests);
+
+    /* A fresh loader finds them on disk */
+    mock_api_server_reset_stats(server);
+    loader = tile_loader_create(&config);
+    if (loader) {
+        for (int i = 0; i < 8; i++) {
+            TileKey key = { 4, i, 3 };
+            tile_loader_request(loader, key, TILE_PRIORITY_VISIBLE);
+        }
+        int got = collect(loader, results, 8, 5000);
+        int cached = 0;
+        for (int i = 0; i < got; i++) {
+            cached += results[i].status == TILE_STATUS_OK && results[i].from_disk_cache;
+        }
+        STRESS_CHECK(failures, cached == 8, "expected 8 disk hits, got %d", cached);
+        free_results(results, got);
+        tile_loader_destroy(loader);
+    }
+    mock_api_server_get_stats(server, &server_stats);
+    STRESS_CHECK(failures, server_stats.requests == 0, "disk hits still fetched %llu tiles",
+                 (unsigned long long)server_stats.requests);
+    printf("  network:  %llu downloads, %llu KB, second loader served from disk\n",
+           (unsigned long long)stats.network_fetches,
+           (unsigned long long)(stats.bytes_read / 1024));
+
+    /* Over budget: oldest tiles go first */
+    config.disk_cache_mb = 1;
+    loader = tile_loader_create(&config);
+    if (loader) {
+        for (int i = 0; i < NET_TILES; i++) {
+            TileKey key = { 5, i, 9 };
+            tile_loader_request(loader, key, TILE_PRIORITY_VISIBLE);
+        }
+        int got = collect(loader, results, NET_TILES, 10000);
+        STRESS_CHECK(failures, got == NET_TILES, "expected %d results, got %d", NET_TILES, got);
+        free_results(results, got);
+        tile_loader_destroy(loader);
+    }
+    int files = 0;
+    uint64_t bytes = tree_bytes(cache_dir, &files);
+    STRESS_CHECK(failures, bytes <= 1024 * 1024, "disk cache at %llu KB over a 1MB budget",
+                 (unsigned long long)(bytes / 1024));
+    char first_pass[768];
+    snprintf(first_pass, sizeof(first_pass), "%s/4/0/3.tile", cache_dir);
+    STRESS_CHECK(failures, access(first_pass, F_OK) != 0, "oldest tile survived the trim");
+    printf("  trim:     %d files, %llu KB kept of a 1024 KB budget\n", files,
+           (unsigned long long)(bytes / 1024));
+
+    mock_api_server_stop(server);
+    free(body);
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_tile_loader");
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    char root[] = "/tmp/panelkit_tiles_XXXXXX";
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    for (int x = 0; x < GRID; x++) {
+        for (int y = 0; y < GRID; y++) {
+            if (!write_tile(root, 2, x, y)) {
+                perror("write_tile");
+                return 1;
+            }
+        }
+    }
+    char source[512];
+    snprintf(source, sizeof(source), "file://%s/{z}/{x}/{y}.bmp", root);
+    char cache_dir[600];
+    snprintf(cache_dir, sizeof(cache_dir), "%s/cache", root);
+
+    printf("\n=== Tile loader ===\n");
+    int failures = 0;
+    failures += stress_local(source);
+    failures += stress_priority(source);
+    failures += stress_network(cache_dir);
+
+    remove_tree(root);
+    curl_global_cleanup();
+    logger_shutdown();
+
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file stress_watchdog.c
+ * @brief Functional checks for the frame-deadline watchdog
+ *
+ * Runs a fake 200 Hz main loop against a short deadline and checks:
+ * - steady heartbeats never report a stall, and systemd pings flow
+ *   (NOTIFY_SOCKET points at a datagram socket owned by the test)
+ * - a blocked "handler" is reported once, with its phase and the main
+ *   thread's stack written to the error log
+ * - pings stop while the loop is stalled and resume afterwards
+ * - the stall duration is measured when heartbeats resume
+ * - watchdog_suspend() covers intentional long operations
+ *
+ * Exit status is non-zero if any check fails.
+ */
+
+#define _GNU_SOURCE
+#include "bench_common.h"
+#include "../../src/core/logger.h"
+#include "../../src/core/error.h"
+#include "../../src/core/error_logger.h"
+#include "../../src/core/watchdog.h"
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define DEADLINE_MS 100
+#define FRAME_MS 5
+#define STALL_MS 400
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+    /* The capture signal interrupts nanosleep; finish the remainder */
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+static void run_frames(Watchdog* watchdog, int frames) {
+    for (int i = 0; i < frames; i++) {
+        watchdog_heartbeat(watchdog);
+        watchdog_phase(watchdog, "events");
+        sleep_ms(FRAME_MS);
+    }
+}
+
+/* Stands in for a subscriber doing blocking I/O inside event_emit */
+void __attribute__((noinline)) stress_watchdog_blocking_handler(void) {
+    sleep_ms(STALL_MS);
+}
+
+/* Count WATCHDOG=1 datagrams queued on the fake notify socket */
+static int drain_pings(int fd) {
+    char buf[64];
+    int pings = 0;
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf) - 1, MSG_DONTWAIT)) > 0) {
+        buf[n] = '\0';
+        if (strcmp(buf, "WATCHDOG=1") == 0) {
+            pings++;
+        }
+    }
+    return pings;
+}
+
+/* Read the whole current error log */
+static char* read_error_log(void) {
+    const char* path = error_logger_get_current_file();
+    FILE* file = path ? fopen(path, "r") : NULL;
+    if (!file) {
+        return NULL;
+    }
+    static char contents[65536];
+    size_t len = fread(contents, 1, sizeof(contents) - 1, file);
+    contents[len] = '\0';
+    fclose(file);
+    return contents;
+}
+
+int main(int argc, char* argv[]) {
+    logger_init(argc > 1 ? argv[1] : "bench_zlog.conf", "stress_watchdog");
+    int failures = 0;
+
+    char log_dir[] = "/tmp/panelkit-watchdog-XXXXXX";
+    if (!mkdtemp(log_dir)) {
+        fprintf(stderr, "FAIL: cannot create log directory\n");
+        return 1;
+    }
+    ErrorLogConfig log_config = error_logger_default_config();
+    log_config.log_directory = log_dir;
+    log_config.log_to_console = false;
+    error_logger_init(&log_config);
+
+    /* Fake service manager */
+    char notify_path[sizeof(log_dir) + 16];
+    snprintf(notify_path, sizeof(notify_path), "%s/notify", log_dir);
+    int notify_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", notify_path);
+    if (notify_fd < 0 || bind(notify_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "FAIL: cannot bind fake NOTIFY_SOCKET\n");
+        return 1;
+    }
+    setenv("NOTIFY_SOCKET", notify_path, 1);
+    setenv("WATCHDOG_USEC", "120000", 1);  /* Ping every 60ms */
+    unsetenv("WATCHDOG_PID");
+
+    WatchdogConfig config = watchdog_default_config();
+    config.deadline_ms = DEADLINE_MS;
+    config.check_interval_ms = 10;
+    Watchdog* watchdog = watchdog_create(&config);
+    STRESS_CHECK(failures, watchdog != NULL, "watchdog_create failed");
+    if (!watchdog) {
+        return 1;
+    }
+    STRESS_CHECK(failures, watchdog_start(watchdog), "watchdog_start failed: %s",
+                 pk_get_last_error_context());
+    STRESS_CHECK(failures, watchdog_notify("READY=1"), "READY=1 not sent");
+
+    printf("Running watchdog checks (deadline %dms, %dms frames, %dms stall)\n",
+           DEADLINE_MS, FRAME_MS, STALL_MS);
+
+    /* Steady loop: no stalls, pings flowing */
+    run_frames(watchdog, 60);
+    WatchdogStats stats;
+    watchdog_get_stats(watchdog, &stats);
+    int steady_pings = drain_pings(notify_fd);
+    STRESS_CHECK(failures, stats.stalls == 0, "steady loop reported %llu stalls",
+                 (unsigned long long)stats.stalls);
+    STRESS_CHECK(failures, steady_pings >= 3, "only %d pings in 300ms", steady_pings);
+    printf("  steady:   %s (%d pings)\n", stats.stalls == 0 ? "ok" : "FAILED", steady_pings);
+
+    /* Blocked handler */
+    watchdog_heartbeat(watchdog);
+    watchdog_phase(watchdog, "handler");
+    drain_pings(notify_fd);
+    stress_watchdog_blocking_handler();
+    int stalled_pings = drain_pings(notify_fd);
+    watchdog_get_stats(watchdog, &stats);
+    STRESS_CHECK(failures, stats.stalls == 1, "expected 1 stall, got %llu",
+                 (unsigned long long)stats.stalls);
+    STRESS_CHECK(failures, stats.stalled, "stall not in progress during block");
+    /* Pings may go out until the deadline passes */
+    STRESS_CHECK(failures, stalled_pings <= DEADLINE_MS / 60 + 2,
+                 "%d pings sent while stalled", stalled_pings);
+
+    const char* contents = read_error_log();
+    STRESS_CHECK(failures, contents != NULL, "error log not readable");
+    if (contents) {
+        STRESS_CHECK(failures, strstr(contents, "phase 'handler'") != NULL,
+                     "stall report lacks the phase");
+        STRESS_CHECK(failures, strstr(contents, "Stack of main thread:") != NULL,
+                     "stall report lacks the stack header");
+#ifdef __GLIBC__
+        STRESS_CHECK(failures, strstr(contents, "#0 ") != NULL,
+                     "stall report lacks stack frames");
+#endif
+    }
+    printf("  stall:    %s (%d pings while stalled)\n",
+           stats.stalls == 1 ? "ok" : "FAILED", stalled_pings);
+
+    /* Recovery */
+    run_frames(watchdog, 10);
+    watchdog_get_stats(watchdog, &stats);
+    STRESS_CHECK(failures, !stats.stalled, "stall not cleared after heartbeats resumed");
+    STRESS_CHECK(failures, stats.last_stall_ms >= STALL_MS - 20 && stats.last_stall_ms < STALL_MS * 3,
+                 "measured stall %ums, expected ~%dms", stats.last_stall_ms, STALL_MS);
+    run_frames(watchdog, 20);
+    int recovered_pings = drain_pings(notify_fd);
+    STRESS_CHECK(failures, recovered_pings >= 1, "pings did not resume");
+    printf("  recovery: %s (stall measured %ums)\n", !stats.stalled ? "ok" : "FAILED",
+           stats.last_stall_ms);
+
+    /* Intentional long operation */
+    watchdog_suspend(watchdog);
+    sleep_ms(STALL_MS);
+    run_frames(watchdog, 5);
+    watchdog_get_stats(watchdog, &stats);
+    STRESS_CHECK(failures, stats.stalls == 1, "suspended operation reported as a stall");
+    printf("  suspend:  %s\n", stats.stalls == 1 ? "ok" : "FAILED");
+
+    watchdog_destroy(watchdog);
+    close(notify_fd);
+    unlink(notify_path);
+    char error_log_path[512];
+    snprintf(error_log_path, sizeof(error_log_path), "%s",
+             error_logger_get_current_file() ? error_logger_get_current_file() : "");
+    error_logger_shutdown();
+    if (error_log_path[0]) {
+        unlink(error_log_path);
+    }
+    rmdir(log_dir);
+    logger_shutdown();
+
+    printf("%s (%d failures)\n", failures ? "STRESS FAILED" : "STRESS PASSED", failures);
+    return failures ? 1 : 0;
+}
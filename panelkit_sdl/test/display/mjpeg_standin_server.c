@@ -0,0 +1,221 @@
+/**
+ * @file mjpeg_standin_server.c
+ * @brief Stand-in MJPEG camera for exercising the video widget
+ *
+ * Serves a file of concatenated JPEG images as a multipart/x-mixed-replace
+ * stream, looping forever at a fixed frame rate, like a typical IP camera's
+ * /stream.mjpg endpoint. Any path is accepted; each client gets its own
+ * thread and stream position.
+ *
+ * Usage: mjpeg_standin_server <frames.mjpg> [port] [fps]
+ *
+ * A frames file can be made with e.g.
+ *   ffmpeg -f lavfi -i testsrc=size=640x480:rate=30 -t 5 -f mjpeg frames.mjpg
+ * and shown with `ui.video.source: "http://127.0.0.1:8090/stream.mjpg"`.
+ * Raising fps above the display rate exercises the widget's drop path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#define MAX_FRAMES 4096
+#define BOUNDARY "panelkitframe"
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+} Frame;
+
+static uint8_t* g_file;
+static Frame g_frames[MAX_FRAMES];
+static int g_frame_count;
+static long g_frame_interval_ns;
+
+static int load_frames(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
+        fprintf(stderr, "%s is empty\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    g_file = malloc((size_t)size);
+    if (!g_file || fread(g_file, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    // Split on SOI (FFD8) ... EOI (FFD9)
+    size_t start = 0;
+    bool in_frame = false;
+    for (size_t i = 0; i + 1 < (size_t)size && g_frame_count < MAX_FRAMES; i++) {
+        if (g_file[i] != 0xFF) {
+            continue;
+        }
+        if (!in_frame && g_file[i + 1] == 0xD8) {
+            start = i;
+            in_frame = true;
+        } else if (in_frame && g_file[i + 1] == 0xD9) {
+            g_frames[g_frame_count].data = g_file + start;
+            g_frames[g_frame_count].size = i + 2 - start;
+            g_frame_count++;
+            in_frame = false;
+            i++;
+        }
+    }
+
+    if (g_frame_count == 0) {
+        fprintf(stderr, "No JPEG frames found in %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int send_all(int fd, const void* data, size_t size) {
+    const uint8_t* p = data;
+    while (size > 0) {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static void sleep_until(struct timespec* deadline) {
+    deadline->tv_nsec += g_frame_interval_ns;
+    while (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_nsec -= 1000000000L;
+        deadline->tv_sec++;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) == EINTR) {
+    }
+}
+
+static void* client_main(void* arg) {
+    int fd = (int)(intptr_t)arg;
+
+    // Discard the request; every path gets the stream
+    char request[2048];
+    if (recv(fd, request, sizeof(request), 0) <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    const char* header =
+        "HTTP/1.0 200 OK\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: close\r\n"
+        "Content-Type: multipart/x-mixed-replace; boundary=" BOUNDARY "\r\n\r\n";
+    if (send_all(fd, header, strlen(header)) < 0) {
+        close(fd);
+        return NULL;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    unsigned long sent = 0;
+
+    for (int i = 0;; i = (i + 1) % g_frame_count) {
+        char part[128];
+        int len = snprintf(part, sizeof(part),
+                           "--" BOUNDARY "\r\nContent-Type: image/jpeg\r\n"
+                           "Content-Length: %zu\r\n\r\n", g_frames[i].size);
+        if (send_all(fd, part, (size_t)len) < 0 ||
+            send_all(fd, g_frames[i].data, g_frames[i].size) < 0 ||
+            send_all(fd, "\r\n", 2) < 0) {
+            break;
+        }
+        sent++;
+        sleep_until(&deadline);
+    }
+
+    printf("Client disconnected after %lu frames\n", sent);
+    close(fd);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <frames.mjpg> [port] [fps]\n", argv[0]);
+        return 1;
+    }
+
+    int port = argc > 2 ? atoi(argv[2]) : 8090;
+    int fps = argc > 3 ? atoi(argv[3]) : 30;
+    if (fps <= 0) {
+        fps = 30;
+    }
+    g_frame_interval_ns = 1000000000L / fps;
+
+    if (load_frames(argv[1]) < 0) {
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(listener, 8) < 0) {
+        fprintf(stderr, "Cannot listen on port %d: %s\n", port, strerror(errno));
+        return 1;
+    }
+
+    printf("Serving %d frames at %d fps on http://0.0.0.0:%d/stream.mjpg\n",
+           g_frame_count, fps, port);
+
+    for (;;) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("accept");
+            break;
+        }
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, client_main, (void*)(intptr_t)fd) != 0) {
+            close(fd);
+            continue;
+        }
+        pthread_detach(thread);
+        printf("Client connected\n");
+    }
+
+    close(listener);
+    free(g_file);
+    return 0;
+}